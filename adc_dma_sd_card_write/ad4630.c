@@ -1,22 +1,18 @@
 /* Private includes --------------------------------------------------------------------------------------------------*/
 
 #include "ad4630.h"
-#include "dma.h"
-#include "dma_regs.h"
-#include "gpio_helpers.h"
-#include "mxc_delay.h"
-#include "mxc_device.h"
-#include "nvic_table.h"
-#include "spi.h"
-#include "spi_regs.h"
-
-#include <stddef.h> // for NULL
+#include "hal_gpio.h"
+#include "hal_spi.h"
+#include "hal_timer.h"
 
 /* Private defines ---------------------------------------------------------------------------------------------------*/
 
 // we use two SPI busses for the ADC, one to configure the ADC, and one to read the audio data from the ADC
-#define CONFIG_SPI_BUS (MXC_SPI2)
-#define DATA_SPI_BUS (MXC_SPI1)
+#define CONFIG_SPI_BUS (HAL_SPI_BUS_2)
+#define DATA_SPI_BUS (HAL_SPI_BUS_1)
+
+// the config SPI clock
+#define CONFIG_SPI_CLK_FREQ_HZ (5000000)
 
 // some operations require a dummy read
 #define AD4630_REG_READ_DUMMY (0x00)
@@ -57,7 +53,6 @@
 // size of the various buffers used for SPI transactions
 #define CONFIG_SPI_TX_BUFF_LEN_IN_BYTES (3)
 #define CONFIG_SPI_RX_BUFF_LEN_IN_BYTES (3)
-#define DATA_SPI_RX_BUFF_LEN_IN_BYTES (3)
 
 /* Private types -----------------------------------------------------------------------------------------------------*/
 
@@ -78,61 +73,41 @@ typedef enum
 /**
  * Chip select pin for config SPI, shorted to the ADC busy pin. Used as the chip select for the config SPI, then set to hi-Z
  */
-static mxc_gpio_cfg_t config_spi_cs_pin = {
-    .port = MXC_GPIO0,
-    .mask = MXC_GPIO_PIN_16,
-    .pad = MXC_GPIO_PAD_NONE,
-    .func = MXC_GPIO_FUNC_OUT,
-    .vssel = MXC_GPIO_VSSEL_VDDIO,
-    .drvstr = MXC_GPIO_DRVSTR_3,
+static Hal_GPIO_Pin_t config_spi_cs_pin = {
+    .port = HAL_GPIO_PORT_0,
+    .mask = HAL_GPIO_PIN(16),
+    .func = HAL_GPIO_FUNC_OUT,
+    .voltage = HAL_GPIO_VOLTAGE_VDDIO,
+    .drive_strength = HAL_GPIO_DRIVE_STRENGTH_3,
 };
 
 /**
  * Pin to enable and disable the ADC clock generation, HIGH to enable, LOW to disable
  */
-static const mxc_gpio_cfg_t adc_clk_en_pin = {
-    .port = MXC_GPIO0,
-    .mask = MXC_GPIO_PIN_20,
-    .pad = MXC_GPIO_PAD_NONE,
-    .func = MXC_GPIO_FUNC_OUT,
-    .vssel = MXC_GPIO_VSSEL_VDDIO,
-    .drvstr = MXC_GPIO_DRVSTR_0,
+static const Hal_GPIO_Pin_t adc_clk_en_pin = {
+    .port = HAL_GPIO_PORT_0,
+    .mask = HAL_GPIO_PIN(20),
+    .func = HAL_GPIO_FUNC_OUT,
+    .voltage = HAL_GPIO_VOLTAGE_VDDIO,
+    .drive_strength = HAL_GPIO_DRIVE_STRENGTH_0,
 };
 
 /**
  * Pin to force a reset of the ADC. To reset, pull LOW, then HIGH. Must be HIGH when ADC is in use.
  */
-static const mxc_gpio_cfg_t adc_n_reset_pin = {
-    .port = MXC_GPIO0,
-    .mask = MXC_GPIO_PIN_21,
-    .pad = MXC_GPIO_PAD_NONE,
-    .func = MXC_GPIO_FUNC_OUT,
-    .vssel = MXC_GPIO_VSSEL_VDDIO,
-    .drvstr = MXC_GPIO_DRVSTR_0,
+static const Hal_GPIO_Pin_t adc_n_reset_pin = {
+    .port = HAL_GPIO_PORT_0,
+    .mask = HAL_GPIO_PIN(21),
+    .func = HAL_GPIO_FUNC_OUT,
+    .voltage = HAL_GPIO_VOLTAGE_VDDIO,
+    .drive_strength = HAL_GPIO_DRIVE_STRENGTH_0,
 };
 
 /**
- * Buffers for writing and reading from the two SPI busses
+ * Buffers for writing and reading from the configuration SPI, used to initialize and set up the ADC
  */
 static uint8_t cfg_spi_tx_buff[CONFIG_SPI_TX_BUFF_LEN_IN_BYTES];
 static uint8_t cfg_spi_rx_buff[CONFIG_SPI_RX_BUFF_LEN_IN_BYTES];
-static uint8_t data_spi_rx_buff[DATA_SPI_RX_BUFF_LEN_IN_BYTES];
-
-/**
- * SPI request structure for the configuration SPI, used to initialize and set up the ADC
- */
-static mxc_spi_req_t cfg_spi_req = {
-    .spi = CONFIG_SPI_BUS,
-    .txData = cfg_spi_tx_buff,
-    .rxData = cfg_spi_rx_buff,
-    .txLen = CONFIG_SPI_TX_BUFF_LEN_IN_BYTES,
-    .rxLen = 1,
-    .ssIdx = 0,
-    .ssDeassert = 1,
-    .txCnt = 0,
-    .rxCnt = 0,
-    .completeCB = NULL,
-};
 
 /* Private function declarations -------------------------------------------------------------------------------------*/
 
@@ -213,12 +188,12 @@ static AD4630_Error_t set_data_spi_to_slave_mode();
 
 AD4630_Error_t ad4630_init()
 {
-    MXC_GPIO_Config(&adc_clk_en_pin);
-    MXC_GPIO_Config(&config_spi_cs_pin);
+    hal_gpio_config(&adc_clk_en_pin);
+    hal_gpio_config(&config_spi_cs_pin);
 
     // the reset pin must be high or the ADC will be stuck in reset
-    MXC_GPIO_Config(&adc_n_reset_pin);
-    gpio_write_pin(&adc_n_reset_pin, true);
+    hal_gpio_config(&adc_n_reset_pin);
+    hal_gpio_write(&adc_n_reset_pin, true);
 
     ad4630_cont_conversions_stop();
 
@@ -236,7 +211,7 @@ AD4630_Error_t ad4630_init()
     }
 
     // we need to re-initialize the clock enable pin, because the config is overwritten when we init SPI1
-    MXC_GPIO_Config(&adc_clk_en_pin);
+    hal_gpio_config(&adc_clk_en_pin);
 
     ad4630_cont_conversions_stop();
 
@@ -245,12 +220,12 @@ AD4630_Error_t ad4630_init()
 
 void ad4630_cont_conversions_start()
 {
-    gpio_write_pin(&adc_clk_en_pin, true);
+    hal_gpio_write(&adc_clk_en_pin, true);
 }
 
 void ad4630_cont_conversions_stop()
 {
-    gpio_write_pin(&adc_clk_en_pin, false);
+    hal_gpio_write(&adc_clk_en_pin, false);
 }
 
 /* Private function definitions --------------------------------------------------------------------------------------*/
@@ -261,16 +236,16 @@ AD4630_Error_t ad4630_read_reg(AD4630_Register_t reg, uint8_t *out)
     cfg_spi_tx_buff[1] = (uint8_t)reg;
     cfg_spi_tx_buff[2] = AD4630_REG_READ_DUMMY; // the output data will end up here
 
-    gpio_write_pin(&config_spi_cs_pin, false);
-    MXC_Delay(4); // TODO are these delays necessary?
+    hal_gpio_write(&config_spi_cs_pin, false);
+    hal_timer_delay_microsecs(4); // TODO are these delays necessary?
 
-    if (MXC_SPI_MasterTransaction(&cfg_spi_req) != E_NO_ERROR)
+    if (hal_spi_master_transaction(CONFIG_SPI_BUS, cfg_spi_tx_buff, CONFIG_SPI_TX_BUFF_LEN_IN_BYTES, cfg_spi_rx_buff, 1) != HAL_SPI_ERROR_ALL_OK)
     {
         return AD4630_ERROR_CONFIG_ERROR;
     }
 
-    gpio_write_pin(&config_spi_cs_pin, true);
-    MXC_Delay(4); // TODO are these delays necessary?
+    hal_gpio_write(&config_spi_cs_pin, true);
+    hal_timer_delay_microsecs(4); // TODO are these delays necessary?
 
     *out = cfg_spi_tx_buff[2];
 
@@ -283,16 +258,16 @@ AD4630_Error_t ad4630_write_reg(AD4630_Register_t reg, uint8_t val)
     cfg_spi_tx_buff[1] = (uint8_t)reg;
     cfg_spi_tx_buff[2] = val;
 
-    gpio_write_pin(&config_spi_cs_pin, false);
-    MXC_Delay(4); // TODO are these delays necessary?
+    hal_gpio_write(&config_spi_cs_pin, false);
+    hal_timer_delay_microsecs(4); // TODO are these delays necessary?
 
-    if (MXC_SPI_MasterTransaction(&cfg_spi_req) != E_NO_ERROR)
+    if (hal_spi_master_transaction(CONFIG_SPI_BUS, cfg_spi_tx_buff, CONFIG_SPI_TX_BUFF_LEN_IN_BYTES, cfg_spi_rx_buff, 1) != HAL_SPI_ERROR_ALL_OK)
     {
         return AD4630_ERROR_CONFIG_ERROR;
     }
 
-    gpio_write_pin(&config_spi_cs_pin, true);
-    MXC_Delay(4); // TODO are these delays necessary?
+    hal_gpio_write(&config_spi_cs_pin, true);
+    hal_timer_delay_microsecs(4); // TODO are these delays necessary?
 
     return AD4630_ERROR_ALL_OK;
 }
@@ -311,30 +286,10 @@ AD4630_Error_t ad4630_end_register_access_mode()
 AD4630_Error_t initialize_ad4630_with_config_spi()
 {
     // chip select high to start
-    gpio_write_pin(&config_spi_cs_pin, true);
+    hal_gpio_write(&config_spi_cs_pin, true);
 
     // set up SPI2 to perform ADC initialization
-    const uint32_t CFG_SPI_CLK_FREQ_Hz = 5000000;
-    if (MXC_SPI_Init(
-            CONFIG_SPI_BUS,
-            1, // 1 -> master mode
-            0, // 0 -> quad mode not used, single bit SPI
-            1, // num slaves
-            0, // CS polarity (0 for active low)
-            CFG_SPI_CLK_FREQ_Hz,
-            MAP_A) != E_NO_ERROR)
-    {
-        return AD4630_ERROR_CONFIG_ERROR;
-    }
-    if (MXC_SPI_SetDataSize(CONFIG_SPI_BUS, 8) != E_NO_ERROR)
-    {
-        return AD4630_ERROR_CONFIG_ERROR;
-    }
-    if (MXC_SPI_SetWidth(CONFIG_SPI_BUS, SPI_WIDTH_STANDARD) != E_NO_ERROR)
-    {
-        return AD4630_ERROR_CONFIG_ERROR;
-    }
-    if (MXC_SPI_SetMode(CONFIG_SPI_BUS, SPI_MODE_0) != E_NO_ERROR)
+    if (hal_spi_master_init(CONFIG_SPI_BUS, CONFIG_SPI_CLK_FREQ_HZ, HAL_SPI_MODE_0, HAL_SPI_WIDTH_STANDARD) != HAL_SPI_ERROR_ALL_OK)
     {
         return AD4630_ERROR_CONFIG_ERROR;
     }
@@ -358,66 +313,20 @@ AD4630_Error_t initialize_ad4630_with_config_spi()
     }
 
     // we no longer need SPI2 for the ADC, set the chip sel line as high-Z
-    MXC_SPI_Shutdown(CONFIG_SPI_BUS);
-    config_spi_cs_pin.func = MXC_GPIO_FUNC_IN;
-    MXC_GPIO_Config(&config_spi_cs_pin);
+    hal_spi_shutdown(CONFIG_SPI_BUS);
+    config_spi_cs_pin.func = HAL_GPIO_FUNC_IN;
+    hal_gpio_config(&config_spi_cs_pin);
 
     return AD4630_ERROR_ALL_OK;
 }
 
 AD4630_Error_t set_data_spi_to_slave_mode()
 {
-    if (MXC_SPI_Init(
-            DATA_SPI_BUS,
-            0, // 0 -> slave mode
-            0, // 0 -> quad mode not used, single bit SPI
-            0, // num slaves, none
-            0, // CS polarity (0 for active low)
-            0, // freq is defined by the driving clock
-            MAP_A) != E_NO_ERROR)
+    // the slave bus is left disabled with an empty FIFO, so the DMA stream starts only on pos edge of Slave-sel-B
+    if (hal_spi_slave_init(DATA_SPI_BUS, HAL_SPI_MODE_1, HAL_SPI_WIDTH_3WIRE) != HAL_SPI_ERROR_ALL_OK)
     {
         return AD4630_ERROR_CONFIG_ERROR;
     }
 
-    // TODO: this call returns an error. It does in Bob's code too, but it is not handled there.
-    // Do we even need to set the data size to 8 bits?
-    if (MXC_SPI_SetDataSize(DATA_SPI_BUS, 8) != E_NO_ERROR)
-    {
-        //        return AD4630_ERROR_CONFIG_ERROR;
-    }
-
-    if (MXC_SPI_SetWidth(DATA_SPI_BUS, SPI_WIDTH_3WIRE) != E_NO_ERROR)
-    {
-        return AD4630_ERROR_CONFIG_ERROR;
-    }
-    if (MXC_SPI_SetMode(DATA_SPI_BUS, SPI_MODE_1) != E_NO_ERROR)
-    {
-        return AD4630_ERROR_CONFIG_ERROR;
-    }
-
-    // complete the init; don't use the data!
-    mxc_spi_req_t data_spi_req = {
-        .spi = DATA_SPI_BUS,
-        .txData = NULL,
-        .rxData = data_spi_rx_buff,
-        .txLen = 0,
-        .rxLen = DATA_SPI_RX_BUFF_LEN_IN_BYTES,
-        .ssIdx = 0,
-        .ssDeassert = 1,
-        .txCnt = 0,
-        .rxCnt = 0,
-        .completeCB = NULL,
-    };
-    if (MXC_SPI_SlaveTransactionAsync(&data_spi_req) != E_NO_ERROR)
-    {
-        return AD4630_ERROR_CONFIG_ERROR;
-    }
-
-    // disable the port
-    DATA_SPI_BUS->ctrl0 &= ~(MXC_F_SPI_CTRL0_EN);
-
-    // clear the fifo, start only on pos edge of Slave-sel-B
-    MXC_SPI_ClearRXFIFO(DATA_SPI_BUS);
-
     return AD4630_ERROR_ALL_OK;
 }
@@ -13,6 +13,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "audio_dma_ring.h"
 #include "wav_header.h"
 
 /* Public definitions ------------------------------------------------------------------------------------------------*/
@@ -26,6 +27,11 @@
 // the time it takes for one round of the DMA buffer to be filled, in microseconds
 #define AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS ((AUDIO_DMA_BUFF_LEN_IN_SAMPS * 1000) / (WAVE_HEADER_SAMPLE_RATE_384kHz / 1000))
 
+// the number of DMA blocks in the ring, 8 blocks hold ~172ms of audio in ~194KiB. With the ~125KiB of the other
+// recorder buffers that leaves over half of the 560KiB of SRAM for FatFS, the stack, and the rest of the firmware.
+// test/profiling_tests measures the longest write stall of a card, the ring must hold at least that much audio
+#define AUDIO_DMA_RING_DEPTH_IN_BLOCKS (8)
+
 /* Public enumerations -----------------------------------------------------------------------------------------------*/
 
 /**
@@ -35,8 +41,17 @@ typedef enum
 {
     AUDIO_DMA_ERROR_ALL_OK,
     AUDIO_DMA_ERROR_DMA_ERROR,
+    AUDIO_DMA_ERROR_INVALID_ARG_ERROR,
 } Audio_DMA_Error_t;
 
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A function to call each time a DMA block is ready is represented here, see
+ * `audio_dma_set_block_ready_callback(f)`.
+ */
+typedef void (*Audio_DMA_Block_Ready_Callback_t)();
+
 /* Public function declarations --------------------------------------------------------------------------------------*/
 
 /**
@@ -70,6 +85,31 @@ Audio_DMA_Error_t audio_dma_start();
  */
 Audio_DMA_Error_t audio_dma_stop();
 
+/**
+ * @brief `audio_dma_set_ring_depth(d)` sets the number of DMA blocks in the ring to `d`. Each block of slack tolerates
+ * one more `AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS` of SD card stall. The recorder always uses
+ * `AUDIO_DMA_RING_DEPTH_IN_BLOCKS` since the SRAM for it is allocated anyway, shallower rings are for testing.
+ *
+ * @pre DMA initialization is complete and the DMA stream is stopped
+ *
+ * @param depth_in_blocks the number of blocks in the ring, in [2, AUDIO_DMA_RING_DEPTH_IN_BLOCKS]
+ *
+ * @post the next time the DMA stream is started it uses a ring of `d` blocks
+ *
+ * @retval `AUDIO_DMA_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Audio_DMA_Error_t audio_dma_set_ring_depth(uint32_t depth_in_blocks);
+
+/**
+ * @brief `audio_dma_get_stats()` is a pointer to the ring occupancy statistics gathered since the DMA stream was last
+ * started. The statistics are cleared each time the stream is started, so they cover a single recording.
+ *
+ * @pre DMA initialization is complete
+ *
+ * @retval pointer to the statistics, valid until the next time the DMA stream is started
+ */
+const Audio_DMA_Ring_Stats_t *audio_dma_get_stats();
+
 /**
  * @brief `audio_dma_num_buffers_available()` is the number of full buffers available for reading
  *
@@ -106,4 +146,29 @@ bool audio_dma_overrun_occured();
  */
 void audio_dma_clear_overrun();
 
+/**
+ * @brief `audio_dma_set_block_ready_callback(f)` sets function `f` to be called each time the DMA fills a block.
+ *
+ * `f` does not run in the DMA interrupt, it runs in a lower priority context that pre-empts the main loop (the PendSV
+ * exception on the MAX32666, a separate thread on the host). This lets `f` process blocks while the main loop is blocked
+ * in an SD card write, without holding up the DMA interrupt. `f` is never re-entered, and may be called more than once
+ * per block, so it should consume every block available each time it runs.
+ *
+ * @pre the DMA stream is stopped
+ *
+ * @param callback the function to call, or NULL to stop calling anything
+ *
+ * @post `f` is called after each block is filled while the stream runs
+ */
+void audio_dma_set_block_ready_callback(Audio_DMA_Block_Ready_Callback_t callback);
+
+/**
+ * @brief `audio_dma_request_block_ready_callback()` asks for the block ready callback to be run again as soon as
+ * possible in its own context, even if no new block was filled. Use this when the callback had to leave blocks in the
+ * ring because it was waiting on something the main loop has now finished.
+ *
+ * @post the callback runs once more, if one is set and the stream is running
+ */
+void audio_dma_request_block_ready_callback();
+
 #endif /* AUDIO_DMA_H_ */
@@ -0,0 +1,141 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "audio_dma.h"
+#include "audio_dma_ring.h"
+#include "trace_log.h"
+
+#include <string.h> // for memset
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the number of blocks in the ring, set by `audio_dma_ring_reset()`
+static uint32_t depth = 2;
+
+// The producer and the consumer each own one free-running counter, the number of blocks waiting to be consumed is the
+// difference between the two. Because each counter only has one writer there is no read-modify-write race between
+// the DMA interrupt and the recording loop.
+static volatile uint32_t num_blocks_produced = 0;
+static volatile uint32_t num_blocks_consumed = 0;
+
+// the index of the block the DMA is currently filling, only touched by the producer
+static uint32_t fill_idx = 0;
+
+// the index of the oldest full block, only touched by the consumer
+static uint32_t read_idx = 0;
+
+// true if the producer caught up with the consumer
+static volatile bool overrun_occured = false;
+
+// a stall starts when the consumer falls a whole block behind, and lasts until the ring is empty again
+static volatile bool stall_in_progress = false;
+static volatile uint32_t stall_start_block = 0;
+
+static Audio_DMA_Ring_Stats_t stats;
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void audio_dma_ring_reset(uint32_t depth_in_blocks)
+{
+    depth = depth_in_blocks;
+    num_blocks_produced = 0;
+    num_blocks_consumed = 0;
+    fill_idx = 0;
+    read_idx = 0;
+    overrun_occured = false;
+    stall_in_progress = false;
+    stall_start_block = 0;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.depth_in_blocks = depth_in_blocks;
+}
+
+uint32_t audio_dma_ring_get_depth()
+{
+    return depth;
+}
+
+uint32_t audio_dma_ring_produce()
+{
+    // avoid a modulo here, this runs in the DMA interrupt and the depth is not necessarily a power of 2
+    fill_idx = (fill_idx + 1 == depth) ? 0 : fill_idx + 1;
+
+    num_blocks_produced += 1;
+    stats.num_blocks_produced = num_blocks_produced;
+
+    const uint32_t occupancy = num_blocks_produced - num_blocks_consumed;
+
+    if (occupancy > stats.peak_occupancy_in_blocks)
+    {
+        stats.peak_occupancy_in_blocks = occupancy;
+    }
+
+    if (occupancy >= 2 && !stall_in_progress)
+    {
+        stall_start_block = num_blocks_produced;
+        stall_in_progress = true;
+        stats.num_stalls += 1;
+    }
+
+    // the block we are about to fill is the oldest one still waiting to be consumed
+    // this runs once per block in the DMA interrupt, so it marks the time each block was done
+    trace_log_event(TRACE_LOG_EVENT_DMA_BLOCK_DONE, (uint16_t)occupancy);
+
+    if (occupancy >= depth)
+    {
+        overrun_occured = true;
+        stats.num_overruns += 1;
+        trace_log_event(TRACE_LOG_EVENT_DMA_OVERRUN, (uint16_t)occupancy);
+    }
+
+    return fill_idx;
+}
+
+uint32_t audio_dma_ring_consume()
+{
+    const uint32_t retval = read_idx;
+    read_idx = (read_idx + 1 == depth) ? 0 : read_idx + 1;
+
+    const uint32_t produced = num_blocks_produced;
+    const uint32_t lag = produced - num_blocks_consumed - 1;
+    stats.lag_histogram[lag < AUDIO_DMA_RING_LAG_HISTOGRAM_NUM_BINS ? lag : AUDIO_DMA_RING_LAG_HISTOGRAM_NUM_BINS - 1] += 1;
+
+    num_blocks_consumed += 1;
+    stats.num_blocks_consumed = num_blocks_consumed;
+
+    if (stall_in_progress && lag == 0)
+    {
+        const uint32_t drain_time = produced - stall_start_block;
+
+        stats.total_drain_time_in_blocks += drain_time;
+        if (drain_time > stats.max_drain_time_in_blocks)
+        {
+            stats.max_drain_time_in_blocks = drain_time;
+        }
+        stats.drain_time_histogram[drain_time < AUDIO_DMA_RING_DRAIN_HISTOGRAM_NUM_BINS ? drain_time : AUDIO_DMA_RING_DRAIN_HISTOGRAM_NUM_BINS - 1] += 1;
+
+        stall_in_progress = false;
+    }
+
+    return retval;
+}
+
+uint32_t audio_dma_ring_num_blocks_available()
+{
+    return num_blocks_produced - num_blocks_consumed;
+}
+
+bool audio_dma_ring_overrun_occured()
+{
+    return overrun_occured;
+}
+
+void audio_dma_ring_clear_overrun()
+{
+    overrun_occured = false;
+}
+
+const Audio_DMA_Ring_Stats_t *audio_dma_ring_get_stats()
+{
+    return &stats;
+}
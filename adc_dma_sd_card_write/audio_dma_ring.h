@@ -0,0 +1,112 @@
+/**
+ * @file      audio_dma_ring.h
+ * @brief     A software interface for the bookkeeping and telemetry of the audio DMA ring is represented here.
+ * @details   The big DMA buffer is split into a ring of DMA block sized chunks. The DMA interrupt (the producer) fills
+ *            one chunk at a time and the recording loop (the consumer) drains them. This module keeps track of which
+ *            chunks are full, and gathers statistics about how far the consumer lags behind the producer so that the
+ *            ring can be sized for a given SD card model instead of guessed. Each block produced, and each overrun, is
+ *            also recorded in the trace log, see trace_log.h.
+ *
+ *            This module does not touch any peripherals, so it can be unit tested and shared with host simulations.
+ */
+
+#ifndef AUDIO_DMA_RING_H_
+#define AUDIO_DMA_RING_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// lags and drain times at or beyond the last bin are lumped into the last bin of their histogram
+#define AUDIO_DMA_RING_LAG_HISTOGRAM_NUM_BINS (16)
+#define AUDIO_DMA_RING_DRAIN_HISTOGRAM_NUM_BINS (16)
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Statistics gathered over one recording are represented here. All times are in units of DMA block periods,
+ * multiply by `AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS` to get microseconds.
+ */
+typedef struct
+{
+    uint32_t depth_in_blocks;          /** The depth of the ring the stats were gathered with */
+    uint32_t num_blocks_produced;      /** The number of blocks filled by the DMA */
+    uint32_t num_blocks_consumed;      /** The number of blocks consumed by the recording loop */
+    uint32_t peak_occupancy_in_blocks; /** The largest number of full blocks waiting to be consumed at one time */
+    uint32_t num_overruns;             /** The number of times the DMA started filling a block that was not consumed */
+
+    /** `lag_histogram[n]` is the number of blocks consumed while `n` more full blocks were waiting behind them */
+    uint32_t lag_histogram[AUDIO_DMA_RING_LAG_HISTOGRAM_NUM_BINS];
+
+    uint32_t num_stalls;                 /** The number of times the consumer fell a whole block or more behind */
+    uint32_t max_drain_time_in_blocks;   /** The longest time from the start of a stall until the ring was empty */
+    uint32_t total_drain_time_in_blocks; /** The sum of all drain times, divide by `num_stalls` for the mean */
+
+    /** `drain_time_histogram[n]` is the number of stalls that took `n` block periods to drain */
+    uint32_t drain_time_histogram[AUDIO_DMA_RING_DRAIN_HISTOGRAM_NUM_BINS];
+} Audio_DMA_Ring_Stats_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `audio_dma_ring_reset(d)` empties the ring, sets its depth to `d` blocks, and clears all statistics.
+ *
+ * @pre the producer is not running, i.e. the DMA is stopped.
+ *
+ * @param depth_in_blocks the number of DMA blocks in the ring, must be at least 2.
+ *
+ * @post the ring is empty, the next block to be filled is block 0, the overrun flag and the statistics are cleared.
+ */
+void audio_dma_ring_reset(uint32_t depth_in_blocks);
+
+/**
+ * @brief `audio_dma_ring_get_depth()` is the number of DMA blocks in the ring.
+ */
+uint32_t audio_dma_ring_get_depth();
+
+/**
+ * @brief `audio_dma_ring_produce()` marks the block currently being filled as full and is the index of the block to
+ * fill next. This is meant to be called from the DMA interrupt each time a block is complete.
+ *
+ * @post the number of available blocks grows by 1, the overrun flag is set if the next block to fill is still waiting
+ * to be consumed.
+ *
+ * @retval the index in [0, depth) of the next block the DMA should fill.
+ */
+uint32_t audio_dma_ring_produce();
+
+/**
+ * @brief `audio_dma_ring_consume()` is the index of the oldest full block, and marks it as consumed.
+ *
+ * @pre at least one block is available.
+ *
+ * @post the number of available blocks shrinks by 1.
+ *
+ * @retval the index in [0, depth) of the block to read from.
+ */
+uint32_t audio_dma_ring_consume();
+
+/**
+ * @brief `audio_dma_ring_num_blocks_available()` is the number of full blocks waiting to be consumed.
+ */
+uint32_t audio_dma_ring_num_blocks_available();
+
+/**
+ * @brief `audio_dma_ring_overrun_occured()` is true if the producer caught up with the consumer since the last reset.
+ */
+bool audio_dma_ring_overrun_occured();
+
+/**
+ * @brief `audio_dma_ring_clear_overrun()` clears the overrun flag, the overrun count in the statistics is kept.
+ */
+void audio_dma_ring_clear_overrun();
+
+/**
+ * @brief `audio_dma_ring_get_stats()` is a pointer to the statistics gathered since the last reset.
+ */
+const Audio_DMA_Ring_Stats_t *audio_dma_ring_get_stats();
+
+#endif /* AUDIO_DMA_RING_H_ */
@@ -0,0 +1,26 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "cycle_counter.h"
+#include "mxc_device.h"
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void cycle_counter_init()
+{
+    // the DWT is part of the debug and trace unit, which is off until trace is enabled
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t cycle_counter_now()
+{
+    return DWT->CYCCNT;
+}
+
+uint32_t cycle_counter_freq_hz()
+{
+    return SystemCoreClock;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file      cycle_counter.h
+ * @brief     A software module for reading a free running clock for timestamps is represented here.
+ * @details   On the MAX32666 this is the DWT cycle counter of the Cortex-M4 core, which counts every cycle of the core
+ *            clock and wraps around about every 44 seconds at 96MHz. Reading it takes a single load, so it can be used
+ *            to timestamp events from interrupts without disturbing them. Host simulations provide their own version
+ *            of this module with a clock of their own.
+ */
+
+#ifndef CYCLE_COUNTER_H_
+#define CYCLE_COUNTER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `cycle_counter_init()` starts the cycle counter from 0.
+ *
+ * @post `cycle_counter_now()` counts up at `cycle_counter_freq_hz()`.
+ */
+void cycle_counter_init();
+
+/**
+ * @brief `cycle_counter_now()` is the number of cycles since the counter was started, modulo 2^32.
+ */
+uint32_t cycle_counter_now();
+
+/**
+ * @brief `cycle_counter_freq_hz()` is the number of times a second the cycle counter counts up.
+ */
+uint32_t cycle_counter_freq_hz();
+
+#endif /* CYCLE_COUNTER_H_ */
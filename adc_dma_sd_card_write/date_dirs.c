@@ -0,0 +1,165 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <ctype.h>
+#include <string.h>
+
+#include "date_dirs.h"
+#include "sd_card.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the lengths of "YYYY", "YYYY/MM", and "YYYY/MM/DD"
+#define YEAR_PATH_LEN (4)
+#define MONTH_PATH_LEN (7)
+#define DAY_PATH_LEN (10)
+
+// long enough for the name of any directory entry we care about, longer names are cut short and don't match
+#define DIR_ENTRY_NAME_BUFF_LEN (16)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the day the directories were last made for, if any
+static bool is_day_known = false;
+static int known_year;
+static int known_month;
+static int known_day;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `make_dir(p, l)` makes the directory named by the first `l` chars of path `p`.
+ */
+static void make_dir(const char *path, size_t len);
+
+/**
+ * @brief `find_latest_entry(p, l, n)` finds the directory in directory `p` with the greatest name of `l` digits, and
+ * stores its name in `n`, which must be at least `l + 1` chars long.
+ *
+ * @retval true if there is one, false if there is none or the card failed.
+ */
+static bool find_latest_entry(const char *path, size_t name_len, char *name_buff);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+size_t date_dirs_make(const tm_t *time, char *path_buff)
+{
+    const size_t len = strftime(path_buff, DATE_DIRS_PREFIX_LEN + 1, "%Y/%m/%d/", time);
+
+    // a new year needs a new month and day too, and a new month a new day
+    const bool is_new_year = !is_day_known || time->tm_year != known_year;
+    const bool is_new_month = is_new_year || time->tm_mon != known_month;
+    const bool is_new_day = is_new_month || time->tm_mday != known_day;
+
+    // the directories may already be there from an earlier recording, if the card failed the file won't open either
+    if (is_new_year)
+    {
+        make_dir(path_buff, YEAR_PATH_LEN);
+    }
+    if (is_new_month)
+    {
+        make_dir(path_buff, MONTH_PATH_LEN);
+    }
+    if (is_new_day)
+    {
+        make_dir(path_buff, DAY_PATH_LEN);
+    }
+
+    is_day_known = true;
+    known_year = time->tm_year;
+    known_month = time->tm_mon;
+    known_day = time->tm_mday;
+
+    return len;
+}
+
+void date_dirs_forget()
+{
+    is_day_known = false;
+}
+
+bool date_dirs_find_latest(const char *base, char *path_buff)
+{
+    // the year, then the month in it, then the day in that, each the greatest by name
+    const size_t name_lens[] = {4, 2, 2};
+
+    strcpy(path_buff, base);
+    size_t len = strlen(path_buff);
+
+    for (size_t i = 0; i < sizeof(name_lens) / sizeof(name_lens[0]); i++)
+    {
+        char name[DIR_ENTRY_NAME_BUFF_LEN];
+        if (!find_latest_entry(path_buff, name_lens[i], name))
+        {
+            return false;
+        }
+
+        if (len == 0 || path_buff[len - 1] != '/')
+        {
+            path_buff[len++] = '/';
+        }
+        strcpy(path_buff + len, name);
+        len += name_lens[i];
+    }
+
+    return true;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void make_dir(const char *path, size_t len)
+{
+    char dir_path[DATE_DIRS_PREFIX_LEN + 1];
+
+    memcpy(dir_path, path, len);
+    dir_path[len] = '\0';
+
+    sd_card_mkdir(dir_path);
+}
+
+bool find_latest_entry(const char *path, size_t name_len, char *name_buff)
+{
+    if (sd_card_opendir(path) != SD_CARD_ERROR_ALL_OK)
+    {
+        return false;
+    }
+
+    bool is_found = false;
+
+    while (true)
+    {
+        char name[DIR_ENTRY_NAME_BUFF_LEN];
+        bool is_dir;
+
+        if (sd_card_readdir(name, sizeof(name), &is_dir) != SD_CARD_ERROR_ALL_OK)
+        {
+            is_found = false;
+            break;
+        }
+
+        if (name[0] == '\0')
+        {
+            break;
+        }
+
+        if (!is_dir || strlen(name) != name_len)
+        {
+            continue;
+        }
+
+        bool is_all_digits = true;
+        for (size_t i = 0; i < name_len; i++)
+        {
+            is_all_digits = is_all_digits && isdigit((unsigned char)name[i]);
+        }
+
+        // names of the same number of digits sort the same way as the numbers
+        if (is_all_digits && (!is_found || strcmp(name, name_buff) > 0))
+        {
+            strcpy(name_buff, name);
+            is_found = true;
+        }
+    }
+
+    return sd_card_closedir() == SD_CARD_ERROR_ALL_OK && is_found;
+}
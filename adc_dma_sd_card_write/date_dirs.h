@@ -0,0 +1,66 @@
+/**
+ * @file      date_dirs.h
+ * @brief     A software module for keeping recordings in a directory for each day is represented here.
+ * @details   FatFS finds a file by reading its directory entry by entry, so the time `f_open()` takes to create a file
+ *            grows with the number of files already next to it. A deployment recording 5 minute files makes 288 of them
+ *            a day, and tens of thousands over a few months. This module puts each file in a `YYYY/MM/DD/` directory
+ *            under the current directory instead, so no directory holds more than a day of files, and the year and
+ *            month directories only ever hold a handful of entries.
+ *
+ *            The directories are made with `sd_card_mkdir()` the first time a file of a new day is named, and the day
+ *            is remembered, so a recording only makes directories when it runs past midnight. The paths are relative,
+ *            the current directory is left as it is.
+ */
+
+#ifndef DATE_DIRS_H_
+#define DATE_DIRS_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "time_helpers.h"
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// the length of a "YYYY/MM/DD/" path prefix, without the terminating null
+#define DATE_DIRS_PREFIX_LEN (11)
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `date_dirs_make(t, b)` writes the "YYYY/MM/DD/" directory of the day of time `t` into string buffer `b`, and
+ * makes any of those directories that weren't made for the last day, relative to the current directory.
+ *
+ * @param time the time of the file to keep in the directory, `time` is not mutated.
+ *
+ * @param path_buff a c-style string buffer to write the directory into, must be at least `DATE_DIRS_PREFIX_LEN + 1`
+ * chars long.
+ *
+ * @post the directories exist, unless the card failed, which the file opened in them then reports.
+ *
+ * @retval the number of chars written into `path_buff`, `DATE_DIRS_PREFIX_LEN`.
+ */
+size_t date_dirs_make(const tm_t *time, char *path_buff);
+
+/**
+ * @brief `date_dirs_forget()` forgets the last day the directories were made for, so the next `date_dirs_make()` makes
+ * them all. Call this whenever the current directory or the mounted card changes.
+ */
+void date_dirs_forget();
+
+/**
+ * @brief `date_dirs_find_latest(b, p)` finds the latest day directory under directory `b`, going by the names of the
+ * year, month, and day directories, for finding the recording a power cut may have left unfinished.
+ *
+ * @param base the directory to look in, e.g. "/" or "/384k-24bit".
+ *
+ * @param path_buff a c-style string buffer to write the path of the day directory into, `b` followed by the
+ * "YYYY/MM/DD", must be at least `strlen(b) + DATE_DIRS_PREFIX_LEN + 1` chars long.
+ *
+ * @retval true if there is a day directory, false if there is none or the card failed.
+ */
+bool date_dirs_find_latest(const char *base, char *path_buff);
+
+#endif /* DATE_DIRS_H_ */
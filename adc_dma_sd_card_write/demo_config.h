@@ -8,34 +8,119 @@
 
 /* Includes ----------------------------------------------------------------------------------------------------------*/
 
+#include "afe_control.h"
 #include "wav_header.h"
 
 /* Public defines ----------------------------------------------------------------------------------------------------*/
 
-// set to 1 to generate a CSV file of the durations of each DMA block filter/SD-write event
-#define DEMO_CONFIG_GENERATE_CSV_OF_WRITE_TIMES (0)
+// set to 1 to keep a binary trace of the DMA interrupts, the processing of each DMA block, the SD card writes and any
+// overruns of every recording, appended to the file below, decode it with test/profiling_tests/trace_decode.py
+#define DEMO_CONFIG_WRITE_TRACE_LOG (1)
+#define DEMO_CONFIG_TRACE_LOG_FILE_NAME ("/trace_log.bin")
 
-// the length of the WAVE file to write to the SD card, a positive integer, long file durations will tale a long time to write
-// max value 4k seconds, about 70 minutes (we will remove this limitation in the final code, limited for the demo for simplicity).
+// set to 1 to time each stage of the processing of a DMA block and each SD card write with the cycle counter, and append
+// the min, mean, 99th percentile and max time of each stage, and the number of times it went over its budget, to a CSV
+// file after each recording, 0 compiles the profiling out
+#define DEMO_CONFIG_PROFILE_STAGES (1)
+
+// set to 1 to append a row of DMA ring occupancy statistics to a CSV file after each recording
+#define DEMO_CONFIG_GENERATE_CSV_OF_DMA_RING_STATS (0)
+
+// set to 1 to sleep the core until the next interrupt whenever the scheduler has nothing to run, such as between DMA
+// blocks, 0 to spin instead
+#define DEMO_CONFIG_SLEEP_WHEN_IDLE (1)
+
+// set to 1 to append a row with the time the core was awake during each recording, and its share of the length of the
+// recording, to a CSV file after each recording
+#define DEMO_CONFIG_GENERATE_CSV_OF_DUTY_CYCLE (1)
+
+// set to 1 to allocate each WAVE file contiguously up front and stream the audio straight to its sectors, 0 to let
+// FatFS grow the file one cluster at a time
+#define DEMO_CONFIG_PREALLOCATE_FILES (1)
+
+// set above 0 to gather the writes of each file into clusters of the SD card, or units of this many bytes if clusters
+// are longer, at most 32768, so low sample rates send a few big writes instead of one small write per DMA block, 0 to
+// send each processed DMA block to the card as it comes
+#define DEMO_CONFIG_SD_CARD_WRITE_UNIT_IN_BYTES (32768)
+
+// set above 0 to rewrite the header of each file with the audio written so far and sync the file every this many
+// seconds of audio, so a power cut loses at most this much, 0 to only write the header when the file is opened
+#define DEMO_CONFIG_CHECKPOINT_INTERVAL_IN_SECONDS (10)
+
+// the length of the WAVE file to write to the SD card, a positive integer, long file durations will take a long time to write.
+// Files are exactly this many seconds of samples long, files that don't fit in a plain WAVE file are written as RF64, and
+// FLAC files must be under 2^36 samples, about 49 hours at 384kHz
 #define DEMO_CONFIG_AUDIO_FILE_LEN_IN_SECONDS (5)
 
+// set to 1 to compress each file losslessly into a FLAC stream named .flac instead of writing a WAVE file, with the
+// checkpoint interval above counted in bytes of FLAC frames, so compressed files are synced less often
+#define DEMO_CONFIG_COMPRESS_FLAC (0)
+
+// set to 1 to write the DMA blocks to the card untouched, as the big-endian packed 24 bit samples at 384kHz the ADC
+// sends, into files named .raw with a .txt sidecar of their metadata, which costs the least CPU per block, and decide on
+// the sample rate and bit depth later with test/raw_convert. Only the 384kHz 24 bit combination is recorded
+#define DEMO_CONFIG_RAW_CAPTURE (0)
+
+// set to 1 to add a Broadcast Wave bext chunk to each file, with the time of its first sample to the sample
+#define DEMO_CONFIG_WRITE_BROADCAST_WAVE_CHUNK (1)
+
+// set above 1 to record this many back to back files of DEMO_CONFIG_AUDIO_FILE_LEN_IN_SECONDS each for every sample rate
+// and bit depth, without stopping the ADC/DMA between them, the files are named after the time on the real time clock
+#define DEMO_CONFIG_NUM_FILES_PER_RECORDING (1)
+
+// set to 1 to keep the files named after the time in a YYYY/MM/DD/ directory for the day they start, so directories stay
+// small over a long deployment and FatFS opens files just as fast at the end of it, 0 to keep them all side by side
+#define DEMO_CONFIG_SHARD_FILES_BY_DATE (1)
+
+// set to 1 to record onto the 6 cards of the SD card bank in turn, moving on to the next card at a file boundary when
+// the mounted one is full, 0 to record onto the FTHR2 SD card slot
+#define DEMO_CONFIG_USE_SD_CARD_BANK (0)
+
+// set to 1 to sync the real time clock to GNSS time from a task that runs alongside the recordings, with a timeout for
+// each sync in case the GNSS module has no fix or isn't plugged in, and the time between the end of one sync and the
+// start of the next, 0 for a single sync at boot
+#define DEMO_CONFIG_SYNC_RTC_TO_GNSS (1)
+#define DEMO_CONFIG_GNSS_SYNC_TIMEOUT_IN_SECONDS (120)
+#define DEMO_CONFIG_GNSS_RESYNC_PERIOD_IN_SECONDS (3600)
+
+// set to 1 to set the gain of the AFE channel from a task that runs alongside the recordings, and to read it back every
+// check period to set it again if it was lost
+#define DEMO_CONFIG_CONTROL_AFE_GAIN (1)
+#define DEMO_CONFIG_AFE_GAIN (AFE_CONTROL_GAIN_20dB)
+#define DEMO_CONFIG_AFE_GAIN_CHECK_PERIOD_IN_SECONDS (10)
+
+#if DEMO_CONFIG_RAW_CAPTURE == 1
+// the raw stream only comes in the one sample rate and bit depth
+static const Wave_Header_Sample_Rate_t demo_sample_rates_to_test[] = {
+    WAVE_HEADER_SAMPLE_RATE_384kHz,
+};
+#else
 // comment or uncomment sample rates to add them to the test
-const Wave_Header_Sample_Rate_t demo_sample_rates_to_test[] = {
+static const Wave_Header_Sample_Rate_t demo_sample_rates_to_test[] = {
     WAVE_HEADER_SAMPLE_RATE_24kHz,
     WAVE_HEADER_SAMPLE_RATE_48kHz,
     WAVE_HEADER_SAMPLE_RATE_96kHz,
     WAVE_HEADER_SAMPLE_RATE_192kHz,
     WAVE_HEADER_SAMPLE_RATE_384kHz,
 };
+#endif
 
-const uint32_t DEMO_CONFIG_NUM_SAMPLE_RATES_TO_TEST = sizeof(demo_sample_rates_to_test) / sizeof(demo_sample_rates_to_test[0]);
+static const uint32_t DEMO_CONFIG_NUM_SAMPLE_RATES_TO_TEST = sizeof(demo_sample_rates_to_test) / sizeof(demo_sample_rates_to_test[0]);
 
-// comment or uncomment bit depths to add them to the test
-const Wave_Header_Bits_Per_Sample_t demo_bit_depths_to_test[] = {
+#if DEMO_CONFIG_RAW_CAPTURE == 1
+static const Wave_Header_Bits_Per_Sample_t demo_bit_depths_to_test[] = {
+    WAVE_HEADER_24_BITS_PER_SAMPLE,
+};
+#else
+// comment or uncomment bit depths to add them to the test, 4 bit IMA ADPCM files are a quarter the size of 16 bit ones
+// but lossy, and can't be compressed with FLAC
+static const Wave_Header_Bits_Per_Sample_t demo_bit_depths_to_test[] = {
     WAVE_HEADER_16_BITS_PER_SAMPLE,
     WAVE_HEADER_24_BITS_PER_SAMPLE,
+    // WAVE_HEADER_4_BITS_PER_SAMPLE_IMA_ADPCM,
 };
+#endif
 
-const uint32_t DEMO_CONFIG_NUM_BIT_DEPTHS_TO_TEST = sizeof(demo_bit_depths_to_test) / sizeof(demo_bit_depths_to_test[0]);
+static const uint32_t DEMO_CONFIG_NUM_BIT_DEPTHS_TO_TEST = sizeof(demo_bit_depths_to_test) / sizeof(demo_bit_depths_to_test[0]);
 
 #endif /* DEMO_CONFIG_H_ */
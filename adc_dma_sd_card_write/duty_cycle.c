@@ -0,0 +1,63 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "duty_cycle.h"
+#include "cycle_counter.h"
+#include "hal_sleep.h"
+#include "hal_timer.h"
+#include "scheduler.h"
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// only touched from the main loop
+static uint64_t awake_cycles = 0;
+static uint32_t wake_cycles = 0;
+static uint32_t num_sleeps = 0;
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void duty_cycle_reset()
+{
+    awake_cycles = 0;
+    wake_cycles = cycle_counter_now();
+    num_sleeps = 0;
+}
+
+void duty_cycle_sleep_while_idle()
+{
+    // an interrupt that posts an event after this check still wakes the core at once, see hal_sleep.h
+    hal_sleep_mask_interrupts();
+
+    if (scheduler_is_idle())
+    {
+        awake_cycles += cycle_counter_now() - wake_cycles;
+
+        // no timer needs the tick until the next one is due, so it doesn't wake the core every period until then, and
+        // the clock of the scheduler is caught up with the periods it held off when the core wakes, whatever woke it
+        const uint32_t millisecs_to_next_timer = scheduler_get_millisecs_to_next_timer();
+        hal_timer_suppress_tick(millisecs_to_next_timer < UINT32_MAX / 1000 ? millisecs_to_next_timer * 1000 : UINT32_MAX);
+
+        hal_sleep_wait_for_interrupt();
+
+        hal_timer_resume_tick();
+
+        // the interrupt that woke the core runs once they are unmasked, and counts as awake
+        wake_cycles = cycle_counter_now();
+        num_sleeps += 1;
+    }
+
+    hal_sleep_unmask_interrupts();
+}
+
+uint64_t duty_cycle_awake_microsecs()
+{
+    // the core is awake now, so the time since it last woke up counts too
+    const uint64_t cycles = awake_cycles + (cycle_counter_now() - wake_cycles);
+
+    return (cycles * 1000000) / cycle_counter_freq_hz();
+}
+
+uint32_t duty_cycle_num_sleeps()
+{
+    return num_sleeps;
+}
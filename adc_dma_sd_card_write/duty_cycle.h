@@ -0,0 +1,53 @@
+/**
+ * @file      duty_cycle.h
+ * @brief     A software module for sleeping the core while the scheduler has nothing to run, and measuring how much of
+ *            the time it is awake, is represented here.
+ * @details   `duty_cycle_sleep_while_idle()` is the idle hook of the scheduler. Between DMA blocks the main loop has
+ *            nothing to do until the block ready callback posts the next chunk to the write task, so rather than spin
+ *            it sleeps until an interrupt, see `hal_sleep.h`. At low sample rates the processing and writing of a block
+ *            only take a few milliseconds of each block period, so the core sleeps for most of it. While it sleeps the
+ *            tick of the scheduler is held off until the next software timer is due, see `hal_timer.h`, so it is
+ *            woken about once per DMA block rather than by each of the ~21 ticks of a block period.
+ *
+ *            The time awake is counted with the cycle counter from each wake-up to the next time the core goes to
+ *            sleep, which includes every interrupt that ran meanwhile, so it holds whether or not the cycle counter
+ *            keeps counting while the core sleeps. A stretch awake longer than the wrap of the cycle counter, about 44
+ *            seconds at 96MHz, is undercounted, the recording loop sleeps every block so it never gets near that.
+ */
+
+#ifndef DUTY_CYCLE_H_
+#define DUTY_CYCLE_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `duty_cycle_reset()` starts counting the time awake from now, and forgets the number of sleeps.
+ *
+ * @pre the cycle counter is running, see cycle_counter.h, and it is called from the main loop.
+ */
+void duty_cycle_reset();
+
+/**
+ * @brief `duty_cycle_sleep_while_idle()` sleeps the core until the next interrupt if the scheduler has nothing to run,
+ * holding off the tick until the next timer is due, and counts the time awake up to now. Set it as the idle hook with
+ * `scheduler_set_idle_hook()`.
+ *
+ * @pre called from the main loop, and the tick of `hal_timer.h` moves the clock of the scheduler on.
+ */
+void duty_cycle_sleep_while_idle();
+
+/**
+ * @brief `duty_cycle_awake_microsecs()` is the time the core was awake since the last reset, in microseconds.
+ */
+uint64_t duty_cycle_awake_microsecs();
+
+/**
+ * @brief `duty_cycle_num_sleeps()` is the number of times the core went to sleep since the last reset.
+ */
+uint32_t duty_cycle_num_sleeps();
+
+#endif /* DUTY_CYCLE_H_ */
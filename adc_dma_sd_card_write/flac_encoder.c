@@ -0,0 +1,593 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flac_encoder.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the FLAC fixed predictors go up to order 4
+#define MAX_FIXED_ORDER (4)
+
+// a 384kHz DMA block is 8256 = 129 * 2^6 samples, so it splits into at most 64 partitions of 129 samples, finer
+// partitions would cost more time to search than they save space
+#define MAX_PARTITION_ORDER (6)
+#define MAX_NUM_PARTITIONS (1 << MAX_PARTITION_ORDER)
+
+// the largest Rice parameters the 4 and 5 bit parameter fields can hold, all ones is the escape code which we don't use
+#define MAX_RICE_PARAM_4_BIT (14)
+#define MAX_RICE_PARAM_5_BIT (30)
+
+#define RESIDUAL_CODING_RICE_4_BIT (0)
+#define RESIDUAL_CODING_RICE_5_BIT (1)
+
+#define STREAMINFO_LEN_IN_BYTES (34)
+#define METADATA_BLOCK_TYPE_STREAMINFO (0)
+
+// 14 sync bits, a reserved 0 bit, and the blocking strategy bit set for variable block sizes
+#define FRAME_SYNC_CODE_VARIABLE_BLOCK_SIZE (0xFFF9)
+
+// the block size follows the coded sample number as 8 or 16 bits holding the block size minus 1
+#define BLOCK_SIZE_CODE_8_BIT (0x6)
+#define BLOCK_SIZE_CODE_16_BIT (0x7)
+
+// we always take the sample rate from the STREAMINFO block, there are no codes for 384kHz
+#define SAMPLE_RATE_CODE_FROM_STREAMINFO (0x0)
+
+#define CHANNEL_ASSIGNMENT_MONO (0x0)
+
+#define SAMPLE_SIZE_CODE_16_BIT (0x4)
+#define SAMPLE_SIZE_CODE_24_BIT (0x6)
+
+// subframe headers are a zero bit, the 6 bit type, and the wasted bits flag, which we never set
+#define SUBFRAME_HEADER_VERBATIM (0x01 << 1)
+#define SUBFRAME_HEADER_FIXED(order) ((0x08 | (order)) << 1)
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A writer of big-endian bit fields into a byte buffer is represented here. Nothing is stored past the end of
+ * the buffer, but the length keeps counting so running out of room can be detected afterwards.
+ */
+typedef struct
+{
+    uint8_t *dest;
+    uint32_t max_len_in_bytes;
+    uint32_t len_in_bytes; // whole bytes written so far
+    uint64_t bits;         // the low `num_bits` bits are not written out yet
+    uint32_t num_bits;     // always less than 8 between calls
+} Bit_Writer_t;
+
+/**
+ * @brief The Rice coding of the residual of a subframe is represented here, one parameter per partition.
+ */
+typedef struct
+{
+    uint32_t partition_order;
+    uint32_t coding_method;
+    uint8_t params[MAX_NUM_PARTITIONS];
+} Rice_Coding_t;
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// CRC-8 with polynomial x^8 + x^2 + x + 1, a nibble at a time, it only runs over the few bytes of a frame header
+static const uint8_t crc8_nibble_table[16] = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D};
+
+// CRC-16 with polynomial x^16 + x^15 + x^2 + 1, a byte at a time, it runs over every byte of a frame so the bigger table
+// pays for itself
+static const uint16_t crc16_table[256] = {
+    0x0000, 0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011,
+    0x8033, 0x0036, 0x003C, 0x8039, 0x0028, 0x802D, 0x8027, 0x0022,
+    0x8063, 0x0066, 0x006C, 0x8069, 0x0078, 0x807D, 0x8077, 0x0072,
+    0x0050, 0x8055, 0x805F, 0x005A, 0x804B, 0x004E, 0x0044, 0x8041,
+    0x80C3, 0x00C6, 0x00CC, 0x80C9, 0x00D8, 0x80DD, 0x80D7, 0x00D2,
+    0x00F0, 0x80F5, 0x80FF, 0x00FA, 0x80EB, 0x00EE, 0x00E4, 0x80E1,
+    0x00A0, 0x80A5, 0x80AF, 0x00AA, 0x80BB, 0x00BE, 0x00B4, 0x80B1,
+    0x8093, 0x0096, 0x009C, 0x8099, 0x0088, 0x808D, 0x8087, 0x0082,
+    0x8183, 0x0186, 0x018C, 0x8189, 0x0198, 0x819D, 0x8197, 0x0192,
+    0x01B0, 0x81B5, 0x81BF, 0x01BA, 0x81AB, 0x01AE, 0x01A4, 0x81A1,
+    0x01E0, 0x81E5, 0x81EF, 0x01EA, 0x81FB, 0x01FE, 0x01F4, 0x81F1,
+    0x81D3, 0x01D6, 0x01DC, 0x81D9, 0x01C8, 0x81CD, 0x81C7, 0x01C2,
+    0x0140, 0x8145, 0x814F, 0x014A, 0x815B, 0x015E, 0x0154, 0x8151,
+    0x8173, 0x0176, 0x017C, 0x8179, 0x0168, 0x816D, 0x8167, 0x0162,
+    0x8123, 0x0126, 0x012C, 0x8129, 0x0138, 0x813D, 0x8137, 0x0132,
+    0x0110, 0x8115, 0x811F, 0x011A, 0x810B, 0x010E, 0x0104, 0x8101,
+    0x8303, 0x0306, 0x030C, 0x8309, 0x0318, 0x831D, 0x8317, 0x0312,
+    0x0330, 0x8335, 0x833F, 0x033A, 0x832B, 0x032E, 0x0324, 0x8321,
+    0x0360, 0x8365, 0x836F, 0x036A, 0x837B, 0x037E, 0x0374, 0x8371,
+    0x8353, 0x0356, 0x035C, 0x8359, 0x0348, 0x834D, 0x8347, 0x0342,
+    0x03C0, 0x83C5, 0x83CF, 0x03CA, 0x83DB, 0x03DE, 0x03D4, 0x83D1,
+    0x83F3, 0x03F6, 0x03FC, 0x83F9, 0x03E8, 0x83ED, 0x83E7, 0x03E2,
+    0x83A3, 0x03A6, 0x03AC, 0x83A9, 0x03B8, 0x83BD, 0x83B7, 0x03B2,
+    0x0390, 0x8395, 0x839F, 0x039A, 0x838B, 0x038E, 0x0384, 0x8381,
+    0x0280, 0x8285, 0x828F, 0x028A, 0x829B, 0x029E, 0x0294, 0x8291,
+    0x82B3, 0x02B6, 0x02BC, 0x82B9, 0x02A8, 0x82AD, 0x82A7, 0x02A2,
+    0x82E3, 0x02E6, 0x02EC, 0x82E9, 0x02F8, 0x82FD, 0x82F7, 0x02F2,
+    0x02D0, 0x82D5, 0x82DF, 0x02DA, 0x82CB, 0x02CE, 0x02C4, 0x82C1,
+    0x8243, 0x0246, 0x024C, 0x8249, 0x0258, 0x825D, 0x8257, 0x0252,
+    0x0270, 0x8275, 0x827F, 0x027A, 0x826B, 0x026E, 0x0264, 0x8261,
+    0x0220, 0x8225, 0x822F, 0x022A, 0x823B, 0x023E, 0x0234, 0x8231,
+    0x8213, 0x0216, 0x021C, 0x8219, 0x0208, 0x820D, 0x8207, 0x0202};
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `put_bits(w, b, n)` writes the low `n` bits of `b` to bit writer `w`, `n` is at most 32 and the rest of `b`
+ * must be zero.
+ */
+static inline void put_bits(Bit_Writer_t *writer, uint32_t bits, uint32_t num_bits);
+
+/**
+ * @brief `put_rice(w, u, k)` writes folded residual `u` to bit writer `w` as a Rice code with parameter `k`.
+ */
+static inline void put_rice(Bit_Writer_t *writer, uint32_t folded, uint32_t param);
+
+/**
+ * @brief `read_sample(s, i, b)` is sample `i` of the packed little-endian samples of `b` bytes each in `s`.
+ */
+static inline int32_t read_sample(const uint8_t *src, uint32_t idx, uint32_t bytes_per_sample);
+
+/**
+ * @brief `next_residual(x, d, o)` is the residual of the fixed predictor of order `o` for the next sample `x`, given
+ * the differences `d` of the samples before it, which are updated to include `x`.
+ */
+static inline int32_t next_residual(int32_t sample, int32_t *diffs, uint32_t order);
+
+/**
+ * @brief `fold(e)` maps signed residual `e` to an unsigned value for Rice coding, 0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+ */
+static inline uint32_t fold(int32_t residual);
+
+/**
+ * @brief `best_fixed_order(s, n, b)` is the order of the fixed predictor that leaves the smallest total residual for
+ * the `n` samples of `b` bytes each in `s`.
+ */
+static uint32_t best_fixed_order(const uint8_t *src, uint32_t num_samples, uint32_t bytes_per_sample);
+
+/**
+ * @brief `plan_rice_coding(s, n, b, o, c)` works out the partition order and Rice parameters that code the residual of
+ * the fixed predictor of order `o` for the `n` samples of `b` bytes each in `s` in the fewest bits, and stores them in
+ * `c`.
+ */
+static void plan_rice_coding(const uint8_t *src, uint32_t num_samples, uint32_t bytes_per_sample, uint32_t order, Rice_Coding_t *coding);
+
+/**
+ * @brief `rice_param(s, n)` is the Rice parameter for `n` folded residuals that add up to `s`, about the log2 of their
+ * mean.
+ */
+static uint32_t rice_param(uint64_t sum, uint32_t num_residuals);
+
+/**
+ * @brief `write_frame_header(w, n, b, f)` writes the header of a frame of `n` samples of `b` bits, starting at sample
+ * `f`, to bit writer `w`, including its CRC-8.
+ */
+static void write_frame_header(Bit_Writer_t *writer, uint32_t num_samples, uint32_t bits_per_sample, uint64_t first_sample_number);
+
+/**
+ * @brief `write_fixed_subframe(w, s, n, b, o, c)` writes the `n` samples of `b` bytes each in `s` to bit writer `w` as
+ * a fixed subframe of order `o` with Rice coding `c`. It stops early if `w` runs out of room.
+ */
+static void write_fixed_subframe(Bit_Writer_t *writer, const uint8_t *src, uint32_t num_samples, uint32_t bytes_per_sample, uint32_t order, const Rice_Coding_t *coding);
+
+/**
+ * @brief `write_verbatim_subframe(d, s, n, b)` stores the `n` samples of `b` bytes each in `s` into `d` as a verbatim
+ * subframe and is the number of bytes stored.
+ */
+static uint32_t write_verbatim_subframe(uint8_t *dest, const uint8_t *src, uint32_t num_samples, uint32_t bytes_per_sample);
+
+/**
+ * @brief `crc8(d, n)` is the FLAC CRC-8 of the `n` bytes in `d`.
+ */
+static uint8_t crc8(const uint8_t *data, uint32_t len);
+
+/**
+ * @brief `crc16(d, n)` is the FLAC CRC-16 of the `n` bytes in `d`.
+ */
+static uint16_t crc16(const uint8_t *data, uint32_t len);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+uint32_t flac_encoder_write_stream_header(const Flac_Encoder_Stream_Info_t *info, uint8_t *dest)
+{
+    Bit_Writer_t writer = {.dest = dest, .max_len_in_bytes = FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES};
+
+    put_bits(&writer, ('f' << 24) | ('L' << 16) | ('a' << 8) | 'C', 32);
+
+    // the STREAMINFO block is the last metadata block
+    put_bits(&writer, 1, 1);
+    put_bits(&writer, METADATA_BLOCK_TYPE_STREAMINFO, 7);
+    put_bits(&writer, STREAMINFO_LEN_IN_BYTES, 24);
+
+    put_bits(&writer, FLAC_ENCODER_MIN_BLOCK_LEN_IN_SAMPLES, 16);
+    put_bits(&writer, info->max_block_len_in_samples, 16);
+    put_bits(&writer, 0, 24); // minimum frame length unknown
+    put_bits(&writer, 0, 24); // maximum frame length unknown
+    put_bits(&writer, info->sample_rate, 20);
+    put_bits(&writer, 0, 3); // one channel
+    put_bits(&writer, info->bits_per_sample - 1, 5);
+    put_bits(&writer, (uint32_t)(info->total_samples >> 32) & 0xF, 4);
+    put_bits(&writer, (uint32_t)info->total_samples, 32);
+
+    // the MD5 of the audio is unknown
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        put_bits(&writer, 0, 32);
+    }
+
+    return writer.len_in_bytes;
+}
+
+uint32_t flac_encoder_encode_frame(const uint8_t *src, uint32_t num_samples, uint32_t bits_per_sample, uint64_t first_sample_number, uint8_t *dest)
+{
+    const uint32_t bytes_per_sample = bits_per_sample / 8;
+
+    Bit_Writer_t writer = {.dest = dest, .max_len_in_bytes = FLAC_ENCODER_MAX_FRAME_LEN_IN_BYTES(num_samples, bits_per_sample)};
+
+    write_frame_header(&writer, num_samples, bits_per_sample, first_sample_number);
+    const uint32_t header_len = writer.len_in_bytes;
+
+    // the fixed subframe is only worth it if it is shorter than the verbatim one, so that's all the room we give it
+    writer.max_len_in_bytes = header_len + 1 + (num_samples * bytes_per_sample);
+
+    const uint32_t order = best_fixed_order(src, num_samples, bytes_per_sample);
+
+    Rice_Coding_t coding = {0};
+    plan_rice_coding(src, num_samples, bytes_per_sample, order, &coding);
+
+    write_fixed_subframe(&writer, src, num_samples, bytes_per_sample, order, &coding);
+
+    // pad the subframe out to a whole byte
+    if (writer.num_bits > 0)
+    {
+        put_bits(&writer, 0, 8 - writer.num_bits);
+    }
+
+    uint32_t len = writer.len_in_bytes;
+
+    if (len >= writer.max_len_in_bytes)
+    {
+        len = header_len + write_verbatim_subframe(dest + header_len, src, num_samples, bytes_per_sample);
+    }
+
+    const uint16_t crc = crc16(dest, len);
+    dest[len++] = (uint8_t)(crc >> 8);
+    dest[len++] = (uint8_t)crc;
+
+    return len;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void put_bits(Bit_Writer_t *writer, uint32_t bits, uint32_t num_bits)
+{
+    writer->bits = (writer->bits << num_bits) | bits;
+    writer->num_bits += num_bits;
+
+    while (writer->num_bits >= 8)
+    {
+        writer->num_bits -= 8;
+
+        if (writer->len_in_bytes < writer->max_len_in_bytes)
+        {
+            writer->dest[writer->len_in_bytes] = (uint8_t)(writer->bits >> writer->num_bits);
+        }
+        writer->len_in_bytes += 1;
+    }
+}
+
+void put_rice(Bit_Writer_t *writer, uint32_t folded, uint32_t param)
+{
+    uint32_t quotient = folded >> param;
+    const uint32_t remainder = folded & ((1u << param) - 1);
+
+    // the quotient in unary as that many 0s and a 1, then the remainder in binary, usually all in one go
+    if (quotient + 1 + param <= 32)
+    {
+        put_bits(writer, (1u << param) | remainder, quotient + 1 + param);
+        return;
+    }
+
+    // an outlier, the caller falls back to a verbatim subframe if this runs out of room
+    while (quotient >= 32 && writer->len_in_bytes < writer->max_len_in_bytes)
+    {
+        put_bits(writer, 0, 32);
+        quotient -= 32;
+    }
+
+    put_bits(writer, 1, (quotient % 32) + 1);
+    put_bits(writer, remainder, param);
+}
+
+int32_t read_sample(const uint8_t *src, uint32_t idx, uint32_t bytes_per_sample)
+{
+    const uint8_t *sample = src + (idx * bytes_per_sample);
+
+    if (bytes_per_sample == 2)
+    {
+        return (int16_t)(sample[0] | (sample[1] << 8));
+    }
+
+    // shift the sample up to the top of the word and back down to sign extend it
+    return (int32_t)(((uint32_t)sample[0] << 8) | ((uint32_t)sample[1] << 16) | ((uint32_t)sample[2] << 24)) >> 8;
+}
+
+int32_t next_residual(int32_t sample, int32_t *diffs, uint32_t order)
+{
+    // the residual of order k is the difference between the residuals of order k - 1 for this sample and the last one
+    int32_t residual = sample;
+
+    for (uint32_t k = 0; k < order; k++)
+    {
+        const int32_t diff = residual - diffs[k];
+        diffs[k] = residual;
+        residual = diff;
+    }
+
+    return residual;
+}
+
+uint32_t fold(int32_t residual)
+{
+    return ((uint32_t)residual << 1) ^ (uint32_t)(residual >> 31);
+}
+
+uint32_t best_fixed_order(const uint8_t *src, uint32_t num_samples, uint32_t bytes_per_sample)
+{
+    // there must be at least one residual after the warm-up samples
+    const uint32_t max_order = num_samples > MAX_FIXED_ORDER ? MAX_FIXED_ORDER : num_samples - 1;
+
+    // the residuals of all the orders at once, each one is the difference of the one below it for this sample and the
+    // last one, the residuals of the orders above `max_order` are never looked at
+    int32_t last_residuals[MAX_FIXED_ORDER] = {0};
+    uint64_t totals[MAX_FIXED_ORDER + 1] = {0};
+
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        const int32_t residual_0 = read_sample(src, i, bytes_per_sample);
+        const int32_t residual_1 = residual_0 - last_residuals[0];
+        const int32_t residual_2 = residual_1 - last_residuals[1];
+        const int32_t residual_3 = residual_2 - last_residuals[2];
+        const int32_t residual_4 = residual_3 - last_residuals[3];
+
+        last_residuals[0] = residual_0;
+        last_residuals[1] = residual_1;
+        last_residuals[2] = residual_2;
+        last_residuals[3] = residual_3;
+
+        // every order is judged on the same samples, the ones past the warm-up of the highest order
+        if (i >= max_order)
+        {
+            totals[0] += (uint32_t)(residual_0 < 0 ? -residual_0 : residual_0);
+            totals[1] += (uint32_t)(residual_1 < 0 ? -residual_1 : residual_1);
+            totals[2] += (uint32_t)(residual_2 < 0 ? -residual_2 : residual_2);
+            totals[3] += (uint32_t)(residual_3 < 0 ? -residual_3 : residual_3);
+            totals[4] += (uint32_t)(residual_4 < 0 ? -residual_4 : residual_4);
+        }
+    }
+
+    uint32_t best_order = 0;
+    for (uint32_t k = 1; k <= max_order; k++)
+    {
+        if (totals[k] < totals[best_order])
+        {
+            best_order = k;
+        }
+    }
+
+    return best_order;
+}
+
+void plan_rice_coding(const uint8_t *src, uint32_t num_samples, uint32_t bytes_per_sample, uint32_t order, Rice_Coding_t *coding)
+{
+    // the sum of the folded residuals in each partition, coarser partitions are sums of the finer ones
+    static uint64_t sums[MAX_NUM_PARTITIONS];
+
+    // partitions must split the block evenly and the first one must have room for a residual after the warm-up
+    uint32_t max_partition_order = 0;
+    while (max_partition_order < MAX_PARTITION_ORDER &&
+           num_samples % (2u << max_partition_order) == 0 &&
+           (num_samples >> (max_partition_order + 1)) > order)
+    {
+        max_partition_order += 1;
+    }
+
+    const uint32_t finest_partition_len = num_samples >> max_partition_order;
+    int32_t diffs[MAX_FIXED_ORDER] = {0};
+
+    for (uint32_t i = 0; i < order; i++)
+    {
+        next_residual(read_sample(src, i, bytes_per_sample), diffs, order);
+    }
+
+    uint32_t i = order;
+    for (uint32_t j = 0; j < (1u << max_partition_order); j++)
+    {
+        sums[j] = 0;
+
+        for (const uint32_t end = (j + 1) * finest_partition_len; i < end; i++)
+        {
+            sums[j] += fold(next_residual(read_sample(src, i, bytes_per_sample), diffs, order));
+        }
+    }
+
+    // work from the finest partitions to a single one, merging pairs of partitions each time
+    uint64_t best_len_in_bits = UINT64_MAX;
+    Rice_Coding_t candidate;
+
+    for (int32_t partition_order = (int32_t)max_partition_order; partition_order >= 0; partition_order--)
+    {
+        const uint32_t num_partitions = 1u << partition_order;
+        const uint32_t partition_len = num_samples >> partition_order;
+
+        uint64_t len_in_bits = 0;
+        uint32_t max_param = 0;
+
+        for (uint32_t j = 0; j < num_partitions; j++)
+        {
+            const uint32_t num_residuals = j == 0 ? partition_len - order : partition_len;
+            const uint32_t param = rice_param(sums[j], num_residuals);
+
+            // each residual is a unary quotient, a stop bit, and the remainder, this is an upper bound on the quotients
+            len_in_bits += ((uint64_t)num_residuals * (param + 1)) + (sums[j] >> param);
+            candidate.params[j] = (uint8_t)param;
+            max_param = param > max_param ? param : max_param;
+        }
+
+        candidate.partition_order = (uint32_t)partition_order;
+        candidate.coding_method = max_param > MAX_RICE_PARAM_4_BIT ? RESIDUAL_CODING_RICE_5_BIT : RESIDUAL_CODING_RICE_4_BIT;
+        len_in_bits += num_partitions * (candidate.coding_method == RESIDUAL_CODING_RICE_5_BIT ? 5 : 4);
+
+        if (len_in_bits < best_len_in_bits)
+        {
+            best_len_in_bits = len_in_bits;
+            *coding = candidate;
+        }
+
+        for (uint32_t j = 0; j < num_partitions / 2; j++)
+        {
+            sums[j] = sums[2 * j] + sums[(2 * j) + 1];
+        }
+    }
+}
+
+uint32_t rice_param(uint64_t sum, uint32_t num_residuals)
+{
+    uint32_t param = 0;
+
+    while (param < MAX_RICE_PARAM_5_BIT && ((uint64_t)num_residuals << (param + 1)) <= sum)
+    {
+        param += 1;
+    }
+
+    return param;
+}
+
+void write_frame_header(Bit_Writer_t *writer, uint32_t num_samples, uint32_t bits_per_sample, uint64_t first_sample_number)
+{
+    const bool is_short_block = num_samples <= 256;
+
+    put_bits(writer, FRAME_SYNC_CODE_VARIABLE_BLOCK_SIZE, 16);
+    put_bits(writer, is_short_block ? BLOCK_SIZE_CODE_8_BIT : BLOCK_SIZE_CODE_16_BIT, 4);
+    put_bits(writer, SAMPLE_RATE_CODE_FROM_STREAMINFO, 4);
+    put_bits(writer, CHANNEL_ASSIGNMENT_MONO, 4);
+    put_bits(writer, bits_per_sample == 16 ? SAMPLE_SIZE_CODE_16_BIT : SAMPLE_SIZE_CODE_24_BIT, 3);
+    put_bits(writer, 0, 1);
+
+    // the sample number is coded like a UTF-8 character, extended to 36 bits
+    if (first_sample_number < 0x80)
+    {
+        put_bits(writer, (uint32_t)first_sample_number, 8);
+    }
+    else
+    {
+        // each continuation byte holds 6 bits, and the first byte holds what is left after its run of 1s and a 0
+        uint32_t num_continuation_bytes = 1;
+        while (num_continuation_bytes < 6 && (first_sample_number >> (6 * num_continuation_bytes)) >= (1u << (6 - num_continuation_bytes)))
+        {
+            num_continuation_bytes += 1;
+        }
+
+        const uint32_t lead_bits = (0xFF00u >> (num_continuation_bytes + 1)) & 0xFF;
+        put_bits(writer, lead_bits | (uint32_t)(first_sample_number >> (6 * num_continuation_bytes)), 8);
+
+        for (int32_t i = (int32_t)num_continuation_bytes - 1; i >= 0; i--)
+        {
+            put_bits(writer, 0x80 | ((uint32_t)(first_sample_number >> (6 * i)) & 0x3F), 8);
+        }
+    }
+
+    put_bits(writer, num_samples - 1, is_short_block ? 8 : 16);
+    put_bits(writer, crc8(writer->dest, writer->len_in_bytes), 8);
+}
+
+void write_fixed_subframe(Bit_Writer_t *writer, const uint8_t *src, uint32_t num_samples, uint32_t bytes_per_sample, uint32_t order, const Rice_Coding_t *coding)
+{
+    const uint32_t bits_per_sample = bytes_per_sample * 8;
+    const uint32_t sample_mask = 0xFFFFFFFFu >> (32 - bits_per_sample);
+
+    put_bits(writer, SUBFRAME_HEADER_FIXED(order), 8);
+
+    for (uint32_t i = 0; i < order; i++)
+    {
+        put_bits(writer, (uint32_t)read_sample(src, i, bytes_per_sample) & sample_mask, bits_per_sample);
+    }
+
+    put_bits(writer, coding->coding_method, 2);
+    put_bits(writer, coding->partition_order, 4);
+
+    const uint32_t param_len_in_bits = coding->coding_method == RESIDUAL_CODING_RICE_5_BIT ? 5 : 4;
+    const uint32_t partition_len = num_samples >> coding->partition_order;
+    int32_t diffs[MAX_FIXED_ORDER] = {0};
+
+    // the warm-up samples still have to go through the predictor to fill in its differences
+    for (uint32_t i = 0; i < order; i++)
+    {
+        next_residual(read_sample(src, i, bytes_per_sample), diffs, order);
+    }
+
+    uint32_t i = order;
+    for (uint32_t j = 0; j < (1u << coding->partition_order); j++)
+    {
+        if (writer->len_in_bytes >= writer->max_len_in_bytes)
+        {
+            return;
+        }
+
+        const uint32_t param = coding->params[j];
+        put_bits(writer, param, param_len_in_bits);
+
+        for (const uint32_t end = (j + 1) * partition_len; i < end; i++)
+        {
+            put_rice(writer, fold(next_residual(read_sample(src, i, bytes_per_sample), diffs, order)), param);
+        }
+    }
+}
+
+uint32_t write_verbatim_subframe(uint8_t *dest, const uint8_t *src, uint32_t num_samples, uint32_t bytes_per_sample)
+{
+    uint32_t len = 0;
+    dest[len++] = SUBFRAME_HEADER_VERBATIM;
+
+    // FLAC samples are big-endian
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        const uint8_t *sample = src + (i * bytes_per_sample);
+
+        for (int32_t b = (int32_t)bytes_per_sample - 1; b >= 0; b--)
+        {
+            dest[len++] = sample[b];
+        }
+    }
+
+    return len;
+}
+
+uint8_t crc8(const uint8_t *data, uint32_t len)
+{
+    uint8_t crc = 0;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        crc = (uint8_t)(crc << 4) ^ crc8_nibble_table[crc >> 4];
+        crc = (uint8_t)(crc << 4) ^ crc8_nibble_table[crc >> 4];
+    }
+
+    return crc;
+}
+
+uint16_t crc16(const uint8_t *data, uint32_t len)
+{
+    uint16_t crc = 0;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc = (uint16_t)(crc << 8) ^ crc16_table[(crc >> 8) ^ data[i]];
+    }
+
+    return crc;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file      flac_encoder.h
+ * @brief     A software interface for losslessly compressing blocks of audio into FLAC frames is represented here.
+ * @details   Bioacoustic recordings are mostly quiet background with the odd call in it, so their samples are very
+ *            predictable and most of the bits of a 24 bit WAVE file are wasted on the card. This module encodes mono
+ *            16 and 24 bit PCM, in the same packed little-endian layout the recorder writes to WAVE files, into FLAC
+ *            frames that any FLAC decoder can read.
+ *
+ *            Each frame holds one subframe, predicted with the best of the FLAC fixed polynomial predictors of order 0
+ *            to 4, and the residual is Rice coded in partitions that each get their own Rice parameter. The fixed
+ *            predictors only take integer adds, so a frame is encoded in three passes over the samples (choose the
+ *            order, size the partitions, write the codes) without any multiplies or a residual buffer, which keeps the
+ *            cost per sample within the time the DMA block ready callback has left on the MAX32666. If the prediction
+ *            doesn't pay off, e.g. for full scale white noise, the frame falls back to storing the samples verbatim, so
+ *            a frame is never much bigger than the PCM.
+ *
+ *            The stream uses the variable block size strategy, so frame headers carry the number of their first sample
+ *            and frames of different lengths can follow each other, e.g. when a DMA block is split between two files.
+ *            The MD5 signature in the stream header is left as zero, which tells decoders that it wasn't computed.
+ *
+ *            This module does not touch any peripherals, so it can be unit tested and shared with host benchmarks.
+ */
+
+#ifndef FLAC_ENCODER_H_
+#define FLAC_ENCODER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// the "fLaC" marker and the STREAMINFO metadata block, the only metadata we write
+#define FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES (42)
+
+// STREAMINFO counts the samples of a stream in 36 bits, so a stream must hold fewer than this, about 49 hours at 384kHz
+#define FLAC_ENCODER_MAX_TOTAL_SAMPLES (1ULL << 36)
+
+// FLAC frames must be at least 16 samples long, only the last frame of a stream may be shorter
+#define FLAC_ENCODER_MIN_BLOCK_LEN_IN_SAMPLES (16)
+
+// the frame header, the subframe header, and the CRC-16 at the end of the frame, at their longest
+#define FLAC_ENCODER_FRAME_OVERHEAD_IN_BYTES (17)
+
+// the longest frame `n` samples of `b` bits can encode to, the samples stored verbatim plus the frame overhead
+#define FLAC_ENCODER_MAX_FRAME_LEN_IN_BYTES(n, b) (((n) * ((b) / 8)) + FLAC_ENCODER_FRAME_OVERHEAD_IN_BYTES)
+
+/* Public structs ----------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The fields of the FLAC STREAMINFO metadata block are represented here.
+ */
+typedef struct
+{
+    uint32_t sample_rate;
+    uint32_t bits_per_sample;          // 16 or 24
+    uint32_t max_block_len_in_samples; // the longest frame in the stream, at most 65535 samples
+    uint64_t total_samples;            // the number of samples in the stream, less than 2^36
+} Flac_Encoder_Stream_Info_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `flac_encoder_write_stream_header(i, d)` writes the start of a FLAC stream with info `i` to `d`.
+ *
+ * @param info the info for the STREAMINFO block, the minimum block length is always given as 16 samples and the frame
+ * lengths as unknown
+ *
+ * @param dest the destination for the stream header, must be at least `FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES` long
+ *
+ * @post the "fLaC" marker and a STREAMINFO block marked as the last metadata block are stored in `d`
+ *
+ * @retval the number of bytes stored, `FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES`
+ */
+uint32_t flac_encoder_write_stream_header(const Flac_Encoder_Stream_Info_t *info, uint8_t *dest);
+
+/**
+ * @brief `flac_encoder_encode_frame(s, n, b, f, d)` encodes `n` mono samples of `b` bits packed in `s` into one FLAC
+ * frame in `d`, numbering its first sample `f`.
+ *
+ * @param src the packed little-endian samples, 2 bytes each for 16 bits and 3 bytes each for 24 bits, the same layout
+ * as the audio data of a WAVE file
+ *
+ * @param num_samples the number of samples in the frame, in [1, 65535], at least 16 unless this is the last frame
+ *
+ * @param bits_per_sample 16 or 24, the same as in the stream header
+ *
+ * @param first_sample_number the number of the first sample of the frame in the stream, counting from 0
+ *
+ * @param dest the destination for the frame, must be at least `FLAC_ENCODER_MAX_FRAME_LEN_IN_BYTES(n, b)` long and
+ * must not overlap `s`
+ *
+ * @post `d` holds a complete frame with its header and CRCs, which a decoder turns back into exactly the samples in `s`
+ *
+ * @retval the length of the frame in bytes
+ */
+uint32_t flac_encoder_encode_frame(const uint8_t *src, uint32_t num_samples, uint32_t bits_per_sample, uint64_t first_sample_number, uint8_t *dest);
+
+#endif /* FLAC_ENCODER_H_ */
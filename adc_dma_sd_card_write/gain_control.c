@@ -0,0 +1,99 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "afe_control.h"
+#include "gain_control.h"
+#include "scheduler.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the recorder records the one AFE channel in front of the ADC
+#define AFE_CHANNEL (AFE_CONTROL_CHANNEL_0)
+
+// the events of the gain task
+#define GAIN_EVENT_SET (1u << 0)
+#define GAIN_EVENT_CHECK (1u << 1)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static Scheduler_Task_t gain_task;
+static Scheduler_Timer_t check_timer;
+
+// the gain asked for, written from any context, and the gain last read back
+static volatile AFE_Control_Gain_t requested_gain;
+static AFE_Control_Gain_t confirmed_gain = AFE_CONTROL_GAIN_UNDEFINED;
+
+static uint32_t num_errors = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `run_gain_control(e)` is the gain task, it sets the gain asked for, and reads it back to make sure it took, or
+ * is still set.
+ */
+static void run_gain_control(Scheduler_Events_t events);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+Gain_Control_Error_t gain_control_init(Hal_I2C_Bus_t bus, AFE_Control_Gain_t gain, uint32_t check_period_secs)
+{
+    afe_control_init(bus);
+    afe_control_enable(AFE_CHANNEL);
+
+    if (scheduler_add_task(run_gain_control, SCHEDULER_PRIORITY_NORMAL, &gain_task) != SCHEDULER_ERROR_ALL_OK ||
+        scheduler_add_timer(gain_task, GAIN_EVENT_CHECK, &check_timer) != SCHEDULER_ERROR_ALL_OK)
+    {
+        return GAIN_CONTROL_ERROR_SCHEDULER_ERROR;
+    }
+
+    if (check_period_secs > 0)
+    {
+        scheduler_timer_start(check_timer, check_period_secs * 1000, check_period_secs * 1000);
+    }
+
+    gain_control_set_gain(gain);
+
+    return GAIN_CONTROL_ERROR_ALL_OK;
+}
+
+void gain_control_set_gain(AFE_Control_Gain_t gain)
+{
+    requested_gain = gain;
+    scheduler_post(gain_task, GAIN_EVENT_SET);
+}
+
+AFE_Control_Gain_t gain_control_get_gain()
+{
+    return confirmed_gain;
+}
+
+uint32_t gain_control_num_errors()
+{
+    return num_errors;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void run_gain_control(Scheduler_Events_t events)
+{
+    const AFE_Control_Gain_t gain = requested_gain;
+
+    // a check finds out if the switch lost the gain, which is then set again just like a new gain
+    if ((events & GAIN_EVENT_CHECK) && !(events & GAIN_EVENT_SET))
+    {
+        confirmed_gain = afe_control_get_gain(AFE_CHANNEL);
+        if (confirmed_gain == gain)
+        {
+            return;
+        }
+
+        num_errors += 1;
+    }
+
+    if (events & (GAIN_EVENT_SET | GAIN_EVENT_CHECK))
+    {
+        // a switch that doesn't take the gain is tried again at the next check
+        afe_control_set_gain(AFE_CHANNEL, gain);
+        confirmed_gain = afe_control_get_gain(AFE_CHANNEL);
+    }
+}
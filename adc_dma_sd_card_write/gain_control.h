@@ -0,0 +1,62 @@
+/**
+ * @file      gain_control.h
+ * @brief     A task that sets the gain of the analog front end and keeps it set while the recorder runs is represented
+ *            here.
+ * @details   The gain of the AFE channel in front of the ADC is set by a MAX14662 switch on I2C. Asking for a new gain
+ *            posts to the task rather than talking to the switch there and then, so a gain change from anywhere, such
+ *            as a schedule or a level check, never holds up a DMA block. The task also reads the gain back every check
+ *            period and sets it again if the switch lost it, e.g. to a brown out of the AFE supply, so a long
+ *            deployment doesn't record at the wrong gain for the rest of its life.
+ */
+
+#ifndef GAIN_CONTROL_H_
+#define GAIN_CONTROL_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include "afe_control.h"
+#include "hal_i2c.h"
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Gain control errors are represented here
+ */
+typedef enum
+{
+    GAIN_CONTROL_ERROR_ALL_OK,
+    GAIN_CONTROL_ERROR_SCHEDULER_ERROR,
+} Gain_Control_Error_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `gain_control_init(b, g, p)` powers up the AFE channel with its gain switch on I2C bus `b`, adds the gain
+ * task to the scheduler, and asks for gain `g`, which is read back every `p` seconds, or never if `p` is 0.
+ *
+ * @pre `b` is initialized as an I2C master with pullups to 1.8V.
+ *
+ * @retval `GAIN_CONTROL_ERROR_ALL_OK` if the gain task was started, else an error code
+ */
+Gain_Control_Error_t gain_control_init(Hal_I2C_Bus_t bus, AFE_Control_Gain_t gain, uint32_t check_period_secs);
+
+/**
+ * @brief `gain_control_set_gain(g)` asks the gain task to set gain `g`, it can be called from any context.
+ */
+void gain_control_set_gain(AFE_Control_Gain_t gain);
+
+/**
+ * @brief `gain_control_get_gain()` is the gain the switch last read back as, `AFE_CONTROL_GAIN_UNDEFINED` until the
+ * task has set it, or if the switch doesn't answer.
+ */
+AFE_Control_Gain_t gain_control_get_gain();
+
+/**
+ * @brief `gain_control_num_errors()` is the number of times the gain read back wrong, or the switch didn't answer, and
+ * the task set it again.
+ */
+uint32_t gain_control_num_errors();
+
+#endif /* GAIN_CONTROL_H_ */
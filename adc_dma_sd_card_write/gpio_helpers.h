@@ -8,7 +8,7 @@
 
 /* Includes ----------------------------------------------------------------------------------------------------------*/
 
-#include "mxc_device.h"
+#include "hal_gpio.h"
 #include <stdbool.h>
 
 /* Public enumerations -----------------------------------------------------------------------------------------------*/
@@ -18,20 +18,14 @@
  */
 typedef enum
 {
-    GPIO_PROFILING_PIN_P1_8 = MXC_GPIO_PIN_8,
-    GPIO_PROFILING_PIN_P1_9 = MXC_GPIO_PIN_9,
-    GPIO_PROFILING_PIN_P1_10 = MXC_GPIO_PIN_10,
-    GPIO_PROFILING_PIN_P1_11 = MXC_GPIO_PIN_11,
+    GPIO_PROFILING_PIN_P1_8 = HAL_GPIO_PIN(8),
+    GPIO_PROFILING_PIN_P1_9 = HAL_GPIO_PIN(9),
+    GPIO_PROFILING_PIN_P1_10 = HAL_GPIO_PIN(10),
+    GPIO_PROFILING_PIN_P1_11 = HAL_GPIO_PIN(11),
 } GPIO_Profiling_Pin_t;
 
 /* Public function declarations --------------------------------------------------------------------------------------*/
 
-void gpio_write_pin(const mxc_gpio_cfg_t *pin, bool state);
-
-void gpio_toggle_pin(const mxc_gpio_cfg_t *pin);
-
-bool gpio_read_pin(const mxc_gpio_cfg_t *pin);
-
 void gpio_profiling_pin_init();
 
 void gpio_profiling_pin_write(GPIO_Profiling_Pin_t pin, bool state);
@@ -0,0 +1,178 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_dma.h"
+#include "dma.h"
+#include "dma_regs.h"
+#include "mxc_device.h"
+
+#include <stdbool.h>
+#include <stddef.h> // for NULL
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the number of bytes moved for each request of the SPI bus
+#define DMA_BURST_LEN_IN_BYTES (24)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the DMA channel to use, will be updated to a valid DMA channel during initialization
+static int dma_channel = E_BAD_STATE;
+
+static uint32_t block_len;
+
+static Hal_DMA_Block_Done_Handler_t block_done_handler = NULL;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * this gets called by the DMA 1st, and when this returns, it goes directly to the DMA0_IRQHandler()
+ */
+static void DMA_CALLBACK_func(int a, int b)
+{
+    /* do nothing, immediately transitions to DMA0_IRQHandler() where all the real work happens */
+}
+
+/**
+ * @brief In the DMA interrupt handler we point the DMA at the next block
+ */
+void DMA0_IRQHandler();
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+Hal_DMA_Error_t hal_dma_init(Hal_SPI_Bus_t bus, uint32_t block_len_in_bytes, Hal_DMA_Block_Done_Handler_t handler)
+{
+    block_len = block_len_in_bytes;
+    block_done_handler = handler;
+
+    NVIC_EnableIRQ(DMA0_IRQn);
+
+    if (MXC_DMA_Init(MXC_DMA0) != E_NO_ERROR)
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    dma_channel = MXC_DMA_AcquireChannel(MXC_DMA0);
+
+    if (dma_channel == E_NONE_AVAIL || dma_channel == E_BAD_STATE || dma_channel == E_BUSY)
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    // the destination is set when the stream is prepared
+    mxc_dma_srcdst_t dma_transfer = {
+        .ch = dma_channel,
+        .source = NULL,
+        .dest = NULL,
+        .len = block_len,
+    };
+
+    mxc_dma_config_t dma_config = {
+        .ch = dma_channel,
+        .reqsel = bus == HAL_SPI_BUS_1 ? MXC_DMA_REQUEST_SPI1RX : MXC_DMA_REQUEST_SPI2RX,
+        .srcwd = MXC_DMA_WIDTH_BYTE,
+        .dstwd = MXC_DMA_WIDTH_BYTE,
+        .srcinc_en = 0, // this is ignored??
+        .dstinc_en = 1,
+    };
+
+    mxc_dma_adv_config_t advConfig = {
+        .ch = dma_channel,
+        .prio = MXC_DMA_PRIO_HIGH,
+        .reqwait_en = 0,
+        .tosel = MXC_DMA_TIMEOUT_4_CLK,
+        .pssel = MXC_DMA_PRESCALE_DISABLE,
+        .burst_size = DMA_BURST_LEN_IN_BYTES,
+    };
+
+    if (MXC_DMA_ConfigChannel(dma_config, dma_transfer) != E_NO_ERROR)
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    if (MXC_DMA_AdvConfigChannel(advConfig) != E_NO_ERROR)
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    const bool ch_complete_int = false;
+    const bool count_to_zero_int = true;
+    if (MXC_DMA_SetChannelInterruptEn(dma_channel, ch_complete_int, count_to_zero_int) != E_NO_ERROR)
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    if (MXC_DMA_SetCallback(dma_channel, DMA_CALLBACK_func) != E_NO_ERROR)
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    return HAL_DMA_ERROR_ALL_OK;
+}
+
+Hal_DMA_Error_t hal_dma_prepare(uint8_t *first_block)
+{
+    mxc_dma_srcdst_t dma_transfer = {
+        .ch = dma_channel,
+        .source = NULL,
+        .dest = first_block,
+        .len = block_len,
+    };
+
+    if (MXC_DMA_SetSrcDst(dma_transfer) != E_NO_ERROR)
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    if (MXC_DMA_SetSrcReload(dma_transfer) != E_NO_ERROR)
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    if (MXC_DMA_EnableInt(dma_channel) != E_NO_ERROR)
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    return HAL_DMA_ERROR_ALL_OK;
+}
+
+Hal_DMA_Error_t hal_dma_start()
+{
+    if (MXC_DMA_Start(dma_channel) != E_NO_ERROR) // sets bits 0 and 1 of control reg and bit 31 of count reload reg
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    return HAL_DMA_ERROR_ALL_OK;
+}
+
+Hal_DMA_Error_t hal_dma_stop()
+{
+    if (MXC_DMA_Stop(dma_channel) != E_NO_ERROR)
+    {
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    return HAL_DMA_ERROR_ALL_OK;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void DMA0_IRQHandler()
+{
+    // we have a very short time from the start of this function to the moment the first few bytes of the next block
+    // are overwritten. If we take too long messing about in this function we will get invalid data for the first few
+    // samples in the block. At 384kHz the time we have is under 1/384kHz = 2.6 microseconds.
+
+    MXC_DMA_Handler(MXC_DMA0);
+    int flags = MXC_DMA_ChannelGetFlags(dma_channel); // clears the cfg enable bit
+    MXC_DMA_ChannelClearFlags(dma_channel, flags);
+
+    const uint32_t next_block = (uint32_t)block_done_handler();
+
+    MXC_DMA0->ch[dma_channel].dst = next_block;
+    MXC_DMA0->ch[dma_channel].dst_rld = next_block;
+    MXC_DMA0->ch[dma_channel].cnt = block_len;
+    MXC_DMA0->ch[dma_channel].cnt_rld |= MXC_F_DMA_CNT_RLD_RLDEN;
+}
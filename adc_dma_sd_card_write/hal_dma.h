@@ -0,0 +1,82 @@
+/**
+ * @file      hal_dma.h
+ * @brief     A thin hardware abstraction of the DMA stream from an SPI slave bus into memory is represented here.
+ * @details   The stream fills one block of memory at a time with the bytes received on the bus. Each time a block is
+ *            full the block done handler runs in the DMA interrupt and says where the next block goes, so the blocks
+ *            can form a ring. `hal_dma.c` is the MSDK back-end for the MAX32666, the host back-end in test/host_sim
+ *            fills the blocks from the simulated ADC on a thread standing in for the DMA and its interrupt.
+ *
+ *            The blocks are only ever written by the stream, so a block done handler that publishes a block to the
+ *            main loop must do so with release semantics, and the reader must read with acquire semantics.
+ */
+
+#ifndef HAL_DMA_H_
+#define HAL_DMA_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include "hal_spi.h"
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief DMA errors are represented here
+ */
+typedef enum
+{
+    HAL_DMA_ERROR_ALL_OK,
+    HAL_DMA_ERROR_DMA_ERROR,
+} Hal_DMA_Error_t;
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A function run in the DMA interrupt each time a block is full is represented here, it is the address of the
+ * next block to fill. It must be quick, the bus keeps receiving while it runs.
+ */
+typedef uint8_t *(*Hal_DMA_Block_Done_Handler_t)();
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_dma_init(b, l, f)` sets up a DMA channel to move the bytes received on bus `b` into blocks of `l` bytes,
+ * running `f` each time a block is full.
+ *
+ * @pre `b` is set up as an SPI slave, see hal_spi.h.
+ *
+ * @retval `HAL_DMA_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_DMA_Error_t hal_dma_init(Hal_SPI_Bus_t bus, uint32_t block_len_in_bytes, Hal_DMA_Block_Done_Handler_t handler);
+
+/**
+ * @brief `hal_dma_prepare(d)` makes `d` the first block the stream fills.
+ *
+ * @pre DMA initialization is complete and the stream is stopped.
+ *
+ * @post the stream is ready to start, the DMA interrupt is enabled.
+ *
+ * @retval `HAL_DMA_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_DMA_Error_t hal_dma_prepare(uint8_t *first_block);
+
+/**
+ * @brief `hal_dma_start()` starts the stream.
+ *
+ * @pre `hal_dma_prepare()` was called, and the bus requests the DMA, see `hal_spi_enable_rx_dma()`.
+ *
+ * @retval `HAL_DMA_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_DMA_Error_t hal_dma_start();
+
+/**
+ * @brief `hal_dma_stop()` stops the stream, the block being filled is left part way.
+ *
+ * @post the block done handler doesn't run again until the stream is started.
+ *
+ * @retval `HAL_DMA_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_DMA_Error_t hal_dma_stop();
+
+#endif /* HAL_DMA_H_ */
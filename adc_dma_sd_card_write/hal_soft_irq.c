@@ -0,0 +1,47 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_soft_irq.h"
+#include "mxc_device.h"
+
+#include <stddef.h> // for NULL
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static volatile Hal_Soft_IRQ_Handler_t soft_irq_handler = NULL;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief PendSV is the lowest priority exception, so the handler can pre-empt the main loop (even in the middle of a
+ * blocking SD card write) while every interrupt can still pre-empt it.
+ */
+void PendSV_Handler();
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_soft_irq_set_handler(Hal_Soft_IRQ_Handler_t handler)
+{
+    // the handler must never hold up an interrupt
+    NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+
+    // PendSV pre-empts the main loop, so the old handler can't be part way through when we get here
+    soft_irq_handler = handler;
+}
+
+void hal_soft_irq_pend()
+{
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void PendSV_Handler()
+{
+    const Hal_Soft_IRQ_Handler_t handler = soft_irq_handler;
+
+    if (handler != NULL)
+    {
+        handler();
+    }
+}
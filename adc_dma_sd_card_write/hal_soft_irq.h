@@ -0,0 +1,39 @@
+/**
+ * @file      hal_soft_irq.h
+ * @brief     A thin hardware abstraction of a software interrupt is represented here.
+ * @details   The handler runs in a context of its own, below every hardware interrupt but pre-empting the main loop, so
+ *            an interrupt can hand longer work to it and return quickly. On the MAX32666 this is the PendSV exception,
+ *            see `hal_soft_irq.c`, the host back-end in test/host_sim runs the handler on a thread of its own.
+ */
+
+#ifndef HAL_SOFT_IRQ_H_
+#define HAL_SOFT_IRQ_H_
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A function run by the software interrupt is represented here.
+ */
+typedef void (*Hal_Soft_IRQ_Handler_t)();
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_soft_irq_set_handler(f)` sets function `f` to run each time the software interrupt is pended.
+ *
+ * @pre called from the main loop.
+ *
+ * @param handler the function to run, or NULL to stop running anything
+ *
+ * @post the old handler is not running and won't run again. `f` is never re-entered, and pends that come in while it
+ * runs may be merged into a single run after it.
+ */
+void hal_soft_irq_set_handler(Hal_Soft_IRQ_Handler_t handler);
+
+/**
+ * @brief `hal_soft_irq_pend()` asks for the handler to run as soon as no hardware interrupt is running, it can be
+ * called from any context.
+ */
+void hal_soft_irq_pend();
+
+#endif /* HAL_SOFT_IRQ_H_ */
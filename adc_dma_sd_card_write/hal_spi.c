@@ -0,0 +1,180 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_spi.h"
+#include "mxc_device.h"
+#include "spi.h"
+#include "spi_regs.h"
+
+#include <stddef.h> // for NULL
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the slave init ends with a short receive that is thrown away
+#define SLAVE_INIT_RX_BUFF_LEN_IN_BYTES (3)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static uint8_t slave_init_rx_buff[SLAVE_INIT_RX_BUFF_LEN_IN_BYTES];
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `spi_regs(b)` is the MSDK register block of SPI bus `b`.
+ */
+static mxc_spi_regs_t *spi_regs(Hal_SPI_Bus_t bus);
+
+/**
+ * @brief `set_format(b, m, w)` sets bus `b` to mode `m` and width `w`, and is true on success.
+ */
+static bool set_format(Hal_SPI_Bus_t bus, Hal_SPI_Mode_t mode, Hal_SPI_Width_t width);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+Hal_SPI_Error_t hal_spi_master_init(Hal_SPI_Bus_t bus, uint32_t clk_freq_hz, Hal_SPI_Mode_t mode, Hal_SPI_Width_t width)
+{
+    if (MXC_SPI_Init(
+            spi_regs(bus),
+            1, // 1 -> master mode
+            0, // 0 -> quad mode not used, single bit SPI
+            1, // num slaves
+            0, // CS polarity (0 for active low)
+            clk_freq_hz,
+            MAP_A) != E_NO_ERROR)
+    {
+        return HAL_SPI_ERROR_CONFIG_ERROR;
+    }
+    if (MXC_SPI_SetDataSize(spi_regs(bus), 8) != E_NO_ERROR)
+    {
+        return HAL_SPI_ERROR_CONFIG_ERROR;
+    }
+
+    return set_format(bus, mode, width) ? HAL_SPI_ERROR_ALL_OK : HAL_SPI_ERROR_CONFIG_ERROR;
+}
+
+Hal_SPI_Error_t hal_spi_master_transaction(Hal_SPI_Bus_t bus, const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len)
+{
+    mxc_spi_req_t req = {
+        .spi = spi_regs(bus),
+        .txData = (uint8_t *)tx_buff, // the MSDK only reads it
+        .rxData = rx_buff,
+        .txLen = tx_len,
+        .rxLen = rx_len,
+        .ssIdx = 0,
+        .ssDeassert = 1,
+        .txCnt = 0,
+        .rxCnt = 0,
+        .completeCB = NULL,
+    };
+
+    return MXC_SPI_MasterTransaction(&req) == E_NO_ERROR ? HAL_SPI_ERROR_ALL_OK : HAL_SPI_ERROR_TRANSACTION_ERROR;
+}
+
+Hal_SPI_Error_t hal_spi_slave_init(Hal_SPI_Bus_t bus, Hal_SPI_Mode_t mode, Hal_SPI_Width_t width)
+{
+    if (MXC_SPI_Init(
+            spi_regs(bus),
+            0, // 0 -> slave mode
+            0, // 0 -> quad mode not used, single bit SPI
+            0, // num slaves, none
+            0, // CS polarity (0 for active low)
+            0, // freq is defined by the driving clock
+            MAP_A) != E_NO_ERROR)
+    {
+        return HAL_SPI_ERROR_CONFIG_ERROR;
+    }
+
+    // TODO: this call returns an error. It does in Bob's code too, but it is not handled there.
+    // Do we even need to set the data size to 8 bits?
+    if (MXC_SPI_SetDataSize(spi_regs(bus), 8) != E_NO_ERROR)
+    {
+        //        return HAL_SPI_ERROR_CONFIG_ERROR;
+    }
+
+    if (!set_format(bus, mode, width))
+    {
+        return HAL_SPI_ERROR_CONFIG_ERROR;
+    }
+
+    // complete the init; don't use the data!
+    mxc_spi_req_t req = {
+        .spi = spi_regs(bus),
+        .txData = NULL,
+        .rxData = slave_init_rx_buff,
+        .txLen = 0,
+        .rxLen = SLAVE_INIT_RX_BUFF_LEN_IN_BYTES,
+        .ssIdx = 0,
+        .ssDeassert = 1,
+        .txCnt = 0,
+        .rxCnt = 0,
+        .completeCB = NULL,
+    };
+    if (MXC_SPI_SlaveTransactionAsync(&req) != E_NO_ERROR)
+    {
+        return HAL_SPI_ERROR_CONFIG_ERROR;
+    }
+
+    // disable the port
+    hal_spi_set_enabled(bus, false);
+
+    // clear the fifo, start only on pos edge of Slave-sel-B
+    hal_spi_clear_rx_fifo(bus);
+
+    return HAL_SPI_ERROR_ALL_OK;
+}
+
+void hal_spi_shutdown(Hal_SPI_Bus_t bus)
+{
+    MXC_SPI_Shutdown(spi_regs(bus));
+}
+
+void hal_spi_set_enabled(Hal_SPI_Bus_t bus, bool enabled)
+{
+    if (enabled)
+    {
+        spi_regs(bus)->ctrl0 |= MXC_F_SPI_CTRL0_EN;
+    }
+    else
+    {
+        spi_regs(bus)->ctrl0 &= ~MXC_F_SPI_CTRL0_EN;
+    }
+}
+
+void hal_spi_clear_rx_fifo(Hal_SPI_Bus_t bus)
+{
+    MXC_SPI_ClearRXFIFO(spi_regs(bus));
+}
+
+Hal_SPI_Error_t hal_spi_enable_rx_dma(Hal_SPI_Bus_t bus, uint32_t threshold_in_bytes)
+{
+    spi_regs(bus)->dma |= MXC_F_SPI_DMA_RX_FIFO_EN;
+    if (MXC_SPI_SetRXThreshold(spi_regs(bus), threshold_in_bytes) != E_NO_ERROR)
+    {
+        return HAL_SPI_ERROR_CONFIG_ERROR;
+    }
+    spi_regs(bus)->dma |= MXC_F_SPI_DMA_RX_DMA_EN;
+
+    return HAL_SPI_ERROR_ALL_OK;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+mxc_spi_regs_t *spi_regs(Hal_SPI_Bus_t bus)
+{
+    return bus == HAL_SPI_BUS_1 ? MXC_SPI1 : MXC_SPI2;
+}
+
+bool set_format(Hal_SPI_Bus_t bus, Hal_SPI_Mode_t mode, Hal_SPI_Width_t width)
+{
+    static const mxc_spi_mode_t modes[] = {
+        [HAL_SPI_MODE_0] = SPI_MODE_0,
+        [HAL_SPI_MODE_1] = SPI_MODE_1,
+        [HAL_SPI_MODE_2] = SPI_MODE_2,
+        [HAL_SPI_MODE_3] = SPI_MODE_3,
+    };
+
+    const mxc_spi_width_t spi_width = width == HAL_SPI_WIDTH_3WIRE ? SPI_WIDTH_3WIRE : SPI_WIDTH_STANDARD;
+
+    return MXC_SPI_SetWidth(spi_regs(bus), spi_width) == E_NO_ERROR &&
+           MXC_SPI_SetMode(spi_regs(bus), modes[mode]) == E_NO_ERROR;
+}
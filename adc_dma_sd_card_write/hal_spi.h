@@ -0,0 +1,118 @@
+/**
+ * @file      hal_spi.h
+ * @brief     A thin hardware abstraction of the SPI busses is represented here.
+ * @details   A bus is either a master, for blocking transactions with a device, or a slave that only receives, with
+ *            the received bytes moved to memory by the DMA, see hal_dma.h. `hal_spi.c` is the MSDK back-end for the
+ *            MAX32666, the host back-end in test/host_sim hands master transactions to a device model. Chip selects
+ *            of master busses are driven by the caller with hal_gpio.h.
+ */
+
+#ifndef HAL_SPI_H_
+#define HAL_SPI_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief SPI errors are represented here
+ */
+typedef enum
+{
+    HAL_SPI_ERROR_ALL_OK,
+    HAL_SPI_ERROR_CONFIG_ERROR,
+    HAL_SPI_ERROR_TRANSACTION_ERROR,
+} Hal_SPI_Error_t;
+
+/**
+ * @brief The SPI busses of the MAX32666 we use are represented here, on their pin mapping A
+ */
+typedef enum
+{
+    HAL_SPI_BUS_1 = 0,
+    HAL_SPI_BUS_2,
+    HAL_SPI_NUM_BUSES,
+} Hal_SPI_Bus_t;
+
+/**
+ * @brief The SPI clock polarity and phase modes are represented here
+ */
+typedef enum
+{
+    HAL_SPI_MODE_0 = 0,
+    HAL_SPI_MODE_1,
+    HAL_SPI_MODE_2,
+    HAL_SPI_MODE_3,
+} Hal_SPI_Mode_t;
+
+/**
+ * @brief The SPI data line widths are represented here
+ */
+typedef enum
+{
+    HAL_SPI_WIDTH_STANDARD = 0, // separate MOSI and MISO lines
+    HAL_SPI_WIDTH_3WIRE,        // a single bidirectional data line
+} Hal_SPI_Width_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_spi_master_init(b, f, m, w)` sets up bus `b` as a master with one device, 8 bit words, a clock of `f`
+ * Hz, mode `m`, and width `w`.
+ *
+ * @post `hal_spi_master_transaction()` can be used on `b`.
+ *
+ * @retval `HAL_SPI_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_SPI_Error_t hal_spi_master_init(Hal_SPI_Bus_t bus, uint32_t clk_freq_hz, Hal_SPI_Mode_t mode, Hal_SPI_Width_t width);
+
+/**
+ * @brief `hal_spi_master_transaction(b, t, tl, r, rl)` sends the `tl` bytes of `t` on bus `b` and stores the first
+ * `rl` bytes received in `r`, blocking until it is done.
+ *
+ * @pre `b` is set up as a master and the device is selected.
+ *
+ * @param rx_buff where to store the received bytes, may be NULL if `rl` is 0.
+ *
+ * @retval `HAL_SPI_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_SPI_Error_t hal_spi_master_transaction(Hal_SPI_Bus_t bus, const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len);
+
+/**
+ * @brief `hal_spi_slave_init(b, m, w)` sets up bus `b` as a receive only slave with 8 bit words, mode `m`, and width
+ * `w`, clocked by the master.
+ *
+ * @pre the master is driving the bus clock.
+ *
+ * @post `b` is disabled with an empty receive FIFO, ready for `hal_spi_enable_rx_dma()` and `hal_spi_set_enabled()`.
+ *
+ * @retval `HAL_SPI_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_SPI_Error_t hal_spi_slave_init(Hal_SPI_Bus_t bus, Hal_SPI_Mode_t mode, Hal_SPI_Width_t width);
+
+/**
+ * @brief `hal_spi_shutdown(b)` shuts bus `b` down and releases its pins.
+ */
+void hal_spi_shutdown(Hal_SPI_Bus_t bus);
+
+/**
+ * @brief `hal_spi_set_enabled(b, e)` starts bus `b` moving data if `e` is true, else stops it.
+ */
+void hal_spi_set_enabled(Hal_SPI_Bus_t bus, bool enabled);
+
+/**
+ * @brief `hal_spi_clear_rx_fifo(b)` throws away any bytes waiting in the receive FIFO of bus `b`.
+ */
+void hal_spi_clear_rx_fifo(Hal_SPI_Bus_t bus);
+
+/**
+ * @brief `hal_spi_enable_rx_dma(b, t)` makes bus `b` request the DMA each time its receive FIFO holds `t` bytes.
+ *
+ * @retval `HAL_SPI_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_SPI_Error_t hal_spi_enable_rx_dma(Hal_SPI_Bus_t bus, uint32_t threshold_in_bytes);
+
+#endif /* HAL_SPI_H_ */
@@ -1,23 +1,54 @@
 
 /* Private includes --------------------------------------------------------------------------------------------------*/
 
-#include <stdio.h>
 #include <stdint.h>
 #include "led.h"
 #include "board.h"
-#include "mxc_delay.h"
-#include "tmr.h"
 
 #include "ad4630.h"
 #include "audio_dma.h"
-#include "data_converters.h"
-#include "decimation_filter.h"
+#include "cycle_counter.h"
+#include "date_dirs.h"
 #include "demo_config.h"
+#include "duty_cycle.h"
+#include "gain_control.h"
 #include "gpio_helpers.h"
+#include "hal_gpio.h"
+#include "hal_i2c.h"
+#include "hal_timer.h"
+#include "real_time_clock.h"
+#include "rtc_sync.h"
+#include "scheduler.h"
 #include "sd_card.h"
+#include "sd_card_bank_ctl.h"
+#include "storage_manager.h"
+#include "trace_log.h"
 #include "wav_header.h"
+#include "wav_recorder.h"
+#include "wav_writer.h"
 
-#include <string.h>
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// this I2C bus serves the RTC and other peripherals
+#define I2C_3V3 (HAL_I2C_BUS_1)
+
+// this I2C bus serves the AFE gain switches, its pins stay in the VDDIO domain
+#define I2C_1V8 (HAL_I2C_BUS_0)
+
+// the timers of the scheduler count ticks of this period
+#define SCHEDULER_TICK_PERIOD_IN_MICROSECS (1000)
+
+#define FAST_BLINK_PERIOD_IN_MILLISECS (100)
+#define SLOW_BLINK_PERIOD_IN_MILLISECS (1000)
+
+#define PAUSE_BETWEEN_RECORDINGS_IN_MILLISECS (500)
+
+// the events of the demo task
+#define DEMO_EVENT_START_NEXT_RECORDING (1u << 0)
+#define DEMO_EVENT_RECORDING_DONE (1u << 1)
+
+// the event of the LED task
+#define LED_EVENT_TOGGLE (1u << 0)
 
 /* Private enumerations ----------------------------------------------------------------------------------------------*/
 
@@ -31,26 +62,70 @@ typedef enum
     LED_COLOR_BLUE,
 } LED_Color_t;
 
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the demo task records every combination of sample rate and bit depth in demo_config.h in turn, with a pause between
+// the recordings, while the LED task blinks the LEDs, and the gain and RTC sync tasks of gain_control.c and rtc_sync.c
+// run in between the DMA blocks
+static Scheduler_Task_t demo_task;
+static Scheduler_Timer_t next_recording_timer;
+static Scheduler_Task_t led_task;
+static Scheduler_Timer_t blink_timer;
+
+static LED_Color_t blink_color;
+
+// the combination being recorded, counting through the bit depths of each sample rate
+static uint32_t recording_idx = 0;
+
+static Wave_Header_Attributes_t wav_attr = {
+    .num_channels = WAVE_HEADER_MONO, // only mono is supported for now, 2 channel might be added later
+};
+
+// how the last recording went, passed from the done callback of the recorder to the demo task
+static Wav_Recorder_Error_t recording_err;
+
 /* Private function declarations -------------------------------------------------------------------------------------*/
 
+// the error handler rapidly blinks the given LED color forever, it is only called before the scheduler runs
+static void error_handler(LED_Color_t c);
+
 /**
- * @brief `write_demo_wav_file(a, l)` writes a wav file with attributes `a`, and length in seconds `l`, with a name
- * derived from the attributes. Calling this function starts the ADC/DMA and continuously records audio in blocking
- * fashion until the time is up.
- *
- * @pre initialization is complete for the ADC, DMA, decimation filters, and SD card, the SD card must be mounted
- *
- * @param wav_attr pointer to the wav header attributes structure holding information about sample rate, bit depth, etc
- *
- * @param file_len_secs the length of the audio file to write, in seconds
- *
- * @post this function consumes buffers from the ADC/DMA until the duration of the file length has elapsed and writes
- * the audio data out to a .wav file on the SD card. The wav header for the file is also written in this function.
+ * @brief `run_demo(e)` is the demo task, it starts the next recording, and when a recording is done it shows any error,
+ * or waits for the pause between recordings to start the next one, or finishes the demo after the last one.
  */
-static void write_demo_wav_file(Wave_Header_Attributes_t *wav_attr, uint32_t file_len_secs);
+static void run_demo(Scheduler_Events_t events);
 
-// the error handler simply rapidly blinks the given LED color forever
-static void error_handler(LED_Color_t c);
+/**
+ * @brief `on_recording_done(e)` is the done callback of the recorder, it hands error `e` to the demo task.
+ */
+static void on_recording_done(Wav_Recorder_Error_t err);
+
+/**
+ * @brief `show_recording_error(e)` blinks the LED for recording error `e` forever, red for the SD card and blue for
+ * the rest.
+ */
+static void show_recording_error(Wav_Recorder_Error_t err);
+
+/**
+ * @brief `finish_demo()` unmounts the SD card and slowly blinks green to show the demo is done.
+ */
+static void finish_demo();
+
+/**
+ * @brief `toggle_led(e)` is the LED task, it toggles the blinking LED each time the blink timer expires.
+ */
+static void toggle_led(Scheduler_Events_t events);
+
+/**
+ * @brief `start_blinking(c, p)` turns every LED off, then toggles LED `c` every `p` milliseconds.
+ */
+static void start_blinking(LED_Color_t color, uint32_t period_millisecs);
+
+/**
+ * @brief `on_tick(n)` moves the clock of the scheduler on by `n` ticks, it runs in the timer interrupt, or from the
+ * idle hook after the ticks were held off while the core slept.
+ */
+static void on_tick(uint32_t num_periods);
 
 /* Public function definitions ---------------------------------------------------------------------------------------*/
 
@@ -59,6 +134,17 @@ int main(void)
     // blue led on during initialization
     LED_On(LED_COLOR_BLUE);
 
+    // the LED task blinks the errors of the rest of the initialization, nothing can blink without it, so the blue LED
+    // just stays on if it can't be set up
+    if (scheduler_add_task(toggle_led, SCHEDULER_PRIORITY_NORMAL, &led_task) != SCHEDULER_ERROR_ALL_OK ||
+        scheduler_add_timer(led_task, LED_EVENT_TOGGLE, &blink_timer) != SCHEDULER_ERROR_ALL_OK ||
+        hal_timer_start_tick(SCHEDULER_TICK_PERIOD_IN_MICROSECS, on_tick) != HAL_TIMER_ERROR_ALL_OK)
+    {
+        while (true)
+        {
+        }
+    }
+
     gpio_profiling_pin_init();
 
     if (ad4630_init() != AD4630_ERROR_ALL_OK)
@@ -70,232 +156,226 @@ int main(void)
         error_handler(LED_COLOR_BLUE);
     }
 
-    if (sd_card_init() != SD_CARD_ERROR_ALL_OK)
-    {
-        error_handler(LED_COLOR_RED);
-    }
-
-    if (sd_card_mount() != SD_CARD_ERROR_ALL_OK)
+    if (hal_i2c_init(I2C_3V3, HAL_I2C_SPEED_STANDARD) != HAL_I2C_ERROR_ALL_OK)
     {
-        error_handler(LED_COLOR_RED);
+        error_handler(LED_COLOR_BLUE);
     }
-
-    Wave_Header_Attributes_t wav_attr = {
-        .num_channels = WAVE_HEADER_MONO, // only mono is supported for now, 2 channel might be added later
+    // I2C pins default to VDDIO for the logical high voltage, we want VDDIOH for 3.3v pullups
+    const Hal_GPIO_Pin_t i2c1_pins = {
+        .port = HAL_GPIO_PORT_0,
+        .mask = (HAL_GPIO_PIN(14) | HAL_GPIO_PIN(15)),
+        .func = HAL_GPIO_FUNC_ALT1,
+        .voltage = HAL_GPIO_VOLTAGE_VDDIOH,
+        .drive_strength = HAL_GPIO_DRIVE_STRENGTH_0,
     };
+    hal_gpio_config(&i2c1_pins);
 
-    LED_Off(LED_COLOR_BLUE);
+    // applies to every card mounted from here on
+    sd_card_set_write_unit(DEMO_CONFIG_SD_CARD_WRITE_UNIT_IN_BYTES);
 
-    for (uint32_t sr = 0; sr < DEMO_CONFIG_NUM_SAMPLE_RATES_TO_TEST; sr++)
+    // the RTC only names the files, so the demo carries on without it and the recorder falls back to a default time
+    real_time_clock_init(I2C_3V3);
+
+#if DEMO_CONFIG_CONTROL_AFE_GAIN == 1
+    // the gain task sets the gain before the first recording starts, and keeps it set from then on
+    if (hal_i2c_init(I2C_1V8, HAL_I2C_SPEED_STANDARD) != HAL_I2C_ERROR_ALL_OK ||
+        gain_control_init(I2C_1V8, DEMO_CONFIG_AFE_GAIN, DEMO_CONFIG_AFE_GAIN_CHECK_PERIOD_IN_SECONDS) != GAIN_CONTROL_ERROR_ALL_OK)
     {
-        for (uint32_t bd = 0; bd < DEMO_CONFIG_NUM_BIT_DEPTHS_TO_TEST; bd++)
-        {
-            // green led on during recording
-            LED_On(LED_COLOR_GREEN);
-            wav_attr.sample_rate = demo_sample_rates_to_test[sr];
-            wav_attr.bits_per_sample = demo_bit_depths_to_test[bd];
-            write_demo_wav_file(&wav_attr, DEMO_CONFIG_AUDIO_FILE_LEN_IN_SECONDS);
-            LED_Off(LED_COLOR_GREEN);
+        error_handler(LED_COLOR_BLUE);
+    }
+#endif
 
-            MXC_Delay(500000);
-        }
+#if DEMO_CONFIG_SYNC_RTC_TO_GNSS == 1
+    // the GNSS module is optional, a sync without it just times out, the sync task polls it between the DMA blocks
+    if (rtc_sync_init(DEMO_CONFIG_GNSS_SYNC_TIMEOUT_IN_SECONDS, DEMO_CONFIG_GNSS_RESYNC_PERIOD_IN_SECONDS) != RTC_SYNC_ERROR_ALL_OK)
+    {
+        error_handler(LED_COLOR_BLUE);
     }
+#endif
 
-    if (sd_card_unmount() != SD_CARD_ERROR_ALL_OK)
+#if DEMO_CONFIG_USE_SD_CARD_BANK == 1
+    // the SD card bank shares the I2C bus with the RTC, every card is checked and the first one with room is mounted
+    if (sd_card_bank_ctl_init(I2C_3V3) != SD_CARD_BANK_CTL_ERROR_ALL_OK)
     {
         error_handler(LED_COLOR_RED);
     }
 
-    // do a slow green blink to indicate success
-    const uint32_t slow_blink = 1000000;
-    while (1)
+    if (storage_manager_init() != STORAGE_MANAGER_ERROR_ALL_OK)
     {
-        LED_On(LED_COLOR_GREEN);
-        MXC_Delay(slow_blink);
-        LED_Off(LED_COLOR_GREEN);
-        MXC_Delay(slow_blink);
+        error_handler(LED_COLOR_RED);
+    }
+#else
+    if (sd_card_init() != SD_CARD_ERROR_ALL_OK)
+    {
+        error_handler(LED_COLOR_RED);
     }
-}
-
-/* Private function definitions --------------------------------------------------------------------------------------*/
-
-void write_demo_wav_file(Wave_Header_Attributes_t *wav_attr, uint32_t file_len_secs)
-{
-    // a buffers for processing the audio data, big enough to fit one full buffers worth of samples as q31s
-    static uint8_t audio_buff_0[AUDIO_DMA_BUFF_LEN_IN_SAMPS * 4];
-    static uint8_t audio_buff_1[AUDIO_DMA_BUFF_LEN_IN_SAMPS * 4];
-
-    // a variable to store the number of bytes written to the SD card, can be checked against the intended amount
-    static uint32_t bytes_written;
-
-    // a string buffer to write file names into
-    static char file_name_buff[64];
-
-    // there will be some integer truncation here, good enough for this early demo, but improve file-len code eventually
-    const uint32_t file_len_in_microsecs = file_len_secs * 1000000;
-    const uint32_t num_dma_blocks_in_the_file = file_len_in_microsecs / AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS;
-
-#if DEMO_CONFIG_GENERATE_CSV_OF_WRITE_TIMES == 1
-    // for misc SD card writing, a buffer to sprintf into
-    static char str_buff[64] = {0};
 
-    // we'll store the time it takes to write out each block here
-    static uint32_t block_write_time_microsecs[4000] = {0}; // 4k is enough if we stay under 70 seconds
+    if (sd_card_mount() != SD_CARD_ERROR_ALL_OK)
+    {
+        error_handler(LED_COLOR_RED);
+    }
 #endif
 
-    // derive the file name from the input parameters
-    sprintf(file_name_buff, "demo_%dkHz_%d_bit.wav", wav_attr->sample_rate / 1000, wav_attr->bits_per_sample);
-
-    if (sd_card_fopen(file_name_buff, POSIX_FILE_MODE_WRITE) != SD_CARD_ERROR_ALL_OK)
+    // repair any recording a power cut left unfinished before we start new ones, the count is only of interest when
+    // debugging. Cards of the SD card bank are filled in turn, so the one being written when the power was cut is the
+    // first one with room, the one mounted now
+    uint32_t num_files_repaired;
+    if (wav_writer_recover_dir("/", &num_files_repaired) != WAV_WRITER_ERROR_ALL_OK)
     {
         error_handler(LED_COLOR_RED);
     }
 
-    // seek past the wave header, we'll fill it in later after recording the audio, we'll know the file length then
-    if (sd_card_lseek(wav_header_get_header_length()) != SD_CARD_ERROR_ALL_OK)
+#if DEMO_CONFIG_SHARD_FILES_BY_DATE == 1
+    // files named after the time are kept in day directories, the one the power was cut in is the latest
+    static char day_dir_path[DATE_DIRS_PREFIX_LEN + 2];
+    if (date_dirs_find_latest("/", day_dir_path) && wav_writer_recover_dir(day_dir_path, &num_files_repaired) != WAV_WRITER_ERROR_ALL_OK)
     {
         error_handler(LED_COLOR_RED);
     }
+#endif
+    (void)num_files_repaired;
 
-    decimation_filter_set_sample_rate(wav_attr->sample_rate);
-
-    ad4630_cont_conversions_start();
-    audio_dma_start();
+    // timestamps the trace, times the stages of the pipeline, and counts the time the core is awake
+    cycle_counter_init();
 
-    for (uint32_t num_dma_blocks_written = 0; num_dma_blocks_written < num_dma_blocks_in_the_file;)
-    {
-        if (audio_dma_overrun_occured())
-        {
-            error_handler(LED_COLOR_BLUE);
-        }
-
-        while (audio_dma_num_buffers_available() > 0)
-        {
-#if DEMO_CONFIG_GENERATE_CSV_OF_WRITE_TIMES == 1
-            MXC_TMR_SW_Start(MXC_TMR1); // for profiling the time it takes to filter and write out the buffer
+#if DEMO_CONFIG_SLEEP_WHEN_IDLE == 1
+    // the core sleeps whenever no task has anything to do, the DMA, the software interrupt, and the tick wake it
+    scheduler_set_idle_hook(duty_cycle_sleep_while_idle);
 #endif
-            if (wav_attr->sample_rate == WAVE_HEADER_SAMPLE_RATE_384kHz)
-            {
-                // for 384kHz data, we just need to swap the endianness of the sample to little-endian format needed for WAV
-                data_converters_i24_swap_endianness(audio_dma_consume_buffer(), audio_buff_0, AUDIO_DMA_BUFF_LEN_IN_BYTES);
-
-                if (wav_attr->bits_per_sample == WAVE_HEADER_24_BITS_PER_SAMPLE)
-                {
-                    if (sd_card_fwrite(audio_buff_0, AUDIO_DMA_BUFF_LEN_IN_BYTES, &bytes_written) != SD_CARD_ERROR_ALL_OK)
-                    {
-                        error_handler(LED_COLOR_RED);
-                    }
-                }
-                else // it must be 16 bits
-                {
-                    const uint32_t len = data_converters_i24_to_q15(audio_buff_0, (q15_t *)audio_buff_0, AUDIO_DMA_BUFF_LEN_IN_BYTES);
-
-                    if (sd_card_fwrite(audio_buff_0, len, &bytes_written) != SD_CARD_ERROR_ALL_OK)
-                    {
-                        error_handler(LED_COLOR_RED);
-                    }
-                }
-            }
-            else // it's not the special case of 384kHz, all other sample rates are filtered
-            {
-                // all sample rates other than 384k are filtered, so we need to swap endianness and also expand to 32 bit words as expected by the filters
-                data_converters_i24_to_q31_with_endian_swap(audio_dma_consume_buffer(), (q31_t *)audio_buff_0, AUDIO_DMA_BUFF_LEN_IN_BYTES);
-
-                const uint32_t len_in_samps = decimation_filter_downsample(
-                    (q31_t *)audio_buff_0,
-                    (q31_t *)audio_buff_1,
-                    AUDIO_DMA_BUFF_LEN_IN_SAMPS); // we want num samples, not num bytes
-
-                // note that the data conversion functions for truncating down to 16 and 24 bits can work in-place
-                uint32_t len_in_bytes;
-                if (wav_attr->bits_per_sample == WAVE_HEADER_24_BITS_PER_SAMPLE)
-                {
-                    len_in_bytes = data_converters_q31_to_i24((q31_t *)audio_buff_1, audio_buff_1, len_in_samps);
-                }
-                else // it's 16 bits
-                {
-                    len_in_bytes = data_converters_q31_to_q15((q31_t *)audio_buff_1, (q15_t *)audio_buff_1, len_in_samps);
-                }
-
-                if (sd_card_fwrite(audio_buff_1, len_in_bytes, &bytes_written) != SD_CARD_ERROR_ALL_OK)
-                {
-                    error_handler(LED_COLOR_RED);
-                }
-            }
-
-#if DEMO_CONFIG_GENERATE_CSV_OF_WRITE_TIMES == 1
-            const uint32_t time_to_filter_and_write_the_block = MXC_TMR_SW_Stop(MXC_TMR1);
-            block_write_time_microsecs[num_dma_blocks_written] = time_to_filter_and_write_the_block;
+
+#if DEMO_CONFIG_WRITE_TRACE_LOG == 1
+    // the trace of each recording is appended to the trace file once the recording stops
+    trace_log_start(DEMO_CONFIG_TRACE_LOG_FILE_NAME);
 #endif
 
-            num_dma_blocks_written += 1;
-        }
+    // the recorder writes the audio from a task of its own, the demo task starts each recording and waits for it
+    if (wav_recorder_init() != WAV_RECORDER_ERROR_ALL_OK)
+    {
+        error_handler(LED_COLOR_BLUE);
     }
 
-    ad4630_cont_conversions_stop();
-    audio_dma_stop();
-
-    // back to the top of the file so we can write the wav header now that we can determine the size of the file
-    if (sd_card_lseek(0) != SD_CARD_ERROR_ALL_OK)
+    if (scheduler_add_task(run_demo, SCHEDULER_PRIORITY_NORMAL, &demo_task) != SCHEDULER_ERROR_ALL_OK ||
+        scheduler_add_timer(demo_task, DEMO_EVENT_START_NEXT_RECORDING, &next_recording_timer) != SCHEDULER_ERROR_ALL_OK)
     {
-        error_handler(LED_COLOR_RED);
+        error_handler(LED_COLOR_BLUE);
     }
 
-    wav_attr->file_length = sd_card_fsize();
-    wav_header_set_attributes(wav_attr);
+    LED_Off(LED_COLOR_BLUE);
 
-    if (sd_card_fwrite(wav_header_get_header(), wav_header_get_header_length(), &bytes_written) != SD_CARD_ERROR_ALL_OK)
-    {
-        error_handler(LED_COLOR_RED);
-    }
+    // from here on everything happens in the tasks
+    scheduler_post(demo_task, DEMO_EVENT_START_NEXT_RECORDING);
+    scheduler_run();
+}
 
-    if (sd_card_fclose() != SD_CARD_ERROR_ALL_OK)
-    {
-        error_handler(LED_COLOR_RED);
-    }
+/* Private function definitions --------------------------------------------------------------------------------------*/
 
-#if DEMO_CONFIG_GENERATE_CSV_OF_WRITE_TIMES == 1
-    // write a file summary of the time taken to filter and write each DMA block
-    if (sd_card_fopen("block_write_times_microsec.csv", POSIX_FILE_MODE_APPEND) != SD_CARD_ERROR_ALL_OK)
+void error_handler(LED_Color_t color)
+{
+    start_blinking(color, FAST_BLINK_PERIOD_IN_MILLISECS);
+
+    // nothing else is running yet, so only the LED task ever runs
+    scheduler_run();
+
+    while (true)
     {
-        error_handler(LED_COLOR_RED);
     }
+}
 
-    const uint32_t len = sprintf(str_buff, "\n%dk-%dbit,", wav_attr->sample_rate / 1000, wav_attr->bits_per_sample);
-    if (sd_card_fwrite(str_buff, len, &bytes_written) != SD_CARD_ERROR_ALL_OK)
+void run_demo(Scheduler_Events_t events)
+{
+    if (events & DEMO_EVENT_RECORDING_DONE)
     {
-        error_handler(LED_COLOR_RED);
+        LED_Off(LED_COLOR_GREEN);
+
+        if (recording_err != WAV_RECORDER_ERROR_ALL_OK)
+        {
+            show_recording_error(recording_err);
+            return;
+        }
+
+        recording_idx += 1;
+
+        if (recording_idx == DEMO_CONFIG_NUM_SAMPLE_RATES_TO_TEST * DEMO_CONFIG_NUM_BIT_DEPTHS_TO_TEST)
+        {
+            finish_demo();
+            return;
+        }
+
+        scheduler_timer_start(next_recording_timer, PAUSE_BETWEEN_RECORDINGS_IN_MILLISECS, 0);
     }
 
-    for (uint32_t i = 0; i < num_dma_blocks_in_the_file; i++)
+    if (events & DEMO_EVENT_START_NEXT_RECORDING)
     {
-        const uint32_t len = sprintf(str_buff, "%d,", block_write_time_microsecs[i]);
-
-        if (sd_card_fwrite(str_buff, len, &bytes_written) != SD_CARD_ERROR_ALL_OK)
+        // green led on during recording
+        LED_On(LED_COLOR_GREEN);
+        wav_attr.sample_rate = demo_sample_rates_to_test[recording_idx / DEMO_CONFIG_NUM_BIT_DEPTHS_TO_TEST];
+        wav_attr.bits_per_sample = demo_bit_depths_to_test[recording_idx % DEMO_CONFIG_NUM_BIT_DEPTHS_TO_TEST];
+#if DEMO_CONFIG_NUM_FILES_PER_RECORDING > 1
+        const Wav_Recorder_Error_t err = wav_recorder_start_continuous(
+            &wav_attr,
+            wav_recorder_secs_to_samples(&wav_attr, DEMO_CONFIG_AUDIO_FILE_LEN_IN_SECONDS),
+            DEMO_CONFIG_NUM_FILES_PER_RECORDING,
+            on_recording_done);
+#else
+        const Wav_Recorder_Error_t err = wav_recorder_start_demo_file(
+            &wav_attr,
+            wav_recorder_secs_to_samples(&wav_attr, DEMO_CONFIG_AUDIO_FILE_LEN_IN_SECONDS),
+            on_recording_done);
+#endif
+        if (err != WAV_RECORDER_ERROR_ALL_OK)
         {
-            error_handler(LED_COLOR_RED);
+            LED_Off(LED_COLOR_GREEN);
+            show_recording_error(err);
         }
     }
+}
 
-    if (sd_card_fclose() != SD_CARD_ERROR_ALL_OK)
+void on_recording_done(Wav_Recorder_Error_t err)
+{
+    recording_err = err;
+    scheduler_post(demo_task, DEMO_EVENT_RECORDING_DONE);
+}
+
+void show_recording_error(Wav_Recorder_Error_t err)
+{
+    start_blinking(err == WAV_RECORDER_ERROR_SD_CARD_ERROR ? LED_COLOR_RED : LED_COLOR_BLUE, FAST_BLINK_PERIOD_IN_MILLISECS);
+}
+
+void finish_demo()
+{
+    if (sd_card_unmount() != SD_CARD_ERROR_ALL_OK)
     {
-        error_handler(LED_COLOR_RED);
+        start_blinking(LED_COLOR_RED, FAST_BLINK_PERIOD_IN_MILLISECS);
+        return;
     }
+
+#if DEMO_CONFIG_USE_SD_CARD_BANK == 1
+    sd_card_bank_ctl_disable_all();
 #endif
+
+    // do a slow green blink to indicate success
+    start_blinking(LED_COLOR_GREEN, SLOW_BLINK_PERIOD_IN_MILLISECS);
 }
 
-void error_handler(LED_Color_t color)
+void toggle_led(Scheduler_Events_t events)
+{
+    (void)events;
+
+    LED_Toggle(blink_color);
+}
+
+void start_blinking(LED_Color_t color, uint32_t period_millisecs)
 {
     LED_Off(LED_COLOR_RED);
     LED_Off(LED_COLOR_GREEN);
     LED_Off(LED_COLOR_BLUE);
 
-    const uint32_t fast_blink = 100000;
-    while (true)
-    {
-        LED_On(color);
-        MXC_Delay(fast_blink);
-        LED_Off(color);
-        MXC_Delay(fast_blink);
-    }
+    blink_color = color;
+    LED_On(blink_color);
+    scheduler_timer_start(blink_timer, period_millisecs, period_millisecs);
+}
+
+void on_tick(uint32_t num_periods)
+{
+    scheduler_tick(num_periods * (SCHEDULER_TICK_PERIOD_IN_MICROSECS / 1000));
 }
@@ -20,6 +20,29 @@ LIB_SDHC = 1
 
 FATFS_VERSION = ff15
 
+# the modules shared between snippets that this one uses, AUTOSEARCH only covers this directory
+include ../magpie_core/core.mk
+SRCS += $(MAGPIE_CORE_DIR)/sd_card.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_sdhc.c
+SRCS += $(MAGPIE_CORE_DIR)/write_coalescer.c
+SRCS += $(MAGPIE_CORE_DIR)/wav_header.c
+SRCS += $(MAGPIE_CORE_DIR)/ima_adpcm.c
+SRCS += $(MAGPIE_CORE_DIR)/scheduler.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_sleep.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_timer.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_gpio.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_i2c.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_uart.c
+SRCS += $(MAGPIE_CORE_DIR)/sd_card_bank_ctl.c
+SRCS += $(MAGPIE_CORE_DIR)/afe_control.c
+SRCS += $(MAGPIE_CORE_DIR)/gnss_module.c
+
+# the NMEA parser gnss_module.c uses, minmea calls timegm() which newlib doesn't have, the RTC runs in UTC so mktime()
+# does the same
+IPATH += $(MAGPIE_CORE_DIR)/third_party/minmea
+SRCS += $(MAGPIE_CORE_DIR)/third_party/minmea/minmea.c
+PROJ_CFLAGS += -Dtimegm=mktime
+
 LIB_CMSIS_DSP = 1
 
 MXC_OPTIMIZE_CFLAGS = -O2
@@ -0,0 +1,160 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "gnss_module.h"
+#include "real_time_clock.h"
+#include "rtc_sync.h"
+#include "scheduler.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the UART buffer fills in about 250ms at 9600 baud, so it is drained well before that
+#define POLL_PERIOD_IN_MILLISECS (100)
+
+// the events of the sync task
+#define SYNC_EVENT_START (1u << 0)
+#define SYNC_EVENT_POLL (1u << 1)
+#define SYNC_EVENT_TIMEOUT (1u << 2)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static Scheduler_Task_t sync_task;
+static Scheduler_Timer_t start_timer;
+static Scheduler_Timer_t poll_timer;
+static Scheduler_Timer_t timeout_timer;
+
+static uint32_t sync_timeout_in_millisecs;
+static uint32_t resync_period_in_millisecs;
+
+static bool is_syncing = false;
+
+static uint32_t num_syncs = 0;
+static uint32_t num_failures = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `run_sync(e)` is the sync task, it starts a sync, polls the GNSS module for a fix, and ends the sync when it
+ * finds one, on an error, or when the sync times out.
+ */
+static void run_sync(Scheduler_Events_t events);
+
+/**
+ * @brief `start_sync()` powers up the GNSS module and starts polling it.
+ */
+static void start_sync();
+
+/**
+ * @brief `end_sync(s)` powers down the GNSS module, counts a sync if `s` is true or a failure if not, and schedules the
+ * next sync.
+ */
+static void end_sync(bool synced);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+RTC_Sync_Error_t rtc_sync_init(uint32_t timeout_secs, uint32_t resync_period_secs)
+{
+    sync_timeout_in_millisecs = timeout_secs * 1000;
+    resync_period_in_millisecs = resync_period_secs * 1000;
+
+    if (gnss_module_init() != GNSS_MODULE_ERROR_ALL_OK)
+    {
+        return RTC_SYNC_ERROR_GNSS_ERROR;
+    }
+
+    // the audio always comes first, a poll can wait for a write, the UART buffer covers it
+    if (scheduler_add_task(run_sync, SCHEDULER_PRIORITY_NORMAL, &sync_task) != SCHEDULER_ERROR_ALL_OK ||
+        scheduler_add_timer(sync_task, SYNC_EVENT_START, &start_timer) != SCHEDULER_ERROR_ALL_OK ||
+        scheduler_add_timer(sync_task, SYNC_EVENT_POLL, &poll_timer) != SCHEDULER_ERROR_ALL_OK ||
+        scheduler_add_timer(sync_task, SYNC_EVENT_TIMEOUT, &timeout_timer) != SCHEDULER_ERROR_ALL_OK)
+    {
+        return RTC_SYNC_ERROR_SCHEDULER_ERROR;
+    }
+
+    scheduler_post(sync_task, SYNC_EVENT_START);
+
+    return RTC_SYNC_ERROR_ALL_OK;
+}
+
+uint32_t rtc_sync_num_syncs()
+{
+    return num_syncs;
+}
+
+uint32_t rtc_sync_num_failures()
+{
+    return num_failures;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void run_sync(Scheduler_Events_t events)
+{
+    if ((events & SYNC_EVENT_START) && !is_syncing)
+    {
+        start_sync();
+        return;
+    }
+
+    // a poll or a timeout may still come in after the sync ended
+    if (!is_syncing)
+    {
+        return;
+    }
+
+    if (events & SYNC_EVENT_POLL)
+    {
+        tm_t gnss_time;
+        bool has_fix;
+        if (gnss_module_sync_poll(&gnss_time, &has_fix) != GNSS_MODULE_ERROR_ALL_OK)
+        {
+            end_sync(false);
+            return;
+        }
+
+        if (has_fix)
+        {
+            end_sync(real_time_clock_set_datetime(&gnss_time) == REAL_TIME_CLOCK_ERROR_ALL_OK);
+            return;
+        }
+    }
+
+    if (events & SYNC_EVENT_TIMEOUT)
+    {
+        end_sync(false);
+    }
+}
+
+void start_sync()
+{
+    is_syncing = true;
+
+    gnss_module_enable();
+    gnss_module_sync_start();
+
+    scheduler_timer_start(poll_timer, POLL_PERIOD_IN_MILLISECS, POLL_PERIOD_IN_MILLISECS);
+    scheduler_timer_start(timeout_timer, sync_timeout_in_millisecs, 0);
+}
+
+void end_sync(bool synced)
+{
+    is_syncing = false;
+
+    scheduler_timer_stop(poll_timer);
+    scheduler_timer_stop(timeout_timer);
+    gnss_module_disable();
+
+    if (synced)
+    {
+        num_syncs += 1;
+    }
+    else
+    {
+        num_failures += 1;
+    }
+
+    if (resync_period_in_millisecs > 0)
+    {
+        scheduler_timer_start(start_timer, resync_period_in_millisecs, 0);
+    }
+}
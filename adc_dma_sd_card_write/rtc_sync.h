@@ -0,0 +1,62 @@
+/**
+ * @file      rtc_sync.h
+ * @brief     A task that keeps the real time clock in sync with GNSS time while the recorder runs is represented here.
+ * @details   The recorder names its files and stamps their bext chunks with the time on the real time clock, which
+ *            drifts a few seconds a month. With the optional GNSS module plugged in this task powers it up, parses
+ *            its NMEA sentences a poll at a time until it reports a good fix, sets the real time clock to the UTC time
+ *            of the fix, and powers it down again, then does it all again after the resync period. Each poll only
+ *            parses what the UART has buffered since the last one, so a sync runs alongside a recording, at a lower
+ *            priority than the write task, instead of holding it up for the half a minute or more a fix can take.
+ *
+ *            A recording keeps the start time it read from the real time clock, so a sync in the middle of it only
+ *            shows up in the names and timestamps of the files after the next start.
+ *
+ *            Without the GNSS module no fix ever comes, each sync gives up after its timeout and the recorder carries
+ *            on with the time it had.
+ */
+
+#ifndef RTC_SYNC_H_
+#define RTC_SYNC_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief RTC sync errors are represented here
+ */
+typedef enum
+{
+    RTC_SYNC_ERROR_ALL_OK,
+    RTC_SYNC_ERROR_GNSS_ERROR,
+    RTC_SYNC_ERROR_SCHEDULER_ERROR,
+} RTC_Sync_Error_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `rtc_sync_init(t, p)` adds the sync task to the scheduler and starts the first sync, each sync gives up `t`
+ * seconds after it starts, and the next starts `p` seconds after that, or never if `p` is 0.
+ *
+ * @pre `real_time_clock_init()` has been called.
+ *
+ * @post the GNSS module is powered up until the first sync ends.
+ *
+ * @retval `RTC_SYNC_ERROR_ALL_OK` if the sync task was started, else an error code
+ */
+RTC_Sync_Error_t rtc_sync_init(uint32_t timeout_secs, uint32_t resync_period_secs);
+
+/**
+ * @brief `rtc_sync_num_syncs()` is the number of times the real time clock was set from a GNSS fix.
+ */
+uint32_t rtc_sync_num_syncs();
+
+/**
+ * @brief `rtc_sync_num_failures()` is the number of syncs that timed out, or ended in an error of the GNSS module or
+ * the real time clock.
+ */
+uint32_t rtc_sync_num_failures();
+
+#endif /* RTC_SYNC_H_ */
@@ -0,0 +1,172 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "stage_profiler.h"
+#include "audio_dma.h"
+#include "cycle_counter.h"
+#include "trace_log.h"
+
+#include <string.h> // for memset
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static Stage_Profiler_Stats_t stats[STAGE_PROFILER_NUM_STAGES];
+
+// the cycle counter when each stage began
+static uint32_t begin_cycles[STAGE_PROFILER_NUM_STAGES];
+
+static uint32_t budget_cycles[STAGE_PROFILER_NUM_STAGES];
+
+static const uint32_t budget_in_percent[STAGE_PROFILER_NUM_STAGES] = {
+    [STAGE_PROFILER_STAGE_CONVERT] = STAGE_PROFILER_CONVERT_BUDGET_IN_PERCENT,
+    [STAGE_PROFILER_STAGE_DECIMATE] = STAGE_PROFILER_DECIMATE_BUDGET_IN_PERCENT,
+    [STAGE_PROFILER_STAGE_ENCODE] = STAGE_PROFILER_ENCODE_BUDGET_IN_PERCENT,
+    [STAGE_PROFILER_STAGE_WRITE] = STAGE_PROFILER_WRITE_BUDGET_IN_PERCENT,
+    [STAGE_PROFILER_STAGE_HEADER] = STAGE_PROFILER_HEADER_BUDGET_IN_PERCENT,
+};
+
+static const char *stage_names[STAGE_PROFILER_NUM_STAGES] = {
+    [STAGE_PROFILER_STAGE_CONVERT] = "convert",
+    [STAGE_PROFILER_STAGE_DECIMATE] = "decimate",
+    [STAGE_PROFILER_STAGE_ENCODE] = "encode",
+    [STAGE_PROFILER_STAGE_WRITE] = "write",
+    [STAGE_PROFILER_STAGE_HEADER] = "header",
+};
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `histogram_bin(c)` is the histogram bin for a call that took `c` cycles. Bin `2n` holds the calls from `2^n`
+ * to `1.5 * 2^n` cycles and bin `2n + 1` the rest up to `2^(n+1)`, calls of less than 2 cycles go in bin 0.
+ */
+static uint32_t histogram_bin(uint32_t cycles);
+
+/**
+ * @brief `histogram_bin_max_cycles(b)` is the longest call in cycles that goes in histogram bin `b`.
+ */
+static uint64_t histogram_bin_max_cycles(uint32_t bin);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void stage_profiler_reset()
+{
+    memset(stats, 0, sizeof(stats));
+
+    for (uint32_t i = 0; i < STAGE_PROFILER_NUM_STAGES; i++)
+    {
+        stats[i].min_cycles = UINT32_MAX;
+
+        const uint64_t budget_microsecs = ((uint64_t)AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS * budget_in_percent[i]) / 100;
+        budget_cycles[i] = (uint32_t)((budget_microsecs * cycle_counter_freq_hz()) / 1000000);
+    }
+}
+
+void stage_profiler_begin(Stage_Profiler_Stage_t stage)
+{
+    begin_cycles[stage] = cycle_counter_now();
+}
+
+void stage_profiler_end(Stage_Profiler_Stage_t stage)
+{
+    // the counter wraps around, the difference modulo 2^32 is right as long as the call took less than a wrap
+    const uint32_t cycles = cycle_counter_now() - begin_cycles[stage];
+    Stage_Profiler_Stats_t *s = &stats[stage];
+
+    s->num_calls += 1;
+    s->total_cycles += cycles;
+    s->histogram[histogram_bin(cycles)] += 1;
+
+    if (cycles < s->min_cycles)
+    {
+        s->min_cycles = cycles;
+    }
+
+    if (cycles > s->max_cycles)
+    {
+        s->max_cycles = cycles;
+    }
+
+    if (cycles > budget_cycles[stage])
+    {
+        s->num_over_budget += 1;
+        trace_log_event(TRACE_LOG_EVENT_OVER_BUDGET, (uint16_t)stage);
+    }
+}
+
+const Stage_Profiler_Stats_t *stage_profiler_get_stats(Stage_Profiler_Stage_t stage)
+{
+    return &stats[stage];
+}
+
+const char *stage_profiler_stage_name(Stage_Profiler_Stage_t stage)
+{
+    return stage_names[stage];
+}
+
+uint32_t stage_profiler_budget_microsecs(Stage_Profiler_Stage_t stage)
+{
+    return (AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS * budget_in_percent[stage]) / 100;
+}
+
+uint32_t stage_profiler_cycles_to_microsecs(uint64_t cycles)
+{
+    return (uint32_t)((cycles * 1000000) / cycle_counter_freq_hz());
+}
+
+uint32_t stage_profiler_mean_microsecs(Stage_Profiler_Stage_t stage)
+{
+    const Stage_Profiler_Stats_t *s = &stats[stage];
+    return s->num_calls == 0 ? 0 : stage_profiler_cycles_to_microsecs(s->total_cycles / s->num_calls);
+}
+
+uint32_t stage_profiler_percentile_microsecs(Stage_Profiler_Stage_t stage, uint32_t percent)
+{
+    const Stage_Profiler_Stats_t *s = &stats[stage];
+
+    if (s->num_calls == 0)
+    {
+        return 0;
+    }
+
+    // the number of calls at or below the percentile, rounded up so the 99th percentile of a few calls is the max
+    const uint64_t rank = (((uint64_t)s->num_calls * percent) + 99) / 100;
+
+    uint64_t num_calls_so_far = 0;
+    uint32_t bin = 0;
+    for (; bin < STAGE_PROFILER_HISTOGRAM_NUM_BINS - 1; bin++)
+    {
+        num_calls_so_far += s->histogram[bin];
+        if (num_calls_so_far >= rank)
+        {
+            break;
+        }
+    }
+
+    const uint64_t cycles = histogram_bin_max_cycles(bin);
+    return stage_profiler_cycles_to_microsecs(cycles < s->max_cycles ? cycles : s->max_cycles);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+uint32_t histogram_bin(uint32_t cycles)
+{
+    if (cycles < 2)
+    {
+        return 0;
+    }
+
+    const uint32_t msb = 31 - __builtin_clz(cycles);
+    return (2 * msb) + ((cycles >> (msb - 1)) & 1);
+}
+
+uint64_t histogram_bin_max_cycles(uint32_t bin)
+{
+    if (bin < 2)
+    {
+        return 1;
+    }
+
+    const uint32_t msb = bin / 2;
+    const uint64_t bin_min_cycles = (uint64_t)(2 + (bin & 1)) << (msb - 1);
+    return bin_min_cycles + ((uint64_t)1 << (msb - 1)) - 1;
+}
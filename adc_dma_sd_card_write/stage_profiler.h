@@ -0,0 +1,138 @@
+/**
+ * @file      stage_profiler.h
+ * @brief     A software module for profiling the time each stage of the recording pipeline takes is represented here.
+ * @details   Each stage is timed with the cycle counter from `STAGE_PROFILER_BEGIN()` to `STAGE_PROFILER_END()`, and
+ *            the profiler keeps the number of calls, the min, mean and max time, and a histogram for the 99th
+ *            percentile of each stage in a fixed amount of SRAM, so it can stay on for recordings of any length. Each
+ *            stage has a budget, a share of the `AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS` it takes for the DMA to
+ *            fill a block, calls that go over it are counted and recorded in the trace log as they happen.
+ *
+ *            With `DEMO_CONFIG_PROFILE_STAGES` set to 0 the macros expand to nothing, so the pipeline carries no trace
+ *            of the profiler and the linker drops this module.
+ *
+ *            Each stage must only ever run from one context, the block ready callback or the main loop, stages can
+ *            nest inside each other but a stage can't nest inside itself.
+ */
+
+#ifndef STAGE_PROFILER_H_
+#define STAGE_PROFILER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include "demo_config.h"
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// the histogram has two bins per power of 2 of cycles, enough to cover the whole range of the cycle counter, so the
+// 99th percentile is given to within a factor of 1.5
+#define STAGE_PROFILER_HISTOGRAM_NUM_BINS (64)
+
+// the budget of one call of each stage, as a percentage of the time it takes the DMA to fill a block. The processing
+// stages run back to back for each block in the block ready callback, and the write of one block runs alongside the
+// processing of the next, so each side has to fit in a block period with room to spare for the SD card to stall
+#define STAGE_PROFILER_CONVERT_BUDGET_IN_PERCENT (10)
+#define STAGE_PROFILER_DECIMATE_BUDGET_IN_PERCENT (40)
+#define STAGE_PROFILER_ENCODE_BUDGET_IN_PERCENT (40)
+#define STAGE_PROFILER_WRITE_BUDGET_IN_PERCENT (40)
+#define STAGE_PROFILER_HEADER_BUDGET_IN_PERCENT (20)
+
+#if DEMO_CONFIG_PROFILE_STAGES == 1
+#define STAGE_PROFILER_BEGIN(stage) stage_profiler_begin(stage)
+#define STAGE_PROFILER_END(stage) stage_profiler_end(stage)
+#else
+#define STAGE_PROFILER_BEGIN(stage)
+#define STAGE_PROFILER_END(stage)
+#endif
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The stages of the recording pipeline that are profiled are represented here.
+ */
+typedef enum
+{
+    STAGE_PROFILER_STAGE_CONVERT = 0, // a data conversion of a DMA block, 384kHz blocks take one, decimated blocks two
+    STAGE_PROFILER_STAGE_DECIMATE,    // the decimation filter of a DMA block
+    STAGE_PROFILER_STAGE_ENCODE,      // the FLAC or IMA ADPCM encoding of a DMA block
+    STAGE_PROFILER_STAGE_WRITE,       // an SD card write, along with any checkpoint or file switch that came with it
+    STAGE_PROFILER_STAGE_HEADER,      // a rewrite of the WAVE header, at a checkpoint or the end of a file
+    STAGE_PROFILER_NUM_STAGES,
+} Stage_Profiler_Stage_t;
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The statistics of one stage since the profiler was reset are represented here, times are in cycles of the
+ * cycle counter.
+ */
+typedef struct
+{
+    uint32_t num_calls;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint32_t num_over_budget;
+    uint32_t histogram[STAGE_PROFILER_HISTOGRAM_NUM_BINS];
+} Stage_Profiler_Stats_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `stage_profiler_reset()` clears the statistics of every stage, and works out the budgets in cycles.
+ *
+ * @pre the cycle counter is running, see cycle_counter.h, and no stage is running.
+ */
+void stage_profiler_reset();
+
+/**
+ * @brief `stage_profiler_begin(s)` starts timing a call of stage `s`, use `STAGE_PROFILER_BEGIN()` so it compiles out.
+ */
+void stage_profiler_begin(Stage_Profiler_Stage_t stage);
+
+/**
+ * @brief `stage_profiler_end(s)` stops timing the call of stage `s` and adds it to the statistics of `s`, use
+ * `STAGE_PROFILER_END()` so it compiles out.
+ *
+ * @pre `stage_profiler_begin(s)` was called from the same context.
+ *
+ * @post if the call took longer than the budget of `s` it is counted, and `TRACE_LOG_EVENT_OVER_BUDGET` is recorded.
+ */
+void stage_profiler_end(Stage_Profiler_Stage_t stage);
+
+/**
+ * @brief `stage_profiler_get_stats(s)` is a pointer to the statistics of stage `s`, only read it while the stage isn't
+ * running.
+ */
+const Stage_Profiler_Stats_t *stage_profiler_get_stats(Stage_Profiler_Stage_t stage);
+
+/**
+ * @brief `stage_profiler_stage_name(s)` is the name of stage `s` in lower case, e.g. "decimate".
+ */
+const char *stage_profiler_stage_name(Stage_Profiler_Stage_t stage);
+
+/**
+ * @brief `stage_profiler_budget_microsecs(s)` is the budget of one call of stage `s` in microseconds.
+ */
+uint32_t stage_profiler_budget_microsecs(Stage_Profiler_Stage_t stage);
+
+/**
+ * @brief `stage_profiler_cycles_to_microsecs(c)` is `c` cycles of the cycle counter in microseconds, rounded down.
+ */
+uint32_t stage_profiler_cycles_to_microsecs(uint64_t cycles);
+
+/**
+ * @brief `stage_profiler_mean_microsecs(s)` is the mean time of a call of stage `s` in microseconds, 0 if it wasn't
+ * called.
+ */
+uint32_t stage_profiler_mean_microsecs(Stage_Profiler_Stage_t stage);
+
+/**
+ * @brief `stage_profiler_percentile_microsecs(s, p)` is the time in microseconds that `p` percent of the calls of stage
+ * `s` took at most, 0 if it wasn't called. It is the top of the histogram bin the percentile falls in, but never more
+ * than the max, so it errs on the side of a longer time.
+ */
+uint32_t stage_profiler_percentile_microsecs(Stage_Profiler_Stage_t stage, uint32_t percent);
+
+#endif /* STAGE_PROFILER_H_ */
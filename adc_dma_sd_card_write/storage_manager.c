@@ -0,0 +1,409 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "hal_timer.h"
+
+#include "date_dirs.h"
+#include "scheduler.h"
+#include "sd_card.h"
+#include "sd_card_bank_ctl.h"
+#include "storage_manager.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define DIR_PATH_BUFF_LEN (64)
+
+// the event of the switch task
+#define SWITCH_EVENT_CARD_SETTLED (1u << 0)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static bool is_enabled = false;
+
+// the free space on each card, counted at boot and updated when a card is unmounted, 0 for a slot with no card or a
+// card that didn't mount. The mounted card keeps its own count, see `sd_card_free_space_bytes()`
+static uint64_t free_bytes_on_each_card[SD_CARD_BANK_CTL_NUM_CARDS];
+
+// the length of the last file the room was made for, the next file of a recording is expected to be as long
+static uint64_t last_file_len_in_bytes;
+
+// whether the next file won't fit on the mounted card, and if so whether the next card was picked yet, and which
+static bool is_switch_due;
+static bool is_next_slot_picked;
+static SD_Card_Bank_Card_Slot_t next_slot;
+
+// the directory to change into on every card
+static char dir_path[DIR_PATH_BUFF_LEN] = "/";
+
+// the task that mounts the card switched to once it has settled, and who to tell
+static Scheduler_Task_t switch_task;
+static Scheduler_Timer_t settle_timer;
+static Storage_Manager_Switch_Done_Callback_t switch_done_callback = NULL;
+
+// when the pending switch started, and the longest a switch took
+static uint32_t switch_start_millisecs;
+static uint32_t max_switch_millisecs = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `power_up_and_mount(s, c)` makes slot `s` the active slot, and initializes and mounts its card, counting its
+ * free space if `c` is true, else trusting the free space last seen on it. It waits for the card to settle in between.
+ *
+ * @pre no card is mounted.
+ *
+ * @post the card is mounted, or the bank is powered down if there was an error.
+ */
+static Storage_Manager_Error_t power_up_and_mount(SD_Card_Bank_Card_Slot_t slot, bool count_free_space);
+
+/**
+ * @brief `power_up(s)` makes slot `s` the active slot and initializes its card, which then has to settle before it is
+ * mounted with `mount()`.
+ *
+ * @post the card is initialized, or the bank is powered down if there was an error.
+ */
+static Storage_Manager_Error_t power_up(SD_Card_Bank_Card_Slot_t slot);
+
+/**
+ * @brief `mount(c)` mounts the card of the active slot, counting its free space if `c` is true, else trusting the free
+ * space last seen on it.
+ *
+ * @pre the card was initialized with `power_up()` and has settled.
+ *
+ * @post the card is mounted, or the bank is powered down if there was an error.
+ */
+static Storage_Manager_Error_t mount(bool count_free_space);
+
+/**
+ * @brief `pick_next_slot(l)` is the first slot after the active one with a card inserted that has room for a file of
+ * `l` bytes, or `SD_CARD_BANK_ALL_SLOTS_DISABLED` if there is none, using the cached card detect pins.
+ */
+static SD_Card_Bank_Card_Slot_t pick_next_slot(uint64_t file_len_in_bytes);
+
+/**
+ * @brief `start_switch(s)` unmounts the mounted card and powers up the card in slot `s`, the settle timer then has
+ * `finish_switch()` mount it.
+ */
+static Storage_Manager_Error_t start_switch(SD_Card_Bank_Card_Slot_t slot);
+
+/**
+ * @brief `finish_switch(e)` is the switch task, it mounts the card switched to in the directory of the recording once
+ * it has settled, and calls back with how it went.
+ */
+static void finish_switch(Scheduler_Events_t events);
+
+/**
+ * @brief `change_into_dir()` changes into the directory of the recording on the mounted card, creating it if needed.
+ */
+static Storage_Manager_Error_t change_into_dir();
+
+/**
+ * @brief `room_for_files(f)` is `f` bytes of free space less the margin, 0 if there is less than that.
+ */
+static uint64_t room_for_files(uint64_t free_bytes);
+
+/**
+ * @brief `note_file_len(l, r)` remembers that the file being opened is `l` bytes long, with `r` bytes of room for files
+ * on the mounted card, and whether the next card has to be picked while it is written.
+ */
+static void note_file_len(uint64_t file_len_in_bytes, uint64_t room);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+Storage_Manager_Error_t storage_manager_init()
+{
+    is_enabled = false;
+    is_switch_due = false;
+    is_next_slot_picked = false;
+    switch_done_callback = NULL;
+    max_switch_millisecs = 0;
+    strcpy(dir_path, "/");
+
+    // nothing can be written until the card is mounted, so the mount comes before anything else
+    if (scheduler_add_task(finish_switch, SCHEDULER_PRIORITY_HIGH, &switch_task) != SCHEDULER_ERROR_ALL_OK ||
+        scheduler_add_timer(switch_task, SWITCH_EVENT_CARD_SETTLED, &settle_timer) != SCHEDULER_ERROR_ALL_OK)
+    {
+        return STORAGE_MANAGER_ERROR_SCHEDULER_ERROR;
+    }
+
+    if (sd_card_bank_ctl_read_and_cache_detect_pins() != SD_CARD_BANK_CTL_ERROR_ALL_OK)
+    {
+        return STORAGE_MANAGER_ERROR_CARD_BANK_ERROR;
+    }
+
+    // no audio is being recorded yet, so this is the time to find out how much room each card has
+    for (uint32_t slot = 0; slot < SD_CARD_BANK_CTL_NUM_CARDS; slot++)
+    {
+        free_bytes_on_each_card[slot] = 0;
+
+        if (!sd_card_bank_ctl_slot_is_inserted(slot))
+        {
+            continue;
+        }
+
+        const Storage_Manager_Error_t err = power_up_and_mount(slot, true);
+        if (err == STORAGE_MANAGER_ERROR_CARD_BANK_ERROR)
+        {
+            return err;
+        }
+
+        // a card that doesn't mount is skipped like an empty slot
+        if (err == STORAGE_MANAGER_ERROR_ALL_OK)
+        {
+            free_bytes_on_each_card[slot] = sd_card_free_space_bytes();
+            sd_card_unmount();
+        }
+    }
+
+    if (sd_card_bank_ctl_disable_all() != SD_CARD_BANK_CTL_ERROR_ALL_OK)
+    {
+        return STORAGE_MANAGER_ERROR_CARD_BANK_ERROR;
+    }
+
+    for (uint32_t slot = 0; slot < SD_CARD_BANK_CTL_NUM_CARDS; slot++)
+    {
+        if (room_for_files(free_bytes_on_each_card[slot]) == 0)
+        {
+            continue;
+        }
+
+        const Storage_Manager_Error_t err = power_up_and_mount(slot, false);
+        if (err != STORAGE_MANAGER_ERROR_ALL_OK)
+        {
+            return err;
+        }
+
+        is_enabled = true;
+        return STORAGE_MANAGER_ERROR_ALL_OK;
+    }
+
+    return STORAGE_MANAGER_ERROR_ALL_CARDS_FULL;
+}
+
+bool storage_manager_is_enabled()
+{
+    return is_enabled;
+}
+
+Storage_Manager_Error_t storage_manager_cd(const char *path)
+{
+    if (strlen(path) >= DIR_PATH_BUFF_LEN)
+    {
+        return STORAGE_MANAGER_ERROR_SD_CARD_ERROR;
+    }
+
+    strcpy(dir_path, path);
+
+    return change_into_dir();
+}
+
+Storage_Manager_Error_t storage_manager_make_room(uint64_t file_len_in_bytes, Storage_Manager_Switch_Done_Callback_t done)
+{
+    if (!is_enabled)
+    {
+        return STORAGE_MANAGER_ERROR_ALL_OK;
+    }
+
+    // no file is open now, so the free space on the mounted card is all there is for this file and the ones after it
+    uint64_t room = room_for_files(sd_card_free_space_bytes());
+
+    if (file_len_in_bytes > room)
+    {
+        // the look ahead normally picked the card while the last file was written, this is for when it didn't get the
+        // chance, or the file is longer than the last one
+        if (!is_next_slot_picked || file_len_in_bytes > last_file_len_in_bytes)
+        {
+            if (sd_card_bank_ctl_read_and_cache_detect_pins() != SD_CARD_BANK_CTL_ERROR_ALL_OK)
+            {
+                return STORAGE_MANAGER_ERROR_CARD_BANK_ERROR;
+            }
+            next_slot = pick_next_slot(file_len_in_bytes);
+        }
+
+        if (next_slot == SD_CARD_BANK_ALL_SLOTS_DISABLED)
+        {
+            return STORAGE_MANAGER_ERROR_ALL_CARDS_FULL;
+        }
+
+        last_file_len_in_bytes = file_len_in_bytes;
+        is_switch_due = false;
+        is_next_slot_picked = false;
+
+        const Storage_Manager_Error_t err = start_switch(next_slot);
+        if (err != STORAGE_MANAGER_ERROR_ALL_OK)
+        {
+            return err;
+        }
+
+        switch_done_callback = done;
+        return STORAGE_MANAGER_ERROR_SWITCH_PENDING;
+    }
+
+    note_file_len(file_len_in_bytes, room);
+
+    return STORAGE_MANAGER_ERROR_ALL_OK;
+}
+
+void storage_manager_look_ahead()
+{
+    if (!is_enabled || !is_switch_due || is_next_slot_picked)
+    {
+        return;
+    }
+
+    // if the pins can't be read now they are read again at the end of the file
+    if (sd_card_bank_ctl_read_and_cache_detect_pins() != SD_CARD_BANK_CTL_ERROR_ALL_OK)
+    {
+        return;
+    }
+
+    next_slot = pick_next_slot(last_file_len_in_bytes);
+    is_next_slot_picked = true;
+}
+
+uint32_t storage_manager_get_max_switch_millisecs()
+{
+    return max_switch_millisecs;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+Storage_Manager_Error_t power_up_and_mount(SD_Card_Bank_Card_Slot_t slot, bool count_free_space)
+{
+    const Storage_Manager_Error_t err = power_up(slot);
+    if (err != STORAGE_MANAGER_ERROR_ALL_OK)
+    {
+        return err;
+    }
+
+    // without a brief delay between card init and mount, there are often mount errors
+    hal_timer_delay_microsecs(STORAGE_MANAGER_CARD_SETTLE_TIME_IN_MILLISECS * 1000);
+
+    return mount(count_free_space);
+}
+
+Storage_Manager_Error_t power_up(SD_Card_Bank_Card_Slot_t slot)
+{
+    if (sd_card_bank_ctl_enable_slot(slot) != SD_CARD_BANK_CTL_ERROR_ALL_OK)
+    {
+        return STORAGE_MANAGER_ERROR_CARD_BANK_ERROR;
+    }
+
+    if (sd_card_init() != SD_CARD_ERROR_ALL_OK)
+    {
+        sd_card_bank_ctl_disable_all();
+        return STORAGE_MANAGER_ERROR_SD_CARD_ERROR;
+    }
+
+    return STORAGE_MANAGER_ERROR_ALL_OK;
+}
+
+Storage_Manager_Error_t mount(bool count_free_space)
+{
+    const SD_Card_Bank_Card_Slot_t slot = sd_card_bank_ctl_get_active_slot();
+
+    const SD_Card_Error_t err = count_free_space ? sd_card_mount() : sd_card_mount_with_free_space(free_bytes_on_each_card[slot]);
+    if (err != SD_CARD_ERROR_ALL_OK)
+    {
+        sd_card_bank_ctl_disable_all();
+        return STORAGE_MANAGER_ERROR_SD_CARD_ERROR;
+    }
+
+    return STORAGE_MANAGER_ERROR_ALL_OK;
+}
+
+SD_Card_Bank_Card_Slot_t pick_next_slot(uint64_t file_len_in_bytes)
+{
+    for (uint32_t slot = sd_card_bank_ctl_get_active_slot() + 1; slot < SD_CARD_BANK_CTL_NUM_CARDS; slot++)
+    {
+        if (sd_card_bank_ctl_slot_is_inserted(slot) && room_for_files(free_bytes_on_each_card[slot]) >= file_len_in_bytes)
+        {
+            return slot;
+        }
+    }
+
+    return SD_CARD_BANK_ALL_SLOTS_DISABLED;
+}
+
+Storage_Manager_Error_t start_switch(SD_Card_Bank_Card_Slot_t slot)
+{
+    switch_start_millisecs = scheduler_get_millisecs();
+
+    free_bytes_on_each_card[sd_card_bank_ctl_get_active_slot()] = sd_card_free_space_bytes();
+
+    if (sd_card_unmount() != SD_CARD_ERROR_ALL_OK)
+    {
+        return STORAGE_MANAGER_ERROR_SD_CARD_ERROR;
+    }
+
+    const Storage_Manager_Error_t err = power_up(slot);
+    if (err != STORAGE_MANAGER_ERROR_ALL_OK)
+    {
+        return err;
+    }
+
+    // the card settles while the other tasks run, rather than in a delay
+    scheduler_timer_start(settle_timer, STORAGE_MANAGER_CARD_SETTLE_TIME_IN_MILLISECS, 0);
+
+    return STORAGE_MANAGER_ERROR_ALL_OK;
+}
+
+void finish_switch(Scheduler_Events_t events)
+{
+    (void)events;
+
+    // counting the free clusters can take seconds on a big card, nothing else wrote to it since we last saw its count
+    Storage_Manager_Error_t err = mount(false);
+    if (err == STORAGE_MANAGER_ERROR_ALL_OK)
+    {
+        err = change_into_dir();
+    }
+
+    if (err == STORAGE_MANAGER_ERROR_ALL_OK)
+    {
+        note_file_len(last_file_len_in_bytes, room_for_files(sd_card_free_space_bytes()));
+    }
+
+    const uint32_t switch_millisecs = scheduler_get_millisecs() - switch_start_millisecs;
+    if (switch_millisecs > max_switch_millisecs)
+    {
+        max_switch_millisecs = switch_millisecs;
+    }
+
+    const Storage_Manager_Switch_Done_Callback_t done = switch_done_callback;
+    switch_done_callback = NULL;
+
+    if (done != NULL)
+    {
+        done(err);
+    }
+}
+
+Storage_Manager_Error_t change_into_dir()
+{
+    // the day directories are relative to this one, and a card switched to doesn't have them yet
+    date_dirs_forget();
+
+    // the directory may already be there from an earlier recording
+    if (strcmp(dir_path, "/") != 0)
+    {
+        sd_card_mkdir(dir_path);
+    }
+
+    return sd_card_cd(dir_path) == SD_CARD_ERROR_ALL_OK ? STORAGE_MANAGER_ERROR_ALL_OK : STORAGE_MANAGER_ERROR_SD_CARD_ERROR;
+}
+
+uint64_t room_for_files(uint64_t free_bytes)
+{
+    return free_bytes > STORAGE_MANAGER_MARGIN_IN_BYTES ? free_bytes - STORAGE_MANAGER_MARGIN_IN_BYTES : 0;
+}
+
+void note_file_len(uint64_t file_len_in_bytes, uint64_t room)
+{
+    last_file_len_in_bytes = file_len_in_bytes;
+
+    // another file of the same length won't fit, so the next card is picked while this file is written
+    is_switch_due = file_len_in_bytes > room - file_len_in_bytes;
+    is_next_slot_picked = false;
+}
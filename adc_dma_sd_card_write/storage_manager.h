@@ -0,0 +1,147 @@
+/**
+ * @file      storage_manager.h
+ * @brief     A software interface for recording across the cards of the SD card bank is represented here.
+ * @details   The SD card bank holds 6 cards, but only one of them can be powered and routed to the SDHC lines at a time.
+ *            This module fills the cards in slot order. Before each file is opened it makes sure the mounted card has
+ *            room for the whole file, and if not it moves on to the next card with room, so a recording is only ever
+ *            split between cards at a file boundary, where the DMA ring covers the switch.
+ *
+ *            Every slot is checked once at boot, before any audio is recorded, so the cards are known to mount and the
+ *            free space on each is known up front. FatFS can take seconds to count the free clusters of a big card,
+ *            that is only done here and not with the DMA running. After that the SD card module keeps the count of the
+ *            mounted card up to date from its own writes, and the count is kept here for a card that is unmounted, so
+ *            it is trusted when the card is mounted again. When a file is opened that leaves no room for another file
+ *            of the same length, the next card to switch to is picked from the card detect pins the next time the
+ *            recording loop has nothing to write, so all that is left at the file boundary is powering the card up,
+ *            initializing it, and mounting it.
+ *
+ *            A card has to settle for `STORAGE_MANAGER_CARD_SETTLE_TIME_IN_MILLISECS` between initializing and
+ *            mounting, so a switch during a recording is split in two. `storage_manager_make_room()` powers the card up
+ *            and initializes it, and a timer of the scheduler mounts it once it has settled, the other tasks run in the
+ *            meantime. Nothing can be written while no card is mounted, so the whole switch still has to fit in the
+ *            audio the DMA ring holds, about 172ms: the 10ms `sd_card_init()` waits before initializing the card, the
+ *            initialization itself, the settle time, and the mount, see `storage_manager_get_max_switch_millisecs()`.
+ *
+ *            Without `storage_manager_init()` the module does nothing, so the same recorder works with the single SD
+ *            card slot of the FTHR2.
+ */
+
+#ifndef STORAGE_MANAGER_H_
+#define STORAGE_MANAGER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sd_card_bank_ctl.h"
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// the space left unused on every card, for the directory entries the free space count of the SD card module doesn't
+// follow, and for files written by anything else
+#define STORAGE_MANAGER_MARGIN_IN_BYTES (4u * 1024u * 1024u)
+
+// how long a card takes to settle after it is initialized, before it can be mounted reliably
+#define STORAGE_MANAGER_CARD_SETTLE_TIME_IN_MILLISECS (100u)
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Enumerated storage manager errors are represented here.
+ */
+typedef enum
+{
+    STORAGE_MANAGER_ERROR_ALL_OK,
+    STORAGE_MANAGER_ERROR_CARD_BANK_ERROR,
+    STORAGE_MANAGER_ERROR_SD_CARD_ERROR,
+    STORAGE_MANAGER_ERROR_ALL_CARDS_FULL,
+    STORAGE_MANAGER_ERROR_SCHEDULER_ERROR,
+    STORAGE_MANAGER_ERROR_SWITCH_PENDING,
+} Storage_Manager_Error_t;
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A function called when a switch to the next card is done is represented here, it is passed
+ * `STORAGE_MANAGER_ERROR_ALL_OK` if the card is mounted and ready for the file, else an error code, and runs in the
+ * task of the storage manager.
+ */
+typedef void (*Storage_Manager_Switch_Done_Callback_t)(Storage_Manager_Error_t err);
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `storage_manager_init()` checks every slot of the SD card bank, noting the free space on each card that is
+ * inserted and mounts, and mounts the first card with room to spare. This blocks for the settle time of every card, it
+ * is meant for boot, before any audio is recorded.
+ *
+ * @pre `sd_card_bank_ctl_init()` has been called and no card is mounted, called from the main loop.
+ *
+ * @post the first card with more than `STORAGE_MANAGER_MARGIN_IN_BYTES` free is powered on and mounted, with the root
+ * as the current directory, and the storage manager is enabled.
+ *
+ * @retval `STORAGE_MANAGER_ERROR_ALL_OK` if a card is mounted, `STORAGE_MANAGER_ERROR_ALL_CARDS_FULL` if there is no
+ * card with room, else an error code
+ */
+Storage_Manager_Error_t storage_manager_init();
+
+/**
+ * @brief `storage_manager_is_enabled()` is true iff `storage_manager_init()` has mounted a card of the SD card bank.
+ */
+bool storage_manager_is_enabled();
+
+/**
+ * @brief `storage_manager_cd(p)` changes into directory `p` on the mounted card, creating it first if it doesn't exist,
+ * and does the same on every card switched to after this.
+ *
+ * @param path a directory at the root, e.g. "/" or "384k-24bit", the string is copied
+ *
+ * @pre the storage manager is enabled and no file is open.
+ *
+ * @retval `STORAGE_MANAGER_ERROR_ALL_OK` if the directory is the current directory, else an error code
+ */
+Storage_Manager_Error_t storage_manager_cd(const char *path);
+
+/**
+ * @brief `storage_manager_make_room(l, d)` makes sure the mounted card has room for a file of `l` bytes, switching to
+ * the next card with room first if it doesn't. Cards are never switched back to, so the files stay in the order they
+ * were recorded in from one slot to the next.
+ *
+ * A switch unmounts the card and powers up and initializes the next one, then returns while the card settles, and
+ * `d` is called once the card is mounted.
+ *
+ * If the storage manager is not enabled this does nothing, the single card is written until it is full.
+ *
+ * @param file_len_in_bytes the longest the file can get, including its header
+ *
+ * @param done called when a switch this starts is done, not called otherwise
+ *
+ * @pre no file is open and no switch is pending.
+ *
+ * @post the card for the file is mounted, in the directory set with `storage_manager_cd()`, or will be when `d` is
+ * called with `STORAGE_MANAGER_ERROR_ALL_OK`. If there isn't room for another file of the same length after this one,
+ * the next card is picked by the next `storage_manager_look_ahead()`.
+ *
+ * @retval `STORAGE_MANAGER_ERROR_ALL_OK` if there is room for the file, `STORAGE_MANAGER_ERROR_SWITCH_PENDING` if it
+ * will be once `d` is called, `STORAGE_MANAGER_ERROR_ALL_CARDS_FULL` if no card has room, else an error code
+ */
+Storage_Manager_Error_t storage_manager_make_room(uint64_t file_len_in_bytes, Storage_Manager_Switch_Done_Callback_t done);
+
+/**
+ * @brief `storage_manager_look_ahead()` reads the card detect pins and picks the next card, once per file, if the file
+ * being written is the last one that fits on the mounted card. It's cheap to call in a loop, e.g. while waiting for
+ * the next block of audio, and does nothing if the storage manager is not enabled.
+ *
+ * @post the card to switch to at the end of the file is known, or that there is none.
+ */
+void storage_manager_look_ahead();
+
+/**
+ * @brief `storage_manager_get_max_switch_millisecs()` is the longest a switch to the next card took since boot, from
+ * unmounting the last card to mounting the next, in scheduler ticks. Nothing is written for this long, so it has to
+ * stay well below the time the DMA ring holds.
+ */
+uint32_t storage_manager_get_max_switch_millisecs();
+
+#endif /* STORAGE_MANAGER_H_ */
@@ -0,0 +1,478 @@
+/**
+ * Measures how long the on-device IMA ADPCM encoder `ima_adpcm.c` takes per sample, and how much of the signal it keeps,
+ * by running it on PCM WAVE files the way the recorder would: the first channel is cut down to 16 bits and encoded one
+ * DMA block at a time at the sample rate of the file.
+ *
+ * With `--synth` a synthetic 384kHz recording is used instead, a quiet noise floor with an echolocation-like chirp every
+ * 100ms, which is handy for a quick check but no substitute for real field recordings.
+ *
+ * With `--out` the encoded audio is also written to IMA ADPCM WAVE files, with the header from `wav_header.c`, so they
+ * can be listened to next to the originals.
+ *
+ * usage: adpcm_bench [--out <dir>] [--synth <secs>] [<file.wav> ...]
+ */
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "audio_dma.h"
+#include "ima_adpcm.h"
+#include "wav_header.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define ADC_SAMPLE_RATE (384000)
+
+// the time the recorder has to process each DMA block before the next one arrives
+#define BLOCK_BUDGET_IN_MICROSECS ((AUDIO_DMA_BUFF_LEN_IN_SAMPS * 1000000.0) / ADC_SAMPLE_RATE)
+
+// each file is encoded this many times and the fastest run is kept, to keep the host scheduler out of the timings
+#define NUM_TIMING_RUNS (5)
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The first channel of a recording, as 32 bit samples with the audio in the top bits, is represented here.
+ */
+typedef struct
+{
+    const char *name;
+    uint32_t sample_rate;
+    uint32_t num_samples;
+    int32_t *samples;
+} Recording_t;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `load_wav_file(p, r)` loads the first channel of the 16, 24, or 32 bit PCM WAVE file at `p` into `r`, and is
+ * true if it could.
+ */
+static bool load_wav_file(const char *path, Recording_t *recording);
+
+/**
+ * @brief `make_synth_recording(s, r)` fills `r` with `s` seconds of synthetic 384kHz audio.
+ */
+static void make_synth_recording(uint32_t secs, Recording_t *recording);
+
+/**
+ * @brief `bench(r, o)` encodes recording `r`, prints a row of results, and writes the encoded audio to a WAVE file in
+ * directory `o` if it is not NULL. It is true if the file could be written.
+ */
+static bool bench(const Recording_t *recording, const char *out_dir);
+
+/**
+ * @brief `decoded_snr_in_db(e, n, s)` decodes the `n` samples of IMA ADPCM blocks in `e` and is their signal to noise
+ * ratio in dB as a copy of the 16 bit samples in `s`.
+ */
+static double decoded_snr_in_db(const uint8_t *encoded, uint32_t num_samples, const int16_t *src);
+
+/**
+ * @brief `samples_per_block(r)` is the number of samples a DMA block turns into at sample rate `r`.
+ */
+static uint32_t samples_per_block(uint32_t sample_rate);
+
+static double now_in_secs();
+
+static uint64_t read_cycle_counter();
+
+static uint32_t read_u16(const uint8_t *p);
+
+static uint32_t read_u32(const uint8_t *p);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    const char *out_dir = NULL;
+    uint32_t synth_secs = 0;
+    int first_file_arg = argc;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            out_dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--synth") == 0 && i + 1 < argc)
+        {
+            synth_secs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (argv[i][0] != '-')
+        {
+            first_file_arg = i;
+            break;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--out <dir>] [--synth <secs>] [<file.wav> ...]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (synth_secs == 0 && first_file_arg == argc)
+    {
+        fprintf(stderr, "nothing to encode, give some WAVE files or --synth <secs>\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("each DMA block has to be processed within %.0fus, on the MAX32666 and not on this host\n", BLOCK_BUDGET_IN_MICROSECS);
+    printf("%-24s %7s %8s %7s %7s %10s %8s %8s %8s\n",
+           "recording", "rate", "secs", "ratio", "snr_db", "ns/sample", "cyc/samp", "blk_us", "blk_max");
+
+    int exit_code = EXIT_SUCCESS;
+    Recording_t recording;
+
+    if (synth_secs > 0)
+    {
+        make_synth_recording(synth_secs, &recording);
+
+        if (!bench(&recording, out_dir))
+        {
+            exit_code = EXIT_FAILURE;
+        }
+
+        free(recording.samples);
+    }
+
+    for (int i = first_file_arg; i < argc; i++)
+    {
+        if (!load_wav_file(argv[i], &recording))
+        {
+            fprintf(stderr, "could not load %s as a PCM WAVE file\n", argv[i]);
+            exit_code = EXIT_FAILURE;
+            continue;
+        }
+
+        if (!bench(&recording, out_dir))
+        {
+            exit_code = EXIT_FAILURE;
+        }
+
+        free(recording.samples);
+    }
+
+    return exit_code;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool load_wav_file(const char *path, Recording_t *recording)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    const long file_len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t *file = malloc(file_len);
+    const bool read_ok = file != NULL && fread(file, 1, file_len, f) == (size_t)file_len;
+    fclose(f);
+
+    if (!read_ok || file_len < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0)
+    {
+        free(file);
+        return false;
+    }
+
+    uint32_t num_channels = 0;
+    uint32_t bits_per_sample = 0;
+    uint32_t sample_rate = 0;
+    const uint8_t *data = NULL;
+    uint32_t data_len = 0;
+
+    // walk the chunks, we only care about "fmt " and "data"
+    for (long pos = 12; pos + 8 <= file_len;)
+    {
+        const uint8_t *chunk = file + pos;
+        const uint32_t chunk_len = read_u32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && chunk_len >= 16)
+        {
+            num_channels = read_u16(chunk + 10);
+            sample_rate = read_u32(chunk + 12);
+            bits_per_sample = read_u16(chunk + 22);
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            data = chunk + 8;
+            data_len = chunk_len <= file_len - pos - 8 ? chunk_len : file_len - pos - 8;
+        }
+
+        pos += 8 + chunk_len + (chunk_len & 1); // chunks are padded to an even length
+    }
+
+    const uint32_t bytes_per_samp = bits_per_sample / 8;
+    const uint32_t bytes_per_frame = bytes_per_samp * num_channels;
+
+    if (data == NULL || num_channels == 0 || (bytes_per_samp != 2 && bytes_per_samp != 3 && bytes_per_samp != 4) ||
+        data_len < bytes_per_frame)
+    {
+        free(file);
+        return false;
+    }
+
+    const char *name = strrchr(path, '/');
+    recording->name = name != NULL ? name + 1 : path;
+    recording->sample_rate = sample_rate;
+    recording->num_samples = data_len / bytes_per_frame;
+    recording->samples = malloc(recording->num_samples * sizeof(int32_t));
+
+    for (uint32_t i = 0; i < recording->num_samples; i++)
+    {
+        const uint8_t *s = data + (i * bytes_per_frame);
+
+        // put the sample in the top of a 32 bit word, so cutting it down to any bit depth is a shift
+        uint32_t samp = 0;
+        for (uint32_t b = 0; b < bytes_per_samp; b++)
+        {
+            samp |= (uint32_t)s[b] << (8 * (b + 4 - bytes_per_samp));
+        }
+        recording->samples[i] = (int32_t)samp;
+    }
+
+    free(file);
+
+    return true;
+}
+
+void make_synth_recording(uint32_t secs, Recording_t *recording)
+{
+    const double chirp_period_in_secs = 0.1;
+    const double chirp_len_in_secs = 0.005;
+
+    recording->name = "synth";
+    recording->sample_rate = ADC_SAMPLE_RATE;
+    recording->num_samples = secs * ADC_SAMPLE_RATE;
+    recording->samples = malloc(recording->num_samples * sizeof(int32_t));
+
+    srand(1);
+
+    for (uint32_t i = 0; i < recording->num_samples; i++)
+    {
+        const double t = (double)i / ADC_SAMPLE_RATE;
+
+        // a noise floor about 60dB below full scale
+        double val = 0.001 * (((double)rand() / RAND_MAX) - 0.5);
+
+        // a chirp sweeping down from 80kHz to 20kHz, with a raised cosine envelope
+        const double t_in_chirp = fmod(t, chirp_period_in_secs);
+        if (t_in_chirp < chirp_len_in_secs)
+        {
+            const double sweep = (20000.0 - 80000.0) / chirp_len_in_secs;
+            const double phase = 2 * M_PI * ((80000.0 * t_in_chirp) + (0.5 * sweep * t_in_chirp * t_in_chirp));
+            const double envelope = 0.5 * (1 - cos(2 * M_PI * t_in_chirp / chirp_len_in_secs));
+            val += 0.5 * envelope * sin(phase);
+        }
+
+        recording->samples[i] = (int32_t)(val * 2147483647.0);
+    }
+}
+
+bool bench(const Recording_t *recording, const char *out_dir)
+{
+    const uint32_t block_len = samples_per_block(recording->sample_rate);
+
+    // the recorder only keeps whole IMA ADPCM blocks
+    const uint32_t num_samples = recording->num_samples - (recording->num_samples % IMA_ADPCM_SAMPLES_PER_BLOCK);
+    const uint32_t num_blocks = (num_samples + block_len - 1) / block_len;
+
+    if (num_samples == 0)
+    {
+        fprintf(stderr, "%s is shorter than an IMA ADPCM block\n", recording->name);
+        return false;
+    }
+
+    int16_t *pcm = malloc((size_t)num_samples * sizeof(int16_t));
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        pcm[i] = (int16_t)(recording->samples[i] >> 16);
+    }
+
+    const size_t max_encoded_len = (size_t)num_blocks * IMA_ADPCM_MAX_ENCODED_LEN_IN_BYTES(block_len);
+    uint8_t *encoded = malloc(max_encoded_len);
+
+    double best_secs = INFINITY;
+    uint64_t best_cycles = UINT64_MAX;
+    double max_block_secs = 0;
+    size_t encoded_len = 0;
+
+    for (uint32_t run = 0; run < NUM_TIMING_RUNS; run++)
+    {
+        ima_adpcm_reset();
+        encoded_len = 0;
+        double run_max_block_secs = 0;
+
+        const double start_secs = now_in_secs();
+        const uint64_t start_cycles = read_cycle_counter();
+
+        for (uint32_t first = 0; first < num_samples; first += block_len)
+        {
+            const uint32_t len = num_samples - first < block_len ? num_samples - first : block_len;
+            const double block_start_secs = now_in_secs();
+
+            encoded_len += ima_adpcm_encode(pcm + first, len, encoded + encoded_len);
+
+            const double block_secs = now_in_secs() - block_start_secs;
+            run_max_block_secs = block_secs > run_max_block_secs ? block_secs : run_max_block_secs;
+        }
+
+        const uint64_t cycles = read_cycle_counter() - start_cycles;
+        const double secs = now_in_secs() - start_secs;
+
+        if (secs < best_secs)
+        {
+            best_secs = secs;
+            best_cycles = cycles;
+            max_block_secs = run_max_block_secs;
+        }
+    }
+
+    const double ratio = (double)encoded_len / ((double)num_samples * sizeof(int16_t));
+
+    printf("%-24.24s %7u %8.1f %7.3f %7.1f %10.2f %8.1f %8.1f %8.1f\n",
+           recording->name,
+           recording->sample_rate,
+           (double)num_samples / recording->sample_rate,
+           ratio,
+           decoded_snr_in_db(encoded, num_samples, pcm),
+           (best_secs * 1e9) / num_samples,
+           (double)best_cycles / num_samples,
+           (best_secs * 1e6) / num_blocks,
+           max_block_secs * 1e6);
+
+    bool ok = true;
+
+    if (out_dir != NULL)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s_ima_adpcm.wav", out_dir, recording->name);
+
+        wav_header_enable_ima_adpcm(true);
+
+        Wave_Header_Attributes_t wav_attr = {
+            .num_channels = WAVE_HEADER_MONO,
+            .bits_per_sample = WAVE_HEADER_4_BITS_PER_SAMPLE_IMA_ADPCM,
+            .sample_rate = recording->sample_rate,
+            .file_length = wav_header_get_header_length() + encoded_len,
+        };
+        wav_header_set_attributes(&wav_attr);
+
+        FILE *f = fopen(path, "wb");
+        ok = f != NULL && fwrite(wav_header_get_header(), 1, wav_header_get_header_length(), f) == wav_header_get_header_length() &&
+             fwrite(encoded, 1, encoded_len, f) == encoded_len;
+
+        if (f != NULL)
+        {
+            fclose(f);
+        }
+
+        if (!ok)
+        {
+            fprintf(stderr, "could not write %s\n", path);
+        }
+    }
+
+    free(encoded);
+    free(pcm);
+
+    return ok;
+}
+
+double decoded_snr_in_db(const uint8_t *encoded, uint32_t num_samples, const int16_t *src)
+{
+    static const int32_t step_sizes[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107,
+        118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876,
+        963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+        5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086,
+        29794, 32767};
+    static const int32_t step_index_adjustments[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+    double signal = 0.0;
+    double noise = 0.0;
+    int32_t sample = 0;
+    int32_t step_index = 0;
+
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        const uint8_t *block = encoded + ((i / IMA_ADPCM_SAMPLES_PER_BLOCK) * IMA_ADPCM_BLOCK_LEN_IN_BYTES);
+        const uint32_t n = i % IMA_ADPCM_SAMPLES_PER_BLOCK;
+
+        if (n == 0)
+        {
+            sample = (int16_t)(block[0] | (block[1] << 8));
+            step_index = block[2];
+        }
+        else
+        {
+            const uint8_t byte = block[IMA_ADPCM_BLOCK_HEADER_LEN_IN_BYTES + ((n - 1) / 2)];
+            const uint32_t code = (n & 1) ? (byte & 0xF) : (byte >> 4);
+            const int32_t step = step_sizes[step_index];
+            const int32_t delta = (step >> 3) + ((code & 4) ? step : 0) + ((code & 2) ? step >> 1 : 0) + ((code & 1) ? step >> 2 : 0);
+
+            sample += (code & 8) ? -delta : delta;
+            sample = sample > INT16_MAX ? INT16_MAX : sample < INT16_MIN ? INT16_MIN : sample;
+
+            step_index += step_index_adjustments[code & 7];
+            step_index = step_index > 88 ? 88 : step_index < 0 ? 0 : step_index;
+        }
+
+        signal += (double)src[i] * src[i];
+        noise += ((double)src[i] - sample) * ((double)src[i] - sample);
+    }
+
+    return noise > 0.0 ? 10.0 * log10(signal / noise) : INFINITY;
+}
+
+uint32_t samples_per_block(uint32_t sample_rate)
+{
+    // rates the recorder doesn't decimate to are encoded in blocks as long as the DMA block
+    if (sample_rate == 0 || sample_rate > ADC_SAMPLE_RATE || ADC_SAMPLE_RATE % sample_rate != 0 || ADC_SAMPLE_RATE / sample_rate > 16)
+    {
+        return AUDIO_DMA_BUFF_LEN_IN_SAMPS;
+    }
+
+    return AUDIO_DMA_BUFF_LEN_IN_SAMPS / (ADC_SAMPLE_RATE / sample_rate);
+}
+
+double now_in_secs()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + ((double)t.tv_nsec / 1e9);
+}
+
+uint64_t read_cycle_counter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    // no portable cycle counter, the column reads 0
+    return 0;
+#endif
+}
+
+uint32_t read_u16(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+uint32_t read_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
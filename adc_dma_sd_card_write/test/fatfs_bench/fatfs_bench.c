@@ -0,0 +1,600 @@
+/**
+ * Compares the sector operations FatFS issues, and the simulated latency of each write, when recording a 384kHz 24 bit
+ * WAVE file with three write layouts:
+ *
+ * - unaligned: each processed DMA block is written as is, right after the 44 byte header, the way the recorder did
+ *   before the write pipeline lined writes up with sectors
+ * - aligned: the same blocks go through the write pipeline, so every write starts and ends on a sector boundary
+ * - streamed: aligned writes to a file allocated contiguously up front with `sd_card_fpreallocate()`, so whole sectors
+ *   go straight to the card without FatFS following or extending the cluster chain
+ *
+ * The real `sd_card.c` and FatFS run unchanged on top of a disk image that counts every disk command. The image is kept
+ * in memory, or in a file with `--image` so it can be checked with `fsck` or mounted afterwards.
+ *
+ * The streamed layout is then recorded again through `wav_writer.c` with header checkpoints at a few intervals, to show
+ * what each checkpoint and `f_sync()` costs in extra sectors written and in write latency, and a last table divides the
+ * difference from the recording without checkpoints by the number of checkpoints.
+ *
+ * With `--opens` nothing is recorded, instead that many files are created the way a long deployment of 5 minute files
+ * names them, once all in one directory and once in the day directories of `date_dirs.c`, to show how the time to open
+ * a new file grows with the number of files already in its directory.
+ *
+ * usage: fatfs_bench [--secs <n>] [--fat32] [--image <file>] [--opens <n>]
+ */
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "date_dirs.h"
+#include "ff.h"
+#include "image_diskio.h"
+#include "sd_card.h"
+#include "time_helpers.h"
+#include "wav_header.h"
+#include "wav_writer.h"
+#include "write_pipeline.h"
+
+#if !FF_USE_MKFS
+#error "the benchmark formats a disk image, FF_USE_MKFS must be enabled in ffconf.h"
+#endif
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// 1GiB, plenty for several minutes of 384kHz 24 bit audio and big enough to format as FAT32, only the sectors that
+// are touched take up memory or disk space on the host
+#define DISK_IMAGE_NUM_SECTORS (1024 * 2048)
+
+// the cluster size an SDXC card is usually formatted with
+#define EXFAT_CLUSTER_LEN_IN_BYTES (32 * 1024)
+
+// write latencies are binned to the nearest 100us to find percentiles
+#define LATENCY_HISTOGRAM_BIN_IN_MICROSECS (100)
+#define LATENCY_HISTOGRAM_NUM_BINS (1000)
+
+#define BYTES_PER_SEC_384kHz_24_BIT (384000 * 3)
+
+// the length of each file of the deployment the file opens are benchmarked for, and how many rows the results are in
+#define OPENS_FILE_LEN_IN_MINS (5)
+#define OPENS_NUM_ROWS (10)
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+
+typedef enum
+{
+    LAYOUT_UNALIGNED,
+    LAYOUT_ALIGNED,
+    LAYOUT_STREAMED,
+} Layout_t;
+
+/**
+ * @brief The simulated latency of each write of a recording is summarized here.
+ */
+typedef struct
+{
+    uint32_t num_writes;
+    uint64_t total_microsecs;
+    uint32_t max_microsecs;
+    uint32_t histogram[LATENCY_HISTOGRAM_NUM_BINS];
+} Write_Latency_t;
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static FATFS fat_fs;
+
+static Write_Latency_t latency;
+
+// the number of checkpoints the wav writer made in the last recording with checkpoints
+static uint32_t num_checkpoints;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `record(l, n)` writes a WAVE file of `n` 384kHz 24 bit blocks using write layout `l`, and is true on success.
+ */
+static bool record(Layout_t layout, uint32_t num_blocks);
+
+/**
+ * @brief `record_with_checkpoints(n, i)` writes a WAVE file of `n` 384kHz 24 bit blocks with the streamed layout through
+ * the wav writer, checkpointing the header every `i` bytes of audio, or never if `i` is 0, and is true on success.
+ */
+static bool record_with_checkpoints(uint32_t num_blocks, uint32_t interval_in_bytes);
+
+/**
+ * @brief `timed_fwrite(b, n)` writes `n` bytes of `b` to the open file, adds the simulated time it took to the latency
+ * summary, and is true on success.
+ */
+static bool timed_fwrite(const void *buff, uint32_t len);
+
+/**
+ * @brief `timed_wav_writer_write(b, n)` is `timed_fwrite(b, n)` through the wav writer, including any checkpoint.
+ */
+static bool timed_wav_writer_write(const void *buff, uint32_t len);
+
+/**
+ * @brief `add_write_latency(t0)` adds a write that started when the simulated busy time was `t0` to the latency summary.
+ */
+static void add_write_latency(uint64_t start_in_microsecs);
+
+/**
+ * @brief `latency_percentile(p)` is the simulated write latency in microseconds that `p` percent of writes came in under.
+ */
+static uint32_t latency_percentile(double percent);
+
+/**
+ * @brief `print_results(n)` prints the disk counters and write latencies for the layout named `n`.
+ */
+static void print_results(const char *name);
+
+/**
+ * @brief `print_checkpoint_cost(n, k, c, s)` prints what each of the `k` checkpoints of the recording every `n`, which
+ * ended with disk counters `c`, cost on top of the same recording without checkpoints, which ended with counters `s`.
+ */
+static void print_checkpoint_cost(const char *name, uint32_t num_checkpoints, const Image_Diskio_Counters_t *counters,
+                                  const Image_Diskio_Counters_t *never_counters);
+
+/**
+ * @brief `bench_opens(n)` creates `n` files named after the times of back to back 5 minute files, in one directory and
+ * then in day directories, prints the simulated time and sectors read per `sd_card_fopen()` as the files add up, and is
+ * true on success.
+ */
+static bool bench_opens(uint32_t num_files);
+
+/**
+ * @brief `time_opens(d, i, n, s, r)` creates files `i` to `i + n - 1` of the deployment in directory `d`, in day
+ * directories if `s` is true, and adds the simulated time and sectors read by opening them to `t` and `r`, and is true
+ * on success.
+ */
+static bool time_opens(const char *dir, uint32_t first_file, uint32_t num_files, bool is_sharded, uint64_t *microsecs, uint32_t *sectors_read);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    uint32_t file_len_secs = 10;
+    bool use_fat32 = false;
+    const char *image_path = NULL;
+    uint32_t num_opens = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--secs") == 0 && i + 1 < argc)
+        {
+            file_len_secs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--fat32") == 0)
+        {
+            use_fat32 = true;
+        }
+        else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc)
+        {
+            image_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--opens") == 0 && i + 1 < argc)
+        {
+            num_opens = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--secs <n>] [--fat32] [--image <file>] [--opens <n>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const uint32_t num_blocks = (file_len_secs * 1000000) / AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS;
+
+    static BYTE mkfs_work_buff[FF_MAX_SS * 64];
+    const MKFS_PARM mkfs_opts = {
+        .fmt = use_fat32 ? FM_FAT32 : FM_EXFAT,
+        .au_size = use_fat32 ? 0 : EXFAT_CLUSTER_LEN_IN_BYTES, // let FatFS pick the FAT32 cluster size
+    };
+
+    if (!image_diskio_init(image_path, DISK_IMAGE_NUM_SECTORS) || f_mkfs("", &mkfs_opts, mkfs_work_buff, sizeof(mkfs_work_buff)) != FR_OK)
+    {
+        fprintf(stderr, "could not format the disk image\n");
+        return EXIT_FAILURE;
+    }
+
+    if (sd_card_init() != SD_CARD_ERROR_ALL_OK || sd_card_mount() != SD_CARD_ERROR_ALL_OK)
+    {
+        fprintf(stderr, "could not mount the disk image\n");
+        return EXIT_FAILURE;
+    }
+
+    if (num_opens > 0)
+    {
+        const bool is_ok = bench_opens(num_opens);
+
+        sd_card_unmount();
+        image_diskio_deinit();
+
+        return is_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    printf("%u blocks of %u bytes (%us of 384kHz 24 bit audio) on %s\n",
+           num_blocks, AUDIO_DMA_BUFF_LEN_IN_BYTES, file_len_secs, use_fat32 ? "FAT32" : "exFAT");
+    printf("%-10s %10s %8s %9s %9s %8s %8s %8s %8s %8s %8s\n",
+           "layout", "write_cmds", "single", "sect_wr", "read_cmds", "MiB", "mean_ms", "p99_ms", "max_ms", "total_s", "host_ms");
+
+    const Layout_t layouts[] = {LAYOUT_UNALIGNED, LAYOUT_ALIGNED, LAYOUT_STREAMED};
+    const char *layout_names[] = {"unaligned", "aligned", "streamed"};
+
+    for (uint32_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++)
+    {
+        image_diskio_reset_counters();
+        memset(&latency, 0, sizeof(latency));
+
+        if (!record(layouts[i], num_blocks))
+        {
+            fprintf(stderr, "SD card error while recording the %s layout\n", layout_names[i]);
+            return EXIT_FAILURE;
+        }
+
+        print_results(layout_names[i]);
+    }
+
+    printf("\nstreamed, with a header checkpoint and f_sync() every:\n");
+
+    const uint32_t checkpoint_intervals_in_bytes[] = {0, 10 * BYTES_PER_SEC_384kHz_24_BIT, BYTES_PER_SEC_384kHz_24_BIT, BYTES_PER_SEC_384kHz_24_BIT / 10};
+    const char *checkpoint_names[] = {"never", "10s", "1s", "100ms"};
+    const uint32_t num_intervals = sizeof(checkpoint_intervals_in_bytes) / sizeof(checkpoint_intervals_in_bytes[0]);
+
+    Image_Diskio_Counters_t checkpoint_counters[num_intervals];
+    uint32_t checkpoint_counts[num_intervals];
+
+    for (uint32_t i = 0; i < num_intervals; i++)
+    {
+        image_diskio_reset_counters();
+        memset(&latency, 0, sizeof(latency));
+
+        if (!record_with_checkpoints(num_blocks, checkpoint_intervals_in_bytes[i]))
+        {
+            fprintf(stderr, "SD card error while recording with checkpoints every %s\n", checkpoint_names[i]);
+            return EXIT_FAILURE;
+        }
+
+        print_results(checkpoint_names[i]);
+
+        checkpoint_counters[i] = *image_diskio_get_counters();
+        checkpoint_counts[i] = num_checkpoints;
+    }
+
+    printf("\ncost of each checkpoint over never:\n");
+    printf("%-10s %8s %10s %9s %9s %8s %8s\n", "every", "ckpts", "write_cmds", "sect_wr", "read_cmds", "ms", "extra_%");
+
+    for (uint32_t i = 1; i < num_intervals; i++)
+    {
+        print_checkpoint_cost(checkpoint_names[i], checkpoint_counts[i], &checkpoint_counters[i], &checkpoint_counters[0]);
+    }
+
+    sd_card_unmount();
+    image_diskio_deinit();
+
+    return EXIT_SUCCESS;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool record(Layout_t layout, uint32_t num_blocks)
+{
+    static uint8_t unaligned_block[AUDIO_DMA_BUFF_LEN_IN_BYTES];
+    static char file_name[32];
+    uint32_t bytes_written;
+
+    sprintf(file_name, "layout_%d.wav", (int)layout);
+
+    if (sd_card_fopen(file_name, POSIX_FILE_MODE_WRITE) != SD_CARD_ERROR_ALL_OK)
+    {
+        return false;
+    }
+
+    if (layout == LAYOUT_STREAMED &&
+        sd_card_fpreallocate(wav_header_get_header_length() + (num_blocks * AUDIO_DMA_BUFF_LEN_IN_BYTES)) != SD_CARD_ERROR_ALL_OK)
+    {
+        fprintf(stderr, "could not pre-allocate, is FF_USE_EXPAND enabled in ffconf.h?\n");
+        return false;
+    }
+
+    if (sd_card_lseek(wav_header_get_header_length()) != SD_CARD_ERROR_ALL_OK)
+    {
+        return false;
+    }
+
+    write_pipeline_reset(wav_header_get_header_length());
+
+    for (uint32_t i = 0; i < num_blocks; i++)
+    {
+        const uint8_t *chunk = unaligned_block;
+        uint32_t len = AUDIO_DMA_BUFF_LEN_IN_BYTES;
+
+        // the contents don't matter to FatFS, only the lengths and the positions of the writes
+        if (layout == LAYOUT_UNALIGNED)
+        {
+            memset(unaligned_block, (int)i, AUDIO_DMA_BUFF_LEN_IN_BYTES);
+        }
+        else
+        {
+            memset(write_pipeline_get_free_buffer(), (int)i, AUDIO_DMA_BUFF_LEN_IN_BYTES);
+            write_pipeline_submit_buffer(AUDIO_DMA_BUFF_LEN_IN_BYTES);
+            chunk = write_pipeline_start_write(&len);
+        }
+
+        if (!timed_fwrite(chunk, len))
+        {
+            return false;
+        }
+
+        if (layout != LAYOUT_UNALIGNED)
+        {
+            write_pipeline_on_write_complete();
+        }
+    }
+
+    if (layout != LAYOUT_UNALIGNED)
+    {
+        uint32_t num_carried_bytes;
+        const uint8_t *carried_bytes = write_pipeline_get_carried_bytes(&num_carried_bytes);
+
+        if (!timed_fwrite(carried_bytes, num_carried_bytes))
+        {
+            return false;
+        }
+    }
+
+    // fill in the header just like the recorder does
+    if (sd_card_lseek(0) != SD_CARD_ERROR_ALL_OK)
+    {
+        return false;
+    }
+
+    Wave_Header_Attributes_t wav_attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_384kHz,
+        .bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE,
+        .file_length = sd_card_fsize(),
+    };
+    wav_header_set_attributes(&wav_attr);
+
+    if (sd_card_fwrite(wav_header_get_header(), wav_header_get_header_length(), &bytes_written) != SD_CARD_ERROR_ALL_OK)
+    {
+        return false;
+    }
+
+    return sd_card_fclose() == SD_CARD_ERROR_ALL_OK;
+}
+
+bool record_with_checkpoints(uint32_t num_blocks, uint32_t interval_in_bytes)
+{
+    Wave_Header_Attributes_t wav_attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_384kHz,
+        .bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE,
+    };
+
+    const uint64_t file_len = wav_header_get_header_length() + ((uint64_t)num_blocks * AUDIO_DMA_BUFF_LEN_IN_BYTES);
+
+    wav_writer_set_checkpoint_interval(interval_in_bytes);
+
+    if (wav_writer_open("checkpoints.wav", &wav_attr, file_len) != WAV_WRITER_ERROR_ALL_OK)
+    {
+        return false;
+    }
+
+    write_pipeline_reset(wav_header_get_header_length());
+
+    // the wav writer checkpoints on the first write that takes the audio since the last checkpoint to the interval
+    uint64_t bytes_since_checkpoint = 0;
+    num_checkpoints = 0;
+
+    for (uint32_t i = 0; i < num_blocks; i++)
+    {
+        uint32_t len;
+
+        memset(write_pipeline_get_free_buffer(), (int)i, AUDIO_DMA_BUFF_LEN_IN_BYTES);
+        write_pipeline_submit_buffer(AUDIO_DMA_BUFF_LEN_IN_BYTES);
+        const uint8_t *chunk = write_pipeline_start_write(&len);
+
+        if (!timed_wav_writer_write(chunk, len))
+        {
+            return false;
+        }
+
+        write_pipeline_on_write_complete();
+
+        bytes_since_checkpoint += len;
+        if (interval_in_bytes != 0 && bytes_since_checkpoint >= interval_in_bytes)
+        {
+            num_checkpoints += 1;
+            bytes_since_checkpoint = 0;
+        }
+    }
+
+    uint32_t num_carried_bytes;
+    const uint8_t *carried_bytes = write_pipeline_get_carried_bytes(&num_carried_bytes);
+
+    if (!timed_wav_writer_write(carried_bytes, num_carried_bytes))
+    {
+        return false;
+    }
+
+    return wav_writer_close() == WAV_WRITER_ERROR_ALL_OK;
+}
+
+bool timed_fwrite(const void *buff, uint32_t len)
+{
+    uint32_t bytes_written;
+
+    const uint64_t start = image_diskio_get_counters()->busy_time_in_microsecs;
+
+    if (sd_card_fwrite(buff, len, &bytes_written) != SD_CARD_ERROR_ALL_OK || bytes_written != len)
+    {
+        return false;
+    }
+
+    add_write_latency(start);
+
+    return true;
+}
+
+bool timed_wav_writer_write(const void *buff, uint32_t len)
+{
+    const uint64_t start = image_diskio_get_counters()->busy_time_in_microsecs;
+
+    if (wav_writer_write(buff, len) != WAV_WRITER_ERROR_ALL_OK)
+    {
+        return false;
+    }
+
+    add_write_latency(start);
+
+    return true;
+}
+
+void add_write_latency(uint64_t start_in_microsecs)
+{
+    const uint32_t microsecs = (uint32_t)(image_diskio_get_counters()->busy_time_in_microsecs - start_in_microsecs);
+
+    latency.num_writes += 1;
+    latency.total_microsecs += microsecs;
+    latency.max_microsecs = microsecs > latency.max_microsecs ? microsecs : latency.max_microsecs;
+
+    const uint32_t bin = microsecs / LATENCY_HISTOGRAM_BIN_IN_MICROSECS;
+    latency.histogram[bin < LATENCY_HISTOGRAM_NUM_BINS ? bin : LATENCY_HISTOGRAM_NUM_BINS - 1] += 1;
+}
+
+uint32_t latency_percentile(double percent)
+{
+    const uint32_t target = (uint32_t)((latency.num_writes * percent) / 100.0);
+
+    uint32_t num_below = 0;
+    for (uint32_t i = 0; i < LATENCY_HISTOGRAM_NUM_BINS; i++)
+    {
+        num_below += latency.histogram[i];
+        if (num_below >= target)
+        {
+            return (i + 1) * LATENCY_HISTOGRAM_BIN_IN_MICROSECS;
+        }
+    }
+
+    return LATENCY_HISTOGRAM_NUM_BINS * LATENCY_HISTOGRAM_BIN_IN_MICROSECS;
+}
+
+void print_results(const char *name)
+{
+    const Image_Diskio_Counters_t *c = image_diskio_get_counters();
+    const double mean_microsecs = latency.num_writes == 0 ? 0.0 : (double)latency.total_microsecs / latency.num_writes;
+
+    printf("%-10s %10u %8u %9u %9u %8.1f %8.2f %8.2f %8.2f %8.3f %8.1f\n",
+           name,
+           c->num_write_cmds,
+           c->num_single_sector_writes,
+           c->num_sectors_written,
+           c->num_read_cmds,
+           (c->num_bytes_written + c->num_bytes_read) / (1024.0 * 1024.0),
+           mean_microsecs / 1000.0,
+           latency_percentile(99.0) / 1000.0,
+           latency.max_microsecs / 1000.0,
+           c->busy_time_in_microsecs / 1e6,
+           c->host_time_in_nanosecs / 1e6);
+}
+
+void print_checkpoint_cost(const char *name, uint32_t num_checkpoints, const Image_Diskio_Counters_t *counters,
+                           const Image_Diskio_Counters_t *never_counters)
+{
+    const double n = num_checkpoints == 0 ? 1.0 : (double)num_checkpoints;
+    const double extra_microsecs = (double)counters->busy_time_in_microsecs - (double)never_counters->busy_time_in_microsecs;
+
+    printf("%-10s %8u %10.1f %9.1f %9.1f %8.2f %8.2f\n",
+           name,
+           num_checkpoints,
+           ((double)counters->num_write_cmds - never_counters->num_write_cmds) / n,
+           ((double)counters->num_sectors_written - never_counters->num_sectors_written) / n,
+           ((double)counters->num_read_cmds - never_counters->num_read_cmds) / n,
+           (extra_microsecs / n) / 1000.0,
+           (100.0 * extra_microsecs) / never_counters->busy_time_in_microsecs);
+}
+
+bool bench_opens(uint32_t num_files)
+{
+    const uint32_t files_per_row = (num_files + OPENS_NUM_ROWS - 1) / OPENS_NUM_ROWS;
+
+    printf("opening %u files named like back to back %u minute recordings\n", num_files, OPENS_FILE_LEN_IN_MINS);
+    printf("%-10s %10s %10s %10s %10s\n", "files", "flat_ms", "flat_rd", "daily_ms", "daily_rd");
+
+    // the two layouts take turns a row at a time, each in a directory of its own
+    if (sd_card_mkdir("flat") != SD_CARD_ERROR_ALL_OK || sd_card_mkdir("daily") != SD_CARD_ERROR_ALL_OK)
+    {
+        return false;
+    }
+
+    for (uint32_t first_file = 0; first_file < num_files; first_file += files_per_row)
+    {
+        const uint32_t num_in_row = num_files - first_file < files_per_row ? num_files - first_file : files_per_row;
+
+        uint64_t flat_microsecs = 0;
+        uint64_t daily_microsecs = 0;
+        uint32_t flat_sectors_read = 0;
+        uint32_t daily_sectors_read = 0;
+
+        if (!time_opens("flat", first_file, num_in_row, false, &flat_microsecs, &flat_sectors_read) ||
+            !time_opens("daily", first_file, num_in_row, true, &daily_microsecs, &daily_sectors_read))
+        {
+            return false;
+        }
+
+        printf("%-10u %10.3f %10.1f %10.3f %10.1f\n",
+               first_file + num_in_row,
+               (flat_microsecs / (double)num_in_row) / 1000.0,
+               flat_sectors_read / (double)num_in_row,
+               (daily_microsecs / (double)num_in_row) / 1000.0,
+               daily_sectors_read / (double)num_in_row);
+    }
+
+    return true;
+}
+
+bool time_opens(const char *dir, uint32_t first_file, uint32_t num_files, bool is_sharded, uint64_t *microsecs, uint32_t *sectors_read)
+{
+    static char file_name[64];
+
+    if (sd_card_cd(dir) != SD_CARD_ERROR_ALL_OK)
+    {
+        return false;
+    }
+
+    // every row starts from the directory of the layout, just like every recording does
+    date_dirs_forget();
+
+    tm_t deployment_start = time_helpers_get_default_time();
+    deployment_start.tm_year = 2024 - 1900;
+
+    for (uint32_t i = first_file; i < first_file + num_files; i++)
+    {
+        const tm_t file_start_time = time_helpers_add_time(&deployment_start, 0, 0, (int)(i * OPENS_FILE_LEN_IN_MINS), 0);
+
+        // the day directories are made before the time is taken, just like the recorder makes them before it opens
+        size_t len = is_sharded ? date_dirs_make(&file_start_time, file_name) : 0;
+        len += time_helpers_tm_to_string(&file_start_time, file_name + len);
+        strcpy(file_name + len, ".wav");
+
+        const uint64_t start = image_diskio_get_counters()->busy_time_in_microsecs;
+        const uint32_t start_sectors_read = image_diskio_get_counters()->num_sectors_read;
+
+        if (sd_card_fopen(file_name, POSIX_FILE_MODE_WRITE) != SD_CARD_ERROR_ALL_OK)
+        {
+            return false;
+        }
+
+        *microsecs += image_diskio_get_counters()->busy_time_in_microsecs - start;
+        *sectors_read += image_diskio_get_counters()->num_sectors_read - start_sectors_read;
+
+        if (sd_card_fclose() != SD_CARD_ERROR_ALL_OK)
+        {
+            return false;
+        }
+    }
+
+    return sd_card_cd("/") == SD_CARD_ERROR_ALL_OK;
+}
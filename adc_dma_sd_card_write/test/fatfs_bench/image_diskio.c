@@ -0,0 +1,226 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "ff.h"
+#include "diskio.h"
+#include "image_diskio.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define SECTOR_LEN_IN_BYTES (512)
+
+// SD cards erase in blocks much larger than a sector, FatFS uses this to align the data area when formatting
+#define ERASE_BLOCK_LEN_IN_SECTORS (8192)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static uint8_t *disk = NULL;
+static uint32_t disk_num_sectors = 0;
+
+// the image file descriptor, or -1 if the image is only kept in memory
+static int image_fd = -1;
+
+// A rough model of a class 10 card: each command costs a fixed time (for a write, mostly the card programming its
+// flash) plus the transfer time of the sectors, about 12.5MB/s on a 4 bit bus at 25MHz
+static Image_Diskio_Latency_t latency = {
+    .read_cmd_overhead_in_microsecs = 150,
+    .write_cmd_overhead_in_microsecs = 500,
+    .sector_transfer_time_in_microsecs = 41,
+};
+
+static Image_Diskio_Counters_t counters;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `now_in_nanosecs()` is the host's monotonic time in nanoseconds.
+ */
+static uint64_t now_in_nanosecs();
+
+/**
+ * @brief `count_cmd(o, n, s)` adds a command with overhead `o` for `n` sectors to the simulated busy time, and the host
+ * time since `s` to the host time.
+ */
+static void count_cmd(uint32_t overhead_in_microsecs, uint32_t num_sectors, uint64_t host_start_in_nanosecs);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+bool image_diskio_init(const char *path, uint32_t num_sectors)
+{
+    const size_t len = (size_t)num_sectors * SECTOR_LEN_IN_BYTES;
+
+    if (path == NULL)
+    {
+        disk = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    }
+    else
+    {
+        // start from a blank image, truncating to 0 first so that every sector reads back as zeros
+        image_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+        if (image_fd < 0 || ftruncate(image_fd, (off_t)len) != 0)
+        {
+            image_diskio_deinit();
+            return false;
+        }
+
+        disk = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, image_fd, 0);
+    }
+
+    if (disk == MAP_FAILED)
+    {
+        disk = NULL;
+        image_diskio_deinit();
+        return false;
+    }
+
+    disk_num_sectors = num_sectors;
+
+    image_diskio_reset_counters();
+
+    return true;
+}
+
+void image_diskio_deinit()
+{
+    if (disk != NULL)
+    {
+        const size_t len = (size_t)disk_num_sectors * SECTOR_LEN_IN_BYTES;
+
+        if (image_fd >= 0)
+        {
+            msync(disk, len, MS_SYNC);
+        }
+        munmap(disk, len);
+    }
+
+    if (image_fd >= 0)
+    {
+        close(image_fd);
+    }
+
+    disk = NULL;
+    disk_num_sectors = 0;
+    image_fd = -1;
+}
+
+void image_diskio_set_latency(const Image_Diskio_Latency_t *new_latency)
+{
+    latency = *new_latency;
+}
+
+void image_diskio_reset_counters()
+{
+    memset(&counters, 0, sizeof(counters));
+}
+
+const Image_Diskio_Counters_t *image_diskio_get_counters()
+{
+    return &counters;
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+    return disk_status(pdrv);
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+    return (pdrv == 0 && disk != NULL) ? 0 : STA_NOINIT;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count)
+{
+    if (pdrv != 0 || disk == NULL || sector + count > disk_num_sectors)
+    {
+        return RES_PARERR;
+    }
+
+    const uint64_t start = now_in_nanosecs();
+
+    memcpy(buff, disk + (sector * SECTOR_LEN_IN_BYTES), count * SECTOR_LEN_IN_BYTES);
+
+    counters.num_read_cmds += 1;
+    counters.num_sectors_read += count;
+    counters.num_bytes_read += count * SECTOR_LEN_IN_BYTES;
+    count_cmd(latency.read_cmd_overhead_in_microsecs, count, start);
+
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count)
+{
+    if (pdrv != 0 || disk == NULL || sector + count > disk_num_sectors)
+    {
+        return RES_PARERR;
+    }
+
+    const uint64_t start = now_in_nanosecs();
+
+    memcpy(disk + (sector * SECTOR_LEN_IN_BYTES), buff, count * SECTOR_LEN_IN_BYTES);
+
+    counters.num_write_cmds += 1;
+    counters.num_single_sector_writes += count == 1 ? 1 : 0;
+    counters.num_sectors_written += count;
+    counters.num_bytes_written += count * SECTOR_LEN_IN_BYTES;
+    count_cmd(latency.write_cmd_overhead_in_microsecs, count, start);
+
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    if (pdrv != 0 || disk == NULL)
+    {
+        return RES_NOTRDY;
+    }
+
+    switch (cmd)
+    {
+    case CTRL_SYNC:
+        return RES_OK;
+    case GET_SECTOR_COUNT:
+        *(LBA_t *)buff = disk_num_sectors;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD *)buff = SECTOR_LEN_IN_BYTES;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD *)buff = ERASE_BLOCK_LEN_IN_SECTORS;
+        return RES_OK;
+    default:
+        return RES_PARERR;
+    }
+}
+
+DWORD get_fattime()
+{
+    // 2024-01-01 00:00:00, the benchmark doesn't care about time stamps
+    return ((DWORD)(2024 - 1980) << 25) | ((DWORD)1 << 21) | ((DWORD)1 << 16);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+uint64_t now_in_nanosecs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+void count_cmd(uint32_t overhead_in_microsecs, uint32_t num_sectors, uint64_t host_start_in_nanosecs)
+{
+    const uint32_t cmd_time = overhead_in_microsecs + (num_sectors * latency.sector_transfer_time_in_microsecs);
+    counters.busy_time_in_microsecs += cmd_time;
+    counters.max_cmd_time_in_microsecs = cmd_time > counters.max_cmd_time_in_microsecs ? cmd_time : counters.max_cmd_time_in_microsecs;
+
+    const uint32_t host_time = (uint32_t)(now_in_nanosecs() - host_start_in_nanosecs);
+    counters.host_time_in_nanosecs += host_time;
+    counters.max_host_call_time_in_nanosecs = host_time > counters.max_host_call_time_in_nanosecs ? host_time : counters.max_host_call_time_in_nanosecs;
+}
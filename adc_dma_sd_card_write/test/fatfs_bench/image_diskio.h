@@ -0,0 +1,90 @@
+/**
+ * @file      image_diskio.h
+ * @brief     A FatFS disk I/O layer backed by a disk image on the host, with counters of the sector operations, is
+ *            represented here.
+ * @details   `image_diskio.c` implements the `diskio.h` functions FatFS calls, so FatFS and `sd_card.c` can be run
+ *            unchanged on a host PC while every disk command they issue is counted. The disk is an image file mapped
+ *            into memory with `mmap()`, so it can be inspected or mounted after a run, or an anonymous mapping when
+ *            there is no need to keep it.
+ *
+ *            Each command also adds to a simulated busy time, from a simple model of an SD card on the MAX32666's 4 bit
+ *            bus, so the latency of each file operation can be compared without real hardware and without any noise
+ *            from the host. The time the host actually spent in each call is measured too.
+ */
+
+#ifndef IMAGE_DISKIO_H_
+#define IMAGE_DISKIO_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A simple model of how long an SD card takes to complete a command is represented here, each command costs a
+ * fixed overhead plus a transfer time for each sector.
+ */
+typedef struct
+{
+    uint32_t read_cmd_overhead_in_microsecs;    /** CMD17/CMD18 command and access time */
+    uint32_t write_cmd_overhead_in_microsecs;   /** CMD24/CMD25 command time, mostly the card programming its flash */
+    uint32_t sector_transfer_time_in_microsecs; /** the time to move one sector over the bus */
+} Image_Diskio_Latency_t;
+
+/**
+ * @brief Counts of the disk commands issued by FatFS are represented here.
+ */
+typedef struct
+{
+    uint32_t num_read_cmds;                  /** calls to disk_read(), e.g. read-modify-writes of partial sectors */
+    uint32_t num_sectors_read;               /** sectors read by all calls to disk_read() */
+    uint64_t num_bytes_read;                 /** bytes read by all calls to disk_read() */
+    uint32_t num_write_cmds;                 /** calls to disk_write() */
+    uint32_t num_single_sector_writes;       /** calls to disk_write() for a single sector, CMD24 on an SD card */
+    uint32_t num_sectors_written;            /** sectors written by all calls to disk_write() */
+    uint64_t num_bytes_written;              /** bytes written by all calls to disk_write() */
+    uint64_t busy_time_in_microsecs;         /** simulated time the card spent on all the commands */
+    uint32_t max_cmd_time_in_microsecs;      /** simulated time of the slowest command */
+    uint64_t host_time_in_nanosecs;          /** time the host spent in all calls to disk_read() and disk_write() */
+    uint32_t max_host_call_time_in_nanosecs; /** time the host spent in the slowest call */
+} Image_Diskio_Counters_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `image_diskio_init(p, n)` maps a blank disk image of `n` sectors into memory and clears the counters, and is
+ * true on success.
+ *
+ * @param path the image file to create, an existing file is overwritten. If NULL the image is only kept in memory.
+ *
+ * @param num_sectors the size of the disk, the image file is sparse so only the sectors written take up space.
+ *
+ * @post the disk is ready for `f_mkfs()`, the latency model is the default one in `image_diskio.c`.
+ */
+bool image_diskio_init(const char *path, uint32_t num_sectors);
+
+/**
+ * @brief `image_diskio_deinit()` writes the image back to its file, if it has one, and unmaps it.
+ */
+void image_diskio_deinit();
+
+/**
+ * @brief `image_diskio_set_latency(l)` sets the latency model used to simulate the busy time of each command.
+ *
+ * @param latency the latency model to use, copied.
+ */
+void image_diskio_set_latency(const Image_Diskio_Latency_t *latency);
+
+/**
+ * @brief `image_diskio_reset_counters()` sets all the counters to zero.
+ */
+void image_diskio_reset_counters();
+
+/**
+ * @brief `image_diskio_get_counters()` is a pointer to the counters gathered since the last reset.
+ */
+const Image_Diskio_Counters_t *image_diskio_get_counters();
+
+#endif /* IMAGE_DISKIO_H_ */
@@ -0,0 +1,427 @@
+/**
+ * Measures how well the on-device FLAC encoder `flac_encoder.c` compresses recordings, and how long it takes per
+ * sample, by running it on PCM WAVE files the way the recorder would: the first channel is cut down to 16 and to 24
+ * bits, and encoded one frame per DMA block at the sample rate of the file.
+ *
+ * With `--synth` a synthetic 384kHz recording is used instead, a quiet noise floor with an echolocation-like chirp every
+ * 100ms, which is handy for a quick check but no substitute for real field recordings.
+ *
+ * With `--out` the encoded streams are also written to .flac files, which can be checked with `flac --test`.
+ *
+ * usage: flac_bench [--out <dir>] [--synth <secs>] [<file.wav> ...]
+ */
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "audio_dma.h"
+#include "flac_encoder.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define ADC_SAMPLE_RATE (384000)
+
+// the time the recorder has to process each DMA block before the next one arrives
+#define BLOCK_BUDGET_IN_MICROSECS ((AUDIO_DMA_BUFF_LEN_IN_SAMPS * 1000000.0) / ADC_SAMPLE_RATE)
+
+// each file is encoded this many times and the fastest run is kept, to keep the host scheduler out of the timings
+#define NUM_TIMING_RUNS (5)
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The first channel of a recording, as 32 bit samples with the audio in the top bits, is represented here.
+ */
+typedef struct
+{
+    const char *name;
+    uint32_t sample_rate;
+    uint32_t num_samples;
+    int32_t *samples;
+} Recording_t;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `load_wav_file(p, r)` loads the first channel of the 16, 24, or 32 bit PCM WAVE file at `p` into `r`, and is
+ * true if it could.
+ */
+static bool load_wav_file(const char *path, Recording_t *recording);
+
+/**
+ * @brief `make_synth_recording(s, r)` fills `r` with `s` seconds of synthetic 384kHz audio.
+ */
+static void make_synth_recording(uint32_t secs, Recording_t *recording);
+
+/**
+ * @brief `bench(r, b, o)` encodes recording `r` at `b` bits per sample, prints a row of results, and writes the stream
+ * to a file in directory `o` if it is not NULL. It is true if the file could be written.
+ */
+static bool bench(const Recording_t *recording, uint32_t bits_per_sample, const char *out_dir);
+
+/**
+ * @brief `samples_per_block(r)` is the number of samples a DMA block turns into at sample rate `r`.
+ */
+static uint32_t samples_per_block(uint32_t sample_rate);
+
+static double now_in_secs();
+
+static uint64_t read_cycle_counter();
+
+static uint32_t read_u16(const uint8_t *p);
+
+static uint32_t read_u32(const uint8_t *p);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    const char *out_dir = NULL;
+    uint32_t synth_secs = 0;
+    int first_file_arg = argc;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            out_dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--synth") == 0 && i + 1 < argc)
+        {
+            synth_secs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (argv[i][0] != '-')
+        {
+            first_file_arg = i;
+            break;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--out <dir>] [--synth <secs>] [<file.wav> ...]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (synth_secs == 0 && first_file_arg == argc)
+    {
+        fprintf(stderr, "nothing to encode, give some WAVE files or --synth <secs>\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("each DMA block has to be processed within %.0fus, on the MAX32666 and not on this host\n", BLOCK_BUDGET_IN_MICROSECS);
+    printf("%-24s %7s %4s %8s %7s %8s %10s %8s %8s %8s\n",
+           "recording", "rate", "bits", "secs", "ratio", "verbatim", "ns/sample", "cyc/samp", "blk_us", "blk_max");
+
+    int exit_code = EXIT_SUCCESS;
+    Recording_t recording;
+
+    if (synth_secs > 0)
+    {
+        make_synth_recording(synth_secs, &recording);
+
+        if (!bench(&recording, 16, out_dir) || !bench(&recording, 24, out_dir))
+        {
+            exit_code = EXIT_FAILURE;
+        }
+
+        free(recording.samples);
+    }
+
+    for (int i = first_file_arg; i < argc; i++)
+    {
+        if (!load_wav_file(argv[i], &recording))
+        {
+            fprintf(stderr, "could not load %s as a PCM WAVE file\n", argv[i]);
+            exit_code = EXIT_FAILURE;
+            continue;
+        }
+
+        if (!bench(&recording, 16, out_dir) || !bench(&recording, 24, out_dir))
+        {
+            exit_code = EXIT_FAILURE;
+        }
+
+        free(recording.samples);
+    }
+
+    return exit_code;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool load_wav_file(const char *path, Recording_t *recording)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    const long file_len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t *file = malloc(file_len);
+    const bool read_ok = file != NULL && fread(file, 1, file_len, f) == (size_t)file_len;
+    fclose(f);
+
+    if (!read_ok || file_len < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0)
+    {
+        free(file);
+        return false;
+    }
+
+    uint32_t num_channels = 0;
+    uint32_t bits_per_sample = 0;
+    uint32_t sample_rate = 0;
+    const uint8_t *data = NULL;
+    uint32_t data_len = 0;
+
+    // walk the chunks, we only care about "fmt " and "data"
+    for (long pos = 12; pos + 8 <= file_len;)
+    {
+        const uint8_t *chunk = file + pos;
+        const uint32_t chunk_len = read_u32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && chunk_len >= 16)
+        {
+            num_channels = read_u16(chunk + 10);
+            sample_rate = read_u32(chunk + 12);
+            bits_per_sample = read_u16(chunk + 22);
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            data = chunk + 8;
+            data_len = chunk_len <= file_len - pos - 8 ? chunk_len : file_len - pos - 8;
+        }
+
+        pos += 8 + chunk_len + (chunk_len & 1); // chunks are padded to an even length
+    }
+
+    const uint32_t bytes_per_samp = bits_per_sample / 8;
+    const uint32_t bytes_per_frame = bytes_per_samp * num_channels;
+
+    if (data == NULL || num_channels == 0 || (bytes_per_samp != 2 && bytes_per_samp != 3 && bytes_per_samp != 4) ||
+        data_len < bytes_per_frame)
+    {
+        free(file);
+        return false;
+    }
+
+    const char *name = strrchr(path, '/');
+    recording->name = name != NULL ? name + 1 : path;
+    recording->sample_rate = sample_rate;
+    recording->num_samples = data_len / bytes_per_frame;
+    recording->samples = malloc(recording->num_samples * sizeof(int32_t));
+
+    for (uint32_t i = 0; i < recording->num_samples; i++)
+    {
+        const uint8_t *s = data + (i * bytes_per_frame);
+
+        // put the sample in the top of a 32 bit word, so cutting it down to any bit depth is a shift
+        uint32_t samp = 0;
+        for (uint32_t b = 0; b < bytes_per_samp; b++)
+        {
+            samp |= (uint32_t)s[b] << (8 * (b + 4 - bytes_per_samp));
+        }
+        recording->samples[i] = (int32_t)samp;
+    }
+
+    free(file);
+
+    return true;
+}
+
+void make_synth_recording(uint32_t secs, Recording_t *recording)
+{
+    const double chirp_period_in_secs = 0.1;
+    const double chirp_len_in_secs = 0.005;
+
+    recording->name = "synth";
+    recording->sample_rate = ADC_SAMPLE_RATE;
+    recording->num_samples = secs * ADC_SAMPLE_RATE;
+    recording->samples = malloc(recording->num_samples * sizeof(int32_t));
+
+    srand(1);
+
+    for (uint32_t i = 0; i < recording->num_samples; i++)
+    {
+        const double t = (double)i / ADC_SAMPLE_RATE;
+
+        // a noise floor about 60dB below full scale
+        double val = 0.001 * (((double)rand() / RAND_MAX) - 0.5);
+
+        // a chirp sweeping down from 80kHz to 20kHz, with a raised cosine envelope
+        const double t_in_chirp = fmod(t, chirp_period_in_secs);
+        if (t_in_chirp < chirp_len_in_secs)
+        {
+            const double sweep = (20000.0 - 80000.0) / chirp_len_in_secs;
+            const double phase = 2 * M_PI * ((80000.0 * t_in_chirp) + (0.5 * sweep * t_in_chirp * t_in_chirp));
+            const double envelope = 0.5 * (1 - cos(2 * M_PI * t_in_chirp / chirp_len_in_secs));
+            val += 0.5 * envelope * sin(phase);
+        }
+
+        recording->samples[i] = (int32_t)(val * 2147483647.0);
+    }
+}
+
+bool bench(const Recording_t *recording, uint32_t bits_per_sample, const char *out_dir)
+{
+    const uint32_t bytes_per_sample = bits_per_sample / 8;
+    const uint32_t block_len = samples_per_block(recording->sample_rate);
+    const uint32_t num_samples = recording->num_samples;
+
+    // the packed little-endian samples the recorder hands to the encoder
+    uint8_t *pcm = malloc((size_t)num_samples * bytes_per_sample);
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        const uint32_t samp = (uint32_t)recording->samples[i] >> (32 - bits_per_sample);
+        for (uint32_t b = 0; b < bytes_per_sample; b++)
+        {
+            pcm[(i * bytes_per_sample) + b] = (uint8_t)(samp >> (8 * b));
+        }
+    }
+
+    const uint32_t num_blocks = (num_samples + block_len - 1) / block_len;
+    uint8_t *stream = malloc(FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES + ((size_t)num_blocks * FLAC_ENCODER_MAX_FRAME_LEN_IN_BYTES(block_len, bits_per_sample)));
+
+    const Flac_Encoder_Stream_Info_t info = {
+        .sample_rate = recording->sample_rate,
+        .bits_per_sample = bits_per_sample,
+        .max_block_len_in_samples = block_len,
+        .total_samples = num_samples,
+    };
+
+    double best_secs = INFINITY;
+    uint64_t best_cycles = UINT64_MAX;
+    double max_block_secs = 0;
+    size_t stream_len = 0;
+    uint32_t num_verbatim_frames = 0;
+
+    for (uint32_t run = 0; run < NUM_TIMING_RUNS; run++)
+    {
+        stream_len = flac_encoder_write_stream_header(&info, stream);
+        num_verbatim_frames = 0;
+        double run_max_block_secs = 0;
+
+        const double start_secs = now_in_secs();
+        const uint64_t start_cycles = read_cycle_counter();
+
+        for (uint32_t first = 0; first < num_samples; first += block_len)
+        {
+            const uint32_t len = num_samples - first < block_len ? num_samples - first : block_len;
+            const double block_start_secs = now_in_secs();
+
+            const uint32_t frame_len = flac_encoder_encode_frame(pcm + ((size_t)first * bytes_per_sample), len, bits_per_sample, first, stream + stream_len);
+
+            const double block_secs = now_in_secs() - block_start_secs;
+            run_max_block_secs = block_secs > run_max_block_secs ? block_secs : run_max_block_secs;
+
+            // a verbatim frame is longer than its samples, a fixed one hardly ever is
+            if (frame_len >= len * bytes_per_sample)
+            {
+                num_verbatim_frames += 1;
+            }
+
+            stream_len += frame_len;
+        }
+
+        const uint64_t cycles = read_cycle_counter() - start_cycles;
+        const double secs = now_in_secs() - start_secs;
+
+        if (secs < best_secs)
+        {
+            best_secs = secs;
+            best_cycles = cycles;
+            max_block_secs = run_max_block_secs;
+        }
+    }
+
+    const double ratio = (double)stream_len / ((double)num_samples * bytes_per_sample);
+
+    printf("%-24.24s %7u %4u %8.1f %7.3f %7.1f%% %10.2f %8.1f %8.1f %8.1f\n",
+           recording->name,
+           recording->sample_rate,
+           bits_per_sample,
+           (double)num_samples / recording->sample_rate,
+           ratio,
+           (100.0 * num_verbatim_frames) / num_blocks,
+           (best_secs * 1e9) / num_samples,
+           (double)best_cycles / num_samples,
+           (best_secs * 1e6) / num_blocks,
+           max_block_secs * 1e6);
+
+    bool ok = true;
+
+    if (out_dir != NULL)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s_%u_bit.flac", out_dir, recording->name, bits_per_sample);
+
+        FILE *f = fopen(path, "wb");
+        ok = f != NULL && fwrite(stream, 1, stream_len, f) == stream_len;
+
+        if (f != NULL)
+        {
+            fclose(f);
+        }
+
+        if (!ok)
+        {
+            fprintf(stderr, "could not write %s\n", path);
+        }
+    }
+
+    free(stream);
+    free(pcm);
+
+    return ok;
+}
+
+uint32_t samples_per_block(uint32_t sample_rate)
+{
+    // rates the recorder doesn't decimate to are encoded in blocks as long as the DMA block
+    if (sample_rate == 0 || sample_rate > ADC_SAMPLE_RATE || ADC_SAMPLE_RATE % sample_rate != 0 || ADC_SAMPLE_RATE / sample_rate > 16)
+    {
+        return AUDIO_DMA_BUFF_LEN_IN_SAMPS;
+    }
+
+    return AUDIO_DMA_BUFF_LEN_IN_SAMPS / (ADC_SAMPLE_RATE / sample_rate);
+}
+
+double now_in_secs()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + ((double)t.tv_nsec / 1e9);
+}
+
+uint64_t read_cycle_counter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    // no portable cycle counter, the column reads 0
+    return 0;
+#endif
+}
+
+uint32_t read_u16(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+uint32_t read_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
@@ -0,0 +1,121 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "ad4630_model.h"
+#include "hal_gpio.h"
+#include "hal_gpio_host.h"
+#include "hal_spi.h"
+#include "hal_spi_host.h"
+
+#include <stdint.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the wiring on the board, see ad4630.c and audio_dma.c
+#define CONFIG_SPI_BUS (HAL_SPI_BUS_2)
+#define CONFIG_SPI_CS_PIN (HAL_GPIO_PIN(16))
+#define CLK_EN_PIN (HAL_GPIO_PIN(20))
+#define BUSY_PIN (HAL_GPIO_PIN(3))
+
+// the config SPI frame is a read/write bit and a 15 bit register address, then one data byte
+#define FRAME_LEN_IN_BYTES (3)
+#define FRAME_READ_FLAG (1u << 7)
+
+#define REG_EXIT_CFG_MD (0x14)
+#define REG_MODES (0x20)
+#define REG_OSCILLATOR (0x21)
+#define REG_CONFIG_MODE_SPECIAL_CONSTANT (0x3fff)
+
+#define EXIT_CFG_MD_FLAG_EXIT (1)
+
+// the busy pin is high for one read in this many, so the firmware sees both edges whenever it starts looking
+#define BUSY_PERIOD_IN_READS (3)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static bool in_register_access_mode = false;
+static bool oscillator_written = false;
+static bool modes_written = false;
+static bool configured = false;
+
+static uint32_t num_busy_reads = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `config_spi_transaction(t, tl, r, rl)` answers one config SPI frame, it is only heard while chip select is low.
+ */
+static bool config_spi_transaction(const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len);
+
+/**
+ * @brief `busy_pin_level()` is the level of the busy pin, it only pulses while conversions are enabled.
+ */
+static bool busy_pin_level();
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void ad4630_model_attach()
+{
+    hal_spi_host_attach(CONFIG_SPI_BUS, config_spi_transaction);
+    hal_gpio_host_attach_input(HAL_GPIO_PORT_0, BUSY_PIN, busy_pin_level);
+}
+
+bool ad4630_model_is_configured()
+{
+    return configured;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool config_spi_transaction(const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len)
+{
+    if (hal_gpio_host_output_level(HAL_GPIO_PORT_0, CONFIG_SPI_CS_PIN) || tx_len < FRAME_LEN_IN_BYTES)
+    {
+        return false;
+    }
+
+    const bool is_read = (tx_buff[0] & FRAME_READ_FLAG) != 0u;
+    const uint32_t reg = ((uint32_t)(tx_buff[0] & ~FRAME_READ_FLAG) << 8) | tx_buff[1];
+
+    if (is_read)
+    {
+        if (reg == REG_CONFIG_MODE_SPECIAL_CONSTANT)
+        {
+            in_register_access_mode = true;
+        }
+
+        // no register we model has a value worth reading back
+        for (uint32_t i = 0; i < rx_len; i++)
+        {
+            rx_buff[i] = 0;
+        }
+
+        return true;
+    }
+
+    if (!in_register_access_mode)
+    {
+        return true; // writes outside register access mode are ignored, like on the ADC
+    }
+
+    oscillator_written = oscillator_written || reg == REG_OSCILLATOR;
+    modes_written = modes_written || reg == REG_MODES;
+
+    if (reg == REG_EXIT_CFG_MD && (tx_buff[2] & EXIT_CFG_MD_FLAG_EXIT) != 0u)
+    {
+        in_register_access_mode = false;
+        configured = oscillator_written && modes_written;
+    }
+
+    return true;
+}
+
+bool busy_pin_level()
+{
+    if (!hal_gpio_host_output_level(HAL_GPIO_PORT_0, CLK_EN_PIN))
+    {
+        return false;
+    }
+
+    return (num_busy_reads++ % BUSY_PERIOD_IN_READS) == (BUSY_PERIOD_IN_READS - 1);
+}
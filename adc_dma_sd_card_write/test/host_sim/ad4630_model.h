@@ -0,0 +1,33 @@
+/**
+ * @file      ad4630_model.h
+ * @brief     A model of the AD4630 ADC for the host simulator is represented here.
+ * @details   The model sits on the config SPI bus and the ADC GPIO pins of the simulated HAL, so the real `ad4630.c`
+ *            configures it and starts and stops conversions just like on the board. It answers register reads and
+ *            writes while its chip select is low, and while the clock enable pin is high its busy pin pulses with each
+ *            conversion, which `audio_dma_start()` waits for. The samples themselves come from the simulated DMA
+ *            stream, see `hal_dma_host.h`.
+ */
+
+#ifndef AD4630_MODEL_H_
+#define AD4630_MODEL_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `ad4630_model_attach()` puts the model on the simulated config SPI bus and ADC pins.
+ *
+ * @post `ad4630_init()` talks to the model.
+ */
+void ad4630_model_attach();
+
+/**
+ * @brief `ad4630_model_is_configured()` is true if the model was put in register access mode, had its oscillator and
+ * modes registers written, and was taken back out of register access mode, in that order.
+ */
+bool ad4630_model_is_configured();
+
+#endif /* AD4630_MODEL_H_ */
@@ -0,0 +1,49 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "cycle_counter.h"
+
+#include <time.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the host counts microseconds of the monotonic clock, which wraps around after a little over an hour
+#define HOST_CYCLE_COUNTER_FREQ_HZ (1000000)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static uint64_t start_microsecs = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `monotonic_microsecs()` is the time on the host monotonic clock in microseconds.
+ */
+static uint64_t monotonic_microsecs();
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void cycle_counter_init()
+{
+    start_microsecs = monotonic_microsecs();
+}
+
+uint32_t cycle_counter_now()
+{
+    return (uint32_t)(monotonic_microsecs() - start_microsecs);
+}
+
+uint32_t cycle_counter_freq_hz()
+{
+    return HOST_CYCLE_COUNTER_FREQ_HZ;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+uint64_t monotonic_microsecs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000) + ((uint64_t)now.tv_nsec / 1000);
+}
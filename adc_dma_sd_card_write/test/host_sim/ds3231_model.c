@@ -0,0 +1,153 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "ds3231_model.h"
+#include "hal_i2c_host.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define DS3231_7_BIT_I2C_ADDR (0x68u)
+
+#define NUM_REGS (0x13u)
+
+// the time keeping registers come first, seconds to years
+#define REG_SECONDS (0x00u)
+#define REG_MINUTES (0x01u)
+#define REG_HOUR (0x02u)
+#define REG_DAY (0x03u)
+#define REG_DATE (0x04u)
+#define REG_MONTH (0x05u)
+#define REG_YEAR (0x06u)
+#define NUM_TIME_REGS (7u)
+
+#define MONTH_REG_FLAG_CENTURY (1u << 7u)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static uint8_t regs[NUM_REGS];
+
+// the register the next byte is read from or written to, it advances with every byte and wraps around
+static uint8_t reg_pointer = 0;
+
+// the difference between the time in the time keeping registers and the host clock, in seconds
+static time_t offset_from_host_clock_in_secs = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+static bool ds3231_write(const uint8_t *tx_buff, uint32_t tx_len);
+
+static bool ds3231_read(uint8_t *rx_buff, uint32_t rx_len);
+
+/**
+ * @brief `update_time_regs()` stores the time now in the time keeping registers, in BCD.
+ */
+static void update_time_regs();
+
+/**
+ * @brief `apply_time_regs()` makes the time in the time keeping registers the time now.
+ */
+static void apply_time_regs();
+
+static uint8_t to_bcd(int decimal);
+
+static int from_bcd(uint8_t bcd);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void ds3231_model_attach(Hal_I2C_Bus_t bus)
+{
+    static const Hal_I2C_Host_Device_t ds3231_device = {
+        .write = ds3231_write,
+        .read = ds3231_read,
+    };
+
+    hal_i2c_host_attach(bus, DS3231_7_BIT_I2C_ADDR, &ds3231_device);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool ds3231_write(const uint8_t *tx_buff, uint32_t tx_len)
+{
+    // the first byte sets the register pointer, the rest are written from there on
+    reg_pointer = tx_buff[0] % NUM_REGS;
+
+    if (tx_len == 1)
+    {
+        return true;
+    }
+
+    // fields the write leaves alone keep counting
+    update_time_regs();
+
+    bool time_written = false;
+    for (uint32_t i = 1; i < tx_len; i++)
+    {
+        time_written = time_written || reg_pointer < NUM_TIME_REGS;
+        regs[reg_pointer] = tx_buff[i];
+        reg_pointer = (reg_pointer + 1) % NUM_REGS;
+    }
+
+    if (time_written)
+    {
+        apply_time_regs();
+    }
+
+    return true;
+}
+
+bool ds3231_read(uint8_t *rx_buff, uint32_t rx_len)
+{
+    update_time_regs();
+
+    for (uint32_t i = 0; i < rx_len; i++)
+    {
+        rx_buff[i] = regs[reg_pointer];
+        reg_pointer = (reg_pointer + 1) % NUM_REGS;
+    }
+
+    return true;
+}
+
+void update_time_regs()
+{
+    const time_t now = time(NULL) + offset_from_host_clock_in_secs;
+    struct tm t;
+    localtime_r(&now, &t);
+
+    regs[REG_SECONDS] = to_bcd(t.tm_sec);
+    regs[REG_MINUTES] = to_bcd(t.tm_min);
+    regs[REG_HOUR] = to_bcd(t.tm_hour); // 24 hour time
+    regs[REG_DAY] = to_bcd(t.tm_wday + 1);
+    regs[REG_DATE] = to_bcd(t.tm_mday);
+    regs[REG_MONTH] = to_bcd(t.tm_mon + 1) | (t.tm_year >= 100 ? MONTH_REG_FLAG_CENTURY : 0u);
+    regs[REG_YEAR] = to_bcd(t.tm_year % 100);
+}
+
+void apply_time_regs()
+{
+    struct tm t = {
+        .tm_sec = from_bcd(regs[REG_SECONDS]),
+        .tm_min = from_bcd(regs[REG_MINUTES]),
+        .tm_hour = from_bcd(regs[REG_HOUR] & 0x3fu),
+        .tm_mday = from_bcd(regs[REG_DATE]),
+        .tm_mon = from_bcd(regs[REG_MONTH] & 0x1fu) - 1,
+        .tm_year = from_bcd(regs[REG_YEAR]) + ((regs[REG_MONTH] & MONTH_REG_FLAG_CENTURY) != 0u ? 100 : 0),
+        .tm_isdst = -1,
+    };
+
+    offset_from_host_clock_in_secs = mktime(&t) - time(NULL);
+}
+
+uint8_t to_bcd(int decimal)
+{
+    return (uint8_t)(((decimal / 10) << 4) | (decimal % 10));
+}
+
+int from_bcd(uint8_t bcd)
+{
+    return ((bcd >> 4) * 10) + (bcd & 0x0fu);
+}
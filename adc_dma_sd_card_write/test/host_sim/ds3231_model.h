@@ -0,0 +1,25 @@
+/**
+ * @file      ds3231_model.h
+ * @brief     A model of the DS3231 real time clock for the host simulator is represented here.
+ * @details   The model sits on the simulated I2C bus, so the real `real_time_clock.c` reads and sets it just like on the
+ *            board. Its time is the host clock in local time, plus whatever offset setting the time registers made, and
+ *            it keeps the other registers without acting on them, nothing in the simulator waits on the alarm.
+ */
+
+#ifndef DS3231_MODEL_H_
+#define DS3231_MODEL_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include "hal_i2c.h"
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `ds3231_model_attach(b)` puts the model on simulated I2C bus `b`.
+ *
+ * @post `real_time_clock_init(b)` talks to the model.
+ */
+void ds3231_model_attach(Hal_I2C_Bus_t bus);
+
+#endif /* DS3231_MODEL_H_ */
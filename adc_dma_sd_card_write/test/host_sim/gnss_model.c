@@ -0,0 +1,118 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "gnss_model.h"
+#include "hal_gpio_host.h"
+#include "hal_uart_host.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the wiring on the board, see gnss_module.c
+#define GNSS_UART (HAL_UART_2)
+#define GNSS_ENABLE_PORT (HAL_GPIO_PORT_0)
+#define GNSS_ENABLE_MASK (HAL_GPIO_PIN(23))
+
+// room for the GGA and RMC sentences of one second, each is at most 82 chars
+#define SENTENCE_BUFF_LEN (256)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the sentences of the last second, and how far the firmware has read them
+static char sentences[SENTENCE_BUFF_LEN];
+static uint32_t sentences_len = 0;
+static uint32_t sentences_pos = 0;
+
+// the second the last sentences were sent in, 0 while the module is powered down
+static time_t last_sent_secs = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+static uint32_t gnss_read(uint8_t *rx_buff, uint32_t max_len);
+
+/**
+ * @brief `send_sentences(t)` queues up the GGA and RMC sentences of a fix at UTC time `t`.
+ */
+static void send_sentences(time_t now);
+
+/**
+ * @brief `append_sentence(b)` queues up sentence body `b`, framed by '$' and its checksum.
+ */
+static void append_sentence(const char *body);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void gnss_model_attach()
+{
+    hal_uart_host_attach(GNSS_UART, gnss_read);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+uint32_t gnss_read(uint8_t *rx_buff, uint32_t max_len)
+{
+    if (!hal_gpio_host_output_level(GNSS_ENABLE_PORT, GNSS_ENABLE_MASK))
+    {
+        // powered down, anything not read yet is lost
+        sentences_len = 0;
+        sentences_pos = 0;
+        last_sent_secs = 0;
+        return 0;
+    }
+
+    const time_t now = time(NULL);
+    if (now != last_sent_secs && sentences_pos == sentences_len)
+    {
+        send_sentences(now);
+        last_sent_secs = now;
+    }
+
+    uint32_t num_read = 0;
+    while (num_read < max_len && sentences_pos < sentences_len)
+    {
+        rx_buff[num_read++] = (uint8_t)sentences[sentences_pos++];
+    }
+
+    return num_read;
+}
+
+void send_sentences(time_t now)
+{
+    struct tm t;
+    gmtime_r(&now, &t);
+
+    sentences_len = 0;
+    sentences_pos = 0;
+
+    char body[SENTENCE_BUFF_LEN];
+
+    // a fix of quality 1 with 8 satellites
+    snprintf(body, sizeof(body), "GPGGA,%02d%02d%02d.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,",
+             t.tm_hour, t.tm_min, t.tm_sec);
+    append_sentence(body);
+
+    snprintf(body, sizeof(body), "GPRMC,%02d%02d%02d.00,A,4807.038,N,01131.000,E,0.0,0.0,%02d%02d%02d,,",
+             t.tm_hour, t.tm_min, t.tm_sec, t.tm_mday, t.tm_mon + 1, t.tm_year % 100);
+    append_sentence(body);
+}
+
+void append_sentence(const char *body)
+{
+    // the checksum is the XOR of the chars between the '$' and the '*'
+    uint8_t checksum = 0;
+    for (const char *c = body; *c != '\0'; c++)
+    {
+        checksum ^= (uint8_t)*c;
+    }
+
+    const int len = snprintf(&sentences[sentences_len], SENTENCE_BUFF_LEN - sentences_len, "$%s*%02X\r\n", body, checksum);
+    if (len > 0 && sentences_len + (uint32_t)len < SENTENCE_BUFF_LEN)
+    {
+        sentences_len += (uint32_t)len;
+    }
+}
@@ -0,0 +1,22 @@
+/**
+ * @file      gnss_model.h
+ * @brief     A model of the optional GNSS module for the host simulator is represented here.
+ * @details   The model sits on the simulated GNSS UART, so the real `gnss_module.c` parses what it sends just like on
+ *            the board. While the enable pin powers it, it sends a GGA and an RMC sentence with a good fix once a
+ *            second, giving the host clock in UTC, and it sends nothing while powered down. It has a fix from the
+ *            start, so the simulator doesn't wait out the half a minute or more a real module takes to find one.
+ */
+
+#ifndef GNSS_MODEL_H_
+#define GNSS_MODEL_H_
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `gnss_model_attach()` puts the model on the simulated GNSS UART.
+ *
+ * @post `gnss_module_init()` talks to the model.
+ */
+void gnss_model_attach();
+
+#endif /* GNSS_MODEL_H_ */
@@ -0,0 +1,158 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "audio_dma.h"
+#include "hal_dma.h"
+#include "hal_dma_host.h"
+#include "hal_timer_host.h"
+#include "host_adc_source.h"
+
+#include <pthread.h>
+#include <stddef.h> // for NULL
+#include <time.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define NANOSECS_PER_SEC (1000000000L)
+
+// the simulated ADC produces packed 24 bit samples
+#define BYTES_PER_SAMPLE (3)
+
+// how long the lockstep producer waits between checks for the consumer to catch up
+#define LOCKSTEP_POLL_PERIOD_IN_NANOSECS (20000L)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static uint32_t block_len = 0;
+
+static Hal_DMA_Block_Done_Handler_t block_done_handler = NULL;
+
+static uint8_t *first_block = NULL;
+
+static Hal_DMA_Host_Lockstep_Gate_t lockstep_gate = NULL;
+
+static pthread_t producer_thread;
+static volatile bool stream_running = false;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `producer_thread_func(a)` stands in for the DMA and its interrupt, it fills one block at a time from the
+ * simulated ADC and runs the block done handler after each one until the stream is stopped.
+ */
+static void *producer_thread_func(void *arg);
+
+/**
+ * @brief `timespec_add_nanosecs(t, n)` advances time `t` by `n` nanoseconds.
+ */
+static void timespec_add_nanosecs(struct timespec *t, long nanosecs);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_dma_host_set_lockstep_gate(Hal_DMA_Host_Lockstep_Gate_t gate)
+{
+    lockstep_gate = gate;
+}
+
+Hal_DMA_Error_t hal_dma_init(Hal_SPI_Bus_t bus, uint32_t block_len_in_bytes, Hal_DMA_Block_Done_Handler_t handler)
+{
+    (void)bus;
+
+    block_len = block_len_in_bytes;
+    block_done_handler = handler;
+
+    return HAL_DMA_ERROR_ALL_OK;
+}
+
+Hal_DMA_Error_t hal_dma_prepare(uint8_t *block)
+{
+    first_block = block;
+
+    return HAL_DMA_ERROR_ALL_OK;
+}
+
+Hal_DMA_Error_t hal_dma_start()
+{
+    // every recording sees the same samples, like a real ADC sampling the same input
+    host_adc_source_rewind();
+
+    stream_running = true;
+
+    if (pthread_create(&producer_thread, NULL, producer_thread_func, NULL) != 0)
+    {
+        stream_running = false;
+        return HAL_DMA_ERROR_DMA_ERROR;
+    }
+
+    return HAL_DMA_ERROR_ALL_OK;
+}
+
+Hal_DMA_Error_t hal_dma_stop()
+{
+    if (!stream_running)
+    {
+        return HAL_DMA_ERROR_ALL_OK;
+    }
+
+    stream_running = false;
+
+    return pthread_join(producer_thread, NULL) == 0 ? HAL_DMA_ERROR_ALL_OK : HAL_DMA_ERROR_DMA_ERROR;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void *producer_thread_func(void *arg)
+{
+    (void)arg;
+
+    const double speed = hal_timer_host_get_speed();
+    const bool lockstep = speed <= 0.0;
+    const long block_period_in_nanosecs = lockstep ? 0 : (long)((AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS * 1000.0) / speed);
+
+    uint8_t *block = first_block;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    while (stream_running)
+    {
+        if (lockstep && lockstep_gate != NULL)
+        {
+            // wait for the consumer to be ready before making another block
+            const struct timespec poll_period = {.tv_sec = 0, .tv_nsec = LOCKSTEP_POLL_PERIOD_IN_NANOSECS};
+            while (stream_running && !lockstep_gate())
+            {
+                nanosleep(&poll_period, NULL);
+            }
+        }
+
+        // the real DMA fills the block gradually over the block period, we fill it all at once at the start
+        host_adc_source_fill(block, block_len / BYTES_PER_SAMPLE);
+
+        if (!lockstep)
+        {
+            timespec_add_nanosecs(&deadline, block_period_in_nanosecs);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        }
+
+        if (!stream_running)
+        {
+            break;
+        }
+
+        block = block_done_handler();
+    }
+
+    return NULL;
+}
+
+void timespec_add_nanosecs(struct timespec *t, long nanosecs)
+{
+    t->tv_nsec += nanosecs;
+
+    while (t->tv_nsec >= NANOSECS_PER_SEC)
+    {
+        t->tv_nsec -= NANOSECS_PER_SEC;
+        t->tv_sec += 1;
+    }
+}
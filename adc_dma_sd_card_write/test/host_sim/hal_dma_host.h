@@ -0,0 +1,36 @@
+/**
+ * @file      hal_dma_host.h
+ * @brief     Host-only controls for the simulated DMA back-end are represented here.
+ * @details   The simulated back-end implements `hal_dma.h` with a producer thread that fills one block at a time from
+ *            the simulated ADC (see `host_adc_source.h`) and runs the block done handler after each one, standing in
+ *            for the DMA and its interrupt. Blocks come at the pace of a real 384kHz stream or some multiple of it,
+ *            see `hal_timer_host_set_speed()`.
+ */
+
+#ifndef HAL_DMA_HOST_H_
+#define HAL_DMA_HOST_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A check of whether the consumer is ready for the next block is represented here, see
+ * `hal_dma_host_set_lockstep_gate()`.
+ */
+typedef bool (*Hal_DMA_Host_Lockstep_Gate_t)();
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_dma_host_set_lockstep_gate(g)` makes a lockstep stream (a speed of 0.0) wait for `g()` to be true before
+ * filling each block, e.g. until the consumer has taken every block so far. Without a gate a lockstep stream produces
+ * blocks as fast as it can.
+ *
+ * @pre the DMA stream is stopped.
+ */
+void hal_dma_host_set_lockstep_gate(Hal_DMA_Host_Lockstep_Gate_t gate);
+
+#endif /* HAL_DMA_HOST_H_ */
@@ -0,0 +1,94 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_gpio.h"
+#include "hal_gpio_host.h"
+
+#include <stddef.h> // for NULL
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define MAX_NUM_ATTACHED_INPUTS (8)
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+
+typedef struct
+{
+    Hal_GPIO_Port_t port;
+    uint32_t mask;
+    Hal_GPIO_Host_Input_t input;
+} Attached_Input_t;
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the pins are written from the main loop and the callback thread, so the levels are only touched atomically
+static uint32_t port_levels[HAL_GPIO_NUM_PORTS];
+
+static Attached_Input_t attached_inputs[MAX_NUM_ATTACHED_INPUTS];
+static uint32_t num_attached_inputs = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `find_attached_input(p)` is the input a device model attached to any of the pins of `p`, or NULL if none.
+ */
+static Hal_GPIO_Host_Input_t find_attached_input(const Hal_GPIO_Pin_t *pin);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_gpio_host_attach_input(Hal_GPIO_Port_t port, uint32_t mask, Hal_GPIO_Host_Input_t input)
+{
+    if (num_attached_inputs < MAX_NUM_ATTACHED_INPUTS)
+    {
+        attached_inputs[num_attached_inputs++] = (Attached_Input_t){.port = port, .mask = mask, .input = input};
+    }
+}
+
+bool hal_gpio_host_output_level(Hal_GPIO_Port_t port, uint32_t mask)
+{
+    return (__atomic_load_n(&port_levels[port], __ATOMIC_ACQUIRE) & mask) != 0u;
+}
+
+Hal_GPIO_Error_t hal_gpio_config(const Hal_GPIO_Pin_t *pin)
+{
+    return pin->port < HAL_GPIO_NUM_PORTS ? HAL_GPIO_ERROR_ALL_OK : HAL_GPIO_ERROR_CONFIG_ERROR;
+}
+
+void hal_gpio_write(const Hal_GPIO_Pin_t *pin, bool state)
+{
+    if (state)
+    {
+        __atomic_fetch_or(&port_levels[pin->port], pin->mask, __ATOMIC_ACQ_REL);
+    }
+    else
+    {
+        __atomic_fetch_and(&port_levels[pin->port], ~pin->mask, __ATOMIC_ACQ_REL);
+    }
+}
+
+void hal_gpio_toggle(const Hal_GPIO_Pin_t *pin)
+{
+    __atomic_fetch_xor(&port_levels[pin->port], pin->mask, __ATOMIC_ACQ_REL);
+}
+
+bool hal_gpio_read(const Hal_GPIO_Pin_t *pin)
+{
+    const Hal_GPIO_Host_Input_t input = find_attached_input(pin);
+
+    return input != NULL ? input() : hal_gpio_host_output_level(pin->port, pin->mask);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+Hal_GPIO_Host_Input_t find_attached_input(const Hal_GPIO_Pin_t *pin)
+{
+    for (uint32_t i = 0; i < num_attached_inputs; i++)
+    {
+        if (attached_inputs[i].port == pin->port && (attached_inputs[i].mask & pin->mask) != 0u)
+        {
+            return attached_inputs[i].input;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file      hal_gpio_host.h
+ * @brief     Host-only controls for the simulated GPIO back-end are represented here.
+ * @details   The simulated back-end implements `hal_gpio.h` with a level for every pin. Writes set the level, and reads
+ *            return it, unless a device model has attached an input to the pin, then reads return whatever the model
+ *            drives, e.g. the busy pin of the simulated ADC. Device models can read back the outputs the firmware
+ *            drives, e.g. a chip select.
+ */
+
+#ifndef HAL_GPIO_HOST_H_
+#define HAL_GPIO_HOST_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal_gpio.h"
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A device model driving an input pin is represented here, it is the level of the pin each time it is read.
+ */
+typedef bool (*Hal_GPIO_Host_Input_t)();
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_gpio_host_attach_input(p, m, f)` makes every read of the pins `m` of port `p` return `f()`.
+ *
+ * @pre `f` is safe to call from any thread that reads the pins.
+ */
+void hal_gpio_host_attach_input(Hal_GPIO_Port_t port, uint32_t mask, Hal_GPIO_Host_Input_t input);
+
+/**
+ * @brief `hal_gpio_host_output_level(p, m)` is true if any of the pins `m` of port `p` was last written high.
+ */
+bool hal_gpio_host_output_level(Hal_GPIO_Port_t port, uint32_t mask);
+
+#endif /* HAL_GPIO_HOST_H_ */
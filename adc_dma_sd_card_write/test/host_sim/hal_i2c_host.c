@@ -0,0 +1,70 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_i2c.h"
+#include "hal_i2c_host.h"
+
+#include <stddef.h> // for NULL
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define NUM_7_BIT_ADDRS (128)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static const Hal_I2C_Host_Device_t *attached_devices[HAL_I2C_NUM_BUSES][NUM_7_BIT_ADDRS];
+
+static bool bus_initialized[HAL_I2C_NUM_BUSES];
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_i2c_host_attach(Hal_I2C_Bus_t bus, uint8_t addr, const Hal_I2C_Host_Device_t *device)
+{
+    attached_devices[bus][addr % NUM_7_BIT_ADDRS] = device;
+}
+
+Hal_I2C_Error_t hal_i2c_init(Hal_I2C_Bus_t bus, Hal_I2C_Speed_t speed)
+{
+    (void)speed;
+
+    if (bus >= HAL_I2C_NUM_BUSES)
+    {
+        return HAL_I2C_ERROR_CONFIG_ERROR;
+    }
+
+    bus_initialized[bus] = true;
+
+    return HAL_I2C_ERROR_ALL_OK;
+}
+
+Hal_I2C_Error_t hal_i2c_write(Hal_I2C_Bus_t bus, uint8_t addr, const uint8_t *tx_buff, uint32_t tx_len)
+{
+    return hal_i2c_write_read(bus, addr, tx_buff, tx_len, NULL, 0);
+}
+
+Hal_I2C_Error_t hal_i2c_write_read(Hal_I2C_Bus_t bus, uint8_t addr, const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len)
+{
+    if (bus >= HAL_I2C_NUM_BUSES || !bus_initialized[bus] || addr >= NUM_7_BIT_ADDRS)
+    {
+        return HAL_I2C_ERROR_TRANSACTION_ERROR;
+    }
+
+    const Hal_I2C_Host_Device_t *device = attached_devices[bus][addr];
+    if (device == NULL)
+    {
+        return HAL_I2C_ERROR_TRANSACTION_ERROR;
+    }
+
+    // the write is done before the read starts, so the rx buffer can be the tx buffer like on the MAX32666
+    if (tx_len > 0 && !device->write(tx_buff, tx_len))
+    {
+        return HAL_I2C_ERROR_TRANSACTION_ERROR;
+    }
+
+    if (rx_len > 0 && !device->read(rx_buff, rx_len))
+    {
+        return HAL_I2C_ERROR_TRANSACTION_ERROR;
+    }
+
+    return HAL_I2C_ERROR_ALL_OK;
+}
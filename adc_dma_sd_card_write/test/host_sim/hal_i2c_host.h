@@ -0,0 +1,41 @@
+/**
+ * @file      hal_i2c_host.h
+ * @brief     Host-only controls for the simulated I2C back-end are represented here.
+ * @details   The simulated back-end implements `hal_i2c.h` by handing each transaction to the device model attached at
+ *            the address on the bus. A transaction to an address with nothing attached fails as if it was not
+ *            acknowledged, and so does a transaction on a bus that hasn't been initialized.
+ */
+
+#ifndef HAL_I2C_HOST_H_
+#define HAL_I2C_HOST_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal_i2c.h"
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A device model on an I2C bus is represented here. A transaction is a write of the tx bytes, if there are any,
+ * then a read of the rx bytes, if there are any. Each part is true if the device acknowledged it.
+ */
+typedef struct
+{
+    bool (*write)(const uint8_t *tx_buff, uint32_t tx_len);
+    bool (*read)(uint8_t *rx_buff, uint32_t rx_len);
+} Hal_I2C_Host_Device_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_i2c_host_attach(b, a, d)` hands every following transaction to 7 bit address `a` on bus `b` to device
+ * model `d`.
+ *
+ * @pre `d` outlives the simulation.
+ */
+void hal_i2c_host_attach(Hal_I2C_Bus_t bus, uint8_t addr, const Hal_I2C_Host_Device_t *device);
+
+#endif /* HAL_I2C_HOST_H_ */
@@ -0,0 +1,19 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_sdhc.h"
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+// there is no controller on the host, the card behind the FatFS disk layer is always ready
+
+Hal_SDHC_Error_t hal_sdhc_init()
+{
+    return HAL_SDHC_ERROR_ALL_OK;
+}
+
+Hal_SDHC_Error_t hal_sdhc_init_card(uint32_t num_retries)
+{
+    (void)num_retries;
+    return HAL_SDHC_ERROR_ALL_OK;
+}
@@ -0,0 +1,71 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_sleep.h"
+#include "hal_sleep_host.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define NANOSECS_PER_SEC (1000000000L)
+
+// the longest the main loop waits for a signal, so a wake-up the host back-ends don't signal only costs a little time
+// rather than hanging the simulation. It is well over a DMA block, the ticks are held off while the main loop waits, so
+// running out would count as a wake-up the board doesn't have
+#define MAX_WAIT_IN_NANOSECS (100000000L)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static pthread_mutex_t interrupt_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t interrupt_signalled = PTHREAD_COND_INITIALIZER;
+
+// counts every signal, so the main loop can tell whether one came since it masked interrupts
+static uint64_t num_interrupts = 0;
+static uint64_t num_interrupts_when_masked = 0;
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_sleep_mask_interrupts()
+{
+    // the threads standing in for the interrupts can't be held off, only noted, which is all waiting needs
+    pthread_mutex_lock(&interrupt_lock);
+    num_interrupts_when_masked = num_interrupts;
+    pthread_mutex_unlock(&interrupt_lock);
+}
+
+void hal_sleep_wait_for_interrupt()
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += MAX_WAIT_IN_NANOSECS;
+    if (deadline.tv_nsec >= NANOSECS_PER_SEC)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= NANOSECS_PER_SEC;
+    }
+
+    pthread_mutex_lock(&interrupt_lock);
+    while (num_interrupts == num_interrupts_when_masked)
+    {
+        if (pthread_cond_timedwait(&interrupt_signalled, &interrupt_lock, &deadline) != 0)
+        {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&interrupt_lock);
+}
+
+void hal_sleep_unmask_interrupts()
+{
+}
+
+void hal_sleep_host_signal_interrupt()
+{
+    pthread_mutex_lock(&interrupt_lock);
+    num_interrupts += 1;
+    pthread_cond_broadcast(&interrupt_signalled);
+    pthread_mutex_unlock(&interrupt_lock);
+}
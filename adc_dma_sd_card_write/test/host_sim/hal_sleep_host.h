@@ -0,0 +1,20 @@
+/**
+ * @file      hal_sleep_host.h
+ * @brief     Host-only controls for the simulated sleep back-end are represented here.
+ * @details   The simulated back-end implements `hal_sleep.h` with a condition variable. The threads that stand in for
+ *            the interrupts of the MAX32666 signal it each time their handler has run, which wakes a main loop waiting
+ *            for an interrupt, or keeps it from waiting at all if the signal came after it masked interrupts.
+ */
+
+#ifndef HAL_SLEEP_HOST_H_
+#define HAL_SLEEP_HOST_H_
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_sleep_host_signal_interrupt()` wakes the main loop if it waits for an interrupt, it is called by the host
+ * back-ends each time the handler of a simulated interrupt has run.
+ */
+void hal_sleep_host_signal_interrupt();
+
+#endif /* HAL_SLEEP_HOST_H_ */
@@ -0,0 +1,100 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_soft_irq.h"
+#include "hal_sleep_host.h"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdbool.h>
+#include <stddef.h> // for NULL
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the handler runs on its own thread, which stands in for the PendSV exception on the MAX32666
+static Hal_Soft_IRQ_Handler_t soft_irq_handler = NULL;
+static pthread_t handler_thread;
+static volatile bool handler_thread_running = false;
+
+// held while the handler runs, so a new handler never starts while the old one is part way through
+static pthread_mutex_t handler_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// posted once for each pend, it is never destroyed so a late pend is harmless
+static sem_t pend_requested;
+static bool pend_requested_initialized = false;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `handler_thread_func(a)` runs the handler each time the software interrupt is pended, until the handler is
+ * cleared.
+ */
+static void *handler_thread_func(void *arg);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_soft_irq_set_handler(Hal_Soft_IRQ_Handler_t handler)
+{
+    if (!pend_requested_initialized)
+    {
+        sem_init(&pend_requested, 0, 0);
+        pend_requested_initialized = true;
+    }
+
+    pthread_mutex_lock(&handler_lock);
+    soft_irq_handler = handler;
+    pthread_mutex_unlock(&handler_lock);
+
+    if (handler != NULL && !handler_thread_running)
+    {
+        handler_thread_running = true;
+        if (pthread_create(&handler_thread, NULL, handler_thread_func, NULL) != 0)
+        {
+            handler_thread_running = false;
+        }
+    }
+    else if (handler == NULL && handler_thread_running)
+    {
+        // wake the thread so it sees the handler is gone
+        handler_thread_running = false;
+        sem_post(&pend_requested);
+        pthread_join(handler_thread, NULL);
+    }
+}
+
+void hal_soft_irq_pend()
+{
+    if (handler_thread_running)
+    {
+        sem_post(&pend_requested);
+    }
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void *handler_thread_func(void *arg)
+{
+    (void)arg;
+
+    while (true)
+    {
+        sem_wait(&pend_requested);
+
+        if (!handler_thread_running)
+        {
+            break;
+        }
+
+        pthread_mutex_lock(&handler_lock);
+        if (soft_irq_handler != NULL)
+        {
+            soft_irq_handler();
+        }
+        pthread_mutex_unlock(&handler_lock);
+
+        // the handler may have posted to a task, as returning from PendSV would, wake the main loop to run it
+        hal_sleep_host_signal_interrupt();
+    }
+
+    return NULL;
+}
@@ -0,0 +1,68 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_spi.h"
+#include "hal_spi_host.h"
+
+#include <stddef.h> // for NULL
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static Hal_SPI_Host_Device_t attached_devices[HAL_SPI_NUM_BUSES];
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_spi_host_attach(Hal_SPI_Bus_t bus, Hal_SPI_Host_Device_t device)
+{
+    attached_devices[bus] = device;
+}
+
+Hal_SPI_Error_t hal_spi_master_init(Hal_SPI_Bus_t bus, uint32_t clk_freq_hz, Hal_SPI_Mode_t mode, Hal_SPI_Width_t width)
+{
+    (void)clk_freq_hz;
+    (void)mode;
+    (void)width;
+    return bus < HAL_SPI_NUM_BUSES ? HAL_SPI_ERROR_ALL_OK : HAL_SPI_ERROR_CONFIG_ERROR;
+}
+
+Hal_SPI_Error_t hal_spi_master_transaction(Hal_SPI_Bus_t bus, const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len)
+{
+    const Hal_SPI_Host_Device_t device = attached_devices[bus];
+
+    if (device == NULL || !device(tx_buff, tx_len, rx_buff, rx_len))
+    {
+        return HAL_SPI_ERROR_TRANSACTION_ERROR;
+    }
+
+    return HAL_SPI_ERROR_ALL_OK;
+}
+
+Hal_SPI_Error_t hal_spi_slave_init(Hal_SPI_Bus_t bus, Hal_SPI_Mode_t mode, Hal_SPI_Width_t width)
+{
+    (void)mode;
+    (void)width;
+    return bus < HAL_SPI_NUM_BUSES ? HAL_SPI_ERROR_ALL_OK : HAL_SPI_ERROR_CONFIG_ERROR;
+}
+
+void hal_spi_shutdown(Hal_SPI_Bus_t bus)
+{
+    (void)bus;
+}
+
+void hal_spi_set_enabled(Hal_SPI_Bus_t bus, bool enabled)
+{
+    (void)bus;
+    (void)enabled;
+}
+
+void hal_spi_clear_rx_fifo(Hal_SPI_Bus_t bus)
+{
+    (void)bus;
+}
+
+Hal_SPI_Error_t hal_spi_enable_rx_dma(Hal_SPI_Bus_t bus, uint32_t threshold_in_bytes)
+{
+    (void)bus;
+    (void)threshold_in_bytes;
+    return HAL_SPI_ERROR_ALL_OK;
+}
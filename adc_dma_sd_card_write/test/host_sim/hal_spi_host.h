@@ -0,0 +1,35 @@
+/**
+ * @file      hal_spi_host.h
+ * @brief     Host-only controls for the simulated SPI back-end are represented here.
+ * @details   The simulated back-end implements `hal_spi.h` by handing each master transaction to the device model
+ *            attached to the bus, a transaction on a bus with nothing attached fails. Slave buses only feed the
+ *            simulated DMA stream, which makes up its own bytes (see `hal_dma_host.h`), so setting up a slave bus always
+ *            succeeds and does nothing else.
+ */
+
+#ifndef HAL_SPI_HOST_H_
+#define HAL_SPI_HOST_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal_spi.h"
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A device model on an SPI bus is represented here, it takes one master transaction and is true if the device
+ * answered it.
+ */
+typedef bool (*Hal_SPI_Host_Device_t)(const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len);
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_spi_host_attach(b, d)` hands every following master transaction on bus `b` to device model `d`.
+ */
+void hal_spi_host_attach(Hal_SPI_Bus_t bus, Hal_SPI_Host_Device_t device);
+
+#endif /* HAL_SPI_HOST_H_ */
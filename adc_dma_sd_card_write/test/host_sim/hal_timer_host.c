@@ -0,0 +1,175 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_timer.h"
+#include "hal_timer_host.h"
+#include "hal_sleep_host.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h> // for NULL
+#include <time.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define NANOSECS_PER_SEC (1000000000L)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static double clock_speed = 1.0;
+
+// the tick runs on its own thread, which stands in for the interrupt of TMR1 on the MAX32666
+static Hal_Timer_Tick_Callback_t tick_callback = NULL;
+static uint32_t tick_period_microsecs;
+static pthread_t tick_thread;
+static volatile bool tick_thread_running = false;
+
+// while the ticks are held off the thread counts the periods instead of calling the callback, and only wakes the main
+// loop when the last one is up, the lock keeps the count and the callback in step with `hal_timer_resume_tick()`
+static pthread_mutex_t suppress_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t num_suppressed_periods = 0;
+static uint32_t num_periods_passed = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `sleep_microsecs(n)` sleeps for `n` microseconds of host time.
+ */
+static void sleep_microsecs(double microsecs);
+
+/**
+ * @brief `tick_thread_func(a)` calls the tick callback once per period on the simulated clock, until the tick is
+ * stopped.
+ */
+static void *tick_thread_func(void *arg);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_timer_host_set_speed(double speed)
+{
+    clock_speed = speed;
+}
+
+double hal_timer_host_get_speed()
+{
+    return clock_speed;
+}
+
+void hal_timer_delay_microsecs(uint32_t microsecs)
+{
+    // in lockstep the DMA waits for the consumer anyway, so there's nothing to gain from waiting
+    if (clock_speed <= 0.0)
+    {
+        return;
+    }
+
+    sleep_microsecs(microsecs / clock_speed);
+}
+
+Hal_Timer_Error_t hal_timer_start_tick(uint32_t period_microsecs, Hal_Timer_Tick_Callback_t callback)
+{
+    hal_timer_stop_tick();
+
+    tick_callback = callback;
+    tick_period_microsecs = period_microsecs;
+
+    tick_thread_running = true;
+    if (pthread_create(&tick_thread, NULL, tick_thread_func, NULL) != 0)
+    {
+        tick_thread_running = false;
+        return HAL_TIMER_ERROR_TIMER_ERROR;
+    }
+
+    return HAL_TIMER_ERROR_ALL_OK;
+}
+
+void hal_timer_stop_tick()
+{
+    if (tick_thread_running)
+    {
+        tick_thread_running = false;
+        pthread_join(tick_thread, NULL);
+    }
+
+    num_suppressed_periods = 0;
+}
+
+void hal_timer_suppress_tick(uint32_t max_microsecs)
+{
+    const uint32_t num_periods = max_microsecs / tick_period_microsecs;
+    if (num_periods <= 1)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&suppress_lock);
+    num_suppressed_periods = num_periods;
+    num_periods_passed = 0;
+    pthread_mutex_unlock(&suppress_lock);
+}
+
+void hal_timer_resume_tick()
+{
+    pthread_mutex_lock(&suppress_lock);
+
+    if (num_suppressed_periods > 0)
+    {
+        num_suppressed_periods = 0;
+        if (num_periods_passed > 0)
+        {
+            tick_callback(num_periods_passed);
+        }
+    }
+
+    pthread_mutex_unlock(&suppress_lock);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void sleep_microsecs(double microsecs)
+{
+    const uint64_t nanosecs = (uint64_t)(microsecs * 1000.0);
+    const struct timespec duration = {
+        .tv_sec = (time_t)(nanosecs / NANOSECS_PER_SEC),
+        .tv_nsec = (long)(nanosecs % NANOSECS_PER_SEC),
+    };
+    nanosleep(&duration, NULL);
+}
+
+void *tick_thread_func(void *arg)
+{
+    (void)arg;
+
+    while (tick_thread_running)
+    {
+        // in lockstep there is no simulated clock to follow, so the tick keeps to real time
+        sleep_microsecs(clock_speed <= 0.0 ? tick_period_microsecs : tick_period_microsecs / clock_speed);
+
+        if (!tick_thread_running)
+        {
+            break;
+        }
+
+        pthread_mutex_lock(&suppress_lock);
+
+        bool wakes = true;
+        if (num_suppressed_periods == 0)
+        {
+            tick_callback(1);
+        }
+        else
+        {
+            num_periods_passed += 1;
+            wakes = num_periods_passed == num_suppressed_periods;
+        }
+
+        pthread_mutex_unlock(&suppress_lock);
+
+        if (wakes)
+        {
+            hal_sleep_host_signal_interrupt();
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file      hal_timer_host.h
+ * @brief     Host-only controls for the simulated timer back-end are represented here.
+ * @details   The simulated back-end implements `hal_timer.h` with sleeps on the host clock, and the periodic tick with
+ *            a thread that sleeps between ticks. While the ticks are held off the thread keeps counting the periods,
+ *            but only wakes the main loop when the last one is up, like the longer compare count of TMR1. The simulated DMA stream (see `hal_dma_host.h`) runs on the same
+ *            clock, so a delay eats up the same number of DMA blocks at any pace.
+ */
+
+#ifndef HAL_TIMER_HOST_H_
+#define HAL_TIMER_HOST_H_
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_timer_host_set_speed(x)` sets the pace of the simulated clock to `x` times real time.
+ *
+ * @pre the DMA stream is stopped.
+ *
+ * @param speed the pace as a multiple of real time, e.g. 1.0 is real time and 10.0 is ten times faster. A speed of 0.0
+ * runs the DMA stream in lockstep with the consumer: a new block is produced as soon as the previous one is consumed, so
+ * runs are as fast as the consumer and can never overrun, which is useful for bit-exact regression tests. Delays return
+ * at once in lockstep, there is nothing to gain from waiting, and the tick keeps to real time.
+ *
+ * @post the next time the DMA stream is started it produces blocks at the given pace, and delays and ticks are scaled
+ * to match.
+ */
+void hal_timer_host_set_speed(double speed);
+
+/**
+ * @brief `hal_timer_host_get_speed()` is the pace of the simulated clock, see `hal_timer_host_set_speed()`.
+ */
+double hal_timer_host_get_speed();
+
+#endif /* HAL_TIMER_HOST_H_ */
@@ -0,0 +1,46 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_uart.h"
+#include "hal_uart_host.h"
+
+#include <stdbool.h>
+#include <stddef.h> // for NULL
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static Hal_UART_Host_Device_t attached_devices[HAL_UART_NUM_UARTS];
+
+static bool uart_initialized[HAL_UART_NUM_UARTS];
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_uart_host_attach(Hal_UART_t uart, Hal_UART_Host_Device_t device)
+{
+    attached_devices[uart] = device;
+}
+
+Hal_UART_Error_t hal_uart_init(Hal_UART_t uart, uint32_t baud_rate, Hal_GPIO_Voltage_t voltage)
+{
+    (void)baud_rate;
+    (void)voltage;
+
+    if (uart >= HAL_UART_NUM_UARTS)
+    {
+        return HAL_UART_ERROR_CONFIG_ERROR;
+    }
+
+    uart_initialized[uart] = true;
+
+    return HAL_UART_ERROR_ALL_OK;
+}
+
+uint32_t hal_uart_read(Hal_UART_t uart, uint8_t *rx_buff, uint32_t max_len)
+{
+    if (uart >= HAL_UART_NUM_UARTS || !uart_initialized[uart] || attached_devices[uart] == NULL)
+    {
+        return 0;
+    }
+
+    return attached_devices[uart](rx_buff, max_len);
+}
@@ -0,0 +1,33 @@
+/**
+ * @file      hal_uart_host.h
+ * @brief     Host-only controls for the simulated UART back-end are represented here.
+ * @details   The simulated back-end implements `hal_uart.h` by asking the device model attached to the UART for the
+ *            bytes it has sent. Reads from a UART with nothing attached, or one that hasn't been initialized, find
+ *            nothing, like a UART with nothing plugged in.
+ */
+
+#ifndef HAL_UART_HOST_H_
+#define HAL_UART_HOST_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include "hal_uart.h"
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A device model on a UART is represented here, `d(r, n)` moves up to `n` of the bytes it has sent since the last
+ * read into `r`, and is the number moved.
+ */
+typedef uint32_t (*Hal_UART_Host_Device_t)(uint8_t *rx_buff, uint32_t max_len);
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_uart_host_attach(u, d)` hands every following read of UART `u` to device model `d`.
+ */
+void hal_uart_host_attach(Hal_UART_t uart, Hal_UART_Host_Device_t device);
+
+#endif /* HAL_UART_HOST_H_ */
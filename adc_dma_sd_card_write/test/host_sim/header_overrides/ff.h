@@ -0,0 +1,17 @@
+/**
+ * This file is a header override for the FatFS ff.h, the POSIX SD card back-end only needs the file mode flags that
+ * sd_card.h builds its file modes from. Add more here if necessary.
+ */
+
+#ifndef FF_HEADER_OVERRIDE_H__
+#define FF_HEADER_OVERRIDE_H__
+
+#define FA_READ 0x01
+#define FA_WRITE 0x02
+#define FA_OPEN_EXISTING 0x00
+#define FA_CREATE_NEW 0x04
+#define FA_CREATE_ALWAYS 0x08
+#define FA_OPEN_ALWAYS 0x10
+#define FA_OPEN_APPEND 0x30
+
+#endif
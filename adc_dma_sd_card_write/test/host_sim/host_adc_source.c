@@ -0,0 +1,184 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "host_adc_source.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define ADC_SAMPLE_RATE (384000.0)
+
+#define I24_MAX (8388607)
+
+/* Private enumerations ----------------------------------------------------------------------------------------------*/
+
+typedef enum
+{
+    SOURCE_SINE,
+    SOURCE_WAV_FILE,
+} Source_t;
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static Source_t source = SOURCE_SINE;
+
+static double sine_phase = 0.0;
+static double sine_phase_increment = (2.0 * M_PI * 1000.0) / ADC_SAMPLE_RATE;
+static double sine_amplitude = 0.5;
+
+// the samples of the WAVE file, stored as right-justified 24 bit integers
+static int32_t *wav_samps = NULL;
+static uint32_t wav_num_samps = 0;
+static uint32_t wav_read_idx = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `read_u16(b)` and `read_u32(b)` are the little-endian integers starting at `b`
+ */
+static uint16_t read_u16(const uint8_t *b);
+static uint32_t read_u32(const uint8_t *b);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void host_adc_source_use_sine(double freq_hz, double amplitude)
+{
+    source = SOURCE_SINE;
+    sine_phase = 0.0;
+    sine_phase_increment = (2.0 * M_PI * freq_hz) / ADC_SAMPLE_RATE;
+    sine_amplitude = amplitude;
+}
+
+bool host_adc_source_use_wav_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    const long file_len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t *file = malloc(file_len);
+    const bool read_ok = file != NULL && fread(file, 1, file_len, f) == (size_t)file_len;
+    fclose(f);
+
+    if (!read_ok || file_len < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0)
+    {
+        free(file);
+        return false;
+    }
+
+    uint16_t num_channels = 0;
+    uint16_t bits_per_sample = 0;
+    uint32_t sample_rate = 0;
+    const uint8_t *data = NULL;
+    uint32_t data_len = 0;
+
+    // walk the chunks, we only care about "fmt " and "data"
+    for (long pos = 12; pos + 8 <= file_len;)
+    {
+        const uint8_t *chunk = file + pos;
+        const uint32_t chunk_len = read_u32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && chunk_len >= 16)
+        {
+            num_channels = read_u16(chunk + 10);
+            sample_rate = read_u32(chunk + 12);
+            bits_per_sample = read_u16(chunk + 22);
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            data = chunk + 8;
+            data_len = chunk_len <= file_len - pos - 8 ? chunk_len : file_len - pos - 8;
+        }
+
+        pos += 8 + chunk_len + (chunk_len & 1); // chunks are padded to an even length
+    }
+
+    const uint32_t bytes_per_samp = bits_per_sample / 8;
+    const uint32_t bytes_per_frame = bytes_per_samp * num_channels;
+
+    if (data == NULL || num_channels == 0 || (bytes_per_samp != 2 && bytes_per_samp != 3 && bytes_per_samp != 4) ||
+        data_len < bytes_per_frame)
+    {
+        free(file);
+        return false;
+    }
+
+    if (sample_rate != (uint32_t)ADC_SAMPLE_RATE)
+    {
+        fprintf(stderr, "note: %s is %u Hz, it will be played back at 384kHz\n", path, sample_rate);
+    }
+
+    free(wav_samps);
+    wav_num_samps = data_len / bytes_per_frame;
+    wav_samps = malloc(wav_num_samps * sizeof(int32_t));
+    wav_read_idx = 0;
+
+    for (uint32_t i = 0; i < wav_num_samps; i++)
+    {
+        const uint8_t *s = data + (i * bytes_per_frame);
+
+        // sign-extend into the top of a 32 bit word, then keep the top 24 bits
+        int32_t samp = 0;
+        for (uint32_t b = 0; b < bytes_per_samp; b++)
+        {
+            samp |= (int32_t)s[b] << (8 * (b + 4 - bytes_per_samp));
+        }
+        wav_samps[i] = samp >> 8;
+    }
+
+    free(file);
+    source = SOURCE_WAV_FILE;
+
+    return true;
+}
+
+void host_adc_source_rewind()
+{
+    sine_phase = 0.0;
+    wav_read_idx = 0;
+}
+
+void host_adc_source_fill(uint8_t *dest, uint32_t num_samps)
+{
+    for (uint32_t i = 0; i < num_samps; i++)
+    {
+        int32_t samp;
+
+        if (source == SOURCE_WAV_FILE)
+        {
+            samp = wav_samps[wav_read_idx];
+            wav_read_idx = (wav_read_idx + 1 == wav_num_samps) ? 0 : wav_read_idx + 1;
+        }
+        else
+        {
+            samp = (int32_t)lround(sin(sine_phase) * sine_amplitude * I24_MAX);
+            sine_phase = fmod(sine_phase + sine_phase_increment, 2.0 * M_PI);
+        }
+
+        // the AD4630 sends the most significant byte first
+        *dest++ = (uint8_t)(samp >> 16);
+        *dest++ = (uint8_t)(samp >> 8);
+        *dest++ = (uint8_t)(samp);
+    }
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+uint16_t read_u16(const uint8_t *b)
+{
+    return (uint16_t)(b[0] | (b[1] << 8));
+}
+
+uint32_t read_u32(const uint8_t *b)
+{
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
@@ -0,0 +1,57 @@
+/**
+ * @file      host_adc_source.h
+ * @brief     A software interface for the simulated ADC signal used by the host audio DMA back-end is represented here.
+ * @details   The simulated ADC produces 384kHz samples in the same packed big-endian 24 bit format that the AD4630
+ *            delivers over SPI, either from a sine generator or by looping over the samples of a WAVE file.
+ */
+
+#ifndef HOST_ADC_SOURCE_H_
+#define HOST_ADC_SOURCE_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `host_adc_source_use_sine(f, a)` makes the simulated ADC produce a sine wave of `f` Hertz with amplitude `a`.
+ *
+ * @param freq_hz the frequency of the sine wave, should be below 192kHz to avoid aliasing.
+ *
+ * @param amplitude the amplitude of the sine wave as a fraction of full scale, in [0.0, 1.0].
+ *
+ * @post future calls to `host_adc_source_fill()` produce the sine wave, starting at phase zero.
+ */
+void host_adc_source_use_sine(double freq_hz, double amplitude);
+
+/**
+ * @brief `host_adc_source_use_wav_file(p)` makes the simulated ADC loop over the samples in the PCM WAVE file at `p`.
+ * Only the first channel is used. The samples are played back at 384kHz whatever the sample rate of the file is.
+ *
+ * @param path the path to a 16, 24, or 32 bit PCM WAVE file.
+ *
+ * @post if the file could be read, future calls to `host_adc_source_fill()` play back its samples from the start.
+ *
+ * @retval true if the file was loaded, else false and the previous source is kept.
+ */
+bool host_adc_source_use_wav_file(const char *path);
+
+/**
+ * @brief `host_adc_source_rewind()` moves the source back to its first sample, so every recording sees the same samples
+ * no matter how many blocks the simulated DMA produced past the end of the previous recording.
+ */
+void host_adc_source_rewind();
+
+/**
+ * @brief `host_adc_source_fill(d, n)` stores the next `n` samples of the simulated ADC into `d` as packed big-endian
+ * 24 bit samples.
+ *
+ * @param dest the buffer to fill, must be at least `3 * n` bytes long.
+ *
+ * @param num_samps the number of samples to produce.
+ */
+void host_adc_source_fill(uint8_t *dest, uint32_t num_samps);
+
+#endif /* HOST_ADC_SOURCE_H_ */
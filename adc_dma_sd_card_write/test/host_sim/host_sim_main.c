@@ -0,0 +1,729 @@
+/**
+ * Runs the firmware recording loop `write_demo_wav_file()` on a host PC, with the real drivers on the host back-ends of
+ * the HAL and models of the ADC, the real time clock, and the SD card bank, and the SD card replaced by a host
+ * directory. Every sample rate and bit depth enabled in demo_config.h is recorded, and the time taken and the DMA ring
+ * statistics are printed for each file.
+ *
+ * Each file is exactly `--secs` seconds of samples at its own sample rate long, or `--samples` samples, wherever its
+ * last sample falls in a DMA block.
+ *
+ * With `--files` each combination is recorded as that many back to back files with `wav_recorder_record_continuous()`
+ * instead, into a directory of its own since the files are named after the time they start.
+ *
+ * With `--plan` nothing is recorded, instead the DMA ring depth each combination needs to ride out the SD card latency
+ * model is worked out with the ring depth planner, to hold up against the `AUDIO_DMA_RING_DEPTH_IN_BLOCKS` the firmware
+ * always runs at.
+ *
+ * With `--power-cut` the process ends abruptly part way through the recording, as if the power was cut, and `--recover`
+ * then runs the boot-time recovery over the files it left behind instead of recording.
+ *
+ * With `--bank` the recording goes onto the simulated SD card bank instead, six directories in the output directory
+ * standing in for cards of the given size, filled in turn by the storage manager.
+ *
+ * With `--write-unit` the writes are gathered into units of that many bytes instead of the size set in demo_config.h,
+ * the number of writes that reach the card and the time the latency model gave them show what coalescing saves.
+ *
+ * With `DEMO_CONFIG_SLEEP_WHEN_IDLE` the main loop waits for the next simulated interrupt whenever the scheduler has
+ * nothing to run, as the core sleeps on the board, and `awake` is the share of the wall time it was busy, which leaves
+ * out the block ready callback on its thread of its own. `wake/blk` is the number of times it waited per DMA block, the
+ * tick is held off while it waits until the next timer of the scheduler is due.
+ *
+ * With `DEMO_CONFIG_WRITE_TRACE_LOG` the trace of every recording goes into the trace file in the output directory, just
+ * like on the SD card, with timestamps in microseconds of host time.
+ *
+ * usage: host_sim [--out <dir>] [--secs <n> | --samples <n>] [--files <n>] [--speed <x>] [--sine <Hz> | --wav <file>]
+ *                 [--sd-latency <model>] [--ring-depth <n>] [--plan [--block-cpu-us <n>]] [--power-cut <n> | --recover]
+ *                 [--bank <MiB>] [--write-unit <bytes>]
+ */
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "ad4630.h"
+#include "ad4630_model.h"
+#include "audio_dma.h"
+#include "audio_dma_ring.h"
+#include "cycle_counter.h"
+#include "date_dirs.h"
+#include "demo_config.h"
+#include "duty_cycle.h"
+#include "gain_control.h"
+#include "ds3231_model.h"
+#include "gnss_model.h"
+#include "hal_dma_host.h"
+#include "hal_i2c.h"
+#include "hal_timer.h"
+#include "hal_timer_host.h"
+#include "host_adc_source.h"
+#include "max14662_model.h"
+#include "max7312_model.h"
+#include "real_time_clock.h"
+#include "ring_depth_planner.h"
+#include "rtc_sync.h"
+#include "scheduler.h"
+#include "sd_card.h"
+#include "sd_card_bank_ctl.h"
+#include "sd_card_posix.h"
+#include "sd_latency_model.h"
+#include "storage_manager.h"
+#include "trace_log.h"
+#include "wav_recorder.h"
+#include "wav_writer.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the 3.3V I2C bus the real time clock and the SD card bank are on, the same as in main.c
+#define I2C_3V3 (HAL_I2C_BUS_1)
+
+// the 1.8V I2C bus the AFE gain switches are on
+#define I2C_1V8 (HAL_I2C_BUS_0)
+
+// the timers of the scheduler count ticks of this period, the same as in main.c
+#define SCHEDULER_TICK_PERIOD_IN_MICROSECS (1000)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// if not 0 this ring depth is used no matter what depth the recorder asks for
+static uint32_t forced_ring_depth = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `__wrap_audio_dma_set_ring_depth(d)` stands in for `audio_dma_set_ring_depth(d)` everywhere, the Makefile
+ * links with `--wrap`, so `--ring-depth` can make the ring any depth whatever depth the recorder asks for.
+ */
+Audio_DMA_Error_t __wrap_audio_dma_set_ring_depth(uint32_t depth_in_blocks);
+Audio_DMA_Error_t __real_audio_dma_set_ring_depth(uint32_t depth_in_blocks);
+
+/**
+ * @brief `__wrap_real_time_clock_get_milliseconds(ms)` stands in for the milliseconds of the MAX32666 RTC, which the
+ * firmware doesn't read yet, with the milliseconds of the host clock the DS3231 model counts seconds on. Without it
+ * every recording waits for the seconds to tick over.
+ */
+Real_Time_Clock_Error_t __wrap_real_time_clock_get_milliseconds(int *out_msec);
+
+/**
+ * @brief `consumer_caught_up()` is true if the recorder has taken every DMA block so far, a lockstep stream waits for
+ * this before filling the next block.
+ */
+static bool consumer_caught_up();
+
+/**
+ * @brief `elapsed_secs(t0)` is the number of seconds since time `t0` on the monotonic clock.
+ */
+static double elapsed_secs(const struct timespec *t0);
+
+/**
+ * @brief `bytes_written_per_block(a)` is the number of bytes each DMA block turns into on the SD card for a recording
+ * with attributes `a`, the same as in `wav_recorder.c`.
+ */
+static uint32_t bytes_written_per_block(const Wave_Header_Attributes_t *wav_attr);
+
+/**
+ * @brief `plan_ring_depths(m, s, c)` prints the ring depth every enabled combination needs for `s` second files with
+ * SD card latency model `m` and `c` microseconds of processing per block, and is the exit code.
+ */
+static int plan_ring_depths(SD_Latency_Model_t *model, uint32_t file_len_secs, uint32_t processing_microsecs);
+
+/**
+ * @brief `recover_files()` repairs the files a power cut left unfinished at the root of the SD card and in the directory
+ * of each combination, and in the latest day directory of each, prints how many were repaired, and is the exit code.
+ */
+static int recover_files();
+
+/**
+ * @brief `recover_dir(p, n)` repairs the files a power cut left unfinished in directory `p` and in its latest day
+ * directory, adds the number repaired to `n`, and is true if every file could be checked.
+ */
+static bool recover_dir(const char *path, uint32_t *total_repaired);
+
+/**
+ * @brief `mount_card_bank(d, c)` mounts the first card with room of the simulated SD card bank in directory `d`, with
+ * cards of `c` bytes, making the six slot directories first if there are none, and is true if a card was mounted.
+ * Delete some of the slot directories to leave those slots empty.
+ */
+static bool mount_card_bank(const char *dir, uint64_t capacity_in_bytes);
+
+/**
+ * @brief `change_dir(p)` changes into directory `p` on the SD card, making it first if needed, and is true on success.
+ * With the SD card bank every card switched to gets the directory too.
+ */
+static bool change_dir(const char *path);
+
+static void print_usage(const char *prog_name);
+
+/**
+ * @brief `on_tick(n)` moves the clock of the scheduler on by `n` ticks, it runs on the tick thread, or from the
+ * idle hook after the ticks were held off while the core slept.
+ */
+static void on_tick(uint32_t num_periods);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    const char *out_dir = "./out";
+    uint32_t file_len_secs = DEMO_CONFIG_AUDIO_FILE_LEN_IN_SECONDS;
+    uint64_t file_len_in_samples = 0;
+    uint32_t num_files = 0;
+    double speed = 1.0;
+    bool plan = false;
+    bool recover = false;
+    uint32_t processing_microsecs = 0;
+    uint32_t bank_capacity_in_mib = 0;
+    uint32_t write_unit_len = DEMO_CONFIG_SD_CARD_WRITE_UNIT_IN_BYTES;
+    SD_Latency_Model_t sd_latency;
+
+    sd_latency_model_parse("none", &sd_latency);
+
+    host_adc_source_use_sine(1000.0, 0.5);
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_val = i + 1 < argc;
+
+        if (strcmp(argv[i], "--out") == 0 && has_val)
+        {
+            out_dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--secs") == 0 && has_val)
+        {
+            file_len_secs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--samples") == 0 && has_val)
+        {
+            file_len_in_samples = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--files") == 0 && has_val)
+        {
+            num_files = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--speed") == 0 && has_val)
+        {
+            speed = strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--sine") == 0 && has_val)
+        {
+            host_adc_source_use_sine(strtod(argv[++i], NULL), 0.5);
+        }
+        else if (strcmp(argv[i], "--wav") == 0 && has_val)
+        {
+            const char *path = argv[++i];
+            if (!host_adc_source_use_wav_file(path))
+            {
+                fprintf(stderr, "could not load %s as a PCM WAVE file\n", path);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--sd-latency") == 0 && has_val)
+        {
+            const char *model = argv[++i];
+            sd_latency_model_free(&sd_latency);
+            if (!sd_latency_model_parse(model, &sd_latency))
+            {
+                fprintf(stderr, "could not parse SD card latency model %s\n", model);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--ring-depth") == 0 && has_val)
+        {
+            const uint32_t depth = (uint32_t)strtoul(argv[++i], NULL, 10);
+            if (depth < 2 || AUDIO_DMA_RING_DEPTH_IN_BLOCKS < depth)
+            {
+                fprintf(stderr, "the ring depth must be in [2, %u]\n", AUDIO_DMA_RING_DEPTH_IN_BLOCKS);
+                return EXIT_FAILURE;
+            }
+            forced_ring_depth = depth;
+        }
+        else if (strcmp(argv[i], "--plan") == 0)
+        {
+            plan = true;
+        }
+        else if (strcmp(argv[i], "--block-cpu-us") == 0 && has_val)
+        {
+            processing_microsecs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--power-cut") == 0 && has_val)
+        {
+            sd_card_posix_cut_power_after((uint32_t)strtoul(argv[++i], NULL, 10));
+        }
+        else if (strcmp(argv[i], "--recover") == 0)
+        {
+            recover = true;
+        }
+        else if (strcmp(argv[i], "--bank") == 0 && has_val)
+        {
+            bank_capacity_in_mib = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--write-unit") == 0 && has_val)
+        {
+            write_unit_len = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (plan)
+    {
+        const int exit_code = plan_ring_depths(&sd_latency, file_len_secs, processing_microsecs);
+        sd_latency_model_free(&sd_latency);
+        return exit_code;
+    }
+
+    hal_timer_host_set_speed(speed);
+    hal_dma_host_set_lockstep_gate(consumer_caught_up);
+    sd_card_posix_set_root_dir(out_dir);
+    sd_card_set_write_unit(write_unit_len);
+
+    // the SD card runs on the same sped up clock as the DMA, so the slack in the DMA ring means the same thing
+    const double sd_latency_scale = speed > 0.0 ? 1.0 / speed : 1.0;
+
+    // the real drivers talk to models of the devices on the board through the simulated HAL
+    ad4630_model_attach();
+    ds3231_model_attach(I2C_3V3);
+    max7312_model_attach(I2C_3V3, out_dir);
+    max14662_model_attach(I2C_1V8);
+    gnss_model_attach();
+
+    if (ad4630_init() != AD4630_ERROR_ALL_OK || !ad4630_model_is_configured() || audio_dma_init() != AUDIO_DMA_ERROR_ALL_OK)
+    {
+        fprintf(stderr, "could not initialize the simulated ADC/DMA\n");
+        return EXIT_FAILURE;
+    }
+
+    if (hal_i2c_init(I2C_3V3, HAL_I2C_SPEED_STANDARD) != HAL_I2C_ERROR_ALL_OK || real_time_clock_init(I2C_3V3) != REAL_TIME_CLOCK_ERROR_ALL_OK)
+    {
+        fprintf(stderr, "could not initialize the simulated real time clock\n");
+        return EXIT_FAILURE;
+    }
+
+    // the recordings run as tasks of the scheduler, which the blocking recorder functions run until each one ends
+    if (wav_recorder_init() != WAV_RECORDER_ERROR_ALL_OK)
+    {
+        fprintf(stderr, "could not add the recorder tasks to the scheduler\n");
+        return EXIT_FAILURE;
+    }
+
+    if (bank_capacity_in_mib > 0)
+    {
+        if (!mount_card_bank(out_dir, (uint64_t)bank_capacity_in_mib * 1024 * 1024))
+        {
+            fprintf(stderr, "could not mount a card with room in the slot directories of %s\n", out_dir);
+            return EXIT_FAILURE;
+        }
+    }
+    else if (sd_card_init() != SD_CARD_ERROR_ALL_OK || sd_card_mount() != SD_CARD_ERROR_ALL_OK)
+    {
+        fprintf(stderr, "could not mount %s as the SD card, does the directory exist?\n", out_dir);
+        return EXIT_FAILURE;
+    }
+
+    if (recover)
+    {
+        const int exit_code = recover_files();
+        sd_card_unmount();
+        sd_latency_model_free(&sd_latency);
+        return exit_code;
+    }
+
+    // the gain and RTC sync tasks run in between the blocks, just like on the board, on the ticks of the scheduler
+#if DEMO_CONFIG_CONTROL_AFE_GAIN == 1
+    if (hal_i2c_init(I2C_1V8, HAL_I2C_SPEED_STANDARD) != HAL_I2C_ERROR_ALL_OK ||
+        gain_control_init(I2C_1V8, DEMO_CONFIG_AFE_GAIN, DEMO_CONFIG_AFE_GAIN_CHECK_PERIOD_IN_SECONDS) != GAIN_CONTROL_ERROR_ALL_OK)
+    {
+        fprintf(stderr, "could not start the gain task\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+#if DEMO_CONFIG_SYNC_RTC_TO_GNSS == 1
+    if (rtc_sync_init(DEMO_CONFIG_GNSS_SYNC_TIMEOUT_IN_SECONDS, DEMO_CONFIG_GNSS_RESYNC_PERIOD_IN_SECONDS) != RTC_SYNC_ERROR_ALL_OK)
+    {
+        fprintf(stderr, "could not start the RTC sync task\n");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    if (hal_timer_start_tick(SCHEDULER_TICK_PERIOD_IN_MICROSECS, on_tick) != HAL_TIMER_ERROR_ALL_OK)
+    {
+        fprintf(stderr, "could not start the scheduler tick\n");
+        return EXIT_FAILURE;
+    }
+
+    cycle_counter_init();
+
+#if DEMO_CONFIG_SLEEP_WHEN_IDLE == 1
+    // the main loop waits for the threads standing in for the interrupts instead of spinning, as the core sleeps
+    scheduler_set_idle_hook(duty_cycle_sleep_while_idle);
+#endif
+
+#if DEMO_CONFIG_WRITE_TRACE_LOG == 1
+    trace_log_start(DEMO_CONFIG_TRACE_LOG_FILE_NAME);
+#endif
+
+    Wave_Header_Attributes_t wav_attr = {
+        .num_channels = WAVE_HEADER_MONO,
+    };
+
+    char file_len_desc[32];
+    if (file_len_in_samples > 0)
+    {
+        snprintf(file_len_desc, sizeof(file_len_desc), "%llu sample", (unsigned long long)file_len_in_samples);
+    }
+    else
+    {
+        snprintf(file_len_desc, sizeof(file_len_desc), "%u second", file_len_secs);
+    }
+
+    if (num_files > 0)
+    {
+        printf("recording %u back to back %s files at %.1fx real time%s\n", num_files, file_len_desc, speed, speed <= 0.0 ? " (lockstep)" : "");
+    }
+    else
+    {
+        printf("recording %s files at %.1fx real time%s\n", file_len_desc, speed, speed <= 0.0 ? " (lockstep)" : "");
+    }
+    printf("%-12s %8s %8s %6s %6s %9s %8s %8s %8s %8s %7s %8s\n", "file", "secs", "x_rt", "depth", "peak", "overruns", "stalls", "drain_ms", "card_wr", "busy_s", "awake", "wake/blk");
+
+    int exit_code = EXIT_SUCCESS;
+
+    for (uint32_t sr = 0; sr < DEMO_CONFIG_NUM_SAMPLE_RATES_TO_TEST; sr++)
+    {
+        for (uint32_t bd = 0; bd < DEMO_CONFIG_NUM_BIT_DEPTHS_TO_TEST; bd++)
+        {
+            wav_attr.sample_rate = demo_sample_rates_to_test[sr];
+            wav_attr.bits_per_sample = demo_bit_depths_to_test[bd];
+
+            // each file sees the same write times as the planner would give it
+            sd_card_posix_set_write_latency(&sd_latency, sd_latency_scale);
+
+            char name[16];
+            snprintf(name, sizeof(name), "%uk-%ubit", wav_attr.sample_rate / 1000, wav_attr.bits_per_sample);
+
+            // the time based file names of one combination would clash with the next one's in a fast run
+            if (num_files > 0)
+            {
+                if (!change_dir(name))
+                {
+                    fprintf(stderr, "could not make a directory for %s\n", name);
+                    return EXIT_FAILURE;
+                }
+            }
+
+            struct timespec t0;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+
+            const uint64_t len_in_samples = file_len_in_samples > 0 ? file_len_in_samples : wav_recorder_secs_to_samples(&wav_attr, file_len_secs);
+
+            const Wav_Recorder_Error_t err = num_files > 0
+                                                 ? wav_recorder_record_continuous(&wav_attr, len_in_samples, num_files)
+                                                 : write_demo_wav_file(&wav_attr, len_in_samples);
+
+            const double secs = elapsed_secs(&t0);
+            const Audio_DMA_Ring_Stats_t *stats = audio_dma_get_stats();
+            const double audio_secs = (stats->num_blocks_consumed * (double)AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS) / 1e6;
+
+            uint32_t num_card_writes;
+            uint64_t card_write_microsecs;
+            sd_card_posix_get_write_stats(&num_card_writes, &card_write_microsecs);
+
+            printf("%-12s %8.3f %8.1f %6u %6u %9u %8u %8.1f %8u %8.2f %6.1f%% %8.2f%s\n",
+                   name,
+                   secs,
+                   secs > 0.0 ? audio_secs / secs : 0.0,
+                   stats->depth_in_blocks,
+                   stats->peak_occupancy_in_blocks,
+                   stats->num_overruns,
+                   stats->num_stalls,
+                   (stats->max_drain_time_in_blocks * (double)AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS) / 1000.0,
+                   num_card_writes,
+                   card_write_microsecs / 1e6,
+                   secs > 0.0 ? (100.0 * duty_cycle_awake_microsecs()) / (secs * 1e6) : 0.0,
+                   stats->num_blocks_consumed > 0 ? (double)duty_cycle_num_sleeps() / stats->num_blocks_consumed : 0.0,
+                   err == WAV_RECORDER_ERROR_ALL_OK               ? ""
+                   : err == WAV_RECORDER_ERROR_SD_CARD_ERROR      ? "  SD card error"
+                   : err == WAV_RECORDER_ERROR_INVALID_ARG_ERROR ? "  invalid file length"
+                                                                  : "  DMA overrun");
+
+            if (err != WAV_RECORDER_ERROR_ALL_OK)
+            {
+                // the firmware halts here, we close the partial file and carry on so one run reports every combination
+                sd_card_fclose();
+                exit_code = EXIT_FAILURE;
+            }
+
+            if (num_files > 0)
+            {
+                change_dir("/");
+            }
+        }
+    }
+
+    if (storage_manager_is_enabled())
+    {
+        printf("the recordings filled the card bank up to slot_%u\n", sd_card_bank_ctl_get_active_slot());
+
+        // nothing is written during a switch, so it has to fit in the audio the DMA ring holds
+        printf("the longest card switch took %ums, the DMA ring holds %ums of audio\n", storage_manager_get_max_switch_millisecs(),
+               ((forced_ring_depth != 0 ? forced_ring_depth : AUDIO_DMA_RING_DEPTH_IN_BLOCKS) * AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS) / 1000);
+    }
+
+    if (trace_log_num_dropped() > 0)
+    {
+        printf("%u records were dropped from the trace log\n", trace_log_num_dropped());
+    }
+
+#if DEMO_CONFIG_CONTROL_AFE_GAIN == 1
+    printf("the AFE gain switch read back as 0x%02x, %u times it had to be set again\n", gain_control_get_gain(), gain_control_num_errors());
+#endif
+
+#if DEMO_CONFIG_SYNC_RTC_TO_GNSS == 1
+    printf("the RTC was synced to GNSS time %u times, %u syncs failed\n", rtc_sync_num_syncs(), rtc_sync_num_failures());
+#endif
+
+    hal_timer_stop_tick();
+    sd_card_unmount();
+    sd_card_posix_set_write_latency(NULL, 1.0);
+    sd_latency_model_free(&sd_latency);
+
+    return exit_code;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+double elapsed_secs(const struct timespec *t0)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec - t0->tv_sec) + ((now.tv_nsec - t0->tv_nsec) / 1e9);
+}
+
+uint32_t bytes_written_per_block(const Wave_Header_Attributes_t *wav_attr)
+{
+    // in bits so 4 bit IMA ADPCM comes out right too, give or take its block headers
+    const uint32_t decimation_factor = WAVE_HEADER_SAMPLE_RATE_384kHz / wav_attr->sample_rate;
+    return ((AUDIO_DMA_BUFF_LEN_IN_SAMPS / decimation_factor) * wav_attr->bits_per_sample) / 8;
+}
+
+int plan_ring_depths(SD_Latency_Model_t *model, uint32_t file_len_secs, uint32_t processing_microsecs)
+{
+    const uint32_t num_blocks = (uint32_t)(((uint64_t)file_len_secs * 1000000) / AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS);
+
+    printf("planning the DMA ring for %u second files with %uus of processing per block\n", file_len_secs, processing_microsecs);
+    printf("%-12s %8s %8s %8s %6s %9s %8s\n", "file", "bytes", "mean_ms", "max_ms", "peak", "min_depth", "min_KiB");
+
+    int exit_code = EXIT_SUCCESS;
+
+    for (uint32_t sr = 0; sr < DEMO_CONFIG_NUM_SAMPLE_RATES_TO_TEST; sr++)
+    {
+        for (uint32_t bd = 0; bd < DEMO_CONFIG_NUM_BIT_DEPTHS_TO_TEST; bd++)
+        {
+            const Wave_Header_Attributes_t wav_attr = {
+                .sample_rate = demo_sample_rates_to_test[sr],
+                .bits_per_sample = demo_bit_depths_to_test[bd],
+            };
+
+            const uint32_t bytes_per_block = bytes_written_per_block(&wav_attr);
+
+            Ring_Depth_Plan_t result;
+            if (!ring_depth_planner_run(model, bytes_per_block, processing_microsecs, num_blocks, &result))
+            {
+                fprintf(stderr, "not enough memory to plan %u blocks\n", num_blocks);
+                return EXIT_FAILURE;
+            }
+
+            char name[16];
+            snprintf(name, sizeof(name), "%uk-%ubit", wav_attr.sample_rate / 1000, wav_attr.bits_per_sample);
+
+            const char *verdict = "";
+            if (result.min_depth_in_blocks == 0)
+            {
+                verdict = "  the card can't keep up";
+            }
+            else if (result.min_depth_in_blocks > AUDIO_DMA_RING_DEPTH_IN_BLOCKS)
+            {
+                verdict = "  deeper than the firmware's ring";
+            }
+
+            printf("%-12s %8u %8.2f %8.2f %6u %9u %8u%s\n",
+                   name,
+                   bytes_per_block,
+                   num_blocks == 0 ? 0.0 : (result.total_write_microsecs / (double)num_blocks) / 1000.0,
+                   result.max_write_microsecs / 1000.0,
+                   result.peak_occupancy_in_blocks,
+                   result.min_depth_in_blocks,
+                   (result.min_depth_in_blocks * AUDIO_DMA_BUFF_LEN_IN_BYTES) / 1024,
+                   verdict);
+
+            if (verdict[0] != '\0')
+            {
+                exit_code = EXIT_FAILURE;
+            }
+        }
+    }
+
+    return exit_code;
+}
+
+int recover_files()
+{
+    uint32_t total_repaired = 0;
+
+    if (!recover_dir("/", &total_repaired))
+    {
+        fprintf(stderr, "could not check every file at the root\n");
+        return EXIT_FAILURE;
+    }
+
+    // the directories --files records into, skipping the ones that don't exist
+    for (uint32_t sr = 0; sr < DEMO_CONFIG_NUM_SAMPLE_RATES_TO_TEST; sr++)
+    {
+        for (uint32_t bd = 0; bd < DEMO_CONFIG_NUM_BIT_DEPTHS_TO_TEST; bd++)
+        {
+            char name[16];
+            snprintf(name, sizeof(name), "/%uk-%ubit", demo_sample_rates_to_test[sr] / 1000, demo_bit_depths_to_test[bd]);
+
+            if (sd_card_cd(name) != SD_CARD_ERROR_ALL_OK)
+            {
+                continue;
+            }
+            sd_card_cd("/");
+
+            if (!recover_dir(name, &total_repaired))
+            {
+                fprintf(stderr, "could not check every file in %s\n", name);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    printf("repaired %u file%s\n", total_repaired, total_repaired == 1 ? "" : "s");
+
+    return EXIT_SUCCESS;
+}
+
+bool recover_dir(const char *path, uint32_t *total_repaired)
+{
+    uint32_t num_repaired;
+
+    if (wav_writer_recover_dir(path, &num_repaired) != WAV_WRITER_ERROR_ALL_OK)
+    {
+        return false;
+    }
+    *total_repaired += num_repaired;
+
+    // like the firmware at boot, only the latest day can have a file the power was cut in
+    char day_dir_path[64];
+    if (date_dirs_find_latest(path, day_dir_path))
+    {
+        if (wav_writer_recover_dir(day_dir_path, &num_repaired) != WAV_WRITER_ERROR_ALL_OK)
+        {
+            return false;
+        }
+        *total_repaired += num_repaired;
+    }
+
+    return true;
+}
+
+Audio_DMA_Error_t __wrap_audio_dma_set_ring_depth(uint32_t depth_in_blocks)
+{
+    return __real_audio_dma_set_ring_depth(forced_ring_depth != 0 ? forced_ring_depth : depth_in_blocks);
+}
+
+Real_Time_Clock_Error_t __wrap_real_time_clock_get_milliseconds(int *out_msec)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    *out_msec = (int)(now.tv_usec / 1000);
+
+    return REAL_TIME_CLOCK_ERROR_ALL_OK;
+}
+
+bool consumer_caught_up()
+{
+    return audio_dma_num_buffers_available() == 0;
+}
+
+bool mount_card_bank(const char *dir, uint64_t capacity_in_bytes)
+{
+    sd_card_posix_set_capacity(capacity_in_bytes);
+
+    if (sd_card_bank_ctl_init(I2C_3V3) != SD_CARD_BANK_CTL_ERROR_ALL_OK ||
+        sd_card_bank_ctl_read_and_cache_detect_pins() != SD_CARD_BANK_CTL_ERROR_ALL_OK)
+    {
+        return false;
+    }
+
+    bool any_slot_dirs = false;
+    for (uint32_t slot = 0; slot < SD_CARD_BANK_CTL_NUM_CARDS; slot++)
+    {
+        any_slot_dirs = any_slot_dirs || sd_card_bank_ctl_slot_is_inserted(slot);
+    }
+
+    for (uint32_t slot = 0; slot < SD_CARD_BANK_CTL_NUM_CARDS && !any_slot_dirs; slot++)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/slot_%u", dir, slot);
+        mkdir(path, 0777);
+    }
+
+    return storage_manager_init() == STORAGE_MANAGER_ERROR_ALL_OK;
+}
+
+bool change_dir(const char *path)
+{
+    if (storage_manager_is_enabled())
+    {
+        return storage_manager_cd(path) == STORAGE_MANAGER_ERROR_ALL_OK;
+    }
+
+    // the directory may already be there from an earlier run
+    if (strcmp(path, "/") != 0)
+    {
+        sd_card_mkdir(path);
+    }
+
+    return sd_card_cd(path) == SD_CARD_ERROR_ALL_OK;
+}
+
+void print_usage(const char *prog_name)
+{
+    fprintf(stderr, "usage: %s [--out <dir>] [--secs <n> | --samples <n>] [--files <n>] [--speed <x>] [--sine <Hz> | --wav <file>]\n", prog_name);
+    fprintf(stderr, "                [--sd-latency <model>] [--ring-depth <n>] [--plan [--block-cpu-us <n>]] [--power-cut <n> | --recover]\n");
+    fprintf(stderr, "                [--bank <MiB>] [--write-unit <bytes>]\n");
+    fprintf(stderr, "  --out    directory standing in for the SD card root (default ./out)\n");
+    fprintf(stderr, "  --secs   length of each file in seconds (default from demo_config.h)\n");
+    fprintf(stderr, "  --samples  length of each file in samples at its own sample rate, instead of --secs\n");
+    fprintf(stderr, "  --files  record this many back to back files per combination without stopping the DMA\n");
+    fprintf(stderr, "  --speed  pace of the simulated DMA as a multiple of real time, 0 for lockstep (default 1)\n");
+    fprintf(stderr, "  --sine   record a sine wave of the given frequency (default 1000Hz)\n");
+    fprintf(stderr, "  --wav    record by looping over the samples of a PCM WAVE file\n");
+    fprintf(stderr, "  --sd-latency  simulated SD card write latency, none (default), typical, longtail,\n");
+    fprintf(stderr, "                <overhead_us>:<bytes_per_ms>:<stall_us>:<stall_period_in_writes>,\n");
+    fprintf(stderr, "                longtail:<overhead_us>:<bytes_per_ms>:<min_stall_us>:<max_stall_us>:<one_in_n>,\n");
+    fprintf(stderr, "                or csv:<block_write_times_microsec.csv>[:<row>]\n");
+    fprintf(stderr, "  --ring-depth  use this DMA ring depth instead of the firmware's\n");
+    fprintf(stderr, "  --plan   don't record, print the DMA ring depth each file needs with the SD card latency model\n");
+    fprintf(stderr, "  --block-cpu-us  with --plan, the time to process one DMA block on the target (default 0)\n");
+    fprintf(stderr, "  --power-cut  end the process without closing anything after this many SD card writes\n");
+    fprintf(stderr, "  --recover    don't record, repair the files a power cut left unfinished\n");
+    fprintf(stderr, "  --bank   record onto a bank of cards of this many MiB, the slot_0 to slot_5 directories of --out\n");
+    fprintf(stderr, "  --write-unit  gather writes into units of this many bytes, 0 for none (default from demo_config.h)\n");
+}
+
+void on_tick(uint32_t num_periods)
+{
+    scheduler_tick(num_periods * (SCHEDULER_TICK_PERIOD_IN_MICROSECS / 1000));
+}
@@ -0,0 +1,133 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_gpio_host.h"
+#include "hal_i2c_host.h"
+#include "max14662_model.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the wiring on the board, see afe_control.h
+#define CH0_7_BIT_I2C_ADDR (0x4Fu)
+#define CH1_7_BIT_I2C_ADDR (0x4Eu)
+#define CH0_ENABLE_MASK (HAL_GPIO_PIN(11))
+#define CH1_ENABLE_MASK (HAL_GPIO_PIN(12))
+
+#define NUM_CHANNELS (2u)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// every switch is open at power up
+static uint8_t switches[NUM_CHANNELS];
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+static bool ch0_write(const uint8_t *tx_buff, uint32_t tx_len);
+
+static bool ch0_read(uint8_t *rx_buff, uint32_t rx_len);
+
+static bool ch1_write(const uint8_t *tx_buff, uint32_t tx_len);
+
+static bool ch1_read(uint8_t *rx_buff, uint32_t rx_len);
+
+/**
+ * @brief `max14662_write(c, t, n)` handles a write of `n` bytes `t` to the switch of channel `c`, and is false if the
+ * switch doesn't acknowledge it.
+ */
+static bool max14662_write(uint32_t channel, const uint8_t *tx_buff, uint32_t tx_len);
+
+/**
+ * @brief `max14662_read(c, r, n)` handles a read of `n` bytes into `r` from the switch of channel `c`, and is false if
+ * the switch doesn't acknowledge it.
+ */
+static bool max14662_read(uint32_t channel, uint8_t *rx_buff, uint32_t rx_len);
+
+/**
+ * @brief `is_powered(c)` is true if the enable pin of channel `c` is high. A switch that is powered down loses its
+ * settings.
+ */
+static bool is_powered(uint32_t channel);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void max14662_model_attach(Hal_I2C_Bus_t bus)
+{
+    static const Hal_I2C_Host_Device_t ch0_device = {
+        .write = ch0_write,
+        .read = ch0_read,
+    };
+    static const Hal_I2C_Host_Device_t ch1_device = {
+        .write = ch1_write,
+        .read = ch1_read,
+    };
+
+    hal_i2c_host_attach(bus, CH0_7_BIT_I2C_ADDR, &ch0_device);
+    hal_i2c_host_attach(bus, CH1_7_BIT_I2C_ADDR, &ch1_device);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool ch0_write(const uint8_t *tx_buff, uint32_t tx_len)
+{
+    return max14662_write(0, tx_buff, tx_len);
+}
+
+bool ch0_read(uint8_t *rx_buff, uint32_t rx_len)
+{
+    return max14662_read(0, rx_buff, rx_len);
+}
+
+bool ch1_write(const uint8_t *tx_buff, uint32_t tx_len)
+{
+    return max14662_write(1, tx_buff, tx_len);
+}
+
+bool ch1_read(uint8_t *rx_buff, uint32_t rx_len)
+{
+    return max14662_read(1, rx_buff, rx_len);
+}
+
+bool max14662_write(uint32_t channel, const uint8_t *tx_buff, uint32_t tx_len)
+{
+    if (!is_powered(channel))
+    {
+        return false;
+    }
+
+    // the first byte is a dummy register address, the switches take the last byte written
+    if (tx_len >= 2)
+    {
+        switches[channel] = tx_buff[tx_len - 1];
+    }
+
+    return true;
+}
+
+bool max14662_read(uint32_t channel, uint8_t *rx_buff, uint32_t rx_len)
+{
+    if (!is_powered(channel))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < rx_len; i++)
+    {
+        rx_buff[i] = switches[channel];
+    }
+
+    return true;
+}
+
+bool is_powered(uint32_t channel)
+{
+    const bool powered = hal_gpio_host_output_level(HAL_GPIO_PORT_0, channel == 0 ? CH0_ENABLE_MASK : CH1_ENABLE_MASK);
+    if (!powered)
+    {
+        switches[channel] = 0u;
+    }
+
+    return powered;
+}
@@ -0,0 +1,25 @@
+/**
+ * @file      max14662_model.h
+ * @brief     A model of the two MAX14662 switches that set the AFE gains, for the host simulator, is represented here.
+ * @details   The models sit on the simulated I2C bus, so the real `afe_control.c` drives them just like on the board.
+ *            Each switch is powered by the enable pin of its AFE channel, and only answers while its channel is
+ *            enabled. A write of a dummy byte and the switch settings sets the switches, and a read returns them.
+ */
+
+#ifndef MAX14662_MODEL_H_
+#define MAX14662_MODEL_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include "hal_i2c.h"
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `max14662_model_attach(b)` puts the switches of both AFE channels on simulated I2C bus `b`.
+ *
+ * @post `afe_control_init(b)` talks to the models.
+ */
+void max14662_model_attach(Hal_I2C_Bus_t bus);
+
+#endif /* MAX14662_MODEL_H_ */
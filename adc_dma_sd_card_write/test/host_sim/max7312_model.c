@@ -0,0 +1,163 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_i2c_host.h"
+#include "max7312_model.h"
+#include "sd_card_bank_ctl.h"
+#include "sd_card_posix.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// A0..A2 are tied low on the PCB
+#define MAX7312_7_BIT_I2C_ADDR (0x20u)
+
+#define REG_INPUT_PORT_0 (0x00u)
+#define REG_INPUT_PORT_1 (0x01u)
+#define REG_OUTPUT_PORT_0 (0x02u)
+#define REG_OUTPUT_PORT_1 (0x03u)
+#define REG_POLARITY_INV_1 (0x05u)
+#define REG_TIMEOUT (0x08u)
+#define NUM_REGS (REG_TIMEOUT + 1u)
+
+// the wiring on the board, see sd_card_bank_ctl.c. Port 0 has the mux enable in bit 0, the mux channel in bits 1..3,
+// and the enables of cards 0..3 in bits 4..7. Port 1 has the enables of cards 4..5 in bits 0..1, and the detect pins
+// in bits 2..7.
+#define MUX_EN_PORT_0_MASK (1u << 0u)
+#define MUX_CHANNEL_PORT_0_POS (1u)
+#define MUX_CHANNEL_MASK (0x07u)
+#define SD_EN_0_PORT_0_POS (4u)
+#define SD_EN_4_PORT_1_POS (0u)
+#define SD_DETECT_0_PORT_1_POS (2u)
+
+#define PATH_BUFF_LEN (512)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the registers power up with every bit set, the firmware clears the outputs first thing
+static uint8_t regs[NUM_REGS] = {0xffu, 0xffu, 0xffu, 0xffu, 0x00u, 0x00u, 0xffu, 0xffu, 0x01u};
+
+// the register the next byte is read from or written to
+static uint8_t reg_pointer = 0;
+
+// the root directory of each card, they must stay valid while the card is mounted
+static char slot_dirs[SD_CARD_BANK_CTL_NUM_CARDS][PATH_BUFF_LEN];
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+static bool max7312_write(const uint8_t *tx_buff, uint32_t tx_len);
+
+static bool max7312_read(uint8_t *rx_buff, uint32_t rx_len);
+
+/**
+ * @brief `input_port_1_level()` is the level of the port 1 pins as read, after the polarity inversion.
+ */
+static uint8_t input_port_1_level();
+
+/**
+ * @brief `route_card()` points the POSIX SD card back-end at the card the outputs power and route to, if there is one.
+ */
+static void route_card();
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void max7312_model_attach(Hal_I2C_Bus_t bus, const char *path)
+{
+    static const Hal_I2C_Host_Device_t max7312_device = {
+        .write = max7312_write,
+        .read = max7312_read,
+    };
+
+    for (uint32_t slot = 0; slot < SD_CARD_BANK_CTL_NUM_CARDS; slot++)
+    {
+        snprintf(slot_dirs[slot], PATH_BUFF_LEN, "%s/slot_%u", path, slot);
+    }
+
+    hal_i2c_host_attach(bus, MAX7312_7_BIT_I2C_ADDR, &max7312_device);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool max7312_write(const uint8_t *tx_buff, uint32_t tx_len)
+{
+    // the first byte is the command byte, it sets the register pointer
+    if (tx_buff[0] >= NUM_REGS)
+    {
+        return false;
+    }
+
+    reg_pointer = tx_buff[0];
+
+    for (uint32_t i = 1; i < tx_len; i++)
+    {
+        // the input ports are read only
+        if (reg_pointer != REG_INPUT_PORT_0 && reg_pointer != REG_INPUT_PORT_1)
+        {
+            regs[reg_pointer] = tx_buff[i];
+        }
+
+        if (reg_pointer == REG_OUTPUT_PORT_0 || reg_pointer == REG_OUTPUT_PORT_1)
+        {
+            route_card();
+        }
+
+        // the pointer toggles between the two registers of a pair
+        reg_pointer ^= 1u;
+    }
+
+    return true;
+}
+
+bool max7312_read(uint8_t *rx_buff, uint32_t rx_len)
+{
+    for (uint32_t i = 0; i < rx_len; i++)
+    {
+        rx_buff[i] = reg_pointer == REG_INPUT_PORT_1 ? input_port_1_level() : regs[reg_pointer];
+        reg_pointer ^= 1u;
+    }
+
+    return true;
+}
+
+uint8_t input_port_1_level()
+{
+    // the detect pins are pulled up, and shorted to ground when a card is in the slot
+    uint8_t level = 0xffu;
+
+    for (uint32_t slot = 0; slot < SD_CARD_BANK_CTL_NUM_CARDS; slot++)
+    {
+        struct stat st;
+        if (stat(slot_dirs[slot], &st) == 0 && S_ISDIR(st.st_mode))
+        {
+            level &= (uint8_t)~(1u << (slot + SD_DETECT_0_PORT_1_POS));
+        }
+    }
+
+    return level ^ regs[REG_POLARITY_INV_1];
+}
+
+void route_card()
+{
+    const uint8_t port_0 = regs[REG_OUTPUT_PORT_0];
+    const uint8_t port_1 = regs[REG_OUTPUT_PORT_1];
+
+    // one bit per powered slot, slot 0 in the LSB
+    const uint32_t powered_slots = (uint32_t)(port_0 >> SD_EN_0_PORT_0_POS) | ((uint32_t)((port_1 >> SD_EN_4_PORT_1_POS) & 0x03u) << 4u);
+
+    // a card is only usable when it is the only one powered and the mux routes the SD host controller to it
+    if ((port_0 & MUX_EN_PORT_0_MASK) == 0u || powered_slots == 0u || (powered_slots & (powered_slots - 1u)) != 0u)
+    {
+        return;
+    }
+
+    const uint32_t routed_slot = (port_0 >> MUX_CHANNEL_PORT_0_POS) & MUX_CHANNEL_MASK;
+    if (powered_slots == (1u << routed_slot))
+    {
+        // a missing directory fails `sd_card_init()` like an empty slot would
+        sd_card_posix_set_root_dir(slot_dirs[routed_slot]);
+    }
+}
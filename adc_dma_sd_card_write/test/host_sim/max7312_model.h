@@ -0,0 +1,30 @@
+/**
+ * @file      max7312_model.h
+ * @brief     A model of the MAX7312 port expander that runs the SD card bank, for the host simulator, is represented
+ *            here.
+ * @details   The model sits on the simulated I2C bus, so the real `sd_card_bank_ctl.c` drives it just like on the
+ *            board. A host directory per slot, named "slot_0" to "slot_5", stands in for the cards: the detect pin of a
+ *            slot is pulled low iff its directory exists, and when the outputs power exactly one slot with the mux routed
+ *            to it the POSIX SD card back-end is pointed at its directory, so each card is a directory like the single
+ *            SD card is without the bank. Use `sd_card_posix_set_capacity()` to make the cards fill up.
+ */
+
+#ifndef MAX7312_MODEL_H_
+#define MAX7312_MODEL_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include "hal_i2c.h"
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `max7312_model_attach(b, p)` puts the model on simulated I2C bus `b`, with the slot directories in `p`.
+ *
+ * @param path an existing directory on the host.
+ *
+ * @post `sd_card_bank_ctl_init(b)` talks to the model.
+ */
+void max7312_model_attach(Hal_I2C_Bus_t bus, const char *path);
+
+#endif /* MAX7312_MODEL_H_ */
@@ -0,0 +1,92 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "audio_dma.h"
+#include "ring_depth_planner.h"
+#include "write_pipeline.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+bool ring_depth_planner_run(SD_Latency_Model_t *model,
+                            uint32_t bytes_written_per_block,
+                            uint32_t processing_microsecs,
+                            uint32_t num_blocks,
+                            Ring_Depth_Plan_t *plan)
+{
+    memset(plan, 0, sizeof(*plan));
+    plan->num_blocks = num_blocks;
+
+    // the time each block is taken out of the ring, and the time each block's write completes
+    uint64_t *consume_time = malloc(num_blocks * sizeof(uint64_t));
+    uint64_t *write_done_time = malloc(num_blocks * sizeof(uint64_t));
+
+    if (consume_time == NULL || write_done_time == NULL)
+    {
+        free(consume_time);
+        free(write_done_time);
+        return false;
+    }
+
+    sd_latency_model_restart(model);
+
+    uint64_t processing_done = 0;
+    uint64_t prev_write_done = 0;
+
+    for (uint32_t i = 0; i < num_blocks; i++)
+    {
+        // block i is full at the end of its DMA period
+        const uint64_t arrival = (uint64_t)(i + 1) * AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS;
+
+        // it can only be processed once the previous block is done and one of the write pipeline buffers is free
+        uint64_t consume = arrival > processing_done ? arrival : processing_done;
+        if (i >= WRITE_PIPELINE_NUM_BUFFERS && write_done_time[i - WRITE_PIPELINE_NUM_BUFFERS] > consume)
+        {
+            consume = write_done_time[i - WRITE_PIPELINE_NUM_BUFFERS];
+        }
+
+        consume_time[i] = consume;
+        processing_done = consume + processing_microsecs;
+
+        // the writes go out one at a time, in order
+        const uint32_t write_time = sd_latency_model_next_write_time(model, bytes_written_per_block);
+        const uint64_t write_start = processing_done > prev_write_done ? processing_done : prev_write_done;
+
+        write_done_time[i] = write_start + write_time;
+        prev_write_done = write_done_time[i];
+
+        plan->total_write_microsecs += write_time;
+        plan->max_write_microsecs = write_time > plan->max_write_microsecs ? write_time : plan->max_write_microsecs;
+    }
+
+    // when block k arrives, every block up to k is full and the ones taken out before then are gone, see
+    // audio_dma_ring_produce() for the same bookkeeping on the target
+    uint32_t num_consumed = 0;
+
+    for (uint32_t k = 0; k < num_blocks; k++)
+    {
+        const uint64_t arrival = (uint64_t)(k + 1) * AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS;
+
+        while (num_consumed < k && consume_time[num_consumed] < arrival)
+        {
+            num_consumed += 1;
+        }
+
+        const uint32_t occupancy = (k + 1) - num_consumed;
+        plan->peak_occupancy_in_blocks = occupancy > plan->peak_occupancy_in_blocks ? occupancy : plan->peak_occupancy_in_blocks;
+    }
+
+    // if the card is slower than the audio on average the backlog only grows, no ring is deep enough in the long run
+    const uint64_t audio_microsecs = (uint64_t)num_blocks * AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS;
+    const bool keeps_up = (plan->total_write_microsecs <= audio_microsecs) &&
+                          ((uint64_t)processing_microsecs * num_blocks <= audio_microsecs);
+
+    plan->min_depth_in_blocks = keeps_up ? plan->peak_occupancy_in_blocks + 1 : 0;
+
+    free(consume_time);
+    free(write_done_time);
+
+    return true;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file      ring_depth_planner.h
+ * @brief     A planner for the depth of the DMA ring a given SD card needs is represented here.
+ * @details   The planner replays a recording without threads or sleeps: DMA blocks arrive once every
+ *            `AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS`, each one is processed into a free write pipeline buffer, and
+ *            the buffers are written out one at a time with write times drawn from an SD card latency model. The peak
+ *            number of full blocks waiting in the ring gives the shallowest ring that would never overrun.
+ *
+ *            Because nothing depends on the host's scheduler the answer is the same on every run, and a whole day of
+ *            recording can be planned in a fraction of a second.
+ */
+
+#ifndef RING_DEPTH_PLANNER_H_
+#define RING_DEPTH_PLANNER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sd_latency_model.h"
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The result of planning one recording is represented here.
+ */
+typedef struct
+{
+    uint32_t num_blocks;               /** the number of DMA blocks in the recording */
+    uint32_t peak_occupancy_in_blocks; /** the most full blocks waiting in the ring when a new block arrived */
+    uint32_t min_depth_in_blocks;      /** the shallowest ring with zero overruns, one more than the peak occupancy */
+    uint32_t max_write_microsecs;      /** the slowest write */
+    uint64_t total_write_microsecs;    /** the sum of all write times, divide by `num_blocks` for the mean */
+} Ring_Depth_Plan_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `ring_depth_planner_run(m, w, c, n, p)` plans a recording of `n` DMA blocks which each turn into `w` bytes
+ * written to an SD card with latency model `m`, and take `c` microseconds of processing, and stores the result in `p`.
+ *
+ * @param model the SD card latency model, restarted before use so the plan matches a live run from the same model.
+ *
+ * @param bytes_written_per_block the number of bytes written to the SD card for each DMA block.
+ *
+ * @param processing_microsecs the time it takes to process one DMA block into a write pipeline buffer.
+ *
+ * @param num_blocks the length of the recording in DMA blocks.
+ *
+ * @param plan the result, `min_depth_in_blocks` is 0 if the card can't keep up on average and no finite ring is enough.
+ *
+ * @retval true if the plan was made, false if there wasn't enough memory.
+ */
+bool ring_depth_planner_run(SD_Latency_Model_t *model,
+                            uint32_t bytes_written_per_block,
+                            uint32_t processing_microsecs,
+                            uint32_t num_blocks,
+                            Ring_Depth_Plan_t *plan);
+
+#endif /* RING_DEPTH_PLANNER_H_ */
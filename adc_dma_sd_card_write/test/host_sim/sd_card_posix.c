@@ -0,0 +1,511 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "sd_card.h"
+#include "sd_card_posix.h"
+#include "write_coalescer.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define PATH_BUFF_LEN (512)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static const char *root_dir = ".";
+
+// the current directory relative to the root, always ends in a '/'
+static char current_dir[PATH_BUFF_LEN] = "/";
+
+static FILE *SD_file = NULL;
+static FILE *log_file = NULL;
+static DIR *SD_dir = NULL;
+static bool is_mounted;
+
+// the size of the card, or 0 for the host file system, with the bytes used by files and the length of the open file
+static uint64_t capacity = 0;
+static uint64_t used_bytes;
+static uint64_t open_file_len;
+
+// the number of writes left before the power is cut, 0 for never
+static uint32_t num_writes_until_power_cut = 0;
+
+static SD_Latency_Model_t *write_latency = NULL;
+static double write_latency_scale = 1.0;
+
+// the host file system has no clusters, so writes are gathered into units of the longest length allowed
+static uint32_t write_unit_len = 0;
+
+// the writes that reached the host file, and the time the latency model gave them before scaling
+static uint32_t num_card_writes = 0;
+static uint64_t card_write_microsecs = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `host_path(p, b)` stores the host path of SD card path `p` into buffer `b` of length `PATH_BUFF_LEN`.
+ * Absolute SD card paths are relative to the root dir, relative paths are relative to the current directory.
+ */
+static void host_path(const char *path, char *buff);
+
+/**
+ * @brief `dir_size(p)` is the total size of the files in host directory `p` and its subdirectories.
+ */
+static uint64_t dir_size(const char *path);
+
+/**
+ * @brief `sleep_for_write_latency(n)` sleeps for as long as the latency model says a write of `n` bytes takes, scaled
+ * by the time scale.
+ */
+static void sleep_for_write_latency(uint32_t size);
+
+/**
+ * @brief `write_to_file(b, l)` writes `l` bytes of `b` to the open file at its position, unless the card would overflow,
+ * sleeps for the write latency, and is true iff they were all written. This is the write function of the write
+ * coalescer.
+ */
+static bool write_to_file(const uint8_t *buff, uint32_t len);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void sd_card_posix_set_root_dir(const char *path)
+{
+    root_dir = path;
+}
+
+void sd_card_posix_set_capacity(uint64_t capacity_in_bytes)
+{
+    capacity = capacity_in_bytes;
+}
+
+void sd_card_posix_set_write_latency(SD_Latency_Model_t *model, double time_scale)
+{
+    write_latency = model;
+    write_latency_scale = time_scale;
+
+    if (model != NULL)
+    {
+        sd_latency_model_restart(model);
+    }
+
+    num_card_writes = 0;
+    card_write_microsecs = 0;
+}
+
+void sd_card_posix_get_write_stats(uint32_t *num_writes, uint64_t *total_microsecs)
+{
+    *num_writes = num_card_writes;
+    *total_microsecs = card_write_microsecs;
+}
+
+void sd_card_posix_cut_power_after(uint32_t num_writes)
+{
+    num_writes_until_power_cut = num_writes;
+}
+
+SD_Card_Error_t sd_card_init()
+{
+    struct stat st;
+    return (stat(root_dir, &st) == 0 && S_ISDIR(st.st_mode)) ? SD_CARD_ERROR_ALL_OK : SD_CARD_NOT_INSERTED_ERROR;
+}
+
+SD_Card_Error_t sd_card_mount()
+{
+    strcpy(current_dir, "/");
+
+    used_bytes = capacity > 0 ? dir_size(root_dir) : 0;
+
+    is_mounted = true;
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_mount_with_free_space(uint64_t free_space_in_bytes)
+{
+    strcpy(current_dir, "/");
+
+    // trust the count like the firmware does, so a wrong one shows up in the files that fit
+    used_bytes = capacity > free_space_in_bytes ? capacity - free_space_in_bytes : 0;
+
+    is_mounted = true;
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_unmount()
+{
+    sd_card_fclose();
+    sd_card_log_close();
+    is_mounted = false;
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+bool sd_card_is_mounted()
+{
+    return is_mounted;
+}
+
+uint64_t sd_card_disk_size_bytes()
+{
+    if (capacity > 0)
+    {
+        return sd_card_is_mounted() ? capacity : 0;
+    }
+
+    struct statvfs vfs;
+    if (!sd_card_is_mounted() || statvfs(root_dir, &vfs) != 0)
+    {
+        return 0;
+    }
+
+    return (uint64_t)vfs.f_blocks * vfs.f_frsize;
+}
+
+void sd_card_set_write_unit(uint32_t max_len_in_bytes)
+{
+    write_unit_len = max_len_in_bytes;
+}
+
+uint64_t sd_card_free_space_bytes()
+{
+    if (capacity > 0)
+    {
+        return sd_card_is_mounted() ? capacity - used_bytes : 0;
+    }
+
+    struct statvfs vfs;
+    if (!sd_card_is_mounted() || statvfs(root_dir, &vfs) != 0)
+    {
+        return 0;
+    }
+
+    return (uint64_t)vfs.f_bavail * vfs.f_frsize;
+}
+
+SD_Card_Error_t sd_card_mkdir(const char *path)
+{
+    char buff[PATH_BUFF_LEN];
+    host_path(path, buff);
+
+    return mkdir(buff, 0777) == 0 ? SD_CARD_ERROR_ALL_OK : SD_CARD_DIRECTORY_ERROR;
+}
+
+SD_Card_Error_t sd_card_cd(const char *path)
+{
+    char buff[PATH_BUFF_LEN];
+    host_path(path, buff);
+
+    struct stat st;
+    if (stat(buff, &st) != 0 || !S_ISDIR(st.st_mode))
+    {
+        return SD_CARD_DIRECTORY_ERROR;
+    }
+
+    // keep the new current directory relative to the root
+    const size_t root_len = strlen(root_dir);
+    snprintf(current_dir, sizeof(current_dir), "%s/", buff + root_len);
+
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_fopen(const char *file_name, POSIX_FileMode_t mode)
+{
+    char buff[PATH_BUFF_LEN];
+    host_path(file_name, buff);
+
+    const char *host_mode = mode == POSIX_FILE_MODE_READ         ? "rb"
+                            : mode == POSIX_FILE_MODE_APPEND     ? "ab"
+                            : mode == POSIX_FILE_MODE_READ_WRITE ? "r+b"
+                                                                 : "wb";
+
+    // a file that is created over an old one gives back the old one's space
+    struct stat st;
+    const bool existed = stat(buff, &st) == 0;
+    if (existed && (mode == POSIX_FILE_MODE_WRITE))
+    {
+        used_bytes -= (uint64_t)st.st_size;
+    }
+
+    SD_file = fopen(buff, host_mode);
+    open_file_len = (existed && mode != POSIX_FILE_MODE_WRITE) ? (uint64_t)st.st_size : 0;
+
+    if (SD_file == NULL)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    write_coalescer_start(write_to_file, write_unit_len, (uint64_t)ftello(SD_file));
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_fpreallocate(uint64_t size)
+{
+    // the host file system allocates space however it sees fit, there's nothing to gain from doing it up front here
+    (void)size;
+    return SD_file != NULL ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_fclose()
+{
+    if (SD_file == NULL)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    const bool is_flushed = write_coalescer_flush();
+    const int res = fclose(SD_file);
+    SD_file = NULL;
+
+    return (res == 0 && is_flushed) ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_fwrite(const void *buff, uint32_t size, uint32_t *written)
+{
+    const bool is_written = write_coalescer_write(buff, size);
+    *written = is_written ? size : 0;
+
+    // like a brown-out, whatever is still in the stdio buffer or the coalescing buffer never reaches the file and
+    // nothing gets closed
+    if (num_writes_until_power_cut > 0 && --num_writes_until_power_cut == 0)
+    {
+        fprintf(stderr, "power cut\n");
+        _exit(SD_CARD_POSIX_POWER_CUT_EXIT_CODE);
+    }
+
+    return is_written ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_lseek(uint64_t offset)
+{
+    if (!write_coalescer_flush() || fseeko(SD_file, (off_t)offset, SEEK_SET) != 0)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    write_coalescer_start(write_to_file, write_unit_len, offset);
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_fsync()
+{
+    return (write_coalescer_flush() && fflush(SD_file) == 0 && fsync(fileno(SD_file)) == 0) ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_fread(void *buff, uint32_t size, uint32_t *read)
+{
+    if (!write_coalescer_flush())
+    {
+        *read = 0;
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    *read = (uint32_t)fread(buff, 1, size, SD_file);
+
+    return ferror(SD_file) == 0 ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_ftruncate(uint64_t size)
+{
+    if (!write_coalescer_flush() || fflush(SD_file) != 0 || ftruncate(fileno(SD_file), (off_t)size) != 0)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    if (size < open_file_len)
+    {
+        used_bytes -= open_file_len - size;
+        open_file_len = size;
+    }
+
+    return fseeko(SD_file, (off_t)size, SEEK_SET) == 0 ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_opendir(const char *path)
+{
+    char buff[PATH_BUFF_LEN];
+    host_path(path, buff);
+
+    SD_dir = opendir(buff);
+
+    return SD_dir != NULL ? SD_CARD_ERROR_ALL_OK : SD_CARD_DIRECTORY_ERROR;
+}
+
+SD_Card_Error_t sd_card_readdir(char *name_buff, uint32_t buff_len, bool *is_dir)
+{
+    // FatFS doesn't list the dot entries
+    const struct dirent *entry;
+    do
+    {
+        entry = readdir(SD_dir);
+    } while (entry != NULL && (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0));
+
+    *is_dir = entry != NULL && entry->d_type == DT_DIR;
+    snprintf(name_buff, buff_len, "%s", entry != NULL ? entry->d_name : "");
+
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_closedir()
+{
+    const int res = closedir(SD_dir);
+    SD_dir = NULL;
+
+    return res == 0 ? SD_CARD_ERROR_ALL_OK : SD_CARD_DIRECTORY_ERROR;
+}
+
+uint64_t sd_card_fsize()
+{
+    fflush(SD_file);
+
+    struct stat st;
+    if (fstat(fileno(SD_file), &st) != 0)
+    {
+        return 0;
+    }
+
+    // like FatFS, seeking past the end of a file being written extends it, and the buffered bytes go at the position
+    const uint64_t pos = (uint64_t)ftello(SD_file) + write_coalescer_num_buffered();
+    return pos > (uint64_t)st.st_size ? pos : (uint64_t)st.st_size;
+}
+
+SD_Card_Error_t sd_card_log_open(const char *file_name)
+{
+    char buff[PATH_BUFF_LEN];
+    host_path(file_name, buff);
+
+    if (log_file != NULL || (log_file = fopen(buff, "ab")) == NULL)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_log_write(const void *buff, uint32_t size)
+{
+    // the log is small next to the audio, so its writes take only as long as the host takes and don't disturb the
+    // latency model
+    if (log_file == NULL || (capacity > 0 && used_bytes + size > capacity))
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    used_bytes += size;
+    return fwrite(buff, 1, size, log_file) == size ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_log_close()
+{
+    if (log_file == NULL)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    const int res = fclose(log_file);
+    log_file = NULL;
+
+    return res == 0 ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+bool sd_card_log_is_open()
+{
+    return log_file != NULL;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void host_path(const char *path, char *buff)
+{
+    if (path[0] == '/')
+    {
+        snprintf(buff, PATH_BUFF_LEN, "%s%s", root_dir, path);
+    }
+    else
+    {
+        snprintf(buff, PATH_BUFF_LEN, "%s%s%s", root_dir, current_dir, path);
+    }
+}
+
+uint64_t dir_size(const char *path)
+{
+    DIR *dir = opendir(path);
+    if (dir == NULL)
+    {
+        return 0;
+    }
+
+    uint64_t size = 0;
+    const struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        {
+            continue;
+        }
+
+        char buff[PATH_BUFF_LEN];
+        snprintf(buff, sizeof(buff), "%s/%s", path, entry->d_name);
+
+        struct stat st;
+        if (stat(buff, &st) != 0)
+        {
+            continue;
+        }
+
+        size += S_ISDIR(st.st_mode) ? dir_size(buff) : (uint64_t)st.st_size;
+    }
+
+    closedir(dir);
+    return size;
+}
+
+void sleep_for_write_latency(uint32_t size)
+{
+    if (write_latency == NULL)
+    {
+        return;
+    }
+
+    const uint32_t model_microsecs = sd_latency_model_next_write_time(write_latency, size);
+    card_write_microsecs += model_microsecs;
+
+    const uint64_t microsecs = (uint64_t)(model_microsecs * write_latency_scale);
+
+    if (microsecs == 0)
+    {
+        return;
+    }
+
+    const struct timespec duration = {
+        .tv_sec = (time_t)(microsecs / 1000000),
+        .tv_nsec = (long)((microsecs % 1000000) * 1000),
+    };
+    nanosleep(&duration, NULL);
+}
+
+bool write_to_file(const uint8_t *buff, uint32_t len)
+{
+    // only the part of a write past the end of the file takes up more space
+    const uint64_t end = (uint64_t)ftello(SD_file) + len;
+    const uint64_t growth = end > open_file_len ? end - open_file_len : 0;
+
+    if (capacity > 0 && used_bytes + growth > capacity)
+    {
+        return false;
+    }
+
+    used_bytes += growth;
+    open_file_len += growth;
+
+    const size_t written = fwrite(buff, 1, len, SD_file);
+
+    num_card_writes += 1;
+    sleep_for_write_latency(len);
+
+    return written == len;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file      sd_card_posix.h
+ * @brief     Host-only controls for the POSIX SD card back-end are represented here.
+ * @details   The POSIX back-end implements `sd_card.h` with plain stdio files inside a directory on the host, which
+ *            stands in for the root of the SD card file system.
+ */
+
+#ifndef SD_CARD_POSIX_H_
+#define SD_CARD_POSIX_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include "sd_latency_model.h"
+
+/* Public defines ----------------------------------------------------------------------------------------------------*/
+
+// the exit code of the process when the power is cut, see `sd_card_posix_cut_power_after()`
+#define SD_CARD_POSIX_POWER_CUT_EXIT_CODE (3)
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `sd_card_posix_set_root_dir(p)` sets the host directory that stands in for the root of the SD card to `p`.
+ *
+ * @pre the card is not mounted.
+ *
+ * @param path an existing directory on the host, the string must stay valid while the card is mounted.
+ *
+ * @post the next time the card is mounted all file paths are relative to `p`.
+ */
+void sd_card_posix_set_root_dir(const char *path);
+
+/**
+ * @brief `sd_card_posix_set_capacity(n)` makes the card hold at most `n` bytes of files, so a long recording can fill
+ * it up. The free space is worked out from the sizes of the files under the root when the card is mounted, and a write
+ * that would go past the capacity fails without writing anything, like on a full card. Directories take no space.
+ *
+ * @pre the card is not mounted.
+ *
+ * @param capacity_in_bytes the size of the card, or 0 for the free space of the host file system (the default)
+ */
+void sd_card_posix_set_capacity(uint64_t capacity_in_bytes);
+
+/**
+ * @brief `sd_card_posix_set_write_latency(m, s)` makes every following write to the host file sleep for the write time
+ * latency model `m` gives, multiplied by `s`, in addition to the time the host takes. By default writes take only as
+ * long as the host takes. With `sd_card_set_write_unit()` the writes to the file are the coalesced ones, several
+ * `sd_card_fwrite()` calls may make up one write, or one call several writes. Writes to the log file only take as
+ * long as the host takes.
+ *
+ * @param model the latency model to use, or NULL to stop adding latency. The model is used in place, it must stay valid
+ * while it is set.
+ *
+ * @param time_scale the write times are multiplied by this, e.g. 0.1 when the simulated DMA runs at 10x real time.
+ *
+ * @post the model is restarted, so a run produces the same write times as `ring_depth_planner_run()` with that model,
+ * and the write statistics are cleared.
+ */
+void sd_card_posix_set_write_latency(SD_Latency_Model_t *model, double time_scale);
+
+/**
+ * @brief `sd_card_posix_get_write_stats(n, t)` stores the number of writes to the host file since the write latency
+ * was last set in `n`, and the total time the latency model gave them in microseconds, before scaling, in `t`.
+ */
+void sd_card_posix_get_write_stats(uint32_t *num_writes, uint64_t *total_microsecs);
+
+/**
+ * @brief `sd_card_posix_cut_power_after(n)` simulates a power cut right after the `n`th following `sd_card_fwrite()`,
+ * by ending the process with `SD_CARD_POSIX_POWER_CUT_EXIT_CODE` without flushing or closing anything. Data still in the
+ * stdio buffer or the coalescing buffer is lost, like data in the FatFS sector buffer or the card's cache would be.
+ *
+ * @param num_writes the number of writes to let through, 0 to never cut the power (the default)
+ */
+void sd_card_posix_cut_power_after(uint32_t num_writes);
+
+#endif /* SD_CARD_POSIX_H_ */
@@ -0,0 +1,260 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "sd_latency_model.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define DEFAULT_SEED (12345)
+
+// the longest line we expect in a csv of write times, a 70 minute file has about 200k blocks
+#define CSV_LINE_BUFF_LEN (2 * 1024 * 1024)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// a card in the middle of the pack, 10MB/s sustained with an 80ms busy period about once a second at 384kHz
+static const SD_Latency_Model_t typical_model = {
+    .kind = SD_LATENCY_MODEL_PERIODIC,
+    .overhead_microsecs = 500,
+    .bytes_per_millisec = 10000,
+    .stall_microsecs = 80000,
+    .stall_period_in_writes = 48,
+    .seed = DEFAULT_SEED,
+};
+
+// the same card, but it stops for garbage collection at random, and for a lot longer
+static const SD_Latency_Model_t long_tail_model = {
+    .kind = SD_LATENCY_MODEL_LONG_TAIL,
+    .overhead_microsecs = 500,
+    .bytes_per_millisec = 10000,
+    .min_gc_stall_microsecs = 100000,
+    .max_gc_stall_microsecs = 250000,
+    .gc_stall_one_in_n = 50,
+    .seed = DEFAULT_SEED,
+};
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `load_csv(p, r, m)` loads the write times in csv file `p` into model `m`, only from the row labelled `r`, or
+ * every row if `r` is NULL, and is true if at least one write time was loaded.
+ */
+static bool load_csv(const char *path, const char *row_label, SD_Latency_Model_t *model);
+
+/**
+ * @brief `next_random(m)` is the next number from model `m`'s random number generator, a 32 bit xorshift.
+ */
+static uint32_t next_random(SD_Latency_Model_t *model);
+
+/**
+ * @brief `transfer_time(m, n)` is the fixed overhead plus the time to move `n` bytes at model `m`'s throughput.
+ */
+static uint32_t transfer_time(const SD_Latency_Model_t *model, uint32_t size);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+bool sd_latency_model_parse(const char *str, SD_Latency_Model_t *model)
+{
+    const SD_Latency_Model_t no_latency = {.kind = SD_LATENCY_MODEL_PERIODIC, .seed = DEFAULT_SEED};
+    *model = no_latency;
+
+    bool is_valid = false;
+
+    if (strcmp(str, "none") == 0)
+    {
+        is_valid = true;
+    }
+    else if (strcmp(str, "typical") == 0)
+    {
+        *model = typical_model;
+        is_valid = true;
+    }
+    else if (strcmp(str, "longtail") == 0)
+    {
+        *model = long_tail_model;
+        is_valid = true;
+    }
+    else if (strncmp(str, "longtail:", strlen("longtail:")) == 0)
+    {
+        *model = long_tail_model;
+        is_valid = sscanf(str + strlen("longtail:"), "%u:%u:%u:%u:%u",
+                          &model->overhead_microsecs,
+                          &model->bytes_per_millisec,
+                          &model->min_gc_stall_microsecs,
+                          &model->max_gc_stall_microsecs,
+                          &model->gc_stall_one_in_n) == 5 &&
+                   model->min_gc_stall_microsecs <= model->max_gc_stall_microsecs;
+    }
+    else if (strncmp(str, "csv:", strlen("csv:")) == 0)
+    {
+        // split off the optional row label after the last ':'
+        char path[512];
+        snprintf(path, sizeof(path), "%s", str + strlen("csv:"));
+
+        char *row_label = strrchr(path, ':');
+        if (row_label != NULL)
+        {
+            *row_label++ = '\0';
+        }
+
+        model->kind = SD_LATENCY_MODEL_MEASURED;
+        is_valid = load_csv(path, row_label, model);
+    }
+    else
+    {
+        is_valid = sscanf(str, "%u:%u:%u:%u",
+                          &model->overhead_microsecs,
+                          &model->bytes_per_millisec,
+                          &model->stall_microsecs,
+                          &model->stall_period_in_writes) == 4;
+    }
+
+    sd_latency_model_restart(model);
+
+    return is_valid;
+}
+
+void sd_latency_model_free(SD_Latency_Model_t *model)
+{
+    free(model->measured_microsecs);
+    model->measured_microsecs = NULL;
+    model->num_measured = 0;
+}
+
+void sd_latency_model_restart(SD_Latency_Model_t *model)
+{
+    model->num_writes_since_stall = 0;
+
+    // xorshift gets stuck at 0
+    model->rng_state = model->seed != 0 ? model->seed : DEFAULT_SEED;
+}
+
+uint32_t sd_latency_model_next_write_time(SD_Latency_Model_t *model, uint32_t size)
+{
+    switch (model->kind)
+    {
+    case SD_LATENCY_MODEL_PERIODIC:
+    {
+        uint32_t microsecs = transfer_time(model, size);
+
+        if (model->stall_period_in_writes != 0)
+        {
+            model->num_writes_since_stall += 1;
+            if (model->num_writes_since_stall == model->stall_period_in_writes)
+            {
+                microsecs += model->stall_microsecs;
+                model->num_writes_since_stall = 0;
+            }
+        }
+
+        return microsecs;
+    }
+    case SD_LATENCY_MODEL_LONG_TAIL:
+    {
+        uint32_t microsecs = transfer_time(model, size);
+
+        if (model->gc_stall_one_in_n != 0 && (next_random(model) % model->gc_stall_one_in_n) == 0)
+        {
+            const uint32_t range = model->max_gc_stall_microsecs - model->min_gc_stall_microsecs + 1;
+            microsecs += model->min_gc_stall_microsecs + (next_random(model) % range);
+        }
+
+        return microsecs;
+    }
+    case SD_LATENCY_MODEL_MEASURED:
+        return model->num_measured == 0 ? 0 : model->measured_microsecs[next_random(model) % model->num_measured];
+    default:
+        return 0;
+    }
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool load_csv(const char *path, const char *row_label, SD_Latency_Model_t *model)
+{
+    FILE *csv = fopen(path, "r");
+    char *line = malloc(CSV_LINE_BUFF_LEN);
+
+    if (csv == NULL || line == NULL)
+    {
+        if (csv != NULL)
+        {
+            fclose(csv);
+        }
+        free(line);
+        return false;
+    }
+
+    uint32_t capacity = 0;
+    bool out_of_memory = false;
+
+    // each row is a label like 384k-24bit followed by one write time per DMA block, with a trailing comma
+    while (!out_of_memory && fgets(line, CSV_LINE_BUFF_LEN, csv) != NULL)
+    {
+        char *cell = strtok(line, ",\r\n");
+
+        if (cell == NULL || (row_label != NULL && strcmp(cell, row_label) != 0))
+        {
+            continue;
+        }
+
+        while ((cell = strtok(NULL, ",\r\n")) != NULL)
+        {
+            char *end;
+            const unsigned long microsecs = strtoul(cell, &end, 10);
+
+            if (end == cell)
+            {
+                continue;
+            }
+
+            if (model->num_measured == capacity)
+            {
+                const uint32_t new_capacity = capacity == 0 ? 4096 : capacity * 2;
+                uint32_t *grown = realloc(model->measured_microsecs, new_capacity * sizeof(uint32_t));
+
+                if (grown == NULL)
+                {
+                    out_of_memory = true;
+                    break;
+                }
+                model->measured_microsecs = grown;
+                capacity = new_capacity;
+            }
+
+            model->measured_microsecs[model->num_measured++] = (uint32_t)microsecs;
+        }
+    }
+
+    fclose(csv);
+    free(line);
+
+    return model->num_measured > 0;
+}
+
+uint32_t next_random(SD_Latency_Model_t *model)
+{
+    uint32_t x = model->rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    model->rng_state = x;
+
+    return x;
+}
+
+uint32_t transfer_time(const SD_Latency_Model_t *model, uint32_t size)
+{
+    uint32_t microsecs = model->overhead_microsecs;
+
+    if (model->bytes_per_millisec != 0)
+    {
+        microsecs += (uint32_t)(((uint64_t)size * 1000) / model->bytes_per_millisec);
+    }
+
+    return microsecs;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file      sd_latency_model.h
+ * @brief     Models of how long an SD card takes to complete each write are represented here.
+ * @details   A latency model turns a sequence of writes into a sequence of write times. The POSIX SD card back-end sleeps
+ *            for each write time to inject realistic latency into a live run of the recording loop, and the ring depth
+ *            planner (see `ring_depth_planner.h`) replays the same sequence without any threads to find the DMA ring
+ *            depth a card needs. Models with randomness use their own seeded generator so every run is repeatable.
+ */
+
+#ifndef SD_LATENCY_MODEL_H_
+#define SD_LATENCY_MODEL_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The kinds of latency model are represented here.
+ */
+typedef enum
+{
+    SD_LATENCY_MODEL_PERIODIC,  /** a fixed overhead plus throughput, with a stall every so many writes */
+    SD_LATENCY_MODEL_LONG_TAIL, /** a fixed overhead plus throughput, with garbage collection stalls at random writes */
+    SD_LATENCY_MODEL_MEASURED,  /** write times drawn at random from write times measured on a real card */
+} SD_Latency_Model_Kind_t;
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A latency model and its state are represented here. Only the fields for the model's kind are used.
+ */
+typedef struct
+{
+    SD_Latency_Model_Kind_t kind;
+
+    uint32_t overhead_microsecs; /** periodic and long tail, the fixed cost of each write, command and busy time */
+    uint32_t bytes_per_millisec; /** periodic and long tail, sustained write throughput, 0 for infinitely fast */
+
+    uint32_t stall_microsecs;        /** periodic, the length of an occasional long busy period */
+    uint32_t stall_period_in_writes; /** periodic, a stall happens every this many writes, 0 for never */
+
+    uint32_t min_gc_stall_microsecs; /** long tail, the shortest garbage collection stall */
+    uint32_t max_gc_stall_microsecs; /** long tail, the longest garbage collection stall */
+    uint32_t gc_stall_one_in_n;      /** long tail, each write has a 1 in this many chance of a stall, 0 for never */
+
+    uint32_t *measured_microsecs; /** measured, the write times to draw from, owned by the model */
+    uint32_t num_measured;        /** measured, the number of write times */
+
+    uint32_t seed; /** the random number generator starts from this seed each time the model is restarted */
+
+    // the state of the model, set by `sd_latency_model_restart()`
+    uint32_t num_writes_since_stall;
+    uint32_t rng_state;
+} SD_Latency_Model_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `sd_latency_model_parse(s, m)` sets up model `m` from description `s`, and is true if `s` was valid. The
+ * descriptions are:
+ *
+ * - `none` writes take no time
+ * - `typical` a card in the middle of the pack, 10MB/s with an 80ms stall every 48 writes
+ * - `<overhead_us>:<bytes_per_ms>:<stall_us>:<stall_period_in_writes>` a custom periodic model
+ * - `longtail` 10MB/s with a 100-250ms garbage collection stall at 1 in 50 writes at random
+ * - `longtail:<overhead_us>:<bytes_per_ms>:<min_stall_us>:<max_stall_us>:<one_in_n>` a custom long tail model
+ * - `csv:<file>` write times drawn from every row of a `block_write_times_microsec.csv` file made from a firmware trace
+ * - `csv:<file>:<row>` write times drawn from one row of the file, e.g. `csv:times.csv:384k-24bit`
+ *
+ * @post the model is restarted and ready to use. Free it with `sd_latency_model_free()`.
+ */
+bool sd_latency_model_parse(const char *str, SD_Latency_Model_t *model);
+
+/**
+ * @brief `sd_latency_model_free(m)` frees any memory held by model `m`.
+ */
+void sd_latency_model_free(SD_Latency_Model_t *model);
+
+/**
+ * @brief `sd_latency_model_restart(m)` puts model `m` back in its initial state, so it produces the same write times
+ * again.
+ */
+void sd_latency_model_restart(SD_Latency_Model_t *model);
+
+/**
+ * @brief `sd_latency_model_next_write_time(m, n)` is the time in microseconds the next write of `n` bytes takes under
+ * model `m`.
+ *
+ * Measured write times already include the transfer time for the block size they were measured with, so they don't
+ * depend on `n`. Draw them from the row with the same sample rate and bit depth for the most faithful results.
+ */
+uint32_t sd_latency_model_next_write_time(SD_Latency_Model_t *model, uint32_t size);
+
+#endif /* SD_LATENCY_MODEL_H_ */
@@ -63,7 +63,7 @@ for i in range(num_sample_rates):
 
         axs[i, j].axvline(x=df[col].max(), color="purple", ls="dotted", label="max")
 
-        axs[i, j].set_xlabel("Time to filter and write 1 DMA block (seconds)")
+        axs[i, j].set_xlabel("Time to write 1 processed DMA block (seconds)")
 
 plt.legend()
 
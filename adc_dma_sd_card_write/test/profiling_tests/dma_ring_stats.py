@@ -0,0 +1,36 @@
+import matplotlib.pyplot as plt
+import pandas as pd
+
+# the firmware appends one row per recording, with no header, so name the columns here
+summary_cols = [
+    "recording",
+    "depth",
+    "peak_occupancy",
+    "overruns",
+    "stalls",
+    "max_drain_microsecs",
+    "mean_drain_microsecs",
+]
+num_lag_bins = 16
+lag_cols = [f"lag_{i}" for i in range(num_lag_bins)]
+
+df = pd.read_csv(
+    "dma_ring_stats.csv", header=None, names=summary_cols + lag_cols, skip_blank_lines=True
+)
+
+print(df[summary_cols].to_string(index=False))
+
+fig, axs = plt.subplots(len(df), 1, sharex=True, squeeze=False)
+
+fig.suptitle("Consumer lag behind the DMA, in blocks, for each recording")
+
+for ax, (_, row) in zip(axs[:, 0], df.iterrows()):
+    ax.bar(range(num_lag_bins), row[lag_cols], alpha=0.7)
+    ax.axvline(x=row["depth"] - 1, color="red", ls="solid", label="overrun")
+    ax.set_yscale("log")
+    ax.set_ylabel(row["recording"], size="large")
+
+axs[-1, 0].set_xlabel("Full blocks waiting behind the block being consumed (last bin includes all larger lags)")
+
+plt.legend()
+plt.show()
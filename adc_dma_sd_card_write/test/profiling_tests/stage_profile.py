@@ -0,0 +1,28 @@
+import pandas as pd
+
+# the firmware appends one row per stage for each recording, with no header, so name the columns here
+cols = [
+    "recording",
+    "stage",
+    "calls",
+    "min_microsecs",
+    "mean_microsecs",
+    "p99_microsecs",
+    "max_microsecs",
+    "budget_microsecs",
+    "over_budget",
+]
+
+df = pd.read_csv("stage_profile.csv", header=None, names=cols, skip_blank_lines=True)
+
+# stages a recording doesn't use, e.g. decimate at 384kHz, have no calls
+df = df[df["calls"] > 0]
+
+print(df.to_string(index=False))
+
+over = df[df["over_budget"] > 0]
+if over.empty:
+    print("\nevery stage stayed within its budget")
+else:
+    print("\nstages that went over their budget")
+    print(over[["recording", "stage", "over_budget", "max_microsecs", "budget_microsecs"]].to_string(index=False))
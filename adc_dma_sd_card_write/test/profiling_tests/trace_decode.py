@@ -0,0 +1,190 @@
+import argparse
+import numpy as np
+import pandas as pd
+
+# the records of the trace log, see trace_log.h, the event values are part of the file format
+record_dtype = np.dtype([("timestamp", "<u4"), ("event", "<u2"), ("arg", "<u2")])
+
+EVENT_NONE = 0
+EVENT_SESSION_START = 1
+EVENT_RECORDS_DROPPED = 2
+EVENT_RECORDING_START = 3
+EVENT_RECORDING_END = 4
+EVENT_FILE_START = 5
+EVENT_DMA_BLOCK_DONE = 6
+EVENT_DMA_OVERRUN = 7
+EVENT_OVER_BUDGET = 16
+
+# the stages of the stage profiler, in the order of Stage_Profiler_Stage_t in stage_profiler.h
+profiler_stages = ["convert", "decimate", "encode", "write", "header"]
+
+# the steps traced with a start and an end event
+steps = {
+    "convert": (8, 9),
+    "decimate": (10, 11),
+    "encode": (12, 13),
+    "write": (14, 15),
+}
+
+parser = argparse.ArgumentParser(
+    description="Decodes the binary trace log the firmware appends to trace_log.bin"
+)
+parser.add_argument("trace", nargs="?", default="trace_log.bin", help="the trace file")
+parser.add_argument(
+    "--csv",
+    action="store_true",
+    help="also write the write times to block_write_times_microsec.csv, for block_write_hist.py and the host sim",
+)
+parser.add_argument(
+    "--plot",
+    metavar="DETAILS",
+    help="plot a histogram of the step times of each recording, with DETAILS in the title",
+)
+parser.add_argument(
+    "--step",
+    choices=steps.keys(),
+    default="write",
+    help="the step to plot, write times include any file switch that came with the write",
+)
+args = parser.parse_args()
+
+records = np.fromfile(args.trace, dtype=record_dtype)
+
+
+class Recording:
+    def __init__(self, arg, ticks_per_microsec):
+        self.name = f"{arg & 0x3FF}k-{arg >> 10}bit"
+        self.ticks_per_microsec = ticks_per_microsec
+        self.step_times = {step: [] for step in steps}
+        self.step_start = {}
+        self.dma_periods = []
+        self.last_dma_timestamp = None
+        self.peak_occupancy = 0
+        self.num_blocks = 0
+        self.num_files = 0
+        self.num_overruns = 0
+        self.num_dropped = 0
+        self.num_over_budget = {}
+        self.end_err = None
+
+    def microsecs(self, start, end):
+        # the timestamps wrap around at 32 bits, the time between two is their difference modulo 2^32
+        return ((int(end) - int(start)) % (1 << 32)) / self.ticks_per_microsec
+
+
+# split the trace into recordings, the records of one recording are in the order they went into the ring
+recordings = []
+recording = None
+ticks_per_microsec = 1.0
+start_events = {start: step for step, (start, _) in steps.items()}
+end_events = {end: step for step, (_, end) in steps.items()}
+
+for timestamp, event, arg in records:
+    if event == EVENT_NONE:
+        continue
+    elif event == EVENT_SESSION_START:
+        ticks_per_microsec = timestamp / 1e6
+    elif event == EVENT_RECORDING_START:
+        recording = Recording(arg, ticks_per_microsec)
+        recordings.append(recording)
+    elif recording is None:
+        continue
+    elif event == EVENT_RECORDING_END:
+        recording.end_err = arg
+        recording = None
+    elif event == EVENT_RECORDS_DROPPED:
+        recording.num_dropped += arg
+    elif event == EVENT_FILE_START:
+        recording.num_files += 1
+    elif event == EVENT_DMA_BLOCK_DONE:
+        recording.num_blocks += 1
+        recording.peak_occupancy = max(recording.peak_occupancy, arg)
+        if recording.last_dma_timestamp is not None:
+            recording.dma_periods.append(recording.microsecs(recording.last_dma_timestamp, timestamp))
+        recording.last_dma_timestamp = timestamp
+    elif event == EVENT_DMA_OVERRUN:
+        recording.num_overruns += 1
+    elif event == EVENT_OVER_BUDGET:
+        stage = profiler_stages[arg] if arg < len(profiler_stages) else str(arg)
+        recording.num_over_budget[stage] = recording.num_over_budget.get(stage, 0) + 1
+    elif event in start_events:
+        recording.step_start[start_events[event]] = timestamp
+    elif event in end_events:
+        step = end_events[event]
+        if step in recording.step_start:
+            recording.step_times[step].append(recording.microsecs(recording.step_start.pop(step), timestamp))
+
+
+def summary(times):
+    return (np.mean(times), np.percentile(times, 99), np.max(times)) if times else (np.nan,) * 3
+
+
+rows = []
+for r in recordings:
+    row = {
+        "recording": r.name,
+        "files": r.num_files,
+        "blocks": r.num_blocks,
+        "peak": r.peak_occupancy,
+        "overruns": r.num_overruns,
+        "dropped": r.num_dropped,
+        "max_dma_ms": max(r.dma_periods) / 1000 if r.dma_periods else np.nan,
+    }
+    for step in steps:
+        mean, p99, max_time = summary(r.step_times[step])
+        row[f"{step}_mean_ms"] = mean / 1000
+        row[f"{step}_p99_ms"] = p99 / 1000
+        row[f"{step}_max_ms"] = max_time / 1000
+    row["over_budget"] = " ".join(f"{stage}:{n}" for stage, n in r.num_over_budget.items())
+    row["error"] = "" if r.end_err in (None, 0) else r.end_err
+    rows.append(row)
+
+df = pd.DataFrame(rows)
+print(df.dropna(axis=1, how="all").to_string(index=False, float_format="%.3f"))
+
+if args.csv:
+    # the same layout the firmware used to write, one row per recording with a trailing comma after each value
+    with open("block_write_times_microsec.csv", "w") as csv:
+        for r in recordings:
+            csv.write(f"\n{r.name}," + "".join(f"{round(t)}," for t in r.step_times["write"]))
+
+if args.plot is not None:
+    # only needed for the plot, so the summary and the csv work without it
+    import matplotlib.pyplot as plt
+
+    # one histogram per recording, sample rates down and bit depths across like block_write_hist.py
+    sample_rates = list(dict.fromkeys(r.name.split("-")[0] for r in recordings))
+    bit_depths = list(dict.fromkeys(r.name.split("-")[1] for r in recordings))
+
+    fig, axs = plt.subplots(len(sample_rates), len(bit_depths), squeeze=False)
+    fig.suptitle(f"Histogram of {args.step} times. {args.plot}")
+
+    all_times = [t / 1e6 for r in recordings for t in r.step_times[args.step]]
+    t_range = [min(all_times), max(all_times)] if all_times else None
+
+    for ax, col in zip(axs[0], bit_depths):
+        ax.set_title(col)
+
+    for ax, row in zip(axs[:, 0], sample_rates):
+        ax.set_ylabel(row, size="large")
+
+    for r in recordings:
+        sample_rate, bit_depth = r.name.split("-")
+        ax = axs[sample_rates.index(sample_rate), bit_depths.index(bit_depth)]
+        times = [t / 1e6 for t in r.step_times[args.step]]
+        if not times:
+            continue
+
+        ax.hist(x=times, bins=100, range=t_range, alpha=0.7)
+        ax.axvline(x=0.0085, color="red", ls="solid", label="8.5msec limit")
+        ax.axvline(x=np.mean(times), color="blue", ls="dashed", label="mean")
+        ax.axvline(x=np.median(times), color="green", ls="dashdot", label="median")
+        ax.axvline(x=np.max(times), color="purple", ls="dotted", label="max")
+        ax.set_xlabel(f"Time to {args.step} 1 processed DMA block (seconds)")
+
+    plt.legend()
+
+    for ax in fig.get_axes():
+        ax.label_outer()
+
+    plt.show()
@@ -0,0 +1,558 @@
+/**
+ * Converts the raw files written with `DEMO_CONFIG_RAW_CAPTURE` into WAVE files at any of the sample rates and bit
+ * depths the recorder supports, with the same data converters and decimation filters the recorder runs, so a WAVE file
+ * made here is sample for sample the file the recorder would have written at that rate and depth.
+ *
+ * Each raw file is mapped into memory once with `mmap` and shared by every conversion of it. Each output file is one
+ * job, and the jobs run in parallel in worker processes, at most `--jobs` at a time. Workers are processes rather than
+ * threads because the decimation filters keep their state in statics, and one output can't be split between workers
+ * because that state runs from the first sample of the file to the last.
+ *
+ * The metadata of each raw file is read from the .txt sidecar next to it, the start time goes in the bext chunk of each
+ * WAVE file made from it.
+ *
+ * usage: raw_convert [--rate <Hz>]... [--bits <16|24>]... [--jobs <n>] [--out <dir>] <file.raw> ...
+ */
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "audio_dma.h"
+#include "data_converters.h"
+#include "decimation_filter.h"
+#include "wav_header.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define ADC_SAMPLE_RATE (WAVE_HEADER_SAMPLE_RATE_384kHz)
+
+// the decimation filters take samples in multiples of this, the most they decimate by
+#define FILTER_CHUNK_LEN_IN_SAMPS (16)
+
+#define MAX_NUM_RATES (5)
+#define MAX_NUM_BIT_DEPTHS (2)
+#define MAX_NUM_FILES (1024)
+
+#define PATH_BUFF_LEN (1024)
+
+// output files are written through a buffer this big, so the disk sees a few big writes
+#define OUT_BUFF_LEN_IN_BYTES (1 << 20)
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A raw file mapped into memory, with the metadata from its sidecar, is represented here.
+ */
+typedef struct
+{
+    const char *path;
+    const uint8_t *samples;
+    uint64_t num_samples;
+    Wave_Header_Broadcast_Attributes_t start;
+} Raw_File_t;
+
+/**
+ * @brief One output file to make from a raw file is represented here.
+ */
+typedef struct
+{
+    const Raw_File_t *raw;
+    Wave_Header_Sample_Rate_t sample_rate;
+    Wave_Header_Bits_Per_Sample_t bits_per_sample;
+} Job_t;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `load_raw_file(p, r)` reads the sidecar of the raw file at `p` and maps the file into memory in `r`, and is
+ * true if it could.
+ */
+static bool load_raw_file(const char *path, Raw_File_t *raw);
+
+/**
+ * @brief `read_sidecar(p, r, n)` reads the sidecar of the raw file at `p` into `r`, and stores the number of samples it
+ * says the file holds in `n`. It is true if the sidecar is there and describes a stream this tool can convert.
+ */
+static bool read_sidecar(const char *path, Raw_File_t *raw, uint64_t *num_samples);
+
+/**
+ * @brief `convert(j, o)` makes the output file of job `j` in directory `o`, or next to the raw file if `o` is NULL,
+ * prints a row of results, and is true if the file was written.
+ */
+static bool convert(const Job_t *job, const char *out_dir);
+
+/**
+ * @brief `process_samples(s, n, r, b, d)` converts `n` big-endian 24 bit samples from `s` to sample rate `r` and `b`
+ * bits per sample into `d`, the way the recorder processes a DMA block, and is the number of bytes stored. `n` is a
+ * multiple of `FILTER_CHUNK_LEN_IN_SAMPS` no more than `AUDIO_DMA_BUFF_LEN_IN_SAMPS`.
+ */
+static uint32_t process_samples(const uint8_t *src, uint32_t num_samps, Wave_Header_Sample_Rate_t sample_rate,
+                                 Wave_Header_Bits_Per_Sample_t bits_per_sample, uint8_t *dest);
+
+/**
+ * @brief `out_path(j, o, p)` stores the path of the output file of job `j` in directory `o`, or next to the raw file
+ * if `o` is NULL, in `p`.
+ */
+static void out_path(const Job_t *job, const char *out_dir, char *path);
+
+static bool is_supported_rate(uint32_t sample_rate);
+
+static double now_in_secs();
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    static Raw_File_t raw_files[MAX_NUM_FILES];
+    static Job_t jobs[MAX_NUM_FILES * MAX_NUM_RATES * MAX_NUM_BIT_DEPTHS];
+
+    Wave_Header_Sample_Rate_t rates[MAX_NUM_RATES];
+    uint32_t num_rates = 0;
+    Wave_Header_Bits_Per_Sample_t bit_depths[MAX_NUM_BIT_DEPTHS];
+    uint32_t num_bit_depths = 0;
+    long max_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *out_dir = NULL;
+    int first_file_arg = argc;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc && num_rates < MAX_NUM_RATES)
+        {
+            rates[num_rates++] = (Wave_Header_Sample_Rate_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--bits") == 0 && i + 1 < argc && num_bit_depths < MAX_NUM_BIT_DEPTHS)
+        {
+            bit_depths[num_bit_depths++] = (Wave_Header_Bits_Per_Sample_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        {
+            max_jobs = strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            out_dir = argv[++i];
+        }
+        else if (argv[i][0] != '-')
+        {
+            first_file_arg = i;
+            break;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--rate <Hz>]... [--bits <16|24>]... [--jobs <n>] [--out <dir>] <file.raw> ...\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // with no rate or bit depth given, each raw file is just wrapped up as a 384kHz 24 bit WAVE file
+    if (num_rates == 0)
+    {
+        rates[num_rates++] = WAVE_HEADER_SAMPLE_RATE_384kHz;
+    }
+
+    if (num_bit_depths == 0)
+    {
+        bit_depths[num_bit_depths++] = WAVE_HEADER_24_BITS_PER_SAMPLE;
+    }
+
+    for (uint32_t i = 0; i < num_rates; i++)
+    {
+        if (!is_supported_rate(rates[i]))
+        {
+            fprintf(stderr, "%u Hz isn't a sample rate the recorder supports, try 24000, 48000, 96000, 192000 or 384000\n", rates[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (uint32_t i = 0; i < num_bit_depths; i++)
+    {
+        if (bit_depths[i] != WAVE_HEADER_16_BITS_PER_SAMPLE && bit_depths[i] != WAVE_HEADER_24_BITS_PER_SAMPLE)
+        {
+            fprintf(stderr, "%u bits per sample isn't supported, try 16 or 24\n", bit_depths[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (first_file_arg == argc || argc - first_file_arg > MAX_NUM_FILES || max_jobs < 1)
+    {
+        fprintf(stderr, "nothing to convert, give between 1 and %d raw files and at least 1 job\n", MAX_NUM_FILES);
+        return EXIT_FAILURE;
+    }
+
+    int exit_code = EXIT_SUCCESS;
+    uint32_t num_jobs = 0;
+
+    // the files are mapped before the workers start, so every worker converting the same file shares its pages
+    for (int i = first_file_arg; i < argc; i++)
+    {
+        Raw_File_t *raw = &raw_files[i - first_file_arg];
+
+        if (!load_raw_file(argv[i], raw))
+        {
+            exit_code = EXIT_FAILURE;
+            continue;
+        }
+
+        for (uint32_t r = 0; r < num_rates; r++)
+        {
+            for (uint32_t b = 0; b < num_bit_depths; b++)
+            {
+                jobs[num_jobs++] = (Job_t){.raw = raw, .sample_rate = rates[r], .bits_per_sample = bit_depths[b]};
+            }
+        }
+    }
+
+    printf("%-40s %7s %4s %10s %8s %8s\n", "file", "rate", "bits", "audio_s", "secs", "x_rt");
+    fflush(stdout);
+
+    const double start_secs = now_in_secs();
+    double audio_secs = 0.0;
+    uint32_t num_running = 0;
+
+    for (uint32_t next_job = 0; next_job < num_jobs || num_running > 0;)
+    {
+        if (next_job < num_jobs && num_running < max_jobs)
+        {
+            const Job_t *job = &jobs[next_job++];
+            audio_secs += (double)job->raw->num_samples / ADC_SAMPLE_RATE;
+
+            const pid_t pid = fork();
+            if (pid == 0)
+            {
+                _exit(convert(job, out_dir) ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+
+            if (pid < 0)
+            {
+                perror("fork");
+                exit_code = EXIT_FAILURE;
+                continue;
+            }
+
+            num_running += 1;
+            continue;
+        }
+
+        int status;
+        if (wait(&status) < 0)
+        {
+            break;
+        }
+
+        num_running -= 1;
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            exit_code = EXIT_FAILURE;
+        }
+    }
+
+    const double secs = now_in_secs() - start_secs;
+    printf("%u files from %.1f seconds of audio in %.2f seconds with up to %ld jobs at a time, %.0fx real time\n",
+           num_jobs, audio_secs, secs, max_jobs, secs > 0.0 ? audio_secs / secs : 0.0);
+
+    return exit_code;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool load_raw_file(const char *path, Raw_File_t *raw)
+{
+    uint64_t sidecar_num_samples;
+    if (!read_sidecar(path, raw, &sidecar_num_samples))
+    {
+        return false;
+    }
+
+    const int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        fprintf(stderr, "could not open %s\n", path);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+
+    // a power cut leaves the file at its last checkpoint, shorter than the sidecar says, the samples that made it are
+    // still good
+    raw->path = path;
+    raw->num_samples = (uint64_t)st.st_size / DATA_CONVERTERS_I24_SIZE_IN_BYTES;
+    if (raw->num_samples < sidecar_num_samples)
+    {
+        fprintf(stderr, "%s has %llu of the %llu samples its sidecar says, converting the ones there are\n", path,
+                (unsigned long long)raw->num_samples, (unsigned long long)sidecar_num_samples);
+    }
+    else
+    {
+        raw->num_samples = sidecar_num_samples;
+    }
+
+    if (raw->num_samples == 0)
+    {
+        fprintf(stderr, "%s has no samples\n", path);
+        close(fd);
+        return false;
+    }
+
+    raw->samples = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (raw->samples == MAP_FAILED)
+    {
+        fprintf(stderr, "could not map %s\n", path);
+        return false;
+    }
+
+    // every worker reads its file front to back
+    madvise((void *)raw->samples, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    return true;
+}
+
+bool read_sidecar(const char *path, Raw_File_t *raw, uint64_t *num_samples)
+{
+    char sidecar_path[PATH_BUFF_LEN];
+    const char *ext = strrchr(path, '.');
+    const size_t stem_len = ext != NULL && strcmp(ext, ".raw") == 0 ? (size_t)(ext - path) : strlen(path);
+    snprintf(sidecar_path, sizeof(sidecar_path), "%.*s.txt", (int)stem_len, path);
+
+    FILE *f = fopen(sidecar_path, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "could not open the sidecar %s\n", sidecar_path);
+        return false;
+    }
+
+    char line[256];
+    bool is_raw = false;
+    uint32_t sample_rate = 0;
+    uint32_t bits_per_sample = 0;
+    uint32_t num_channels = 0;
+    bool is_big_endian = false;
+    *num_samples = 0;
+    raw->start = (Wave_Header_Broadcast_Attributes_t){0};
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        char *value = strchr(line, '=');
+        if (value == NULL)
+        {
+            continue;
+        }
+        *value++ = '\0';
+        value[strcspn(value, "\r\n")] = '\0';
+
+        unsigned year, month, day, hour, minute, second;
+
+        if (strcmp(line, "format") == 0)
+        {
+            is_raw = strcmp(value, "raw") == 0;
+        }
+        else if (strcmp(line, "sample_rate") == 0)
+        {
+            sample_rate = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(line, "bits_per_sample") == 0)
+        {
+            bits_per_sample = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(line, "channels") == 0)
+        {
+            num_channels = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(line, "byte_order") == 0)
+        {
+            is_big_endian = strcmp(value, "big") == 0;
+        }
+        else if (strcmp(line, "num_samples") == 0)
+        {
+            *num_samples = strtoull(value, NULL, 10);
+        }
+        else if (strcmp(line, "start_time") == 0 &&
+                 sscanf(value, "%u-%u-%u %u:%u:%u", &year, &month, &day, &hour, &minute, &second) == 6)
+        {
+            raw->start.year = (uint16_t)year;
+            raw->start.month = (uint8_t)month;
+            raw->start.day = (uint8_t)day;
+            raw->start.hour = (uint8_t)hour;
+            raw->start.minute = (uint8_t)minute;
+            raw->start.second = (uint8_t)second;
+        }
+        else if (strcmp(line, "time_reference") == 0)
+        {
+            raw->start.time_reference = strtoull(value, NULL, 10);
+        }
+    }
+
+    fclose(f);
+
+    if (!is_raw || sample_rate != ADC_SAMPLE_RATE || bits_per_sample != 24 || num_channels != 1 || !is_big_endian)
+    {
+        fprintf(stderr, "%s doesn't describe a 384kHz 24 bit big-endian mono raw file\n", sidecar_path);
+        return false;
+    }
+
+    return true;
+}
+
+bool convert(const Job_t *job, const char *out_dir)
+{
+    // big enough for a DMA block of 384kHz 24 bit samples, or of decimated q31's
+    static uint8_t block_buff[AUDIO_DMA_BUFF_LEN_IN_BYTES];
+    static uint8_t tail_buff[AUDIO_DMA_BUFF_LEN_IN_BYTES];
+    static char out_buff[OUT_BUFF_LEN_IN_BYTES];
+
+    const double start_secs = now_in_secs();
+    const Raw_File_t *raw = job->raw;
+    const uint32_t decimation_factor = ADC_SAMPLE_RATE / job->sample_rate;
+    const uint32_t bytes_per_sample = job->bits_per_sample / 8;
+    const uint64_t out_num_samples = raw->num_samples / decimation_factor;
+    const uint64_t data_len = out_num_samples * bytes_per_sample;
+
+    if (job->sample_rate != ADC_SAMPLE_RATE)
+    {
+        decimation_filter_set_sample_rate(job->sample_rate);
+    }
+
+    // the header is laid out the way the recorder lays out its own, RF64 only when the file won't fit a plain one
+    Wave_Header_Broadcast_Attributes_t bext_attr = raw->start;
+    bext_attr.time_reference /= decimation_factor;
+    wav_header_enable_bext(true);
+    wav_header_enable_ima_adpcm(false);
+    wav_header_enable_rf64(false);
+    wav_header_enable_rf64(wav_header_get_header_length() + data_len - 8 > UINT32_MAX);
+    wav_header_set_broadcast_attributes(&bext_attr);
+
+    Wave_Header_Attributes_t wav_attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = job->bits_per_sample,
+        .sample_rate = job->sample_rate,
+        .file_length = wav_header_get_header_length() + data_len,
+    };
+    wav_header_set_attributes(&wav_attr);
+
+    char path[PATH_BUFF_LEN];
+    out_path(job, out_dir, path);
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "could not create %s\n", path);
+        return false;
+    }
+
+    setvbuf(f, out_buff, _IOFBF, sizeof(out_buff));
+    bool is_written = fwrite(wav_header_get_header(), 1, wav_header_get_header_length(), f) == wav_header_get_header_length();
+
+    // whole DMA blocks first, just as the recorder sees them
+    const uint64_t num_whole_samps = raw->num_samples - (raw->num_samples % FILTER_CHUNK_LEN_IN_SAMPS);
+    uint64_t pos = 0;
+
+    while (is_written && pos < num_whole_samps)
+    {
+        const uint64_t samps_left = num_whole_samps - pos;
+        const uint32_t num_samps = samps_left < AUDIO_DMA_BUFF_LEN_IN_SAMPS ? (uint32_t)samps_left : AUDIO_DMA_BUFF_LEN_IN_SAMPS;
+
+        const uint32_t len = process_samples(raw->samples + (pos * DATA_CONVERTERS_I24_SIZE_IN_BYTES), num_samps, job->sample_rate,
+                                             job->bits_per_sample, block_buff);
+        is_written = fwrite(block_buff, 1, len, f) == len;
+        pos += num_samps;
+    }
+
+    // the last few samples are padded out to a whole chunk for the filters, only the samples they fully make are kept
+    const uint32_t tail_len_in_samps = (uint32_t)(raw->num_samples - num_whole_samps);
+    if (is_written && tail_len_in_samps > 0)
+    {
+        memset(tail_buff, 0, FILTER_CHUNK_LEN_IN_SAMPS * DATA_CONVERTERS_I24_SIZE_IN_BYTES);
+        memcpy(tail_buff, raw->samples + (pos * DATA_CONVERTERS_I24_SIZE_IN_BYTES), tail_len_in_samps * DATA_CONVERTERS_I24_SIZE_IN_BYTES);
+        process_samples(tail_buff, FILTER_CHUNK_LEN_IN_SAMPS, job->sample_rate, job->bits_per_sample, block_buff);
+
+        const uint32_t len = (tail_len_in_samps / decimation_factor) * bytes_per_sample;
+        is_written = fwrite(block_buff, 1, len, f) == len;
+    }
+
+    is_written = fclose(f) == 0 && is_written;
+
+    if (!is_written)
+    {
+        fprintf(stderr, "could not write %s\n", path);
+        return false;
+    }
+
+    const double secs = now_in_secs() - start_secs;
+    const double audio_secs = (double)raw->num_samples / ADC_SAMPLE_RATE;
+    const char *name = strrchr(path, '/') != NULL ? strrchr(path, '/') + 1 : path;
+    printf("%-40s %7u %4u %10.1f %8.2f %8.0f\n", name, job->sample_rate, job->bits_per_sample, audio_secs, secs,
+           secs > 0.0 ? audio_secs / secs : 0.0);
+    fflush(stdout);
+
+    return true;
+}
+
+uint32_t process_samples(const uint8_t *src, uint32_t num_samps, Wave_Header_Sample_Rate_t sample_rate,
+                         Wave_Header_Bits_Per_Sample_t bits_per_sample, uint8_t *dest)
+{
+    // the samples as q31's for the decimation filters
+    static q31_t q31_buff[AUDIO_DMA_BUFF_LEN_IN_SAMPS];
+
+    // the converters only read their source, the mapping is read only
+    uint8_t *samples = (uint8_t *)src;
+    const uint32_t len_in_bytes = num_samps * DATA_CONVERTERS_I24_SIZE_IN_BYTES;
+
+    if (sample_rate == WAVE_HEADER_SAMPLE_RATE_384kHz)
+    {
+        data_converters_i24_swap_endianness(samples, dest, len_in_bytes);
+
+        return bits_per_sample == WAVE_HEADER_24_BITS_PER_SAMPLE ? len_in_bytes : data_converters_i24_to_q15(dest, (q15_t *)dest, len_in_bytes);
+    }
+
+    data_converters_i24_to_q31_with_endian_swap(samples, q31_buff, len_in_bytes);
+
+    const uint32_t len_in_samps = decimation_filter_downsample(q31_buff, (q31_t *)dest, num_samps);
+
+    return bits_per_sample == WAVE_HEADER_24_BITS_PER_SAMPLE
+               ? data_converters_q31_to_i24((q31_t *)dest, dest, len_in_samps)
+               : data_converters_q31_to_q15((q31_t *)dest, (q15_t *)dest, len_in_samps);
+}
+
+void out_path(const Job_t *job, const char *out_dir, char *path)
+{
+    const char *raw_name = strrchr(job->raw->path, '/') != NULL ? strrchr(job->raw->path, '/') + 1 : job->raw->path;
+    const char *ext = strrchr(raw_name, '.');
+    const int stem_len = ext != NULL ? (int)(ext - raw_name) : (int)strlen(raw_name);
+
+    // next to the raw file unless told otherwise
+    const int dir_len = out_dir != NULL ? (int)strlen(out_dir) : (int)(raw_name - job->raw->path);
+    const char *dir = out_dir != NULL ? out_dir : job->raw->path;
+    const char *separator = out_dir != NULL && dir_len > 0 && out_dir[dir_len - 1] != '/' ? "/" : "";
+
+    snprintf(path, PATH_BUFF_LEN, "%.*s%s%.*s_%ukHz_%u_bit.wav", dir_len, dir, separator, stem_len, raw_name,
+             job->sample_rate / 1000, job->bits_per_sample);
+}
+
+bool is_supported_rate(uint32_t sample_rate)
+{
+    return sample_rate == WAVE_HEADER_SAMPLE_RATE_24kHz || sample_rate == WAVE_HEADER_SAMPLE_RATE_48kHz ||
+           sample_rate == WAVE_HEADER_SAMPLE_RATE_96kHz || sample_rate == WAVE_HEADER_SAMPLE_RATE_192kHz ||
+           sample_rate == WAVE_HEADER_SAMPLE_RATE_384kHz;
+}
+
+double now_in_secs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
@@ -0,0 +1,33 @@
+#include "fake_cycle_counter.hpp"
+
+namespace fake_cycle_counter
+{
+    uint32_t now;
+    uint32_t cycles_per_read;
+
+    void reset()
+    {
+        now = 0;
+        cycles_per_read = 1;
+    }
+}
+
+extern "C"
+{
+    void cycle_counter_init()
+    {
+        fake_cycle_counter::now = 0;
+    }
+
+    uint32_t cycle_counter_now()
+    {
+        const uint32_t cycles = fake_cycle_counter::now;
+        fake_cycle_counter::now += fake_cycle_counter::cycles_per_read;
+        return cycles;
+    }
+
+    uint32_t cycle_counter_freq_hz()
+    {
+        return fake_cycle_counter::FREQ_HZ;
+    }
+}
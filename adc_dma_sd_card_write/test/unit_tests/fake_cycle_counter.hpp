@@ -0,0 +1,24 @@
+
+/**
+ * The trace log and the stage profiler read the time from cycle_counter.h, so it is faked here for their tests with a
+ * counter that moves on by a set number of cycles each time it is read.
+ */
+
+#include <stdint.h>
+
+extern "C"
+{
+#include "cycle_counter.h"
+}
+
+namespace fake_cycle_counter
+{
+    const uint32_t FREQ_HZ = 96000000;
+
+    // the value the next read gives, and how far each read moves it on
+    extern uint32_t now;
+    extern uint32_t cycles_per_read;
+
+    // starts the counter from 0, counting up by one each read
+    void reset();
+}
@@ -0,0 +1,270 @@
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "fake_sd_card.hpp"
+
+namespace fake_sd_card
+{
+    Card cards[SD_CARD_BANK_CTL_NUM_CARDS];
+    SD_Card_Bank_Card_Slot_t active_slot;
+    bool is_mounted;
+
+    uint32_t num_detect_pin_reads;
+    uint32_t num_free_space_counts;
+
+    std::vector<std::string> mkdir_paths;
+    std::vector<std::string> dirs_changed_into;
+
+    std::vector<uint8_t> log_file;
+    bool is_log_open;
+    uint32_t num_log_writes_until_failure;
+
+    static bool detect_pins[SD_CARD_BANK_CTL_NUM_CARDS];
+
+    // the entries of the open directory, and the next one to read
+    static std::vector<std::pair<std::string, bool>> dir_entries;
+    static size_t next_dir_entry;
+
+    void reset()
+    {
+        for (Card &card : cards)
+        {
+            card = {false, true, 0};
+        }
+        active_slot = SD_CARD_BANK_ALL_SLOTS_DISABLED;
+        is_mounted = false;
+        num_detect_pin_reads = 0;
+        num_free_space_counts = 0;
+        mkdir_paths.clear();
+        dirs_changed_into.clear();
+        log_file.clear();
+        is_log_open = false;
+        num_log_writes_until_failure = UINT32_MAX;
+    }
+
+    void mount(SD_Card_Bank_Card_Slot_t slot)
+    {
+        cards[slot].is_inserted = true;
+        active_slot = slot;
+        is_mounted = true;
+    }
+
+    SD_Card_Bank_Card_Slot_t mounted_slot()
+    {
+        return is_mounted ? active_slot : SD_CARD_BANK_ALL_SLOTS_DISABLED;
+    }
+
+    // `path` without any leading or trailing '/', so the root is ""
+    static std::string trimmed(const char *path)
+    {
+        std::string trimmed_path(path);
+        trimmed_path.erase(0, trimmed_path.find_first_not_of('/'));
+        while (!trimmed_path.empty() && trimmed_path.back() == '/')
+        {
+            trimmed_path.pop_back();
+        }
+        return trimmed_path;
+    }
+
+    // the directory `path` is in, "" for the root
+    static std::string parent(const std::string &path)
+    {
+        const size_t sep = path.rfind('/');
+        return sep == std::string::npos ? "" : path.substr(0, sep);
+    }
+}
+
+using namespace fake_sd_card;
+
+extern "C"
+{
+    SD_Card_Bank_Ctl_Error_t sd_card_bank_ctl_disable_all()
+    {
+        active_slot = SD_CARD_BANK_ALL_SLOTS_DISABLED;
+        is_mounted = false;
+        return SD_CARD_BANK_CTL_ERROR_ALL_OK;
+    }
+
+    SD_Card_Bank_Ctl_Error_t sd_card_bank_ctl_enable_slot(SD_Card_Bank_Card_Slot_t slot)
+    {
+        EXPECT_FALSE(is_mounted) << "slot " << slot << " enabled under a mounted card";
+        active_slot = slot;
+        return SD_CARD_BANK_CTL_ERROR_ALL_OK;
+    }
+
+    SD_Card_Bank_Card_Slot_t sd_card_bank_ctl_get_active_slot()
+    {
+        return active_slot;
+    }
+
+    SD_Card_Bank_Ctl_Error_t sd_card_bank_ctl_read_and_cache_detect_pins()
+    {
+        for (uint32_t slot = 0; slot < SD_CARD_BANK_CTL_NUM_CARDS; slot++)
+        {
+            detect_pins[slot] = cards[slot].is_inserted;
+        }
+        num_detect_pin_reads += 1;
+        return SD_CARD_BANK_CTL_ERROR_ALL_OK;
+    }
+
+    bool sd_card_bank_ctl_slot_is_inserted(SD_Card_Bank_Card_Slot_t slot)
+    {
+        return slot < SD_CARD_BANK_CTL_NUM_CARDS && detect_pins[slot];
+    }
+
+    SD_Card_Error_t sd_card_init()
+    {
+        return active_slot < SD_CARD_BANK_CTL_NUM_CARDS && cards[active_slot].is_inserted ? SD_CARD_ERROR_ALL_OK : SD_CARD_NOT_INSERTED_ERROR;
+    }
+
+    SD_Card_Error_t sd_card_mount()
+    {
+        num_free_space_counts += 1;
+        is_mounted = cards[active_slot].mounts;
+        return is_mounted ? SD_CARD_ERROR_ALL_OK : SD_CARD_MOUNT_ERROR;
+    }
+
+    SD_Card_Error_t sd_card_mount_with_free_space(uint64_t free_space_in_bytes)
+    {
+        EXPECT_EQ(free_space_in_bytes, cards[active_slot].free_bytes) << "slot " << active_slot << " mounted with a stale count";
+        is_mounted = cards[active_slot].mounts;
+        return is_mounted ? SD_CARD_ERROR_ALL_OK : SD_CARD_MOUNT_ERROR;
+    }
+
+    SD_Card_Error_t sd_card_unmount()
+    {
+        is_mounted = false;
+        is_log_open = false;
+        return SD_CARD_ERROR_ALL_OK;
+    }
+
+    uint64_t sd_card_free_space_bytes()
+    {
+        return is_mounted ? cards[active_slot].free_bytes : 0;
+    }
+
+    SD_Card_Error_t sd_card_mkdir(const char *path)
+    {
+        mkdir_paths.push_back(path);
+
+        const std::string dir = trimmed(path);
+        if (!is_mounted || cards[active_slot].dirs.count(dir) != 0)
+        {
+            return SD_CARD_DIRECTORY_ERROR;
+        }
+
+        // like FatFS, the directory it goes in must already be there
+        if (!parent(dir).empty() && cards[active_slot].dirs.count(parent(dir)) == 0)
+        {
+            return SD_CARD_DIRECTORY_ERROR;
+        }
+
+        cards[active_slot].dirs.insert(dir);
+        return SD_CARD_ERROR_ALL_OK;
+    }
+
+    SD_Card_Error_t sd_card_cd(const char *path)
+    {
+        dirs_changed_into.push_back(std::to_string(active_slot) + ":" + path);
+        return SD_CARD_ERROR_ALL_OK;
+    }
+
+    SD_Card_Error_t sd_card_opendir(const char *path)
+    {
+        const std::string dir = trimmed(path);
+        if (!is_mounted || (!dir.empty() && cards[active_slot].dirs.count(dir) == 0))
+        {
+            return SD_CARD_DIRECTORY_ERROR;
+        }
+
+        dir_entries.clear();
+        next_dir_entry = 0;
+
+        for (const std::string &d : cards[active_slot].dirs)
+        {
+            if (parent(d) == dir)
+            {
+                dir_entries.push_back({d.substr(dir.empty() ? 0 : dir.size() + 1), true});
+            }
+        }
+        for (const std::string &f : cards[active_slot].files)
+        {
+            if (parent(f) == dir)
+            {
+                dir_entries.push_back({f.substr(dir.empty() ? 0 : dir.size() + 1), false});
+            }
+        }
+
+        // FatFS lists entries in the order they were made, starting half way through the sorted names makes sure nothing
+        // relies on the greatest name coming first or last
+        std::rotate(dir_entries.begin(), dir_entries.begin() + (dir_entries.size() / 2), dir_entries.end());
+
+        return SD_CARD_ERROR_ALL_OK;
+    }
+
+    SD_Card_Error_t sd_card_readdir(char *name_buff, uint32_t buff_len, bool *is_dir)
+    {
+        // an empty name marks the end of the directory, like FatFS
+        const std::string name = next_dir_entry < dir_entries.size() ? dir_entries[next_dir_entry].first : "";
+        *is_dir = next_dir_entry < dir_entries.size() && dir_entries[next_dir_entry].second;
+        next_dir_entry += 1;
+
+        strncpy(name_buff, name.c_str(), buff_len - 1);
+        name_buff[buff_len - 1] = '\0';
+
+        return SD_CARD_ERROR_ALL_OK;
+    }
+
+    SD_Card_Error_t sd_card_closedir()
+    {
+        dir_entries.clear();
+        return SD_CARD_ERROR_ALL_OK;
+    }
+
+    SD_Card_Error_t sd_card_log_open(const char *file_name)
+    {
+        (void)file_name;
+        if (!is_mounted || is_log_open)
+        {
+            return SD_CARD_FILE_IO_ERROR;
+        }
+        is_log_open = true;
+        return SD_CARD_ERROR_ALL_OK;
+    }
+
+    SD_Card_Error_t sd_card_log_write(const void *buff, uint32_t size)
+    {
+        if (!is_log_open || num_log_writes_until_failure == 0)
+        {
+            return SD_CARD_FILE_IO_ERROR;
+        }
+        num_log_writes_until_failure -= num_log_writes_until_failure == UINT32_MAX ? 0 : 1;
+
+        const uint8_t *bytes = (const uint8_t *)buff;
+        log_file.insert(log_file.end(), bytes, bytes + size);
+        return SD_CARD_ERROR_ALL_OK;
+    }
+
+    SD_Card_Error_t sd_card_log_close()
+    {
+        if (!is_log_open)
+        {
+            return SD_CARD_FILE_IO_ERROR;
+        }
+        is_log_open = false;
+        return SD_CARD_ERROR_ALL_OK;
+    }
+
+    bool sd_card_log_is_open()
+    {
+        return is_log_open;
+    }
+
+    void hal_timer_delay_microsecs(uint32_t microsecs)
+    {
+        (void)microsecs;
+    }
+}
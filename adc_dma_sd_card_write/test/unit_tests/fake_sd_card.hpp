@@ -0,0 +1,61 @@
+
+/**
+ * The modules that manage the SD card only talk to it and to the SD card bank through sd_card.h and sd_card_bank_ctl.h,
+ * so both are faked here for all of their tests, with six cards that each have a free space and a tree of directories,
+ * and can be left out of their slot or fail to mount.
+ */
+
+#include <stdint.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "sd_card.h"
+#include "sd_card_bank_ctl.h"
+}
+
+namespace fake_sd_card
+{
+    struct Card
+    {
+        bool is_inserted;
+        bool mounts;
+        uint64_t free_bytes;
+        std::set<std::string> dirs;  // every directory on the card, e.g. "2024", "2024/01"
+        std::set<std::string> files; // every file on the card, e.g. "2024/01/20240131_235959.wav"
+    };
+
+    extern Card cards[SD_CARD_BANK_CTL_NUM_CARDS];
+    extern SD_Card_Bank_Card_Slot_t active_slot;
+    extern bool is_mounted;
+
+    extern uint32_t num_detect_pin_reads;
+    extern uint32_t num_free_space_counts;
+
+    // every path passed to `sd_card_mkdir()`, made or not, and every path changed into as "<slot>:<path>"
+    extern std::vector<std::string> mkdir_paths;
+    extern std::vector<std::string> dirs_changed_into;
+
+    // the bytes appended to the log file, whether it is open, and the number of log writes left before they fail
+    extern std::vector<uint8_t> log_file;
+    extern bool is_log_open;
+    extern uint32_t num_log_writes_until_failure;
+
+    /**
+     * @brief `reset()` resets the fakes to six empty slots with none of them active, and an empty log file.
+     */
+    void reset();
+
+    /**
+     * @brief `mount(s)` makes slot `s` the active slot and mounts its card, as if it was the only SD card slot.
+     */
+    void mount(SD_Card_Bank_Card_Slot_t slot);
+
+    /**
+     * @brief `mounted_slot()` is the slot of the mounted card, or `SD_CARD_BANK_ALL_SLOTS_DISABLED`.
+     */
+    SD_Card_Bank_Card_Slot_t mounted_slot();
+}
@@ -8,7 +8,9 @@
 #include <stdint.h>
 #include "string.h"
 
-#define __SIMD32(addr) (*(int32_t **)&(addr))
+// the pointer to a byte buffer is read and advanced as a pointer to 32 bit words through a union, rather than by casting
+// its address, which breaks the strict aliasing rules
+#define __SIMD32(addr) (((union { __typeof__(&(addr)) as_declared; int32_t **as_words; }){.as_declared = &(addr)}).as_words[0])
 
 typedef int64_t q63_t;
 
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "test_helpers.hpp"
+
+extern "C"
+{
+#include "audio_dma.h"
+#include "audio_dma_ring.h"
+}
+
+using namespace testing;
+
+TEST(AudioDMARingTest, reset_empties_the_ring_and_sets_the_depth)
+{
+    audio_dma_ring_reset(6);
+
+    ASSERT_EQ(audio_dma_ring_get_depth(), 6);
+    ASSERT_EQ(audio_dma_ring_num_blocks_available(), 0);
+    ASSERT_FALSE(audio_dma_ring_overrun_occured());
+    ASSERT_EQ(audio_dma_ring_get_stats()->depth_in_blocks, 6);
+}
+
+TEST(AudioDMARingTest, producer_and_consumer_walk_the_ring_in_order_and_wrap_for_any_depth)
+{
+    // 5 is deliberately not a power of 2
+    audio_dma_ring_reset(5);
+
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        ASSERT_EQ(audio_dma_ring_produce(), (i + 1) % 5); // the index of the next block for the DMA to fill
+        ASSERT_EQ(audio_dma_ring_num_blocks_available(), 1);
+        ASSERT_EQ(audio_dma_ring_consume(), i % 5); // the index of the block that was just filled
+        ASSERT_EQ(audio_dma_ring_num_blocks_available(), 0);
+    }
+
+    ASSERT_FALSE(audio_dma_ring_overrun_occured());
+}
+
+TEST(AudioDMARingTest, overrun_is_flagged_when_the_dma_starts_filling_an_unconsumed_block)
+{
+    audio_dma_ring_reset(4);
+
+    // three full blocks waiting, the DMA is filling the fourth which is free
+    audio_dma_ring_produce();
+    audio_dma_ring_produce();
+    audio_dma_ring_produce();
+    ASSERT_FALSE(audio_dma_ring_overrun_occured());
+
+    // four full blocks waiting, the DMA wraps around onto block 0 which was never consumed
+    audio_dma_ring_produce();
+    ASSERT_TRUE(audio_dma_ring_overrun_occured());
+    ASSERT_EQ(audio_dma_ring_get_stats()->num_overruns, 1);
+
+    audio_dma_ring_clear_overrun();
+    ASSERT_FALSE(audio_dma_ring_overrun_occured());
+    ASSERT_EQ(audio_dma_ring_get_stats()->num_overruns, 1); // clearing the flag keeps the count
+}
+
+TEST(AudioDMARingTest, peak_occupancy_is_the_most_blocks_ever_waiting)
+{
+    audio_dma_ring_reset(8);
+
+    audio_dma_ring_produce();
+    audio_dma_ring_produce();
+    audio_dma_ring_produce();
+    audio_dma_ring_consume();
+    audio_dma_ring_consume();
+    audio_dma_ring_produce();
+
+    ASSERT_EQ(audio_dma_ring_get_stats()->peak_occupancy_in_blocks, 3);
+    ASSERT_EQ(audio_dma_ring_get_stats()->num_blocks_produced, 4);
+    ASSERT_EQ(audio_dma_ring_get_stats()->num_blocks_consumed, 2);
+}
+
+TEST(AudioDMARingTest, lag_histogram_counts_blocks_waiting_behind_each_consumed_block)
+{
+    audio_dma_ring_reset(8);
+
+    // keeping up, nothing waiting behind the consumed block
+    audio_dma_ring_produce();
+    audio_dma_ring_consume();
+
+    // fall 2 blocks behind, then catch up
+    audio_dma_ring_produce();
+    audio_dma_ring_produce();
+    audio_dma_ring_produce();
+    audio_dma_ring_consume(); // 2 waiting behind
+    audio_dma_ring_consume(); // 1 waiting behind
+    audio_dma_ring_consume(); // 0 waiting behind
+
+    const Audio_DMA_Ring_Stats_t *stats = audio_dma_ring_get_stats();
+    ASSERT_EQ(stats->lag_histogram[0], 2);
+    ASSERT_EQ(stats->lag_histogram[1], 1);
+    ASSERT_EQ(stats->lag_histogram[2], 1);
+    ASSERT_EQ(stats->lag_histogram[3], 0);
+}
+
+TEST(AudioDMARingTest, drain_time_is_measured_from_the_start_of_a_stall_until_the_ring_is_empty)
+{
+    audio_dma_ring_reset(8);
+
+    audio_dma_ring_produce();
+    audio_dma_ring_produce(); // the stall starts here, 2 blocks waiting
+    audio_dma_ring_produce();
+    audio_dma_ring_consume();
+    audio_dma_ring_produce();
+    audio_dma_ring_consume();
+    audio_dma_ring_consume();
+    audio_dma_ring_consume(); // empty again, 2 block periods after the stall started
+
+    const Audio_DMA_Ring_Stats_t *stats = audio_dma_ring_get_stats();
+    ASSERT_EQ(stats->num_stalls, 1);
+    ASSERT_EQ(stats->max_drain_time_in_blocks, 2);
+    ASSERT_EQ(stats->total_drain_time_in_blocks, 2);
+    ASSERT_EQ(stats->drain_time_histogram[2], 1);
+}
+
+TEST(AudioDMARingTest, long_lags_and_drain_times_land_in_the_last_histogram_bin)
+{
+    const uint32_t deep = AUDIO_DMA_RING_LAG_HISTOGRAM_NUM_BINS + 8;
+    audio_dma_ring_reset(deep);
+
+    for (uint32_t i = 0; i < deep - 1; i++)
+    {
+        audio_dma_ring_produce();
+    }
+    for (uint32_t i = 0; i < deep - 1; i++)
+    {
+        audio_dma_ring_consume();
+    }
+
+    const Audio_DMA_Ring_Stats_t *stats = audio_dma_ring_get_stats();
+    ASSERT_EQ(stats->lag_histogram[AUDIO_DMA_RING_LAG_HISTOGRAM_NUM_BINS - 1], deep - AUDIO_DMA_RING_LAG_HISTOGRAM_NUM_BINS);
+    ASSERT_EQ(stats->drain_time_histogram[AUDIO_DMA_RING_DRAIN_HISTOGRAM_NUM_BINS - 1], 1);
+    ASSERT_FALSE(audio_dma_ring_overrun_occured());
+}
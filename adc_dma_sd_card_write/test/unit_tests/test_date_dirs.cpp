@@ -0,0 +1,155 @@
+/**
+ * The day directories are tested against the fake SD card in fake_sd_card.cpp, mounted as the only card unless a test
+ * sets up the SD card bank.
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <string>
+
+#include "fake_sd_card.hpp"
+
+extern "C"
+{
+#include "date_dirs.h"
+#include "scheduler.h"
+#include "storage_manager.h"
+#include "time_helpers.h"
+}
+
+using namespace testing;
+using namespace fake_sd_card;
+
+static const uint64_t MiB = 1024 * 1024;
+
+// a time on day `d` of month `m` (counting from 1) of year `y`
+static tm_t day(int year, int month, int mday, int hour = 0, int min = 0)
+{
+    tm_t t = time_helpers_get_default_time();
+    t.tm_year = year - 1900;
+    t.tm_mon = month - 1;
+    t.tm_mday = mday;
+    t.tm_hour = hour;
+    t.tm_min = min;
+    return t;
+}
+
+// the day directory for time `t`, as `date_dirs_make()` writes it
+static std::string make(const tm_t &time)
+{
+    char path_buff[DATE_DIRS_PREFIX_LEN + 1];
+    const size_t len = date_dirs_make(&time, path_buff);
+    EXPECT_EQ(len, (size_t)DATE_DIRS_PREFIX_LEN);
+    return path_buff;
+}
+
+class DateDirsTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        fake_sd_card::reset();
+        mount(SD_CARD_BANK_CARD_SLOT_0);
+        date_dirs_forget();
+    }
+};
+
+TEST_F(DateDirsTest, the_first_file_makes_the_year_month_and_day)
+{
+    ASSERT_EQ(make(day(2024, 1, 31, 23, 55)), "2024/01/31/");
+
+    ASSERT_THAT(mkdir_paths, ElementsAre("2024", "2024/01", "2024/01/31"));
+    ASSERT_THAT(cards[0].dirs, ElementsAre("2024", "2024/01", "2024/01/31"));
+}
+
+TEST_F(DateDirsTest, a_day_of_files_makes_its_directories_once)
+{
+    // 5 minute files
+    for (int min = 0; min < 24 * 60; min += 5)
+    {
+        ASSERT_EQ(make(day(2024, 9, 27, min / 60, min % 60)), "2024/09/27/");
+    }
+
+    ASSERT_EQ(mkdir_paths.size(), 3u);
+}
+
+TEST_F(DateDirsTest, only_what_changed_is_made_at_midnight)
+{
+    make(day(2023, 12, 30));
+    mkdir_paths.clear();
+
+    make(day(2023, 12, 31));
+    ASSERT_THAT(mkdir_paths, ElementsAre("2023/12/31"));
+
+    make(day(2024, 1, 1));
+    ASSERT_THAT(mkdir_paths, ElementsAre("2023/12/31", "2024", "2024/01", "2024/01/01"));
+
+    make(day(2024, 2, 1));
+    ASSERT_THAT(mkdir_paths, ElementsAre("2023/12/31", "2024", "2024/01", "2024/01/01", "2024/02", "2024/02/01"));
+}
+
+TEST_F(DateDirsTest, forgetting_makes_the_directories_again)
+{
+    make(day(2024, 1, 31));
+    date_dirs_forget();
+
+    // they are already there, which is fine
+    ASSERT_EQ(make(day(2024, 1, 31)), "2024/01/31/");
+    ASSERT_EQ(mkdir_paths.size(), 6u);
+    ASSERT_EQ(cards[0].dirs.size(), 3u);
+}
+
+TEST_F(DateDirsTest, the_latest_day_is_found_by_name)
+{
+    cards[0].dirs = {"2023", "2023/12", "2023/12/31",
+                     "2024", "2024/01", "2024/01/02", "2024/01/10", "2024/01/09", "2024/notes",
+                     "384k-24bit", "20250"};
+    cards[0].files = {"2024/01/31", "2024/01/10/20240110_000000.wav"};
+
+    char path_buff[1 + DATE_DIRS_PREFIX_LEN + 1];
+    ASSERT_TRUE(date_dirs_find_latest("/", path_buff));
+    ASSERT_STREQ(path_buff, "/2024/01/10");
+}
+
+TEST_F(DateDirsTest, the_latest_day_is_found_under_a_directory)
+{
+    cards[0].dirs = {"384k-24bit", "384k-24bit/2024", "384k-24bit/2024/02", "384k-24bit/2024/02/29", "2025"};
+
+    char path_buff[32];
+    ASSERT_TRUE(date_dirs_find_latest("/384k-24bit", path_buff));
+    ASSERT_STREQ(path_buff, "/384k-24bit/2024/02/29");
+}
+
+TEST_F(DateDirsTest, there_is_no_latest_day_without_a_whole_day_directory)
+{
+    char path_buff[32];
+    ASSERT_FALSE(date_dirs_find_latest("/", path_buff));
+
+    // a year with no months in it
+    cards[0].dirs = {"2024", "384k-24bit"};
+    ASSERT_FALSE(date_dirs_find_latest("/", path_buff));
+}
+
+TEST_F(DateDirsTest, the_next_card_of_the_bank_gets_the_directories_too)
+{
+    fake_sd_card::reset();
+    scheduler_reset();
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (10 * MiB)};
+    cards[1] = {true, true, 100 * MiB};
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+
+    ASSERT_EQ(storage_manager_make_room(10 * MiB, NULL), STORAGE_MANAGER_ERROR_ALL_OK);
+    make(day(2024, 1, 31));
+    cards[mounted_slot()].free_bytes -= 10 * MiB;
+
+    // the next card is mounted once it has settled
+    ASSERT_EQ(storage_manager_make_room(10 * MiB, NULL), STORAGE_MANAGER_ERROR_SWITCH_PENDING);
+    scheduler_tick(STORAGE_MANAGER_CARD_SETTLE_TIME_IN_MILLISECS);
+    ASSERT_TRUE(scheduler_run_once());
+    ASSERT_EQ(mounted_slot(), SD_CARD_BANK_CARD_SLOT_1);
+    make(day(2024, 1, 31));
+
+    ASSERT_THAT(cards[0].dirs, ElementsAre("2024", "2024/01", "2024/01/31"));
+    ASSERT_THAT(cards[1].dirs, ElementsAre("2024", "2024/01", "2024/01/31"));
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "fake_cycle_counter.hpp"
+
+extern "C"
+{
+#include "duty_cycle.h"
+#include "hal_sleep.h"
+#include "hal_timer.h"
+#include "scheduler.h"
+}
+
+using namespace testing;
+
+static const uint32_t CYCLES_PER_MICROSEC = fake_cycle_counter::FREQ_HZ / 1000000;
+
+// the core sleeps for this long each time it waits for an interrupt
+static uint32_t sleep_cycles;
+static uint32_t num_waits;
+static bool is_masked;
+static bool was_masked_while_waiting;
+
+// the tick the core sleeps through is held off for at most this long, and the clock catches up this much when it wakes
+static uint32_t suppressed_microsecs;
+static uint32_t microsecs_suppressed_while_waiting;
+static uint32_t millisecs_slept;
+
+extern "C"
+{
+    void hal_sleep_mask_interrupts()
+    {
+        is_masked = true;
+    }
+
+    void hal_sleep_wait_for_interrupt()
+    {
+        was_masked_while_waiting = is_masked;
+        microsecs_suppressed_while_waiting = suppressed_microsecs;
+        num_waits += 1;
+        fake_cycle_counter::now += sleep_cycles;
+    }
+
+    void hal_sleep_unmask_interrupts()
+    {
+        is_masked = false;
+    }
+
+    void hal_timer_suppress_tick(uint32_t max_microsecs)
+    {
+        suppressed_microsecs = max_microsecs;
+    }
+
+    void hal_timer_resume_tick()
+    {
+        suppressed_microsecs = 0;
+        scheduler_tick(millisecs_slept);
+    }
+}
+
+static Scheduler_Task_t task;
+static Scheduler_Timer_t timer;
+
+static void handle_nothing(Scheduler_Events_t events)
+{
+    (void)events;
+}
+
+class DutyCycleTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        // time only moves on when a test says so
+        fake_cycle_counter::reset();
+        fake_cycle_counter::cycles_per_read = 0;
+
+        sleep_cycles = 0;
+        num_waits = 0;
+        is_masked = false;
+        was_masked_while_waiting = false;
+        suppressed_microsecs = 0;
+        microsecs_suppressed_while_waiting = 0;
+        millisecs_slept = 0;
+
+        scheduler_reset();
+        scheduler_add_task(handle_nothing, SCHEDULER_PRIORITY_NORMAL, &task);
+
+        duty_cycle_reset();
+    }
+
+    void stay_awake_for(uint32_t microsecs)
+    {
+        fake_cycle_counter::now += microsecs * CYCLES_PER_MICROSEC;
+    }
+};
+
+TEST_F(DutyCycleTest, sleeps_with_interrupts_masked_only_when_the_scheduler_is_idle)
+{
+    scheduler_post(task, 0x1);
+    duty_cycle_sleep_while_idle();
+    ASSERT_EQ(num_waits, 0u);
+    ASSERT_FALSE(is_masked);
+
+    scheduler_run_once();
+    duty_cycle_sleep_while_idle();
+    ASSERT_EQ(num_waits, 1u);
+    ASSERT_TRUE(was_masked_while_waiting);
+    ASSERT_FALSE(is_masked);
+
+    ASSERT_EQ(duty_cycle_num_sleeps(), 1u);
+}
+
+TEST_F(DutyCycleTest, only_counts_the_time_awake)
+{
+    sleep_cycles = 17000 * CYCLES_PER_MICROSEC;
+
+    // two blocks that take 3ms each to process, with the rest of the block period asleep
+    stay_awake_for(3000);
+    duty_cycle_sleep_while_idle();
+    stay_awake_for(3000);
+    duty_cycle_sleep_while_idle();
+
+    ASSERT_EQ(duty_cycle_awake_microsecs(), 6000u);
+
+    // the core is awake while it is asked, so the time since it woke up counts too
+    stay_awake_for(500);
+    ASSERT_EQ(duty_cycle_awake_microsecs(), 6500u);
+    ASSERT_EQ(duty_cycle_num_sleeps(), 2u);
+}
+
+TEST_F(DutyCycleTest, the_time_awake_is_right_across_the_wrap_of_the_cycle_counter)
+{
+    fake_cycle_counter::now = UINT32_MAX - (1000 * CYCLES_PER_MICROSEC) + 1;
+    duty_cycle_reset();
+
+    stay_awake_for(3000);
+    ASSERT_EQ(duty_cycle_awake_microsecs(), 3000u);
+}
+
+TEST_F(DutyCycleTest, reset_forgets_the_time_awake_and_the_sleeps)
+{
+    stay_awake_for(3000);
+    duty_cycle_sleep_while_idle();
+
+    duty_cycle_reset();
+
+    ASSERT_EQ(duty_cycle_awake_microsecs(), 0u);
+    ASSERT_EQ(duty_cycle_num_sleeps(), 0u);
+}
+
+TEST_F(DutyCycleTest, holds_the_tick_off_while_asleep_until_the_next_timer_is_due)
+{
+    scheduler_add_timer(task, 0x2, &timer);
+    scheduler_timer_start(timer, 50, 0);
+    scheduler_tick(20);
+
+    // the core sleeps through the 30 ticks before the timer is due, and the clock catches up with them when it wakes
+    millisecs_slept = 30;
+    duty_cycle_sleep_while_idle();
+    ASSERT_EQ(microsecs_suppressed_while_waiting, 30000u);
+    ASSERT_EQ(suppressed_microsecs, 0u);
+    ASSERT_EQ(scheduler_get_millisecs(), 50u);
+    ASSERT_EQ(scheduler_get_millisecs_to_next_timer(), 0u);
+}
+
+TEST_F(DutyCycleTest, holds_the_tick_off_for_as_long_as_it_can_when_no_timer_is_running)
+{
+    duty_cycle_sleep_while_idle();
+    ASSERT_EQ(microsecs_suppressed_while_waiting, UINT32_MAX);
+
+    // a timer further off than the tick can be held off for
+    scheduler_add_timer(task, 0x2, &timer);
+    scheduler_timer_start(timer, UINT32_MAX / 1000 + 1, 0);
+    duty_cycle_sleep_while_idle();
+    ASSERT_EQ(microsecs_suppressed_while_waiting, UINT32_MAX);
+}
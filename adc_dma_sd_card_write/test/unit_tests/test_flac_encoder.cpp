@@ -0,0 +1,429 @@
+/**
+ * The frames are checked by decoding them with the small FLAC decoder below, which only understands what the encoder
+ * writes (mono, fixed and verbatim subframes, Rice coded residuals) and checks both CRCs. While viewing or modifying
+ * this file it may help to have the FLAC format open, for example: https://www.rfc-editor.org/rfc/rfc9639
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+extern "C"
+{
+#include "flac_encoder.h"
+}
+
+using namespace testing;
+
+/**
+ * @brief A reader of big-endian bit fields is represented here.
+ */
+struct Bit_Reader
+{
+    const uint8_t *data;
+    uint32_t len_in_bytes;
+    uint64_t pos_in_bits = 0;
+
+    uint32_t read(uint32_t num_bits)
+    {
+        uint32_t val = 0;
+        for (uint32_t i = 0; i < num_bits; i++)
+        {
+            const uint64_t byte = pos_in_bits / 8;
+            EXPECT_LT(byte, len_in_bytes);
+            const uint32_t bit = byte < len_in_bytes ? (data[byte] >> (7 - (pos_in_bits % 8))) & 1 : 0;
+            val = (val << 1) | bit;
+            pos_in_bits += 1;
+        }
+        return val;
+    }
+
+    int32_t read_signed(uint32_t num_bits)
+    {
+        const uint32_t val = read(num_bits);
+        return (int32_t)(val << (32 - num_bits)) >> (32 - num_bits);
+    }
+
+    uint32_t byte_pos()
+    {
+        return (uint32_t)((pos_in_bits + 7) / 8);
+    }
+};
+
+// the CRCs are worked out a bit at a time here, unlike the table driven ones in the encoder
+static uint32_t crc(const uint8_t *data, uint32_t len, uint32_t poly, uint32_t width)
+{
+    const uint32_t top_bit = 1u << (width - 1);
+    const uint32_t mask = (width == 32) ? 0xFFFFFFFF : ((1u << width) - 1);
+    uint32_t crc = 0;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= (uint32_t)data[i] << (width - 8);
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc & top_bit) ? ((crc << 1) ^ poly) : (crc << 1);
+            crc &= mask;
+        }
+    }
+
+    return crc;
+}
+
+static uint32_t crc8(const uint8_t *data, uint32_t len)
+{
+    return crc(data, len, 0x07, 8);
+}
+
+static uint32_t crc16(const uint8_t *data, uint32_t len)
+{
+    return crc(data, len, 0x8005, 16);
+}
+
+/**
+ * @brief A decoded frame is represented here.
+ */
+struct Decoded_Frame
+{
+    uint64_t first_sample_number;
+    uint32_t bits_per_sample;
+    uint32_t subframe_type;
+    std::vector<int32_t> samples;
+};
+
+// decodes the frame of `len` bytes in `frame`, failing the test if anything is off
+static Decoded_Frame decode_frame(const uint8_t *frame, uint32_t len)
+{
+    Decoded_Frame decoded;
+    Bit_Reader reader = {frame, len};
+
+    EXPECT_EQ(reader.read(14), 0x3FFE); // sync code
+    EXPECT_EQ(reader.read(1), 0);       // reserved
+    EXPECT_EQ(reader.read(1), 1);       // variable block size
+
+    const uint32_t block_size_code = reader.read(4);
+    EXPECT_EQ(reader.read(4), 0); // sample rate from STREAMINFO
+    EXPECT_EQ(reader.read(4), 0); // mono
+
+    const uint32_t sample_size_code = reader.read(3);
+    EXPECT_TRUE(sample_size_code == 4 || sample_size_code == 6);
+    decoded.bits_per_sample = sample_size_code == 4 ? 16 : 24;
+    EXPECT_EQ(reader.read(1), 0);
+
+    // the UTF-8 like coded sample number
+    const uint32_t lead = reader.read(8);
+    uint32_t num_continuation_bytes = 0;
+    while (num_continuation_bytes < 7 && (lead & (0x80 >> num_continuation_bytes)))
+    {
+        num_continuation_bytes += 1;
+    }
+    EXPECT_NE(num_continuation_bytes, 1);
+    num_continuation_bytes = num_continuation_bytes == 0 ? 0 : num_continuation_bytes - 1;
+
+    uint64_t sample_number = lead & (0x7F >> num_continuation_bytes);
+    for (uint32_t i = 0; i < num_continuation_bytes; i++)
+    {
+        const uint32_t byte = reader.read(8);
+        EXPECT_EQ(byte & 0xC0, 0x80);
+        sample_number = (sample_number << 6) | (byte & 0x3F);
+    }
+    decoded.first_sample_number = sample_number;
+
+    EXPECT_TRUE(block_size_code == 6 || block_size_code == 7);
+    const uint32_t num_samples = reader.read(block_size_code == 6 ? 8 : 16) + 1;
+
+    const uint32_t header_len = reader.byte_pos();
+    EXPECT_EQ(reader.read(8), crc8(frame, header_len));
+
+    // the subframe
+    EXPECT_EQ(reader.read(1), 0);
+    decoded.subframe_type = reader.read(6);
+    EXPECT_EQ(reader.read(1), 0); // no wasted bits
+
+    const uint32_t bits = decoded.bits_per_sample;
+
+    if (decoded.subframe_type == 1)
+    {
+        for (uint32_t i = 0; i < num_samples; i++)
+        {
+            decoded.samples.push_back(reader.read_signed(bits));
+        }
+    }
+    else
+    {
+        EXPECT_EQ(decoded.subframe_type & 0x38, 0x08);
+        const uint32_t order = decoded.subframe_type & 0x07;
+        EXPECT_LE(order, 4);
+
+        for (uint32_t i = 0; i < order; i++)
+        {
+            decoded.samples.push_back(reader.read_signed(bits));
+        }
+
+        const uint32_t coding_method = reader.read(2);
+        EXPECT_LE(coding_method, 1);
+        const uint32_t param_len = coding_method == 0 ? 4 : 5;
+        const uint32_t partition_order = reader.read(4);
+        const uint32_t num_partitions = 1u << partition_order;
+        EXPECT_EQ(num_samples % num_partitions, 0);
+
+        for (uint32_t j = 0; j < num_partitions; j++)
+        {
+            const uint32_t param = reader.read(param_len);
+            EXPECT_NE(param, (1u << param_len) - 1); // no escape codes
+
+            const uint32_t num_residuals = (num_samples >> partition_order) - (j == 0 ? order : 0);
+            for (uint32_t i = 0; i < num_residuals; i++)
+            {
+                uint32_t quotient = 0;
+                while (reader.read(1) == 0)
+                {
+                    quotient += 1;
+                }
+                const uint32_t folded = (quotient << param) | reader.read(param);
+                const int32_t residual = (folded & 1) ? -(int32_t)(folded >> 1) - 1 : (int32_t)(folded >> 1);
+
+                // the fixed predictors, see RFC 9639 section 9.2.5
+                const size_t n = decoded.samples.size();
+                int64_t prediction = 0;
+                switch (order)
+                {
+                case 1:
+                    prediction = decoded.samples[n - 1];
+                    break;
+                case 2:
+                    prediction = 2 * (int64_t)decoded.samples[n - 1] - decoded.samples[n - 2];
+                    break;
+                case 3:
+                    prediction = 3 * (int64_t)decoded.samples[n - 1] - 3 * (int64_t)decoded.samples[n - 2] + decoded.samples[n - 3];
+                    break;
+                case 4:
+                    prediction = 4 * (int64_t)decoded.samples[n - 1] - 6 * (int64_t)decoded.samples[n - 2] + 4 * (int64_t)decoded.samples[n - 3] - decoded.samples[n - 4];
+                    break;
+                }
+                decoded.samples.push_back((int32_t)(prediction + residual));
+            }
+        }
+    }
+
+    // the frame is padded to a whole byte, then ends with its CRC-16
+    const uint32_t padding_bits = (8 - (reader.pos_in_bits % 8)) % 8;
+    EXPECT_EQ(reader.read(padding_bits), 0);
+
+    const uint32_t frame_len = reader.byte_pos();
+    EXPECT_EQ(frame_len + 2, len);
+    EXPECT_EQ(reader.read(16), crc16(frame, frame_len));
+
+    return decoded;
+}
+
+// packs the samples little-endian into `b` bytes each, like the audio data of a WAVE file
+static std::vector<uint8_t> pack(const std::vector<int32_t> &samples, uint32_t bits_per_sample)
+{
+    std::vector<uint8_t> packed;
+    for (int32_t sample : samples)
+    {
+        for (uint32_t b = 0; b < bits_per_sample / 8; b++)
+        {
+            packed.push_back((uint8_t)(sample >> (8 * b)));
+        }
+    }
+    return packed;
+}
+
+// encodes the samples as one frame, checks it fits in the max frame length, and decodes it again
+static Decoded_Frame round_trip(const std::vector<int32_t> &samples, uint32_t bits_per_sample, uint64_t first_sample_number, uint32_t *frame_len = nullptr)
+{
+    const std::vector<uint8_t> pcm = pack(samples, bits_per_sample);
+
+    // a guard past the end of the max frame length catches overruns
+    const uint32_t max_len = FLAC_ENCODER_MAX_FRAME_LEN_IN_BYTES((uint32_t)samples.size(), bits_per_sample);
+    std::vector<uint8_t> frame(max_len + 16, 0xA5);
+
+    const uint32_t len = flac_encoder_encode_frame(pcm.data(), (uint32_t)samples.size(), bits_per_sample, first_sample_number, frame.data());
+
+    EXPECT_LE(len, max_len);
+    for (uint32_t i = max_len; i < frame.size(); i++)
+    {
+        EXPECT_EQ(frame[i], 0xA5);
+    }
+
+    if (frame_len != nullptr)
+    {
+        *frame_len = len;
+    }
+
+    return decode_frame(frame.data(), len);
+}
+
+static std::vector<int32_t> sine(uint32_t num_samples, double amplitude, double cycles_per_sample)
+{
+    std::vector<int32_t> samples;
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        samples.push_back((int32_t)std::lround(amplitude * std::sin(2 * M_PI * cycles_per_sample * i)));
+    }
+    return samples;
+}
+
+static std::vector<int32_t> white_noise(uint32_t num_samples, uint32_t bits_per_sample)
+{
+    std::srand(1234);
+    std::vector<int32_t> samples;
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        const int32_t full_scale = 1 << (bits_per_sample - 1);
+        samples.push_back((int32_t)(((uint32_t)std::rand() ^ ((uint32_t)std::rand() << 15)) % (2u * full_scale)) - full_scale);
+    }
+    return samples;
+}
+
+TEST(FlacEncoderTest, decoder_crcs_match_the_check_values)
+{
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+    ASSERT_EQ(crc8(check, sizeof(check)), 0xF4);
+    ASSERT_EQ(crc16(check, sizeof(check)), 0xFEE8);
+}
+
+TEST(FlacEncoderTest, stream_header_is_the_marker_and_a_last_streaminfo_block)
+{
+    uint8_t header[FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES];
+    const Flac_Encoder_Stream_Info_t info = {.sample_rate = 384000, .bits_per_sample = 24, .max_block_len_in_samples = 8271, .total_samples = 384000};
+
+    ASSERT_EQ(flac_encoder_write_stream_header(&info, header), FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES);
+
+    ASSERT_EQ(header[0], 'f');
+    ASSERT_EQ(header[1], 'L');
+    ASSERT_EQ(header[2], 'a');
+    ASSERT_EQ(header[3], 'C');
+
+    Bit_Reader reader = {header + 4, FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES - 4};
+    ASSERT_EQ(reader.read(1), 1);  // last metadata block
+    ASSERT_EQ(reader.read(7), 0);  // STREAMINFO
+    ASSERT_EQ(reader.read(24), 34); // length
+}
+
+TEST(FlacEncoderTest, streaminfo_holds_the_stream_info)
+{
+    uint8_t header[FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES];
+
+    // more samples than fit in 32 bits
+    const Flac_Encoder_Stream_Info_t info = {.sample_rate = 192000, .bits_per_sample = 16, .max_block_len_in_samples = 4143, .total_samples = 0x923456789ull};
+    flac_encoder_write_stream_header(&info, header);
+
+    Bit_Reader reader = {header + 8, FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES - 8};
+    ASSERT_EQ(reader.read(16), FLAC_ENCODER_MIN_BLOCK_LEN_IN_SAMPLES);
+    ASSERT_EQ(reader.read(16), 4143);
+    ASSERT_EQ(reader.read(24), 0); // unknown frame lengths
+    ASSERT_EQ(reader.read(24), 0);
+    ASSERT_EQ(reader.read(20), 192000);
+    ASSERT_EQ(reader.read(3), 0);  // one channel
+    ASSERT_EQ(reader.read(5), 15); // bits per sample - 1
+    ASSERT_EQ(reader.read(4), 0x9);
+    ASSERT_EQ(reader.read(32), 0x23456789);
+
+    // no MD5
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(reader.read(32), 0);
+    }
+}
+
+TEST(FlacEncoderTest, a_16_bit_sine_round_trips_and_compresses)
+{
+    const std::vector<int32_t> samples = sine(8256, 20000, 1000.0 / 384000);
+
+    uint32_t len;
+    const Decoded_Frame decoded = round_trip(samples, 16, 0, &len);
+
+    ASSERT_EQ(decoded.samples, samples);
+    ASSERT_EQ(decoded.bits_per_sample, 16);
+    ASSERT_NE(decoded.subframe_type, 1); // not verbatim
+
+    // less than half the size of the PCM
+    ASSERT_LT(len, (samples.size() * 2) / 2);
+}
+
+TEST(FlacEncoderTest, a_24_bit_sine_round_trips_and_compresses)
+{
+    const std::vector<int32_t> samples = sine(4128, 8000000, 3000.0 / 192000);
+
+    uint32_t len;
+    const Decoded_Frame decoded = round_trip(samples, 24, 0, &len);
+
+    ASSERT_EQ(decoded.samples, samples);
+    ASSERT_EQ(decoded.bits_per_sample, 24);
+    ASSERT_NE(decoded.subframe_type, 1);
+    ASSERT_LT(len, (samples.size() * 3) / 2);
+}
+
+TEST(FlacEncoderTest, silence_takes_about_a_bit_per_sample)
+{
+    const std::vector<int32_t> samples(8256, 0);
+
+    uint32_t len;
+    const Decoded_Frame decoded = round_trip(samples, 24, 0, &len);
+
+    ASSERT_EQ(decoded.samples, samples);
+    ASSERT_LT(len, (8256 / 8) + 64);
+}
+
+TEST(FlacEncoderTest, white_noise_falls_back_to_verbatim)
+{
+    for (uint32_t bits : {16u, 24u})
+    {
+        const std::vector<int32_t> samples = white_noise(2064, bits);
+
+        uint32_t len;
+        const Decoded_Frame decoded = round_trip(samples, bits, 0, &len);
+
+        ASSERT_EQ(decoded.samples, samples);
+        ASSERT_EQ(decoded.subframe_type, 1);
+    }
+}
+
+TEST(FlacEncoderTest, full_scale_steps_round_trip)
+{
+    // the biggest residuals a fixed predictor can see, a single outlier in an otherwise quiet block
+    std::vector<int32_t> samples(1032, 0);
+    samples[500] = 0x7FFFFF;
+    samples[501] = -0x800000;
+    samples[502] = 0x7FFFFF;
+
+    ASSERT_EQ(round_trip(samples, 24, 0).samples, samples);
+
+    std::vector<int32_t> alternating;
+    for (uint32_t i = 0; i < 516; i++)
+    {
+        alternating.push_back(i % 2 ? 32767 : -32768);
+    }
+
+    ASSERT_EQ(round_trip(alternating, 16, 0).samples, alternating);
+}
+
+TEST(FlacEncoderTest, frames_of_any_length_round_trip)
+{
+    // short last frames, frames that can't be split into partitions, and a block with samples carried in front of it
+    for (uint32_t num_samples : {1u, 2u, 3u, 5u, 15u, 16u, 17u, 127u, 256u, 257u, 1031u, 8271u})
+    {
+        const std::vector<int32_t> samples = sine(num_samples, 1000000, 0.01);
+
+        const Decoded_Frame decoded = round_trip(samples, 24, 0);
+        ASSERT_EQ(decoded.samples, samples) << num_samples << " samples";
+    }
+}
+
+TEST(FlacEncoderTest, the_first_sample_number_is_coded_in_the_frame_header)
+{
+    const std::vector<int32_t> samples = sine(64, 1000, 0.01);
+
+    // every length of the UTF-8 like coding, up to the 36 bits of the sample count in STREAMINFO
+    for (uint64_t sample_number : {0ull, 127ull, 128ull, 2047ull, 2048ull, 65536ull, 1ull << 21, 1ull << 26, 1ull << 31, (1ull << 36) - 1})
+    {
+        ASSERT_EQ(round_trip(samples, 16, sample_number).first_sample_number, sample_number);
+    }
+}
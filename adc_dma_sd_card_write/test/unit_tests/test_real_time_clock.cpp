@@ -0,0 +1,149 @@
+/**
+ * The real time clock driver is tested against a fake DS3231 on a fake I2C bus, defined here in place of the HAL.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+extern "C"
+{
+#include "hal_gpio.h"
+#include "hal_i2c.h"
+#include "real_time_clock.h"
+}
+
+using namespace testing;
+
+static const uint8_t DS3231_ADDR = 0x68;
+static const uint32_t DS3231_NUM_REGS = 0x13;
+
+// the registers of the fake DS3231, and the register the next byte goes to or comes from
+static uint8_t ds3231_regs[DS3231_NUM_REGS];
+static uint8_t ds3231_reg_pointer;
+
+static bool nack_everything;
+static Hal_I2C_Bus_t last_bus;
+
+extern "C"
+{
+    Hal_I2C_Error_t hal_i2c_write_read(Hal_I2C_Bus_t bus, uint8_t addr, const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len)
+    {
+        last_bus = bus;
+
+        if (nack_everything || addr != DS3231_ADDR)
+        {
+            return HAL_I2C_ERROR_TRANSACTION_ERROR;
+        }
+
+        // the first byte written sets the register pointer, which advances with every byte after it
+        for (uint32_t i = 0; i < tx_len; i++)
+        {
+            if (i == 0)
+            {
+                ds3231_reg_pointer = tx_buff[0];
+            }
+            else
+            {
+                ds3231_regs[ds3231_reg_pointer++ % DS3231_NUM_REGS] = tx_buff[i];
+            }
+        }
+
+        for (uint32_t i = 0; i < rx_len; i++)
+        {
+            rx_buff[i] = ds3231_regs[ds3231_reg_pointer++ % DS3231_NUM_REGS];
+        }
+
+        return HAL_I2C_ERROR_ALL_OK;
+    }
+
+    Hal_I2C_Error_t hal_i2c_write(Hal_I2C_Bus_t bus, uint8_t addr, const uint8_t *tx_buff, uint32_t tx_len)
+    {
+        return hal_i2c_write_read(bus, addr, tx_buff, tx_len, NULL, 0);
+    }
+
+    Hal_GPIO_Error_t hal_gpio_config(const Hal_GPIO_Pin_t *pin)
+    {
+        (void)pin;
+        return HAL_GPIO_ERROR_ALL_OK;
+    }
+}
+
+class RealTimeClockTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        memset(ds3231_regs, 0, sizeof(ds3231_regs));
+        ds3231_reg_pointer = 0;
+        nack_everything = false;
+
+        ASSERT_EQ(real_time_clock_init(HAL_I2C_BUS_1), REAL_TIME_CLOCK_ERROR_ALL_OK);
+    }
+};
+
+TEST_F(RealTimeClockTest, init_uses_the_int_pin_for_interrupts_and_enables_the_32kHz_output)
+{
+    ASSERT_EQ(last_bus, HAL_I2C_BUS_1);
+    ASSERT_EQ(ds3231_regs[0x0E], 1u << 2);
+    ASSERT_EQ(ds3231_regs[0x0F], 1u << 3);
+}
+
+TEST_F(RealTimeClockTest, datetime_round_trips_through_the_bcd_registers)
+{
+    tm_t t = {};
+    t.tm_year = 124; // 2024
+    t.tm_mon = 11;   // December
+    t.tm_mday = 31;
+    t.tm_hour = 23;
+    t.tm_min = 59;
+    t.tm_sec = 58;
+
+    ASSERT_EQ(real_time_clock_set_datetime(&t), REAL_TIME_CLOCK_ERROR_ALL_OK);
+
+    ASSERT_EQ(ds3231_regs[0x00], 0x58);
+    ASSERT_EQ(ds3231_regs[0x01], 0x59);
+    ASSERT_EQ(ds3231_regs[0x02], 0x23);
+    ASSERT_EQ(ds3231_regs[0x04], 0x31);
+    ASSERT_EQ(ds3231_regs[0x05], 0x80 | 0x12); // with the century bit
+    ASSERT_EQ(ds3231_regs[0x06], 0x24);
+
+    tm_t read_back = {};
+    ASSERT_EQ(real_time_clock_get_datetime(&read_back), REAL_TIME_CLOCK_ERROR_ALL_OK);
+
+    ASSERT_EQ(read_back.tm_year, t.tm_year);
+    ASSERT_EQ(read_back.tm_mon, t.tm_mon);
+    ASSERT_EQ(read_back.tm_mday, t.tm_mday);
+    ASSERT_EQ(read_back.tm_hour, t.tm_hour);
+    ASSERT_EQ(read_back.tm_min, t.tm_min);
+    ASSERT_EQ(read_back.tm_sec, t.tm_sec);
+}
+
+TEST_F(RealTimeClockTest, alarm_matches_the_date_and_time_and_enables_its_interrupt)
+{
+    tm_t t = {};
+    t.tm_mday = 7;
+    t.tm_hour = 12;
+    t.tm_min = 30;
+    t.tm_sec = 15;
+
+    ASSERT_EQ(real_time_clock_set_alarm(&t), REAL_TIME_CLOCK_ERROR_ALL_OK);
+
+    ASSERT_EQ(ds3231_regs[0x07], 0x15);
+    ASSERT_EQ(ds3231_regs[0x08], 0x30);
+    ASSERT_EQ(ds3231_regs[0x09], 0x12);
+    ASSERT_EQ(ds3231_regs[0x0A], 0x07);
+    ASSERT_EQ(ds3231_regs[0x0E], (1u << 2) | (1u << 0)); // INTCN and A1IE
+}
+
+TEST_F(RealTimeClockTest, i2c_errors_are_reported)
+{
+    nack_everything = true;
+
+    tm_t t = {};
+    t.tm_year = 124;
+
+    ASSERT_EQ(real_time_clock_set_datetime(&t), REAL_TIME_CLOCK_ERROR_I2C_ERROR);
+    ASSERT_EQ(real_time_clock_get_datetime(&t), REAL_TIME_CLOCK_ERROR_I2C_ERROR);
+    ASSERT_EQ(real_time_clock_set_alarm(&t), REAL_TIME_CLOCK_ERROR_I2C_ERROR);
+}
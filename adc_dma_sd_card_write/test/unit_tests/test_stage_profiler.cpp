@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <vector>
+
+#include "fake_cycle_counter.hpp"
+#include "fake_sd_card.hpp"
+
+extern "C"
+{
+#include "audio_dma.h"
+#include "stage_profiler.h"
+#include "trace_log.h"
+}
+
+using namespace testing;
+
+static const uint32_t CYCLES_PER_MICROSEC = fake_cycle_counter::FREQ_HZ / 1000000;
+
+class StageProfilerTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        fake_sd_card::reset();
+        fake_cycle_counter::reset();
+        stage_profiler_reset();
+    }
+
+    // times a call of `stage` that takes `n` cycles, the fake counter moves on by `n` between the begin and the end
+    void time_call(Stage_Profiler_Stage_t stage, uint32_t num_cycles)
+    {
+        fake_cycle_counter::cycles_per_read = num_cycles;
+        stage_profiler_begin(stage);
+        stage_profiler_end(stage);
+    }
+};
+
+TEST_F(StageProfilerTest, keeps_the_number_of_calls_and_the_min_mean_and_max_of_each_stage)
+{
+    time_call(STAGE_PROFILER_STAGE_DECIMATE, 2 * CYCLES_PER_MICROSEC);
+    time_call(STAGE_PROFILER_STAGE_DECIMATE, 1 * CYCLES_PER_MICROSEC);
+    time_call(STAGE_PROFILER_STAGE_DECIMATE, 3 * CYCLES_PER_MICROSEC);
+
+    const Stage_Profiler_Stats_t *stats = stage_profiler_get_stats(STAGE_PROFILER_STAGE_DECIMATE);
+    ASSERT_EQ(stats->num_calls, 3u);
+    ASSERT_EQ(stage_profiler_cycles_to_microsecs(stats->min_cycles), 1u);
+    ASSERT_EQ(stage_profiler_mean_microsecs(STAGE_PROFILER_STAGE_DECIMATE), 2u);
+    ASSERT_EQ(stage_profiler_cycles_to_microsecs(stats->max_cycles), 3u);
+
+    // the other stages are untouched
+    ASSERT_EQ(stage_profiler_get_stats(STAGE_PROFILER_STAGE_CONVERT)->num_calls, 0u);
+    ASSERT_EQ(stage_profiler_mean_microsecs(STAGE_PROFILER_STAGE_CONVERT), 0u);
+    ASSERT_EQ(stage_profiler_percentile_microsecs(STAGE_PROFILER_STAGE_CONVERT, 99), 0u);
+}
+
+TEST_F(StageProfilerTest, the_99th_percentile_leaves_out_the_slowest_one_percent_and_errs_long)
+{
+    for (int i = 0; i < 99; i++)
+    {
+        time_call(STAGE_PROFILER_STAGE_WRITE, 10 * CYCLES_PER_MICROSEC);
+    }
+    time_call(STAGE_PROFILER_STAGE_WRITE, 1000 * CYCLES_PER_MICROSEC);
+
+    // 960 cycles falls in the bin from 768 to 1023 cycles
+    ASSERT_EQ(stage_profiler_percentile_microsecs(STAGE_PROFILER_STAGE_WRITE, 99), (1023 * 1000000ull) / fake_cycle_counter::FREQ_HZ);
+    ASSERT_EQ(stage_profiler_percentile_microsecs(STAGE_PROFILER_STAGE_WRITE, 100), 1000u);
+
+    // the top of a bin is never more than the max
+    stage_profiler_reset();
+    time_call(STAGE_PROFILER_STAGE_WRITE, 10 * CYCLES_PER_MICROSEC);
+    ASSERT_EQ(stage_profiler_percentile_microsecs(STAGE_PROFILER_STAGE_WRITE, 99), 10u);
+}
+
+TEST_F(StageProfilerTest, calls_over_budget_are_counted_and_traced)
+{
+    const uint32_t budget_microsecs = stage_profiler_budget_microsecs(STAGE_PROFILER_STAGE_WRITE);
+    ASSERT_EQ(budget_microsecs, (AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS * STAGE_PROFILER_WRITE_BUDGET_IN_PERCENT) / 100);
+
+    fake_sd_card::mount(SD_CARD_BANK_CARD_SLOT_0);
+    trace_log_start("/trace_log.bin");
+
+    time_call(STAGE_PROFILER_STAGE_WRITE, budget_microsecs * CYCLES_PER_MICROSEC);
+    time_call(STAGE_PROFILER_STAGE_WRITE, (budget_microsecs * CYCLES_PER_MICROSEC) + 1);
+    time_call(STAGE_PROFILER_STAGE_HEADER, 1);
+
+    ASSERT_EQ(stage_profiler_get_stats(STAGE_PROFILER_STAGE_WRITE)->num_over_budget, 1u);
+    ASSERT_EQ(stage_profiler_get_stats(STAGE_PROFILER_STAGE_HEADER)->num_over_budget, 0u);
+
+    ASSERT_EQ(trace_log_close(), TRACE_LOG_ERROR_ALL_OK);
+
+    std::vector<Trace_Log_Record_t> over_budget;
+    for (size_t i = 0; i + sizeof(Trace_Log_Record_t) <= fake_sd_card::log_file.size(); i += sizeof(Trace_Log_Record_t))
+    {
+        Trace_Log_Record_t record;
+        memcpy(&record, &fake_sd_card::log_file[i], sizeof(record));
+        if (record.event == TRACE_LOG_EVENT_OVER_BUDGET)
+        {
+            over_budget.push_back(record);
+        }
+    }
+    ASSERT_THAT(over_budget, ElementsAre(Field(&Trace_Log_Record_t::arg, STAGE_PROFILER_STAGE_WRITE)));
+}
+
+TEST_F(StageProfilerTest, a_call_across_the_wrap_of_the_cycle_counter_is_timed_right)
+{
+    fake_cycle_counter::now = UINT32_MAX - 10;
+    time_call(STAGE_PROFILER_STAGE_CONVERT, 5 * CYCLES_PER_MICROSEC);
+
+    ASSERT_EQ(stage_profiler_cycles_to_microsecs(stage_profiler_get_stats(STAGE_PROFILER_STAGE_CONVERT)->max_cycles), 5u);
+}
+
+TEST_F(StageProfilerTest, stages_nest_inside_each_other)
+{
+    // a checkpoint rewrites the header in the middle of a write
+    fake_cycle_counter::cycles_per_read = CYCLES_PER_MICROSEC;
+    stage_profiler_begin(STAGE_PROFILER_STAGE_WRITE);
+    stage_profiler_begin(STAGE_PROFILER_STAGE_HEADER);
+    stage_profiler_end(STAGE_PROFILER_STAGE_HEADER);
+    stage_profiler_end(STAGE_PROFILER_STAGE_WRITE);
+
+    ASSERT_EQ(stage_profiler_mean_microsecs(STAGE_PROFILER_STAGE_HEADER), 1u);
+    ASSERT_EQ(stage_profiler_mean_microsecs(STAGE_PROFILER_STAGE_WRITE), 3u);
+}
@@ -0,0 +1,292 @@
+/**
+ * The storage manager is tested against the fake SD card bank in fake_sd_card.cpp.
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "fake_sd_card.hpp"
+
+extern "C"
+{
+#include "scheduler.h"
+#include "storage_manager.h"
+}
+
+using namespace testing;
+using namespace fake_sd_card;
+
+static const uint64_t MiB = 1024 * 1024;
+static const uint64_t GiB = 1024 * MiB;
+
+// how each switch to the next card went, in the order they were done
+static std::vector<Storage_Manager_Error_t> switch_errs;
+
+static void on_switch_done(Storage_Manager_Error_t err)
+{
+    switch_errs.push_back(err);
+}
+
+// makes room for a file of `l` bytes, waiting for the card to settle if it switches cards
+static Storage_Manager_Error_t make_room(uint64_t file_len)
+{
+    const Storage_Manager_Error_t err = storage_manager_make_room(file_len, on_switch_done);
+    if (err != STORAGE_MANAGER_ERROR_SWITCH_PENDING)
+    {
+        return err;
+    }
+
+    scheduler_tick(STORAGE_MANAGER_CARD_SETTLE_TIME_IN_MILLISECS);
+    while (scheduler_run_once())
+    {
+    }
+
+    return switch_errs.empty() ? err : switch_errs.back();
+}
+
+// makes room for a file of `l` bytes and writes `w` bytes of it to the mounted card, `l` by default
+static Storage_Manager_Error_t make_room_and_write(uint64_t file_len, uint64_t written_len = UINT64_MAX)
+{
+    const Storage_Manager_Error_t err = make_room(file_len);
+    if (err == STORAGE_MANAGER_ERROR_ALL_OK)
+    {
+        cards[mounted_slot()].free_bytes -= written_len == UINT64_MAX ? file_len : written_len;
+    }
+    return err;
+}
+
+/* Tests -------------------------------------------------------------------------------------------------------------*/
+
+class StorageManagerTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        fake_sd_card::reset();
+        scheduler_reset();
+        switch_errs.clear();
+    }
+};
+
+TEST_F(StorageManagerTest, init_mounts_the_first_card_with_room)
+{
+    cards[1] = {true, false, 100 * MiB}; // doesn't mount
+    cards[2] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES}; // full
+    cards[4] = {true, true, 100 * MiB};
+    cards[5] = {true, true, 100 * MiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_TRUE(storage_manager_is_enabled());
+    ASSERT_EQ(mounted_slot(), SD_CARD_BANK_CARD_SLOT_4);
+}
+
+TEST_F(StorageManagerTest, init_fails_when_every_card_is_full_or_missing)
+{
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES};
+    cards[3] = {true, false, 100 * MiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_CARDS_FULL);
+    ASSERT_FALSE(storage_manager_is_enabled());
+}
+
+TEST_F(StorageManagerTest, making_room_does_nothing_without_the_card_bank)
+{
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_CARDS_FULL);
+
+    const uint32_t num_reads = num_detect_pin_reads;
+    ASSERT_EQ(storage_manager_make_room(100 * MiB, on_switch_done), STORAGE_MANAGER_ERROR_ALL_OK);
+    storage_manager_look_ahead();
+    ASSERT_EQ(num_detect_pin_reads, num_reads);
+}
+
+TEST_F(StorageManagerTest, cards_fill_in_turn_and_switch_at_a_file_boundary)
+{
+    // room for 3 files of 10MiB on the first card and 2 on the second
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (35 * MiB)};
+    cards[1] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (20 * MiB)};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+
+    std::vector<int> slot_of_each_file;
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+        slot_of_each_file.push_back(mounted_slot());
+
+        // the card never changes while a file is written
+        storage_manager_look_ahead();
+        storage_manager_look_ahead();
+        ASSERT_EQ(mounted_slot(), slot_of_each_file.back());
+    }
+
+    ASSERT_THAT(slot_of_each_file, ElementsAre(0, 0, 0, 1, 1));
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_CARDS_FULL);
+}
+
+TEST_F(StorageManagerTest, the_next_card_is_looked_for_once_during_the_last_file_that_fits)
+{
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (25 * MiB)};
+    cards[1] = {true, true, 100 * MiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+    const uint32_t num_reads_after_init = num_detect_pin_reads;
+
+    // there is room for another file after the first, so there's nothing to look for
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+    storage_manager_look_ahead();
+    ASSERT_EQ(num_detect_pin_reads, num_reads_after_init);
+
+    // the second file is the last one that fits, the pins are read once however often the loop looks ahead
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+    for (int i = 0; i < 100; i++)
+    {
+        storage_manager_look_ahead();
+    }
+    ASSERT_EQ(num_detect_pin_reads, num_reads_after_init + 1);
+
+    // and the switch itself doesn't read them again
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(mounted_slot(), SD_CARD_BANK_CARD_SLOT_1);
+    ASSERT_EQ(num_detect_pin_reads, num_reads_after_init + 1);
+}
+
+TEST_F(StorageManagerTest, a_card_taken_out_after_boot_is_skipped)
+{
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (15 * MiB)};
+    cards[1] = {true, true, 100 * MiB};
+    cards[2] = {true, true, 100 * MiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+
+    cards[1].is_inserted = false;
+    storage_manager_look_ahead();
+
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(mounted_slot(), SD_CARD_BANK_CARD_SLOT_2);
+}
+
+TEST_F(StorageManagerTest, a_longer_file_than_expected_still_finds_a_card_with_room)
+{
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (15 * MiB)};
+    cards[1] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (15 * MiB)};
+    cards[2] = {true, true, 100 * MiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+    storage_manager_look_ahead();
+
+    // the look ahead picked slot 1 for a 10MiB file, a 20MiB one only fits on slot 2
+    ASSERT_EQ(make_room_and_write(20 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(mounted_slot(), SD_CARD_BANK_CARD_SLOT_2);
+}
+
+TEST_F(StorageManagerTest, the_directory_is_made_on_every_card)
+{
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (10 * MiB)};
+    cards[1] = {true, true, 100 * MiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(storage_manager_cd("384k-24bit"), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+
+    ASSERT_THAT(dirs_changed_into, ElementsAre("0:384k-24bit", "1:384k-24bit"));
+}
+
+TEST_F(StorageManagerTest, free_space_is_only_counted_at_boot)
+{
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (15 * MiB)};
+    cards[1] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (15 * MiB)};
+    cards[3] = {true, true, 100 * MiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(num_free_space_counts, 3u);
+
+    for (int i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+        storage_manager_look_ahead();
+    }
+
+    ASSERT_EQ(mounted_slot(), SD_CARD_BANK_CARD_SLOT_3);
+    ASSERT_EQ(num_free_space_counts, 3u);
+}
+
+TEST_F(StorageManagerTest, a_file_shorter_than_its_room_leaves_the_rest_for_the_next)
+{
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (25 * MiB)};
+    cards[1] = {true, true, 100 * MiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+
+    // each recording is cut short, so only what was written is gone from the card, 4 files fit where 2 were made room for
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(make_room_and_write(10 * MiB, 5 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+        ASSERT_EQ(mounted_slot(), SD_CARD_BANK_CARD_SLOT_0);
+    }
+
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(mounted_slot(), SD_CARD_BANK_CARD_SLOT_1);
+}
+
+TEST_F(StorageManagerTest, cards_bigger_than_4GiB_are_filled)
+{
+    cards[0] = {true, true, 64 * GiB};
+    cards[1] = {true, true, 64 * GiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+
+    std::vector<int> slot_of_each_file;
+    for (int i = 0; i < 14; i++)
+    {
+        ASSERT_EQ(make_room_and_write(5 * GiB), STORAGE_MANAGER_ERROR_ALL_OK);
+        slot_of_each_file.push_back(mounted_slot());
+    }
+
+    // 12 files of 5GiB fit on a 64GiB card, the 13th doesn't
+    ASSERT_EQ(std::count(slot_of_each_file.begin(), slot_of_each_file.end(), 0), 12);
+    ASSERT_EQ(cards[0].free_bytes, 4 * GiB);
+}
+
+TEST_F(StorageManagerTest, the_next_card_settles_while_the_other_tasks_run)
+{
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (10 * MiB)};
+    cards[1] = {true, true, 100 * MiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+
+    // the next card is powered up, but not mounted until it has settled
+    ASSERT_EQ(storage_manager_make_room(10 * MiB, on_switch_done), STORAGE_MANAGER_ERROR_SWITCH_PENDING);
+    ASSERT_EQ(active_slot, SD_CARD_BANK_CARD_SLOT_1);
+    ASSERT_FALSE(is_mounted);
+
+    scheduler_tick(STORAGE_MANAGER_CARD_SETTLE_TIME_IN_MILLISECS - 1);
+    ASSERT_FALSE(scheduler_run_once());
+    ASSERT_FALSE(is_mounted);
+
+    scheduler_tick(1);
+    ASSERT_TRUE(scheduler_run_once());
+    ASSERT_EQ(mounted_slot(), SD_CARD_BANK_CARD_SLOT_1);
+    ASSERT_THAT(switch_errs, ElementsAre(STORAGE_MANAGER_ERROR_ALL_OK));
+    ASSERT_EQ(storage_manager_get_max_switch_millisecs(), STORAGE_MANAGER_CARD_SETTLE_TIME_IN_MILLISECS);
+}
+
+TEST_F(StorageManagerTest, a_card_that_doesnt_mount_after_settling_is_reported)
+{
+    cards[0] = {true, true, STORAGE_MANAGER_MARGIN_IN_BYTES + (10 * MiB)};
+    cards[1] = {true, true, 100 * MiB};
+
+    ASSERT_EQ(storage_manager_init(), STORAGE_MANAGER_ERROR_ALL_OK);
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_ALL_OK);
+
+    cards[1].mounts = false;
+    ASSERT_EQ(make_room_and_write(10 * MiB), STORAGE_MANAGER_ERROR_SD_CARD_ERROR);
+    ASSERT_EQ(mounted_slot(), SD_CARD_BANK_ALL_SLOTS_DISABLED);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <vector>
+
+#include "fake_cycle_counter.hpp"
+#include "fake_sd_card.hpp"
+
+extern "C"
+{
+#include "audio_dma_ring.h"
+#include "trace_log.h"
+}
+
+using namespace testing;
+
+static const uint32_t RECORDS_PER_SECTOR = TRACE_LOG_SECTOR_LEN_IN_BYTES / TRACE_LOG_RECORD_LEN_IN_BYTES;
+static const uint32_t FLUSH_LEN_IN_RECORDS = TRACE_LOG_FLUSH_LEN_IN_SECTORS * RECORDS_PER_SECTOR;
+
+// the records in the log file, padding and all
+static std::vector<Trace_Log_Record_t> records_in_log()
+{
+    std::vector<Trace_Log_Record_t> records(fake_sd_card::log_file.size() / sizeof(Trace_Log_Record_t));
+    memcpy(records.data(), fake_sd_card::log_file.data(), records.size() * sizeof(Trace_Log_Record_t));
+    return records;
+}
+
+// the records in the log file with the given event
+static std::vector<Trace_Log_Record_t> records_in_log(Trace_Log_Event_t event)
+{
+    std::vector<Trace_Log_Record_t> records;
+    for (const Trace_Log_Record_t &record : records_in_log())
+    {
+        if (record.event == event)
+        {
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+class TraceLogTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        fake_sd_card::reset();
+        fake_sd_card::mount(SD_CARD_BANK_CARD_SLOT_0);
+        fake_cycle_counter::reset();
+        trace_log_start("/trace_log.bin");
+    }
+
+    // records `n` write starts, with the index of each one as its argument
+    void record_writes(uint32_t num_writes)
+    {
+        for (uint32_t i = 0; i < num_writes; i++)
+        {
+            trace_log_event(TRACE_LOG_EVENT_WRITE_START, (uint16_t)i);
+        }
+    }
+};
+
+TEST_F(TraceLogTest, nothing_is_written_until_a_flush_worth_of_records_is_waiting)
+{
+    record_writes(FLUSH_LEN_IN_RECORDS - 1);
+
+    ASSERT_EQ(trace_log_flush(), TRACE_LOG_ERROR_ALL_OK);
+
+    ASSERT_FALSE(fake_sd_card::is_log_open);
+    ASSERT_TRUE(fake_sd_card::log_file.empty());
+}
+
+TEST_F(TraceLogTest, records_are_written_in_order_in_whole_sectors_after_a_session_start)
+{
+    record_writes(FLUSH_LEN_IN_RECORDS + 10);
+
+    ASSERT_EQ(trace_log_flush(), TRACE_LOG_ERROR_ALL_OK);
+    ASSERT_EQ(fake_sd_card::log_file.size(), TRACE_LOG_FLUSH_LEN_IN_SECTORS * TRACE_LOG_SECTOR_LEN_IN_BYTES);
+    ASSERT_TRUE(fake_sd_card::is_log_open);
+
+    // the session start takes the place of one record, the rest wait for the next flush
+    const std::vector<Trace_Log_Record_t> records = records_in_log();
+    ASSERT_EQ(records[0].event, TRACE_LOG_EVENT_SESSION_START);
+    ASSERT_EQ(records[0].timestamp, fake_cycle_counter::FREQ_HZ);
+    ASSERT_EQ(records[0].arg, TRACE_LOG_FORMAT_VERSION);
+
+    for (uint32_t i = 1; i < records.size(); i++)
+    {
+        ASSERT_EQ(records[i].event, TRACE_LOG_EVENT_WRITE_START);
+        ASSERT_EQ(records[i].arg, i - 1);
+        ASSERT_EQ(records[i].timestamp, i - 1);
+    }
+
+    // closing writes the rest padded out to a sector, and the trace starts afresh in the same file next time
+    ASSERT_EQ(trace_log_close(), TRACE_LOG_ERROR_ALL_OK);
+    ASSERT_FALSE(fake_sd_card::is_log_open);
+    ASSERT_EQ(fake_sd_card::log_file.size(), (TRACE_LOG_FLUSH_LEN_IN_SECTORS + 1) * TRACE_LOG_SECTOR_LEN_IN_BYTES);
+    ASSERT_EQ(records_in_log(TRACE_LOG_EVENT_WRITE_START).size(), FLUSH_LEN_IN_RECORDS + 10);
+    ASSERT_EQ(records_in_log(TRACE_LOG_EVENT_NONE).size(), RECORDS_PER_SECTOR - 11);
+}
+
+TEST_F(TraceLogTest, a_full_ring_drops_the_newest_records_and_says_how_many)
+{
+    record_writes(TRACE_LOG_RING_LEN_IN_RECORDS + 10);
+    ASSERT_EQ(trace_log_num_dropped(), 10u);
+
+    ASSERT_EQ(trace_log_close(), TRACE_LOG_ERROR_ALL_OK);
+
+    const std::vector<Trace_Log_Record_t> writes = records_in_log(TRACE_LOG_EVENT_WRITE_START);
+    ASSERT_EQ(writes.size(), TRACE_LOG_RING_LEN_IN_RECORDS);
+    ASSERT_EQ(writes.back().arg, TRACE_LOG_RING_LEN_IN_RECORDS - 1);
+
+    ASSERT_THAT(records_in_log(TRACE_LOG_EVENT_RECORDS_DROPPED), ElementsAre(Field(&Trace_Log_Record_t::arg, 10)));
+}
+
+TEST_F(TraceLogTest, a_failed_write_drops_its_records_and_starts_a_new_session)
+{
+    fake_sd_card::num_log_writes_until_failure = 0;
+    record_writes(FLUSH_LEN_IN_RECORDS);
+
+    ASSERT_EQ(trace_log_flush(), TRACE_LOG_ERROR_SD_CARD_ERROR);
+    ASSERT_FALSE(fake_sd_card::is_log_open);
+    ASSERT_EQ(trace_log_num_dropped(), FLUSH_LEN_IN_RECORDS - 1);
+
+    fake_sd_card::num_log_writes_until_failure = UINT32_MAX;
+    record_writes(FLUSH_LEN_IN_RECORDS);
+    ASSERT_EQ(trace_log_flush(), TRACE_LOG_ERROR_ALL_OK);
+
+    const std::vector<Trace_Log_Record_t> records = records_in_log();
+    ASSERT_EQ(records[0].event, TRACE_LOG_EVENT_SESSION_START);
+    ASSERT_EQ(records[1].event, TRACE_LOG_EVENT_RECORDS_DROPPED);
+    ASSERT_EQ(records[1].arg, FLUSH_LEN_IN_RECORDS - 1);
+}
+
+TEST_F(TraceLogTest, unmounting_the_card_closes_the_file_and_the_next_flush_reopens_it)
+{
+    record_writes(FLUSH_LEN_IN_RECORDS);
+    ASSERT_EQ(trace_log_flush(), TRACE_LOG_ERROR_ALL_OK);
+
+    // e.g. the storage manager moving on to the next card of the SD card bank
+    sd_card_unmount();
+    fake_sd_card::mount(SD_CARD_BANK_CARD_SLOT_1);
+
+    record_writes(FLUSH_LEN_IN_RECORDS);
+    ASSERT_EQ(trace_log_flush(), TRACE_LOG_ERROR_ALL_OK);
+
+    ASSERT_EQ(records_in_log(TRACE_LOG_EVENT_SESSION_START).size(), 2u);
+    ASSERT_EQ(trace_log_num_dropped(), 0u);
+}
+
+TEST_F(TraceLogTest, the_dma_ring_records_each_block_and_each_overrun)
+{
+    audio_dma_ring_reset(4);
+
+    for (int i = 0; i < 5; i++)
+    {
+        audio_dma_ring_produce();
+    }
+    ASSERT_EQ(trace_log_close(), TRACE_LOG_ERROR_ALL_OK);
+
+    ASSERT_THAT(records_in_log(TRACE_LOG_EVENT_DMA_BLOCK_DONE), ElementsAre(Field(&Trace_Log_Record_t::arg, 1), Field(&Trace_Log_Record_t::arg, 2),
+                                                                          Field(&Trace_Log_Record_t::arg, 3), Field(&Trace_Log_Record_t::arg, 4),
+                                                                          Field(&Trace_Log_Record_t::arg, 5)));
+    ASSERT_THAT(records_in_log(TRACE_LOG_EVENT_DMA_OVERRUN), ElementsAre(Field(&Trace_Log_Record_t::arg, 4), Field(&Trace_Log_Record_t::arg, 5)));
+}
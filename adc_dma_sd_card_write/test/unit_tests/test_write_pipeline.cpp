@@ -0,0 +1,338 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "test_helpers.hpp"
+
+#include <vector>
+
+extern "C"
+{
+#include "write_pipeline.h"
+}
+
+using namespace testing;
+
+static const uint32_t SECTOR = WRITE_PIPELINE_SECTOR_LEN_IN_BYTES;
+
+// fills the next free buffer with `len` bytes counting up from `first_val` and submits it
+static void submit_counting_bytes(uint32_t len, uint8_t first_val)
+{
+    uint8_t *buff = write_pipeline_get_free_buffer();
+    ASSERT_NE(buff, nullptr);
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        buff[i] = (uint8_t)(first_val + i);
+    }
+
+    write_pipeline_submit_buffer(len);
+}
+
+TEST(WritePipelineTest, reset_frees_every_buffer)
+{
+    write_pipeline_reset(0);
+
+    uint32_t len = 0;
+    ASSERT_EQ(write_pipeline_num_buffers_full(), 0);
+    ASSERT_EQ(write_pipeline_start_write(&len), nullptr);
+    ASSERT_NE(write_pipeline_get_free_buffer(), nullptr);
+
+    write_pipeline_get_carried_bytes(&len);
+    ASSERT_EQ(len, 0);
+}
+
+TEST(WritePipelineTest, a_whole_number_of_sectors_is_written_as_is)
+{
+    write_pipeline_reset(0);
+
+    submit_counting_bytes(4 * SECTOR, 0);
+
+    uint32_t len = 0;
+    const uint8_t *chunk = write_pipeline_start_write(&len);
+
+    ASSERT_EQ(len, 4 * SECTOR);
+    ASSERT_EQ(chunk[0], 0);
+    ASSERT_EQ(chunk[SECTOR + 1], (uint8_t)(SECTOR + 1));
+
+    write_pipeline_get_carried_bytes(&len);
+    ASSERT_EQ(len, 0);
+}
+
+TEST(WritePipelineTest, the_next_block_is_processed_into_the_other_buffer_while_a_write_is_in_progress)
+{
+    write_pipeline_reset(0);
+
+    uint8_t *first = write_pipeline_get_free_buffer();
+    write_pipeline_submit_buffer(SECTOR);
+
+    // the write stage starts writing the first buffer
+    uint32_t len;
+    ASSERT_EQ(write_pipeline_start_write(&len), first);
+
+    // meanwhile the processing stage gets a different buffer to fill
+    uint8_t *second = write_pipeline_get_free_buffer();
+    ASSERT_NE(second, nullptr);
+    ASSERT_NE(second, first);
+    write_pipeline_submit_buffer(SECTOR);
+
+    // both buffers are busy now, the processing stage has to wait
+    ASSERT_EQ(write_pipeline_get_free_buffer(), nullptr);
+    ASSERT_EQ(write_pipeline_num_buffers_full(), WRITE_PIPELINE_NUM_BUFFERS);
+
+    // until the first write completes
+    write_pipeline_on_write_complete();
+    ASSERT_EQ(write_pipeline_get_free_buffer(), first);
+}
+
+TEST(WritePipelineTest, bytes_past_the_last_sector_are_carried_to_the_front_of_the_next_write)
+{
+    write_pipeline_reset(0);
+
+    // a 384kHz 24 bit block is 48 sectors and 192 bytes
+    const uint32_t block_len = AUDIO_DMA_BUFF_LEN_IN_BYTES;
+    const uint32_t tail_len = block_len % SECTOR;
+    ASSERT_EQ(tail_len, 192);
+
+    submit_counting_bytes(block_len, 0);
+    submit_counting_bytes(block_len, 0);
+
+    uint32_t len;
+    const uint8_t *chunk = write_pipeline_start_write(&len);
+    ASSERT_EQ(len, block_len - tail_len);
+    write_pipeline_on_write_complete();
+
+    // the second write starts with the tail of the first block, followed by the start of the second block
+    chunk = write_pipeline_start_write(&len);
+    ASSERT_EQ(len % SECTOR, 0);
+    ASSERT_EQ(chunk[0], (uint8_t)(block_len - tail_len));
+    ASSERT_EQ(chunk[tail_len - 1], (uint8_t)(block_len - 1));
+    ASSERT_EQ(chunk[tail_len], 0);
+    write_pipeline_on_write_complete();
+
+    // the 2 tails add up to 384 bytes, still less than a sector so they are all carried
+    const uint8_t *carried = write_pipeline_get_carried_bytes(&len);
+    ASSERT_EQ(len, 2 * tail_len);
+    ASSERT_EQ(carried[len - 1], (uint8_t)(block_len - 1));
+}
+
+TEST(WritePipelineTest, the_first_write_is_cut_short_so_the_rest_line_up_with_sectors_after_the_header)
+{
+    const uint32_t header_len = 44;
+    write_pipeline_reset(header_len);
+
+    submit_counting_bytes(3 * SECTOR, 0);
+
+    uint32_t len;
+    write_pipeline_start_write(&len);
+    ASSERT_EQ((header_len + len) % SECTOR, 0);
+    ASSERT_EQ(len, 3 * SECTOR - header_len);
+    write_pipeline_on_write_complete();
+
+    submit_counting_bytes(SECTOR, 0);
+    write_pipeline_start_write(&len);
+    ASSERT_EQ(len, SECTOR);
+}
+
+TEST(WritePipelineTest, a_block_too_small_to_finish_a_sector_is_carried_whole)
+{
+    write_pipeline_reset(0);
+
+    submit_counting_bytes(100, 0);
+
+    uint32_t len = 1234;
+    ASSERT_NE(write_pipeline_start_write(&len), nullptr);
+    ASSERT_EQ(len, 0);
+    write_pipeline_on_write_complete();
+
+    submit_counting_bytes(SECTOR, 100);
+    const uint8_t *chunk = write_pipeline_start_write(&len);
+    ASSERT_EQ(len, SECTOR);
+    for (uint32_t i = 0; i < SECTOR; i++)
+    {
+        ASSERT_EQ(chunk[i], (uint8_t)i);
+    }
+}
+
+TEST(WritePipelineTest, every_byte_comes_out_once_and_in_order_with_every_write_ending_on_a_sector_boundary)
+{
+    const uint32_t header_len = 44;
+    write_pipeline_reset(header_len);
+
+    // an awkward mix of block lengths
+    const uint32_t block_lens[] = {1032, AUDIO_DMA_BUFF_LEN_IN_BYTES, 7, 16512, 3000, 511, 513, 2};
+
+    uint32_t num_bytes_in = 0;
+    uint32_t file_pos = header_len;
+    std::vector<uint8_t> out;
+
+    for (uint32_t block_len : block_lens)
+    {
+        submit_counting_bytes(block_len, (uint8_t)num_bytes_in);
+        num_bytes_in += block_len;
+
+        uint32_t len;
+        const uint8_t *chunk = write_pipeline_start_write(&len);
+        out.insert(out.end(), chunk, chunk + len);
+        write_pipeline_on_write_complete();
+
+        file_pos += len;
+        ASSERT_EQ(file_pos % SECTOR, 0);
+    }
+
+    uint32_t len;
+    const uint8_t *carried = write_pipeline_get_carried_bytes(&len);
+    out.insert(out.end(), carried, carried + len);
+
+    ASSERT_EQ(out.size(), num_bytes_in);
+    for (uint32_t i = 0; i < num_bytes_in; i++)
+    {
+        ASSERT_EQ(out[i], (uint8_t)i);
+    }
+}
+
+TEST(WritePipelineTest, a_file_break_at_the_end_of_a_buffer_writes_the_tail_and_starts_the_next_file_unaligned)
+{
+    const uint32_t header_len = 44;
+    write_pipeline_reset(header_len);
+
+    submit_counting_bytes(SECTOR, 0);
+
+    uint32_t len;
+    write_pipeline_start_write(&len);
+    ASSERT_EQ(len, SECTOR - header_len);
+    ASSERT_FALSE(write_pipeline_write_ends_file());
+    write_pipeline_on_write_complete();
+
+    // the last buffer of the file is written out along with the carried bytes, nothing is held back
+    uint8_t *buff = write_pipeline_get_free_buffer();
+    write_pipeline_submit_buffer_with_file_break(100, 100);
+
+    const uint8_t *chunk = write_pipeline_start_write(&len);
+    ASSERT_EQ(len, header_len + 100);
+    ASSERT_EQ(chunk[0], (uint8_t)(SECTOR - header_len));
+    ASSERT_EQ(chunk + header_len, buff);
+    ASSERT_TRUE(write_pipeline_write_ends_file());
+    write_pipeline_on_write_complete();
+    ASSERT_FALSE(write_pipeline_write_ends_file());
+    ASSERT_EQ(write_pipeline_num_buffers_full(), 0);
+
+    write_pipeline_get_carried_bytes(&len);
+    ASSERT_EQ(len, 0);
+
+    // the next file has a header too, so its first write is cut short again
+    submit_counting_bytes(SECTOR, 0);
+    write_pipeline_start_write(&len);
+    ASSERT_EQ(len, SECTOR - header_len);
+}
+
+TEST(WritePipelineTest, a_buffer_split_between_two_files_is_written_in_two_pieces_before_it_is_freed)
+{
+    const uint32_t header_len = 44;
+    write_pipeline_reset(header_len);
+
+    uint8_t *buff = write_pipeline_get_free_buffer();
+    for (uint32_t i = 0; i < 3 * SECTOR; i++)
+    {
+        buff[i] = (uint8_t)i;
+    }
+    write_pipeline_submit_buffer_with_file_break(3 * SECTOR, 1000);
+
+    uint32_t len;
+    const uint8_t *chunk = write_pipeline_start_write(&len);
+    ASSERT_EQ(chunk, buff);
+    ASSERT_EQ(len, 1000);
+    ASSERT_TRUE(write_pipeline_write_ends_file());
+    write_pipeline_on_write_complete();
+
+    // the start of the next file is still in the buffer
+    ASSERT_EQ(write_pipeline_num_buffers_full(), 1);
+
+    chunk = write_pipeline_start_write(&len);
+    ASSERT_EQ(chunk, buff + 1000);
+    ASSERT_EQ((header_len + len) % SECTOR, 0);
+    ASSERT_EQ(len, SECTOR - header_len);
+    ASSERT_FALSE(write_pipeline_write_ends_file());
+    write_pipeline_on_write_complete();
+
+    ASSERT_EQ(write_pipeline_num_buffers_full(), 0);
+
+    const uint8_t *carried = write_pipeline_get_carried_bytes(&len);
+    ASSERT_EQ(len, 3 * SECTOR - 1000 - (SECTOR - header_len));
+    ASSERT_EQ(carried[len - 1], (uint8_t)(3 * SECTOR - 1));
+}
+
+TEST(WritePipelineTest, every_byte_comes_out_once_and_in_order_across_file_breaks)
+{
+    const uint32_t header_len = 44;
+    write_pipeline_reset(header_len);
+
+    // the same block length over and over, with files ending at awkward places
+    const uint32_t block_len = AUDIO_DMA_BUFF_LEN_IN_BYTES;
+    const uint32_t file_len = 2 * block_len + 4321;
+    const uint32_t num_files = 4;
+
+    std::vector<std::vector<uint8_t>> files(1);
+    uint32_t file_pos = header_len;
+    uint32_t num_bytes_in = 0;
+
+    while (num_bytes_in < num_files * file_len)
+    {
+        uint8_t *buff = write_pipeline_get_free_buffer();
+        ASSERT_NE(buff, nullptr);
+
+        for (uint32_t i = 0; i < block_len; i++)
+        {
+            buff[i] = (uint8_t)((num_bytes_in + i) % 251);
+        }
+
+        const uint32_t bytes_left_in_file = file_len - (num_bytes_in % file_len);
+        if (bytes_left_in_file <= block_len)
+        {
+            write_pipeline_submit_buffer_with_file_break(block_len, bytes_left_in_file);
+        }
+        else
+        {
+            write_pipeline_submit_buffer(block_len);
+        }
+        num_bytes_in += block_len;
+
+        // drain the pipeline, a split buffer takes two writes
+        uint32_t len;
+        const uint8_t *chunk;
+        while ((chunk = write_pipeline_start_write(&len)) != NULL)
+        {
+            files.back().insert(files.back().end(), chunk, chunk + len);
+            file_pos += len;
+
+            if (write_pipeline_write_ends_file())
+            {
+                files.emplace_back();
+                file_pos = header_len;
+            }
+            else
+            {
+                ASSERT_EQ(file_pos % SECTOR, 0);
+            }
+
+            write_pipeline_on_write_complete();
+        }
+    }
+
+    uint32_t len;
+    const uint8_t *carried = write_pipeline_get_carried_bytes(&len);
+    files.back().insert(files.back().end(), carried, carried + len);
+
+    ASSERT_EQ(files.size(), num_files + 1);
+
+    for (uint32_t f = 0; f < num_files; f++)
+    {
+        ASSERT_EQ(files[f].size(), file_len);
+        for (uint32_t i = 0; i < file_len; i++)
+        {
+            ASSERT_EQ(files[f][i], (uint8_t)(((f * file_len) + i) % 251));
+        }
+    }
+
+    // whatever was left over after the last file started the one after it
+    ASSERT_EQ(files[num_files].size(), num_bytes_in - (num_files * file_len));
+}
@@ -0,0 +1,240 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "trace_log.h"
+#include "cycle_counter.h"
+#include "sd_card.h"
+
+#include <stdbool.h>
+#include <stddef.h> // for NULL
+#include <string.h> // for memset
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define RECORDS_PER_SECTOR (TRACE_LOG_SECTOR_LEN_IN_BYTES / TRACE_LOG_RECORD_LEN_IN_BYTES)
+
+#define FLUSH_LEN_IN_RECORDS (TRACE_LOG_FLUSH_LEN_IN_SECTORS * RECORDS_PER_SECTOR)
+
+// closing writes out the whole ring, plus the records that come in while it does
+#define MAX_NUM_WRITES_PER_CLOSE ((TRACE_LOG_RING_LEN_IN_RECORDS / FLUSH_LEN_IN_RECORDS) + 1)
+
+#if (TRACE_LOG_RING_LEN_IN_RECORDS & (TRACE_LOG_RING_LEN_IN_RECORDS - 1))
+#error "The trace log ring length must be a power of 2"
+#endif
+
+#if FLUSH_LEN_IN_RECORDS > TRACE_LOG_RING_LEN_IN_RECORDS
+#error "The trace log ring must hold at least one flush worth of records"
+#endif
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static Trace_Log_Record_t ring[TRACE_LOG_RING_LEN_IN_RECORDS];
+
+// Free-running counts of the slots reserved by the producers and the records taken by the consumer, the records waiting
+// are the difference between the two. Producers can interrupt each other, so a slot is reserved with a compare and
+// swap, and only counts as a record once its event is written. The consumer is always the main loop.
+static uint32_t num_reserved = 0;
+static uint32_t num_consumed = 0;
+
+// the number of records dropped, and how many of those the trace file already says were dropped
+static uint32_t num_dropped = 0;
+static uint32_t num_dropped_reported = 0;
+
+static volatile bool is_started = false;
+static const char *trace_file_name = NULL;
+
+// the records of one write to the trace file
+static Trace_Log_Record_t write_buff[FLUSH_LEN_IN_RECORDS];
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `num_waiting()` is the number of slots reserved in the ring and not yet taken by the consumer, the last few
+ * may not hold a record yet.
+ */
+static uint32_t num_waiting();
+
+/**
+ * @brief `take_records(d, n)` moves up to `n` records out of the ring into `d` in order, stopping at a slot that doesn't
+ * hold a record yet, and is the number moved.
+ */
+static uint32_t take_records(Trace_Log_Record_t *dest, uint32_t max_num_records);
+
+/**
+ * @brief `write_records(n)` writes up to `n` records out of the ring to the trace file with a single write of whole
+ * sectors, opening the file first if it isn't open, along with the number of records dropped since the last write.
+ */
+static Trace_Log_Error_t write_records(uint32_t max_num_records);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void trace_log_start(const char *file_name)
+{
+    is_started = false;
+
+    trace_file_name = file_name;
+    num_reserved = 0;
+    num_consumed = 0;
+    num_dropped = 0;
+    num_dropped_reported = 0;
+    memset(ring, 0, sizeof(ring));
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    is_started = true;
+}
+
+void trace_log_event(Trace_Log_Event_t event, uint16_t arg)
+{
+    if (!is_started)
+    {
+        return;
+    }
+
+    // an interrupt that records an event between the load and the compare and swap takes the slot, so we try again with
+    // the one after it
+    uint32_t slot = __atomic_load_n(&num_reserved, __ATOMIC_RELAXED);
+    do
+    {
+        if (slot - __atomic_load_n(&num_consumed, __ATOMIC_ACQUIRE) >= TRACE_LOG_RING_LEN_IN_RECORDS)
+        {
+            __atomic_add_fetch(&num_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&num_reserved, &slot, slot + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    Trace_Log_Record_t *record = &ring[slot & (TRACE_LOG_RING_LEN_IN_RECORDS - 1)];
+    record->timestamp = cycle_counter_now();
+    record->arg = arg;
+
+    // the consumer takes a slot with an event in it as a whole record, so the event goes in last
+    __atomic_store_n(&record->event, (uint16_t)event, __ATOMIC_RELEASE);
+}
+
+Trace_Log_Error_t trace_log_flush()
+{
+    if (!is_started || num_waiting() < FLUSH_LEN_IN_RECORDS)
+    {
+        return TRACE_LOG_ERROR_ALL_OK;
+    }
+
+    return write_records(FLUSH_LEN_IN_RECORDS);
+}
+
+Trace_Log_Error_t trace_log_close()
+{
+    if (!is_started)
+    {
+        return TRACE_LOG_ERROR_ALL_OK;
+    }
+
+    Trace_Log_Error_t err = TRACE_LOG_ERROR_ALL_OK;
+
+    for (uint32_t i = 0; i < MAX_NUM_WRITES_PER_CLOSE && err == TRACE_LOG_ERROR_ALL_OK; i++)
+    {
+        if (num_waiting() == 0 && __atomic_load_n(&num_dropped, __ATOMIC_RELAXED) == num_dropped_reported)
+        {
+            break;
+        }
+        err = write_records(FLUSH_LEN_IN_RECORDS);
+    }
+
+    if (sd_card_log_is_open() && sd_card_log_close() != SD_CARD_ERROR_ALL_OK)
+    {
+        return TRACE_LOG_ERROR_SD_CARD_ERROR;
+    }
+
+    return err;
+}
+
+uint32_t trace_log_num_dropped()
+{
+    return __atomic_load_n(&num_dropped, __ATOMIC_RELAXED);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+uint32_t num_waiting()
+{
+    return __atomic_load_n(&num_reserved, __ATOMIC_ACQUIRE) - num_consumed;
+}
+
+uint32_t take_records(Trace_Log_Record_t *dest, uint32_t max_num_records)
+{
+    uint32_t num_taken = 0;
+
+    while (num_taken < max_num_records && num_waiting() > 0)
+    {
+        Trace_Log_Record_t *record = &ring[num_consumed & (TRACE_LOG_RING_LEN_IN_RECORDS - 1)];
+
+        // pairs with the release store of the event in trace_log_event()
+        if (__atomic_load_n(&record->event, __ATOMIC_ACQUIRE) == TRACE_LOG_EVENT_NONE)
+        {
+            break;
+        }
+
+        dest[num_taken] = *record;
+        num_taken += 1;
+
+        // the slot must be empty again before a producer can reserve it
+        record->event = TRACE_LOG_EVENT_NONE;
+        __atomic_store_n(&num_consumed, num_consumed + 1, __ATOMIC_RELEASE);
+    }
+
+    return num_taken;
+}
+
+Trace_Log_Error_t write_records(uint32_t max_num_records)
+{
+    uint32_t len = 0;
+
+    if (!sd_card_log_is_open())
+    {
+        if (sd_card_log_open(trace_file_name) != SD_CARD_ERROR_ALL_OK)
+        {
+            __atomic_add_fetch(&num_dropped, take_records(write_buff, max_num_records), __ATOMIC_RELAXED);
+            return TRACE_LOG_ERROR_SD_CARD_ERROR;
+        }
+
+        write_buff[len++] = (Trace_Log_Record_t){
+            .timestamp = cycle_counter_freq_hz(),
+            .event = TRACE_LOG_EVENT_SESSION_START,
+            .arg = TRACE_LOG_FORMAT_VERSION,
+        };
+    }
+
+    const uint32_t num_unreported = __atomic_load_n(&num_dropped, __ATOMIC_RELAXED) - num_dropped_reported;
+    const uint16_t num_reported = num_unreported > UINT16_MAX ? UINT16_MAX : (uint16_t)num_unreported;
+
+    if (num_reported > 0)
+    {
+        write_buff[len++] = (Trace_Log_Record_t){
+            .timestamp = cycle_counter_now(),
+            .event = TRACE_LOG_EVENT_RECORDS_DROPPED,
+            .arg = num_reported,
+        };
+    }
+
+    const uint32_t room = FLUSH_LEN_IN_RECORDS - len;
+    const uint32_t num_taken = take_records(write_buff + len, max_num_records < room ? max_num_records : room);
+    len += num_taken;
+
+    if (len == 0)
+    {
+        return TRACE_LOG_ERROR_ALL_OK;
+    }
+
+    // pad out the last sector with empty records
+    const uint32_t padded_len = ((len + RECORDS_PER_SECTOR - 1) / RECORDS_PER_SECTOR) * RECORDS_PER_SECTOR;
+    memset(write_buff + len, 0, (padded_len - len) * TRACE_LOG_RECORD_LEN_IN_BYTES);
+
+    if (sd_card_log_write(write_buff, padded_len * TRACE_LOG_RECORD_LEN_IN_BYTES) != SD_CARD_ERROR_ALL_OK)
+    {
+        // we don't know how much of it made it to the card, so the file is started afresh with a new session
+        sd_card_log_close();
+        __atomic_add_fetch(&num_dropped, num_taken, __ATOMIC_RELAXED);
+        return TRACE_LOG_ERROR_SD_CARD_ERROR;
+    }
+
+    num_dropped_reported += num_reported;
+    return TRACE_LOG_ERROR_ALL_OK;
+}
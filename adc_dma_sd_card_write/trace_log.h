@@ -0,0 +1,136 @@
+/**
+ * @file      trace_log.h
+ * @brief     A software module for keeping a binary trace of timestamped events on the SD card is represented here.
+ * @details   Each event is an 8 byte record: the cycle counter when it happened, what happened, and one 16 bit argument.
+ *            Recording an event is a handful of instructions and never blocks, so events can be recorded from the DMA
+ *            interrupt, the block ready callback and the main loop alike. The records wait in a ring in SRAM until the
+ *            main loop writes them out a few whole sectors at a time, appended to a file of their own, so the trace can
+ *            stay on for recordings of any length without disturbing them. If the ring fills up before the main loop
+ *            gets round to it the newest records are dropped and counted, the count is written to the trace in place
+ *            of them.
+ *
+ *            The file is a plain array of records, little-endian, the same as `Trace_Log_Record_t`. Each time it is
+ *            opened the first record is `TRACE_LOG_EVENT_SESSION_START`, which carries the rate of the timestamps.
+ *            Records with `TRACE_LOG_EVENT_NONE` pad out the last sector of a write and are to be skipped. The
+ *            timestamps wrap around, so the time between two records is their difference modulo 2^32.
+ *            test/profiling_tests/trace_decode.py decodes it.
+ */
+
+#ifndef TRACE_LOG_H_
+#define TRACE_LOG_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// the number of records the ring holds, a power of 2, 1024 records is 8KiB of SRAM
+#define TRACE_LOG_RING_LEN_IN_RECORDS (1024)
+
+// the length of `Trace_Log_Record_t`
+#define TRACE_LOG_RECORD_LEN_IN_BYTES (8)
+
+// records are written out a sector at a time
+#define TRACE_LOG_SECTOR_LEN_IN_BYTES (512)
+
+// the main loop writes out the records once there are this many sectors of them, a single write to the card
+#define TRACE_LOG_FLUSH_LEN_IN_SECTORS (4)
+
+// the version of the file format, in the argument of `TRACE_LOG_EVENT_SESSION_START`
+#define TRACE_LOG_FORMAT_VERSION (1)
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Enumerated trace log errors are represented here.
+ */
+typedef enum
+{
+    TRACE_LOG_ERROR_ALL_OK = 0,
+    TRACE_LOG_ERROR_SD_CARD_ERROR,
+} Trace_Log_Error_t;
+
+/**
+ * @brief The events in the trace are represented here, along with what their argument holds. The values are part of
+ * the file format, so new events go on the end. Events named `_START` and `_END` come in pairs around a step.
+ */
+typedef enum
+{
+    TRACE_LOG_EVENT_NONE = 0,            // padding, not an event
+    TRACE_LOG_EVENT_SESSION_START = 1,   // the file was opened, the timestamp is the timestamp rate in Hz, arg: the format version
+    TRACE_LOG_EVENT_RECORDS_DROPPED = 2, // arg: the number of records dropped since the last time, at most 65535
+    TRACE_LOG_EVENT_RECORDING_START = 3, // arg: the bits per sample in the top 6 bits, and the sample rate in kHz in the bottom 10
+    TRACE_LOG_EVENT_RECORDING_END = 4,   // arg: the `Wav_Recorder_Error_t` the recording ended with
+    TRACE_LOG_EVENT_FILE_START = 5,      // arg: the index of the file in the recording
+    TRACE_LOG_EVENT_DMA_BLOCK_DONE = 6,  // in the DMA interrupt, arg: the number of full blocks in the ring
+    TRACE_LOG_EVENT_DMA_OVERRUN = 7,     // in the DMA interrupt, arg: the number of full blocks in the ring
+    TRACE_LOG_EVENT_CONVERT_START = 8,
+    TRACE_LOG_EVENT_CONVERT_END = 9,
+    TRACE_LOG_EVENT_DECIMATE_START = 10,
+    TRACE_LOG_EVENT_DECIMATE_END = 11,
+    TRACE_LOG_EVENT_ENCODE_START = 12, // FLAC or IMA ADPCM
+    TRACE_LOG_EVENT_ENCODE_END = 13,
+    TRACE_LOG_EVENT_WRITE_START = 14, // arg: the length of the write in bytes, at most 65535
+    TRACE_LOG_EVENT_WRITE_END = 15,   // after any file switch that came with the write
+    TRACE_LOG_EVENT_OVER_BUDGET = 16, // a step took longer than its budget, see stage_profiler.h, arg: the `Stage_Profiler_Stage_t`
+} Trace_Log_Event_t;
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief One record of the trace is represented here, as it is laid out in the file.
+ */
+typedef struct
+{
+    uint32_t timestamp;
+    uint16_t event; // a `Trace_Log_Event_t`
+    uint16_t arg;
+} Trace_Log_Record_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `trace_log_start(f)` empties the ring and starts recording events, to be appended to the file at path `f`.
+ * Events before this are ignored.
+ *
+ * @pre the cycle counter is running, see cycle_counter.h.
+ *
+ * @param file_name the path of the trace file on the SD card, it should be absolute so it doesn't follow the current
+ * directory around. The string must stay valid.
+ */
+void trace_log_start(const char *file_name);
+
+/**
+ * @brief `trace_log_event(e, a)` records event `e` with argument `a` at the current time. Safe to call from any
+ * interrupt or the main loop, it never blocks.
+ *
+ * @post the record is in the ring, or it was dropped and counted if the ring was full.
+ */
+void trace_log_event(Trace_Log_Event_t event, uint16_t arg);
+
+/**
+ * @brief `trace_log_flush()` writes `TRACE_LOG_FLUSH_LEN_IN_SECTORS` sectors of records to the trace file once there
+ * are that many in the ring, opening the file first if it isn't open. Call this from the main loop, often enough that
+ * the ring doesn't fill up.
+ *
+ * @retval `TRACE_LOG_ERROR_ALL_OK` if there was nothing to write or the records were written, else an error, in which
+ * case the records are dropped and counted, and the file is opened afresh next time.
+ */
+Trace_Log_Error_t trace_log_flush();
+
+/**
+ * @brief `trace_log_close()` writes every record in the ring to the trace file, padding out the last sector, and
+ * closes it, so the trace so far is on the card. The next flush opens the file again. Call this from the main loop.
+ *
+ * @retval `TRACE_LOG_ERROR_ALL_OK` if the records were written and the file closed, else an error.
+ */
+Trace_Log_Error_t trace_log_close();
+
+/**
+ * @brief `trace_log_num_dropped()` is the number of records dropped since the trace was started, because the ring was
+ * full or they couldn't be written.
+ */
+uint32_t trace_log_num_dropped();
+
+#endif /* TRACE_LOG_H_ */
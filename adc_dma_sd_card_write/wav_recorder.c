@@ -0,0 +1,1349 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ad4630.h"
+#include "audio_dma.h"
+#include "data_converters.h"
+#include "date_dirs.h"
+#include "decimation_filter.h"
+#include "demo_config.h"
+#include "duty_cycle.h"
+#include "flac_encoder.h"
+#include "ima_adpcm.h"
+#include "real_time_clock.h"
+#include "scheduler.h"
+#include "sd_card.h"
+#include "stage_profiler.h"
+#include "storage_manager.h"
+#include "time_helpers.h"
+#include "trace_log.h"
+#include "wav_header.h"
+#include "wav_recorder.h"
+#include "wav_writer.h"
+#include "write_pipeline.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define SECS_PER_DAY (86400)
+
+// the events of the write task, and of the housekeeping task
+#define WRITE_EVENT_CHUNK_READY (1u << 0)
+#define HOUSEKEEPING_EVENT_WRITES_CAUGHT_UP (1u << 0)
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1 && DEMO_CONFIG_RAW_CAPTURE == 1
+#error "raw capture writes the DMA blocks as they come, it can't compress them with FLAC too"
+#endif
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+#define FILE_EXTENSION ".flac"
+
+// a file that starts with too few samples for a frame of their own carries them in front of the next block, in room
+// for up to 15 of them rounded up to keep the processed samples word aligned
+#define MAX_CARRIED_LEN_IN_BYTES (FLAC_ENCODER_MIN_BLOCK_LEN_IN_SAMPLES * DATA_CONVERTERS_I24_SIZE_IN_BYTES)
+
+// a block with samples carried in front of it, split into two frames where one file ends and the next begins
+#define MAX_FLAC_LEN_PER_BLOCK_IN_BYTES (FLAC_ENCODER_MAX_FRAME_LEN_IN_BYTES(AUDIO_DMA_BUFF_LEN_IN_SAMPS + FLAC_ENCODER_MIN_BLOCK_LEN_IN_SAMPLES - 1, 24) + \
+                                         FLAC_ENCODER_FRAME_OVERHEAD_IN_BYTES)
+
+#if MAX_FLAC_LEN_PER_BLOCK_IN_BYTES > WRITE_PIPELINE_BUFF_LEN_IN_BYTES
+#error "the FLAC frames of a DMA block don't fit in a write pipeline buffer"
+#endif
+#elif DEMO_CONFIG_RAW_CAPTURE == 1
+#define FILE_EXTENSION ".raw"
+
+// the metadata of each raw file goes in a text file of the same name next to it
+#define RAW_SIDECAR_EXTENSION ".txt"
+#else
+#define FILE_EXTENSION ".wav"
+#endif
+
+// IMA ADPCM blocks are encoded after the 16 bit samples of a DMA block, in the same write pipeline buffer
+#if (AUDIO_DMA_BUFF_LEN_IN_SAMPS * DATA_CONVERTERS_Q15_SIZE_IN_BYTES) + IMA_ADPCM_MAX_ENCODED_LEN_IN_BYTES(AUDIO_DMA_BUFF_LEN_IN_SAMPS) > \
+    WRITE_PIPELINE_BUFF_LEN_IN_BYTES
+#error "the IMA ADPCM blocks of a DMA block don't fit in a write pipeline buffer after its samples"
+#endif
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the attributes of the files being recorded, read by the block ready callback while the DMA stream runs
+static Wave_Header_Attributes_t *processing_wav_attr;
+
+// the recording in progress, carried on by the write task one chunk at a time
+static bool is_recording = false;
+static uint64_t recording_file_len_in_samples;
+static uint32_t recording_num_files;
+static uint32_t num_files_written;
+static Wav_Recorder_Done_Callback_t done_callback = NULL;
+
+// the file to open once the storage manager has mounted the next card of the SD card bank, and how the switch went
+static bool is_waiting_for_card = false;
+static uint32_t waiting_file_idx;
+static const char *waiting_file_name;
+static uint64_t waiting_file_len_in_bytes;
+static Wav_Recorder_Error_t card_switch_err;
+
+// the write task writes out each chunk the block ready callback submits, the housekeeping task does what can wait
+// until the writes have caught up
+static Scheduler_Task_t write_task;
+static Scheduler_Task_t housekeeping_task;
+
+// how the last recording started by one of the blocking functions went
+static Wav_Recorder_Error_t blocking_recording_err;
+
+// the number of bytes of audio data in each file of the recording
+static uint64_t bytes_of_audio_per_file;
+
+// the number of files the block ready callback still has audio to process for, only written by the callback
+static uint32_t num_files_left_to_process;
+
+// the number of bytes of audio the block ready callback still has to process for the current file
+static uint64_t bytes_left_in_file;
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+// the number of the next sample to encode in the current file, and the bytes of PCM waiting for the next block
+static uint64_t frame_sample_number;
+static uint32_t carried_len_in_bytes;
+#endif
+
+// when the first sample of the recording was taken, as the midnight before it and the number of samples since then
+static tm_t recording_start_midnight;
+static uint64_t recording_start_sample_of_day;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `start_recording(a, l, n, f, d)` starts recording `n` back to back wav files with attributes `a`, each `l`
+ * samples long, without stopping the ADC/DMA between them, and opens the first file. If `f` is not NULL it is the name
+ * of the one file to record, else the files are named after the time on the real time clock at the start of each file.
+ * The write task carries on the recording from here, and calls `d` when it ends.
+ *
+ * @pre the arguments were checked by the caller, the files are at least one processed DMA block long if `n` > 1.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the recording started, else an error code and `d` is not called
+ */
+static Wav_Recorder_Error_t start_recording(Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_samples, uint32_t num_files, const char *file_name,
+                                            Wav_Recorder_Done_Callback_t done);
+
+/**
+ * @brief `write_next_chunk(e)` is the write task, it runs once for each chunk the block ready callback submits. It
+ * writes the chunk to the file, closes each file at its last chunk and opens the next, and ends the recording after the
+ * last file or at the first error. While the next card of the SD card bank settles it writes nothing, and once the
+ * writes have caught up with the audio it hands over to the housekeeping task.
+ */
+static void write_next_chunk(Scheduler_Events_t events);
+
+/**
+ * @brief `do_housekeeping(e)` is the housekeeping task, it does the work of a recording that can wait until the writes
+ * have caught up with the audio.
+ */
+static void do_housekeeping(Scheduler_Events_t events);
+
+/**
+ * @brief `finish_recording(e)` stops the recording, appends its stats if it went well, and calls the done callback
+ * with `e` or the error that came up appending the stats.
+ */
+static void finish_recording(Wav_Recorder_Error_t err);
+
+/**
+ * @brief `finish_blocking_recording(e)` is the done callback of the blocking functions, it stores `e` and stops the
+ * scheduler they run.
+ */
+static void finish_blocking_recording(Wav_Recorder_Error_t err);
+
+/**
+ * @brief `start_file(a, i, l, f)` makes room for file `i` (counting from 0) of a recording of `l` sample files with
+ * attributes `a`, and opens it with `open_file()`. With the SD card bank the file goes on the next card if the mounted
+ * one is too full, and is only opened once that card has settled and is mounted, the write task waits for it.
+ *
+ * @pre the recording start time is set and the header layout for the recording is selected.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the file was opened and the header written, or will be once the next card is
+ * mounted, else an error code
+ */
+static Wav_Recorder_Error_t start_file(Wave_Header_Attributes_t *wav_attr, uint32_t file_idx, uint64_t file_len_in_samples, const char *file_name);
+
+/**
+ * @brief `open_file(a, i, l, f, n)` works out when file `i` of a recording of `l` sample files starts, and opens it
+ * with a header for attributes `a` and room for `n` bytes. The file is named `f` if it is not NULL, else after its
+ * start time in the form "YYYYmmdd_HHMMSS.wav", in the "YYYY/MM/DD/" directory of that day with
+ * `DEMO_CONFIG_SHARD_FILES_BY_DATE`.
+ *
+ * @pre the card has room for the file.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the file was opened and the header written, else an error code
+ */
+static Wav_Recorder_Error_t open_file(Wave_Header_Attributes_t *wav_attr, uint32_t file_idx, uint64_t file_len_in_samples, const char *file_name,
+                                      uint64_t file_len_in_bytes);
+
+/**
+ * @brief `on_card_switched(e)` is called by the storage manager once the next card is mounted, or not if `e` is an
+ * error. It opens the file that was waiting for the card, and posts the write task for the chunks that came in while
+ * it waited.
+ */
+static void on_card_switched(Storage_Manager_Error_t err);
+
+/**
+ * @brief `read_start_time(t, ms)` stores the time on the real time clock in `t` and `ms`, to the millisecond. If the
+ * clock can't tell the milliseconds it waits for the start of the next second instead, so `ms` is 0. If the clock can't
+ * be read at all the default time is used, so the recording goes ahead anyway.
+ */
+static void read_start_time(tm_t *start_time, uint32_t *start_millisecs);
+
+/**
+ * @brief `is_ima_adpcm(a)` is true if a file with attributes `a` holds IMA ADPCM rather than PCM samples.
+ */
+static bool is_ima_adpcm(const Wave_Header_Attributes_t *wav_attr);
+
+/**
+ * @brief `bytes_per_sample(a)` is the number of bytes in each processed sample of a file with attributes `a`, IMA
+ * ADPCM is encoded from 16 bit samples.
+ */
+static uint32_t bytes_per_sample(const Wave_Header_Attributes_t *wav_attr);
+
+/**
+ * @brief `encoded_len_in_bytes(a, n)` is the number of bytes `n` samples take up in the audio data of a file with
+ * attributes `a`, `n` is a whole number of blocks for IMA ADPCM.
+ */
+static uint64_t encoded_len_in_bytes(const Wave_Header_Attributes_t *wav_attr, uint64_t num_samples);
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+/**
+ * @brief `samples_per_block(a)` is the number of samples each DMA block turns into for a file with attributes `a`,
+ * which sizes the FLAC frames.
+ */
+static uint32_t samples_per_block(const Wave_Header_Attributes_t *wav_attr);
+#endif
+
+/**
+ * @brief `stop_recording(e)` stops the ADC and the DMA stream, closes the file being recorded if an error left it open,
+ * and is `e`, or an SD card error if `e` is OK and the file couldn't be closed, so errors that occur in the middle of a
+ * recording don't leave the DMA running or the file open.
+ */
+static Wav_Recorder_Error_t stop_recording(Wav_Recorder_Error_t err);
+
+/**
+ * @brief `process_available_blocks()` is the DMA block ready callback. It converts, decimates, and truncates each DMA
+ * block waiting in the ring into a free write pipeline buffer, until the ring is empty, there are no free buffers left,
+ * or all the audio for the last file is processed. A block that straddles the end of a file is split between the file
+ * and the next one at the exact sample, the part of the last block past the end of the last file is dropped. Then it
+ * posts the write task.
+ */
+static void process_available_blocks();
+
+/**
+ * @brief `process_block(s, d)` converts DMA block `s` into WAVE samples at the sample rate and bit depth of the current
+ * file, stores them in `d`, and is the number of bytes stored.
+ */
+static uint32_t process_block(uint8_t *dma_block, uint8_t *dest);
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 0
+/**
+ * @brief `encode_ima_adpcm_block(s, d)` processes DMA block `s` into 16 bit samples in free write pipeline buffer `d`,
+ * encodes them into IMA ADPCM blocks after the samples, moves the finished blocks to the start of `d`, and submits
+ * them. Files are a whole number of IMA ADPCM blocks long, so a DMA block that straddles the end of a file splits
+ * between IMA ADPCM blocks too.
+ */
+static void encode_ima_adpcm_block(uint8_t *dma_block, uint8_t *dest);
+#endif
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+/**
+ * @brief `encode_block(s, d)` processes DMA block `s` and encodes it into FLAC frames in free write pipeline buffer
+ * `d`, which it submits. A block that straddles the end of a file is encoded as a frame for each file, unless the part
+ * in the next file is too short for a frame, then it is carried over and encoded in front of the next block.
+ */
+static void encode_block(uint8_t *dma_block, uint8_t *dest);
+
+/**
+ * @brief `encode_frame(s, n, d)` encodes the `n` bytes of processed samples in `s` into a FLAC frame of the current file
+ * in `d`, and is the length of the frame.
+ */
+static uint32_t encode_frame(const uint8_t *pcm, uint32_t len_in_bytes, uint8_t *dest);
+#endif
+
+#if DEMO_CONFIG_RAW_CAPTURE == 1
+/**
+ * @brief `write_raw_sidecar(n, a, t, s, l)` writes the sidecar of raw file `n`, with attributes `a`, starting at time
+ * `t`, which is sample `s` of the day it starts on, and `l` samples long.
+ *
+ * @pre the SD card is mounted and no file is open.
+ *
+ * @post a text file named like `n` with the extension `RAW_SIDECAR_EXTENSION` holds one `key=value` line for each of
+ * the format, sample rate, bits per sample, channels, byte order, number of samples, start time, and the number of the
+ * first sample since midnight, which test/raw_convert reads.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the sidecar was written, else an error code
+ */
+static Wav_Recorder_Error_t write_raw_sidecar(const char *file_name, const Wave_Header_Attributes_t *wav_attr, const tm_t *start_time,
+                                              uint64_t sample_of_day, uint64_t file_len_in_samples);
+
+/**
+ * @brief `sprint_u64(sb, n)` writes `n` in decimal into string buffer `sb`, and is the number of chars written.
+ */
+static uint32_t sprint_u64(char *str_buff, uint64_t n);
+#endif
+
+#if DEMO_CONFIG_GENERATE_CSV_OF_DMA_RING_STATS == 1
+/**
+ * @brief `append_dma_ring_stats_to_csv(a)` appends one row of DMA ring statistics for the recording with attributes `a`
+ * to a CSV file at the root of the SD card.
+ *
+ * @pre the SD card is mounted, no file is open, and the DMA stream was stopped after the recording finished.
+ *
+ * @post a row with the ring depth, peak occupancy, overruns, stall/drain times, and the consumer lag histogram is
+ * appended to the file.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the row was written, else an error code
+ */
+static Wav_Recorder_Error_t append_dma_ring_stats_to_csv(Wave_Header_Attributes_t *wav_attr);
+#endif
+
+#if DEMO_CONFIG_GENERATE_CSV_OF_DUTY_CYCLE == 1
+/**
+ * @brief `append_duty_cycle_to_csv(a)` appends one row with the time the core was awake during the recording with
+ * attributes `a` to a CSV file at the root of the SD card.
+ *
+ * @pre the SD card is mounted, no file is open, and the DMA stream was stopped after the recording finished.
+ *
+ * @post a row with the length of the recording, the time awake, its share of the length in percent, the number of
+ * times the core went to sleep, and that number per DMA block is appended to the file.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the row was written, else an error code
+ */
+static Wav_Recorder_Error_t append_duty_cycle_to_csv(Wave_Header_Attributes_t *wav_attr);
+#endif
+
+#if DEMO_CONFIG_PROFILE_STAGES == 1
+/**
+ * @brief `append_stage_profile_to_csv(a)` appends one row per profiled stage for the recording with attributes `a` to a
+ * CSV file at the root of the SD card.
+ *
+ * @pre the SD card is mounted, no file is open, and the DMA stream was stopped after the recording finished.
+ *
+ * @post a row with the number of calls, the min, mean, 99th percentile and max time, the budget, and the number of calls
+ * over budget of each stage is appended to the file, times in microseconds.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the rows were written, else an error code
+ */
+static Wav_Recorder_Error_t append_stage_profile_to_csv(Wave_Header_Attributes_t *wav_attr);
+#endif
+
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+Wav_Recorder_Error_t wav_recorder_init()
+{
+    // writing out the audio comes before anything else, the housekeeping after everything else
+    if (scheduler_add_task(write_next_chunk, SCHEDULER_PRIORITY_HIGH, &write_task) != SCHEDULER_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SCHEDULER_ERROR;
+    }
+
+    if (scheduler_add_task(do_housekeeping, SCHEDULER_PRIORITY_LOW, &housekeeping_task) != SCHEDULER_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SCHEDULER_ERROR;
+    }
+
+    return WAV_RECORDER_ERROR_ALL_OK;
+}
+
+Wav_Recorder_Error_t wav_recorder_start_demo_file(Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_samples, Wav_Recorder_Done_Callback_t done)
+{
+    // a string buffer to write file names into
+    static char file_name_buff[64];
+
+    // derive the file name from the input parameters
+    sprintf(file_name_buff, "demo_%" PRIu32 "kHz_%" PRIu32 "_bit" FILE_EXTENSION, (uint32_t)wav_attr->sample_rate / 1000,
+            (uint32_t)wav_attr->bits_per_sample);
+
+    return start_recording(wav_attr, file_len_in_samples, 1, file_name_buff, done);
+}
+
+Wav_Recorder_Error_t wav_recorder_start_continuous(Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_samples, uint32_t num_files,
+                                                   Wav_Recorder_Done_Callback_t done)
+{
+    // files are named to the second, so shorter files would share a name
+    if (num_files == 0 || (num_files > 1 && file_len_in_samples < wav_attr->sample_rate))
+    {
+        return WAV_RECORDER_ERROR_INVALID_ARG_ERROR;
+    }
+
+    return start_recording(wav_attr, file_len_in_samples, num_files, NULL, done);
+}
+
+bool wav_recorder_is_recording()
+{
+    return is_recording;
+}
+
+Wav_Recorder_Error_t write_demo_wav_file(Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_samples)
+{
+    const Wav_Recorder_Error_t err = wav_recorder_start_demo_file(wav_attr, file_len_in_samples, finish_blocking_recording);
+    if (err != WAV_RECORDER_ERROR_ALL_OK)
+    {
+        return err;
+    }
+
+    scheduler_run();
+
+    return blocking_recording_err;
+}
+
+Wav_Recorder_Error_t wav_recorder_record_continuous(Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_samples, uint32_t num_files)
+{
+    const Wav_Recorder_Error_t err = wav_recorder_start_continuous(wav_attr, file_len_in_samples, num_files, finish_blocking_recording);
+    if (err != WAV_RECORDER_ERROR_ALL_OK)
+    {
+        return err;
+    }
+
+    scheduler_run();
+
+    return blocking_recording_err;
+}
+
+uint64_t wav_recorder_secs_to_samples(const Wave_Header_Attributes_t *wav_attr, uint32_t secs)
+{
+    return (uint64_t)secs * wav_attr->sample_rate;
+}
+
+uint64_t wav_recorder_bytes_to_samples(const Wave_Header_Attributes_t *wav_attr, uint64_t len_in_bytes)
+{
+    if (is_ima_adpcm(wav_attr))
+    {
+        return (len_in_bytes / IMA_ADPCM_BLOCK_LEN_IN_BYTES) * IMA_ADPCM_SAMPLES_PER_BLOCK;
+    }
+
+    return len_in_bytes / bytes_per_sample(wav_attr);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+Wav_Recorder_Error_t start_recording(Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_samples, uint32_t num_files, const char *file_name,
+                                     Wav_Recorder_Done_Callback_t done)
+{
+    if (is_recording)
+    {
+        return WAV_RECORDER_ERROR_BUSY_ERROR;
+    }
+
+    // an IMA ADPCM file ends on a whole block, the next one starts with the samples that didn't fit
+    if (is_ima_adpcm(wav_attr))
+    {
+        file_len_in_samples -= file_len_in_samples % IMA_ADPCM_SAMPLES_PER_BLOCK;
+    }
+
+    if (file_len_in_samples == 0)
+    {
+        return WAV_RECORDER_ERROR_INVALID_ARG_ERROR;
+    }
+
+    const uint64_t audio_len_in_bytes = file_len_in_samples * bytes_per_sample(wav_attr);
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+    // the FLAC encoder takes PCM samples, and can only count so many of them in a stream
+    if (is_ima_adpcm(wav_attr) || file_len_in_samples >= FLAC_ENCODER_MAX_TOTAL_SAMPLES)
+    {
+        return WAV_RECORDER_ERROR_INVALID_ARG_ERROR;
+    }
+
+    const uint32_t header_len = FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES;
+    frame_sample_number = 0;
+    carried_len_in_bytes = 0;
+#elif DEMO_CONFIG_RAW_CAPTURE == 1
+    // the raw file holds the stream just as the ADC sends it, its metadata goes in the sidecar
+    if (wav_attr->sample_rate != WAVE_HEADER_SAMPLE_RATE_384kHz || wav_attr->bits_per_sample != WAVE_HEADER_24_BITS_PER_SAMPLE)
+    {
+        return WAV_RECORDER_ERROR_INVALID_ARG_ERROR;
+    }
+
+    const uint32_t header_len = 0;
+#else
+#if DEMO_CONFIG_WRITE_BROADCAST_WAVE_CHUNK == 1
+    wav_header_enable_bext(true);
+#else
+    wav_header_enable_bext(false);
+#endif
+
+    wav_header_enable_ima_adpcm(is_ima_adpcm(wav_attr));
+
+    // files that won't fit in a plain WAVE file are written as RF64, the rest keep the plain header. IMA ADPCM files run
+    // out of room for their sample count first, the fact chunk only holds 32 bits of it
+    wav_header_enable_rf64(false);
+    wav_header_enable_rf64(wav_header_get_header_length() + encoded_len_in_bytes(wav_attr, file_len_in_samples) - 8 > UINT32_MAX ||
+                           (is_ima_adpcm(wav_attr) && file_len_in_samples > UINT32_MAX));
+
+    const uint32_t header_len = wav_header_get_header_length();
+#endif
+
+    wav_writer_set_checkpoint_interval((uint32_t)encoded_len_in_bytes(wav_attr, DEMO_CONFIG_CHECKPOINT_INTERVAL_IN_SECONDS * wav_attr->sample_rate));
+
+    decimation_filter_set_sample_rate(wav_attr->sample_rate);
+
+    // the SRAM for the whole ring is set aside at build time, so every recording gets all of it, a shallower ring
+    // would only give up stall tolerance for nothing
+    if (audio_dma_set_ring_depth(AUDIO_DMA_RING_DEPTH_IN_BLOCKS) != AUDIO_DMA_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_AUDIO_DMA_ERROR;
+    }
+
+    // blocks are processed in the block ready callback, the write task only writes out the processed blocks
+    processing_wav_attr = wav_attr;
+    recording_file_len_in_samples = file_len_in_samples;
+    is_waiting_for_card = false;
+    card_switch_err = WAV_RECORDER_ERROR_ALL_OK;
+    bytes_of_audio_per_file = audio_len_in_bytes;
+    bytes_left_in_file = bytes_of_audio_per_file;
+    num_files_left_to_process = num_files;
+    write_pipeline_reset(header_len);
+    ima_adpcm_reset();
+    audio_dma_set_block_ready_callback(process_available_blocks);
+
+    // the day directories are made afresh for every recording, it may not be in the same directory as the last one
+    date_dirs_forget();
+
+    // file names and time references count from the time on the clock right before the stream starts
+    tm_t start_time;
+    uint32_t start_millisecs;
+    read_start_time(&start_time, &start_millisecs);
+
+    recording_start_midnight = start_time;
+    recording_start_midnight.tm_hour = 0;
+    recording_start_midnight.tm_min = 0;
+    recording_start_midnight.tm_sec = 0;
+
+    const uint32_t start_secs_of_day = (start_time.tm_hour * 3600) + (start_time.tm_min * 60) + start_time.tm_sec;
+    recording_start_sample_of_day = ((uint64_t)start_secs_of_day * wav_attr->sample_rate) + (((uint64_t)start_millisecs * wav_attr->sample_rate) / 1000);
+
+#if DEMO_CONFIG_PROFILE_STAGES == 1
+    stage_profiler_reset();
+#endif
+
+    // the duty cycle of a recording counts from the start of the stream, like its length
+    duty_cycle_reset();
+
+    trace_log_event(TRACE_LOG_EVENT_RECORDING_START, (uint16_t)((wav_attr->bits_per_sample << 10) | (wav_attr->sample_rate / 1000)));
+
+    ad4630_cont_conversions_start();
+    audio_dma_start();
+
+    // the first file is opened while the first blocks wait in the DMA ring, just like every file after it
+    const Wav_Recorder_Error_t open_err = start_file(wav_attr, 0, file_len_in_samples, file_name);
+    if (open_err != WAV_RECORDER_ERROR_ALL_OK)
+    {
+        return stop_recording(open_err);
+    }
+
+    // the DMA keeps running from one file to the next, the last chunk of each file is marked by the write pipeline
+    recording_num_files = num_files;
+    num_files_written = 0;
+    done_callback = done;
+    is_recording = true;
+
+    // the block ready callback posts the write task for each chunk, the ones it submitted while the file opened wait
+    // for the write task to run once this returns
+    return WAV_RECORDER_ERROR_ALL_OK;
+}
+
+void write_next_chunk(Scheduler_Events_t events)
+{
+    (void)events;
+
+    // the block ready callback may post once more as the recording stops
+    if (!is_recording)
+    {
+        return;
+    }
+
+    if (audio_dma_overrun_occured())
+    {
+        finish_recording(WAV_RECORDER_ERROR_AUDIO_DMA_ERROR);
+        return;
+    }
+
+    // nothing can be written while the next card of the SD card bank settles, the chunks that come in meanwhile are
+    // posted again once it is mounted
+    if (is_waiting_for_card)
+    {
+        return;
+    }
+
+    if (card_switch_err != WAV_RECORDER_ERROR_ALL_OK)
+    {
+        finish_recording(card_switch_err);
+        return;
+    }
+
+    uint32_t len_in_bytes;
+    const uint8_t *chunk = write_pipeline_start_write(&len_in_bytes);
+
+    if (chunk == NULL)
+    {
+        // the chunk of this post went out with the file break written before it, nothing is left to write until the
+        // block ready callback submits the next chunk and posts again
+        scheduler_post(housekeeping_task, HOUSEKEEPING_EVENT_WRITES_CAUGHT_UP);
+        return;
+    }
+
+    trace_log_event(TRACE_LOG_EVENT_WRITE_START, len_in_bytes > UINT16_MAX ? UINT16_MAX : (uint16_t)len_in_bytes);
+    STAGE_PROFILER_BEGIN(STAGE_PROFILER_STAGE_WRITE);
+
+    // the block ready callback keeps processing the blocks behind this one into the other buffer while we write
+    if (wav_writer_write(chunk, len_in_bytes) != WAV_WRITER_ERROR_ALL_OK)
+    {
+        finish_recording(WAV_RECORDER_ERROR_SD_CARD_ERROR);
+        return;
+    }
+
+    const bool write_ends_file = write_pipeline_write_ends_file();
+    if (write_ends_file)
+    {
+        if (wav_writer_close() != WAV_WRITER_ERROR_ALL_OK)
+        {
+            finish_recording(WAV_RECORDER_ERROR_SD_CARD_ERROR);
+            return;
+        }
+
+        num_files_written += 1;
+
+        // only single file recordings have a fixed name
+        if (num_files_written < recording_num_files)
+        {
+            const Wav_Recorder_Error_t err = start_file(processing_wav_attr, num_files_written, recording_file_len_in_samples, NULL);
+            if (err != WAV_RECORDER_ERROR_ALL_OK)
+            {
+                finish_recording(err);
+                return;
+            }
+        }
+    }
+
+    write_pipeline_on_write_complete();
+
+    // the callback may have left blocks in the ring while both buffers were full, let it pick them up right away
+    audio_dma_request_block_ready_callback();
+
+    STAGE_PROFILER_END(STAGE_PROFILER_STAGE_WRITE);
+    trace_log_event(TRACE_LOG_EVENT_WRITE_END, 0);
+
+    // the trace goes out after the audio, so it never holds up a write, and only to a mounted card
+    if (!is_waiting_for_card)
+    {
+        trace_log_flush();
+    }
+
+    if (num_files_written == recording_num_files)
+    {
+        finish_recording(WAV_RECORDER_ERROR_ALL_OK);
+        return;
+    }
+
+    if (write_ends_file && !is_waiting_for_card)
+    {
+        // the rest of the buffer is the start of the next file, a chunk of its own that the callback didn't post for
+        scheduler_post(write_task, WRITE_EVENT_CHUNK_READY);
+    }
+    else if (write_pipeline_num_buffers_full() == 0)
+    {
+        scheduler_post(housekeeping_task, HOUSEKEEPING_EVENT_WRITES_CAUGHT_UP);
+    }
+}
+
+void do_housekeeping(Scheduler_Events_t events)
+{
+    (void)events;
+
+    // the trace can't be written while the next card of the SD card bank settles
+    if (!is_recording || is_waiting_for_card)
+    {
+        return;
+    }
+
+    // a good time to look for the next card of the SD card bank if it will be needed, and to write out the trace, which
+    // is best effort and never stops a recording
+    storage_manager_look_ahead();
+    trace_log_flush();
+}
+
+void finish_recording(Wav_Recorder_Error_t err)
+{
+    is_recording = false;
+    err = stop_recording(err);
+
+#if DEMO_CONFIG_GENERATE_CSV_OF_DUTY_CYCLE == 1
+    // before the other CSV files, so the time they take to write isn't counted
+    if (err == WAV_RECORDER_ERROR_ALL_OK)
+    {
+        err = append_duty_cycle_to_csv(processing_wav_attr);
+    }
+#endif
+
+#if DEMO_CONFIG_GENERATE_CSV_OF_DMA_RING_STATS == 1
+    if (err == WAV_RECORDER_ERROR_ALL_OK)
+    {
+        err = append_dma_ring_stats_to_csv(processing_wav_attr);
+    }
+#endif
+
+#if DEMO_CONFIG_PROFILE_STAGES == 1
+    if (err == WAV_RECORDER_ERROR_ALL_OK)
+    {
+        err = append_stage_profile_to_csv(processing_wav_attr);
+    }
+#endif
+
+    if (done_callback != NULL)
+    {
+        done_callback(err);
+    }
+}
+
+void finish_blocking_recording(Wav_Recorder_Error_t err)
+{
+    blocking_recording_err = err;
+    scheduler_stop();
+}
+
+Wav_Recorder_Error_t start_file(Wave_Header_Attributes_t *wav_attr, uint32_t file_idx, uint64_t file_len_in_samples, const char *file_name)
+{
+    trace_log_event(TRACE_LOG_EVENT_FILE_START, (uint16_t)file_idx);
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+    // in case every block comes out verbatim, the blocks at either end of the file may be split into frames of their own
+    const uint64_t max_num_frames = (file_len_in_samples / samples_per_block(wav_attr)) + 2;
+    const uint64_t file_len = FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES + bytes_of_audio_per_file + (max_num_frames * FLAC_ENCODER_FRAME_OVERHEAD_IN_BYTES);
+#elif DEMO_CONFIG_RAW_CAPTURE == 1
+    const uint64_t file_len = encoded_len_in_bytes(wav_attr, file_len_in_samples);
+#else
+    const uint64_t file_len = wav_header_get_header_length() + encoded_len_in_bytes(wav_attr, file_len_in_samples);
+#endif
+
+    // this may move on to the next card of the SD card bank, so the file is named after it
+    const Storage_Manager_Error_t err = storage_manager_make_room(file_len, on_card_switched);
+    if (err == STORAGE_MANAGER_ERROR_SWITCH_PENDING)
+    {
+        waiting_file_idx = file_idx;
+        waiting_file_name = file_name;
+        waiting_file_len_in_bytes = file_len;
+        is_waiting_for_card = true;
+        return WAV_RECORDER_ERROR_ALL_OK;
+    }
+
+    if (err != STORAGE_MANAGER_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    return open_file(wav_attr, file_idx, file_len_in_samples, file_name, file_len);
+}
+
+Wav_Recorder_Error_t open_file(Wave_Header_Attributes_t *wav_attr, uint32_t file_idx, uint64_t file_len_in_samples, const char *file_name,
+                               uint64_t file_len_in_bytes)
+{
+    // a string buffer to write file names into
+    static char file_name_buff[64];
+
+    const uint64_t sample_of_day = recording_start_sample_of_day + ((uint64_t)file_idx * file_len_in_samples);
+    const tm_t file_start_time = time_helpers_add_time(&recording_start_midnight, 0, 0, 0, (int)(sample_of_day / wav_attr->sample_rate));
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+    const Flac_Encoder_Stream_Info_t stream_info = {
+        .sample_rate = wav_attr->sample_rate,
+        .bits_per_sample = wav_attr->bits_per_sample,
+        .max_block_len_in_samples = samples_per_block(wav_attr) + FLAC_ENCODER_MIN_BLOCK_LEN_IN_SAMPLES - 1,
+        .total_samples = file_len_in_samples,
+    };
+#elif DEMO_CONFIG_RAW_CAPTURE == 0
+    // the time reference counts from midnight on the day the file starts
+    const Wave_Header_Broadcast_Attributes_t bext_attr = {
+        .year = file_start_time.tm_year + 1900,
+        .month = file_start_time.tm_mon + 1,
+        .day = file_start_time.tm_mday,
+        .hour = file_start_time.tm_hour,
+        .minute = file_start_time.tm_min,
+        .second = file_start_time.tm_sec,
+        .time_reference = sample_of_day % ((uint64_t)SECS_PER_DAY * wav_attr->sample_rate),
+    };
+    wav_header_set_broadcast_attributes(&bext_attr);
+#endif
+
+    if (file_name == NULL)
+    {
+        size_t len = 0;
+#if DEMO_CONFIG_SHARD_FILES_BY_DATE == 1
+        len = date_dirs_make(&file_start_time, file_name_buff);
+#endif
+        len += time_helpers_tm_to_string(&file_start_time, file_name_buff + len);
+        strcpy(file_name_buff + len, FILE_EXTENSION);
+        file_name = file_name_buff;
+    }
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+    const Wav_Writer_Error_t err = wav_writer_open_flac(file_name, &stream_info, file_len_in_bytes);
+#elif DEMO_CONFIG_RAW_CAPTURE == 1
+    // only one file is open at a time, so the sidecar is written first, and a raw file is never left without one
+    if (write_raw_sidecar(file_name, wav_attr, &file_start_time, sample_of_day, file_len_in_samples) != WAV_RECORDER_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    const Wav_Writer_Error_t err = wav_writer_open_raw(file_name, file_len_in_bytes);
+#else
+    const Wav_Writer_Error_t err = wav_writer_open(file_name, wav_attr, file_len_in_bytes);
+#endif
+
+    return err == WAV_WRITER_ERROR_ALL_OK ? WAV_RECORDER_ERROR_ALL_OK : WAV_RECORDER_ERROR_SD_CARD_ERROR;
+}
+
+void on_card_switched(Storage_Manager_Error_t err)
+{
+    is_waiting_for_card = false;
+
+    // the recording may have stopped on a DMA overrun while the card settled
+    if (!is_recording)
+    {
+        return;
+    }
+
+    if (err == STORAGE_MANAGER_ERROR_ALL_OK)
+    {
+        card_switch_err = open_file(processing_wav_attr, waiting_file_idx, recording_file_len_in_samples, waiting_file_name, waiting_file_len_in_bytes);
+    }
+    else
+    {
+        card_switch_err = WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    // the write task dropped the posts of the chunks that came in while it waited, an error is handled there too
+    const uint32_t num_chunks = write_pipeline_num_buffers_full();
+    for (uint32_t i = 0; i < (num_chunks > 0 ? num_chunks : 1); i++)
+    {
+        scheduler_post(write_task, WRITE_EVENT_CHUNK_READY);
+    }
+}
+
+void read_start_time(tm_t *start_time, uint32_t *start_millisecs)
+{
+    // the clock doesn't fill in every field
+    *start_time = time_helpers_get_default_time();
+    *start_millisecs = 0;
+
+    int millisecs_before;
+    int millisecs_after;
+
+    if (real_time_clock_get_milliseconds(&millisecs_before) == REAL_TIME_CLOCK_ERROR_ALL_OK)
+    {
+        // if the milliseconds went backwards the seconds ticked over while we read the date and time, so read it again
+        do
+        {
+            real_time_clock_get_milliseconds(&millisecs_before);
+
+            if (real_time_clock_get_datetime(start_time) != REAL_TIME_CLOCK_ERROR_ALL_OK)
+            {
+                *start_time = time_helpers_get_default_time();
+                return;
+            }
+
+            real_time_clock_get_milliseconds(&millisecs_after);
+        } while (millisecs_after < millisecs_before);
+
+        *start_millisecs = (uint32_t)millisecs_after;
+        return;
+    }
+
+    if (real_time_clock_get_datetime(start_time) != REAL_TIME_CLOCK_ERROR_ALL_OK)
+    {
+        *start_time = time_helpers_get_default_time();
+        return;
+    }
+
+    // poll until the seconds tick over, the start of the stream is then as close to a whole second as an I2C read
+    tm_t now = *start_time;
+    while (now.tm_sec == start_time->tm_sec)
+    {
+        if (real_time_clock_get_datetime(&now) != REAL_TIME_CLOCK_ERROR_ALL_OK)
+        {
+            return;
+        }
+    }
+
+    *start_time = now;
+}
+
+bool is_ima_adpcm(const Wave_Header_Attributes_t *wav_attr)
+{
+    return wav_attr->bits_per_sample == WAVE_HEADER_4_BITS_PER_SAMPLE_IMA_ADPCM;
+}
+
+uint32_t bytes_per_sample(const Wave_Header_Attributes_t *wav_attr)
+{
+    return is_ima_adpcm(wav_attr) ? DATA_CONVERTERS_Q15_SIZE_IN_BYTES : wav_attr->bits_per_sample / 8;
+}
+
+uint64_t encoded_len_in_bytes(const Wave_Header_Attributes_t *wav_attr, uint64_t num_samples)
+{
+    if (is_ima_adpcm(wav_attr))
+    {
+        return (num_samples / IMA_ADPCM_SAMPLES_PER_BLOCK) * IMA_ADPCM_BLOCK_LEN_IN_BYTES;
+    }
+
+    return num_samples * bytes_per_sample(wav_attr);
+}
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+uint32_t samples_per_block(const Wave_Header_Attributes_t *wav_attr)
+{
+    const uint32_t decimation_factor = WAVE_HEADER_SAMPLE_RATE_384kHz / wav_attr->sample_rate;
+    return AUDIO_DMA_BUFF_LEN_IN_SAMPS / decimation_factor;
+}
+#endif
+
+Wav_Recorder_Error_t stop_recording(Wav_Recorder_Error_t err)
+{
+    ad4630_cont_conversions_stop();
+    audio_dma_stop();
+    audio_dma_set_block_ready_callback(NULL);
+
+    // a recording that stops on an error may leave its file open, closing it syncs the audio written so far and frees
+    // the one file handle of the SD card for the next recording. The first error is the one reported
+    if (wav_writer_is_open() && wav_writer_close() != WAV_WRITER_ERROR_ALL_OK && err == WAV_RECORDER_ERROR_ALL_OK)
+    {
+        err = WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    // the trace of the recording is on the card once its file is closed, whether it could be written or not doesn't
+    // change how the recording went
+    trace_log_event(TRACE_LOG_EVENT_RECORDING_END, (uint16_t)err);
+    trace_log_close();
+
+    return err;
+}
+
+void process_available_blocks()
+{
+    // every pass of the loop submits one buffer
+    uint32_t num_submitted = 0;
+
+    while (num_files_left_to_process > 0 && audio_dma_num_buffers_available() > 0)
+    {
+        uint8_t *dest = write_pipeline_get_free_buffer();
+
+        // both buffers are waiting on the SD card, leave the rest in the DMA ring until a write completes
+        if (dest == NULL)
+        {
+            break;
+        }
+
+        num_submitted += 1;
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+        encode_block(audio_dma_consume_buffer(), dest);
+#else
+        if (is_ima_adpcm(processing_wav_attr))
+        {
+            encode_ima_adpcm_block(audio_dma_consume_buffer(), dest);
+            continue;
+        }
+
+        const uint32_t len_in_bytes = process_block(audio_dma_consume_buffer(), dest);
+
+        if (len_in_bytes < bytes_left_in_file)
+        {
+            write_pipeline_submit_buffer(len_in_bytes);
+            bytes_left_in_file -= len_in_bytes;
+            continue;
+        }
+
+        num_files_left_to_process -= 1;
+
+        if (num_files_left_to_process == 0)
+        {
+            // the rest of the block is past the end of the recording
+            write_pipeline_submit_buffer_with_file_break((uint32_t)bytes_left_in_file, (uint32_t)bytes_left_in_file);
+        }
+        else
+        {
+            // files are at least a block long, so the rest of the block fits in the next file
+            write_pipeline_submit_buffer_with_file_break(len_in_bytes, (uint32_t)bytes_left_in_file);
+            bytes_left_in_file = bytes_of_audio_per_file - (len_in_bytes - bytes_left_in_file);
+        }
+#endif
+    }
+
+    // the write task runs once for each chunk submitted above, the chunks are only posted once they are submitted, so a
+    // run never finds its chunk missing. An overrun with nothing submitted still needs a run to end the recording
+    for (uint32_t i = 0; i < num_submitted; i++)
+    {
+        scheduler_post(write_task, WRITE_EVENT_CHUNK_READY);
+    }
+
+    if (num_submitted == 0 && audio_dma_overrun_occured())
+    {
+        scheduler_post(write_task, WRITE_EVENT_CHUNK_READY);
+    }
+}
+
+uint32_t process_block(uint8_t *dma_block, uint8_t *dest)
+{
+#if DEMO_CONFIG_RAW_CAPTURE == 1
+    trace_log_event(TRACE_LOG_EVENT_CONVERT_START, 0);
+    STAGE_PROFILER_BEGIN(STAGE_PROFILER_STAGE_CONVERT);
+
+    // the samples go out as the ADC sent them, big-endian, they are only copied so the DMA can refill its block while
+    // the write pipeline buffer waits on the SD card
+    memcpy(dest, dma_block, AUDIO_DMA_BUFF_LEN_IN_BYTES);
+
+    STAGE_PROFILER_END(STAGE_PROFILER_STAGE_CONVERT);
+    trace_log_event(TRACE_LOG_EVENT_CONVERT_END, 0);
+    return AUDIO_DMA_BUFF_LEN_IN_BYTES;
+#else
+    // a buffer for processing the audio data, big enough to fit one full buffers worth of samples as q31s
+    static uint8_t audio_buff[AUDIO_DMA_BUFF_LEN_IN_SAMPS * 4];
+
+    if (processing_wav_attr->sample_rate == WAVE_HEADER_SAMPLE_RATE_384kHz)
+    {
+        trace_log_event(TRACE_LOG_EVENT_CONVERT_START, 0);
+        STAGE_PROFILER_BEGIN(STAGE_PROFILER_STAGE_CONVERT);
+
+        // for 384kHz data, we just need to swap the endianness of the sample to little-endian format needed for WAV
+        data_converters_i24_swap_endianness(dma_block, dest, AUDIO_DMA_BUFF_LEN_IN_BYTES);
+
+        // it must be 16 bits if it's not 24
+        const uint32_t len_in_bytes = processing_wav_attr->bits_per_sample == WAVE_HEADER_24_BITS_PER_SAMPLE
+                                          ? AUDIO_DMA_BUFF_LEN_IN_BYTES
+                                          : data_converters_i24_to_q15(dest, (q15_t *)dest, AUDIO_DMA_BUFF_LEN_IN_BYTES);
+
+        STAGE_PROFILER_END(STAGE_PROFILER_STAGE_CONVERT);
+        trace_log_event(TRACE_LOG_EVENT_CONVERT_END, 0);
+        return len_in_bytes;
+    }
+
+    trace_log_event(TRACE_LOG_EVENT_CONVERT_START, 0);
+    STAGE_PROFILER_BEGIN(STAGE_PROFILER_STAGE_CONVERT);
+
+    // all sample rates other than 384k are filtered, so we need to swap endianness and also expand to 32 bit words as expected by the filters
+    data_converters_i24_to_q31_with_endian_swap(dma_block, (q31_t *)audio_buff, AUDIO_DMA_BUFF_LEN_IN_BYTES);
+
+    STAGE_PROFILER_END(STAGE_PROFILER_STAGE_CONVERT);
+    trace_log_event(TRACE_LOG_EVENT_CONVERT_END, 0);
+    trace_log_event(TRACE_LOG_EVENT_DECIMATE_START, 0);
+    STAGE_PROFILER_BEGIN(STAGE_PROFILER_STAGE_DECIMATE);
+
+    // at least 2x decimation, so the q31 output always fits in a write pipeline buffer sized for 384kHz 24 bit samples
+    const uint32_t len_in_samps = decimation_filter_downsample(
+        (q31_t *)audio_buff,
+        (q31_t *)dest,
+        AUDIO_DMA_BUFF_LEN_IN_SAMPS); // we want num samples, not num bytes
+
+    STAGE_PROFILER_END(STAGE_PROFILER_STAGE_DECIMATE);
+    trace_log_event(TRACE_LOG_EVENT_DECIMATE_END, 0);
+    trace_log_event(TRACE_LOG_EVENT_CONVERT_START, 0);
+    STAGE_PROFILER_BEGIN(STAGE_PROFILER_STAGE_CONVERT);
+
+    // note that the data conversion functions for truncating down to 16 and 24 bits can work in-place, it's 16 bits if
+    // it's not 24
+    const uint32_t len_in_bytes = processing_wav_attr->bits_per_sample == WAVE_HEADER_24_BITS_PER_SAMPLE
+                                      ? data_converters_q31_to_i24((q31_t *)dest, dest, len_in_samps)
+                                      : data_converters_q31_to_q15((q31_t *)dest, (q15_t *)dest, len_in_samps);
+
+    STAGE_PROFILER_END(STAGE_PROFILER_STAGE_CONVERT);
+    trace_log_event(TRACE_LOG_EVENT_CONVERT_END, 0);
+    return len_in_bytes;
+#endif
+}
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 0
+void encode_ima_adpcm_block(uint8_t *dma_block, uint8_t *dest)
+{
+    const uint32_t len_in_bytes = process_block(dma_block, dest);
+    const int16_t *pcm = (const int16_t *)dest;
+    uint8_t *encoded = dest + len_in_bytes;
+
+    trace_log_event(TRACE_LOG_EVENT_ENCODE_START, 0);
+    STAGE_PROFILER_BEGIN(STAGE_PROFILER_STAGE_ENCODE);
+
+    if (len_in_bytes < bytes_left_in_file)
+    {
+        const uint32_t encoded_len = ima_adpcm_encode(pcm, len_in_bytes / DATA_CONVERTERS_Q15_SIZE_IN_BYTES, encoded);
+        STAGE_PROFILER_END(STAGE_PROFILER_STAGE_ENCODE);
+        trace_log_event(TRACE_LOG_EVENT_ENCODE_END, 0);
+        memmove(dest, encoded, encoded_len);
+        write_pipeline_submit_buffer(encoded_len);
+        bytes_left_in_file -= len_in_bytes;
+        return;
+    }
+
+    num_files_left_to_process -= 1;
+
+    const uint32_t num_samples_in_current_file = (uint32_t)bytes_left_in_file / DATA_CONVERTERS_Q15_SIZE_IN_BYTES;
+    const uint32_t len_in_current_file = ima_adpcm_encode(pcm, num_samples_in_current_file, encoded);
+    uint32_t encoded_len = len_in_current_file;
+
+    // the rest of the block is past the end of the recording unless there's another file
+    if (num_files_left_to_process > 0)
+    {
+        const uint32_t next_len_in_bytes = len_in_bytes - (uint32_t)bytes_left_in_file;
+        encoded_len += ima_adpcm_encode(pcm + num_samples_in_current_file, next_len_in_bytes / DATA_CONVERTERS_Q15_SIZE_IN_BYTES, encoded + len_in_current_file);
+        bytes_left_in_file = bytes_of_audio_per_file - next_len_in_bytes;
+    }
+
+    STAGE_PROFILER_END(STAGE_PROFILER_STAGE_ENCODE);
+    trace_log_event(TRACE_LOG_EVENT_ENCODE_END, 0);
+    memmove(dest, encoded, encoded_len);
+    write_pipeline_submit_buffer_with_file_break(encoded_len, len_in_current_file);
+}
+#endif
+
+#if DEMO_CONFIG_COMPRESS_FLAC == 1
+void encode_block(uint8_t *dma_block, uint8_t *dest)
+{
+    // the processed samples go right after any carried over from the last block, so they are encoded together
+    static uint8_t pcm_buff[MAX_CARRIED_LEN_IN_BYTES + AUDIO_DMA_BUFF_LEN_IN_BYTES] __attribute__((aligned(4)));
+
+    const uint8_t *pcm = pcm_buff + MAX_CARRIED_LEN_IN_BYTES - carried_len_in_bytes;
+    const uint32_t len_in_bytes = carried_len_in_bytes + process_block(dma_block, pcm_buff + MAX_CARRIED_LEN_IN_BYTES);
+    carried_len_in_bytes = 0;
+
+    if (len_in_bytes < bytes_left_in_file)
+    {
+        write_pipeline_submit_buffer(encode_frame(pcm, len_in_bytes, dest));
+        bytes_left_in_file -= len_in_bytes;
+        return;
+    }
+
+    num_files_left_to_process -= 1;
+
+    const uint32_t len_in_current_file = encode_frame(pcm, (uint32_t)bytes_left_in_file, dest);
+
+    // the rest of the block is past the end of the recording
+    if (num_files_left_to_process == 0)
+    {
+        write_pipeline_submit_buffer_with_file_break(len_in_current_file, len_in_current_file);
+        return;
+    }
+
+    // the next file numbers its samples from 0
+    const uint8_t *next_pcm = pcm + bytes_left_in_file;
+    const uint32_t next_len_in_bytes = len_in_bytes - (uint32_t)bytes_left_in_file;
+    bytes_left_in_file = bytes_of_audio_per_file;
+    frame_sample_number = 0;
+
+    if (next_len_in_bytes < FLAC_ENCODER_MIN_BLOCK_LEN_IN_SAMPLES * bytes_per_sample(processing_wav_attr))
+    {
+        memmove(pcm_buff + MAX_CARRIED_LEN_IN_BYTES - next_len_in_bytes, next_pcm, next_len_in_bytes);
+        carried_len_in_bytes = next_len_in_bytes;
+        write_pipeline_submit_buffer_with_file_break(len_in_current_file, len_in_current_file);
+        return;
+    }
+
+    const uint32_t len_in_next_file = encode_frame(next_pcm, next_len_in_bytes, dest + len_in_current_file);
+    bytes_left_in_file -= next_len_in_bytes;
+    write_pipeline_submit_buffer_with_file_break(len_in_current_file + len_in_next_file, len_in_current_file);
+}
+
+uint32_t encode_frame(const uint8_t *pcm, uint32_t len_in_bytes, uint8_t *dest)
+{
+    const uint32_t num_samples = len_in_bytes / bytes_per_sample(processing_wav_attr);
+
+    trace_log_event(TRACE_LOG_EVENT_ENCODE_START, 0);
+    STAGE_PROFILER_BEGIN(STAGE_PROFILER_STAGE_ENCODE);
+    const uint32_t len = flac_encoder_encode_frame(pcm, num_samples, processing_wav_attr->bits_per_sample, frame_sample_number, dest);
+    STAGE_PROFILER_END(STAGE_PROFILER_STAGE_ENCODE);
+    trace_log_event(TRACE_LOG_EVENT_ENCODE_END, 0);
+
+    frame_sample_number += num_samples;
+
+    return len;
+}
+#endif
+
+#if DEMO_CONFIG_RAW_CAPTURE == 1
+Wav_Recorder_Error_t write_raw_sidecar(const char *file_name, const Wave_Header_Attributes_t *wav_attr, const tm_t *start_time,
+                                       uint64_t sample_of_day, uint64_t file_len_in_samples)
+{
+    static char sidecar_name_buff[64];
+    static char str_buff[256];
+    uint32_t bytes_written;
+
+    // the sidecar is named like the raw file, with its own extension
+    const size_t stem_len = strlen(file_name) - strlen(FILE_EXTENSION);
+    memcpy(sidecar_name_buff, file_name, stem_len);
+    strcpy(sidecar_name_buff + stem_len, RAW_SIDECAR_EXTENSION);
+
+    if (sd_card_fopen(sidecar_name_buff, POSIX_FILE_MODE_WRITE) != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    const uint64_t samples_per_day = (uint64_t)SECS_PER_DAY * wav_attr->sample_rate;
+
+    uint32_t len = sprintf(str_buff, "format=raw\nsample_rate=%" PRIu32 "\nbits_per_sample=%" PRIu32 "\nchannels=1\nbyte_order=big\nnum_samples=",
+                           (uint32_t)wav_attr->sample_rate, (uint32_t)wav_attr->bits_per_sample);
+    len += sprint_u64(str_buff + len, file_len_in_samples);
+    len += sprintf(str_buff + len, "\nstart_time=%04d-%02d-%02d %02d:%02d:%02d\ntime_reference=", start_time->tm_year + 1900,
+                   start_time->tm_mon + 1, start_time->tm_mday, start_time->tm_hour, start_time->tm_min, start_time->tm_sec);
+    len += sprint_u64(str_buff + len, sample_of_day % samples_per_day);
+    len += sprintf(str_buff + len, "\n");
+
+    if (sd_card_fwrite(str_buff, len, &bytes_written) != SD_CARD_ERROR_ALL_OK)
+    {
+        sd_card_fclose();
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    return sd_card_fclose() == SD_CARD_ERROR_ALL_OK ? WAV_RECORDER_ERROR_ALL_OK : WAV_RECORDER_ERROR_SD_CARD_ERROR;
+}
+
+uint32_t sprint_u64(char *str_buff, uint64_t n)
+{
+    // newlib nano's printf has no %llu, so the count goes out in two halves of at most 9 digits
+    if (n < 1000000000)
+    {
+        return sprintf(str_buff, "%" PRIu32, (uint32_t)n);
+    }
+
+    return sprintf(str_buff, "%" PRIu32 "%09" PRIu32, (uint32_t)(n / 1000000000), (uint32_t)(n % 1000000000));
+}
+#endif
+
+#if DEMO_CONFIG_GENERATE_CSV_OF_DMA_RING_STATS == 1
+Wav_Recorder_Error_t append_dma_ring_stats_to_csv(Wave_Header_Attributes_t *wav_attr)
+{
+    static char str_buff[64] = {0};
+    static uint32_t bytes_written;
+
+    const Audio_DMA_Ring_Stats_t *stats = audio_dma_get_stats();
+
+    const uint32_t mean_drain_time_microsecs = stats->num_stalls == 0
+                                                   ? 0
+                                                   : (stats->total_drain_time_in_blocks * AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS) / stats->num_stalls;
+
+    if (sd_card_fopen("dma_ring_stats.csv", POSIX_FILE_MODE_APPEND) != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    // one row per recording: name, depth, peak occupancy, overruns, stalls, max/mean drain time, then the lag histogram
+    uint32_t len = sprintf(str_buff, "\n%" PRIu32 "k-%" PRIu32 "bit,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",",
+                           (uint32_t)wav_attr->sample_rate / 1000, (uint32_t)wav_attr->bits_per_sample,
+                           stats->depth_in_blocks, stats->peak_occupancy_in_blocks, stats->num_overruns, stats->num_stalls);
+    if (sd_card_fwrite(str_buff, len, &bytes_written) != SD_CARD_ERROR_ALL_OK)
+    {
+        sd_card_fclose();
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    len = sprintf(str_buff, "%" PRIu32 ",%" PRIu32, (uint32_t)(stats->max_drain_time_in_blocks * AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS),
+                  mean_drain_time_microsecs);
+    if (sd_card_fwrite(str_buff, len, &bytes_written) != SD_CARD_ERROR_ALL_OK)
+    {
+        sd_card_fclose();
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    for (uint32_t i = 0; i < AUDIO_DMA_RING_LAG_HISTOGRAM_NUM_BINS; i++)
+    {
+        len = sprintf(str_buff, ",%" PRIu32, stats->lag_histogram[i]);
+        if (sd_card_fwrite(str_buff, len, &bytes_written) != SD_CARD_ERROR_ALL_OK)
+        {
+            sd_card_fclose();
+            return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+        }
+    }
+
+    if (sd_card_fclose() != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    return WAV_RECORDER_ERROR_ALL_OK;
+}
+#endif
+
+#if DEMO_CONFIG_GENERATE_CSV_OF_DUTY_CYCLE == 1
+Wav_Recorder_Error_t append_duty_cycle_to_csv(Wave_Header_Attributes_t *wav_attr)
+{
+    static char str_buff[64] = {0};
+    static uint32_t bytes_written;
+
+    const uint64_t awake_microsecs = duty_cycle_awake_microsecs();
+
+    // the DMA fills each block in exactly one block period, so the blocks consumed time the recording on the ADC clock
+    const uint64_t recording_microsecs = (uint64_t)audio_dma_get_stats()->num_blocks_consumed * AUDIO_DMA_CHUNK_READY_PERIOD_IN_MICROSECS;
+    const uint32_t awake_permille = recording_microsecs == 0 ? 0 : (uint32_t)((awake_microsecs * 1000) / recording_microsecs);
+
+    // each block wakes the core at least once, anything over that is a timer or another interrupt
+    const uint32_t num_blocks = audio_dma_get_stats()->num_blocks_consumed;
+    const uint32_t centi_sleeps_per_block = num_blocks == 0 ? 0 : (uint32_t)(((uint64_t)duty_cycle_num_sleeps() * 100) / num_blocks);
+
+    if (sd_card_fopen("duty_cycle.csv", POSIX_FILE_MODE_APPEND) != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    // one row per recording: name, length and time awake in milliseconds, percent awake, number of sleeps, sleeps per block
+    const uint32_t len = sprintf(str_buff, "\n%" PRIu32 "k-%" PRIu32 "bit,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ".%" PRIu32 ",%" PRIu32 ",%" PRIu32 ".%02" PRIu32,
+                                 (uint32_t)wav_attr->sample_rate / 1000, (uint32_t)wav_attr->bits_per_sample,
+                                 (uint32_t)(recording_microsecs / 1000), (uint32_t)(awake_microsecs / 1000),
+                                 awake_permille / 10, awake_permille % 10, duty_cycle_num_sleeps(),
+                                 centi_sleeps_per_block / 100, centi_sleeps_per_block % 100);
+    if (sd_card_fwrite(str_buff, len, &bytes_written) != SD_CARD_ERROR_ALL_OK)
+    {
+        sd_card_fclose();
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    if (sd_card_fclose() != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    return WAV_RECORDER_ERROR_ALL_OK;
+}
+#endif
+
+#if DEMO_CONFIG_PROFILE_STAGES == 1
+Wav_Recorder_Error_t append_stage_profile_to_csv(Wave_Header_Attributes_t *wav_attr)
+{
+    static char str_buff[128] = {0};
+    static uint32_t bytes_written;
+
+    if (sd_card_fopen("stage_profile.csv", POSIX_FILE_MODE_APPEND) != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    // one row per stage: recording, stage, calls, min/mean/p99/max time, budget, calls over budget
+    for (uint32_t i = 0; i < STAGE_PROFILER_NUM_STAGES; i++)
+    {
+        const Stage_Profiler_Stage_t stage = (Stage_Profiler_Stage_t)i;
+        const Stage_Profiler_Stats_t *stats = stage_profiler_get_stats(stage);
+
+        const uint32_t len = sprintf(str_buff, "\n%" PRIu32 "k-%" PRIu32 "bit,%s,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32,
+                                     (uint32_t)wav_attr->sample_rate / 1000, (uint32_t)wav_attr->bits_per_sample,
+                                     stage_profiler_stage_name(stage), stats->num_calls,
+                                     stats->num_calls == 0 ? 0 : stage_profiler_cycles_to_microsecs(stats->min_cycles),
+                                     stage_profiler_mean_microsecs(stage), stage_profiler_percentile_microsecs(stage, 99),
+                                     stage_profiler_cycles_to_microsecs(stats->max_cycles), stage_profiler_budget_microsecs(stage),
+                                     stats->num_over_budget);
+        if (sd_card_fwrite(str_buff, len, &bytes_written) != SD_CARD_ERROR_ALL_OK)
+        {
+            sd_card_fclose();
+            return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+        }
+    }
+
+    if (sd_card_fclose() != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_RECORDER_ERROR_SD_CARD_ERROR;
+    }
+
+    return WAV_RECORDER_ERROR_ALL_OK;
+}
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file      wav_recorder.h
+ * @brief     A software interface for recording audio from the ADC/DMA stream into WAVE files is represented here.
+ * @details   This module ties together the audio DMA, the data converters, the decimation filters, the wav header,
+ *            and the SD card. It only talks to those modules through their public interfaces, so the same recording
+ *            loop runs on the MAX32666 and on a host PC with simulated audio DMA and SD card back-ends.
+ *
+ *            A recording runs as tasks of the scheduler, see `scheduler.h`. The block ready callback of the DMA posts
+ *            to a high priority task that writes out each processed chunk, and a low priority task does the
+ *            housekeeping once the writes have caught up, so the main loop is free to run other tasks between chunks.
+ *            `wav_recorder_start_demo_file()` and `wav_recorder_start_continuous()` start a recording and return, the
+ *            done callback is called when it ends. `write_demo_wav_file()` and `wav_recorder_record_continuous()`
+ *            run the scheduler until the recording ends, for callers with nothing else to do.
+ */
+
+#ifndef WAV_RECORDER_H_
+#define WAV_RECORDER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "wav_header.h"
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Wav recorder errors are represented here
+ */
+typedef enum
+{
+    WAV_RECORDER_ERROR_ALL_OK,
+    WAV_RECORDER_ERROR_SD_CARD_ERROR,
+    WAV_RECORDER_ERROR_AUDIO_DMA_ERROR,
+    WAV_RECORDER_ERROR_INVALID_ARG_ERROR,
+    WAV_RECORDER_ERROR_BUSY_ERROR,
+    WAV_RECORDER_ERROR_SCHEDULER_ERROR,
+} Wav_Recorder_Error_t;
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A function called when a recording ends is represented here, it is passed how the recording went and runs in
+ * the write task.
+ */
+typedef void (*Wav_Recorder_Done_Callback_t)(Wav_Recorder_Error_t err);
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `wav_recorder_init()` adds the write and housekeeping tasks of the recorder to the scheduler, this must be
+ * called once before recording.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the tasks were added, else an error code
+ */
+Wav_Recorder_Error_t wav_recorder_init();
+
+/**
+ * @brief `wav_recorder_start_demo_file(a, l, d)` starts the recording of `write_demo_wav_file(a, l)` and returns, the
+ * scheduler carries it on and calls `d` when the file is written or an error stops it.
+ *
+ * @pre as for `write_demo_wav_file()`, and `wav_recorder_init()` was called, and the scheduler runs, see `scheduler.h`.
+ * `a` stays valid until `d` is called.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the recording started, else an error code, the ADC and DMA are stopped and
+ * `d` is not called. `WAV_RECORDER_ERROR_BUSY_ERROR` if a recording is in progress already
+ */
+Wav_Recorder_Error_t wav_recorder_start_demo_file(Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_samples, Wav_Recorder_Done_Callback_t done);
+
+/**
+ * @brief `wav_recorder_start_continuous(a, l, n, d)` starts the recording of `wav_recorder_record_continuous(a, l, n)`
+ * and returns, the scheduler carries it on and calls `d` when all the files are written or an error stops it.
+ *
+ * @pre as for `wav_recorder_record_continuous()`, and `wav_recorder_init()` was called, and the scheduler runs, see
+ * `scheduler.h`. `a` stays valid until `d` is called.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the recording started, else an error code, the ADC and DMA are stopped and
+ * `d` is not called. `WAV_RECORDER_ERROR_BUSY_ERROR` if a recording is in progress already
+ */
+Wav_Recorder_Error_t wav_recorder_start_continuous(Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_samples, uint32_t num_files,
+                                                   Wav_Recorder_Done_Callback_t done);
+
+/**
+ * @brief `wav_recorder_is_recording()` is true from the time a recording starts until its done callback is called.
+ */
+bool wav_recorder_is_recording();
+
+/**
+ * @brief `write_demo_wav_file(a, l)` writes a wav file with attributes `a`, exactly `l` samples long, with a name
+ * derived from the attributes. Calling this function starts the ADC/DMA and continuously records audio in blocking
+ * fashion until the last sample is written, running the scheduler meanwhile.
+ *
+ * @pre initialization is complete for the ADC, DMA, decimation filters, recorder, and SD card, the SD card must be
+ * mounted. The scheduler is not running, this is never called from a task
+ *
+ * @param wav_attr pointer to the wav header attributes structure holding information about sample rate, bit depth, etc
+ *
+ * @param file_len_in_samples the length of the audio file to write in samples at the sample rate of `a`, see
+ * `wav_recorder_secs_to_samples()`. The file ends part way through the DMA block its last sample is in, the rest of the
+ * block is dropped. IMA ADPCM files are rounded down to a whole number of blocks of `IMA_ADPCM_SAMPLES_PER_BLOCK`, and
+ * FLAC files must be shorter than `FLAC_ENCODER_MAX_TOTAL_SAMPLES`
+ *
+ * @post this function consumes buffers from the ADC/DMA until the last sample of the file and writes
+ * the audio data out to a .wav file on the SD card. The wav header for the file is also written in this function.
+ * If an error occurs the ADC and DMA are stopped before returning.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if the file was written, else an error code
+ */
+Wav_Recorder_Error_t write_demo_wav_file(Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_samples);
+
+/**
+ * @brief `wav_recorder_record_continuous(a, l, n)` records `n` back to back wav files with attributes `a`, each `l`
+ * samples long, named "YYYYmmdd_HHMMSS.wav" after the time on the real time clock when each file starts. The ADC/DMA
+ * runs without a break for the whole recording, so no audio is lost between files.
+ * With `DEMO_CONFIG_SHARD_FILES_BY_DATE` set each file goes in the "YYYY/MM/DD/" directory of its day, under the current
+ * directory, see `date_dirs.h`.
+ * With `DEMO_CONFIG_WRITE_BROADCAST_WAVE_CHUNK` set each file gets a Broadcast Wave `bext` chunk with the time of its
+ * first sample, counted in samples from the time the stream started.
+ *
+ * @pre initialization is complete for the ADC, DMA, decimation filters, real time clock, recorder, and SD card, the SD
+ * card must be mounted. If the real time clock can't be read the files are named after
+ * `time_helpers_get_default_time()`. The scheduler is not running, this is never called from a task, it runs the
+ * scheduler until the recording ends.
+ *
+ * @param wav_attr pointer to the wav header attributes structure holding information about sample rate, bit depth, etc
+ *
+ * @param file_len_in_samples the length of each file in samples, at least one second of audio if `n` > 1 so that every
+ * file gets its own name, see `wav_recorder_secs_to_samples()` and `wav_recorder_bytes_to_samples()`. Each file ends on
+ * its last sample and the next one starts on the sample after it, wherever they fall in the DMA blocks. IMA ADPCM files
+ * are rounded down to a whole number of blocks of `IMA_ADPCM_SAMPLES_PER_BLOCK`, and FLAC files must be shorter than
+ * `FLAC_ENCODER_MAX_TOTAL_SAMPLES`
+ *
+ * @param num_files the number of files to record, at least 1
+ *
+ * @post each file is closed with its final wav header as soon as its last sample is written, and the next file is
+ * opened for the next sample. If an error occurs the ADC and DMA are stopped before returning.
+ *
+ * @retval `WAV_RECORDER_ERROR_ALL_OK` if all the files were written, else an error code
+ */
+Wav_Recorder_Error_t wav_recorder_record_continuous(Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_samples, uint32_t num_files);
+
+/**
+ * @brief `wav_recorder_secs_to_samples(a, s)` is the number of samples in `s` seconds of audio with attributes `a`, in 64
+ * bits, so recordings of any length in seconds can be counted.
+ */
+uint64_t wav_recorder_secs_to_samples(const Wave_Header_Attributes_t *wav_attr, uint32_t secs);
+
+/**
+ * @brief `wav_recorder_bytes_to_samples(a, n)` is the number of whole samples in `n` bytes of audio data with attributes
+ * `a`, not counting the header, or the samples in the whole blocks of `n` bytes of IMA ADPCM.
+ */
+uint64_t wav_recorder_bytes_to_samples(const Wave_Header_Attributes_t *wav_attr, uint64_t len_in_bytes);
+
+#endif /* WAV_RECORDER_H_ */
@@ -0,0 +1,363 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "demo_config.h"
+#include "flac_encoder.h"
+#include "sd_card.h"
+#include "stage_profiler.h"
+#include "wav_header.h"
+#include "wav_writer.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// enough of the start of a file to hold the biggest header we write, headers from elsewhere with more chunks in front
+// of the audio than this are left alone by the recovery
+#define RECOVERY_HEADER_BUFF_LEN (1024)
+
+// FatFS long file names are at most 255 characters
+#define FILE_NAME_BUFF_LEN (256)
+#define FILE_PATH_BUFF_LEN (320)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static uint32_t checkpoint_interval_in_bytes = 0;
+
+// a file was opened and hasn't been closed yet, even if writing to it failed
+static bool is_open = false;
+
+// the open file is a WAVE file with a header to keep up to date, FLAC streams and raw files have none
+static bool has_header;
+
+// the attributes and the amount of audio of the open file
+static Wave_Header_Attributes_t *file_attr;
+static uint64_t audio_len_in_bytes;
+static uint64_t bytes_since_checkpoint;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `open_file(n, l)` creates the file named `n`, allocates `l` bytes for it if files are preallocated, and resets
+ * the amount of audio written.
+ */
+static Wav_Writer_Error_t open_file(const char *file_name, uint64_t file_len_in_bytes);
+
+/**
+ * @brief `write_header(n)` rewrites the header of the open file for `n` bytes of audio, rounded down to whole samples,
+ * and moves the file position back to the end of the audio.
+ */
+static Wav_Writer_Error_t write_header(uint64_t len_in_bytes);
+
+/**
+ * @brief `checkpoint()` rewrites the header for the audio written so far and syncs the file, so it all survives a
+ * power cut.
+ */
+static Wav_Writer_Error_t checkpoint();
+
+/**
+ * @brief `repair_file(p, r)` repairs the file at path `p` if it needs it, and stores whether it did in `r`.
+ */
+static Wav_Writer_Error_t repair_file(const char *path, bool *was_repaired);
+
+/**
+ * @brief `has_wav_extension(n)` is true iff file name `n` ends in ".wav", in any case.
+ */
+static bool has_wav_extension(const char *file_name);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void wav_writer_set_checkpoint_interval(uint32_t interval_in_bytes)
+{
+    checkpoint_interval_in_bytes = interval_in_bytes;
+}
+
+Wav_Writer_Error_t wav_writer_open(const char *file_name, Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_bytes)
+{
+    uint32_t bytes_written;
+
+    if (open_file(file_name, file_len_in_bytes) != WAV_WRITER_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    has_header = true;
+    file_attr = wav_attr;
+
+    // without checkpoints the final header goes in up front, so finishing the file never has to seek back to it
+    file_attr->file_length = checkpoint_interval_in_bytes == 0 ? file_len_in_bytes : wav_header_get_header_length();
+    wav_header_set_attributes(file_attr);
+
+    if (sd_card_fwrite(wav_header_get_header(), wav_header_get_header_length(), &bytes_written) != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    if (checkpoint_interval_in_bytes != 0 && sd_card_fsync() != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    return WAV_WRITER_ERROR_ALL_OK;
+}
+
+Wav_Writer_Error_t wav_writer_open_flac(const char *file_name, const Flac_Encoder_Stream_Info_t *stream_info, uint64_t max_file_len_in_bytes)
+{
+    static uint8_t stream_header[FLAC_ENCODER_STREAM_HEADER_LEN_IN_BYTES];
+    uint32_t bytes_written;
+
+    if (open_file(file_name, max_file_len_in_bytes) != WAV_WRITER_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    has_header = false;
+    file_attr = NULL;
+
+    const uint32_t header_len = flac_encoder_write_stream_header(stream_info, stream_header);
+
+    if (sd_card_fwrite(stream_header, header_len, &bytes_written) != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    if (checkpoint_interval_in_bytes != 0 && sd_card_fsync() != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    return WAV_WRITER_ERROR_ALL_OK;
+}
+
+Wav_Writer_Error_t wav_writer_open_raw(const char *file_name, uint64_t file_len_in_bytes)
+{
+    if (open_file(file_name, file_len_in_bytes) != WAV_WRITER_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    has_header = false;
+    file_attr = NULL;
+
+    if (checkpoint_interval_in_bytes != 0 && sd_card_fsync() != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    return WAV_WRITER_ERROR_ALL_OK;
+}
+
+Wav_Writer_Error_t wav_writer_write(const void *buff, uint32_t len_in_bytes)
+{
+    uint32_t bytes_written;
+
+    if (sd_card_fwrite(buff, len_in_bytes, &bytes_written) != SD_CARD_ERROR_ALL_OK || bytes_written != len_in_bytes)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    audio_len_in_bytes += len_in_bytes;
+    bytes_since_checkpoint += len_in_bytes;
+
+    if (checkpoint_interval_in_bytes != 0 && bytes_since_checkpoint >= checkpoint_interval_in_bytes)
+    {
+        return checkpoint();
+    }
+
+    return WAV_WRITER_ERROR_ALL_OK;
+}
+
+Wav_Writer_Error_t wav_writer_close()
+{
+    // whatever happens below the file is done with, FatFS has no way to retry a close
+    is_open = false;
+
+    if (has_header && checkpoint_interval_in_bytes != 0 && write_header(audio_len_in_bytes) != WAV_WRITER_ERROR_ALL_OK)
+    {
+        sd_card_fclose();
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    return sd_card_fclose() == SD_CARD_ERROR_ALL_OK ? WAV_WRITER_ERROR_ALL_OK : WAV_WRITER_ERROR_SD_CARD_ERROR;
+}
+
+bool wav_writer_is_open()
+{
+    return is_open;
+}
+
+Wav_Writer_Error_t wav_writer_recover_dir(const char *path, uint32_t *num_repaired)
+{
+    static char file_name[FILE_NAME_BUFF_LEN];
+    static char file_path[FILE_PATH_BUFF_LEN];
+
+    *num_repaired = 0;
+
+    if (sd_card_opendir(path) != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    Wav_Writer_Error_t err = WAV_WRITER_ERROR_ALL_OK;
+    const size_t path_len = strlen(path);
+    const char *separator = (path_len == 0 || path[path_len - 1] == '/') ? "" : "/";
+
+    while (true)
+    {
+        bool is_dir;
+        if (sd_card_readdir(file_name, sizeof(file_name), &is_dir) != SD_CARD_ERROR_ALL_OK)
+        {
+            err = WAV_WRITER_ERROR_SD_CARD_ERROR;
+            break;
+        }
+
+        if (file_name[0] == '\0')
+        {
+            break;
+        }
+
+        if (is_dir || !has_wav_extension(file_name))
+        {
+            continue;
+        }
+
+        // one file we can't check doesn't stop us checking the rest
+        bool was_repaired;
+        snprintf(file_path, sizeof(file_path), "%s%s%s", path, separator, file_name);
+
+        if (repair_file(file_path, &was_repaired) != WAV_WRITER_ERROR_ALL_OK)
+        {
+            err = WAV_WRITER_ERROR_SD_CARD_ERROR;
+        }
+        else if (was_repaired)
+        {
+            *num_repaired += 1;
+        }
+    }
+
+    if (sd_card_closedir() != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    return err;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+Wav_Writer_Error_t open_file(const char *file_name, uint64_t file_len_in_bytes)
+{
+    if (sd_card_fopen(file_name, POSIX_FILE_MODE_WRITE) != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+#if DEMO_CONFIG_PREALLOCATE_FILES == 1
+    // if there's no contiguous space this big we carry on anyway, FatFS will grow the file as we go
+    sd_card_fpreallocate(file_len_in_bytes);
+#endif
+
+    is_open = true;
+    audio_len_in_bytes = 0;
+    bytes_since_checkpoint = 0;
+
+    return WAV_WRITER_ERROR_ALL_OK;
+}
+
+Wav_Writer_Error_t write_header(uint64_t len_in_bytes)
+{
+    uint32_t bytes_written;
+
+    // a reader should never see part of a sample, or of a block of compressed samples
+    const uint32_t bytes_per_block = wav_header_get_block_align(file_attr);
+    const uint64_t header_len = wav_header_get_header_length();
+
+    STAGE_PROFILER_BEGIN(STAGE_PROFILER_STAGE_HEADER);
+
+    file_attr->file_length = header_len + len_in_bytes - (len_in_bytes % bytes_per_block);
+    wav_header_set_attributes(file_attr);
+
+    const bool is_written = sd_card_lseek(0) == SD_CARD_ERROR_ALL_OK &&
+                            sd_card_fwrite(wav_header_get_header(), header_len, &bytes_written) == SD_CARD_ERROR_ALL_OK &&
+                            sd_card_lseek(header_len + audio_len_in_bytes) == SD_CARD_ERROR_ALL_OK;
+
+    STAGE_PROFILER_END(STAGE_PROFILER_STAGE_HEADER);
+
+    return is_written ? WAV_WRITER_ERROR_ALL_OK : WAV_WRITER_ERROR_SD_CARD_ERROR;
+}
+
+Wav_Writer_Error_t checkpoint()
+{
+    bytes_since_checkpoint = 0;
+
+    // FLAC frames each carry their own sync code and CRC, so a decoder reads every frame that made it to the card, and a
+    // raw file is just its samples, so only the size in the directory entry needs syncing
+    if (!has_header)
+    {
+        return sd_card_fsync() == SD_CARD_ERROR_ALL_OK ? WAV_WRITER_ERROR_ALL_OK : WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    if (write_header(audio_len_in_bytes) != WAV_WRITER_ERROR_ALL_OK || sd_card_fsync() != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    return WAV_WRITER_ERROR_ALL_OK;
+}
+
+Wav_Writer_Error_t repair_file(const char *path, bool *was_repaired)
+{
+    static uint8_t header[RECOVERY_HEADER_BUFF_LEN];
+
+    *was_repaired = false;
+
+    if (sd_card_fopen(path, POSIX_FILE_MODE_READ_WRITE) != SD_CARD_ERROR_ALL_OK)
+    {
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    const uint64_t file_len = sd_card_fsize();
+
+    uint32_t header_len;
+    if (sd_card_fread(header, sizeof(header), &header_len) != SD_CARD_ERROR_ALL_OK)
+    {
+        sd_card_fclose();
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    uint64_t repaired_len;
+    if (wav_header_repair(header, header_len, file_len, &repaired_len) != WAVE_HEADER_REPAIR_REPAIRED)
+    {
+        return sd_card_fclose() == SD_CARD_ERROR_ALL_OK ? WAV_WRITER_ERROR_ALL_OK : WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    // a power cut between the two steps leaves a file that is repaired to the same length the next time round
+    uint32_t bytes_written;
+    if (sd_card_lseek(0) != SD_CARD_ERROR_ALL_OK ||
+        sd_card_fwrite(header, header_len, &bytes_written) != SD_CARD_ERROR_ALL_OK ||
+        bytes_written != header_len ||
+        sd_card_ftruncate(repaired_len) != SD_CARD_ERROR_ALL_OK)
+    {
+        sd_card_fclose();
+        return WAV_WRITER_ERROR_SD_CARD_ERROR;
+    }
+
+    *was_repaired = true;
+
+    return sd_card_fclose() == SD_CARD_ERROR_ALL_OK ? WAV_WRITER_ERROR_ALL_OK : WAV_WRITER_ERROR_SD_CARD_ERROR;
+}
+
+bool has_wav_extension(const char *file_name)
+{
+    const size_t len = strlen(file_name);
+    if (len < 4)
+    {
+        return false;
+    }
+
+    const char *ext = file_name + len - 4;
+    return ext[0] == '.' && tolower((unsigned char)ext[1]) == 'w' && tolower((unsigned char)ext[2]) == 'a' && tolower((unsigned char)ext[3]) == 'v';
+}
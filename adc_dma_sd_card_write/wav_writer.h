@@ -0,0 +1,161 @@
+/**
+ * @file      wav_writer.h
+ * @brief     A software interface for writing WAVE files to the SD card that survive a power cut is represented here.
+ * @details   A WAVE file is only readable if the sizes in its header match its contents, and FatFS only records the
+ *            size of a file in its directory entry when the file is synced or closed. A brown-out in the middle of a
+ *            recording used to leave a file whose header and directory entry disagreed with the audio on the card.
+ *
+ *            With checkpoints enabled the writer rewrites the header with the amount of audio written so far and
+ *            syncs the file every `n` bytes of audio, so a power cut loses at most the audio since the last checkpoint.
+ *            Each checkpoint costs a rewrite of the first sector of the file and of its directory entry, so the
+ *            interval trades the audio at risk against the extra single sector writes, see `test/fatfs_bench`.
+ *
+ *            At boot `wav_writer_recover_dir()` repairs any file a power cut left behind, from its checkpointed header
+ *            and its size on the card.
+ *
+ *            The writer also writes FLAC streams from `flac_encoder.c`. Those have no sizes to keep up to date, the
+ *            frames are written as they come and a checkpoint only syncs the file. A FLAC file cut off by a power cut
+ *            isn't repaired, decoders read it up to the first frame that fails its CRC. Raw files are the same, just
+ *            samples, and one cut off by a power cut holds every sample up to the last checkpoint.
+ *
+ *            This module only talks to the SD card and the wav header through their public interfaces, so it runs
+ *            unchanged on the host with the POSIX or disk image back-ends.
+ */
+
+#ifndef WAV_WRITER_H_
+#define WAV_WRITER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "flac_encoder.h"
+#include "wav_header.h"
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Wav writer errors are represented here
+ */
+typedef enum
+{
+    WAV_WRITER_ERROR_ALL_OK,
+    WAV_WRITER_ERROR_SD_CARD_ERROR,
+} Wav_Writer_Error_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `wav_writer_set_checkpoint_interval(n)` makes the writer checkpoint each file every `n` bytes of audio.
+ *
+ * @param interval_in_bytes the number of bytes of audio between checkpoints, or 0 to never checkpoint (the default),
+ * in which case the final header is written when the file is opened and nothing is synced until the file is closed
+ *
+ * @post files opened from now on use the new interval
+ */
+void wav_writer_set_checkpoint_interval(uint32_t interval_in_bytes);
+
+/**
+ * @brief `wav_writer_open(n, a, l)` opens a new file named `n` for audio with attributes `a`, expected to be `l` bytes
+ * long once all the audio is written, including the header, and writes its header.
+ *
+ * @pre the SD card is mounted, no other file is open, and the header layout is selected with `wav_header_enable_rf64()`,
+ * `wav_header_enable_bext()`, and `wav_header_enable_ima_adpcm()` and won't change until the file is closed
+ *
+ * @param file_name the name of the file to create, any existing file with this name is replaced
+ *
+ * @param wav_attr the attributes of the audio, used until the file is closed so it must stay valid
+ *
+ * @param file_len_in_bytes the expected length of the file, with `DEMO_CONFIG_PREALLOCATE_FILES` this much space is
+ * allocated up front, and without checkpoints the header says the file is this long
+ *
+ * @post the file is open and the file position is right after the header. With checkpoints the header says there is no
+ * audio yet and the file is synced, so the file can be recovered from the very start.
+ *
+ * @retval `WAV_WRITER_ERROR_ALL_OK` if the file was opened and the header written, else an error code
+ */
+Wav_Writer_Error_t wav_writer_open(const char *file_name, Wave_Header_Attributes_t *wav_attr, uint64_t file_len_in_bytes);
+
+/**
+ * @brief `wav_writer_open_flac(n, i, l)` opens a new file named `n` for a FLAC stream with info `i`, at most `l` bytes
+ * long once all the frames are written, including the stream header, and writes its stream header.
+ *
+ * @pre the SD card is mounted and no other file is open
+ *
+ * @param file_name the name of the file to create, any existing file with this name is replaced
+ *
+ * @param stream_info the info for the STREAMINFO block of the stream
+ *
+ * @param max_file_len_in_bytes the longest the file can get, with `DEMO_CONFIG_PREALLOCATE_FILES` this much space is
+ * allocated up front and the rest is given back when the file is closed
+ *
+ * @post the file is open and the file position is right after the stream header, the frames are written to it with
+ * `wav_writer_write()`. With checkpoints the file is synced.
+ *
+ * @retval `WAV_WRITER_ERROR_ALL_OK` if the file was opened and the stream header written, else an error code
+ */
+Wav_Writer_Error_t wav_writer_open_flac(const char *file_name, const Flac_Encoder_Stream_Info_t *stream_info, uint64_t max_file_len_in_bytes);
+
+/**
+ * @brief `wav_writer_open_raw(n, l)` opens a new file named `n` for raw samples with no header, expected to be `l` bytes
+ * long once all the samples are written.
+ *
+ * @pre the SD card is mounted and no other file is open
+ *
+ * @param file_name the name of the file to create, any existing file with this name is replaced
+ *
+ * @param file_len_in_bytes the expected length of the file, with `DEMO_CONFIG_PREALLOCATE_FILES` this much space is
+ * allocated up front
+ *
+ * @post the file is open and empty, the samples are written to it with `wav_writer_write()`. With checkpoints the file
+ * is synced.
+ *
+ * @retval `WAV_WRITER_ERROR_ALL_OK` if the file was opened, else an error code
+ */
+Wav_Writer_Error_t wav_writer_open_raw(const char *file_name, uint64_t file_len_in_bytes);
+
+/**
+ * @brief `wav_writer_write(b, n)` appends `n` bytes of audio from buffer `b` to the open file, and checkpoints the file
+ * if the checkpoint interval is up.
+ *
+ * @pre a file is open with `wav_writer_open()`, `wav_writer_open_flac()`, or `wav_writer_open_raw()`
+ *
+ * @retval `WAV_WRITER_ERROR_ALL_OK` if all the bytes were written, else an error code
+ */
+Wav_Writer_Error_t wav_writer_write(const void *buff, uint32_t len_in_bytes);
+
+/**
+ * @brief `wav_writer_close()` finishes the header of the open file for the audio written to it and closes it.
+ *
+ * @pre a file is open with `wav_writer_open()`, `wav_writer_open_flac()`, or `wav_writer_open_raw()`
+ *
+ * @post the file is closed. A FLAC stream or raw file is closed as is. With checkpoints the header is rewritten for the audio actually written, without them the
+ * header written at open is kept, so the file should have been the expected length.
+ *
+ * @retval `WAV_WRITER_ERROR_ALL_OK` if the file was finished and closed, else an error code
+ */
+Wav_Writer_Error_t wav_writer_close();
+
+/**
+ * @brief `wav_writer_is_open()` is true if a file was opened and not closed since, whether or not the header or the
+ * audio could be written to it. A recording that stops on an error closes it with `wav_writer_close()`, so the audio
+ * written so far is synced and the SD card file handle is free for the next file.
+ */
+bool wav_writer_is_open();
+
+/**
+ * @brief `wav_writer_recover_dir(p, n)` checks every .wav file in directory `p` on the SD card, repairs the ones left
+ * unfinished by a power cut, see `wav_header_repair()`, and stores the number repaired in `n`.
+ *
+ * @pre the SD card is mounted and no file is open
+ *
+ * @post the repaired files have headers that match their contents and are cut to the last whole sample the header and
+ * the card agree on. Files that are fine, or not recognised as WAVE files, are left untouched.
+ *
+ * @retval `WAV_WRITER_ERROR_ALL_OK` if every file could be checked, else an error code, files that could be checked are
+ * still repaired
+ */
+Wav_Writer_Error_t wav_writer_recover_dir(const char *path, uint32_t *num_repaired);
+
+#endif /* WAV_WRITER_H_ */
@@ -0,0 +1,196 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "write_pipeline.h"
+
+#include <stddef.h> // for NULL
+#include <string.h> // for memcpy
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the bytes carried over from the previous write always fit in the sector of headroom in front of each buffer
+#define HEADROOM_LEN_IN_BYTES (WRITE_PIPELINE_SECTOR_LEN_IN_BYTES)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// each buffer is a sector of headroom followed by the space the processing stage fills, the processing stage works on
+// the payload as q31s so it must be word aligned
+static uint8_t output_buffs[WRITE_PIPELINE_NUM_BUFFERS][HEADROOM_LEN_IN_BYTES + WRITE_PIPELINE_BUFF_LEN_IN_BYTES] __attribute__((aligned(4)));
+static uint32_t output_buff_lens[WRITE_PIPELINE_NUM_BUFFERS];
+
+// the number of bytes of each buffer that belong to the current file, if the buffer has a file break in it
+static bool output_buff_has_file_break[WRITE_PIPELINE_NUM_BUFFERS];
+static uint32_t output_buff_file_break_lens[WRITE_PIPELINE_NUM_BUFFERS];
+
+// free-running counters, one writer each, the number of full buffers is the difference between the two
+static volatile uint32_t num_buffers_submitted = 0;
+static volatile uint32_t num_buffers_released = 0;
+
+// the bytes past the last whole sector of the previous write, only touched by the write stage
+static uint8_t carried_bytes[WRITE_PIPELINE_SECTOR_LEN_IN_BYTES];
+static uint32_t num_carried_bytes = 0;
+
+// the position within a sector of the next byte to be written, only non-zero before the first write of a file
+static uint32_t sector_offset = 0;
+
+// the position within a sector of the first byte written to each file
+static uint32_t file_start_sector_offset = 0;
+
+// true if the chunk handed out last is the end of a file, only touched by the write stage
+static bool write_ends_file = false;
+
+// true if the start of the next file is still waiting in the buffer that was split between two files, which begins at
+// `split_offset` in that buffer, only touched by the write stage
+static bool split_is_pending = false;
+static uint32_t split_offset = 0;
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void write_pipeline_reset(uint32_t file_offset)
+{
+    num_buffers_submitted = 0;
+    num_buffers_released = 0;
+    num_carried_bytes = 0;
+    sector_offset = file_offset % WRITE_PIPELINE_SECTOR_LEN_IN_BYTES;
+    file_start_sector_offset = sector_offset;
+    write_ends_file = false;
+    split_is_pending = false;
+}
+
+uint8_t *write_pipeline_get_free_buffer()
+{
+    const uint32_t submitted = num_buffers_submitted;
+
+    if (submitted - num_buffers_released >= WRITE_PIPELINE_NUM_BUFFERS)
+    {
+        return NULL;
+    }
+
+    // make sure the write stage is done reading the buffer before we start filling it again
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    return output_buffs[submitted % WRITE_PIPELINE_NUM_BUFFERS] + HEADROOM_LEN_IN_BYTES;
+}
+
+void write_pipeline_submit_buffer(uint32_t len_in_bytes)
+{
+    output_buff_lens[num_buffers_submitted % WRITE_PIPELINE_NUM_BUFFERS] = len_in_bytes;
+    output_buff_has_file_break[num_buffers_submitted % WRITE_PIPELINE_NUM_BUFFERS] = false;
+
+    // the buffer contents and length must be visible to the write stage before the count says the buffer is full
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    num_buffers_submitted += 1;
+}
+
+void write_pipeline_submit_buffer_with_file_break(uint32_t len_in_bytes, uint32_t len_in_current_file)
+{
+    const uint32_t idx = num_buffers_submitted % WRITE_PIPELINE_NUM_BUFFERS;
+
+    output_buff_lens[idx] = len_in_bytes;
+    output_buff_has_file_break[idx] = true;
+    output_buff_file_break_lens[idx] = len_in_current_file;
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    num_buffers_submitted += 1;
+}
+
+const uint8_t *write_pipeline_start_write(uint32_t *len_in_bytes)
+{
+    const uint32_t released = num_buffers_released;
+
+    if (num_buffers_submitted == released)
+    {
+        return NULL;
+    }
+
+    // pairs with the release fence in write_pipeline_submit_buffer()
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    const uint32_t idx = released % WRITE_PIPELINE_NUM_BUFFERS;
+    uint8_t *payload = output_buffs[idx] + HEADROOM_LEN_IN_BYTES;
+    uint8_t *chunk;
+    uint32_t total_len;
+
+    if (split_is_pending)
+    {
+        // the start of a new file, the end of the old one was written out from this buffer already
+        split_is_pending = false;
+        chunk = payload + split_offset;
+        total_len = output_buff_lens[idx] - split_offset;
+    }
+    else
+    {
+        // put the carried bytes in the headroom, directly in front of the payload
+        chunk = payload - num_carried_bytes;
+        memcpy(chunk, carried_bytes, num_carried_bytes);
+
+        if (output_buff_has_file_break[idx])
+        {
+            // the end of the file is written out as is, there is nothing after it to line the tail up with
+            *len_in_bytes = num_carried_bytes + output_buff_file_break_lens[idx];
+
+            num_carried_bytes = 0;
+            sector_offset = file_start_sector_offset;
+            write_ends_file = true;
+            split_is_pending = output_buff_file_break_lens[idx] < output_buff_lens[idx];
+            split_offset = output_buff_file_break_lens[idx];
+
+            return chunk;
+        }
+
+        total_len = num_carried_bytes + output_buff_lens[idx];
+    }
+
+    // cut the chunk at the last sector boundary of the file, taking into account an unaligned start of the file
+    const uint32_t aligned_len = total_len < (WRITE_PIPELINE_SECTOR_LEN_IN_BYTES - sector_offset)
+                                     ? 0
+                                     : total_len - ((total_len + sector_offset) % WRITE_PIPELINE_SECTOR_LEN_IN_BYTES);
+
+    num_carried_bytes = total_len - aligned_len;
+    memcpy(carried_bytes, chunk + aligned_len, num_carried_bytes);
+
+    // once something is written the file position sits on a sector boundary for good
+    if (aligned_len > 0)
+    {
+        sector_offset = 0;
+    }
+
+    *len_in_bytes = aligned_len;
+
+    return chunk;
+}
+
+void write_pipeline_on_write_complete()
+{
+    // the buffer is still needed if the start of the next file is in it
+    const bool keep_buffer = write_ends_file && split_is_pending;
+    write_ends_file = false;
+
+    if (keep_buffer)
+    {
+        return;
+    }
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    num_buffers_released += 1;
+}
+
+bool write_pipeline_write_ends_file()
+{
+    return write_ends_file;
+}
+
+const uint8_t *write_pipeline_get_carried_bytes(uint32_t *len_in_bytes)
+{
+    *len_in_bytes = num_carried_bytes;
+
+    return carried_bytes;
+}
+
+uint32_t write_pipeline_num_buffers_full()
+{
+    return num_buffers_submitted - num_buffers_released;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file      write_pipeline.h
+ * @brief     A software interface for double-buffering processed audio on its way to the SD card is represented here.
+ * @details   Processing a DMA block (endian swap, decimation, bit depth conversion) and writing the result to the SD
+ *            card are split into two stages that run in different execution contexts. The processing stage fills one
+ *            output buffer while the write stage is busy writing the other one out, so the CPU keeps working on block
+ *            N+1 while the SDHC moves block N, and an SD card stall no longer holds up the processing of the blocks
+ *            behind it.
+ *
+ *            The processing stage is the only writer of the submit count and the write stage is the only writer of the
+ *            release count, so the two stages never need to disable interrupts or take a lock to hand buffers over.
+ *
+ *            Every write handed out by the write stage starts and ends on a sector boundary of the file. Processed
+ *            blocks are rarely a multiple of the sector size (a 384kHz 24 bit block is 24768 bytes), so the bytes past
+ *            the last whole sector are carried over and written in front of the next block. Each output buffer has a
+ *            sector of headroom in front of it for the carried bytes, so no more than one sector is ever copied. This
+ *            lets FatFS send each write straight to the card as a multi-sector transfer, instead of staging partial
+ *            sectors through its sector buffer.
+ *
+ *            A continuous recording is split into several files without stopping the DMA stream. The processing stage
+ *            marks the byte of a buffer where one file ends and the next begins, and the write stage hands the buffer
+ *            out in two pieces: the end of the old file, unaligned tail and all, and then the start of the new one,
+ *            aligned to the new file's sectors.
+ *
+ *            This module does not touch any peripherals, so it can be unit tested and shared with host simulations.
+ */
+
+#ifndef WRITE_PIPELINE_H_
+#define WRITE_PIPELINE_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "audio_dma.h"
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// one buffer being written out while the other is filled
+#define WRITE_PIPELINE_NUM_BUFFERS (2)
+
+// the largest processed block is a raw 384kHz 24 bit block, which is just the DMA block with the endianness swapped,
+// with room for the frame headers an encoder adds when the block doesn't compress, see `flac_encoder.h`
+#define WRITE_PIPELINE_ENCODER_OVERHEAD_IN_BYTES (128)
+#define WRITE_PIPELINE_BUFF_LEN_IN_BYTES (AUDIO_DMA_BUFF_LEN_IN_BYTES + WRITE_PIPELINE_ENCODER_OVERHEAD_IN_BYTES)
+
+// writes are aligned to this many bytes, the sector size of SD cards
+#define WRITE_PIPELINE_SECTOR_LEN_IN_BYTES (512)
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `write_pipeline_reset(o)` marks all output buffers as free and drops any carried bytes, for files whose audio
+ * data starts at byte offset `o`.
+ *
+ * @pre neither stage is running.
+ *
+ * @param file_offset the position in each file of the first byte that will be written, e.g. the length of the header
+ *
+ * @post all buffers are free, the next buffer to be filled and the next buffer to be written are both buffer 0. The
+ * first write is shortened so that it ends on a sector boundary.
+ */
+void write_pipeline_reset(uint32_t file_offset);
+
+/**
+ * @brief `write_pipeline_get_free_buffer()` is the output buffer the processing stage should fill next, or NULL if all
+ * buffers are full or being written.
+ *
+ * @retval pointer to a buffer of `WRITE_PIPELINE_BUFF_LEN_IN_BYTES` bytes, or NULL if there are no free buffers.
+ */
+uint8_t *write_pipeline_get_free_buffer();
+
+/**
+ * @brief `write_pipeline_submit_buffer(n)` hands the buffer most recently given by `write_pipeline_get_free_buffer()`
+ * over to the write stage, with `n` bytes of valid data. Only the processing stage calls this.
+ *
+ * @pre `write_pipeline_get_free_buffer()` returned a buffer which has been filled with `n` bytes.
+ *
+ * @post the buffer is queued for writing behind any buffers submitted before it.
+ */
+void write_pipeline_submit_buffer(uint32_t len_in_bytes);
+
+/**
+ * @brief `write_pipeline_submit_buffer_with_file_break(n, f)` is like `write_pipeline_submit_buffer(n)`, except that
+ * only the first `f` bytes of the buffer belong to the current file, the rest are the start of the next file.
+ *
+ * @pre `write_pipeline_get_free_buffer()` returned a buffer which has been filled with `n` bytes, `f` is in [0, n], and
+ * the file break is the only one in the buffer.
+ *
+ * @post the buffer is queued for writing, the write stage will end the current file after byte `f`.
+ */
+void write_pipeline_submit_buffer_with_file_break(uint32_t len_in_bytes, uint32_t len_in_current_file);
+
+/**
+ * @brief `write_pipeline_start_write(l)` is the sector-aligned chunk to write out next, made from the bytes carried over
+ * from the previous buffer followed by the whole sectors of the oldest submitted buffer, and stores its length in `l`.
+ * It is NULL if no buffers are waiting to be written. Only the write stage calls this.
+ *
+ * @param len_in_bytes pointer to store the length of the chunk in, a multiple of `WRITE_PIPELINE_SECTOR_LEN_IN_BYTES`
+ * except for the first write of a file with an unaligned start and the last write of a file. The length may be 0 if
+ * the buffer was smaller than what was needed to complete a sector. Untouched if the retval is NULL.
+ *
+ * @post if the retval is not NULL, the bytes of the buffer past the last whole sector are carried over to the next
+ * write, and `write_pipeline_on_write_complete()` must be called once the chunk has been written. If the chunk is the
+ * end of a file (see `write_pipeline_write_ends_file()`) nothing is carried over, the next chunk starts the next file.
+ *
+ * @retval pointer to the chunk to write out, or NULL if there is nothing to write.
+ */
+const uint8_t *write_pipeline_start_write(uint32_t *len_in_bytes);
+
+/**
+ * @brief `write_pipeline_on_write_complete()` is the completion callback of the write stage, it releases the buffer
+ * given by the last call to `write_pipeline_start_write()` so the processing stage can fill it again. Only the write
+ * stage calls this.
+ *
+ * @pre the chunk given by `write_pipeline_start_write()` has been completely written out.
+ *
+ * @post the buffer is free, unless the chunk was the end of a file and the rest of the buffer is the start of the next
+ * file, in which case the rest is the next chunk to write.
+ */
+void write_pipeline_on_write_complete();
+
+/**
+ * @brief `write_pipeline_write_ends_file()` is true if the chunk given by the last call to `write_pipeline_start_write()`
+ * is the end of a file, so the write stage should move on to the next file before the next write. Only the write stage
+ * calls this.
+ */
+bool write_pipeline_write_ends_file();
+
+/**
+ * @brief `write_pipeline_get_carried_bytes(l)` is the partial sector carried over after the last write, and stores its
+ * length in `l`. This is the tail end of the recording which must be written out after the last block.
+ *
+ * @pre the processing stage is stopped and every submitted buffer has been written.
+ *
+ * @retval pointer to the carried bytes, the length is in [0, `WRITE_PIPELINE_SECTOR_LEN_IN_BYTES`).
+ */
+const uint8_t *write_pipeline_get_carried_bytes(uint32_t *len_in_bytes);
+
+/**
+ * @brief `write_pipeline_num_buffers_full()` is the number of submitted buffers that have not been released yet.
+ */
+uint32_t write_pipeline_num_buffers_full();
+
+#endif /* WRITE_PIPELINE_H_ */
@@ -15,12 +15,12 @@
 #include <string.h>
 
 #include "board.h"
-#include "i2c.h"
 #include "mxc_device.h"
 #include "mxc_delay.h"
 #include "nvic_table.h"
 
 #include "afe_control.h"
+#include "hal_i2c.h"
 
 /* Defines -----------------------------------------------------------------------------------------------------------*/
 
@@ -50,19 +50,14 @@ int main()
 
     MXC_Delay(DELAY_uSec);
 
-    if (MXC_I2C_Init(MXC_I2C0_BUS0, 1, 0) != E_NO_ERROR)
+    if (hal_i2c_init(HAL_I2C_BUS_0, HAL_I2C_SPEED_STANDARD) != HAL_I2C_ERROR_ALL_OK)
     {
         printf("-->I2C initialization FAILED\n");
         return -1;
     }
-    if (MXC_I2C_SetFrequency(MXC_I2C0_BUS0, MXC_I2C_STD_MODE) != MXC_I2C_STD_MODE)
-    {
-        printf("-->I2C frequency set FAILED\n");
-        return -1;
-    }
     printf("\n-->I2C Master Initialization Complete\n");
 
-    afe_control_init(MXC_I2C0_BUS0);
+    afe_control_init(HAL_I2C_BUS_0);
 
     MXC_Delay(DELAY_uSec);
 
@@ -14,4 +14,12 @@
 # https://www.analog.com/en/education/education-library/videos/6313214207112.html
 SBT=0
 
+PROJ_CFLAGS+=-mno-unaligned-access
+
+# the AFE gain control and the I2C and GPIO HAL it goes through, from the modules shared between snippets
+include ../magpie_core/core.mk
+SRCS += $(MAGPIE_CORE_DIR)/afe_control.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_i2c.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_gpio.c
+
 PROJ_LDFLAGS += -Wl,--print-memory-usage
@@ -4,12 +4,14 @@
 #include <stdio.h>
 #include <stdint.h>
 #include "mxc_delay.h"
-#include "tmr.h"
 #include "board.h"
 
 #include "gnss_module.h"
 #include "gpio_helpers.h"
+#include "hal_i2c.h"
+#include "hal_timer.h"
 #include "real_time_clock.h"
+#include "scheduler.h"
 #include "status_led.h"
 
 #include <string.h>
@@ -17,18 +19,111 @@
 /* Private definitions -----------------------------------------------------------------------------------------------*/
 
 // this I2C bus serves the RTC and other peripherals
-#define I2C_3V3 (MXC_I2C1_BUS0)
+#define I2C_3V3 (HAL_I2C_BUS_1)
+
+// the timers of the scheduler count ticks of this period
+#define SCHEDULER_TICK_PERIOD_IN_MICROSECS (1000)
+
+#define GPS_SYNC_TIMEOUT_SECS (20)
+
+// the UART buffer fills in about 250ms at 9600 baud, so it is drained well before that
+#define GNSS_POLL_PERIOD_IN_MILLISECS (100)
+
+#define FAST_BLINK_PERIOD_IN_MILLISECS (100)
+
+// the events of the GNSS task, and the event of the LED task
+#define GNSS_EVENT_POLL (1u << 0)
+#define GNSS_EVENT_TIMEOUT (1u << 1)
+#define LED_EVENT_TOGGLE (1u << 0)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the GNSS task carries on the sync each time the poll timer expires, and gives up on it when the timeout timer expires,
+// the LED task blinks the errors
+static Scheduler_Task_t gnss_task;
+static Scheduler_Timer_t gnss_poll_timer;
+static Scheduler_Timer_t gnss_timeout_timer;
+static Scheduler_Task_t led_task;
+static Scheduler_Timer_t blink_timer;
+
+static Status_LED_Color_t blink_color;
 
 /* Private function declarations -------------------------------------------------------------------------------------*/
 
 /**
- * print out the time held by the RTC module
+ * print out the time held by the RTC module, false if it could not be read
  */
-static void print_rtc_time();
+static bool print_rtc_time();
 
-// the error handler simply rapidly blinks the given LED color forever
+// the error handler rapidly blinks the given LED color forever, it is only called before the scheduler runs
 static void error_handler(Status_LED_Color_t c);
 
+/**
+ * @brief `sync_rtc(e)` is the GNSS task, it carries on the sync of the RTC to GNSS time, and prints the result and
+ * starts the next sync each time one finishes or times out.
+ */
+static void sync_rtc(Scheduler_Events_t events)
+{
+    GNSS_Module_Error_t res = GNSS_MODULE_ERROR_ALL_OK;
+    bool has_fix = false;
+    tm_t gps_time;
+
+    if (events & GNSS_EVENT_POLL)
+    {
+        res = gnss_module_sync_poll(&gps_time, &has_fix);
+    }
+
+    if (has_fix)
+    {
+        if (real_time_clock_set_datetime(&gps_time) != REAL_TIME_CLOCK_ERROR_ALL_OK)
+        {
+            printf("[ERROR]--> RTC set time\n");
+        }
+        else
+        {
+            printf("[SUCCESS]--> GNSS-RTC time sync\n");
+
+            // the RTC can't be read back, so there's no point syncing it again
+            if (!print_rtc_time())
+            {
+                scheduler_timer_stop(gnss_poll_timer);
+                scheduler_timer_stop(gnss_timeout_timer);
+                start_blinking(STATUS_LED_COLOR_RED);
+                return;
+            }
+        }
+    }
+    else if (res != GNSS_MODULE_ERROR_ALL_OK)
+    {
+        printf("[ERROR]--> RTC time sync failure [%d]\n", res);
+    }
+    else if (events & GNSS_EVENT_TIMEOUT)
+    {
+        printf("[ERROR]--> RTC time sync timed out\n");
+    }
+    else
+    {
+        // still looking for a fix
+        return;
+    }
+
+    // keep syncing, the poll timer carries on with the next sync
+    gnss_module_sync_start();
+    scheduler_timer_start(gnss_timeout_timer, GPS_SYNC_TIMEOUT_SECS * 1000, 0);
+}
+
+void toggle_led(Scheduler_Events_t events);
+
+/**
+ * @brief `start_blinking(c)` turns every LED off, then rapidly blinks LED `c`.
+ */
+static void start_blinking(Status_LED_Color_t color);
+
+/**
+ * @brief `on_tick(n)` moves the clock of the scheduler on by `n` ticks, it runs in the timer interrupt.
+ */
+static void on_tick(uint32_t num_periods);
+
 /* Public function definitions ---------------------------------------------------------------------------------------*/
 
 int main(void)
@@ -45,6 +140,18 @@ int main(void)
 
     printf("\n*** GNSS -> RTC Clock sync example ***\n");
 
+    // the LED task blinks the errors of the rest of the initialization, nothing can blink without it
+    if (scheduler_add_task(toggle_led, SCHEDULER_PRIORITY_NORMAL, &led_task) != SCHEDULER_ERROR_ALL_OK ||
+        scheduler_add_timer(led_task, LED_EVENT_TOGGLE, &blink_timer) != SCHEDULER_ERROR_ALL_OK ||
+        hal_timer_start_tick(SCHEDULER_TICK_PERIOD_IN_MICROSECS, on_tick) != HAL_TIMER_ERROR_ALL_OK)
+    {
+        printf("[ERROR]--> scheduler init\n");
+        status_led_set(STATUS_LED_COLOR_RED, true);
+        while (true)
+        {
+        }
+    }
+
     if (gnss_module_init() != GNSS_MODULE_ERROR_ALL_OK)
     {
         printf("[ERROR]--> GNSS init\n");
@@ -56,7 +163,7 @@ int main(void)
         printf("[SUCCESS]--> GNSS init\n");
     }
 
-    if (MXC_I2C_Init(I2C_3V3, 1, 0) != E_NO_ERROR)
+    if (hal_i2c_init(I2C_3V3, HAL_I2C_SPEED_STANDARD) != HAL_I2C_ERROR_ALL_OK)
     {
         printf("[ERROR]--> I2C init\n");
         error_handler(STATUS_LED_COLOR_RED);
@@ -75,15 +182,6 @@ int main(void)
         .drvstr = MXC_GPIO_DRVSTR_0,
     };
     MXC_GPIO_Config(&i2c1_pins);
-    if (MXC_I2C_SetFrequency(I2C_3V3, MXC_I2C_STD_MODE) != MXC_I2C_STD_MODE)
-    {
-        printf("[ERROR]--> I2C freq set\n");
-        error_handler(STATUS_LED_COLOR_RED);
-    }
-    else
-    {
-        printf("[SUCCESS]--> I2C freq set\n");
-    }
 
     if (real_time_clock_init(I2C_3V3) != REAL_TIME_CLOCK_ERROR_ALL_OK)
     {
@@ -108,32 +206,31 @@ int main(void)
     }
 
     printf("\nRTC default time before syncing to GPS:\n");
-    print_rtc_time();
-
-    printf("\n... Attempting to sync RTC to GPS, this can take some time ...\n");
+    if (!print_rtc_time())
+    {
+        error_handler(STATUS_LED_COLOR_RED);
+    }
 
-    while (1)
+    if (scheduler_add_task(sync_rtc, SCHEDULER_PRIORITY_NORMAL, &gnss_task) != SCHEDULER_ERROR_ALL_OK ||
+        scheduler_add_timer(gnss_task, GNSS_EVENT_POLL, &gnss_poll_timer) != SCHEDULER_ERROR_ALL_OK ||
+        scheduler_add_timer(gnss_task, GNSS_EVENT_TIMEOUT, &gnss_timeout_timer) != SCHEDULER_ERROR_ALL_OK)
     {
-        const uint32_t gps_sync_timeout_secs = 20;
-        const GNSS_Module_Error_t res = gnss_module_sync_RTC_to_GNSS_time(gps_sync_timeout_secs);
-        if (res == GNSS_MODULE_ERROR_ALL_OK)
-        {
-            printf("[SUCCESS]--> GNSS-RTC time sync\n");
+        printf("[ERROR]--> scheduler init\n");
+        error_handler(STATUS_LED_COLOR_RED);
+    }
 
-            print_rtc_time();
-        }
-        else
-        {
-            printf("[ERROR]--> RTC time sync failure [%d]\n", res);
-        }
+    printf("\n... Attempting to sync RTC to GPS, this can take some time ...\n");
 
-        MXC_Delay(10);
-    }
+    // from here on everything happens in the tasks
+    gnss_module_sync_start();
+    scheduler_timer_start(gnss_timeout_timer, GPS_SYNC_TIMEOUT_SECS * 1000, 0);
+    scheduler_timer_start(gnss_poll_timer, GNSS_POLL_PERIOD_IN_MILLISECS, GNSS_POLL_PERIOD_IN_MILLISECS);
+    scheduler_run();
 }
 
 /* Private function definitions --------------------------------------------------------------------------------------*/
 
-void print_rtc_time()
+bool print_rtc_time()
 {
     char str_buff[100];
 
@@ -142,22 +239,77 @@ void print_rtc_time()
     if (real_time_clock_get_datetime(&t0) != REAL_TIME_CLOCK_ERROR_ALL_OK)
     {
         printf("[ERROR]--> RTC get time\n");
-        error_handler(STATUS_LED_COLOR_RED);
+        return false;
     }
 
     time_helpers_tm_to_string(&t0, str_buff);
 
     printf("%s\n", str_buff);
+
+    return true;
 }
 
 void error_handler(Status_LED_Color_t color)
 {
-    status_led_all_off();
+    start_blinking(color);
+
+    // nothing else is running yet, so only the LED task ever runs
+    scheduler_run();
 
-    const uint32_t fast_blink = 100000;
     while (true)
     {
-        status_led_toggle(color);
-        MXC_Delay(fast_blink);
     }
 }
+
+void sync_rtc(Scheduler_Events_t events)
+{
+    (void)events;
+
+    bool is_done;
+    const GNSS_Module_Error_t res = gnss_module_sync_poll(&is_done);
+
+    if (!is_done)
+    {
+        return;
+    }
+
+    if (res == GNSS_MODULE_ERROR_ALL_OK)
+    {
+        printf("[SUCCESS]--> GNSS-RTC time sync\n");
+
+        // the RTC can't be read back, so there's no point syncing it again
+        if (!print_rtc_time())
+        {
+            scheduler_timer_stop(gnss_poll_timer);
+            start_blinking(STATUS_LED_COLOR_RED);
+            return;
+        }
+    }
+    else
+    {
+        printf("[ERROR]--> RTC time sync failure [%d]\n", res);
+    }
+
+    // keep syncing, the poll timer carries on with the next sync
+    gnss_module_sync_start(GPS_SYNC_TIMEOUT_SECS);
+}
+
+void toggle_led(Scheduler_Events_t events)
+{
+    (void)events;
+
+    status_led_toggle(blink_color);
+}
+
+void start_blinking(Status_LED_Color_t color)
+{
+    status_led_all_off();
+
+    blink_color = color;
+    scheduler_timer_start(blink_timer, FAST_BLINK_PERIOD_IN_MILLISECS, FAST_BLINK_PERIOD_IN_MILLISECS);
+}
+
+void on_tick(uint32_t num_periods)
+{
+    scheduler_tick(num_periods * (SCHEDULER_TICK_PERIOD_IN_MICROSECS / 1000));
+}
@@ -20,13 +20,24 @@ LIB_SDHC = 1
 
 FATFS_VERSION = ff15
 
+# the scheduler, the timer tick, the GNSS module and the HAL they go through, from the modules shared between
+# snippets
+include ../magpie_core/core.mk
+SRCS += $(MAGPIE_CORE_DIR)/scheduler.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_timer.c
+SRCS += $(MAGPIE_CORE_DIR)/gnss_module.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_uart.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_gpio.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_i2c.c
+
+# the NMEA parser gnss_module.c uses, minmea calls timegm() which newlib doesn't have, the RTC runs in UTC so mktime()
+# does the same
+IPATH += $(MAGPIE_CORE_DIR)/third_party/minmea
+SRCS += $(MAGPIE_CORE_DIR)/third_party/minmea/minmea.c
+PROJ_CFLAGS += -Dtimegm=mktime
+
 LIB_CMSIS_DSP = 1
 
 MXC_OPTIMIZE_CFLAGS = -O2
 
 PROJ_LDFLAGS += -Wl,--print-memory-usage
-
-# 3rd party GNSS parsing lib
-IPATH += ./third_party/minmea
-SRCS += ./third_party/minmea/minmea.c
-PROJ_CFLAGS += -Dtimegm=mktime
@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 
+#include "hal_gpio.h"
 #include "real_time_clock.h"
 
 #include "time_helpers.h"
@@ -82,16 +83,16 @@ typedef enum
 
 /* Private variables -------------------------------------------------------------------------------------------------*/
 
-// the I2C handle to use to communicate with the DS3231
-static mxc_i2c_regs_t *hi2c_;
+// the I2C bus to use to communicate with the DS3231
+static Hal_I2C_Bus_t i2c_bus;
 
 // interrupts come from the RTC to the MAX
-static mxc_gpio_cfg_t rtc_int_pin = {
-    .port = MXC_GPIO0,
-    .mask = MXC_GPIO_PIN_13,
-    .pad = MXC_GPIO_PAD_NONE,
-    .func = MXC_GPIO_FUNC_IN,
-    .vssel = MXC_GPIO_VSSEL_VDDIOH,
+static const Hal_GPIO_Pin_t rtc_int_pin = {
+    .port = HAL_GPIO_PORT_0,
+    .mask = HAL_GPIO_PIN(13),
+    .func = HAL_GPIO_FUNC_IN,
+    .voltage = HAL_GPIO_VOLTAGE_VDDIOH,
+    .drive_strength = HAL_GPIO_DRIVE_STRENGTH_0,
 };
 
 /* Private function declarations -------------------------------------------------------------------------------------*/
@@ -132,11 +133,11 @@ static Real_Time_Clock_Error_t ds3231_i2c_write(uint8_t *write_buff, uint32_t nu
 
 /* Public function definitions ---------------------------------------------------------------------------------------*/
 
-Real_Time_Clock_Error_t real_time_clock_init(mxc_i2c_regs_t *hi2c)
+Real_Time_Clock_Error_t real_time_clock_init(Hal_I2C_Bus_t bus)
 {
-    hi2c_ = hi2c;
+    i2c_bus = bus;
 
-    MXC_GPIO_Config(&rtc_int_pin);
+    hal_gpio_config(&rtc_int_pin);
 
     uint8_t write_buff[] = {
         DS3231_REGISTER_CONTROL,             // start at the control reg, we'll increment into the status reg
@@ -260,36 +261,14 @@ Real_Time_Clock_Error_t ds3231_i2c_read(DS3231_Register_t start_reg, uint8_t *re
     // we need to first send the starting address we want to read from
     read_buff[0] = start_reg;
 
-    mxc_i2c_req_t req = {
-        .i2c = hi2c_,
-        .addr = DS3231_7_BIT_I2C_ADDR,
-        .tx_buf = read_buff,
-        .tx_len = 1,
-        .rx_buf = read_buff,
-        .rx_len = num_bytes_to_read,
-        .restart = 0,
-        .callback = NULL,
-    };
-
-    const int res = MXC_I2C_MasterTransaction(&req);
+    const Hal_I2C_Error_t res = hal_i2c_write_read(i2c_bus, DS3231_7_BIT_I2C_ADDR, read_buff, 1, read_buff, num_bytes_to_read);
 
-    return res == 0 ? REAL_TIME_CLOCK_ERROR_ALL_OK : REAL_TIME_CLOCK_ERROR_I2C_ERROR;
+    return res == HAL_I2C_ERROR_ALL_OK ? REAL_TIME_CLOCK_ERROR_ALL_OK : REAL_TIME_CLOCK_ERROR_I2C_ERROR;
 }
 
 Real_Time_Clock_Error_t ds3231_i2c_write(uint8_t *write_buff, uint32_t num_bytes_to_write)
 {
-    mxc_i2c_req_t req = {
-        .i2c = hi2c_,
-        .addr = DS3231_7_BIT_I2C_ADDR,
-        .tx_buf = write_buff,
-        .tx_len = num_bytes_to_write,
-        .rx_buf = NULL,
-        .rx_len = 0,
-        .restart = 0,
-        .callback = NULL,
-    };
-
-    const int res = MXC_I2C_MasterTransaction(&req);
+    const Hal_I2C_Error_t res = hal_i2c_write(i2c_bus, DS3231_7_BIT_I2C_ADDR, write_buff, num_bytes_to_write);
 
-    return res == 0 ? REAL_TIME_CLOCK_ERROR_ALL_OK : REAL_TIME_CLOCK_ERROR_I2C_ERROR;
+    return res == HAL_I2C_ERROR_ALL_OK ? REAL_TIME_CLOCK_ERROR_ALL_OK : REAL_TIME_CLOCK_ERROR_I2C_ERROR;
 }
@@ -13,7 +13,7 @@
 
 /* Includes ----------------------------------------------------------------------------------------------------------*/
 
-#include "i2c.h"
+#include "hal_i2c.h"
 
 #include "time_helpers.h"
 
@@ -32,18 +32,18 @@ typedef enum
 /* Public function declarations --------------------------------------------------------------------------------------*/
 
 /**
- * @brief `real_time_clock_init(hi2c)` initializes the real time clock using `hi2c` as the I2C handle for the DS3231.
+ * @brief `real_time_clock_init(b)` initializes the real time clock using I2C bus `b` to talk to the DS3231.
  * The real time clock is composed of both the external DS3231 chip and the onboard MAX32666 RTC.
  *
- * @pre `hi2c` is configured as an I2C master and has pullup resistors to 3.3V.
+ * @pre `b` is initialized as an I2C master and has pullup resistors to 3.3V.
  *
- * @param hi2c the I2C handle to use for communication with the DS3231 RTC chip.
+ * @param bus the I2C bus the DS3231 RTC chip is on.
  *
  * @post the system RTC is initialized and ready to use, the 32kHz clock from the DS3231 is enabled.
  *
  * @retval `REAL_TIME_CLOCK_ERROR_ALL_OK` if successful, else an enumerated error.
  */
-Real_Time_Clock_Error_t real_time_clock_init(mxc_i2c_regs_t *hi2c);
+Real_Time_Clock_Error_t real_time_clock_init(Hal_I2C_Bus_t bus);
 
 /**
  * @brief `real_time_clock_set_datetime(t)` sets the real time clock to time `t`
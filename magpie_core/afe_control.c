@@ -2,9 +2,8 @@
 
 #include <stddef.h> // for NULL
 
-#include "mxc_device.h"
-
 #include "afe_control.h"
+#include "hal_gpio.h"
 
 /* Private defines ---------------------------------------------------------------------------------------------------*/
 
@@ -15,39 +14,37 @@
 
 /* Private variables -------------------------------------------------------------------------------------------------*/
 
-// the I2C handle to use
-static mxc_i2c_regs_t *hi2c_;
+// the I2C bus the gain MUXes are on
+static Hal_I2C_Bus_t i2c_bus;
 
 // buffers for I2C transactions
-static unsigned char tx_buff[MAX14662_TX_BUFF_LEN];
-static unsigned char rx_buff[MAX14662_RX_BUFF_LEN];
-
-const mxc_gpio_cfg_t afe_ch0_enable_pin = {
-    .port = MXC_GPIO0,
-    .mask = MXC_GPIO_PIN_11,
-    .pad = MXC_GPIO_PAD_NONE,
-    .func = MXC_GPIO_FUNC_OUT,
-    .vssel = MXC_GPIO_VSSEL_VDDIO,
-    .drvstr = MXC_GPIO_DRVSTR_0,
+static uint8_t tx_buff[MAX14662_TX_BUFF_LEN];
+static uint8_t rx_buff[MAX14662_RX_BUFF_LEN];
+
+static const Hal_GPIO_Pin_t afe_ch0_enable_pin = {
+    .port = HAL_GPIO_PORT_0,
+    .mask = HAL_GPIO_PIN(11),
+    .func = HAL_GPIO_FUNC_OUT,
+    .voltage = HAL_GPIO_VOLTAGE_VDDIO,
+    .drive_strength = HAL_GPIO_DRIVE_STRENGTH_0,
 };
 
-const mxc_gpio_cfg_t afe_ch1_enable_pin = {
-    .port = MXC_GPIO0,
-    .mask = MXC_GPIO_PIN_12,
-    .pad = MXC_GPIO_PAD_NONE,
-    .func = MXC_GPIO_FUNC_OUT,
-    .vssel = MXC_GPIO_VSSEL_VDDIO,
-    .drvstr = MXC_GPIO_DRVSTR_0,
+static const Hal_GPIO_Pin_t afe_ch1_enable_pin = {
+    .port = HAL_GPIO_PORT_0,
+    .mask = HAL_GPIO_PIN(12),
+    .func = HAL_GPIO_FUNC_OUT,
+    .voltage = HAL_GPIO_VOLTAGE_VDDIO,
+    .drive_strength = HAL_GPIO_DRIVE_STRENGTH_0,
 };
 
 /* Public function definitions ---------------------------------------------------------------------------------------*/
 
-void afe_control_init(mxc_i2c_regs_t *hi2c)
+void afe_control_init(Hal_I2C_Bus_t bus)
 {
-    hi2c_ = hi2c;
+    i2c_bus = bus;
 
-    MXC_GPIO_Config(&afe_ch0_enable_pin);
-    MXC_GPIO_Config(&afe_ch1_enable_pin);
+    hal_gpio_config(&afe_ch0_enable_pin);
+    hal_gpio_config(&afe_ch1_enable_pin);
 }
 
 void afe_control_enable(AFE_Control_Channel_t channel)
@@ -55,10 +52,10 @@ void afe_control_enable(AFE_Control_Channel_t channel)
     switch (channel)
     {
     case AFE_CONTROL_CHANNEL_0:
-        MXC_GPIO_OutSet(afe_ch0_enable_pin.port, afe_ch0_enable_pin.mask);
+        hal_gpio_write(&afe_ch0_enable_pin, true);
         break;
     case AFE_CONTROL_CHANNEL_1:
-        MXC_GPIO_OutSet(afe_ch1_enable_pin.port, afe_ch1_enable_pin.mask);
+        hal_gpio_write(&afe_ch1_enable_pin, true);
         break;
     default:
         break;
@@ -70,10 +67,10 @@ void afe_control_disable(AFE_Control_Channel_t channel)
     switch (channel)
     {
     case AFE_CONTROL_CHANNEL_0:
-        MXC_GPIO_OutClr(afe_ch0_enable_pin.port, afe_ch0_enable_pin.mask);
+        hal_gpio_write(&afe_ch0_enable_pin, false);
         break;
     case AFE_CONTROL_CHANNEL_1:
-        MXC_GPIO_OutClr(afe_ch1_enable_pin.port, afe_ch1_enable_pin.mask);
+        hal_gpio_write(&afe_ch1_enable_pin, false);
         break;
     default:
         break;
@@ -85,9 +82,9 @@ bool afe_control_channel_is_enabled(AFE_Control_Channel_t channel)
     switch (channel)
     {
     case AFE_CONTROL_CHANNEL_0:
-        return MXC_GPIO_InGet(afe_ch0_enable_pin.port, afe_ch0_enable_pin.mask);
+        return hal_gpio_read(&afe_ch0_enable_pin);
     case AFE_CONTROL_CHANNEL_1:
-        return MXC_GPIO_InGet(afe_ch1_enable_pin.port, afe_ch1_enable_pin.mask);
+        return hal_gpio_read(&afe_ch1_enable_pin);
     default:
         return false;
     }
@@ -104,20 +101,9 @@ AFE_Control_Error_t afe_control_set_gain(AFE_Control_Channel_t channel, AFE_Cont
     tx_buff[0] = MAX14662_DUMMY_REGISTER;
     tx_buff[1] = gain;
 
-    mxc_i2c_req_t req = {
-        .i2c = hi2c_,
-        .addr = channel,
-        .tx_buf = tx_buff,
-        .tx_len = MAX14662_TX_BUFF_LEN,
-        .rx_buf = NULL,
-        .rx_len = 0,
-        .restart = 0,
-        .callback = NULL,
-    };
-
-    const int res = MXC_I2C_MasterTransaction(&req);
+    const Hal_I2C_Error_t res = hal_i2c_write(i2c_bus, channel, tx_buff, MAX14662_TX_BUFF_LEN);
 
-    return res == 0 ? AFE_CONTROL_ERROR_ALL_OK : AFE_CONTROL_ERROR_I2C_ERROR;
+    return res == HAL_I2C_ERROR_ALL_OK ? AFE_CONTROL_ERROR_ALL_OK : AFE_CONTROL_ERROR_I2C_ERROR;
 }
 
 AFE_Control_Gain_t afe_control_get_gain(AFE_Control_Channel_t channel)
@@ -127,18 +113,7 @@ AFE_Control_Gain_t afe_control_get_gain(AFE_Control_Channel_t channel)
         return AFE_CONTROL_GAIN_UNDEFINED;
     }
 
-    mxc_i2c_req_t req = {
-        .i2c = hi2c_,
-        .addr = channel,
-        .tx_buf = NULL,
-        .tx_len = 0,
-        .rx_buf = rx_buff,
-        .rx_len = MAX14662_RX_BUFF_LEN,
-        .restart = 0,
-        .callback = NULL,
-    };
-
-    if (MXC_I2C_MasterTransaction(&req) != 0)
+    if (hal_i2c_write_read(i2c_bus, channel, NULL, 0, rx_buff, MAX14662_RX_BUFF_LEN) != HAL_I2C_ERROR_ALL_OK)
     {
         return AFE_CONTROL_GAIN_UNDEFINED;
     }
@@ -6,7 +6,7 @@
  *
  * This module requires:
  * - Exclusive use of P0.11 and P0.12
- * - Shared use of I2C0 using 7-bit addresses 0x4E and 0x4F
+ * - Shared use of an I2C bus, I2C0 on the board, using 7-bit addresses 0x4E and 0x4F, through `hal_i2c.h`
  */
 
 #ifndef AFE_GAIN_CTL_H_
@@ -14,7 +14,9 @@
 
 /* Includes ----------------------------------------------------------------------------------------------------------*/
 
-#include "i2c.h"
+#include <stdbool.h>
+
+#include "hal_i2c.h"
 
 /* Public enumerations -----------------------------------------------------------------------------------------------*/
 
@@ -58,15 +60,15 @@ typedef enum
 /* Public function declarations --------------------------------------------------------------------------------------*/
 
 /**
- * @brief `afe_control_init(hi2c)` initializes the AFE gain control and sets the internal I2C handle to `hi2c`.
+ * @brief `afe_control_init(b)` initializes the AFE gain control to talk to the gain MUXes on I2C bus `b`.
  *
- * @pre `hi2c` is configured as an I2C master and has pullup resistors to 1.8V.
+ * @pre `b` is initialized as an I2C master and has pullup resistors to 1.8V.
  *
- * @param hi2c the I2C handle to use for all AFE gain control I2C communication.
+ * @param bus the I2C bus to use for all AFE gain control I2C communication.
  *
  * @post the AFE gain control is initialized and ready to use.
  */
-void afe_control_init(mxc_i2c_regs_t *hi2c);
+void afe_control_init(Hal_I2C_Bus_t bus);
 
 /**
  * @brief `afe_control_enable(c)` enables AFE channel `c`, powering it on.
@@ -0,0 +1,11 @@
+# Adds the shared core modules to the include path of an MSDK snippet build, see README.md
+
+# Include this from the project.mk of a snippet, then add the core sources the snippet uses to SRCS:
+#   include ../magpie_core/core.mk
+#   SRCS += $(MAGPIE_CORE_DIR)/hal_gpio.c
+
+# the directory this file is in, wherever the including project.mk is
+MAGPIE_CORE_DIR := $(abspath $(dir $(lastword $(MAKEFILE_LIST))))
+
+# only on IPATH, not on VPATH, so AUTOSEARCH doesn't build the whole core into every snippet
+IPATH += $(MAGPIE_CORE_DIR)
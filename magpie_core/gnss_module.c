@@ -0,0 +1,230 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "gnss_module.h"
+#include "hal_gpio.h"
+#include "hal_uart.h"
+
+#include "minmea.h" // 3rd party NMEA parsing lib
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define GNSS_UART (HAL_UART_2)
+#define GNSS_MODULE_UART_BAUD (9600)
+
+#define START_OF_NMEA_SENTENCE ('$')
+#define END_OF_NMEA_SENTENCE ('\n')
+
+// the UART is drained this many chars at a time
+#define UART_READ_CHUNK_LEN (32)
+
+/* Private enumerations ----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief enumerated NMEA parser states are represented here. We build up NMEA strings from chars received from the GPS
+ * UART.
+ */
+typedef enum
+{
+    NMEA_PARSER_STATE_WAITING,         // waiting for the start of sentence char '$
+    NMEA_PARSER_STATE_BUILDING_STRING, // in the middle of building up a string
+} NMEA_Parser_State_t;
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// this pin controls a load switch that powers the GNSS module, high to turn ON, low for OFF
+static const Hal_GPIO_Pin_t gnss_enable_pin = {
+    .port = HAL_GPIO_PORT_0,
+    .mask = HAL_GPIO_PIN(23),
+    .func = HAL_GPIO_FUNC_OUT,
+    .voltage = HAL_GPIO_VOLTAGE_VDDIOH,
+    .drive_strength = HAL_GPIO_DRIVE_STRENGTH_0,
+};
+
+// the PPS signal from the GNSS module pulses high-low once per second when the GPS fix is active
+static const Hal_GPIO_Pin_t gnss_pps_pin = {
+    .port = HAL_GPIO_PORT_0,
+    .mask = HAL_GPIO_PIN(24),
+    .func = HAL_GPIO_FUNC_IN,
+    .voltage = HAL_GPIO_VOLTAGE_VDDIOH,
+    .drive_strength = HAL_GPIO_DRIVE_STRENGTH_0,
+};
+
+// the sync in progress, the NMEA string is built up across calls to `gnss_module_sync_poll()`
+static char nmea_line[MINMEA_MAX_SENTENCE_LENGTH + 1];
+static int nmea_str_pos = 0;
+static NMEA_Parser_State_t parser_state = NMEA_PARSER_STATE_WAITING;
+
+// GGA quality is an integer in 0..9
+static int gga_quality = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `is_ascii(c)` is true iff integer `c` represents a valid ascii character
+ */
+static bool is_ascii(int c);
+
+/**
+ * @brief `parse_char(c)` adds char `c` to the NMEA string being built up, and is true if it completes the string.
+ * Strings too long for the buffer are dropped.
+ */
+static bool parse_char(char c);
+
+/**
+ * @brief `handle_line(t, e)` sets `t` to the time of the completed NMEA string if it is an RMC sentence with a good
+ * fix, and keeps track of the fix quality from GGA sentences.
+ *
+ * @retval true if the search is finished, with the result in `e`, false if it goes on
+ */
+static bool handle_line(struct tm *utc_time, GNSS_Module_Error_t *err);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+GNSS_Module_Error_t gnss_module_init()
+{
+    hal_gpio_config(&gnss_enable_pin);
+
+    // turn the module off to start
+    gnss_module_disable();
+
+    hal_gpio_config(&gnss_pps_pin);
+
+    // the GNSS module talks 3.3V logic
+    if (hal_uart_init(GNSS_UART, GNSS_MODULE_UART_BAUD, HAL_GPIO_VOLTAGE_VDDIOH) != HAL_UART_ERROR_ALL_OK)
+    {
+        return GNSS_MODULE_UART_ERROR;
+    }
+
+    return GNSS_MODULE_ERROR_ALL_OK;
+}
+
+void gnss_module_enable()
+{
+    hal_gpio_write(&gnss_enable_pin, true);
+}
+
+void gnss_module_disable()
+{
+    hal_gpio_write(&gnss_enable_pin, false);
+}
+
+void gnss_module_sync_start()
+{
+    parser_state = NMEA_PARSER_STATE_WAITING;
+    nmea_str_pos = 0;
+    gga_quality = 0;
+}
+
+GNSS_Module_Error_t gnss_module_sync_poll(struct tm *utc_time, bool *has_fix)
+{
+    *has_fix = false;
+
+    uint8_t chars[UART_READ_CHUNK_LEN];
+
+    // everything received since the last poll is parsed
+    uint32_t num_read;
+    while ((num_read = hal_uart_read(GNSS_UART, chars, sizeof(chars))) > 0)
+    {
+        for (uint32_t i = 0; i < num_read; i++)
+        {
+            if (!is_ascii(chars[i]) || !parse_char((char)chars[i]))
+            {
+                continue;
+            }
+
+            GNSS_Module_Error_t err;
+            if (handle_line(utc_time, &err))
+            {
+                *has_fix = err == GNSS_MODULE_ERROR_ALL_OK;
+                return err;
+            }
+        }
+    }
+
+    return GNSS_MODULE_ERROR_ALL_OK;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool is_ascii(int c)
+{
+    return (0 <= c && c <= 127);
+}
+
+bool parse_char(char next_char)
+{
+    switch (parser_state)
+    {
+    case NMEA_PARSER_STATE_WAITING:
+
+        nmea_str_pos = 0;
+
+        if (next_char == START_OF_NMEA_SENTENCE)
+        {
+            nmea_line[nmea_str_pos] = next_char;
+            nmea_str_pos++;
+
+            parser_state = NMEA_PARSER_STATE_BUILDING_STRING;
+        }
+        break; // case NMEA_PARSER_STATE_WAITING
+
+    case NMEA_PARSER_STATE_BUILDING_STRING:
+
+        // a string with no end in sight is garbage, wait for the next one
+        if (nmea_str_pos == MINMEA_MAX_SENTENCE_LENGTH)
+        {
+            parser_state = NMEA_PARSER_STATE_WAITING;
+            break;
+        }
+
+        nmea_line[nmea_str_pos] = next_char;
+        nmea_str_pos++;
+
+        if (next_char == END_OF_NMEA_SENTENCE)
+        {
+            nmea_line[nmea_str_pos] = 0; // null-terminate the string
+            parser_state = NMEA_PARSER_STATE_WAITING;
+            return true;
+        }
+        break; // case NMEA_PARSER_STATE_BUILDING_STRING
+    } // switch on parser_State
+
+    return false;
+}
+
+bool handle_line(struct tm *utc_time, GNSS_Module_Error_t *err)
+{
+    switch (minmea_sentence_id(nmea_line, false))
+    {
+    case MINMEA_SENTENCE_GGA: // GGA gives us the fix-quality, we can use this to make sure we have a good fix
+    {
+        struct minmea_sentence_gga frame;
+        if (minmea_parse_gga(&frame, nmea_line))
+        {
+            gga_quality = frame.fix_quality;
+        }
+
+        break; // case MINMEA_SENTENCE_GGA
+    }
+    case MINMEA_SENTENCE_RMC: // RMC has the datetime
+    {
+        struct minmea_sentence_rmc frame;
+        if (minmea_parse_rmc(&frame, nmea_line))
+        {
+            // only take the time if we are sure the GPS signal is good
+            if (gga_quality >= 1 && frame.valid) // TODO: learn more about GNSS, is this a good way to check if we have a good GPS connection?
+            {
+                *err = minmea_getdatetime(utc_time, &frame.date, &frame.time) == 0 ? GNSS_MODULE_ERROR_ALL_OK : GNSS_MODULE_DATETIME_ERROR;
+                return true;
+            }
+        }
+
+        break; // case MINMEA_SENTENCE_RMC
+    }
+    default:
+        break;
+    } // switch on NMEA sentence
+
+    return false;
+}
@@ -5,9 +5,12 @@
  * microcontroller communicates with the GNSS via UART. The GNSS is mainly used to get an accurate timestamp to use to
  * sync the Real Time Clock to GNSS time.
  *
+ * The module only parses what the GNSS sends, the caller decides what to do with the time and how long to wait for a
+ * fix, so it can be polled from a task of the scheduler and run on the host against a simulated UART.
+ *
  * This module requires:
- * - Exclusive use of UART2
- * - Exclusive use of pins P0.24, P0.24, P0.28, and P0.29
+ * - Exclusive use of UART2, through `hal_uart.h`
+ * - Exclusive use of pins P0.23, P0.24, P0.28, and P0.29
  */
 
 #ifndef GNSS_MODULE_H__
@@ -15,7 +18,8 @@
 
 /* Includes ----------------------------------------------------------------------------------------------------------*/
 
-#include "uart.h"
+#include <stdbool.h>
+#include <time.h>
 
 /* Public enumerations -----------------------------------------------------------------------------------------------*/
 
@@ -26,7 +30,6 @@ typedef enum
 {
     GNSS_MODULE_ERROR_ALL_OK,
     GNSS_MODULE_UART_ERROR,
-    GNSS_MODULE_TIMEOUT_ERROR,
     GNSS_MODULE_DATETIME_ERROR,
 } GNSS_Module_Error_t;
 
@@ -62,19 +65,30 @@ void gnss_module_enable();
 void gnss_module_disable();
 
 /**
- * @brief `gnss_module_sync_RTC_to_GNSS_time(t)` syncs the Real Time Clock module to the time reported by the GNSS
- * module. If it takes longer than `t` seconds the function is aborted.
+ * @brief `gnss_module_sync_start()` starts looking for a good fix in what the GNSS module sends. The search is carried
+ * on by `gnss_module_sync_poll()`, so the caller is free to do other work in between, and to give up whenever it likes.
  *
- * @pre The GNSS and RTC modules are both successfuly initialized, the GNSS module is enabled, and TODO add aprecondition relating to a mandatory GPS fix (need a function to report the fix quality too)
+ * @pre `gnss_module_init()` has been successfully called, and the GNSS module is enabled.
  *
- * @param timeout_sec the timeout period in seconds, if it takes at least this long to get a GPS fix and sync the RTC,
- * the function aborts and returns an error code.
+ * @post the NMEA parser is reset, and anything it had seen of an earlier fix is forgotten.
+ */
+void gnss_module_sync_start();
+
+/**
+ * @brief `gnss_module_sync_poll(t, f)` parses the NMEA sentences received from the GNSS module since the last poll.
+ * `f` is set to true as soon as an RMC sentence comes in with a good fix, and `t` is then the UTC time it gives. The
+ * UART holds `HAL_UART_RX_BUFF_LEN_IN_BYTES` characters, so at 9600 baud this needs to be called at least every 250
+ * milliseconds or so, or sentences are lost and the fix takes longer to find.
  *
- * @post the RTC module is syncronized to the current UTC time as reported by the GNSS module. Calling this function
- * will mutate the time kept by the RTC module if the sync is successful (otherwise the RTC time is left unchanged).
+ * @pre `gnss_module_sync_start()` has been called, and no fix was found since.
  *
- * @retval `GNSS_MODULE_ERROR_ALL_OK` if initialization is successful, else and enumerated error.
+ * @param utc_time set to the UTC time of the fix, only if `f` is set to true
+ *
+ * @param has_fix set to true if a good fix was found, false if the search goes on
+ *
+ * @retval `GNSS_MODULE_ERROR_ALL_OK` if the search found a fix or is still in progress, else an enumerated error, which
+ * ends the search.
  */
-GNSS_Module_Error_t gnss_module_sync_RTC_to_GNSS_time(int timeout_sec);
+GNSS_Module_Error_t gnss_module_sync_poll(struct tm *utc_time, bool *has_fix);
 
 #endif
@@ -0,0 +1,64 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_gpio.h"
+#include "gpio.h"
+#include "mxc_device.h"
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `gpio_regs(p)` is the MSDK register block of GPIO port `p`.
+ */
+static mxc_gpio_regs_t *gpio_regs(Hal_GPIO_Port_t port);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+Hal_GPIO_Error_t hal_gpio_config(const Hal_GPIO_Pin_t *pin)
+{
+    static const mxc_gpio_func_t funcs[] = {
+        [HAL_GPIO_FUNC_IN] = MXC_GPIO_FUNC_IN,
+        [HAL_GPIO_FUNC_OUT] = MXC_GPIO_FUNC_OUT,
+        [HAL_GPIO_FUNC_ALT1] = MXC_GPIO_FUNC_ALT1,
+    };
+
+    static const mxc_gpio_drvstr_t drive_strengths[] = {
+        [HAL_GPIO_DRIVE_STRENGTH_0] = MXC_GPIO_DRVSTR_0,
+        [HAL_GPIO_DRIVE_STRENGTH_1] = MXC_GPIO_DRVSTR_1,
+        [HAL_GPIO_DRIVE_STRENGTH_2] = MXC_GPIO_DRVSTR_2,
+        [HAL_GPIO_DRIVE_STRENGTH_3] = MXC_GPIO_DRVSTR_3,
+    };
+
+    const mxc_gpio_cfg_t cfg = {
+        .port = gpio_regs(pin->port),
+        .mask = pin->mask,
+        .pad = MXC_GPIO_PAD_NONE,
+        .func = funcs[pin->func],
+        .vssel = pin->voltage == HAL_GPIO_VOLTAGE_VDDIOH ? MXC_GPIO_VSSEL_VDDIOH : MXC_GPIO_VSSEL_VDDIO,
+        .drvstr = drive_strengths[pin->drive_strength],
+    };
+
+    return MXC_GPIO_Config(&cfg) == E_NO_ERROR ? HAL_GPIO_ERROR_ALL_OK : HAL_GPIO_ERROR_CONFIG_ERROR;
+}
+
+void hal_gpio_write(const Hal_GPIO_Pin_t *pin, bool state)
+{
+    state ? MXC_GPIO_OutSet(gpio_regs(pin->port), pin->mask) : MXC_GPIO_OutClr(gpio_regs(pin->port), pin->mask);
+}
+
+void hal_gpio_toggle(const Hal_GPIO_Pin_t *pin)
+{
+    MXC_GPIO_OutToggle(gpio_regs(pin->port), pin->mask);
+}
+
+bool hal_gpio_read(const Hal_GPIO_Pin_t *pin)
+{
+    return (bool)MXC_GPIO_InGet(gpio_regs(pin->port), pin->mask);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+mxc_gpio_regs_t *gpio_regs(Hal_GPIO_Port_t port)
+{
+    return port == HAL_GPIO_PORT_0 ? MXC_GPIO0 : MXC_GPIO1;
+}
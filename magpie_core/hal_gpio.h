@@ -0,0 +1,117 @@
+/**
+ * @file      hal_gpio.h
+ * @brief     A thin hardware abstraction of the GPIO pins is represented here.
+ * @details   The drivers configure, read, and write pins through this module instead of calling the MSDK directly, so
+ *            they build and run on a host with the host back-end in test/host_sim, where device models can drive the
+ *            inputs and watch the outputs. `hal_gpio.c` is the MSDK back-end for the MAX32666.
+ */
+
+#ifndef HAL_GPIO_H_
+#define HAL_GPIO_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// the mask of pin `n` of a port, pins of the same port can be or'ed together
+#define HAL_GPIO_PIN(n) (1u << (n))
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief GPIO errors are represented here
+ */
+typedef enum
+{
+    HAL_GPIO_ERROR_ALL_OK,
+    HAL_GPIO_ERROR_CONFIG_ERROR,
+} Hal_GPIO_Error_t;
+
+/**
+ * @brief The GPIO ports of the MAX32666 are represented here
+ */
+typedef enum
+{
+    HAL_GPIO_PORT_0 = 0,
+    HAL_GPIO_PORT_1,
+    HAL_GPIO_NUM_PORTS,
+} Hal_GPIO_Port_t;
+
+/**
+ * @brief The functions a pin can take are represented here, only the alternate functions we use are listed
+ */
+typedef enum
+{
+    HAL_GPIO_FUNC_IN = 0,
+    HAL_GPIO_FUNC_OUT,
+    HAL_GPIO_FUNC_ALT1,
+} Hal_GPIO_Func_t;
+
+/**
+ * @brief The supply a pin takes its logic high from is represented here
+ */
+typedef enum
+{
+    HAL_GPIO_VOLTAGE_VDDIO = 0, // 1.8V on the FTHR2
+    HAL_GPIO_VOLTAGE_VDDIOH,    // 3.3V on the FTHR2
+} Hal_GPIO_Voltage_t;
+
+/**
+ * @brief The output drive strengths of a pin are represented here, from weakest to strongest
+ */
+typedef enum
+{
+    HAL_GPIO_DRIVE_STRENGTH_0 = 0,
+    HAL_GPIO_DRIVE_STRENGTH_1,
+    HAL_GPIO_DRIVE_STRENGTH_2,
+    HAL_GPIO_DRIVE_STRENGTH_3,
+} Hal_GPIO_Drive_Strength_t;
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief One or more pins of a port and their configuration are represented here, pins are never pulled up or down.
+ */
+typedef struct
+{
+    Hal_GPIO_Port_t port;
+    uint32_t mask; // see `HAL_GPIO_PIN(n)`
+    Hal_GPIO_Func_t func;
+    Hal_GPIO_Voltage_t voltage;
+    Hal_GPIO_Drive_Strength_t drive_strength;
+} Hal_GPIO_Pin_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_gpio_config(p)` configures the pins of `p` with the function, voltage, and drive strength of `p`.
+ *
+ * @post the pins are ready to read or write, outputs keep the level they had.
+ *
+ * @retval `HAL_GPIO_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_GPIO_Error_t hal_gpio_config(const Hal_GPIO_Pin_t *pin);
+
+/**
+ * @brief `hal_gpio_write(p, s)` drives the pins of `p` high if `s` is true, else low.
+ *
+ * @pre `p` is configured as an output.
+ */
+void hal_gpio_write(const Hal_GPIO_Pin_t *pin, bool state);
+
+/**
+ * @brief `hal_gpio_toggle(p)` drives the pins of `p` to the opposite level.
+ *
+ * @pre `p` is configured as an output.
+ */
+void hal_gpio_toggle(const Hal_GPIO_Pin_t *pin);
+
+/**
+ * @brief `hal_gpio_read(p)` is true if any of the pins of `p` is high.
+ */
+bool hal_gpio_read(const Hal_GPIO_Pin_t *pin);
+
+#endif /* HAL_GPIO_H_ */
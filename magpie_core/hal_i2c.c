@@ -0,0 +1,67 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_i2c.h"
+#include "i2c.h"
+#include "mxc_device.h"
+
+#include <stddef.h> // for NULL
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `i2c_regs(b)` is the MSDK register block of I2C bus `b`.
+ */
+static mxc_i2c_regs_t *i2c_regs(Hal_I2C_Bus_t bus);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+Hal_I2C_Error_t hal_i2c_init(Hal_I2C_Bus_t bus, Hal_I2C_Speed_t speed)
+{
+    if (MXC_I2C_Init(i2c_regs(bus), 1, 0) != E_NO_ERROR)
+    {
+        return HAL_I2C_ERROR_CONFIG_ERROR;
+    }
+
+    const unsigned int freq_hz = speed == HAL_I2C_SPEED_FAST ? MXC_I2C_FAST_SPEED : MXC_I2C_STD_MODE;
+    if (MXC_I2C_SetFrequency(i2c_regs(bus), freq_hz) != freq_hz)
+    {
+        return HAL_I2C_ERROR_CONFIG_ERROR;
+    }
+
+    return HAL_I2C_ERROR_ALL_OK;
+}
+
+Hal_I2C_Error_t hal_i2c_write(Hal_I2C_Bus_t bus, uint8_t addr, const uint8_t *tx_buff, uint32_t tx_len)
+{
+    return hal_i2c_write_read(bus, addr, tx_buff, tx_len, NULL, 0);
+}
+
+Hal_I2C_Error_t hal_i2c_write_read(Hal_I2C_Bus_t bus, uint8_t addr, const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len)
+{
+    mxc_i2c_req_t req = {
+        .i2c = i2c_regs(bus),
+        .addr = addr,
+        .tx_buf = (uint8_t *)tx_buff, // the MSDK only reads it
+        .tx_len = tx_len,
+        .rx_buf = rx_buff,
+        .rx_len = rx_len,
+        .restart = 0,
+        .callback = NULL,
+    };
+
+    return MXC_I2C_MasterTransaction(&req) == 0 ? HAL_I2C_ERROR_ALL_OK : HAL_I2C_ERROR_TRANSACTION_ERROR;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+mxc_i2c_regs_t *i2c_regs(Hal_I2C_Bus_t bus)
+{
+    static mxc_i2c_regs_t *const regs[] = {
+        [HAL_I2C_BUS_0] = MXC_I2C0_BUS0,
+        [HAL_I2C_BUS_1] = MXC_I2C1_BUS0,
+        [HAL_I2C_BUS_2] = MXC_I2C2_BUS0,
+    };
+
+    return regs[bus];
+}
@@ -0,0 +1,81 @@
+/**
+ * @file      hal_i2c.h
+ * @brief     A thin hardware abstraction of the I2C busses is represented here.
+ * @details   Only blocking master transactions are supported, which is all the RTC, the SD card bank, and the AFE gain
+ *            MUXes need. `hal_i2c.c` is the MSDK back-end for the MAX32666, the host back-end in
+ *            adc_dma_sd_card_write/test/host_sim hands transactions to device models attached at their addresses.
+ */
+
+#ifndef HAL_I2C_H_
+#define HAL_I2C_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief I2C errors are represented here
+ */
+typedef enum
+{
+    HAL_I2C_ERROR_ALL_OK,
+    HAL_I2C_ERROR_CONFIG_ERROR,
+    HAL_I2C_ERROR_TRANSACTION_ERROR,
+} Hal_I2C_Error_t;
+
+/**
+ * @brief The I2C busses of the MAX32666 are represented here
+ */
+typedef enum
+{
+    HAL_I2C_BUS_0 = 0,
+    HAL_I2C_BUS_1,
+    HAL_I2C_BUS_2,
+    HAL_I2C_NUM_BUSES,
+} Hal_I2C_Bus_t;
+
+/**
+ * @brief The I2C clock speeds are represented here
+ */
+typedef enum
+{
+    HAL_I2C_SPEED_STANDARD = 0, // 100kHz
+    HAL_I2C_SPEED_FAST,         // 400kHz
+} Hal_I2C_Speed_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_i2c_init(b, s)` sets up bus `b` as a master at speed `s`.
+ *
+ * @post `b` is ready for transactions, its pins take their logic high from VDDIO, see hal_gpio.h to change that.
+ *
+ * @retval `HAL_I2C_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_I2C_Error_t hal_i2c_init(Hal_I2C_Bus_t bus, Hal_I2C_Speed_t speed);
+
+/**
+ * @brief `hal_i2c_write(b, a, t, tl)` writes the `tl` bytes of `t` to the device at 7 bit address `a` on bus `b`.
+ *
+ * @pre `b` is initialized.
+ *
+ * @retval `HAL_I2C_ERROR_ALL_OK` if the device acknowledged every byte, else an error code
+ */
+Hal_I2C_Error_t hal_i2c_write(Hal_I2C_Bus_t bus, uint8_t addr, const uint8_t *tx_buff, uint32_t tx_len);
+
+/**
+ * @brief `hal_i2c_write_read(b, a, t, tl, r, rl)` writes the `tl` bytes of `t` to the device at 7 bit address `a` on
+ * bus `b`, then reads `rl` bytes from it into `r`, usually to read registers starting at the address written. With
+ * `tl` of 0 it only reads, for devices with a single register.
+ *
+ * @pre `b` is initialized.
+ *
+ * @param rx_buff where to store the bytes read, may be the same buffer as `t`.
+ *
+ * @retval `HAL_I2C_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_I2C_Error_t hal_i2c_write_read(Hal_I2C_Bus_t bus, uint8_t addr, const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len);
+
+#endif /* HAL_I2C_H_ */
@@ -0,0 +1,30 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_sdhc.h"
+#include "mxc_device.h"
+#include "sdhc_lib.h"
+#include "sdhc_regs.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define SDHC_CONFIG_BLOCK_GAP (0)
+#define SDHC_CONFIG_CLK_DIV (0x0b0)
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+Hal_SDHC_Error_t hal_sdhc_init()
+{
+    const mxc_sdhc_cfg_t sdhc_cfg = {
+        .bus_voltage = MXC_SDHC_Bus_Voltage_3_3,
+        .block_gap = SDHC_CONFIG_BLOCK_GAP,
+        .clk_div = SDHC_CONFIG_CLK_DIV,
+    };
+
+    return MXC_SDHC_Init(&sdhc_cfg) == E_NO_ERROR ? HAL_SDHC_ERROR_ALL_OK : HAL_SDHC_ERROR_INIT_ERROR;
+}
+
+Hal_SDHC_Error_t hal_sdhc_init_card(uint32_t num_retries)
+{
+    return MXC_SDHC_Lib_InitCard(num_retries) == E_NO_ERROR ? HAL_SDHC_ERROR_ALL_OK : HAL_SDHC_ERROR_INIT_ERROR;
+}
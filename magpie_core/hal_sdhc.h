@@ -0,0 +1,45 @@
+/**
+ * @file      hal_sdhc.h
+ * @brief     A thin hardware abstraction of the SD host controller is represented here.
+ * @details   Only bringing up the controller and the card is covered, once the card is up FatFS reaches it through the
+ *            MSDK disk layer. `hal_sdhc.c` is the MSDK back-end for the MAX32666, the host back-end in test/host_sim
+ *            has no controller to bring up.
+ */
+
+#ifndef HAL_SDHC_H_
+#define HAL_SDHC_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief SD host controller errors are represented here
+ */
+typedef enum
+{
+    HAL_SDHC_ERROR_ALL_OK,
+    HAL_SDHC_ERROR_INIT_ERROR,
+} Hal_SDHC_Error_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_sdhc_init()` sets up the SD host controller for a 3.3V card.
+ *
+ * @retval `HAL_SDHC_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_SDHC_Error_t hal_sdhc_init();
+
+/**
+ * @brief `hal_sdhc_init_card(n)` brings up the card in the slot, trying up to `n` times.
+ *
+ * @pre the controller is initialized and the card is powered.
+ *
+ * @retval `HAL_SDHC_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_SDHC_Error_t hal_sdhc_init_card(uint32_t num_retries);
+
+#endif /* HAL_SDHC_H_ */
@@ -0,0 +1,27 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_sleep.h"
+#include "mxc_device.h"
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_sleep_mask_interrupts()
+{
+    __disable_irq();
+}
+
+void hal_sleep_wait_for_interrupt()
+{
+    // deep sleep would stop the clocks the SPI and the DMA of the ADC run on, so the core only ever goes to plain sleep
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+    // a pending interrupt wakes the core from WFI even with PRIMASK set
+    __DSB();
+    __WFI();
+}
+
+void hal_sleep_unmask_interrupts()
+{
+    __enable_irq();
+}
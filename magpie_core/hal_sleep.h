@@ -0,0 +1,47 @@
+/**
+ * @file      hal_sleep.h
+ * @brief     A thin hardware abstraction of sleeping the core until an interrupt is represented here.
+ * @details   The main loop sleeps whenever the scheduler has nothing to run, and the interrupt that posts the next event
+ *            wakes it. To not sleep through an event posted between checking for work and going to sleep, the idle
+ *            hook masks interrupts, checks `scheduler_is_idle()`, waits, and then unmasks them:
+ *
+ *                hal_sleep_mask_interrupts();
+ *                if (scheduler_is_idle())
+ *                {
+ *                    hal_sleep_wait_for_interrupt();
+ *                }
+ *                hal_sleep_unmask_interrupts();
+ *
+ *            An interrupt that comes in while they are masked still wakes the core, or stops it from sleeping at all,
+ *            and runs as soon as they are unmasked.
+ *
+ *            `hal_sleep.c` is the MSDK back-end for the MAX32666, it masks with PRIMASK and sleeps with `WFI`. The host
+ *            back-end in test/host_sim waits for the host back-ends of the interrupts to signal it.
+ */
+
+#ifndef HAL_SLEEP_H_
+#define HAL_SLEEP_H_
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_sleep_mask_interrupts()` stops interrupts from running, without stopping them from waking the core.
+ *
+ * @pre called from the main loop, with interrupts unmasked.
+ */
+void hal_sleep_mask_interrupts();
+
+/**
+ * @brief `hal_sleep_wait_for_interrupt()` sleeps the core until an interrupt is pending, it returns right away if one
+ * already is. Only the core sleeps, the clocks of the peripherals keep running, so the DMA carries on filling the ring.
+ *
+ * @pre interrupts are masked by `hal_sleep_mask_interrupts()`.
+ */
+void hal_sleep_wait_for_interrupt();
+
+/**
+ * @brief `hal_sleep_unmask_interrupts()` lets interrupts run again, any that came in while they were masked run now.
+ */
+void hal_sleep_unmask_interrupts();
+
+#endif /* HAL_SLEEP_H_ */
@@ -0,0 +1,154 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_timer.h"
+#include "mxc_delay.h"
+#include "mxc_device.h"
+#include "nvic_table.h"
+#include "tmr.h"
+
+#include <stddef.h> // for NULL
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// TMR0 is left to the snippets, gnss_rtc_sync times out on it
+#define TICK_TMR (MXC_TMR1)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static Hal_Timer_Tick_Callback_t tick_callback = NULL;
+
+// the timer counts this many cycles of the peripheral clock per period, 0 while the tick isn't running
+static uint32_t tick_period_cycles = 0;
+
+// the number of periods the ticks are held off for, 0 while they come every period
+static uint32_t num_suppressed_periods = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The interrupt of the tick timer calls the tick callback once per period, `hal_timer_start_tick()` puts it in the
+ * vector table
+ */
+static void tick_irq_handler(void);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void hal_timer_delay_microsecs(uint32_t microsecs)
+{
+    MXC_Delay(microsecs);
+}
+
+Hal_Timer_Error_t hal_timer_start_tick(uint32_t period_microsecs, Hal_Timer_Tick_Callback_t callback)
+{
+    hal_timer_stop_tick();
+
+    tick_callback = callback;
+    tick_period_cycles = (PeripheralClock / 1000000) * period_microsecs;
+    num_suppressed_periods = 0;
+
+    // the timer counts the peripheral clock, and wraps back to 1 on reaching the compare count in continuous mode
+    mxc_tmr_cfg_t tmr_cfg = {
+        .pres = TMR_PRES_1,
+        .mode = TMR_MODE_CONTINUOUS,
+        .cmp_cnt = tick_period_cycles,
+        .pol = 0,
+    };
+
+    if (MXC_TMR_Init(TICK_TMR, &tmr_cfg) != E_NO_ERROR)
+    {
+        return HAL_TIMER_ERROR_TIMER_ERROR;
+    }
+
+    MXC_TMR_ClearFlags(TICK_TMR);
+    MXC_NVIC_SetVector(TMR1_IRQn, tick_irq_handler);
+    NVIC_EnableIRQ(TMR1_IRQn);
+    MXC_TMR_Start(TICK_TMR);
+
+    return HAL_TIMER_ERROR_ALL_OK;
+}
+
+void hal_timer_stop_tick()
+{
+    NVIC_DisableIRQ(TMR1_IRQn);
+    MXC_TMR_Shutdown(TICK_TMR);
+    MXC_TMR_ClearFlags(TICK_TMR);
+    NVIC_ClearPendingIRQ(TMR1_IRQn);
+
+    tick_callback = NULL;
+    tick_period_cycles = 0;
+    num_suppressed_periods = 0;
+}
+
+void hal_timer_suppress_tick(uint32_t max_microsecs)
+{
+    // there is no tick to hold off before it's started, or after it's stopped
+    if (tick_period_cycles == 0)
+    {
+        return;
+    }
+
+    // the compare count is 32 bits, about 89 seconds of the 48MHz peripheral clock
+    const uint64_t max_cycles = (uint64_t)(PeripheralClock / 1000000) * max_microsecs;
+    const uint64_t num_periods = (max_cycles < UINT32_MAX ? max_cycles : UINT32_MAX) / tick_period_cycles;
+
+    // a pending tick hasn't been handed to the callback yet, and keeps the core from sleeping anyway
+    if (num_periods <= 1 || MXC_TMR_GetFlags(TICK_TMR) != 0)
+    {
+        return;
+    }
+
+    // the count carries on from the last tick, so the tick comes exactly that many periods after it
+    num_suppressed_periods = (uint32_t)num_periods;
+    MXC_TMR_SetCompare(TICK_TMR, num_suppressed_periods * tick_period_cycles);
+}
+
+void hal_timer_resume_tick()
+{
+    if (num_suppressed_periods == 0)
+    {
+        return;
+    }
+
+    MXC_TMR_Stop(TICK_TMR);
+
+    const uint32_t count = MXC_TMR_GetCount(TICK_TMR);
+    uint32_t num_periods;
+    uint32_t left_over_cycles;
+
+    // if the held off tick came, the count started over from it, and its interrupt is taken care of here
+    if (MXC_TMR_GetFlags(TICK_TMR) != 0)
+    {
+        num_periods = num_suppressed_periods;
+        left_over_cycles = count;
+        MXC_TMR_ClearFlags(TICK_TMR);
+        NVIC_ClearPendingIRQ(TMR1_IRQn);
+    }
+    else
+    {
+        num_periods = count / tick_period_cycles;
+        left_over_cycles = count % tick_period_cycles;
+    }
+
+    num_suppressed_periods = 0;
+    MXC_TMR_SetCompare(TICK_TMR, tick_period_cycles);
+    MXC_TMR_SetCount(TICK_TMR, left_over_cycles);
+    MXC_TMR_Start(TICK_TMR);
+
+    if (num_periods > 0 && tick_callback != NULL)
+    {
+        tick_callback(num_periods);
+    }
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void tick_irq_handler(void)
+{
+    MXC_TMR_ClearFlags(TICK_TMR);
+
+    if (tick_callback != NULL)
+    {
+        tick_callback(1);
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * @file      hal_timer.h
+ * @brief     A thin hardware abstraction of the delays the drivers wait for, and of the periodic tick that drives the
+ *            timers of the scheduler, is represented here.
+ * @details   `hal_timer.c` is the MSDK back-end for the MAX32666, it busy waits on the system tick, and ticks from the
+ *            interrupt of TMR1, whose handler `hal_timer_start_tick()` puts in the vector table rather than defining
+ *            `TMR1_IRQHandler()`. The host back-end in test/host_sim sleeps on the same sped up clock as the simulated
+ *            DMA, so a delay eats up the same number of DMA blocks at any pace, and ticks from a thread of its own.
+ *            Timestamps come from cycle_counter.h instead.
+ *
+ *            An idle hook that sleeps until the next interrupt can hold the tick off with `hal_timer_suppress_tick()`
+ *            until the next software timer of the scheduler is due, so the core isn't woken by every tick in between
+ *            for nothing, and catch the clock up with `hal_timer_resume_tick()` once it wakes, whatever woke it.
+ */
+
+#ifndef HAL_TIMER_H_
+#define HAL_TIMER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Timer errors are represented here
+ */
+typedef enum
+{
+    HAL_TIMER_ERROR_ALL_OK,
+    HAL_TIMER_ERROR_TIMER_ERROR,
+} Hal_Timer_Error_t;
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A function called on every tick of the periodic tick is represented here, it is passed the number of periods
+ * since it was last called, 1 except when `hal_timer_resume_tick()` calls it, and runs in interrupt context or from
+ * `hal_timer_resume_tick()`.
+ */
+typedef void (*Hal_Timer_Tick_Callback_t)(uint32_t num_periods);
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_timer_delay_microsecs(n)` waits for `n` microseconds before returning, interrupts still run meanwhile.
+ */
+void hal_timer_delay_microsecs(uint32_t microsecs);
+
+/**
+ * @brief `hal_timer_start_tick(p, f)` calls `f` every `p` microseconds from interrupt context, until the tick is
+ * stopped. A tick that is already running is restarted with the new period and callback.
+ *
+ * @retval `HAL_TIMER_ERROR_ALL_OK` if the tick started, else an error code
+ */
+Hal_Timer_Error_t hal_timer_start_tick(uint32_t period_microsecs, Hal_Timer_Tick_Callback_t callback);
+
+/**
+ * @brief `hal_timer_stop_tick()` stops the periodic tick, the callback is not called again once this returns.
+ */
+void hal_timer_stop_tick();
+
+/**
+ * @brief `hal_timer_suppress_tick(n)` holds off the ticks for up to `n` microseconds from the last tick, rounded down
+ * to whole periods, so the next one wakes the core at the end of that time rather than every period. It does nothing
+ * if that is a period or less, or if a tick is already pending.
+ *
+ * @pre the tick is running, and interrupts are masked by `hal_sleep_mask_interrupts()`.
+ *
+ * @post the core can sleep until the end of the time, or another interrupt, and `hal_timer_resume_tick()` must be
+ * called before interrupts are unmasked.
+ */
+void hal_timer_suppress_tick(uint32_t max_microsecs);
+
+/**
+ * @brief `hal_timer_resume_tick()` goes back to a tick every period after `hal_timer_suppress_tick()`, and calls the
+ * tick callback with the number of whole periods that passed since the last tick, if any, so the clock it moves on
+ * doesn't fall behind. What is left of a period counts toward the next tick.
+ *
+ * @pre interrupts are still masked since `hal_timer_suppress_tick()`.
+ */
+void hal_timer_resume_tick();
+
+#endif /* HAL_TIMER_H_ */
@@ -0,0 +1,161 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "hal_uart.h"
+#include "gpio.h"
+#include "mxc_device.h"
+#include "nvic_table.h"
+#include "uart.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// a power of 2, so the free running indices wrap around cleanly
+#define RX_BUFF_LEN (HAL_UART_RX_BUFF_LEN_IN_BYTES)
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The MSDK register block, pin map, pins, and interrupt of a UART are represented here.
+ */
+typedef struct
+{
+    mxc_uart_regs_t *regs;
+    sys_map_t map;
+    mxc_gpio_regs_t *port;
+    uint32_t rx_tx_mask;
+    mxc_gpio_func_t func;
+    IRQn_Type irq;
+    void (*irq_handler)(void);
+} UART_Config_t;
+
+/**
+ * @brief The bytes a UART has received are represented here, `head` is only written by the interrupt and `tail` only by
+ * `hal_uart_read()`, both count up forever and are taken modulo the length of the buffer.
+ */
+typedef struct
+{
+    uint8_t buff[RX_BUFF_LEN];
+    uint32_t head;
+    uint32_t tail;
+} RX_Buff_t;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `drain_rx_fifo(u)` moves the bytes in the receive FIFO of UART `u` into its buffer, dropping them if the
+ * buffer is full. It runs in the interrupt of the UART.
+ */
+static void drain_rx_fifo(Hal_UART_t uart);
+
+/**
+ * @brief The interrupt of the GNSS UART fires as soon as a byte arrives, `hal_uart_init()` puts it in the vector table
+ */
+static void uart2_irq_handler(void);
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static const UART_Config_t uart_configs[] = {
+    [HAL_UART_2] = {
+        .regs = MXC_UART2,
+        .map = MAP_B,
+        .port = MXC_GPIO0,
+        .rx_tx_mask = MXC_GPIO_PIN_28 | MXC_GPIO_PIN_29,
+        .func = MXC_GPIO_FUNC_ALT3,
+        .irq = UART2_IRQn,
+        .irq_handler = uart2_irq_handler,
+    },
+};
+
+static RX_Buff_t rx_buffs[HAL_UART_NUM_UARTS];
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+Hal_UART_Error_t hal_uart_init(Hal_UART_t uart, uint32_t baud_rate, Hal_GPIO_Voltage_t voltage)
+{
+    const UART_Config_t *cfg = &uart_configs[uart];
+
+    NVIC_DisableIRQ(cfg->irq);
+    rx_buffs[uart].head = 0;
+    rx_buffs[uart].tail = 0;
+
+    if (MXC_UART_Init(cfg->regs, baud_rate, cfg->map) != E_NO_ERROR)
+    {
+        return HAL_UART_ERROR_CONFIG_ERROR;
+    }
+
+    // MXC_UART_Init() leaves the pins in the VDDIO domain, so set them up again in the one asked for, pulled up so a
+    // disconnected RX pin reads as idle
+    const mxc_gpio_cfg_t rx_tx_pins = {
+        .port = cfg->port,
+        .mask = cfg->rx_tx_mask,
+        .pad = MXC_GPIO_PAD_WEAK_PULL_UP,
+        .func = cfg->func,
+        .vssel = voltage == HAL_GPIO_VOLTAGE_VDDIOH ? MXC_GPIO_VSSEL_VDDIOH : MXC_GPIO_VSSEL_VDDIO,
+        .drvstr = MXC_GPIO_DRVSTR_0,
+    };
+
+    if (MXC_GPIO_Config(&rx_tx_pins) != E_NO_ERROR)
+    {
+        return HAL_UART_ERROR_CONFIG_ERROR;
+    }
+
+    // the FIFO only holds 8 bytes, under 10ms at 9600 baud, so every byte is moved into the buffer as it arrives
+    MXC_UART_SetRXThreshold(cfg->regs, 1);
+    MXC_UART_ClearFlags(cfg->regs, MXC_UART_GetFlags(cfg->regs));
+    MXC_UART_EnableInt(cfg->regs, MXC_F_UART_INT_EN_RX_FIFO_THRESH);
+    NVIC_ClearPendingIRQ(cfg->irq);
+    MXC_NVIC_SetVector(cfg->irq, cfg->irq_handler);
+    NVIC_EnableIRQ(cfg->irq);
+
+    return HAL_UART_ERROR_ALL_OK;
+}
+
+uint32_t hal_uart_read(Hal_UART_t uart, uint8_t *rx_buff, uint32_t max_len)
+{
+    RX_Buff_t *rx = &rx_buffs[uart];
+
+    const uint32_t head = __atomic_load_n(&rx->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = rx->tail;
+
+    uint32_t num_read = 0;
+    while (num_read < max_len && tail != head)
+    {
+        rx_buff[num_read++] = rx->buff[tail % RX_BUFF_LEN];
+        tail++;
+    }
+
+    __atomic_store_n(&rx->tail, tail, __ATOMIC_RELEASE);
+
+    return num_read;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void drain_rx_fifo(Hal_UART_t uart)
+{
+    mxc_uart_regs_t *regs = uart_configs[uart].regs;
+    RX_Buff_t *rx = &rx_buffs[uart];
+
+    MXC_UART_ClearFlags(regs, MXC_UART_GetFlags(regs));
+
+    const uint32_t tail = __atomic_load_n(&rx->tail, __ATOMIC_ACQUIRE);
+    uint32_t head = rx->head;
+
+    // a negative result is an error, which is also what we get once the FIFO is empty
+    int res;
+    while ((res = MXC_UART_ReadCharacterRaw(regs)) >= 0)
+    {
+        if (head - tail < RX_BUFF_LEN)
+        {
+            rx->buff[head % RX_BUFF_LEN] = (uint8_t)res;
+            head++;
+        }
+    }
+
+    __atomic_store_n(&rx->head, head, __ATOMIC_RELEASE);
+}
+
+void uart2_irq_handler(void)
+{
+    drain_rx_fifo(HAL_UART_2);
+}
@@ -0,0 +1,70 @@
+/**
+ * @file      hal_uart.h
+ * @brief     A thin hardware abstraction of the UARTs is represented here.
+ * @details   Only receiving is supported, which is all the GNSS module needs. The interrupt of the UART moves each
+ *            byte into a buffer of `HAL_UART_RX_BUFF_LEN_IN_BYTES` as it arrives, and the caller reads the buffer
+ *            whenever it likes, so a task only has to read before the buffer fills, about a quarter of a second at 9600
+ *            baud, rather than before the 8 byte receive FIFO of the MAX32666 does. `hal_uart.c` is the MSDK back-end,
+ *            `hal_uart_init()` puts the handler of the interrupt in the vector table rather than it defining the
+ *            `UARTn_IRQHandler()` of the UART. The host back-end in adc_dma_sd_card_write/test/host_sim reads from a
+ *            device model attached to the UART.
+ */
+
+#ifndef HAL_UART_H_
+#define HAL_UART_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include "hal_gpio.h"
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// the bytes a UART holds for `hal_uart_read()`, a power of 2, any that arrive while it is full are dropped
+#define HAL_UART_RX_BUFF_LEN_IN_BYTES (256)
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief UART errors are represented here
+ */
+typedef enum
+{
+    HAL_UART_ERROR_ALL_OK,
+    HAL_UART_ERROR_CONFIG_ERROR,
+} Hal_UART_Error_t;
+
+/**
+ * @brief The UARTs of the MAX32666 are represented here, only the ones we use are listed
+ */
+typedef enum
+{
+    HAL_UART_2 = 0, // the GNSS port, RX on P0.28 and TX on P0.29
+    HAL_UART_NUM_UARTS,
+} Hal_UART_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `hal_uart_init(u, b, v)` sets up UART `u` for 8-N-1 at `b` baud, with its pins taking their logic high from
+ * supply `v`.
+ *
+ * @post `u` is receiving, the bytes that arrive wait in its buffer for `hal_uart_read()`, anything received before is
+ * dropped.
+ *
+ * @retval `HAL_UART_ERROR_ALL_OK` if the operation succeeded, else an error code
+ */
+Hal_UART_Error_t hal_uart_init(Hal_UART_t uart, uint32_t baud_rate, Hal_GPIO_Voltage_t voltage);
+
+/**
+ * @brief `hal_uart_read(u, r, n)` moves up to `n` of the bytes UART `u` has received into `r`, oldest first, without
+ * waiting for more to arrive.
+ *
+ * @pre `u` is initialized.
+ *
+ * @retval the number of bytes read, 0 if nothing has arrived since the last read
+ */
+uint32_t hal_uart_read(Hal_UART_t uart, uint8_t *rx_buff, uint32_t max_len);
+
+#endif /* HAL_UART_H_ */
@@ -0,0 +1,186 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ima_adpcm.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define MAX_STEP_INDEX (88)
+
+// the sign bit of a 4 bit code, the other 3 bits are the size of the step in eighths of the step size
+#define CODE_SIGN_BIT (0x8)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the step sizes of the IMA ADPCM standard, growing by about 10% from one to the next
+static const int16_t step_sizes[MAX_STEP_INDEX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107,
+    118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+    6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767};
+
+// how far each code moves the step size index, small steps make the step size shrink and big ones make it grow
+static const int8_t step_index_adjustments[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+// the value the decoder predicts for the next sample, and the index of the step size it will use
+static int32_t predicted_sample;
+static int32_t step_index;
+
+// the block being filled when the samples run out, finished by the next call
+static uint8_t unfinished_block[IMA_ADPCM_BLOCK_LEN_IN_BYTES];
+static uint32_t num_samples_in_block;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `encode_into_block(b, s, n)` encodes the `n` samples in `s` into block `b`, after the
+ * `num_samples_in_block` samples already in it, starting the block with its header if it is empty.
+ *
+ * @pre `n` is at most the number of samples left in the block.
+ */
+static void encode_into_block(uint8_t *block, const int16_t *src, uint32_t num_samples);
+
+/**
+ * @brief `encode_sample(s)` is the 4 bit code of the step from the predicted sample towards sample `s`, and moves the
+ * prediction and the step size on the same way the decoder will.
+ */
+static inline uint8_t encode_sample(int32_t sample);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void ima_adpcm_reset()
+{
+    predicted_sample = 0;
+    step_index = 0;
+    num_samples_in_block = 0;
+}
+
+uint32_t ima_adpcm_encode(const int16_t *src, uint32_t num_samples, uint8_t *dest)
+{
+    uint32_t len_in_bytes = 0;
+
+    while (num_samples > 0)
+    {
+        const uint32_t samples_left_in_block = IMA_ADPCM_SAMPLES_PER_BLOCK - num_samples_in_block;
+        const uint32_t num_to_encode = num_samples < samples_left_in_block ? num_samples : samples_left_in_block;
+
+        // a whole block is encoded straight into the destination, one that's split between calls is put together aside
+        const bool is_whole_block = num_to_encode == IMA_ADPCM_SAMPLES_PER_BLOCK;
+        uint8_t *block = is_whole_block ? dest + len_in_bytes : unfinished_block;
+
+        encode_into_block(block, src, num_to_encode);
+        src += num_to_encode;
+        num_samples -= num_to_encode;
+
+        if (num_samples_in_block == IMA_ADPCM_SAMPLES_PER_BLOCK)
+        {
+            if (!is_whole_block)
+            {
+                memcpy(dest + len_in_bytes, unfinished_block, IMA_ADPCM_BLOCK_LEN_IN_BYTES);
+            }
+
+            len_in_bytes += IMA_ADPCM_BLOCK_LEN_IN_BYTES;
+            num_samples_in_block = 0;
+        }
+    }
+
+    return len_in_bytes;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void encode_into_block(uint8_t *block, const int16_t *src, uint32_t num_samples)
+{
+    uint32_t i = 0;
+
+    // the block header holds the first sample as is, so the decoder starts each block from the exact sample
+    if (num_samples_in_block == 0)
+    {
+        predicted_sample = src[0];
+
+        block[0] = (uint8_t)predicted_sample;
+        block[1] = (uint8_t)(predicted_sample >> 8);
+        block[2] = (uint8_t)step_index;
+        block[3] = 0;
+
+        num_samples_in_block = 1;
+        i = 1;
+    }
+
+    // the code of sample n of the block (counting from 1 after the header sample) goes in byte (n - 1) / 2 after the
+    // header, odd samples in the low nibble and even ones in the high nibble
+    uint8_t *codes = block + IMA_ADPCM_BLOCK_HEADER_LEN_IN_BYTES;
+
+    if (i < num_samples && (num_samples_in_block & 1) == 0)
+    {
+        codes[(num_samples_in_block - 1) / 2] |= (uint8_t)(encode_sample(src[i]) << 4);
+        num_samples_in_block += 1;
+        i += 1;
+    }
+
+    for (; i + 1 < num_samples; i += 2)
+    {
+        const uint8_t low = encode_sample(src[i]);
+        const uint8_t high = encode_sample(src[i + 1]);
+
+        codes[(num_samples_in_block - 1) / 2] = (uint8_t)(low | (high << 4));
+        num_samples_in_block += 2;
+    }
+
+    if (i < num_samples)
+    {
+        codes[(num_samples_in_block - 1) / 2] = encode_sample(src[i]);
+        num_samples_in_block += 1;
+    }
+}
+
+uint8_t encode_sample(int32_t sample)
+{
+    int32_t diff = sample - predicted_sample;
+    int32_t step = step_sizes[step_index];
+    uint8_t code = 0;
+
+    if (diff < 0)
+    {
+        code = CODE_SIGN_BIT;
+        diff = -diff;
+    }
+
+    // the decoder adds up step / 8 and the halved steps of the bits that are set, so we do exactly the same
+    int32_t delta = step >> 3;
+
+    if (diff >= step)
+    {
+        code |= 4;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+
+    if (diff >= step)
+    {
+        code |= 2;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+
+    if (diff >= step)
+    {
+        code |= 1;
+        delta += step;
+    }
+
+    predicted_sample += (code & CODE_SIGN_BIT) ? -delta : delta;
+    predicted_sample = predicted_sample > INT16_MAX ? INT16_MAX : predicted_sample < INT16_MIN ? INT16_MIN : predicted_sample;
+
+    step_index += step_index_adjustments[code & 0x7];
+    step_index = step_index > MAX_STEP_INDEX ? MAX_STEP_INDEX : step_index < 0 ? 0 : step_index;
+
+    return code;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file      ima_adpcm.h
+ * @brief     A software interface for encoding audio into 4 bit IMA ADPCM blocks is represented here.
+ * @details   Deployments that only need to tell whether a species called or not can trade fidelity for card space. IMA
+ *            (DVI) ADPCM stores each 16 bit sample as a 4 bit code for the step from a predicted value, with the step
+ *            size adapting to the signal, so files are a quarter the size of 16 bit WAVE files.
+ *
+ *            Samples are encoded into the blocks of the WAVE IMA ADPCM format (format tag 0x11), each block holds the
+ *            first sample as is and the step size index in a 4 byte header, followed by the codes of the rest of the
+ *            samples, two to a byte with the earlier sample in the low nibble. Every block restarts from its header,
+ *            so a damaged block doesn't spread into the next one.
+ *
+ *            The encoder is streaming, samples can be fed in any number at a time, e.g. a DMA block of audio, and only
+ *            whole blocks are output, with the samples of an unfinished block held until the next call.
+ *
+ *            This module does not touch any peripherals, so it can be unit tested and shared with host benchmarks.
+ */
+
+#ifndef IMA_ADPCM_H_
+#define IMA_ADPCM_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// the length of each block, the nBlockAlign of the WAVE file, one sector of the SD card
+#define IMA_ADPCM_BLOCK_LEN_IN_BYTES (512)
+
+// the first sample and the step size index at the start of each block
+#define IMA_ADPCM_BLOCK_HEADER_LEN_IN_BYTES (4)
+
+// the sample in the block header, plus two for each byte after it
+#define IMA_ADPCM_SAMPLES_PER_BLOCK ((2 * (IMA_ADPCM_BLOCK_LEN_IN_BYTES - IMA_ADPCM_BLOCK_HEADER_LEN_IN_BYTES)) + 1)
+
+// the most bytes `n` samples can be output as, when the samples of an unfinished block are waiting in the encoder
+#define IMA_ADPCM_MAX_ENCODED_LEN_IN_BYTES(n) ((((n) + IMA_ADPCM_SAMPLES_PER_BLOCK - 1) / IMA_ADPCM_SAMPLES_PER_BLOCK) * IMA_ADPCM_BLOCK_LEN_IN_BYTES)
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `ima_adpcm_reset()` drops any samples waiting for the rest of their block and resets the step size, ready
+ * for a new recording.
+ *
+ * @post the next sample passed to `ima_adpcm_encode()` starts a new block.
+ */
+void ima_adpcm_reset();
+
+/**
+ * @brief `ima_adpcm_encode(s, n, d)` encodes `n` samples from `s` after the ones from earlier calls, stores each block
+ * that is finished in `d`, and is the number of bytes stored.
+ *
+ * @param src the 16 bit samples to encode
+ *
+ * @param num_samples the number of samples in `src`, any number
+ *
+ * @param dest the destination for the finished blocks, must be at least `IMA_ADPCM_MAX_ENCODED_LEN_IN_BYTES(n)` long
+ * and must not overlap `s`
+ *
+ * @post the finished blocks are stored in `d`, and the samples of the last block, if it isn't finished, are held for
+ * the next call.
+ *
+ * @retval the number of bytes stored in `d`, a multiple of `IMA_ADPCM_BLOCK_LEN_IN_BYTES`
+ */
+uint32_t ima_adpcm_encode(const int16_t *src, uint32_t num_samples, uint8_t *dest);
+
+#endif /* IMA_ADPCM_H_ */
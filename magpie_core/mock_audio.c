@@ -6,6 +6,7 @@
 
 /* Private includes --------------------------------------------------------------------------------------------------*/
 
+#include "mock_audio.h"
 #include <math.h>
 #include <stdint.h>
 
@@ -24,12 +25,10 @@
 
 static int16_t sine_lut[SINE_LUT_SIZE];
 
-static uint32_t phase_accumulator_A;
-static uint32_t phase_accumulator_B;
+static uint32_t phase_accumulator[MOCK_AUDIO_NUM_CHANNELS];
 
 static uint32_t sample_rate;
-static uint32_t accum_increment_A;
-static uint32_t accum_increment_B;
+static uint32_t accum_increment[MOCK_AUDIO_NUM_CHANNELS];
 
 /* Public function definitions ---------------------------------------------------------------------------------------*/
 
@@ -41,6 +40,11 @@ void mock_audio_sine_init()
         const int16_t int_sin = (int16_t)(fl_sin * SINE_LUT_MAX_VAL);
         sine_lut[i] = int_sin;
     }
+
+    for (uint32_t ch = 0; ch < MOCK_AUDIO_NUM_CHANNELS; ch++)
+    {
+        phase_accumulator[ch] = 0;
+    }
 }
 
 void mock_audio_set_sample_rate(uint32_t sr_Hz)
@@ -48,32 +52,32 @@ void mock_audio_set_sample_rate(uint32_t sr_Hz)
     sample_rate = sr_Hz;
 }
 
-void mock_audio_set_sine_freq_A(uint32_t freq_Hz)
+void mock_audio_set_sine_freq(Mock_Audio_Channel_t channel, uint32_t freq_Hz)
 {
     // note that depending on how we order these ops, we might overflow a u32, that's why the divide happens first
-    accum_increment_A = (PHASE_ACCUM_2_TO_THE_N / sample_rate) * freq_Hz;
+    accum_increment[channel] = (PHASE_ACCUM_2_TO_THE_N / sample_rate) * freq_Hz;
 }
 
-void mock_audio_set_sine_freq_B(uint32_t freq_Hz)
+int16_t mock_audio_sine_tick(Mock_Audio_Channel_t channel)
 {
-    // note that depending on how we order these ops, we might overflow a u32, that's why the divide happens first
-    accum_increment_B = (PHASE_ACCUM_2_TO_THE_N / sample_rate) * freq_Hz;
-}
+    phase_accumulator[channel] += accum_increment[channel];
+    phase_accumulator[channel] &= (PHASE_ACCUM_2_TO_THE_N - 1);
 
-int16_t mock_audio_sine_tick_A()
-{
-    phase_accumulator_A += accum_increment_A;
-    phase_accumulator_A &= (PHASE_ACCUM_2_TO_THE_N - 1);
-
-    const uint32_t lut_idx = phase_accumulator_A >> (PHASE_ACCUM_NUM_BITS - SINE_LUT_NUM_INDEX_BITS);
+    const uint32_t lut_idx = phase_accumulator[channel] >> (PHASE_ACCUM_NUM_BITS - SINE_LUT_NUM_INDEX_BITS);
     return sine_lut[lut_idx];
 }
 
-int16_t mock_audio_sine_tick_B()
+void mock_audio_sine_fill(Mock_Audio_Channel_t channel, int16_t *buff, uint32_t num_samps, uint32_t stride)
 {
-    phase_accumulator_B += accum_increment_B;
-    phase_accumulator_B &= (PHASE_ACCUM_2_TO_THE_N - 1);
+    // local copies so the compiler can keep them in registers, the static ones could alias the buffer
+    uint32_t phase = phase_accumulator[channel];
+    const uint32_t increment = accum_increment[channel];
 
-    const uint32_t lut_idx = phase_accumulator_B >> (PHASE_ACCUM_NUM_BITS - SINE_LUT_NUM_INDEX_BITS);
-    return sine_lut[lut_idx];
+    for (uint32_t i = 0; i < num_samps; i++)
+    {
+        phase = (phase + increment) & (PHASE_ACCUM_2_TO_THE_N - 1);
+        buff[i * stride] = sine_lut[phase >> (PHASE_ACCUM_NUM_BITS - SINE_LUT_NUM_INDEX_BITS)];
+    }
+
+    phase_accumulator[channel] = phase;
 }
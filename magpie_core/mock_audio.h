@@ -0,0 +1,82 @@
+/**
+ * @file    mock_audio.h
+ * @brief   A simple and naive sine wave generator for creating mock audio is represented here.
+ * @details This is a "cheap and cheerful" module. No attempts are made at generating a perfect sine, just something
+ * good enough to use for mock SD card writes for testing. The idea is to write a sine wave of a chosen sample rate and
+ * frequency to the SD card so we can validate that the audio on the card matches our intention.
+ * Each channel has its own sine wave generator, so channels can be told apart in the file, but they all share the same
+ * sample rate.
+ */
+
+#ifndef MOCK_AUDIO_H_
+#define MOCK_AUDIO_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Enumerated sine wave generators are represented here, one per channel of mock audio.
+ */
+typedef enum
+{
+    MOCK_AUDIO_CHANNEL_A = 0,
+    MOCK_AUDIO_CHANNEL_B,
+    MOCK_AUDIO_NUM_CHANNELS,
+} Mock_Audio_Channel_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `mock_audio_sine_init()` initializes the internal sine wave generators.
+ *
+ * @post the sine generators are ready to be used, each starting at phase 0.
+ */
+void mock_audio_sine_init();
+
+/**
+ * @brief `mock_audio_set_sample_rate(sr)` sets the sample rate used by the sine generators. The sample rate is shared
+ * between all the sine wave generators.
+ *
+ * @param sr_Hz The sample rate to use, in Hertz.
+ */
+void mock_audio_set_sample_rate(uint32_t sr_Hz);
+
+/**
+ * @brief `mock_audio_set_sine_freq(c, f)` sets the frequency of the sine generator of channel `c` to `f` Hertz.
+ *
+ * @pre `mock_audio_set_sample_rate()` has been called.
+ *
+ * @param freq_Hz the frequency of the sine wave generated by future calls to tick or fill. Note that if the frequency
+ * meets or exceeds the configured (sample rate / 2), aliasing will occur.
+ */
+void mock_audio_set_sine_freq(Mock_Audio_Channel_t channel, uint32_t freq_Hz);
+
+/**
+ * @brief `mock_audio_sine_tick(c)` ticks the sine wave of channel `c` one sample forward and returns the current sample.
+ *
+ * @pre `mock_audio_sine_init()` has been called.
+ *
+ * @post the sine generator is advanced by one tick given by the currently set sample rate and frequency.
+ *
+ * @return the current value of the sine generator.
+ */
+int16_t mock_audio_sine_tick(Mock_Audio_Channel_t channel);
+
+/**
+ * @brief `mock_audio_sine_fill(c, b, n, s)` ticks the sine wave of channel `c` forward `n` samples, and stores them in
+ * every `s`th element of `b`, starting with the first. This gives the same samples as `n` calls to
+ * `mock_audio_sine_tick(c)`, but keeps the phase in a register for the whole buffer.
+ *
+ * @pre `mock_audio_sine_init()` has been called, `b` is at least `((n - 1) * s) + 1` samples long.
+ *
+ * @param stride the distance between consecutive samples in `b`, 1 for mono audio, or the number of channels to fill
+ * one channel of interleaved audio, with `b` pointing at the first sample of that channel.
+ *
+ * @post the sine generator is advanced by `n` ticks, the other elements of `b` are left as they were.
+ */
+void mock_audio_sine_fill(Mock_Audio_Channel_t channel, int16_t *buff, uint32_t num_samps, uint32_t stride);
+
+#endif /* MOCK_AUDIO_H_ */
@@ -0,0 +1,337 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "scheduler.h"
+
+#include <stddef.h> // for NULL
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A task is represented here, `pending` and `num_posts` are written from any context, the rest only from the
+ * main loop.
+ */
+typedef struct
+{
+    Scheduler_Task_Handler_t handler;
+    Scheduler_Events_t pending;
+
+    // the number of posts the task hasn't run for yet, it runs once for each
+    uint32_t num_posts;
+
+    // when the oldest of the posts waiting was made, or when the last run started if that was later
+    uint32_t first_post_millisecs;
+    uint32_t max_latency_millisecs;
+} Task_t;
+
+/**
+ * @brief A software timer is represented here, it is only touched from the main loop.
+ */
+typedef struct
+{
+    Scheduler_Task_t task;
+    Scheduler_Events_t events;
+    bool is_running;
+    uint32_t due_millisecs;
+
+    // 0 for a one shot timer
+    uint32_t period_millisecs;
+} Timer_t;
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static Task_t tasks[SCHEDULER_MAX_NUM_TASKS];
+static uint32_t num_tasks = 0;
+
+// the indices of the tasks from the most urgent to the least, tasks of equal priority in the order they were added
+static Scheduler_Task_t dispatch_order[SCHEDULER_MAX_NUM_TASKS];
+static Scheduler_Priority_t task_priorities[SCHEDULER_MAX_NUM_TASKS];
+
+static Timer_t timers[SCHEDULER_MAX_NUM_TIMERS];
+static uint32_t num_timers = 0;
+
+// moved on by the tick interrupt
+static uint32_t now_millisecs = 0;
+
+static bool is_stop_requested = false;
+
+static Scheduler_Idle_Hook_t idle_hook = NULL;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `post_expired_timers(n)` posts the events of every running timer that is due at time `n`, and restarts the
+ * periodic ones.
+ */
+static void post_expired_timers(uint32_t now);
+
+/**
+ * @brief `is_due(d, n)` is true if time `d` is not after time `n`, across the wrap of the clock.
+ */
+static bool is_due(uint32_t due, uint32_t now);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+Scheduler_Error_t scheduler_add_task(Scheduler_Task_Handler_t handler, Scheduler_Priority_t priority, Scheduler_Task_t *task)
+{
+    if (handler == NULL || task == NULL)
+    {
+        return SCHEDULER_ERROR_INVALID_ARG;
+    }
+
+    if (num_tasks == SCHEDULER_MAX_NUM_TASKS)
+    {
+        return SCHEDULER_ERROR_TOO_MANY_TASKS;
+    }
+
+    const Scheduler_Task_t new_task = num_tasks;
+    tasks[new_task] = (Task_t){.handler = handler};
+    task_priorities[new_task] = priority;
+
+    // insert it behind every task at least as urgent
+    uint32_t pos = num_tasks;
+    while (pos > 0 && task_priorities[dispatch_order[pos - 1]] > priority)
+    {
+        dispatch_order[pos] = dispatch_order[pos - 1];
+        pos--;
+    }
+    dispatch_order[pos] = new_task;
+
+    num_tasks += 1;
+    *task = new_task;
+
+    return SCHEDULER_ERROR_ALL_OK;
+}
+
+Scheduler_Error_t scheduler_add_timer(Scheduler_Task_t task, Scheduler_Events_t events, Scheduler_Timer_t *timer)
+{
+    if (task >= num_tasks || events == 0 || timer == NULL)
+    {
+        return SCHEDULER_ERROR_INVALID_ARG;
+    }
+
+    if (num_timers == SCHEDULER_MAX_NUM_TIMERS)
+    {
+        return SCHEDULER_ERROR_TOO_MANY_TIMERS;
+    }
+
+    timers[num_timers] = (Timer_t){.task = task, .events = events};
+    *timer = num_timers;
+    num_timers += 1;
+
+    return SCHEDULER_ERROR_ALL_OK;
+}
+
+void scheduler_timer_start(Scheduler_Timer_t timer, uint32_t delay_millisecs, uint32_t period_millisecs)
+{
+    if (timer >= num_timers)
+    {
+        return;
+    }
+
+    timers[timer].due_millisecs = scheduler_get_millisecs() + delay_millisecs;
+    timers[timer].period_millisecs = period_millisecs;
+    timers[timer].is_running = true;
+}
+
+void scheduler_timer_stop(Scheduler_Timer_t timer)
+{
+    if (timer >= num_timers)
+    {
+        return;
+    }
+
+    timers[timer].is_running = false;
+}
+
+void scheduler_post(Scheduler_Task_t task, Scheduler_Events_t events)
+{
+    if (task >= num_tasks || events == 0)
+    {
+        return;
+    }
+
+    const uint32_t now = scheduler_get_millisecs();
+
+    // the events go in before the post is counted, so a run the count lets through never misses the events of its post.
+    // A run that slips in between the two lines takes the events early, and the run for the count gets none
+    __atomic_fetch_or(&tasks[task].pending, events, __ATOMIC_ACQ_REL);
+
+    // only the first post waiting counts for the latency
+    if (__atomic_fetch_add(&tasks[task].num_posts, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        tasks[task].first_post_millisecs = now;
+    }
+}
+
+void scheduler_tick(uint32_t millisecs)
+{
+    __atomic_add_fetch(&now_millisecs, millisecs, __ATOMIC_RELAXED);
+}
+
+uint32_t scheduler_get_millisecs()
+{
+    return __atomic_load_n(&now_millisecs, __ATOMIC_RELAXED);
+}
+
+uint32_t scheduler_get_millisecs_to_next_timer()
+{
+    const uint32_t now = scheduler_get_millisecs();
+    uint32_t millisecs_to_next = UINT32_MAX;
+
+    for (uint32_t i = 0; i < num_timers; i++)
+    {
+        if (!timers[i].is_running)
+        {
+            continue;
+        }
+
+        if (is_due(timers[i].due_millisecs, now))
+        {
+            return 0;
+        }
+
+        const uint32_t millisecs_to_due = timers[i].due_millisecs - now;
+        millisecs_to_next = millisecs_to_due < millisecs_to_next ? millisecs_to_due : millisecs_to_next;
+    }
+
+    return millisecs_to_next;
+}
+
+bool scheduler_run_once()
+{
+    const uint32_t now = scheduler_get_millisecs();
+
+    post_expired_timers(now);
+
+    for (uint32_t i = 0; i < num_tasks; i++)
+    {
+        Task_t *task = &tasks[dispatch_order[i]];
+
+        if (__atomic_load_n(&task->num_posts, __ATOMIC_ACQUIRE) == 0)
+        {
+            continue;
+        }
+
+        const uint32_t latency = now - task->first_post_millisecs;
+        task->max_latency_millisecs = latency > task->max_latency_millisecs ? latency : task->max_latency_millisecs;
+
+        const Scheduler_Events_t events = __atomic_exchange_n(&task->pending, 0, __ATOMIC_ACQ_REL);
+
+        // the posts still waiting have waited at least since now, the next post counts from when it is made
+        if (__atomic_sub_fetch(&task->num_posts, 1, __ATOMIC_ACQ_REL) > 0)
+        {
+            task->first_post_millisecs = now;
+        }
+
+        // events posted while the handler runs wait for its next run
+        task->handler(events);
+        return true;
+    }
+
+    return false;
+}
+
+void scheduler_run()
+{
+    __atomic_store_n(&is_stop_requested, false, __ATOMIC_RELEASE);
+
+    while (!__atomic_load_n(&is_stop_requested, __ATOMIC_ACQUIRE))
+    {
+        if (!scheduler_run_once() && idle_hook != NULL)
+        {
+            idle_hook();
+        }
+    }
+}
+
+void scheduler_stop()
+{
+    __atomic_store_n(&is_stop_requested, true, __ATOMIC_RELEASE);
+}
+
+bool scheduler_is_idle()
+{
+    const uint32_t now = scheduler_get_millisecs();
+
+    for (uint32_t i = 0; i < num_tasks; i++)
+    {
+        if (__atomic_load_n(&tasks[i].num_posts, __ATOMIC_ACQUIRE) != 0)
+        {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < num_timers; i++)
+    {
+        if (timers[i].is_running && is_due(timers[i].due_millisecs, now))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void scheduler_set_idle_hook(Scheduler_Idle_Hook_t hook)
+{
+    idle_hook = hook;
+}
+
+uint32_t scheduler_get_max_latency_millisecs(Scheduler_Task_t task)
+{
+    return task < num_tasks ? tasks[task].max_latency_millisecs : 0;
+}
+
+void scheduler_reset_stats()
+{
+    for (uint32_t i = 0; i < num_tasks; i++)
+    {
+        tasks[i].max_latency_millisecs = 0;
+    }
+}
+
+void scheduler_reset()
+{
+    num_tasks = 0;
+    num_timers = 0;
+    idle_hook = NULL;
+    __atomic_store_n(&now_millisecs, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&is_stop_requested, false, __ATOMIC_RELEASE);
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+void post_expired_timers(uint32_t now)
+{
+    for (uint32_t i = 0; i < num_timers; i++)
+    {
+        Timer_t *timer = &timers[i];
+
+        if (!timer->is_running || !is_due(timer->due_millisecs, now))
+        {
+            continue;
+        }
+
+        scheduler_post(timer->task, timer->events);
+
+        if (timer->period_millisecs == 0)
+        {
+            timer->is_running = false;
+            continue;
+        }
+
+        // periodic timers keep to their period without drifting, but a timer that fell behind by more than a period
+        // posts once rather than once for every period it missed
+        timer->due_millisecs += timer->period_millisecs;
+        if (is_due(timer->due_millisecs, now))
+        {
+            timer->due_millisecs = now + timer->period_millisecs;
+        }
+    }
+}
+
+bool is_due(uint32_t due, uint32_t now)
+{
+    return (int32_t)(now - due) >= 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file      scheduler.h
+ * @brief     A cooperative run-to-completion task scheduler with software timers is represented here.
+ * @details   Each task is a handler that runs to completion each time it is dispatched, and is dispatched once for
+ *            every post made to it. Interrupts and the software interrupt post events to tasks rather than doing the
+ *            work themselves, and the main loop only runs `scheduler_run()`, so recording, GNSS parsing, gain control,
+ *            and housekeeping interleave with a latency bounded by the longest handler instead of waiting on each
+ *            other's busy loops.
+ *
+ *            Posts are counted rather than queued, so a task posted N times before it gets to run runs N times, and an
+ *            interrupt that posts once per unit of work, such as a DMA block, gets one run per unit even when the main
+ *            loop falls behind. The events of the posts are OR-ed together, each run is handed the events posted since
+ *            the last run, so the runs after the first of a backlog may be handed none.
+ *
+ *            Tasks run in priority order, the most urgent task with posts waiting is always dispatched next. Tasks of
+ *            equal priority run in the order they were added.
+ *
+ *            Software timers post events to a task when they expire, they count the milliseconds passed to
+ *            `scheduler_tick()`, which the snippet calls from a periodic timer interrupt, see `hal_timer.h`. While the
+ *            core sleeps the tick only has to come when the next timer is due, see
+ *            `scheduler_get_millisecs_to_next_timer()`.
+ *
+ *            There is no allocation, the tasks and timers live in fixed tables sized by `SCHEDULER_MAX_NUM_TASKS` and
+ *            `SCHEDULER_MAX_NUM_TIMERS`. The scheduler is plain C with the GCC atomic builtins, so it runs the same on
+ *            the MAX32666 and on the host.
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+#define SCHEDULER_MAX_NUM_TASKS (8)
+
+#define SCHEDULER_MAX_NUM_TIMERS (8)
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Scheduler errors are represented here
+ */
+typedef enum
+{
+    SCHEDULER_ERROR_ALL_OK,
+    SCHEDULER_ERROR_TOO_MANY_TASKS,
+    SCHEDULER_ERROR_TOO_MANY_TIMERS,
+    SCHEDULER_ERROR_INVALID_ARG,
+} Scheduler_Error_t;
+
+/**
+ * @brief Task priorities are represented here, from the most urgent to the least
+ */
+typedef enum
+{
+    SCHEDULER_PRIORITY_HIGH,
+    SCHEDULER_PRIORITY_NORMAL,
+    SCHEDULER_PRIORITY_LOW,
+} Scheduler_Priority_t;
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The events of a task are represented here, one bit per event, the meaning of each bit is up to the task.
+ */
+typedef uint32_t Scheduler_Events_t;
+
+/**
+ * @brief A task is represented here by its handle, as given by `scheduler_add_task()`.
+ */
+typedef uint32_t Scheduler_Task_t;
+
+/**
+ * @brief A software timer is represented here by its handle, as given by `scheduler_add_timer()`.
+ */
+typedef uint32_t Scheduler_Timer_t;
+
+/**
+ * @brief The handler of a task is represented here, it is passed every event posted to the task since it last ran,
+ * which is 0 if the run is for a post whose events an earlier run already took.
+ */
+typedef void (*Scheduler_Task_Handler_t)(Scheduler_Events_t events);
+
+/**
+ * @brief A function the scheduler calls each time it finds nothing to run is represented here.
+ */
+typedef void (*Scheduler_Idle_Hook_t)();
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `scheduler_add_task(f, p, t)` adds a task with handler `f` and priority `p`, and stores its handle in `t`.
+ *
+ * @pre called from the main loop, before any interrupt posts to the task.
+ *
+ * @retval `SCHEDULER_ERROR_ALL_OK` if the task was added, else an error code
+ */
+Scheduler_Error_t scheduler_add_task(Scheduler_Task_Handler_t handler, Scheduler_Priority_t priority, Scheduler_Task_t *task);
+
+/**
+ * @brief `scheduler_add_timer(t, e, h)` adds a stopped timer which posts events `e` to task `t` when it expires, and
+ * stores its handle in `h`.
+ *
+ * @pre called from the main loop.
+ *
+ * @retval `SCHEDULER_ERROR_ALL_OK` if the timer was added, else an error code
+ */
+Scheduler_Error_t scheduler_add_timer(Scheduler_Task_t task, Scheduler_Events_t events, Scheduler_Timer_t *timer);
+
+/**
+ * @brief `scheduler_timer_start(h, d, p)` starts timer `h` to expire `d` milliseconds from now, and then every `p`
+ * milliseconds, or only once if `p` is 0. A timer that is already running is restarted.
+ *
+ * @pre called from the main loop or a task.
+ */
+void scheduler_timer_start(Scheduler_Timer_t timer, uint32_t delay_millisecs, uint32_t period_millisecs);
+
+/**
+ * @brief `scheduler_timer_stop(h)` stops timer `h`, it does not post again until it is restarted.
+ *
+ * @pre called from the main loop or a task.
+ */
+void scheduler_timer_stop(Scheduler_Timer_t timer);
+
+/**
+ * @brief `scheduler_post(t, e)` posts events `e` to task `t`, it can be called from any context. The task runs once for
+ * every post, events posted before a run are merged and handed to it.
+ */
+void scheduler_post(Scheduler_Task_t task, Scheduler_Events_t events);
+
+/**
+ * @brief `scheduler_tick(n)` moves the clock of the timers on by `n` milliseconds, it can be called from any context
+ * and is usually called from a periodic timer interrupt.
+ */
+void scheduler_tick(uint32_t millisecs);
+
+/**
+ * @brief `scheduler_get_millisecs()` is the number of milliseconds passed to `scheduler_tick()` so far, it wraps
+ * around after about 49 days.
+ */
+uint32_t scheduler_get_millisecs();
+
+/**
+ * @brief `scheduler_get_millisecs_to_next_timer()` is the number of milliseconds until the next running timer is due,
+ * 0 if one is due now, or `UINT32_MAX` if no timer is running. An idle hook can hold off the tick for that long, see
+ * `hal_timer_suppress_tick()`, a timer started by a task is only started after the core has woken up anyway.
+ */
+uint32_t scheduler_get_millisecs_to_next_timer();
+
+/**
+ * @brief `scheduler_run_once()` posts the events of the timers that have expired, then runs the most urgent task with
+ * posts waiting, once, if there is one.
+ *
+ * @pre called from the main loop, never from a task.
+ *
+ * @retval true if a task ran, false if there was nothing to run
+ */
+bool scheduler_run_once();
+
+/**
+ * @brief `scheduler_run()` runs tasks until `scheduler_stop()` is called, calling the idle hook each time there is
+ * nothing to run.
+ *
+ * @pre called from the main loop, never from a task.
+ */
+void scheduler_run();
+
+/**
+ * @brief `scheduler_stop()` makes `scheduler_run()` return once the task running now, if any, returns. It can be
+ * called from any context.
+ */
+void scheduler_stop();
+
+/**
+ * @brief `scheduler_is_idle()` is true if no task has posts waiting and no running timer is due, so there is nothing
+ * for `scheduler_run_once()` to do until an interrupt posts an event or moves the clock on. An idle hook that sleeps
+ * checks it with interrupts masked, so an event posted after the last dispatch can't be slept through, see
+ * `hal_sleep.h`.
+ */
+bool scheduler_is_idle();
+
+/**
+ * @brief `scheduler_set_idle_hook(f)` sets `f` to be called by `scheduler_run()` each time there is nothing to run, or
+ * NULL to spin instead, which is the default.
+ */
+void scheduler_set_idle_hook(Scheduler_Idle_Hook_t hook);
+
+/**
+ * @brief `scheduler_get_max_latency_millisecs(t)` is the longest task `t` has waited to run since it was added or the
+ * stats were reset, from a post to the start of the run for it, to within a tick. A post made while the task was
+ * already waiting counts from the start of the run before its own.
+ */
+uint32_t scheduler_get_max_latency_millisecs(Scheduler_Task_t task);
+
+/**
+ * @brief `scheduler_reset_stats()` forgets the latencies of every task.
+ */
+void scheduler_reset_stats();
+
+/**
+ * @brief `scheduler_reset()` forgets every task and timer, drops any pending events, and sets the clock back to 0.
+ *
+ * @pre no interrupt posts to a task.
+ */
+void scheduler_reset();
+
+#endif /* SCHEDULER_H_ */
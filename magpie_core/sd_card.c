@@ -0,0 +1,582 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "diskio.h"
+#include "hal_gpio.h"
+#include "hal_sdhc.h"
+#include "hal_timer.h"
+#include "sd_card.h"
+#include "write_coalescer.h"
+#include <stddef.h> // for NULL
+#include <string.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define SD_CARD_INIT_NUM_RETRIES (100)
+
+// sectors are the unit of raw writes to the card
+#define SECTOR_LEN_IN_BYTES (512)
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static FATFS *fs; // FFat Filesystem Object
+static FATFS fs_obj;
+static FIL SD_file; // FFat File Object
+static DIR SD_dir;  // FFat Directory Object
+static FILINFO SD_dir_entry;
+static FILINFO SD_file_info;
+static bool is_mounted;
+
+static char volume = '0';
+
+// true while the open file is pre-allocated and written in streaming mode
+static bool is_streaming = false;
+
+// the first sector of the contiguous pre-allocated range, and its length in bytes
+static LBA_t stream_start_sector;
+static uint64_t stream_alloc_len;
+
+// in streaming mode we track the file position and length ourselves, FatFS only knows about the writes it does
+static uint64_t stream_pos;
+static uint64_t stream_len;
+
+// the free space on the mounted card, counted at mount and kept up to date as the open file grows and shrinks
+static uint64_t free_bytes;
+
+// the space the open file takes on the card, a whole number of clusters
+static uint64_t open_file_alloc_len;
+
+// writes are gathered into clusters, but no longer than this, 0 for no coalescing
+static uint32_t max_write_unit_len = 0;
+
+// the write unit of the open file
+static uint32_t write_unit_len;
+
+// the log file can be open alongside the open file, with the space it takes on the card
+static FIL log_file;
+static bool is_log_open = false;
+static uint64_t log_file_alloc_len;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `stream_write_through_fatfs(b, s, w)` writes `s` bytes of `b` at the stream position with an ordinary FatFS
+ * write, and stores the number of bytes written in `w`. Used for partial sectors and writes past the pre-allocation.
+ */
+static SD_Card_Error_t stream_write_through_fatfs(const uint8_t *buff, uint32_t size, uint32_t *written);
+
+/**
+ * @brief `stream_write(b, s, w)` writes `s` bytes of `b` at the stream position, sending whole sectors straight to the
+ * pre-allocated range on the card, and stores the number of bytes written in `w`.
+ */
+static SD_Card_Error_t stream_write(const uint8_t *buff, uint32_t size, uint32_t *written);
+
+/**
+ * @brief `write_to_card(b, l)` writes `l` bytes of `b` at the file position, whichever way the open file is written,
+ * and is true iff they were all written. This is the write function of the write coalescer.
+ */
+static bool write_to_card(const uint8_t *buff, uint32_t len);
+
+/**
+ * @brief `mount()` mounts the SD card without counting its free space.
+ */
+static SD_Card_Error_t mount();
+
+/**
+ * @brief `cluster_len()` is the length of a cluster of the mounted card in bytes.
+ */
+static uint64_t cluster_len();
+
+/**
+ * @brief `alloc_len(l)` is the space a file of `l` bytes takes on the mounted card, a whole number of clusters.
+ */
+static uint64_t alloc_len(uint64_t file_len);
+
+/**
+ * @brief `account_for_open_file_len(l)` updates the free space for the open file now being `l` bytes long.
+ */
+static void account_for_open_file_len(uint64_t file_len);
+
+/**
+ * @brief `account_for_file_growth(a, l)` updates the free space for a file taking `a` bytes on the card now being `l`
+ * bytes long, and stores the space it takes now in `a`.
+ */
+static void account_for_file_growth(uint64_t *file_alloc_len, uint64_t file_len);
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+SD_Card_Error_t sd_card_init()
+{
+    // needed for FTHR2
+    const Hal_GPIO_Pin_t sd_card_en_pin = {
+        .port = HAL_GPIO_PORT_1,
+        .mask = HAL_GPIO_PIN(6),
+        .func = HAL_GPIO_FUNC_OUT,
+        .voltage = HAL_GPIO_VOLTAGE_VDDIOH,
+        .drive_strength = HAL_GPIO_DRIVE_STRENGTH_0,
+    };
+    hal_gpio_config(&sd_card_en_pin);
+    hal_gpio_write(&sd_card_en_pin, false);
+
+    if (hal_sdhc_init() != HAL_SDHC_ERROR_ALL_OK)
+    {
+        return SD_CARD_INIT_ERROR;
+    }
+
+    // needed for FTHR2
+    hal_gpio_config(&sd_card_en_pin);
+    hal_gpio_write(&sd_card_en_pin, false);
+
+    // without a delay here the next function was consistently returning an error
+    hal_timer_delay_microsecs(10000);
+
+    if (hal_sdhc_init_card(SD_CARD_INIT_NUM_RETRIES) != HAL_SDHC_ERROR_ALL_OK)
+    {
+        return SD_CARD_INIT_ERROR;
+    }
+
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_mount()
+{
+    if (mount() != SD_CARD_ERROR_ALL_OK)
+    {
+        return SD_CARD_MOUNT_ERROR;
+    }
+
+    // from elm-chan: http://elm-chan.org/fsw/ff/doc/getfree.html, FatFS counts the free clusters by scanning the FAT,
+    // unless the FAT32 FSInfo sector holds a valid count, so this is the only time we ask for it
+    DWORD free_clusters;
+    if (f_getfree(&volume, &free_clusters, &fs) != FR_OK)
+    {
+        sd_card_unmount();
+        return SD_CARD_MOUNT_ERROR;
+    }
+
+    free_bytes = (uint64_t)free_clusters * cluster_len();
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_mount_with_free_space(uint64_t free_space_in_bytes)
+{
+    if (mount() != SD_CARD_ERROR_ALL_OK)
+    {
+        return SD_CARD_MOUNT_ERROR;
+    }
+
+    free_bytes = free_space_in_bytes;
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_unmount()
+{
+    if (is_log_open)
+    {
+        sd_card_log_close();
+    }
+
+    is_mounted = false;
+    return f_mount(0, "", 0);
+}
+
+bool sd_card_is_mounted()
+{
+    return is_mounted;
+}
+
+uint64_t sd_card_disk_size_bytes()
+{
+    if (!sd_card_is_mounted())
+    {
+        return 0;
+    }
+
+    // from elm-chan: http://elm-chan.org/fsw/ff/doc/getfree.html
+    return (uint64_t)(fs->n_fatent - 2) * cluster_len();
+}
+
+uint64_t sd_card_free_space_bytes()
+{
+    return sd_card_is_mounted() ? free_bytes : 0;
+}
+
+void sd_card_set_write_unit(uint32_t max_len_in_bytes)
+{
+    max_write_unit_len = max_len_in_bytes;
+}
+
+SD_Card_Error_t sd_card_mkdir(const char *path)
+{
+    if (f_mkdir(path) != FR_OK)
+    {
+        return SD_CARD_DIRECTORY_ERROR;
+    }
+
+    // a new directory gets one cluster for its entries
+    free_bytes -= free_bytes > cluster_len() ? cluster_len() : free_bytes;
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_cd(const char *path)
+{
+    return f_chdir(path) == FR_OK ? SD_CARD_ERROR_ALL_OK : SD_CARD_DIRECTORY_ERROR;
+}
+
+SD_Card_Error_t sd_card_fopen(const char *file_name, POSIX_FileMode_t mode)
+{
+    is_streaming = false;
+
+    // opening a file for writing empties it, so the space it took is given back once it's open
+    const bool is_emptied = (mode & FA_CREATE_ALWAYS) && f_stat(file_name, &SD_file_info) == FR_OK;
+
+    if (f_open(&SD_file, file_name, mode) != FR_OK)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    open_file_alloc_len = is_emptied ? alloc_len(SD_file_info.fsize) : alloc_len(f_size(&SD_file));
+    account_for_open_file_len(f_size(&SD_file));
+
+    // the card erases and programs its flash a cluster at a time or more, so a cluster is the smallest write worth
+    // sending, within the coalescing buffer
+    write_unit_len = cluster_len() < max_write_unit_len ? (uint32_t)cluster_len() : max_write_unit_len;
+    write_coalescer_start(write_to_card, write_unit_len, f_tell(&SD_file));
+
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_fpreallocate(uint64_t size)
+{
+#if FF_USE_EXPAND
+    if (f_size(&SD_file) != 0 || write_coalescer_num_buffered() != 0 || size == 0)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    // FAT32 files can't reach 4GiB, only exFAT has 64 bit file sizes
+    if (size > (FSIZE_t)-1)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    // allocate now (opt = 1), and only if it can be done with one contiguous run of clusters
+    if (f_expand(&SD_file, (FSIZE_t)size, 1) != FR_OK)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    // a contiguous file starts at the first sector of its first cluster, see clst2sect() in ff.c
+    const FATFS *file_fs = SD_file.obj.fs;
+    stream_start_sector = file_fs->database + ((LBA_t)file_fs->csize * (SD_file.obj.sclust - 2));
+    stream_alloc_len = size;
+    stream_pos = 0;
+    stream_len = 0;
+    is_streaming = true;
+    account_for_open_file_len(size);
+
+    return SD_CARD_ERROR_ALL_OK;
+#else
+    (void)size;
+    return SD_CARD_FILE_IO_ERROR;
+#endif
+}
+
+SD_Card_Error_t sd_card_fclose()
+{
+    // the file is closed even if the last of it couldn't be written
+    const bool is_flushed = write_coalescer_flush();
+
+    if (is_streaming)
+    {
+        is_streaming = false;
+
+        // give back the part of the allocation we didn't use
+        if (f_lseek(&SD_file, stream_len) != FR_OK || f_truncate(&SD_file) != FR_OK)
+        {
+            f_close(&SD_file);
+            return SD_CARD_FILE_IO_ERROR;
+        }
+        account_for_open_file_len(stream_len);
+    }
+
+    open_file_alloc_len = 0;
+
+    return (f_close(&SD_file) == FR_OK && is_flushed) ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_fwrite(const void *buff, uint32_t size, uint32_t *written)
+{
+    const bool is_written = write_coalescer_write(buff, size);
+    *written = is_written ? size : 0;
+
+    return is_written ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_lseek(uint64_t offset)
+{
+    // the buffered bytes belong at the old position
+    if (!write_coalescer_flush())
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    write_coalescer_start(write_to_card, write_unit_len, offset);
+
+    if (is_streaming)
+    {
+        // FatFS catches up with the stream position the next time it does a write for us, seeking past the end of a
+        // file open for writing extends it, just like with FatFS
+        stream_pos = offset;
+        stream_len = offset > stream_len ? offset : stream_len;
+        return SD_CARD_ERROR_ALL_OK;
+    }
+
+    if (offset > (FSIZE_t)-1)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    // seeking past the end of a file open for writing extends it
+    const FRESULT res = f_lseek(&SD_file, (FSIZE_t)offset);
+    account_for_open_file_len(f_size(&SD_file));
+
+    return res == FR_OK ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_fsync()
+{
+    // in streaming mode FatFS holds at most the partial sectors at either end of the writes, the rest is already on the
+    // card, and the directory entry gets the size of the pre-allocation
+    return (write_coalescer_flush() && f_sync(&SD_file) == FR_OK) ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_fread(void *buff, uint32_t size, uint32_t *read)
+{
+    if (!write_coalescer_flush())
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    return f_read(&SD_file, buff, size, (UINT *)read) == FR_OK ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_ftruncate(uint64_t size)
+{
+    if (is_streaming || size > (FSIZE_t)-1 || !write_coalescer_flush())
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    const bool is_truncated = f_lseek(&SD_file, (FSIZE_t)size) == FR_OK && f_truncate(&SD_file) == FR_OK;
+    account_for_open_file_len(f_size(&SD_file));
+
+    return is_truncated ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_opendir(const char *path)
+{
+    return f_opendir(&SD_dir, path) == FR_OK ? SD_CARD_ERROR_ALL_OK : SD_CARD_DIRECTORY_ERROR;
+}
+
+SD_Card_Error_t sd_card_readdir(char *name_buff, uint32_t buff_len, bool *is_dir)
+{
+    if (f_readdir(&SD_dir, &SD_dir_entry) != FR_OK)
+    {
+        return SD_CARD_DIRECTORY_ERROR;
+    }
+
+    // FatFS marks the end of the directory with an empty name too
+    strncpy(name_buff, SD_dir_entry.fname, buff_len - 1);
+    name_buff[buff_len - 1] = '\0';
+    *is_dir = (SD_dir_entry.fattrib & AM_DIR) != 0;
+
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_closedir()
+{
+    return f_closedir(&SD_dir) == FR_OK ? SD_CARD_ERROR_ALL_OK : SD_CARD_DIRECTORY_ERROR;
+}
+
+uint64_t sd_card_fsize()
+{
+    // a pre-allocated file is as big as its allocation as far as FatFS knows, until it is trimmed at close, and the
+    // buffered bytes go at the file position
+    const uint64_t len = is_streaming ? stream_len : f_size(&SD_file);
+    const uint64_t buffered_end = (is_streaming ? stream_pos : f_tell(&SD_file)) + write_coalescer_num_buffered();
+
+    return buffered_end > len ? buffered_end : len;
+}
+
+SD_Card_Error_t sd_card_log_open(const char *file_name)
+{
+    if (is_log_open || f_open(&log_file, file_name, FA_OPEN_APPEND | FA_WRITE) != FR_OK)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    log_file_alloc_len = alloc_len(f_size(&log_file));
+    is_log_open = true;
+
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+SD_Card_Error_t sd_card_log_write(const void *buff, uint32_t size)
+{
+    if (!is_log_open)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    UINT written;
+    const FRESULT res = f_write(&log_file, buff, size, &written);
+    account_for_file_growth(&log_file_alloc_len, f_size(&log_file));
+
+    return (res == FR_OK && written == size) ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t sd_card_log_close()
+{
+    if (!is_log_open)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    is_log_open = false;
+    return f_close(&log_file) == FR_OK ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+bool sd_card_log_is_open()
+{
+    return is_log_open;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+SD_Card_Error_t stream_write_through_fatfs(const uint8_t *buff, uint32_t size, uint32_t *written)
+{
+    if (f_tell(&SD_file) != stream_pos && f_lseek(&SD_file, stream_pos) != FR_OK)
+    {
+        return SD_CARD_FILE_IO_ERROR;
+    }
+
+    return f_write(&SD_file, buff, size, (UINT *)written) == FR_OK ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR;
+}
+
+SD_Card_Error_t stream_write(const uint8_t *buff, uint32_t size, uint32_t *written)
+{
+    *written = 0;
+
+    // FatFS finishes off a partial sector at the start, it holds that sector in its own buffer so we must not write it
+    // behind its back
+    const uint32_t head_len = (SECTOR_LEN_IN_BYTES - (stream_pos % SECTOR_LEN_IN_BYTES)) % SECTOR_LEN_IN_BYTES;
+    const uint32_t len_through_fatfs = head_len < size ? head_len : size;
+
+    // the whole sectors in the middle that fall inside the pre-allocation go straight to the card
+    const uint64_t raw_start = stream_pos + len_through_fatfs;
+    const uint64_t raw_end = raw_start + (((size - len_through_fatfs) / SECTOR_LEN_IN_BYTES) * SECTOR_LEN_IN_BYTES);
+    const uint64_t raw_alloc_end = (stream_alloc_len / SECTOR_LEN_IN_BYTES) * SECTOR_LEN_IN_BYTES;
+    const uint32_t raw_len = raw_start >= raw_alloc_end ? 0 : (uint32_t)((raw_end < raw_alloc_end ? raw_end : raw_alloc_end) - raw_start);
+
+    uint32_t num_written;
+
+    if (len_through_fatfs > 0)
+    {
+        if (stream_write_through_fatfs(buff, len_through_fatfs, &num_written) != SD_CARD_ERROR_ALL_OK)
+        {
+            return SD_CARD_FILE_IO_ERROR;
+        }
+        *written += num_written;
+        stream_pos += num_written;
+    }
+
+    if (raw_len > 0)
+    {
+        const LBA_t sector = stream_start_sector + (raw_start / SECTOR_LEN_IN_BYTES);
+
+        if (disk_write(SD_file.obj.fs->pdrv, buff + len_through_fatfs, sector, raw_len / SECTOR_LEN_IN_BYTES) != RES_OK)
+        {
+            return SD_CARD_FILE_IO_ERROR;
+        }
+        *written += raw_len;
+        stream_pos += raw_len;
+    }
+
+    // a partial sector at the end, or whatever didn't fit in the pre-allocation
+    const uint32_t tail_len = size - *written;
+
+    if (tail_len > 0)
+    {
+        if (stream_write_through_fatfs(buff + *written, tail_len, &num_written) != SD_CARD_ERROR_ALL_OK)
+        {
+            return SD_CARD_FILE_IO_ERROR;
+        }
+        *written += num_written;
+        stream_pos += num_written;
+    }
+
+    stream_len = stream_pos > stream_len ? stream_pos : stream_len;
+
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+bool write_to_card(const uint8_t *buff, uint32_t len)
+{
+    uint32_t written;
+
+    // in streaming mode FatFS only grows the file for writes past the pre-allocation
+    const SD_Card_Error_t err = is_streaming ? stream_write(buff, len, &written)
+                                             : (f_write(&SD_file, buff, len, (UINT *)&written) == FR_OK ? SD_CARD_ERROR_ALL_OK : SD_CARD_FILE_IO_ERROR);
+
+    account_for_open_file_len(f_size(&SD_file));
+
+    return err == SD_CARD_ERROR_ALL_OK && written == len;
+}
+
+SD_Card_Error_t mount()
+{
+    fs = &fs_obj;
+
+    if (f_mount(fs, "", 1) != FR_OK)
+    {
+        return SD_CARD_MOUNT_ERROR;
+    }
+
+    open_file_alloc_len = 0;
+    is_mounted = true;
+    return SD_CARD_ERROR_ALL_OK;
+}
+
+uint64_t cluster_len()
+{
+    return (uint64_t)fs->csize * SECTOR_LEN_IN_BYTES;
+}
+
+uint64_t alloc_len(uint64_t file_len)
+{
+    return ((file_len + cluster_len() - 1) / cluster_len()) * cluster_len();
+}
+
+void account_for_open_file_len(uint64_t file_len)
+{
+    account_for_file_growth(&open_file_alloc_len, file_len);
+}
+
+void account_for_file_growth(uint64_t *file_alloc_len, uint64_t file_len)
+{
+    const uint64_t new_alloc_len = alloc_len(file_len);
+
+    // the count from mount may be a little off, so it bottoms out at zero rather than wrapping around
+    if (new_alloc_len > *file_alloc_len)
+    {
+        const uint64_t growth = new_alloc_len - *file_alloc_len;
+        free_bytes -= growth < free_bytes ? growth : free_bytes;
+    }
+    else
+    {
+        free_bytes += *file_alloc_len - new_alloc_len;
+    }
+
+    *file_alloc_len = new_alloc_len;
+}
@@ -0,0 +1,349 @@
+/**
+ * @file    sd_card.h
+ * @brief   A software module for initializing and writing to the SD card is represented here.
+ * @details This is a thin wrapper over the existing Elm-chan FatFS library and MSDK SDHC functions.
+ */
+
+#ifndef SD_CARD_H_
+#define SD_CARD_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include "ff.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public enumerations -----------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Enumerated SD card errors are represented here.
+ */
+typedef enum
+{
+    SD_CARD_ERROR_ALL_OK,
+    SD_CARD_NOT_INSERTED_ERROR,
+    SD_CARD_INIT_ERROR,
+    SD_CARD_MOUNT_ERROR,
+    SD_CARD_DIRECTORY_ERROR,
+    SD_CARD_FILE_IO_ERROR,
+} SD_Card_Error_t;
+
+/**
+ * @brief Enumerated POSIX file modes are represented here. Only file modes we actually use are present, not all modes.
+ */
+typedef enum
+{
+    POSIX_FILE_MODE_READ = FA_READ,
+    POSIX_FILE_MODE_WRITE = FA_CREATE_ALWAYS | FA_WRITE,
+    POSIX_FILE_MODE_APPEND = FA_OPEN_APPEND | FA_WRITE,
+    POSIX_FILE_MODE_READ_WRITE = FA_OPEN_EXISTING | FA_READ | FA_WRITE,
+} POSIX_FileMode_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `sd_card_init()` initializes the SD card. This must be called each time a card is powered up.
+ *
+ * @pre An SD card previously formatted to exFAT or FAT32 is physically inserted in the slot.
+ *
+ * @post The SD card is initialized and ready to be mounted.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if initialization was successful, else an error.
+ */
+SD_Card_Error_t sd_card_init();
+
+/**
+ * @brief `sd_card_mount()` mounts the SD card, and counts its free space.
+ *
+ * @pre `sd_card_init()` must have been successfully called prior to mounting.
+ *
+ * @post The SD card is mounted and ready for file IO operations.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if card mounting was successful, else an error.
+ */
+SD_Card_Error_t sd_card_mount();
+
+/**
+ * @brief `sd_card_mount_with_free_space(f)` mounts the SD card like `sd_card_mount()`, but trusts that it has `f` bytes
+ * of free space instead of counting them. Counting the free clusters can take seconds on a big card, so this is for a
+ * card mounted again after `sd_card_free_space_bytes()` was read just before it was unmounted.
+ *
+ * @pre `sd_card_init()` must have been successfully called prior to mounting, and nothing else wrote to the card since
+ * its free space was `f`.
+ *
+ * @param free_space_in_bytes the free space on the card.
+ *
+ * @post The SD card is mounted and ready for file IO operations.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if card mounting was successful, else an error.
+ */
+SD_Card_Error_t sd_card_mount_with_free_space(uint64_t free_space_in_bytes);
+
+/**
+ * @brief `sd_card_unmount()` unmounts the SD card if it was previously mounted.
+ *
+ * @post The SD card is unmounted.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if unmounting was successful, else an error.
+ */
+SD_Card_Error_t sd_card_unmount();
+
+/**
+ * @brief `sd_card_is_mounted()` is true iff the SD card is mounted.
+ *
+ * @return true if the card is mounted, else false.
+ */
+bool sd_card_is_mounted();
+
+/**
+ * @brief `sd_card_disk_size_bytes()` is the size of the currently mounted SD card in bytes.
+ *
+ * @return the size of the mounted SD card in bytes, or zero if there is no card mounted or an error occurs.
+ */
+uint64_t sd_card_disk_size_bytes();
+
+/**
+ * @brief `sd_card_free_space_bytes()` is the number of bytes of free space on the currently mounted SD card. The free
+ * clusters are only counted at mount, after that the count is kept up to date from the writes of this module, so it is
+ * cheap enough to call while recording.
+ *
+ * @return the number of free bytes on the mounted SD card, or zero if there is no card mounted.
+ */
+uint64_t sd_card_free_space_bytes();
+
+/**
+ * @brief `sd_card_set_write_unit(l)` makes `sd_card_fwrite()` gather the writes of each file opened from now on into
+ * clusters of the mounted card, or units of `l` bytes if clusters are longer, and send each one to the card in one
+ * write that starts and ends on a unit boundary of the file, see `write_coalescer.h`.
+ *
+ * Small writes, like the 2064 bytes a 24kHz 16 bit DMA block turns into, each cost the card as much overhead as a
+ * write of a whole cluster, so gathering them up cuts the time spent writing many times over.
+ *
+ * @param max_len_in_bytes the longest write unit, at most `WRITE_COALESCER_MAX_UNIT_LEN_IN_BYTES`, 0 (the default) to
+ * send every write to the card as it comes.
+ *
+ * @post bytes written but not yet sent to the card go out at the next `sd_card_lseek()`, `sd_card_fsync()`,
+ * `sd_card_fread()`, `sd_card_ftruncate()`, or `sd_card_fclose()`, so only a sync makes sure they survive a power cut.
+ */
+void sd_card_set_write_unit(uint32_t max_len_in_bytes);
+
+/**
+ * @brief `sd_card_mkdir(p)` creates a new directory on the currently mounted SD card at directory path `p`.
+ *
+ * @param path the path of the new directory to create.
+ *
+ * @pre The SD card is mounted.
+ *
+ * @post A new directory at path `p` is created.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error.
+ */
+SD_Card_Error_t sd_card_mkdir(const char *path);
+
+/**
+ * `sd_card_cd(p)` changes the directory of the currently mounted SD card to path `p`.
+ *
+ * @param path the path to change directory into.
+ *
+ * @pre The SD card is mounted and path `p` exists.
+ *
+ * @post The current directory is changed to `p`.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error.
+ */
+SD_Card_Error_t sd_card_cd(const char *path);
+
+/**
+ * @brief `sd_card_fopen(f, m)` opens file at path `f` with file mode `m` on the currently mounted SD card.
+ *
+ * @param file_name the name of the file to open.
+ *
+ * @param mode the enumerated POSIX file mode to use.
+ *
+ * @pre The SD card is mounted.
+ *
+ * @post A file is opened with the given file mode.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error.
+ */
+SD_Card_Error_t sd_card_fopen(const char *file_name, POSIX_FileMode_t mode);
+
+/**
+ * @brief `sd_card_fpreallocate(s)` allocates `s` bytes of contiguous space for the currently open file, and switches the
+ * file to streaming writes.
+ *
+ * Without pre-allocation FatFS walks and extends the cluster chain (and on FAT32 updates the FAT) each time a write
+ * crosses into a new cluster, which shows up as latency spikes in long recordings. In streaming mode every whole sector
+ * of a write that lands in the pre-allocated range goes straight to the card as one multi-block write, with no FAT or
+ * cluster chain look ups. Partial sectors and anything past the pre-allocated range still go through FatFS, so writes
+ * of any length and position work, but writes aligned to `WRITE_PIPELINE_SECTOR_LEN_IN_BYTES` get the most out of it.
+ *
+ * @param size the number of bytes to allocate, the expected final length of the file. It's fine for the file to end up
+ * shorter or longer than this. Sizes of 4GiB and up need an exFAT card.
+ *
+ * @pre The SD card is mounted and a newly created (empty) file is open for writing.
+ *
+ * @post The space is allocated and `sd_card_fsize()` still reports only the bytes written so far. The unused part of
+ * the allocation is freed when the file is closed.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the space was allocated, else an error. On an error the file is untouched and
+ * writes go through FatFS as usual, e.g. if there is no contiguous free space this big, or if `FF_USE_EXPAND` is not
+ * enabled in the FatFS configuration.
+ */
+SD_Card_Error_t sd_card_fpreallocate(uint64_t size);
+
+/**
+ * @brief `sd_card_fclose()` closes any open file on the currently mounted SD card. If the file was pre-allocated, the
+ * allocation is trimmed to the bytes actually written first.
+ *
+ * @pre The SD card is mounted.
+ *
+ * @post If a file was open, it is closed.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error.
+ */
+SD_Card_Error_t sd_card_fclose();
+
+/**
+ * @brief `sd_card_fwrite(b, s, w)` writes `s` bytes of buffer `b` to the currently mounted SD card and stores the number
+ * of bytes written in integer pointer `w`.
+ *
+ * @param buff pointer to the buffer to write from.
+ *
+ * @param size the number of bytes from `buff` to write to the card.
+ *
+ * @param written pointer to an integer to store the number of bytes actually written into.
+ *
+ * @pre The SD card is mounted and a file is opened for writing or appending.
+ *
+ * @post Bytes from the buffer are written to the previously opened file on the SD card.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error. If the number of bytes in `written`
+ * does not match `size` after this function returns, this indicates some write error occurred.
+ */
+SD_Card_Error_t sd_card_fwrite(const void *buff, uint32_t size, uint32_t *written);
+
+/**
+ * @brief `sd_card_lseek(o)` offsets the file pointer `o` bytes from the top of the currently opened file.
+ *
+ * @param offset the number of bytes to offset from the top of the file.
+ *
+ * @pre The SD card is mounted and a file is opened.
+ *
+ * @post The read/write pointer of the currently open file is moved to `o` bytes from the top of the file.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error, e.g. for an offset of 4GiB or more on a
+ * FAT32 card.
+ */
+SD_Card_Error_t sd_card_lseek(uint64_t offset);
+
+/**
+ * @brief `sd_card_fsync()` flushes the cached data of the currently open file to the card and updates its directory
+ * entry, so everything written so far survives a power cut.
+ *
+ * A pre-allocated file is as long as its allocation on the card until it is closed, so after a power cut only its
+ * contents can tell how much of it was written, see `wav_header_repair()`.
+ *
+ * @pre The SD card is mounted and a file is opened for writing.
+ *
+ * @post The file on the card is up to date with every write so far.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error.
+ */
+SD_Card_Error_t sd_card_fsync();
+
+/**
+ * @brief `sd_card_fread(b, s, r)` reads up to `s` bytes from the currently open file into buffer `b` and stores the
+ * number of bytes read in integer pointer `r`.
+ *
+ * @pre The SD card is mounted and a file is opened for reading, without pre-allocation.
+ *
+ * @post The file pointer is moved on by the number of bytes read.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error. Fewer than `s` bytes are read if the
+ * end of the file is reached.
+ */
+SD_Card_Error_t sd_card_fread(void *buff, uint32_t size, uint32_t *read);
+
+/**
+ * @brief `sd_card_ftruncate(s)` cuts the currently open file to `s` bytes.
+ *
+ * @pre The SD card is mounted and a file is opened for writing, without pre-allocation, and `s` is at most its size.
+ *
+ * @post The file is `s` bytes long, and the file pointer is at the end of it.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error.
+ */
+SD_Card_Error_t sd_card_ftruncate(uint64_t size);
+
+/**
+ * @brief `sd_card_opendir(p)` opens the directory at path `p` to list its contents with `sd_card_readdir()`. Only one
+ * directory can be open at a time, files can be opened while it is.
+ *
+ * @pre The SD card is mounted.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the directory was opened, else an error.
+ */
+SD_Card_Error_t sd_card_opendir(const char *path);
+
+/**
+ * @brief `sd_card_readdir(b, l, d)` stores the name of the next entry in the open directory in buffer `b` of length
+ * `l`, and whether it is a directory in `d`. At the end of the directory the name is the empty string.
+ *
+ * @pre A directory is open with `sd_card_opendir()`.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error. Names too long for the buffer are cut
+ * short, so they should not be used to open the entry.
+ */
+SD_Card_Error_t sd_card_readdir(char *name_buff, uint32_t buff_len, bool *is_dir);
+
+/**
+ * @brief `sd_card_closedir()` closes the directory opened with `sd_card_opendir()`.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the operation was successful, else an error.
+ */
+SD_Card_Error_t sd_card_closedir();
+
+/**
+ * @brief `sd_card_fsize()` is the size in bytes of the currently opened file.
+ *
+ * @pre The SD card is mounted and a file is opened.
+ *
+ * @return The size of the currently open file in bytes, invalid if a file is not open.
+ */
+uint64_t sd_card_fsize();
+
+/**
+ * @brief `sd_card_log_open(f)` opens file `f` for appending as the log file, a second file that can be written while
+ * another file is open with `sd_card_fopen()`, e.g. for a trace of the recording. Writes to it aren't coalesced, so
+ * they should be whole sectors.
+ *
+ * @pre The SD card is mounted and the log file is not open.
+ *
+ * @post The log file is open and writes go on the end of it.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the file was opened, else an error.
+ */
+SD_Card_Error_t sd_card_log_open(const char *file_name);
+
+/**
+ * @brief `sd_card_log_write(b, s)` appends `s` bytes of buffer `b` to the log file.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if all of them were written, else an error, including when the log file isn't open.
+ */
+SD_Card_Error_t sd_card_log_write(const void *buff, uint32_t size);
+
+/**
+ * @brief `sd_card_log_close()` closes the log file, so its directory entry is up to date with every write so far.
+ * Unmounting the card closes it too.
+ *
+ * @return `SD_CARD_ERROR_ALL_OK` if the file was closed, else an error.
+ */
+SD_Card_Error_t sd_card_log_close();
+
+/**
+ * @brief `sd_card_log_is_open()` is true iff the log file is open.
+ */
+bool sd_card_log_is_open();
+
+#endif /* SD_CARD_H_ */
@@ -25,7 +25,6 @@
 /* Private includes --------------------------------------------------------------------------------------------------*/
 
 #include "sd_card_bank_ctl.h"
-#include <stddef.h> // for NULL
 
 /* Private defines ---------------------------------------------------------------------------------------------------*/
 
@@ -101,8 +100,8 @@ typedef enum uint8_t
 
 /* Private variables -------------------------------------------------------------------------------------------------*/
 
-// the I2C handle to use
-mxc_i2c_regs_t *hi2c_;
+// the I2C bus the MAX7312 is on
+static Hal_I2C_Bus_t i2c_bus;
 
 // a buffer for MAX7312 reads/writes, we need a maximum of two bytes
 #define MAX7312_I2C_BUFF_LEN (2u)
@@ -150,9 +149,9 @@ static SD_Card_Bank_Ctl_Error_t max7312_reg_read(MAX7312_Register_Addr_t reg, ui
 
 /* Public function definitions ---------------------------------------------------------------------------------------*/
 
-SD_Card_Bank_Ctl_Error_t sd_card_bank_ctl_init(mxc_i2c_regs_t *hi2c)
+SD_Card_Bank_Ctl_Error_t sd_card_bank_ctl_init(Hal_I2C_Bus_t bus)
 {
-    hi2c_ = hi2c;
+    i2c_bus = bus;
 
     // Reset all ports to zero, they initialize to 1 on power up.
     if (sd_card_bank_ctl_disable_all() != SD_CARD_BANK_CTL_ERROR_ALL_OK)
@@ -290,6 +289,18 @@ bool sd_card_bank_ctl_active_card_is_inserted()
     return (pin_pos & detect_pins_bitfield) != 0u;
 }
 
+bool sd_card_bank_ctl_slot_is_inserted(SD_Card_Bank_Card_Slot_t slot)
+{
+    if (slot >= SD_CARD_BANK_CTL_NUM_CARDS)
+    {
+        return false;
+    }
+
+    // in order for this to be valid, sd_card_bank_read_detect_pins() must have been called recently
+    const uint8_t pin_pos = 1u << slot;
+    return (pin_pos & detect_pins_bitfield) != 0u;
+}
+
 /* Private function definitions --------------------------------------------------------------------------------------*/
 
 SD_Card_Bank_Ctl_Error_t max7312_reg_write(MAX7312_Register_Addr_t reg, uint8_t val)
@@ -304,19 +315,9 @@ SD_Card_Bank_Ctl_Error_t max7312_reg_write(MAX7312_Register_Addr_t reg, uint8_t
     max_7312_i2c_buff[0u] = reg;
     max_7312_i2c_buff[1u] = val;
 
-    mxc_i2c_req_t req = {
-        .i2c = hi2c_,
-        .addr = MAX7312_7_BIT_I2C_ADDR,
-        .tx_buf = max_7312_i2c_buff,
-        .tx_len = num_bytes_to_write,
-        .rx_buf = NULL,
-        .rx_len = 0,
-        .restart = 0,
-        .callback = NULL,
-    };
-    const int res = MXC_I2C_MasterTransaction(&req);
-
-    return res == 0 ? SD_CARD_BANK_CTL_ERROR_ALL_OK : SD_CARD_BANK_CTL_I2C_ERROR;
+    const Hal_I2C_Error_t res = hal_i2c_write(i2c_bus, MAX7312_7_BIT_I2C_ADDR, max_7312_i2c_buff, num_bytes_to_write);
+
+    return res == HAL_I2C_ERROR_ALL_OK ? SD_CARD_BANK_CTL_ERROR_ALL_OK : SD_CARD_BANK_CTL_I2C_ERROR;
 }
 
 SD_Card_Bank_Ctl_Error_t max7312_reg_read(MAX7312_Register_Addr_t reg, uint8_t *read_byte)
@@ -325,19 +326,9 @@ SD_Card_Bank_Ctl_Error_t max7312_reg_read(MAX7312_Register_Addr_t reg, uint8_t *
     const uint16_t num_bytes_to_read = 1u;
     max_7312_i2c_buff[0u] = reg;
 
-    mxc_i2c_req_t req = {
-        .i2c = hi2c_,
-        .addr = MAX7312_7_BIT_I2C_ADDR,
-        .tx_buf = max_7312_i2c_buff,
-        .tx_len = num_bytes_to_write,
-        .rx_buf = max_7312_i2c_buff,
-        .rx_len = num_bytes_to_read,
-        .restart = 0,
-        .callback = NULL,
-    };
-    const int res = MXC_I2C_MasterTransaction(&req);
+    const Hal_I2C_Error_t res = hal_i2c_write_read(i2c_bus, MAX7312_7_BIT_I2C_ADDR, max_7312_i2c_buff, num_bytes_to_write, max_7312_i2c_buff, num_bytes_to_read);
 
     *read_byte = max_7312_i2c_buff[0u];
 
-    return res == 0 ? SD_CARD_BANK_CTL_ERROR_ALL_OK : SD_CARD_BANK_CTL_I2C_ERROR;
+    return res == HAL_I2C_ERROR_ALL_OK ? SD_CARD_BANK_CTL_ERROR_ALL_OK : SD_CARD_BANK_CTL_I2C_ERROR;
 }
@@ -11,7 +11,7 @@
 /* Includes ----------------------------------------------------------------------------------------------------------*/
 
 #include <stdbool.h>
-#include "i2c.h"
+#include "hal_i2c.h"
 
 /* Public defines ----------------------------------------------------------------------------------------------------*/
 
@@ -46,10 +46,10 @@ typedef enum
 /* Public function declarations --------------------------------------------------------------------------------------*/
 
 /**
- * @brief `sd_card_bank_ctl_init(i2c)` initializes the SD card bank with I2C handle `i2c` and configures all of the I2C
- * GPIO port expander pins used to control the SD card bank.
+ * @brief `sd_card_bank_ctl_init(b)` initializes the SD card bank on I2C bus `b` and configures all of the I2C GPIO
+ * port expander pins used to control the SD card bank.
  *
- * @param hi2c: pointer to the I2C handle to use for I2C transactions.
+ * @param bus: the I2C bus the port expander is on, already initialized.
  *
  * @post All input/output pins of the port expander are configured and the SD card bank is powered down.
  *
@@ -57,7 +57,7 @@ typedef enum
  *
  * This must be performed before any other SD card bank functions are called.
  */
-SD_Card_Bank_Ctl_Error_t sd_card_bank_ctl_init(mxc_i2c_regs_t *hi2c);
+SD_Card_Bank_Ctl_Error_t sd_card_bank_ctl_init(Hal_I2C_Bus_t bus);
 
 /**
  * @brief `sd_card_bank_ctl_disable_all()` deselects any active card slot and powers down the SD card bank.
@@ -126,4 +126,18 @@ SD_Card_Bank_Ctl_Error_t sd_card_bank_ctl_read_and_cache_detect_pins();
  */
 bool sd_card_bank_ctl_active_card_is_inserted();
 
+/**
+ * @brief `sd_card_bank_ctl_slot_is_inserted(s)` is true iff a card in slot `s` was physically detected by the last
+ * `sd_card_bank_ctl_read_and_cache_detect_pins()`, whether the slot is active or not.
+ *
+ * The detect switches are wired to the port expander and not to the cards, so an unpowered card is detected too. This
+ * is how a card can be looked for before switching to it. The same caveats as for
+ * `sd_card_bank_ctl_active_card_is_inserted()` apply.
+ *
+ * @pre `sd_card_bank_init()` has been called. To be valid, `sd_card_bank_read_and_cache_detect_pins()` has been called.
+ *
+ * @return true if a card is physically detected in slot `s`, otherwise false, also for an invalid slot.
+ */
+bool sd_card_bank_ctl_slot_is_inserted(SD_Card_Bank_Card_Slot_t slot);
+
 #endif /* SD_CARD_BANK_H_ */
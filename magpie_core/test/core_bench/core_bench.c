@@ -0,0 +1,312 @@
+/**
+ * Measures the hot paths of the core modules with the buffer sizes each snippet that uses them really has, so a change
+ * to a core module can be timed once for all of them:
+ *
+ * - adc_dma_sd_card_write: a DMA block of 384kHz 24 bit audio and one of 24kHz 16 bit audio through the write coalescer
+ *   into 32KiB clusters, a block of 16 bit samples through the IMA ADPCM encoder, and an RF64 header with a bext chunk
+ *   for every file
+ * - mock_audio_sd_card_write: a 128Ki sample buffer of mono sine, and its 256KiB writes through the coalescer
+ * - mock_audio_sd_card_write_2_channel: an 8256 sample buffer of interleaved stereo sine, and its writes
+ * - sd_mux_control: a short line of text written to each card
+ *
+ * Each operation is repeated until it has moved enough bytes to time reliably, and the fastest of a few runs is kept,
+ * to keep the host scheduler out of the timings.
+ *
+ * The sink the coalescer writes to stands in for the SD card, and reads every byte it is handed, just like the DMA of
+ * the card interface would, so a write that goes straight from the caller's buffer costs what moving it out costs
+ * rather than nothing. `direct_%` is the share of the bytes that went straight from the caller's buffer without being
+ * copied into the unit buffer first, 100 means the coalescer was a pass-through for that write size.
+ *
+ * usage: core_bench [--quick]
+ */
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ima_adpcm.h"
+#include "mock_audio.h"
+#include "wav_header.h"
+#include "write_coalescer.h"
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+#define NUM_TIMING_RUNS (5)
+
+// each run of an operation repeats it until it has produced at least this many bytes, `--quick` cuts it down
+#define BYTES_PER_RUN (64u * 1024u * 1024u)
+#define QUICK_BYTES_PER_RUN (1024u * 1024u)
+
+// the largest buffer any of the snippets has, mock_audio_sd_card_write's 128Ki samples of 16 bit audio
+#define MAX_BUFF_LEN_IN_BYTES (1u << 18u)
+
+#define CLUSTER_LEN_IN_BYTES (32768u)
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief An operation to time is represented here, `run()` does it once on a buffer of `len` bytes.
+ */
+typedef struct
+{
+    const char *consumer;
+    const char *name;
+    uint32_t len;
+    void (*run)(uint32_t len);
+} Bench_Op_t;
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+static uint8_t buff[MAX_BUFF_LEN_IN_BYTES];
+
+static uint8_t adpcm_buff[IMA_ADPCM_MAX_ENCODED_LEN_IN_BYTES(MAX_BUFF_LEN_IN_BYTES / 2)];
+
+// what the sink has been handed, so the compiler can't drop the writes
+static uint64_t sink_total_len = 0;
+
+// a sum of every byte the sink has read
+static uint32_t sink_checksum = 0;
+
+// the bytes the sink was handed in the current run, and how many of those came straight from `buff`
+static uint64_t sink_run_len = 0;
+static uint64_t sink_direct_len = 0;
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `sink_write(b, l)` stands in for the SD card, it reads every byte of any write and takes it.
+ */
+static bool sink_write(const uint8_t *buff, uint32_t len);
+
+static void run_coalesced_write(uint32_t len);
+
+static void run_mono_sine_tick(uint32_t len);
+
+static void run_mono_sine_fill(uint32_t len);
+
+static void run_stereo_sine_tick(uint32_t len);
+
+static void run_stereo_sine_fill(uint32_t len);
+
+static void run_ima_adpcm_encode(uint32_t len);
+
+static void run_plain_wav_header(uint32_t len);
+
+static void run_rf64_bext_wav_header(uint32_t len);
+
+/**
+ * @brief `bench(o, b)` times operation `o` for at least `b` bytes per run and prints a row of results.
+ */
+static void bench(const Bench_Op_t *op, uint32_t bytes_per_run);
+
+static double now_in_secs();
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    uint32_t bytes_per_run = BYTES_PER_RUN;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            bytes_per_run = QUICK_BYTES_PER_RUN;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--quick]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    mock_audio_sine_init();
+    mock_audio_set_sample_rate(WAVE_HEADER_SAMPLE_RATE_48kHz);
+    mock_audio_set_sine_freq(MOCK_AUDIO_CHANNEL_A, 1000);
+    mock_audio_set_sine_freq(MOCK_AUDIO_CHANNEL_B, 2000);
+
+    // the header rows are per file, their length is the header's so MB/s means little, look at ns/op
+    static const Bench_Op_t ops[] = {
+        {"adc_dma_sd_card_write", "coalesce 384k 24bit block", 24768, run_coalesced_write},
+        {"adc_dma_sd_card_write", "coalesce 24k 16bit block", 2064, run_coalesced_write},
+        {"adc_dma_sd_card_write", "ima adpcm encode block", 16512, run_ima_adpcm_encode},
+        {"adc_dma_sd_card_write", "rf64 + bext header", 0, run_rf64_bext_wav_header},
+        {"mock_audio_sd_card_write", "sine tick loop", 1u << 18u, run_mono_sine_tick},
+        {"mock_audio_sd_card_write", "sine fill", 1u << 18u, run_mono_sine_fill},
+        {"mock_audio_sd_card_write", "coalesce buffer", 1u << 18u, run_coalesced_write},
+        {"mock_audio_sd_card_write", "plain header", 0, run_plain_wav_header},
+        {"mock_audio_sd_card_write_2_channel", "sine tick loop", 16512, run_stereo_sine_tick},
+        {"mock_audio_sd_card_write_2_channel", "sine fill", 16512, run_stereo_sine_fill},
+        {"mock_audio_sd_card_write_2_channel", "coalesce buffer", 16512, run_coalesced_write},
+        {"sd_mux_control", "coalesce text line", 20, run_coalesced_write},
+    };
+
+    printf("%-36s %-28s %8s %12s %10s %9s\n", "consumer", "operation", "bytes", "ns/op", "MB/s", "direct_%");
+
+    for (uint32_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++)
+    {
+        bench(&ops[i], bytes_per_run);
+    }
+
+    // keeps the sink alive, and is a handy sanity check that the writes went somewhere
+    printf("%llu bytes handed to the sink, checksum 0x%08x\n", (unsigned long long)sink_total_len, (unsigned)sink_checksum);
+
+    return EXIT_SUCCESS;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+bool sink_write(const uint8_t *data, uint32_t len)
+{
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        sum += data[i];
+    }
+
+    sink_checksum += sum;
+    sink_total_len += len;
+    sink_run_len += len;
+
+    // anything else was copied into the unit buffer of the coalescer first
+    if (data >= buff && data < buff + MAX_BUFF_LEN_IN_BYTES)
+    {
+        sink_direct_len += len;
+    }
+
+    return true;
+}
+
+void run_coalesced_write(uint32_t len)
+{
+    write_coalescer_write(buff, len);
+}
+
+void run_mono_sine_tick(uint32_t len)
+{
+    int16_t *samps = (int16_t *)buff;
+
+    for (uint32_t i = 0; i < len / sizeof(int16_t); i++)
+    {
+        samps[i] = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_A);
+    }
+}
+
+void run_mono_sine_fill(uint32_t len)
+{
+    mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_A, (int16_t *)buff, len / sizeof(int16_t), 1);
+}
+
+void run_stereo_sine_tick(uint32_t len)
+{
+    int16_t *samps = (int16_t *)buff;
+
+    for (uint32_t i = 0; i < len / sizeof(int16_t); i += 2)
+    {
+        samps[i] = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_A);
+        samps[i + 1] = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_B);
+    }
+}
+
+void run_stereo_sine_fill(uint32_t len)
+{
+    int16_t *samps = (int16_t *)buff;
+    const uint32_t num_frames = len / (2 * sizeof(int16_t));
+
+    mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_A, &samps[0], num_frames, 2);
+    mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_B, &samps[1], num_frames, 2);
+}
+
+void run_ima_adpcm_encode(uint32_t len)
+{
+    sink_total_len += ima_adpcm_encode((const int16_t *)buff, len / sizeof(int16_t), adpcm_buff);
+}
+
+void run_plain_wav_header(uint32_t len)
+{
+    (void)len;
+
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_16_BITS_PER_SAMPLE,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_48kHz,
+        .file_length = 5760044 + (sink_total_len & 1),
+    };
+    wav_header_set_attributes(&attr);
+    sink_total_len += (uint8_t)wav_header_get_header()[4];
+}
+
+void run_rf64_bext_wav_header(uint32_t len)
+{
+    (void)len;
+
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_384kHz,
+        .file_length = 6912000000ull + (sink_total_len & 1),
+    };
+    wav_header_set_attributes(&attr);
+    sink_total_len += (uint8_t)wav_header_get_header()[4];
+}
+
+void bench(const Bench_Op_t *op, uint32_t bytes_per_run)
+{
+    const bool is_header = op->run == run_plain_wav_header || op->run == run_rf64_bext_wav_header;
+
+    wav_header_enable_rf64(op->run == run_rf64_bext_wav_header);
+    wav_header_enable_bext(op->run == run_rf64_bext_wav_header);
+    wav_header_enable_ima_adpcm(false);
+
+    const uint32_t len = is_header ? wav_header_get_header_length() : op->len;
+    const uint32_t num_ops = (bytes_per_run + len - 1) / len;
+
+    // something other than silence for the encoder and the sink to chew on
+    mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_A, (int16_t *)buff, MAX_BUFF_LEN_IN_BYTES / sizeof(int16_t), 1);
+
+    double best_secs = 1e9;
+    for (uint32_t run = 0; run < NUM_TIMING_RUNS; run++)
+    {
+        ima_adpcm_reset();
+        write_coalescer_start(sink_write, CLUSTER_LEN_IN_BYTES, 0);
+        sink_run_len = 0;
+        sink_direct_len = 0;
+
+        const double start = now_in_secs();
+        for (uint32_t i = 0; i < num_ops; i++)
+        {
+            op->run(len);
+        }
+        write_coalescer_flush();
+        const double secs = now_in_secs() - start;
+
+        best_secs = secs < best_secs ? secs : best_secs;
+    }
+
+    const double ns_per_op = (best_secs * 1e9) / num_ops;
+    const double mb_per_sec = ((double)len * num_ops) / (best_secs * 1e6);
+
+    printf("%-36s %-28s %8u %12.1f %10.1f", op->consumer, op->name, len, ns_per_op, mb_per_sec);
+
+    // only the coalesced writes go to the sink
+    if (sink_run_len > 0)
+    {
+        printf(" %9.1f\n", (100.0 * sink_direct_len) / sink_run_len);
+    }
+    else
+    {
+        printf(" %9s\n", "-");
+    }
+}
+
+double now_in_secs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
@@ -0,0 +1,50 @@
+#include "fake_hal_gpio.hpp"
+
+static uint32_t levels[HAL_GPIO_NUM_PORTS];
+static uint32_t configured[HAL_GPIO_NUM_PORTS];
+
+namespace fake_hal_gpio
+{
+    bool level(Hal_GPIO_Port_t port, uint32_t mask)
+    {
+        return (levels[port] & mask) != 0;
+    }
+
+    void reset()
+    {
+        for (uint32_t i = 0; i < HAL_GPIO_NUM_PORTS; i++)
+        {
+            levels[i] = 0;
+            configured[i] = 0;
+        }
+    }
+
+    bool is_configured(Hal_GPIO_Port_t port, uint32_t mask)
+    {
+        return (configured[port] & mask) != 0;
+    }
+}
+
+extern "C"
+{
+    Hal_GPIO_Error_t hal_gpio_config(const Hal_GPIO_Pin_t *pin)
+    {
+        configured[pin->port] |= pin->mask;
+        return HAL_GPIO_ERROR_ALL_OK;
+    }
+
+    void hal_gpio_write(const Hal_GPIO_Pin_t *pin, bool state)
+    {
+        levels[pin->port] = state ? (levels[pin->port] | pin->mask) : (levels[pin->port] & ~pin->mask);
+    }
+
+    void hal_gpio_toggle(const Hal_GPIO_Pin_t *pin)
+    {
+        levels[pin->port] ^= pin->mask;
+    }
+
+    bool hal_gpio_read(const Hal_GPIO_Pin_t *pin)
+    {
+        return (levels[pin->port] & pin->mask) != 0;
+    }
+}
@@ -0,0 +1,24 @@
+/**
+ * The drivers of the core reach their pins through hal_gpio.h, so it is faked here for their tests with a level for
+ * every pin, which writes set and reads return.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+extern "C"
+{
+#include "hal_gpio.h"
+}
+
+namespace fake_hal_gpio
+{
+    // true if any of the pins `mask` of `port` is high
+    bool level(Hal_GPIO_Port_t port, uint32_t mask);
+
+    // sets every pin low, and forgets which pins were configured
+    void reset();
+
+    // true if any of the pins `mask` of `port` was configured since the last reset
+    bool is_configured(Hal_GPIO_Port_t port, uint32_t mask);
+}
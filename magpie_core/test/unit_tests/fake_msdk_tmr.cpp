@@ -0,0 +1,153 @@
+#include "fake_msdk_tmr.hpp"
+
+#include <stddef.h>
+
+mxc_tmr_regs_t fake_msdk_tmr1;
+
+static uint32_t tmr_count = 0;
+static uint32_t tmr_compare = 0;
+static bool tmr_flag = false;
+static bool tmr_running = false;
+static bool irq_enabled = false;
+static void (*tmr1_vector)(void) = NULL;
+
+namespace fake_msdk_tmr
+{
+    void reset()
+    {
+        tmr_count = 0;
+        tmr_compare = 0;
+        tmr_flag = false;
+        tmr_running = false;
+        irq_enabled = false;
+        tmr1_vector = NULL;
+    }
+
+    void advance(uint32_t cycles)
+    {
+        if (!tmr_running || tmr_compare == 0)
+        {
+            return;
+        }
+
+        const uint64_t new_count = (uint64_t)tmr_count + cycles;
+        if (new_count >= tmr_compare)
+        {
+            tmr_flag = true;
+        }
+        tmr_count = (uint32_t)(new_count % tmr_compare);
+    }
+
+    bool take_interrupt()
+    {
+        if (!tmr_flag || !irq_enabled || tmr1_vector == NULL)
+        {
+            return false;
+        }
+
+        tmr1_vector();
+        return true;
+    }
+
+    uint32_t count()
+    {
+        return tmr_count;
+    }
+
+    uint32_t compare()
+    {
+        return tmr_compare;
+    }
+
+    bool is_running()
+    {
+        return tmr_running;
+    }
+}
+
+extern "C"
+{
+    void NVIC_EnableIRQ(IRQn_Type irq)
+    {
+        irq_enabled = irq == TMR1_IRQn ? true : irq_enabled;
+    }
+
+    void NVIC_DisableIRQ(IRQn_Type irq)
+    {
+        irq_enabled = irq == TMR1_IRQn ? false : irq_enabled;
+    }
+
+    void NVIC_ClearPendingIRQ(IRQn_Type irq)
+    {
+        // the fake interrupt is only ever pending through the flag of the timer
+        (void)irq;
+    }
+
+    void MXC_NVIC_SetVector(IRQn_Type irqn, void (*irq_callback)(void))
+    {
+        tmr1_vector = irqn == TMR1_IRQn ? irq_callback : tmr1_vector;
+    }
+
+    int MXC_Delay(uint32_t us)
+    {
+        (void)us;
+        return E_NO_ERROR;
+    }
+
+    int MXC_TMR_Init(mxc_tmr_regs_t *tmr, mxc_tmr_cfg_t *cfg)
+    {
+        (void)tmr;
+        tmr_running = false;
+        tmr_count = 0;
+        tmr_compare = cfg->cmp_cnt;
+        return E_NO_ERROR;
+    }
+
+    void MXC_TMR_Shutdown(mxc_tmr_regs_t *tmr)
+    {
+        (void)tmr;
+        tmr_running = false;
+    }
+
+    void MXC_TMR_Start(mxc_tmr_regs_t *tmr)
+    {
+        (void)tmr;
+        tmr_running = true;
+    }
+
+    void MXC_TMR_Stop(mxc_tmr_regs_t *tmr)
+    {
+        (void)tmr;
+        tmr_running = false;
+    }
+
+    void MXC_TMR_ClearFlags(mxc_tmr_regs_t *tmr)
+    {
+        (void)tmr;
+        tmr_flag = false;
+    }
+
+    uint32_t MXC_TMR_GetFlags(mxc_tmr_regs_t *tmr)
+    {
+        (void)tmr;
+        return tmr_flag ? 1 : 0;
+    }
+
+    void MXC_TMR_SetCompare(mxc_tmr_regs_t *tmr, uint32_t cmp_cnt)
+    {
+        (void)tmr;
+        tmr_compare = cmp_cnt;
+    }
+
+    uint32_t MXC_TMR_GetCount(mxc_tmr_regs_t *tmr)
+    {
+        (void)tmr;
+        return tmr_count;
+    }
+
+    void MXC_TMR_SetCount(mxc_tmr_regs_t *tmr, uint32_t cnt)
+    {
+        (void)tmr;
+        tmr_count = cnt;
+    }
+}
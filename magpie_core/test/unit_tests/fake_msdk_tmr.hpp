@@ -0,0 +1,31 @@
+/**
+ * The tick of hal_timer.c runs on TMR1 of the MSDK, so TMR1 and the NVIC calls it makes are faked here for its tests.
+ * The fake counts cycles of the peripheral clock only when a test moves it on, from 0 up to the compare count, where it
+ * sets its flag and starts over from 0, and the interrupt only runs when a test takes it.
+ */
+
+#include <stdint.h>
+
+extern "C"
+{
+#include "nvic_table.h"
+#include "tmr.h"
+}
+
+namespace fake_msdk_tmr
+{
+    // stops the timer, clears its count, compare count, and flag, and forgets the handler in the vector table
+    void reset();
+
+    // moves the count on by `cycles` if the timer is running, setting the flag each time it reaches the compare count
+    void advance(uint32_t cycles);
+
+    // calls the handler in the vector table if the flag is set and the interrupt is enabled, true if it was called
+    bool take_interrupt();
+
+    uint32_t count();
+
+    uint32_t compare();
+
+    bool is_running();
+}
@@ -0,0 +1,12 @@
+/**
+ * This file is a header override for the MSDK mxc_delay.h, fake_msdk_tmr.cpp fakes the delay as returning at once.
+ */
+
+#ifndef MXC_DELAY_HEADER_OVERRIDE_H__
+#define MXC_DELAY_HEADER_OVERRIDE_H__
+
+#include <stdint.h>
+
+int MXC_Delay(uint32_t us);
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ * This file is a header override for the MSDK mxc_device.h, only the parts hal_timer.c uses are here, the peripheral
+ * clock and the NVIC calls, which fake_msdk_tmr.cpp fakes. Add more here if necessary.
+ */
+
+#ifndef MXC_DEVICE_HEADER_OVERRIDE_H__
+#define MXC_DEVICE_HEADER_OVERRIDE_H__
+
+#include <stdint.h>
+
+#define E_NO_ERROR 0
+
+// SystemCoreClock / 2 at the 96MHz of the MAX32666
+#define PeripheralClock (48000000)
+
+typedef enum
+{
+    TMR1_IRQn = 21,
+} IRQn_Type;
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+
+#endif
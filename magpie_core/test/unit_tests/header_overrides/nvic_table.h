@@ -0,0 +1,13 @@
+/**
+ * This file is a header override for the MSDK nvic_table.h, fake_msdk_tmr.cpp keeps the handler put in the vector
+ * table, and calls it when a test takes the interrupt.
+ */
+
+#ifndef NVIC_TABLE_HEADER_OVERRIDE_H__
+#define NVIC_TABLE_HEADER_OVERRIDE_H__
+
+#include "mxc_device.h"
+
+void MXC_NVIC_SetVector(IRQn_Type irqn, void (*irq_callback)(void));
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * This file is a header override for the MSDK tmr.h, only the continuous mode hal_timer.c runs TMR1 in is here, which
+ * fake_msdk_tmr.cpp fakes. Add more here if necessary.
+ */
+
+#ifndef TMR_HEADER_OVERRIDE_H__
+#define TMR_HEADER_OVERRIDE_H__
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t unused;
+} mxc_tmr_regs_t;
+
+extern mxc_tmr_regs_t fake_msdk_tmr1;
+
+#define MXC_TMR1 (&fake_msdk_tmr1)
+
+typedef enum
+{
+    TMR_PRES_1,
+} mxc_tmr_pres_t;
+
+typedef enum
+{
+    TMR_MODE_CONTINUOUS,
+} mxc_tmr_mode_t;
+
+typedef struct
+{
+    mxc_tmr_pres_t pres;
+    mxc_tmr_mode_t mode;
+    uint32_t cmp_cnt;
+    unsigned pol;
+} mxc_tmr_cfg_t;
+
+int MXC_TMR_Init(mxc_tmr_regs_t *tmr, mxc_tmr_cfg_t *cfg);
+void MXC_TMR_Shutdown(mxc_tmr_regs_t *tmr);
+void MXC_TMR_Start(mxc_tmr_regs_t *tmr);
+void MXC_TMR_Stop(mxc_tmr_regs_t *tmr);
+void MXC_TMR_ClearFlags(mxc_tmr_regs_t *tmr);
+uint32_t MXC_TMR_GetFlags(mxc_tmr_regs_t *tmr);
+void MXC_TMR_SetCompare(mxc_tmr_regs_t *tmr, uint32_t cmp_cnt);
+uint32_t MXC_TMR_GetCount(mxc_tmr_regs_t *tmr);
+void MXC_TMR_SetCount(mxc_tmr_regs_t *tmr, uint32_t cnt);
+
+#endif
@@ -0,0 +1,149 @@
+/**
+ * The AFE gain control is tested against a fake pair of MAX14662 switches on a fake I2C bus, defined here in place of
+ * the HAL.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "fake_hal_gpio.hpp"
+
+extern "C"
+{
+#include "afe_control.h"
+#include "hal_i2c.h"
+}
+
+using namespace testing;
+
+static const uint32_t CH0_ENABLE_MASK = HAL_GPIO_PIN(11);
+static const uint32_t CH1_ENABLE_MASK = HAL_GPIO_PIN(12);
+
+// the switch settings of each fake MAX14662, and what the last write to it was
+static uint8_t switches_0x4E;
+static uint8_t switches_0x4F;
+static std::vector<uint8_t> last_write;
+
+static bool nack_everything;
+static Hal_I2C_Bus_t last_bus;
+
+extern "C"
+{
+    Hal_I2C_Error_t hal_i2c_write_read(Hal_I2C_Bus_t bus, uint8_t addr, const uint8_t *tx_buff, uint32_t tx_len, uint8_t *rx_buff, uint32_t rx_len)
+    {
+        last_bus = bus;
+
+        if (nack_everything || (addr != 0x4E && addr != 0x4F))
+        {
+            return HAL_I2C_ERROR_TRANSACTION_ERROR;
+        }
+
+        uint8_t *switches = addr == 0x4E ? &switches_0x4E : &switches_0x4F;
+
+        if (tx_len > 0)
+        {
+            last_write.assign(tx_buff, tx_buff + tx_len);
+            *switches = tx_buff[tx_len - 1];
+        }
+
+        for (uint32_t i = 0; i < rx_len; i++)
+        {
+            rx_buff[i] = *switches;
+        }
+
+        return HAL_I2C_ERROR_ALL_OK;
+    }
+
+    Hal_I2C_Error_t hal_i2c_write(Hal_I2C_Bus_t bus, uint8_t addr, const uint8_t *tx_buff, uint32_t tx_len)
+    {
+        return hal_i2c_write_read(bus, addr, tx_buff, tx_len, NULL, 0);
+    }
+}
+
+class AFEControlTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        fake_hal_gpio::reset();
+        switches_0x4E = 0;
+        switches_0x4F = 0;
+        last_write.clear();
+        nack_everything = false;
+        last_bus = HAL_I2C_BUS_2;
+
+        afe_control_init(HAL_I2C_BUS_0);
+    }
+};
+
+TEST_F(AFEControlTest, init_configures_the_enable_pins_and_leaves_the_channels_off)
+{
+    ASSERT_TRUE(fake_hal_gpio::is_configured(HAL_GPIO_PORT_0, CH0_ENABLE_MASK));
+    ASSERT_TRUE(fake_hal_gpio::is_configured(HAL_GPIO_PORT_0, CH1_ENABLE_MASK));
+
+    ASSERT_FALSE(afe_control_channel_is_enabled(AFE_CONTROL_CHANNEL_0));
+    ASSERT_FALSE(afe_control_channel_is_enabled(AFE_CONTROL_CHANNEL_1));
+}
+
+TEST_F(AFEControlTest, enable_and_disable_drive_the_pin_of_the_channel)
+{
+    afe_control_enable(AFE_CONTROL_CHANNEL_1);
+    ASSERT_FALSE(fake_hal_gpio::level(HAL_GPIO_PORT_0, CH0_ENABLE_MASK));
+    ASSERT_TRUE(fake_hal_gpio::level(HAL_GPIO_PORT_0, CH1_ENABLE_MASK));
+    ASSERT_TRUE(afe_control_channel_is_enabled(AFE_CONTROL_CHANNEL_1));
+
+    afe_control_disable(AFE_CONTROL_CHANNEL_1);
+    ASSERT_FALSE(fake_hal_gpio::level(HAL_GPIO_PORT_0, CH1_ENABLE_MASK));
+    ASSERT_FALSE(afe_control_channel_is_enabled(AFE_CONTROL_CHANNEL_1));
+}
+
+TEST_F(AFEControlTest, set_gain_writes_a_dummy_register_then_the_switches_of_the_channel)
+{
+    afe_control_enable(AFE_CONTROL_CHANNEL_0);
+
+    ASSERT_EQ(afe_control_set_gain(AFE_CONTROL_CHANNEL_0, AFE_CONTROL_GAIN_25dB), AFE_CONTROL_ERROR_ALL_OK);
+
+    ASSERT_EQ(last_bus, HAL_I2C_BUS_0);
+    ASSERT_EQ(last_write, std::vector<uint8_t>({0x00, AFE_CONTROL_GAIN_25dB}));
+    ASSERT_EQ(switches_0x4F, AFE_CONTROL_GAIN_25dB);
+    ASSERT_EQ(switches_0x4E, 0);
+}
+
+TEST_F(AFEControlTest, get_gain_reads_back_the_gain_that_was_set)
+{
+    afe_control_enable(AFE_CONTROL_CHANNEL_0);
+    afe_control_enable(AFE_CONTROL_CHANNEL_1);
+
+    ASSERT_EQ(afe_control_set_gain(AFE_CONTROL_CHANNEL_0, AFE_CONTROL_GAIN_40dB), AFE_CONTROL_ERROR_ALL_OK);
+    ASSERT_EQ(afe_control_set_gain(AFE_CONTROL_CHANNEL_1, AFE_CONTROL_GAIN_5dB), AFE_CONTROL_ERROR_ALL_OK);
+
+    ASSERT_EQ(afe_control_get_gain(AFE_CONTROL_CHANNEL_0), AFE_CONTROL_GAIN_40dB);
+    ASSERT_EQ(afe_control_get_gain(AFE_CONTROL_CHANNEL_1), AFE_CONTROL_GAIN_5dB);
+}
+
+TEST_F(AFEControlTest, a_disabled_channel_is_never_sent_anything)
+{
+    ASSERT_EQ(afe_control_set_gain(AFE_CONTROL_CHANNEL_0, AFE_CONTROL_GAIN_25dB), AFE_CONTROL_ERROR_CHANNEL_NOT_ENABLED_ERROR);
+    ASSERT_EQ(afe_control_get_gain(AFE_CONTROL_CHANNEL_0), AFE_CONTROL_GAIN_UNDEFINED);
+
+    ASSERT_TRUE(last_write.empty());
+    ASSERT_EQ(last_bus, HAL_I2C_BUS_2);
+}
+
+TEST_F(AFEControlTest, a_nack_is_an_i2c_error)
+{
+    afe_control_enable(AFE_CONTROL_CHANNEL_0);
+    nack_everything = true;
+
+    ASSERT_EQ(afe_control_set_gain(AFE_CONTROL_CHANNEL_0, AFE_CONTROL_GAIN_25dB), AFE_CONTROL_ERROR_I2C_ERROR);
+    ASSERT_EQ(afe_control_get_gain(AFE_CONTROL_CHANNEL_0), AFE_CONTROL_GAIN_UNDEFINED);
+}
+
+TEST_F(AFEControlTest, a_read_of_more_than_one_switch_is_an_undefined_gain)
+{
+    afe_control_enable(AFE_CONTROL_CHANNEL_0);
+    switches_0x4F = AFE_CONTROL_GAIN_5dB | AFE_CONTROL_GAIN_10dB;
+
+    ASSERT_EQ(afe_control_get_gain(AFE_CONTROL_CHANNEL_0), AFE_CONTROL_GAIN_UNDEFINED);
+}
@@ -0,0 +1,200 @@
+/**
+ * The GNSS module is tested against NMEA sentences fed to a fake UART, defined here in place of the HAL.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "fake_hal_gpio.hpp"
+
+extern "C"
+{
+#include "gnss_module.h"
+#include "hal_uart.h"
+}
+
+using namespace testing;
+
+static const uint32_t GNSS_ENABLE_MASK = HAL_GPIO_PIN(23);
+
+// what the GNSS has sent that hasn't been read yet, and the most chars one read hands over
+static std::string uart_rx;
+static uint32_t max_chars_per_read;
+
+static bool uart_init_fails;
+static uint32_t uart_baud_rate;
+
+// valid sentences, with a fix of quality 1 at 12:35:19 UTC on the 23rd of March 1994
+static const std::string GGA_WITH_FIX = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+static const std::string GGA_NO_FIX = "$GPGGA,123519,4807.038,N,01131.000,E,0,08,0.9,545.4,M,46.9,M,,*46\r\n";
+static const std::string RMC_VALID = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+
+extern "C"
+{
+    Hal_UART_Error_t hal_uart_init(Hal_UART_t uart, uint32_t baud_rate, Hal_GPIO_Voltage_t voltage)
+    {
+        (void)uart;
+        (void)voltage;
+
+        uart_baud_rate = baud_rate;
+        return uart_init_fails ? HAL_UART_ERROR_CONFIG_ERROR : HAL_UART_ERROR_ALL_OK;
+    }
+
+    uint32_t hal_uart_read(Hal_UART_t uart, uint8_t *rx_buff, uint32_t max_len)
+    {
+        (void)uart;
+
+        const uint32_t n = std::min({max_len, max_chars_per_read, (uint32_t)uart_rx.size()});
+        uart_rx.copy((char *)rx_buff, n);
+        uart_rx.erase(0, n);
+        return n;
+    }
+}
+
+class GNSSModuleTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        fake_hal_gpio::reset();
+        uart_rx.clear();
+        max_chars_per_read = UINT32_MAX;
+        uart_init_fails = false;
+        uart_baud_rate = 0;
+
+        ASSERT_EQ(gnss_module_init(), GNSS_MODULE_ERROR_ALL_OK);
+        gnss_module_enable();
+        gnss_module_sync_start();
+    }
+
+    // polls until the UART is drained or a poll finds a fix, and is the result of the last poll
+    GNSS_Module_Error_t poll_until_drained(struct tm *utc_time, bool *has_fix)
+    {
+        GNSS_Module_Error_t err;
+        do
+        {
+            err = gnss_module_sync_poll(utc_time, has_fix);
+        } while (err == GNSS_MODULE_ERROR_ALL_OK && !*has_fix && !uart_rx.empty());
+
+        return err;
+    }
+};
+
+TEST_F(GNSSModuleTest, init_sets_up_the_uart_and_leaves_the_module_powered_down)
+{
+    fake_hal_gpio::reset();
+
+    ASSERT_EQ(gnss_module_init(), GNSS_MODULE_ERROR_ALL_OK);
+
+    ASSERT_EQ(uart_baud_rate, 9600u);
+    ASSERT_TRUE(fake_hal_gpio::is_configured(HAL_GPIO_PORT_0, GNSS_ENABLE_MASK));
+    ASSERT_FALSE(fake_hal_gpio::level(HAL_GPIO_PORT_0, GNSS_ENABLE_MASK));
+
+    gnss_module_enable();
+    ASSERT_TRUE(fake_hal_gpio::level(HAL_GPIO_PORT_0, GNSS_ENABLE_MASK));
+
+    gnss_module_disable();
+    ASSERT_FALSE(fake_hal_gpio::level(HAL_GPIO_PORT_0, GNSS_ENABLE_MASK));
+}
+
+TEST_F(GNSSModuleTest, a_uart_that_wont_configure_is_an_error)
+{
+    uart_init_fails = true;
+
+    ASSERT_EQ(gnss_module_init(), GNSS_MODULE_UART_ERROR);
+}
+
+TEST_F(GNSSModuleTest, nothing_received_is_no_fix_yet)
+{
+    struct tm t = {};
+    bool has_fix = true;
+
+    ASSERT_EQ(gnss_module_sync_poll(&t, &has_fix), GNSS_MODULE_ERROR_ALL_OK);
+    ASSERT_FALSE(has_fix);
+}
+
+TEST_F(GNSSModuleTest, a_valid_rmc_after_a_gga_with_a_fix_gives_the_utc_time)
+{
+    uart_rx = GGA_WITH_FIX + RMC_VALID;
+
+    struct tm t = {};
+    bool has_fix = false;
+    ASSERT_EQ(poll_until_drained(&t, &has_fix), GNSS_MODULE_ERROR_ALL_OK);
+
+    ASSERT_TRUE(has_fix);
+    ASSERT_EQ(t.tm_year, 94);
+    ASSERT_EQ(t.tm_mon, 2);
+    ASSERT_EQ(t.tm_mday, 23);
+    ASSERT_EQ(t.tm_hour, 12);
+    ASSERT_EQ(t.tm_min, 35);
+    ASSERT_EQ(t.tm_sec, 19);
+}
+
+TEST_F(GNSSModuleTest, sentences_split_across_polls_are_put_back_together)
+{
+    uart_rx = GGA_WITH_FIX + RMC_VALID;
+    max_chars_per_read = 5;
+
+    struct tm t = {};
+    bool has_fix = false;
+
+    // each poll drains what has arrived, so feed the sentences in a few chars at a time
+    const std::string all = uart_rx;
+    uart_rx.clear();
+    for (size_t i = 0; i < all.size() && !has_fix; i += 7)
+    {
+        uart_rx += all.substr(i, 7);
+        ASSERT_EQ(gnss_module_sync_poll(&t, &has_fix), GNSS_MODULE_ERROR_ALL_OK);
+    }
+
+    ASSERT_TRUE(has_fix);
+    ASSERT_EQ(t.tm_sec, 19);
+}
+
+TEST_F(GNSSModuleTest, an_rmc_is_ignored_until_a_gga_reports_a_fix)
+{
+    uart_rx = GGA_NO_FIX + RMC_VALID;
+
+    struct tm t = {};
+    bool has_fix = false;
+    ASSERT_EQ(poll_until_drained(&t, &has_fix), GNSS_MODULE_ERROR_ALL_OK);
+    ASSERT_FALSE(has_fix);
+}
+
+TEST_F(GNSSModuleTest, a_sentence_with_a_bad_checksum_is_ignored)
+{
+    std::string bad_rmc = RMC_VALID;
+    bad_rmc[bad_rmc.find('*') + 1] = '0';
+    uart_rx = GGA_WITH_FIX + bad_rmc;
+
+    struct tm t = {};
+    bool has_fix = false;
+    ASSERT_EQ(poll_until_drained(&t, &has_fix), GNSS_MODULE_ERROR_ALL_OK);
+    ASSERT_FALSE(has_fix);
+}
+
+TEST_F(GNSSModuleTest, sync_start_forgets_the_fix_quality_of_an_earlier_search)
+{
+    uart_rx = GGA_WITH_FIX;
+
+    struct tm t = {};
+    bool has_fix = false;
+    ASSERT_EQ(poll_until_drained(&t, &has_fix), GNSS_MODULE_ERROR_ALL_OK);
+
+    gnss_module_sync_start();
+
+    uart_rx = RMC_VALID;
+    ASSERT_EQ(poll_until_drained(&t, &has_fix), GNSS_MODULE_ERROR_ALL_OK);
+    ASSERT_FALSE(has_fix);
+}
+
+TEST_F(GNSSModuleTest, garbage_and_overlong_lines_dont_stop_the_search)
+{
+    uart_rx = "\xff\xfe noise $" + std::string(200, 'x') + "\r\n" + GGA_WITH_FIX + RMC_VALID;
+
+    struct tm t = {};
+    bool has_fix = false;
+    ASSERT_EQ(poll_until_drained(&t, &has_fix), GNSS_MODULE_ERROR_ALL_OK);
+    ASSERT_TRUE(has_fix);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+#include "fake_msdk_tmr.hpp"
+
+extern "C"
+{
+#include "hal_timer.h"
+}
+
+using namespace testing;
+
+// a tick period of 1ms is this many cycles of the 48MHz peripheral clock
+static const uint32_t period_cycles = 48000;
+
+// the number of periods each call of the tick callback was passed, in order
+static std::vector<uint32_t> ticks;
+
+static void tick_callback(uint32_t num_periods)
+{
+    ticks.push_back(num_periods);
+}
+
+class HalTimerTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        hal_timer_stop_tick();
+        fake_msdk_tmr::reset();
+        ticks.clear();
+    }
+
+    void TearDown() override
+    {
+        hal_timer_stop_tick();
+    }
+};
+
+TEST_F(HalTimerTest, suppressing_or_resuming_before_the_tick_starts_does_nothing)
+{
+    hal_timer_suppress_tick(10000);
+    hal_timer_resume_tick();
+
+    EXPECT_EQ(fake_msdk_tmr::compare(), 0);
+    EXPECT_FALSE(fake_msdk_tmr::is_running());
+    EXPECT_THAT(ticks, IsEmpty());
+}
+
+TEST_F(HalTimerTest, suppressing_after_the_tick_stops_does_nothing)
+{
+    ASSERT_EQ(hal_timer_start_tick(1000, tick_callback), HAL_TIMER_ERROR_ALL_OK);
+    hal_timer_stop_tick();
+
+    hal_timer_suppress_tick(10000);
+    hal_timer_resume_tick();
+
+    EXPECT_EQ(fake_msdk_tmr::compare(), period_cycles);
+    EXPECT_THAT(ticks, IsEmpty());
+}
+
+TEST_F(HalTimerTest, the_interrupt_put_in_the_vector_table_ticks_once_per_period)
+{
+    ASSERT_EQ(hal_timer_start_tick(1000, tick_callback), HAL_TIMER_ERROR_ALL_OK);
+    EXPECT_EQ(fake_msdk_tmr::compare(), period_cycles);
+
+    fake_msdk_tmr::advance(period_cycles - 1);
+    EXPECT_FALSE(fake_msdk_tmr::take_interrupt());
+
+    fake_msdk_tmr::advance(1);
+    EXPECT_TRUE(fake_msdk_tmr::take_interrupt());
+    EXPECT_FALSE(fake_msdk_tmr::take_interrupt());
+
+    EXPECT_THAT(ticks, ElementsAre(1));
+}
+
+TEST_F(HalTimerTest, suppressing_holds_the_tick_off_for_whole_periods)
+{
+    ASSERT_EQ(hal_timer_start_tick(1000, tick_callback), HAL_TIMER_ERROR_ALL_OK);
+
+    hal_timer_suppress_tick(10500);
+
+    EXPECT_EQ(fake_msdk_tmr::compare(), 10 * period_cycles);
+}
+
+TEST_F(HalTimerTest, suppressing_for_a_period_or_less_does_nothing)
+{
+    ASSERT_EQ(hal_timer_start_tick(1000, tick_callback), HAL_TIMER_ERROR_ALL_OK);
+
+    hal_timer_suppress_tick(1999);
+    EXPECT_EQ(fake_msdk_tmr::compare(), period_cycles);
+
+    hal_timer_resume_tick();
+    EXPECT_THAT(ticks, IsEmpty());
+}
+
+TEST_F(HalTimerTest, suppressing_with_a_tick_pending_does_nothing)
+{
+    ASSERT_EQ(hal_timer_start_tick(1000, tick_callback), HAL_TIMER_ERROR_ALL_OK);
+    fake_msdk_tmr::advance(period_cycles);
+
+    hal_timer_suppress_tick(10000);
+    EXPECT_EQ(fake_msdk_tmr::compare(), period_cycles);
+
+    EXPECT_TRUE(fake_msdk_tmr::take_interrupt());
+    EXPECT_THAT(ticks, ElementsAre(1));
+}
+
+TEST_F(HalTimerTest, suppressing_for_ages_is_limited_to_the_32_bit_compare_count)
+{
+    ASSERT_EQ(hal_timer_start_tick(1000, tick_callback), HAL_TIMER_ERROR_ALL_OK);
+
+    hal_timer_suppress_tick(UINT32_MAX);
+
+    EXPECT_EQ(fake_msdk_tmr::compare(), (UINT32_MAX / period_cycles) * period_cycles);
+}
+
+TEST_F(HalTimerTest, waking_early_catches_up_the_whole_periods_and_keeps_what_is_left_for_the_next_tick)
+{
+    ASSERT_EQ(hal_timer_start_tick(1000, tick_callback), HAL_TIMER_ERROR_ALL_OK);
+
+    hal_timer_suppress_tick(10000);
+    fake_msdk_tmr::advance(3 * period_cycles + 1000);
+    EXPECT_FALSE(fake_msdk_tmr::take_interrupt());
+
+    hal_timer_resume_tick();
+
+    EXPECT_THAT(ticks, ElementsAre(3));
+    EXPECT_EQ(fake_msdk_tmr::compare(), period_cycles);
+    EXPECT_EQ(fake_msdk_tmr::count(), 1000);
+    EXPECT_TRUE(fake_msdk_tmr::is_running());
+
+    // the part of a period from before waking up counts toward the next tick
+    fake_msdk_tmr::advance(period_cycles - 1000);
+    EXPECT_TRUE(fake_msdk_tmr::take_interrupt());
+    EXPECT_THAT(ticks, ElementsAre(3, 1));
+}
+
+TEST_F(HalTimerTest, the_held_off_tick_is_counted_once_when_it_comes_before_resuming)
+{
+    ASSERT_EQ(hal_timer_start_tick(1000, tick_callback), HAL_TIMER_ERROR_ALL_OK);
+
+    hal_timer_suppress_tick(10000);
+    fake_msdk_tmr::advance(10 * period_cycles + 500);
+
+    hal_timer_resume_tick();
+
+    // its interrupt is taken care of by resuming, so it doesn't tick again once interrupts are unmasked
+    EXPECT_FALSE(fake_msdk_tmr::take_interrupt());
+    EXPECT_THAT(ticks, ElementsAre(10));
+    EXPECT_EQ(fake_msdk_tmr::compare(), period_cycles);
+    EXPECT_EQ(fake_msdk_tmr::count(), 500);
+}
+
+TEST_F(HalTimerTest, resuming_without_suppressing_does_nothing)
+{
+    ASSERT_EQ(hal_timer_start_tick(1000, tick_callback), HAL_TIMER_ERROR_ALL_OK);
+    fake_msdk_tmr::advance(1000);
+
+    hal_timer_resume_tick();
+
+    EXPECT_THAT(ticks, IsEmpty());
+    EXPECT_EQ(fake_msdk_tmr::count(), 1000);
+}
@@ -0,0 +1,240 @@
+/**
+ * The blocks are checked by decoding them with the IMA ADPCM decoder below, written from the WAVE format 0x11 block
+ * layout rather than from the encoder. While viewing or modifying this file it may help to have the IMA ADPCM
+ * recommendation open, for example: http://www.cs.columbia.edu/~hgs/audio/dvi/IMA_ADPCM.pdf
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+extern "C"
+{
+#include "ima_adpcm.h"
+}
+
+using namespace testing;
+
+static const int32_t step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107,
+    118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+    6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767};
+
+static const int32_t index_table[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+// decodes the mono block of 512 bytes in `block` into its 1017 samples, appended to `dest`
+static void decode_block(const uint8_t *block, std::vector<int16_t> &dest)
+{
+    int32_t sample = (int16_t)(block[0] | (block[1] << 8));
+    int32_t index = block[2];
+    EXPECT_LE(index, 88);
+    EXPECT_EQ(block[3], 0);
+
+    dest.push_back((int16_t)sample);
+
+    for (uint32_t i = 4; i < IMA_ADPCM_BLOCK_LEN_IN_BYTES; i++)
+    {
+        for (uint32_t nibble = 0; nibble < 2; nibble++)
+        {
+            const uint32_t code = nibble == 0 ? (block[i] & 0xF) : (block[i] >> 4);
+            const int32_t step = step_table[index];
+
+            int32_t diff = step >> 3;
+            if (code & 1)
+            {
+                diff += step >> 2;
+            }
+            if (code & 2)
+            {
+                diff += step >> 1;
+            }
+            if (code & 4)
+            {
+                diff += step;
+            }
+
+            sample += (code & 8) ? -diff : diff;
+            sample = sample > 32767 ? 32767 : sample < -32768 ? -32768 : sample;
+
+            index += index_table[code];
+            index = index > 88 ? 88 : index < 0 ? 0 : index;
+
+            dest.push_back((int16_t)sample);
+        }
+    }
+}
+
+// encodes all of `src` in calls of `chunk_len` samples and is the blocks that came out
+static std::vector<uint8_t> encode(const std::vector<int16_t> &src, uint32_t chunk_len)
+{
+    std::vector<uint8_t> encoded(IMA_ADPCM_MAX_ENCODED_LEN_IN_BYTES(src.size()) + IMA_ADPCM_BLOCK_LEN_IN_BYTES);
+    uint32_t len = 0;
+
+    ima_adpcm_reset();
+    for (uint32_t i = 0; i < src.size(); i += chunk_len)
+    {
+        const uint32_t n = (uint32_t)std::min<size_t>(chunk_len, src.size() - i);
+        const uint32_t out = ima_adpcm_encode(src.data() + i, n, encoded.data() + len);
+        EXPECT_LE(out, IMA_ADPCM_MAX_ENCODED_LEN_IN_BYTES(n));
+        len += out;
+    }
+
+    encoded.resize(len);
+    return encoded;
+}
+
+static std::vector<int16_t> decode(const std::vector<uint8_t> &encoded)
+{
+    std::vector<int16_t> decoded;
+    for (size_t i = 0; i < encoded.size(); i += IMA_ADPCM_BLOCK_LEN_IN_BYTES)
+    {
+        decode_block(encoded.data() + i, decoded);
+    }
+    return decoded;
+}
+
+static std::vector<int16_t> make_sine(uint32_t num_samples, double freq_over_rate, double amplitude)
+{
+    std::vector<int16_t> samples(num_samples);
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        samples[i] = (int16_t)lround(amplitude * sin(2.0 * M_PI * freq_over_rate * i));
+    }
+    return samples;
+}
+
+// the signal to noise ratio of `decoded` as a copy of `src` in dB
+static double snr_db(const std::vector<int16_t> &src, const std::vector<int16_t> &decoded)
+{
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t i = 0; i < decoded.size(); i++)
+    {
+        signal += (double)src[i] * src[i];
+        noise += ((double)src[i] - decoded[i]) * ((double)src[i] - decoded[i]);
+    }
+    return 10.0 * log10(signal / (noise > 0.0 ? noise : 1.0));
+}
+
+TEST(ImaAdpcmTest, blocks_are_a_sector_of_1017_samples)
+{
+    ASSERT_EQ(IMA_ADPCM_BLOCK_LEN_IN_BYTES, 512);
+    ASSERT_EQ(IMA_ADPCM_SAMPLES_PER_BLOCK, 1017);
+    ASSERT_EQ(IMA_ADPCM_MAX_ENCODED_LEN_IN_BYTES(1), 512);
+    ASSERT_EQ(IMA_ADPCM_MAX_ENCODED_LEN_IN_BYTES(1017), 512);
+    ASSERT_EQ(IMA_ADPCM_MAX_ENCODED_LEN_IN_BYTES(1018), 1024);
+}
+
+TEST(ImaAdpcmTest, only_whole_blocks_are_output)
+{
+    const std::vector<int16_t> src = make_sine(1017, 0.01, 10000.0);
+    uint8_t encoded[1024];
+
+    ima_adpcm_reset();
+    ASSERT_EQ(ima_adpcm_encode(src.data(), 1016, encoded), 0);
+    ASSERT_EQ(ima_adpcm_encode(src.data() + 1016, 1, encoded), 512);
+    ASSERT_EQ(ima_adpcm_encode(src.data(), 0, encoded), 0);
+}
+
+TEST(ImaAdpcmTest, each_block_starts_with_its_first_sample_as_is)
+{
+    const std::vector<int16_t> src = make_sine(3 * 1017, 0.003, 20000.0);
+    const std::vector<uint8_t> encoded = encode(src, (uint32_t)src.size());
+    ASSERT_EQ(encoded.size(), 3 * 512);
+
+    for (uint32_t b = 0; b < 3; b++)
+    {
+        const int16_t first = (int16_t)(encoded[b * 512] | (encoded[(b * 512) + 1] << 8));
+        ASSERT_EQ(first, src[b * 1017]);
+    }
+
+    // the step size only starts small in the first block, the others pick up where the last one left off
+    ASSERT_EQ(encoded[2], 0);
+    ASSERT_GT(encoded[512 + 2], 0);
+}
+
+TEST(ImaAdpcmTest, blocks_are_the_same_however_the_samples_are_fed_in)
+{
+    const std::vector<int16_t> src = make_sine(8256 * 3, 0.0123, 15000.0);
+    const std::vector<uint8_t> in_one_go = encode(src, (uint32_t)src.size());
+
+    // DMA blocks at each sample rate, and sizes that split blocks at odd and even samples
+    for (uint32_t chunk_len : {8256u, 4128u, 2064u, 1032u, 516u, 1017u, 1u, 2u, 3u, 1000u, 1018u})
+    {
+        ASSERT_EQ(encode(src, chunk_len), in_one_go) << "fed " << chunk_len << " samples at a time";
+    }
+}
+
+TEST(ImaAdpcmTest, a_sine_wave_decodes_to_within_the_quantization_noise)
+{
+    // a 1kHz tone at 48kHz, and the same at 96kHz, at a range of levels
+    for (double freq_over_rate : {1.0 / 48.0, 1.0 / 96.0})
+    {
+        for (double amplitude : {30000.0, 3000.0, 300.0})
+        {
+            const std::vector<int16_t> src = make_sine(20 * 1017, freq_over_rate, amplitude);
+            const std::vector<int16_t> decoded = decode(encode(src, 516));
+
+            ASSERT_EQ(decoded.size(), src.size());
+            ASSERT_GT(snr_db(src, decoded), 25.0) << "amplitude " << amplitude << " at f/fs " << freq_over_rate;
+        }
+    }
+}
+
+TEST(ImaAdpcmTest, silence_decodes_to_silence)
+{
+    const std::vector<int16_t> src(5 * 1017, 0);
+    const std::vector<int16_t> decoded = decode(encode(src, 1032));
+
+    ASSERT_EQ(decoded.size(), src.size());
+
+    // the smallest step is 7, so silence dithers by at most a step
+    for (int16_t sample : decoded)
+    {
+        ASSERT_LE(std::abs(sample), 7);
+    }
+}
+
+TEST(ImaAdpcmTest, full_scale_steps_stay_in_range_and_are_tracked)
+{
+    // a full scale square wave, the worst case for the step size and for clipping the prediction
+    std::vector<int16_t> src(10 * 1017);
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        src[i] = ((i / 200) % 2) ? INT16_MAX : INT16_MIN;
+    }
+
+    const std::vector<int16_t> decoded = decode(encode(src, 2064));
+    ASSERT_EQ(decoded.size(), src.size());
+
+    // once the step size has grown to match, the decoder sits on the rails
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        if (i % 200 >= 20)
+        {
+            ASSERT_NEAR(decoded[i], src[i], 2000) << "at sample " << i;
+        }
+    }
+}
+
+TEST(ImaAdpcmTest, reset_drops_the_unfinished_block)
+{
+    const std::vector<int16_t> src = make_sine(1017, 0.01, 10000.0);
+    uint8_t first[512];
+    uint8_t second[512];
+
+    ima_adpcm_reset();
+    ASSERT_EQ(ima_adpcm_encode(src.data(), 1017, first), 512);
+
+    ima_adpcm_reset();
+    ASSERT_EQ(ima_adpcm_encode(src.data(), 500, second), 0);
+    ima_adpcm_reset();
+    ASSERT_EQ(ima_adpcm_encode(src.data(), 1017, second), 512);
+
+    ASSERT_EQ(memcmp(first, second, 512), 0);
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <vector>
+
+extern "C"
+{
+#include "mock_audio.h"
+}
+
+using namespace testing;
+
+static const uint32_t SAMPLE_RATE = 48000;
+
+// the sine is turned down to half of fullscale
+static const int16_t MAX_VAL = INT16_MAX / 2;
+
+class MockAudioTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        mock_audio_sine_init();
+        mock_audio_set_sample_rate(SAMPLE_RATE);
+        mock_audio_set_sine_freq(MOCK_AUDIO_CHANNEL_A, 1000);
+        mock_audio_set_sine_freq(MOCK_AUDIO_CHANNEL_B, 2000);
+    }
+};
+
+// the number of times the samples go from negative to not negative
+static uint32_t num_rising_zero_crossings(const std::vector<int16_t> &samps)
+{
+    uint32_t num_crossings = 0;
+    for (size_t i = 1; i < samps.size(); i++)
+    {
+        num_crossings += samps[i - 1] < 0 && samps[i] >= 0;
+    }
+    return num_crossings;
+}
+
+TEST_F(MockAudioTest, sine_has_the_set_frequency_and_amplitude)
+{
+    // one second of audio
+    std::vector<int16_t> samps(SAMPLE_RATE);
+    for (auto &s : samps)
+    {
+        s = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_A);
+    }
+
+    // the phase increment is rounded down to a multiple of the frequency, which makes the sine a few tenths of a percent
+    // flat
+    ASSERT_NEAR(num_rising_zero_crossings(samps), 1000, 3);
+
+    ASSERT_LE(*std::max_element(samps.begin(), samps.end()), MAX_VAL);
+    ASSERT_GE(*std::max_element(samps.begin(), samps.end()), MAX_VAL - 1);
+    ASSERT_GE(*std::min_element(samps.begin(), samps.end()), -MAX_VAL);
+}
+
+TEST_F(MockAudioTest, channels_have_their_own_frequency_and_phase)
+{
+    std::vector<int16_t> a(SAMPLE_RATE);
+    std::vector<int16_t> b(SAMPLE_RATE);
+
+    // ticking A more often than B does not move B along
+    for (uint32_t i = 0; i < SAMPLE_RATE; i++)
+    {
+        a[i] = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_A);
+    }
+    for (uint32_t i = 0; i < SAMPLE_RATE; i++)
+    {
+        b[i] = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_B);
+    }
+
+    ASSERT_NEAR(num_rising_zero_crossings(a), 1000, 3);
+    ASSERT_NEAR(num_rising_zero_crossings(b), 2000, 6);
+}
+
+TEST_F(MockAudioTest, fill_gives_the_same_samples_as_tick)
+{
+    const uint32_t len = 1000;
+
+    std::vector<int16_t> ticked(len);
+    for (auto &s : ticked)
+    {
+        s = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_A);
+    }
+
+    mock_audio_sine_init();
+
+    // split in two, to check that the phase carries over from one fill to the next
+    std::vector<int16_t> filled(len);
+    mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_A, filled.data(), 300, 1);
+    mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_A, filled.data() + 300, len - 300, 1);
+
+    ASSERT_THAT(filled, ContainerEq(ticked));
+
+    // and tick carries on from where fill left off
+    mock_audio_sine_init();
+    mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_A, filled.data(), len - 1, 1);
+    ASSERT_EQ(mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_A), ticked[len - 1]);
+}
+
+TEST_F(MockAudioTest, fill_with_a_stride_interleaves_channels)
+{
+    const uint32_t num_frames = 500;
+
+    std::vector<int16_t> left(num_frames);
+    std::vector<int16_t> right(num_frames);
+    for (uint32_t i = 0; i < num_frames; i++)
+    {
+        left[i] = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_A);
+        right[i] = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_B);
+    }
+
+    mock_audio_sine_init();
+
+    // one extra sample past the end, which must be left alone
+    std::vector<int16_t> interleaved(2 * num_frames + 1, 0x1234);
+    mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_A, &interleaved[0], num_frames, 2);
+    mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_B, &interleaved[1], num_frames, 2);
+
+    for (uint32_t i = 0; i < num_frames; i++)
+    {
+        ASSERT_EQ(interleaved[2 * i], left[i]);
+        ASSERT_EQ(interleaved[2 * i + 1], right[i]);
+    }
+    ASSERT_EQ(interleaved[2 * num_frames], 0x1234);
+}
+
+TEST_F(MockAudioTest, init_restarts_every_channel_at_phase_0)
+{
+    mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_A);
+    mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_B);
+
+    mock_audio_sine_init();
+
+    // the first tick is one increment past phase 0, so just above 0 for both channels
+    const int16_t a = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_A);
+    const int16_t b = mock_audio_sine_tick(MOCK_AUDIO_CHANNEL_B);
+    ASSERT_GT(a, 0);
+    ASSERT_GT(b, a);
+}
@@ -0,0 +1,397 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "scheduler.h"
+}
+
+using namespace testing;
+
+// which task ran, with the events it was given, in the order they ran
+static std::vector<std::pair<int, Scheduler_Events_t>> runs;
+
+static Scheduler_Task_t task_a;
+static Scheduler_Task_t task_b;
+
+static void handle_a(Scheduler_Events_t events)
+{
+    runs.push_back({0, events});
+}
+
+static void handle_b(Scheduler_Events_t events)
+{
+    runs.push_back({1, events});
+}
+
+// runs tasks until there is nothing left to run
+static void run_until_idle()
+{
+    while (scheduler_run_once())
+    {
+    }
+}
+
+class SchedulerTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        scheduler_reset();
+        runs.clear();
+    }
+};
+
+TEST_F(SchedulerTest, a_task_only_runs_when_it_has_events)
+{
+    ASSERT_EQ(scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a), SCHEDULER_ERROR_ALL_OK);
+
+    ASSERT_FALSE(scheduler_run_once());
+
+    scheduler_post(task_a, 0x4);
+    ASSERT_TRUE(scheduler_run_once());
+    ASSERT_FALSE(scheduler_run_once());
+
+    ASSERT_THAT(runs, ElementsAre(Pair(0, 0x4)));
+}
+
+TEST_F(SchedulerTest, a_task_runs_once_per_post_and_the_first_run_gets_the_merged_events)
+{
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    scheduler_post(task_a, 0x1);
+    scheduler_post(task_a, 0x2);
+    scheduler_post(task_a, 0x1);
+    run_until_idle();
+
+    ASSERT_THAT(runs, ElementsAre(Pair(0, 0x3), Pair(0, 0), Pair(0, 0)));
+}
+
+TEST_F(SchedulerTest, events_posted_between_runs_of_a_backlog_go_to_the_next_run)
+{
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    scheduler_post(task_a, 0x1);
+    scheduler_post(task_a, 0x1);
+    ASSERT_TRUE(scheduler_run_once());
+
+    scheduler_post(task_a, 0x4);
+    run_until_idle();
+
+    ASSERT_THAT(runs, ElementsAre(Pair(0, 0x1), Pair(0, 0x4), Pair(0, 0)));
+}
+
+TEST_F(SchedulerTest, the_most_urgent_task_runs_first)
+{
+    // b is added first, but a is more urgent
+    scheduler_add_task(handle_b, SCHEDULER_PRIORITY_LOW, &task_b);
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_HIGH, &task_a);
+
+    scheduler_post(task_b, 0x1);
+    scheduler_post(task_a, 0x1);
+    run_until_idle();
+
+    ASSERT_THAT(runs, ElementsAre(Pair(0, 0x1), Pair(1, 0x1)));
+}
+
+TEST_F(SchedulerTest, tasks_of_equal_priority_run_in_the_order_they_were_added)
+{
+    scheduler_add_task(handle_b, SCHEDULER_PRIORITY_NORMAL, &task_b);
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    scheduler_post(task_a, 0x1);
+    scheduler_post(task_b, 0x1);
+    run_until_idle();
+
+    ASSERT_THAT(runs, ElementsAre(Pair(1, 0x1), Pair(0, 0x1)));
+}
+
+TEST_F(SchedulerTest, too_many_tasks_or_timers_is_an_error)
+{
+    Scheduler_Task_t task;
+    for (uint32_t i = 0; i < SCHEDULER_MAX_NUM_TASKS; i++)
+    {
+        ASSERT_EQ(scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task), SCHEDULER_ERROR_ALL_OK);
+    }
+    ASSERT_EQ(scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task), SCHEDULER_ERROR_TOO_MANY_TASKS);
+
+    Scheduler_Timer_t timer;
+    for (uint32_t i = 0; i < SCHEDULER_MAX_NUM_TIMERS; i++)
+    {
+        ASSERT_EQ(scheduler_add_timer(task, 0x1, &timer), SCHEDULER_ERROR_ALL_OK);
+    }
+    ASSERT_EQ(scheduler_add_timer(task, 0x1, &timer), SCHEDULER_ERROR_TOO_MANY_TIMERS);
+
+    // and a timer for a task that doesn't exist, or with nothing to post, is no use
+    scheduler_reset();
+    ASSERT_EQ(scheduler_add_timer(0, 0x1, &timer), SCHEDULER_ERROR_INVALID_ARG);
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task);
+    ASSERT_EQ(scheduler_add_timer(task, 0, &timer), SCHEDULER_ERROR_INVALID_ARG);
+}
+
+TEST_F(SchedulerTest, a_one_shot_timer_posts_once_when_it_expires)
+{
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    Scheduler_Timer_t timer;
+    scheduler_add_timer(task_a, 0x8, &timer);
+    scheduler_timer_start(timer, 10, 0);
+
+    scheduler_tick(9);
+    run_until_idle();
+    ASSERT_THAT(runs, IsEmpty());
+
+    scheduler_tick(1);
+    run_until_idle();
+    ASSERT_THAT(runs, ElementsAre(Pair(0, 0x8)));
+
+    scheduler_tick(100);
+    run_until_idle();
+    ASSERT_EQ(runs.size(), 1);
+}
+
+TEST_F(SchedulerTest, a_periodic_timer_keeps_its_period_until_stopped)
+{
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    Scheduler_Timer_t timer;
+    scheduler_add_timer(task_a, 0x1, &timer);
+    scheduler_timer_start(timer, 5, 10);
+
+    // a tick at a time, as the tick interrupt would
+    for (uint32_t ms = 0; ms < 40; ms++)
+    {
+        scheduler_tick(1);
+        run_until_idle();
+    }
+
+    // at 5, 15, 25, and 35ms
+    ASSERT_EQ(runs.size(), 4);
+
+    scheduler_timer_stop(timer);
+    scheduler_tick(100);
+    run_until_idle();
+    ASSERT_EQ(runs.size(), 4);
+}
+
+TEST_F(SchedulerTest, a_periodic_timer_that_falls_behind_posts_once_and_catches_up)
+{
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    Scheduler_Timer_t timer;
+    scheduler_add_timer(task_a, 0x1, &timer);
+    scheduler_timer_start(timer, 10, 10);
+
+    // the main loop was busy for five periods
+    scheduler_tick(55);
+    run_until_idle();
+    ASSERT_EQ(runs.size(), 1);
+
+    // and the next one is a whole period after it was seen
+    scheduler_tick(9);
+    run_until_idle();
+    ASSERT_EQ(runs.size(), 1);
+    scheduler_tick(1);
+    run_until_idle();
+    ASSERT_EQ(runs.size(), 2);
+}
+
+TEST_F(SchedulerTest, timers_work_across_the_wrap_of_the_clock)
+{
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    Scheduler_Timer_t timer;
+    scheduler_add_timer(task_a, 0x1, &timer);
+
+    scheduler_tick(UINT32_MAX - 4);
+    scheduler_timer_start(timer, 10, 0);
+
+    scheduler_tick(9);
+    run_until_idle();
+    ASSERT_THAT(runs, IsEmpty());
+
+    scheduler_tick(1);
+    run_until_idle();
+    ASSERT_EQ(runs.size(), 1);
+}
+
+TEST_F(SchedulerTest, the_time_to_the_next_timer_is_that_of_the_soonest_running_one)
+{
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    Scheduler_Timer_t soon;
+    Scheduler_Timer_t later;
+    scheduler_add_timer(task_a, 0x1, &soon);
+    scheduler_add_timer(task_a, 0x2, &later);
+
+    // nothing to wake up for
+    ASSERT_EQ(scheduler_get_millisecs_to_next_timer(), UINT32_MAX);
+
+    scheduler_timer_start(later, 500, 0);
+    scheduler_timer_start(soon, 20, 20);
+    scheduler_tick(5);
+    ASSERT_EQ(scheduler_get_millisecs_to_next_timer(), 15);
+
+    // a timer that is due but hasn't posted yet is due now
+    scheduler_tick(15);
+    ASSERT_EQ(scheduler_get_millisecs_to_next_timer(), 0);
+    run_until_idle();
+    ASSERT_EQ(scheduler_get_millisecs_to_next_timer(), 20);
+
+    scheduler_timer_stop(soon);
+    ASSERT_EQ(scheduler_get_millisecs_to_next_timer(), 480);
+}
+
+TEST_F(SchedulerTest, the_latency_is_from_the_first_post_to_the_run)
+{
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    scheduler_post(task_a, 0x1);
+    scheduler_tick(3);
+    scheduler_post(task_a, 0x2);
+    scheduler_tick(4);
+    run_until_idle();
+
+    ASSERT_EQ(scheduler_get_max_latency_millisecs(task_a), 7);
+
+    // a shorter wait doesn't lower the max
+    scheduler_post(task_a, 0x1);
+    scheduler_tick(2);
+    run_until_idle();
+    ASSERT_EQ(scheduler_get_max_latency_millisecs(task_a), 7);
+
+    scheduler_reset_stats();
+    ASSERT_EQ(scheduler_get_max_latency_millisecs(task_a), 0);
+}
+
+TEST_F(SchedulerTest, it_is_idle_only_with_no_events_pending_and_no_timer_due)
+{
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    Scheduler_Timer_t timer;
+    scheduler_add_timer(task_a, 0x2, &timer);
+    scheduler_timer_start(timer, 5, 0);
+    ASSERT_TRUE(scheduler_is_idle());
+
+    scheduler_post(task_a, 0x1);
+    ASSERT_FALSE(scheduler_is_idle());
+    run_until_idle();
+    ASSERT_TRUE(scheduler_is_idle());
+
+    // the tick moved the clock on past the timer, it isn't idle until the timer has posted and the task has run
+    scheduler_tick(5);
+    ASSERT_FALSE(scheduler_is_idle());
+    run_until_idle();
+    ASSERT_TRUE(scheduler_is_idle());
+
+    ASSERT_THAT(runs, ElementsAre(Pair(0, 0x1), Pair(0, 0x2)));
+}
+
+// a task that posts to itself until it has run often enough, then stops the scheduler
+static void count_to_ten(Scheduler_Events_t events)
+{
+    runs.push_back({0, events});
+
+    if (runs.size() < 10)
+    {
+        scheduler_post(task_a, 0x1);
+    }
+    else
+    {
+        scheduler_stop();
+    }
+}
+
+static uint32_t num_idle_calls;
+
+static void count_idle()
+{
+    num_idle_calls++;
+
+    // nothing is pending after the first idle call, so post from here to start the task
+    if (num_idle_calls == 1)
+    {
+        scheduler_post(task_a, 0x1);
+    }
+}
+
+TEST_F(SchedulerTest, run_calls_the_idle_hook_when_there_is_nothing_to_run_and_returns_when_stopped)
+{
+    num_idle_calls = 0;
+    scheduler_add_task(count_to_ten, SCHEDULER_PRIORITY_NORMAL, &task_a);
+    scheduler_set_idle_hook(count_idle);
+
+    scheduler_run();
+
+    ASSERT_EQ(runs.size(), 10);
+    ASSERT_EQ(num_idle_calls, 1);
+}
+
+TEST_F(SchedulerTest, the_latency_of_a_backlog_counts_from_the_run_before)
+{
+    scheduler_add_task(handle_a, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    scheduler_post(task_a, 0x1);
+    scheduler_post(task_a, 0x1);
+    scheduler_tick(2);
+    ASSERT_TRUE(scheduler_run_once());
+    ASSERT_EQ(scheduler_get_max_latency_millisecs(task_a), 2);
+
+    // the second post has been waiting since the first run started
+    scheduler_tick(5);
+    ASSERT_TRUE(scheduler_run_once());
+    ASSERT_EQ(scheduler_get_max_latency_millisecs(task_a), 5);
+}
+
+TEST_F(SchedulerTest, no_events_are_lost_when_posted_from_another_thread)
+{
+    // each event is a bit, the other thread posts them in turn while the main loop runs the task
+    static Scheduler_Events_t seen;
+    seen = 0;
+
+    scheduler_add_task([](Scheduler_Events_t events) { seen |= events; }, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    std::thread poster([]() {
+        for (uint32_t i = 0; i < 32 * 1000; i++)
+        {
+            scheduler_post(task_a, 1u << (i % 32));
+        }
+    });
+
+    while (seen != UINT32_MAX)
+    {
+        scheduler_run_once();
+    }
+    poster.join();
+    run_until_idle();
+
+    ASSERT_EQ(seen, UINT32_MAX);
+}
+
+TEST_F(SchedulerTest, no_posts_are_lost_when_posted_from_another_thread)
+{
+    static uint32_t num_runs;
+    num_runs = 0;
+
+    scheduler_add_task([](Scheduler_Events_t events) { (void)events; num_runs++; }, SCHEDULER_PRIORITY_NORMAL, &task_a);
+
+    const uint32_t NUM_POSTS = 100000;
+    std::thread poster([NUM_POSTS]() {
+        for (uint32_t i = 0; i < NUM_POSTS; i++)
+        {
+            scheduler_post(task_a, 0x1);
+        }
+    });
+
+    while (num_runs < NUM_POSTS)
+    {
+        scheduler_run_once();
+    }
+    poster.join();
+
+    ASSERT_FALSE(scheduler_run_once());
+    ASSERT_EQ(num_runs, NUM_POSTS);
+}
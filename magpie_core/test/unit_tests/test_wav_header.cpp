@@ -0,0 +1,553 @@
+/**
+ * This test suite is a very glass-box view of the WAV header. While viewing or
+ * modifying this file it may help to have a WAV header refernece open, for
+ * example: https://docs.fileformat.com/audio/wav/
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "test_helpers.hpp"
+
+extern "C"
+{
+#include "wav_header.h"
+}
+
+/**
+ * @brief Enumerated starting positions for the various sections of a wav header are represented here.
+ */
+enum Wave_Header_Position_t
+{
+    POS_START_OF_RIFF = 0,
+    POS_START_OF_FILE_LEN_MINUS_8 = 4,
+    POS_START_OF_WAVE = 8,
+    POS_START_OF_FMT_ = 12,
+    POS_START_OF_FMT_CHUNK_SIZE = 16,
+    POS_START_OF_FMT_TAG = 20,
+    POS_START_OF_NUM_CHANNELS = 22,
+    POS_START_OF_SAMPLE_RATE = 24,
+    POS_START_OF_BYTES_PER_SEC = 28,
+    POS_START_OF_BYTES_PER_BLOCK = 32,
+    POS_START_OF_BITS_PER_SAMPLE = 34,
+    POS_START_OF_DATA_STR = 36,
+    POS_START_OF_DATA_LEN = 40,
+};
+
+// a handle to the wav header so we can use a slightly shorter name in the code
+static char *wav_header = wav_header_get_header();
+
+TEST(WavHeaderTest, header_length_is_44_bytes)
+{
+    ASSERT_EQ(wav_header_get_header_length(), 44);
+}
+
+TEST(WavHeaderTest, string_RIFF_is_at_the_start)
+{
+    ASSERT_EQ(wav_header[POS_START_OF_RIFF + 0], 'R');
+    ASSERT_EQ(wav_header[POS_START_OF_RIFF + 1], 'I');
+    ASSERT_EQ(wav_header[POS_START_OF_RIFF + 2], 'F');
+    ASSERT_EQ(wav_header[POS_START_OF_RIFF + 3], 'F');
+}
+
+TEST(WavHeaderTest, eight_is_subtracted_from_file_len)
+{
+    // just an arbitrary constant where it's easy to see if 8 has been subtracted
+    Wave_Header_Attributes_t attr = {.file_length = 12345678};
+    wav_header_set_attributes(&attr);
+
+    const uint32_t file_len_minus_8 = arr_slice_to_u32(wav_header, POS_START_OF_FILE_LEN_MINUS_8);
+
+    ASSERT_EQ(file_len_minus_8, 12345670); // should be 8 smaller than the one we originally set
+}
+
+TEST(WavHeaderTest, string_WAVE_is_in_the_right_spot)
+{
+    ASSERT_EQ(wav_header[POS_START_OF_WAVE + 0], 'W');
+    ASSERT_EQ(wav_header[POS_START_OF_WAVE + 1], 'A');
+    ASSERT_EQ(wav_header[POS_START_OF_WAVE + 2], 'V');
+    ASSERT_EQ(wav_header[POS_START_OF_WAVE + 3], 'E');
+}
+
+TEST(WavHeaderTest, string_fmt_is_in_the_right_spot)
+{
+    ASSERT_EQ(wav_header[POS_START_OF_FMT_ + 0], 'f');
+    ASSERT_EQ(wav_header[POS_START_OF_FMT_ + 1], 'm');
+    ASSERT_EQ(wav_header[POS_START_OF_FMT_ + 2], 't');
+    ASSERT_EQ(wav_header[POS_START_OF_FMT_ + 3], ' ');
+}
+
+TEST(WavHeaderTest, fmt_chunk_size_is_always_16)
+{
+    const uint32_t fmt_chunk_size = arr_slice_to_u32(wav_header, POS_START_OF_FMT_CHUNK_SIZE);
+    ASSERT_EQ(fmt_chunk_size, 16);
+}
+
+TEST(WavHeaderTest, fmt_tag_is_always_PCM)
+{
+    const uint16_t fmt_tag = arr_slice_to_u16(wav_header, POS_START_OF_FMT_TAG);
+    ASSERT_EQ(fmt_tag, 1); // 1 means PCM, other integer values represent other formats which we don't use
+}
+
+TEST(WavHeaderTest, num_channels_can_be_set)
+{
+    Wave_Header_Attributes_t attr = {.num_channels = WAVE_HEADER_MONO};
+    wav_header_set_attributes(&attr);
+
+    uint16_t num_channels = arr_slice_to_u16(wav_header, POS_START_OF_NUM_CHANNELS);
+    ASSERT_EQ(num_channels, 1);
+
+    attr.num_channels = WAVE_HEADER_STEREO;
+    wav_header_set_attributes(&attr);
+
+    num_channels = arr_slice_to_u16(wav_header, POS_START_OF_NUM_CHANNELS);
+    ASSERT_EQ(num_channels, 2);
+}
+
+TEST(WavHeaderTest, sample_rate_can_be_set)
+{
+    Wave_Header_Attributes_t attr = {.sample_rate = WAVE_HEADER_SAMPLE_RATE_24kHz};
+
+    wav_header_set_attributes(&attr);
+
+    uint32_t sample_rate = arr_slice_to_u32(wav_header, POS_START_OF_SAMPLE_RATE);
+    ASSERT_EQ(sample_rate, 24000);
+
+    attr.sample_rate = WAVE_HEADER_SAMPLE_RATE_48kHz;
+    wav_header_set_attributes(&attr);
+
+    sample_rate = arr_slice_to_u32(wav_header, POS_START_OF_SAMPLE_RATE);
+    ASSERT_EQ(sample_rate, 48000);
+
+    attr.sample_rate = WAVE_HEADER_SAMPLE_RATE_384kHz;
+    wav_header_set_attributes(&attr);
+
+    sample_rate = arr_slice_to_u32(wav_header, POS_START_OF_SAMPLE_RATE);
+    ASSERT_EQ(sample_rate, 384000);
+}
+
+TEST(WavHeaderTest, bytes_per_sec_is_calculated_and_set)
+{
+    // bytes per second depends on the num channels, the bit depth, and sample rate
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_STEREO,
+        .bits_per_sample = WAVE_HEADER_16_BITS_PER_SAMPLE,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_24kHz};
+    wav_header_set_attributes(&attr);
+
+    uint32_t bytes_per_sec = arr_slice_to_u32(wav_header, POS_START_OF_BYTES_PER_SEC);
+    ASSERT_EQ(bytes_per_sec, (2 * 16 * 24000) / 8);
+
+    attr.num_channels = WAVE_HEADER_MONO;
+    attr.bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE;
+    attr.sample_rate = WAVE_HEADER_SAMPLE_RATE_384kHz;
+    wav_header_set_attributes(&attr);
+
+    bytes_per_sec = arr_slice_to_u32(wav_header, POS_START_OF_BYTES_PER_SEC);
+    ASSERT_EQ(bytes_per_sec, (1 * 24 * 384000) / 8);
+}
+
+TEST(WavHeaderTest, bytes_per_block_is_calculated_and_set)
+{
+    // bytes per block relies on num channels and bit depth
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_STEREO,
+        .bits_per_sample = WAVE_HEADER_16_BITS_PER_SAMPLE};
+    wav_header_set_attributes(&attr);
+
+    uint32_t bytes_per_block = arr_slice_to_u16(wav_header, POS_START_OF_BYTES_PER_BLOCK);
+    ASSERT_EQ(bytes_per_block, 2 * 2);
+
+    attr.bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE;
+    wav_header_set_attributes(&attr);
+
+    bytes_per_block = arr_slice_to_u16(wav_header, POS_START_OF_BYTES_PER_BLOCK);
+    ASSERT_EQ(bytes_per_block, 2 * 3);
+
+    attr.num_channels = WAVE_HEADER_MONO;
+    attr.bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE;
+    wav_header_set_attributes(&attr);
+
+    bytes_per_block = arr_slice_to_u16(wav_header, POS_START_OF_BYTES_PER_BLOCK);
+    ASSERT_EQ(bytes_per_block, 1 * 3);
+}
+
+TEST(WavHeaderTest, bits_per_sample_is_set)
+{
+    Wave_Header_Attributes_t attr = {.bits_per_sample = WAVE_HEADER_16_BITS_PER_SAMPLE};
+    wav_header_set_attributes(&attr);
+
+    uint32_t bits_per_samp = arr_slice_to_u16(wav_header, POS_START_OF_BITS_PER_SAMPLE);
+    ASSERT_EQ(bits_per_samp, 16);
+
+    attr.bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE;
+    wav_header_set_attributes(&attr);
+
+    bits_per_samp = arr_slice_to_u16(wav_header, POS_START_OF_BITS_PER_SAMPLE);
+    ASSERT_EQ(bits_per_samp, 24);
+}
+
+TEST(WavHeaderTest, string_data_is_in_the_right_spot)
+{
+    ASSERT_EQ(wav_header[POS_START_OF_DATA_STR + 0], 'd');
+    ASSERT_EQ(wav_header[POS_START_OF_DATA_STR + 1], 'a');
+    ASSERT_EQ(wav_header[POS_START_OF_DATA_STR + 2], 't');
+    ASSERT_EQ(wav_header[POS_START_OF_DATA_STR + 3], 'a');
+}
+
+TEST(WavHeaderTest, data_size_does_not_include_header_len)
+{
+    /**
+     * When we set the file length field, this is the length of the whole file including the header itself. This is
+     * because it's easier to ask the FatFS library to give you the length of the whole file before updating the wav
+     * header. Hopwever, the internal field is the length of the data section only, not including the length of the
+     * header itself. The calculation is handled internally by the wav header module under test. This test verifies
+     * that when we set the file length, the data length is calculated correctly.
+     */
+    const uint32_t arbitrary_file_len = 100044; // should come out to 100k after the 44 bytes of the header are subtracted
+
+    Wave_Header_Attributes_t attr = {.file_length = arbitrary_file_len};
+    wav_header_set_attributes(&attr);
+
+    const uint32_t data_section_len = arr_slice_to_u32(wav_header, POS_START_OF_DATA_LEN);
+    ASSERT_EQ(data_section_len, arbitrary_file_len - wav_header_get_header_length());
+}
+TEST(WavHeaderTest, the_rf64_layout_is_80_bytes_and_only_used_when_enabled)
+{
+    wav_header_enable_rf64(true);
+    ASSERT_EQ(wav_header_get_header_length(), 80);
+
+    wav_header_enable_rf64(false);
+    ASSERT_EQ(wav_header_get_header_length(), 44);
+}
+
+TEST(WavHeaderTest, a_file_under_4GiB_with_the_rf64_layout_is_plain_riff_with_a_junk_chunk)
+{
+    wav_header_enable_rf64(true);
+
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_384kHz,
+        .file_length = 100080};
+    wav_header_set_attributes(&attr);
+
+    char *header = wav_header_get_header();
+
+    ASSERT_EQ(memcmp(header, "RIFF", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 4), 100072);
+    ASSERT_EQ(memcmp(header + 8, "WAVE", 4), 0);
+
+    // a JUNK chunk the size of a ds64 chunk, so the file can become RF64 without moving the audio
+    ASSERT_EQ(memcmp(header + 12, "JUNK", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 16), 28);
+
+    // the rest is the plain header, 36 bytes further in
+    ASSERT_EQ(memcmp(header + 48, "fmt ", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 48 + POS_START_OF_SAMPLE_RATE - POS_START_OF_FMT_), 384000);
+    ASSERT_EQ(memcmp(header + 72, "data", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 76), 100000);
+
+    wav_header_enable_rf64(false);
+}
+
+TEST(WavHeaderTest, a_file_over_4GiB_with_the_rf64_layout_has_its_sizes_in_the_ds64_chunk)
+{
+    wav_header_enable_rf64(true);
+
+    // an hour and a half of 384kHz 24 bit mono audio
+    const uint64_t data_len = 90ULL * 60 * 384000 * 3;
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_384kHz,
+        .file_length = 80 + data_len};
+    wav_header_set_attributes(&attr);
+
+    char *header = wav_header_get_header();
+
+    ASSERT_EQ(memcmp(header, "RF64", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 4), 0xFFFFFFFF);
+    ASSERT_EQ(memcmp(header + 12, "ds64", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 16), 28);
+
+    uint64_t riff_size, ds64_data_size, sample_count;
+    memcpy(&riff_size, header + 20, 8);
+    memcpy(&ds64_data_size, header + 28, 8);
+    memcpy(&sample_count, header + 36, 8);
+
+    ASSERT_EQ(riff_size, 80 + data_len - 8);
+    ASSERT_EQ(ds64_data_size, data_len);
+    ASSERT_EQ(sample_count, 90ULL * 60 * 384000);
+    ASSERT_EQ(arr_slice_to_u32(header, 44), 0); // no table of other chunk sizes
+
+    ASSERT_EQ(memcmp(header + 72, "data", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 76), 0xFFFFFFFF);
+
+    wav_header_enable_rf64(false);
+}
+
+TEST(WavHeaderTest, sizes_past_4GiB_saturate_in_the_plain_layout)
+{
+    Wave_Header_Attributes_t attr = {.file_length = 5000000000ULL};
+    wav_header_set_attributes(&attr);
+
+    ASSERT_EQ(arr_slice_to_u32(wav_header, POS_START_OF_FILE_LEN_MINUS_8), 0xFFFFFFFF);
+    ASSERT_EQ(arr_slice_to_u32(wav_header, POS_START_OF_DATA_LEN), 0xFFFFFFFF);
+    ASSERT_EQ(wav_header[0], 'R');
+    ASSERT_EQ(wav_header[3], 'F');
+}
+
+TEST(WavHeaderTest, the_bext_chunk_goes_between_WAVE_and_fmt_with_the_time_reference_split_in_two_words)
+{
+    wav_header_enable_bext(true);
+    ASSERT_EQ(wav_header_get_header_length(), 44 + 610);
+
+    // a bit after 1pm at 384kHz, big enough to need both words
+    const uint64_t time_reference = ((13ULL * 3600) + (2 * 60) + 3) * 384000 + 12345;
+    const Wave_Header_Broadcast_Attributes_t bext_attr = {
+        .year = 2024,
+        .month = 2,
+        .day = 29,
+        .hour = 13,
+        .minute = 2,
+        .second = 3,
+        .time_reference = time_reference,
+    };
+    wav_header_set_broadcast_attributes(&bext_attr);
+
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_16_BITS_PER_SAMPLE,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_384kHz,
+        .file_length = 654 + 1000};
+    wav_header_set_attributes(&attr);
+
+    char *header = wav_header_get_header();
+
+    ASSERT_EQ(memcmp(header, "RIFF", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 4), 654 + 1000 - 8);
+    ASSERT_EQ(memcmp(header + 12, "bext", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 16), 602);
+
+    const char *bext = header + 20;
+    ASSERT_EQ(memcmp(bext + 256, "Magpie", 6), 0);
+    ASSERT_EQ(memcmp(bext + 320, "2024-02-29", 10), 0);
+    ASSERT_EQ(memcmp(bext + 330, "13:02:03", 8), 0);
+    ASSERT_EQ(arr_slice_to_u32((char *)bext, 338), (uint32_t)time_reference);
+    ASSERT_EQ(arr_slice_to_u32((char *)bext, 342), (uint32_t)(time_reference >> 32));
+    ASSERT_EQ(arr_slice_to_u16((char *)bext, 346), 1);
+
+    ASSERT_EQ(memcmp(header + 622, "fmt ", 4), 0);
+    ASSERT_EQ(memcmp(header + 646, "data", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 650), 1000);
+
+    wav_header_enable_bext(false);
+    ASSERT_EQ(wav_header_get_header_length(), 44);
+}
+
+TEST(WavHeaderTest, the_ds64_chunk_comes_before_the_bext_chunk)
+{
+    wav_header_enable_rf64(true);
+    wav_header_enable_bext(true);
+    ASSERT_EQ(wav_header_get_header_length(), 44 + 36 + 610);
+
+    Wave_Header_Attributes_t attr = {.file_length = 690 + 100};
+    wav_header_set_attributes(&attr);
+
+    char *header = wav_header_get_header();
+    ASSERT_EQ(memcmp(header + 12, "JUNK", 4), 0);
+    ASSERT_EQ(memcmp(header + 48, "bext", 4), 0);
+    ASSERT_EQ(memcmp(header + 658, "fmt ", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 686), 100);
+
+    wav_header_enable_rf64(false);
+    wav_header_enable_bext(false);
+}
+
+TEST(WavHeaderTest, an_ima_adpcm_header_has_the_samples_per_block_and_a_fact_chunk_before_the_data)
+{
+    wav_header_enable_ima_adpcm(true);
+    ASSERT_EQ(wav_header_get_header_length(), 44 + 16);
+
+    // 10 blocks of 512 bytes, each holding 1017 samples
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_4_BITS_PER_SAMPLE_IMA_ADPCM,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_96kHz,
+        .file_length = 60 + 5120};
+    wav_header_set_attributes(&attr);
+    ASSERT_EQ(wav_header_get_block_align(&attr), 512);
+
+    char *header = wav_header_get_header();
+    ASSERT_EQ(arr_slice_to_u32(header, POS_START_OF_FILE_LEN_MINUS_8), 60 + 5120 - 8);
+    ASSERT_EQ(arr_slice_to_u32(header, POS_START_OF_FMT_CHUNK_SIZE), 20);
+    ASSERT_EQ(arr_slice_to_u16(header, POS_START_OF_FMT_TAG), 0x11);
+    ASSERT_EQ(arr_slice_to_u32(header, POS_START_OF_BYTES_PER_SEC), (96000 * 512) / 1017);
+    ASSERT_EQ(arr_slice_to_u16(header, POS_START_OF_BYTES_PER_BLOCK), 512);
+    ASSERT_EQ(arr_slice_to_u16(header, POS_START_OF_BITS_PER_SAMPLE), 4);
+    ASSERT_EQ(arr_slice_to_u16(header, 36), 2);
+    ASSERT_EQ(arr_slice_to_u16(header, 38), 1017);
+    ASSERT_EQ(memcmp(header + 40, "fact", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 44), 4);
+    ASSERT_EQ(arr_slice_to_u32(header, 48), 10 * 1017);
+    ASSERT_EQ(memcmp(header + 52, "data", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32(header, 56), 5120);
+
+    wav_header_enable_ima_adpcm(false);
+    ASSERT_EQ(wav_header_get_header_length(), 44);
+
+    // PCM headers go back to the short fmt chunk
+    attr.bits_per_sample = WAVE_HEADER_16_BITS_PER_SAMPLE;
+    attr.file_length = 44 + 100;
+    wav_header_set_attributes(&attr);
+    ASSERT_EQ(arr_slice_to_u32(wav_header_get_header(), POS_START_OF_FMT_CHUNK_SIZE), 16);
+    ASSERT_EQ(arr_slice_to_u16(wav_header_get_header(), POS_START_OF_FMT_TAG), 1);
+}
+
+/**
+ * @brief `header_for_file(a, f, b)` copies the header the module makes for a file of `f` bytes with attributes `a` into
+ * buffer `b`, so tests can treat it as the start of a file read back from the disk.
+ */
+static void header_for_file(Wave_Header_Attributes_t *attr, uint64_t file_len, uint8_t *buff)
+{
+    attr->file_length = file_len;
+    wav_header_set_attributes(attr);
+    memcpy(buff, wav_header_get_header(), wav_header_get_header_length());
+}
+
+TEST(WavHeaderTest, a_finished_file_needs_no_repair)
+{
+    uint8_t header[44];
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_48kHz};
+    header_for_file(&attr, 44 + 3000, header);
+
+    uint64_t repaired_len;
+    ASSERT_EQ(wav_header_repair(header, sizeof(header), 44 + 3000, &repaired_len), WAVE_HEADER_REPAIR_NOT_NEEDED);
+    ASSERT_EQ(repaired_len, 44 + 3000);
+
+    // chunks after the audio count towards the RIFF size, so they are left alone too
+    header_for_file(&attr, 44 + 3000 + 100, header);
+    ASSERT_EQ(wav_header_repair(header, sizeof(header), 44 + 3000 + 100, &repaired_len), WAVE_HEADER_REPAIR_NOT_NEEDED);
+}
+
+TEST(WavHeaderTest, a_file_shorter_than_its_header_says_is_cut_to_the_last_whole_sample_on_disk)
+{
+    uint8_t header[44];
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_48kHz};
+
+    // the final header was written up front but only 1000 bytes of audio made it to the disk, 333 whole samples
+    header_for_file(&attr, 44 + 3000, header);
+
+    uint64_t repaired_len;
+    ASSERT_EQ(wav_header_repair(header, sizeof(header), 44 + 1000, &repaired_len), WAVE_HEADER_REPAIR_REPAIRED);
+    ASSERT_EQ(repaired_len, 44 + 999);
+    ASSERT_EQ(arr_slice_to_u32((char *)header, POS_START_OF_FILE_LEN_MINUS_8), 44 + 999 - 8);
+    ASSERT_EQ(arr_slice_to_u32((char *)header, POS_START_OF_DATA_LEN), 999);
+
+    // once repaired the file is finished
+    ASSERT_EQ(wav_header_repair(header, sizeof(header), repaired_len, &repaired_len), WAVE_HEADER_REPAIR_NOT_NEEDED);
+}
+
+TEST(WavHeaderTest, a_pre_allocated_file_is_cut_to_its_last_checkpoint)
+{
+    uint8_t header[44 + 36 + 610];
+    wav_header_enable_rf64(true);
+    wav_header_enable_bext(true);
+
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_16_BITS_PER_SAMPLE,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_384kHz};
+
+    // the last checkpoint covered 2000 bytes of audio, the file on disk is as long as its allocation
+    header_for_file(&attr, 690 + 2000, header);
+
+    uint64_t repaired_len;
+    ASSERT_EQ(wav_header_repair(header, sizeof(header), 690 + 768000, &repaired_len), WAVE_HEADER_REPAIR_REPAIRED);
+    ASSERT_EQ(repaired_len, 690 + 2000);
+    ASSERT_EQ(arr_slice_to_u32((char *)header, 4), 690 + 2000 - 8);
+    ASSERT_EQ(arr_slice_to_u32((char *)header, 686), 2000);
+
+    wav_header_enable_rf64(false);
+    wav_header_enable_bext(false);
+}
+
+TEST(WavHeaderTest, an_rf64_file_is_repaired_in_its_ds64_chunk)
+{
+    uint8_t header[80];
+    wav_header_enable_rf64(true);
+
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_24_BITS_PER_SAMPLE,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_384kHz};
+
+    const uint64_t checkpoint_data_len = 5000000000ULL;
+    header_for_file(&attr, 80 + checkpoint_data_len, header);
+
+    uint64_t repaired_len;
+    ASSERT_EQ(wav_header_repair(header, sizeof(header), 80 + 6000000000ULL, &repaired_len), WAVE_HEADER_REPAIR_REPAIRED);
+
+    // cut back to whole samples
+    ASSERT_EQ(repaired_len, 80 + 4999999998ULL);
+
+    uint64_t riff_size, data_size, sample_count;
+    memcpy(&riff_size, header + 20, 8);
+    memcpy(&data_size, header + 28, 8);
+    memcpy(&sample_count, header + 36, 8);
+
+    ASSERT_EQ(memcmp(header, "RF64", 4), 0);
+    ASSERT_EQ(riff_size, 80 + 4999999998ULL - 8);
+    ASSERT_EQ(data_size, 4999999998ULL);
+    ASSERT_EQ(sample_count, 4999999998ULL / 3);
+    ASSERT_EQ(arr_slice_to_u32((char *)header, 76), 0xFFFFFFFF);
+
+    wav_header_enable_rf64(false);
+}
+
+TEST(WavHeaderTest, an_ima_adpcm_file_is_cut_to_whole_blocks_and_its_fact_chunk_fixed)
+{
+    uint8_t header[44 + 610 + 16];
+    wav_header_enable_bext(true);
+    wav_header_enable_ima_adpcm(true);
+
+    Wave_Header_Attributes_t attr = {
+        .num_channels = WAVE_HEADER_MONO,
+        .bits_per_sample = WAVE_HEADER_4_BITS_PER_SAMPLE_IMA_ADPCM,
+        .sample_rate = WAVE_HEADER_SAMPLE_RATE_24kHz};
+
+    // the final header was written up front for 20 blocks, but only 3 and a bit made it to the disk
+    header_for_file(&attr, sizeof(header) + (20 * 512), header);
+
+    uint64_t repaired_len;
+    ASSERT_EQ(wav_header_repair(header, sizeof(header), sizeof(header) + (3 * 512) + 100, &repaired_len), WAVE_HEADER_REPAIR_REPAIRED);
+    ASSERT_EQ(repaired_len, sizeof(header) + (3 * 512));
+    ASSERT_EQ(arr_slice_to_u32((char *)header, sizeof(header) - 4), 3 * 512);
+    ASSERT_EQ(memcmp(header + sizeof(header) - 20, "fact", 4), 0);
+    ASSERT_EQ(arr_slice_to_u32((char *)header, sizeof(header) - 12), 3 * 1017);
+
+    wav_header_enable_bext(false);
+    wav_header_enable_ima_adpcm(false);
+}
+
+TEST(WavHeaderTest, files_that_are_not_wave_files_are_not_repaired)
+{
+    uint8_t not_wave[44] = "this is not a wave file, just some text";
+
+    uint64_t repaired_len;
+    ASSERT_EQ(wav_header_repair(not_wave, sizeof(not_wave), 1000, &repaired_len), WAVE_HEADER_REPAIR_NOT_A_WAVE_FILE);
+    ASSERT_EQ(repaired_len, 1000);
+
+    // a header cut off before the data chunk can't be repaired either
+    uint8_t header[44];
+    Wave_Header_Attributes_t attr = {.file_length = 1044};
+    header_for_file(&attr, 1044, header);
+    ASSERT_EQ(wav_header_repair(header, 30, 30, &repaired_len), WAVE_HEADER_REPAIR_NOT_A_WAVE_FILE);
+}
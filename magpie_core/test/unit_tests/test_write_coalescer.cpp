@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+extern "C"
+{
+#include "write_coalescer.h"
+}
+
+using namespace testing;
+
+static const uint32_t UNIT = 16 * WRITE_COALESCER_SECTOR_LEN_IN_BYTES;
+
+// the file the coalesced writes go to, with the file position, and the position and length of each write
+static std::vector<uint8_t> file;
+static uint64_t file_pos;
+static std::vector<std::pair<uint64_t, uint32_t>> writes;
+
+// the write function fails from this write on
+static size_t failing_write = SIZE_MAX;
+
+static bool write_to_file(const uint8_t *buff, uint32_t len)
+{
+    if (writes.size() >= failing_write)
+    {
+        return false;
+    }
+
+    writes.push_back({file_pos, len});
+
+    if (file.size() < file_pos + len)
+    {
+        file.resize(file_pos + len);
+    }
+    std::copy(buff, buff + len, file.begin() + file_pos);
+    file_pos += len;
+
+    return true;
+}
+
+// `len` bytes counting up from `first_val`
+static std::vector<uint8_t> counting_bytes(uint32_t len, uint8_t first_val)
+{
+    std::vector<uint8_t> bytes(len);
+    for (uint32_t i = 0; i < len; i++)
+    {
+        bytes[i] = (uint8_t)(first_val + i);
+    }
+    return bytes;
+}
+
+class WriteCoalescerTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        file.clear();
+        file_pos = 0;
+        writes.clear();
+        failing_write = SIZE_MAX;
+        write_coalescer_start(write_to_file, UNIT, 0);
+    }
+
+    // writes `len` counting bytes through the coalescer, and appends them to `expected`
+    void write(uint32_t len)
+    {
+        const std::vector<uint8_t> bytes = counting_bytes(len, (uint8_t)expected.size());
+        ASSERT_TRUE(write_coalescer_write(bytes.data(), len));
+        expected.insert(expected.end(), bytes.begin(), bytes.end());
+    }
+
+    std::vector<uint8_t> expected;
+};
+
+TEST_F(WriteCoalescerTest, small_writes_are_gathered_into_whole_units)
+{
+    // a 24kHz 16 bit block
+    const uint32_t block_len = 2064;
+
+    for (int i = 0; i < 8; i++)
+    {
+        write(block_len);
+    }
+
+    ASSERT_THAT(writes, ElementsAre(Pair(0, UNIT), Pair(UNIT, UNIT)));
+    ASSERT_EQ(write_coalescer_num_buffered(), 8 * block_len - 2 * UNIT);
+
+    ASSERT_TRUE(write_coalescer_flush());
+    ASSERT_EQ(write_coalescer_num_buffered(), 0u);
+    ASSERT_THAT(writes.back(), Pair(2 * UNIT, 8 * block_len - 2 * UNIT));
+    ASSERT_EQ(file, expected);
+}
+
+TEST_F(WriteCoalescerTest, whole_units_of_a_long_write_are_not_copied)
+{
+    // a 384kHz 24 bit block after a header
+    write(44);
+    write(24768);
+    write(24768);
+
+    // the unit in the buffer is topped up and written, the whole units after it are one write, and the rest waits for
+    // the next unit to fill up
+    ASSERT_THAT(writes, ElementsAre(Pair(0, UNIT), Pair(UNIT, 2 * UNIT), Pair(3 * UNIT, UNIT), Pair(4 * UNIT, 2 * UNIT)));
+    ASSERT_EQ(write_coalescer_num_buffered(), 44 + (2 * 24768) - (6 * UNIT));
+
+    ASSERT_TRUE(write_coalescer_flush());
+    ASSERT_EQ(file, expected);
+}
+
+TEST_F(WriteCoalescerTest, every_write_but_a_flush_ends_on_a_unit_boundary)
+{
+    for (uint32_t len : {1u, 511u, 513u, UNIT - 1, UNIT, UNIT + 1, 3 * UNIT + 7, 2u})
+    {
+        write(len);
+    }
+    ASSERT_TRUE(write_coalescer_flush());
+
+    for (size_t i = 0; i + 1 < writes.size(); i++)
+    {
+        EXPECT_EQ((writes[i].first + writes[i].second) % UNIT, 0u) << "write " << i;
+    }
+    ASSERT_EQ(file, expected);
+}
+
+TEST_F(WriteCoalescerTest, units_line_up_with_the_start_of_the_file_after_a_seek)
+{
+    write_coalescer_start(write_to_file, UNIT, 1000);
+    file_pos = 1000;
+    expected.assign(1000, 0);
+
+    write(UNIT);
+
+    ASSERT_THAT(writes, ElementsAre(Pair(1000, UNIT - 1000)));
+    ASSERT_EQ(write_coalescer_num_buffered(), 1000u);
+}
+
+TEST_F(WriteCoalescerTest, unit_lengths_are_whole_sectors_and_capped)
+{
+    // rounded down to 2 sectors
+    write_coalescer_start(write_to_file, 1500, 0);
+    write(1500);
+    ASSERT_THAT(writes, ElementsAre(Pair(0, 1024)));
+
+    writes.clear();
+    file_pos = 0;
+    write_coalescer_start(write_to_file, 10 * WRITE_COALESCER_MAX_UNIT_LEN_IN_BYTES, 0);
+    write(WRITE_COALESCER_MAX_UNIT_LEN_IN_BYTES + 1);
+    ASSERT_THAT(writes, ElementsAre(Pair(0, WRITE_COALESCER_MAX_UNIT_LEN_IN_BYTES)));
+}
+
+TEST_F(WriteCoalescerTest, units_shorter_than_a_sector_turn_coalescing_off)
+{
+    write_coalescer_start(write_to_file, 0, 0);
+
+    write(44);
+    write(2064);
+
+    ASSERT_THAT(writes, ElementsAre(Pair(0, 44), Pair(44, 2064)));
+    ASSERT_EQ(write_coalescer_num_buffered(), 0u);
+    ASSERT_EQ(file, expected);
+}
+
+TEST_F(WriteCoalescerTest, a_failed_write_is_reported_and_drops_the_buffer)
+{
+    write(UNIT - 1);
+    failing_write = 0;
+
+    const std::vector<uint8_t> bytes = counting_bytes(2, 0);
+    ASSERT_FALSE(write_coalescer_write(bytes.data(), 2));
+    ASSERT_EQ(write_coalescer_num_buffered(), 0u);
+    ASSERT_TRUE(writes.empty());
+
+    // a failed flush empties the buffer too
+    failing_write = SIZE_MAX;
+    write(10);
+    failing_write = 0;
+    ASSERT_FALSE(write_coalescer_flush());
+    ASSERT_EQ(write_coalescer_num_buffered(), 0u);
+}
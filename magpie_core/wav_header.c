@@ -0,0 +1,468 @@
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "ima_adpcm.h"
+#include "wav_header.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Private defines ---------------------------------------------------------------------------------------------------*/
+
+// the fmt chunk of a PCM file ends at the bits_per_sample field, without the size of any extra fields
+#define WAVE_HEADER_FMT_CHUNK_SIZE (16)
+
+#define WAVE_HEADER_FMT_TAG_PCM (1)
+#define WAVE_HEADER_FMT_TAG_IMA_ADPCM (0x11)
+
+// the fmt chunk of an IMA ADPCM file has the size of the extra fields and the number of samples per block added on
+#define WAVE_HEADER_IMA_ADPCM_FMT_CHUNK_SIZE (20)
+#define WAVE_HEADER_IMA_ADPCM_FMT_EXTRA_SIZE (2)
+
+// the size of the fact chunk not counting its id and size fields, just the sample count
+#define WAVE_HEADER_FACT_CHUNK_SIZE (4)
+
+// the size of the ds64 chunk (and the JUNK chunk that holds its place) not counting its id and size fields, with an
+// empty table of chunk sizes, see EBU Tech 3306
+#define WAVE_HEADER_DS64_CHUNK_SIZE (28)
+
+// in an RF64 file the 32 bit sizes are set to this and the real sizes are in the ds64 chunk
+#define WAVE_HEADER_RF64_SIZE_IN_DS64 (0xFFFFFFFF)
+
+// the optional chunks go right after "WAVE", before the fmt chunk, the ds64 chunk must be the first of them
+#define WAVE_HEADER_EXTRA_CHUNKS_POSITION (12)
+
+// the size of the bext chunk not counting its id and size fields, with no coding history, see EBU Tech 3285
+#define WAVE_HEADER_BEXT_CHUNK_SIZE (602)
+
+// version 1 of the bext chunk adds the UMID, version 2 adds loudness values, which we don't measure
+#define WAVE_HEADER_BEXT_VERSION (1)
+
+#define WAVE_HEADER_BEXT_ORIGINATOR "Magpie"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief A structure for holding wav file header information is represented here.
+ *
+ * This can be cast to a char* and written directly to disk.
+ */
+typedef struct __attribute__((packed))
+{
+    char riff[4];              /* always the string "RIFF" */
+    uint32_t file_len_minus_8; /* file length in bytes - 8 bytes */
+    char wave[4];              /* always the string "WAVE" */
+    char fmt_[4];              /* always the string "fmt " (note the trailing space) */
+    uint32_t fmt_chunk_size;   /* size of FMT chunk in bytes, usually 16 or 18 */
+    uint16_t fmt_tag;          /* 1=PCM, 257=Mu-Law, 258=A-Law, 259=ADPCM  */
+    uint16_t num_channels;     /* 1=mono, 2=stereo */
+    uint32_t sample_rate;      /* samples per second */
+    uint32_t bytes_per_sec;    /* bytes per second = sample_rate * bytes_per_sample */
+    uint16_t bytes_per_block;  /* num channels * bytes per sample */
+    uint16_t bits_per_sample;  /* number of bits per sample */
+    char data[4];              /* always the string "data" */
+    uint32_t data_length;      /* data length in bytes (file_length - the length of this struct) */
+} Wave_Header_t;
+
+/**
+ * @brief A structure for holding the ds64 chunk of an RF64 file is represented here, it holds the 64 bit sizes that
+ * don't fit in the RIFF and data chunk sizes. Files that turn out smaller than 4GiB carry a JUNK chunk of the same size
+ * in its place instead, which every reader skips.
+ */
+typedef struct __attribute__((packed))
+{
+    char ds64[4];               /* the string "ds64", or "JUNK" in a plain RIFF file */
+    uint32_t chunk_size;        /* size of the rest of the chunk in bytes, always 28 */
+    uint64_t riff_size;         /* file length in bytes - 8 bytes */
+    uint64_t data_size;         /* data length in bytes */
+    uint64_t sample_count;      /* the number of samples in each channel */
+    uint32_t table_length;      /* the number of extra chunk sizes that follow, always 0 */
+} Wave_Header_DS64_Chunk_t;
+
+/**
+ * @brief A structure for holding the bext chunk of a Broadcast Wave file is represented here, the part we use is the
+ * time reference, which places the first sample of the file on the clock to the sample.
+ */
+typedef struct __attribute__((packed))
+{
+    char bext[4];                     /* always the string "bext" */
+    uint32_t chunk_size;              /* size of the rest of the chunk in bytes, always 602 */
+    char description[256];            /* free text, unused */
+    char originator[32];              /* the name of the device that made the file */
+    char originator_reference[32];    /* unused */
+    char origination_date[10];        /* "yyyy-mm-dd" */
+    char origination_time[8];         /* "hh:mm:ss" */
+    uint32_t time_reference_low;      /* the first sample of the file as a count of samples since midnight, low word */
+    uint32_t time_reference_high;     /* and the high word */
+    uint16_t version;                 /* the version of the bext chunk, always 1 */
+    uint8_t umid[64];                 /* SMPTE unique material identifier, unused */
+    uint8_t reserved[190];            /* always zero */
+} Wave_Header_Bext_Chunk_t;
+
+/**
+ * @brief A structure for holding what an IMA ADPCM file adds to the plain header is represented here, the end of the
+ * fmt chunk and the fact chunk that goes between it and the data chunk.
+ */
+typedef struct __attribute__((packed))
+{
+    uint16_t fmt_extra_size;    /* the size of the fmt chunk fields that follow, always 2 */
+    uint16_t samples_per_block; /* the number of samples in each block of bytes_per_block bytes */
+    char fact[4];               /* always the string "fact" */
+    uint32_t fact_chunk_size;   /* size of the rest of the chunk in bytes, always 4 */
+    uint32_t sample_count;      /* the number of samples in each channel, saturated in an RF64 file */
+} Wave_Header_IMA_ADPCM_Chunks_t;
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// we use one static instance of Wave_Header_t and update its fields using the wav_header_set_attributes(a) function
+static Wave_Header_t wave_header = {
+    // Some attributes of the wave header never change. We set them once here, and then never update them again.
+    // Other attributes (file length, sample rate, etc) do change dynamically via calls to wav_header_set_attributes(a)
+    .riff = {'R', 'I', 'F', 'F'},
+    .wave = {'W', 'A', 'V', 'E'},
+    .fmt_ = {'f', 'm', 't', ' '},
+    .fmt_chunk_size = WAVE_HEADER_FMT_CHUNK_SIZE,
+    .fmt_tag = WAVE_HEADER_FMT_TAG_PCM,
+    .data = {'d', 'a', 't', 'a'},
+};
+
+static Wave_Header_DS64_Chunk_t ds64_chunk = {
+    .chunk_size = WAVE_HEADER_DS64_CHUNK_SIZE,
+    .table_length = 0,
+};
+
+static Wave_Header_Bext_Chunk_t bext_chunk = {
+    .bext = {'b', 'e', 'x', 't'},
+    .chunk_size = WAVE_HEADER_BEXT_CHUNK_SIZE,
+    .originator = WAVE_HEADER_BEXT_ORIGINATOR,
+    .version = WAVE_HEADER_BEXT_VERSION,
+};
+
+static Wave_Header_IMA_ADPCM_Chunks_t ima_adpcm_chunks = {
+    .fmt_extra_size = WAVE_HEADER_IMA_ADPCM_FMT_EXTRA_SIZE,
+    .samples_per_block = IMA_ADPCM_SAMPLES_PER_BLOCK,
+    .fact = {'f', 'a', 'c', 't'},
+    .fact_chunk_size = WAVE_HEADER_FACT_CHUNK_SIZE,
+};
+
+// the header with the optional chunks, put together from the structs above by assemble_extended_header()
+static char extended_header[sizeof(Wave_Header_t) + sizeof(Wave_Header_DS64_Chunk_t) + sizeof(Wave_Header_Bext_Chunk_t) +
+                            sizeof(Wave_Header_IMA_ADPCM_Chunks_t)];
+
+static bool is_rf64_enabled = false;
+static bool is_bext_enabled = false;
+static bool is_ima_adpcm_enabled = false;
+
+const uint32_t HEADER_LENGTH = sizeof(wave_header);
+
+/* Private function declarations -------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `saturate_to_u32(x)` is `x` if it fits in 32 bits, else the biggest 32 bit value.
+ */
+static uint32_t saturate_to_u32(uint64_t x);
+
+/**
+ * @brief `read_u16(b)`, `read_u32(b)`, and `read_u64(b)` are the integers stored at `b`, which need not be aligned,
+ * and `write_u32(b, x)` and `write_u64(b, x)` store `x` at `b` the same way. Like the header structs, these use the
+ * byte order of the processor, which is little endian just like the file format.
+ */
+static uint16_t read_u16(const uint8_t *buff);
+static uint32_t read_u32(const uint8_t *buff);
+static uint64_t read_u64(const uint8_t *buff);
+static void write_u32(uint8_t *buff, uint32_t x);
+static void write_u64(uint8_t *buff, uint64_t x);
+
+/**
+ * @brief `num_samples_in_data(l, b, s)` is the number of samples in `l` bytes of audio data made of blocks of `b` bytes
+ * that hold `s` samples each, only counting whole blocks.
+ */
+static uint64_t num_samples_in_data(uint64_t data_len, uint32_t bytes_per_block, uint32_t samples_per_block);
+
+/**
+ * @brief `assemble_extended_header()` puts the plain header and the enabled optional chunks together into the extended
+ * header buffer, in the order they go in the file.
+ */
+static void assemble_extended_header();
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void wav_header_enable_rf64(bool enable)
+{
+    is_rf64_enabled = enable;
+}
+
+void wav_header_enable_bext(bool enable)
+{
+    is_bext_enabled = enable;
+}
+
+void wav_header_enable_ima_adpcm(bool enable)
+{
+    is_ima_adpcm_enabled = enable;
+}
+
+void wav_header_set_broadcast_attributes(const Wave_Header_Broadcast_Attributes_t *attributes)
+{
+    // one longer than each field for the string terminator, which doesn't go in the file
+    char date_buff[sizeof(bext_chunk.origination_date) + 1];
+    char time_buff[sizeof(bext_chunk.origination_time) + 1];
+
+    snprintf(date_buff, sizeof(date_buff), "%04u-%02u-%02u", attributes->year % 10000u, attributes->month % 100u, attributes->day % 100u);
+    snprintf(time_buff, sizeof(time_buff), "%02u:%02u:%02u", attributes->hour % 100u, attributes->minute % 100u, attributes->second % 100u);
+
+    memcpy(bext_chunk.origination_date, date_buff, sizeof(bext_chunk.origination_date));
+    memcpy(bext_chunk.origination_time, time_buff, sizeof(bext_chunk.origination_time));
+    bext_chunk.time_reference_low = (uint32_t)attributes->time_reference;
+    bext_chunk.time_reference_high = (uint32_t)(attributes->time_reference >> 32);
+
+    assemble_extended_header();
+}
+
+void wav_header_set_attributes(Wave_Header_Attributes_t *attributes)
+{
+    const uint64_t data_length = attributes->file_length - wav_header_get_header_length();
+
+    const uint32_t samples_per_block = is_ima_adpcm_enabled ? IMA_ADPCM_SAMPLES_PER_BLOCK : 1;
+
+    wave_header.fmt_chunk_size = is_ima_adpcm_enabled ? WAVE_HEADER_IMA_ADPCM_FMT_CHUNK_SIZE : WAVE_HEADER_FMT_CHUNK_SIZE;
+    wave_header.fmt_tag = is_ima_adpcm_enabled ? WAVE_HEADER_FMT_TAG_IMA_ADPCM : WAVE_HEADER_FMT_TAG_PCM;
+    wave_header.num_channels = attributes->num_channels;
+    wave_header.sample_rate = attributes->sample_rate;
+    wave_header.bytes_per_block = wav_header_get_block_align(attributes);
+    wave_header.bytes_per_sec = (uint32_t)(((uint64_t)wave_header.bytes_per_block * wave_header.sample_rate) / samples_per_block);
+    wave_header.bits_per_sample = attributes->bits_per_sample;
+
+    const uint64_t sample_count = num_samples_in_data(data_length, wave_header.bytes_per_block, samples_per_block);
+
+    // a plain RIFF file can't say how big it is past 4GiB, saturating the sizes at least tells readers to read to the end
+    const bool is_rf64 = is_rf64_enabled && attributes->file_length - 8 > UINT32_MAX;
+
+    memcpy(wave_header.riff, is_rf64 ? "RF64" : "RIFF", sizeof(wave_header.riff));
+    wave_header.file_len_minus_8 = is_rf64 ? WAVE_HEADER_RF64_SIZE_IN_DS64 : saturate_to_u32(attributes->file_length - 8);
+    wave_header.data_length = is_rf64 ? WAVE_HEADER_RF64_SIZE_IN_DS64 : saturate_to_u32(data_length);
+
+    if (is_rf64_enabled)
+    {
+        memcpy(ds64_chunk.ds64, is_rf64 ? "ds64" : "JUNK", sizeof(ds64_chunk.ds64));
+        ds64_chunk.riff_size = is_rf64 ? attributes->file_length - 8 : 0;
+        ds64_chunk.data_size = is_rf64 ? data_length : 0;
+        ds64_chunk.sample_count = is_rf64 ? sample_count : 0;
+    }
+
+    ima_adpcm_chunks.sample_count = saturate_to_u32(sample_count);
+
+    assemble_extended_header();
+}
+
+char *wav_header_get_header()
+{
+    // cast the struct as an array of bytes so we can write it directly to the SD card
+    return (is_rf64_enabled || is_bext_enabled || is_ima_adpcm_enabled) ? extended_header : (char *)&wave_header;
+}
+
+uint32_t wav_header_get_header_length()
+{
+    return HEADER_LENGTH + (is_rf64_enabled ? sizeof(ds64_chunk) : 0) + (is_bext_enabled ? sizeof(bext_chunk) : 0) +
+           (is_ima_adpcm_enabled ? sizeof(ima_adpcm_chunks) : 0);
+}
+
+uint32_t wav_header_get_block_align(const Wave_Header_Attributes_t *attributes)
+{
+    if (attributes->bits_per_sample == WAVE_HEADER_4_BITS_PER_SAMPLE_IMA_ADPCM)
+    {
+        return IMA_ADPCM_BLOCK_LEN_IN_BYTES * attributes->num_channels;
+    }
+
+    return (attributes->bits_per_sample / 8) * attributes->num_channels;
+}
+
+Wave_Header_Repair_Result_t wav_header_repair(uint8_t *header, uint32_t header_len, uint64_t file_len, uint64_t *repaired_file_len)
+{
+    *repaired_file_len = file_len;
+
+    if (header_len < WAVE_HEADER_EXTRA_CHUNKS_POSITION || memcmp(header + 8, "WAVE", 4) != 0)
+    {
+        return WAVE_HEADER_REPAIR_NOT_A_WAVE_FILE;
+    }
+
+    const bool is_rf64 = memcmp(header, "RF64", 4) == 0;
+    if (!is_rf64 && memcmp(header, "RIFF", 4) != 0)
+    {
+        return WAVE_HEADER_REPAIR_NOT_A_WAVE_FILE;
+    }
+
+    // walk the chunks up to the data chunk, picking up the ds64 chunk, the fact chunk, and the block size on the way
+    uint32_t ds64_pos = 0;
+    uint32_t fact_pos = 0;
+    uint32_t data_pos = 0;
+    uint16_t bytes_per_block = 0;
+    uint16_t samples_per_block = 1;
+
+    for (uint64_t pos = WAVE_HEADER_EXTRA_CHUNKS_POSITION; pos + 8 <= header_len;)
+    {
+        const uint8_t *chunk = header + pos;
+        const uint32_t chunk_size = read_u32(chunk + 4);
+
+        if (memcmp(chunk, "ds64", 4) == 0 && pos + sizeof(Wave_Header_DS64_Chunk_t) <= header_len)
+        {
+            ds64_pos = (uint32_t)pos;
+        }
+        else if (memcmp(chunk, "fmt ", 4) == 0 && pos + 8 + WAVE_HEADER_FMT_CHUNK_SIZE <= header_len)
+        {
+            bytes_per_block = read_u16(chunk + 8 + 12);
+
+            if (read_u16(chunk + 8) == WAVE_HEADER_FMT_TAG_IMA_ADPCM && chunk_size >= WAVE_HEADER_IMA_ADPCM_FMT_CHUNK_SIZE &&
+                pos + 8 + WAVE_HEADER_IMA_ADPCM_FMT_CHUNK_SIZE <= header_len)
+            {
+                samples_per_block = read_u16(chunk + 8 + WAVE_HEADER_FMT_CHUNK_SIZE + 2);
+            }
+        }
+        else if (memcmp(chunk, "fact", 4) == 0 && pos + 8 + WAVE_HEADER_FACT_CHUNK_SIZE <= header_len)
+        {
+            fact_pos = (uint32_t)pos;
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            data_pos = (uint32_t)pos;
+            break;
+        }
+
+        // chunks are padded to an even length
+        pos += 8 + (uint64_t)chunk_size + (chunk_size & 1);
+    }
+
+    if (data_pos == 0 || (is_rf64 && ds64_pos == 0))
+    {
+        return WAVE_HEADER_REPAIR_NOT_A_WAVE_FILE;
+    }
+
+    uint8_t *ds64 = header + ds64_pos;
+    const uint64_t riff_size = is_rf64 ? read_u64(ds64 + offsetof(Wave_Header_DS64_Chunk_t, riff_size)) : read_u32(header + 4);
+    const uint64_t data_size = is_rf64 ? read_u64(ds64 + offsetof(Wave_Header_DS64_Chunk_t, data_size)) : read_u32(header + data_pos + 4);
+
+    // a finished file is as long as the RIFF size says, any chunks after the audio included. A plain file past 4GiB has
+    // saturated sizes that only tell readers to read to the end, there's nothing more to go on
+    if (riff_size + 8 == file_len || (!is_rf64 && riff_size == UINT32_MAX))
+    {
+        return WAVE_HEADER_REPAIR_NOT_NEEDED;
+    }
+
+    const uint64_t data_start = (uint64_t)data_pos + 8;
+    const uint64_t data_on_disk = file_len > data_start ? file_len - data_start : 0;
+
+    uint64_t good_data_size = data_size < data_on_disk ? data_size : data_on_disk;
+    if (bytes_per_block != 0)
+    {
+        good_data_size -= good_data_size % bytes_per_block;
+    }
+
+    *repaired_file_len = data_start + good_data_size;
+
+    const uint64_t good_sample_count = num_samples_in_data(good_data_size, bytes_per_block, samples_per_block);
+
+    if (fact_pos != 0)
+    {
+        write_u32(header + fact_pos + 8, saturate_to_u32(good_sample_count));
+    }
+
+    if (is_rf64)
+    {
+        // the 32 bit sizes stay at 0xFFFFFFFF, pointing at the ds64 chunk
+        write_u64(ds64 + offsetof(Wave_Header_DS64_Chunk_t, riff_size), *repaired_file_len - 8);
+        write_u64(ds64 + offsetof(Wave_Header_DS64_Chunk_t, data_size), good_data_size);
+        write_u64(ds64 + offsetof(Wave_Header_DS64_Chunk_t, sample_count), good_sample_count);
+    }
+    else
+    {
+        // the header claimed no more than 4GiB, so the repaired sizes fit too
+        write_u32(header + 4, (uint32_t)(*repaired_file_len - 8));
+        write_u32(header + data_pos + 4, (uint32_t)good_data_size);
+    }
+
+    return WAVE_HEADER_REPAIR_REPAIRED;
+}
+
+/* Private function definitions --------------------------------------------------------------------------------------*/
+
+uint32_t saturate_to_u32(uint64_t x)
+{
+    return x > UINT32_MAX ? UINT32_MAX : (uint32_t)x;
+}
+
+uint16_t read_u16(const uint8_t *buff)
+{
+    uint16_t x;
+    memcpy(&x, buff, sizeof(x));
+    return x;
+}
+
+uint32_t read_u32(const uint8_t *buff)
+{
+    uint32_t x;
+    memcpy(&x, buff, sizeof(x));
+    return x;
+}
+
+uint64_t read_u64(const uint8_t *buff)
+{
+    uint64_t x;
+    memcpy(&x, buff, sizeof(x));
+    return x;
+}
+
+void write_u32(uint8_t *buff, uint32_t x)
+{
+    memcpy(buff, &x, sizeof(x));
+}
+
+void write_u64(uint8_t *buff, uint64_t x)
+{
+    memcpy(buff, &x, sizeof(x));
+}
+
+uint64_t num_samples_in_data(uint64_t data_len, uint32_t bytes_per_block, uint32_t samples_per_block)
+{
+    return bytes_per_block != 0 ? (data_len / bytes_per_block) * samples_per_block : 0;
+}
+
+void assemble_extended_header()
+{
+    if (!is_rf64_enabled && !is_bext_enabled && !is_ima_adpcm_enabled)
+    {
+        return;
+    }
+
+    // "RIFF", the size, and "WAVE", then the optional chunks, then the rest of the plain header from "fmt " on
+    char *pos = extended_header;
+
+    memcpy(pos, &wave_header, WAVE_HEADER_EXTRA_CHUNKS_POSITION);
+    pos += WAVE_HEADER_EXTRA_CHUNKS_POSITION;
+
+    if (is_rf64_enabled)
+    {
+        memcpy(pos, &ds64_chunk, sizeof(ds64_chunk));
+        pos += sizeof(ds64_chunk);
+    }
+
+    if (is_bext_enabled)
+    {
+        memcpy(pos, &bext_chunk, sizeof(bext_chunk));
+        pos += sizeof(bext_chunk);
+    }
+
+    // the IMA ADPCM fields carry on the fmt chunk, and the fact chunk follows it, so they go in before "data"
+    const size_t data_chunk_position = offsetof(Wave_Header_t, data);
+
+    memcpy(pos, (char *)&wave_header + WAVE_HEADER_EXTRA_CHUNKS_POSITION, data_chunk_position - WAVE_HEADER_EXTRA_CHUNKS_POSITION);
+    pos += data_chunk_position - WAVE_HEADER_EXTRA_CHUNKS_POSITION;
+
+    if (is_ima_adpcm_enabled)
+    {
+        memcpy(pos, &ima_adpcm_chunks, sizeof(ima_adpcm_chunks));
+        pos += sizeof(ima_adpcm_chunks);
+    }
+
+    memcpy(pos, (char *)&wave_header + data_chunk_position, sizeof(wave_header) - data_chunk_position);
+}
@@ -0,0 +1,245 @@
+/**
+ * @file    wav_header.h
+ * @brief   A software module for generating WAVE file headers is represented here.
+ * @details WAVE is a specific format for writing audio files. WAVE headers contain information about the audio sample
+ * rate, bit depth, file size, and other metadata.
+ *
+ * We can configure WAVE headers with 4 pieces of information:
+ * - Mono/stereo
+ * - Bits per sample
+ * - Sample rate
+ * - Total file length
+ *
+ * Other internal fields can be derived from the above 4 numbers.
+ *
+ * The file length field is the total size of the entire file, and includes the size of the header itself.
+ * Because of this, it is common to write a file like this:
+ * 1) open a new file for writing
+ * 2) advance the write pointer by the size of the wave header so the audio data starts right after the header
+ * 3) write all the audio data
+ * 4) save the size of the file into the file_length field of a Wave_Header_Attributes_t variable
+ *      a) the size we just saved includes both the audio data and the (currently blank) header
+ * 5) reset the write pointer back to the top of the file
+ * 6) use the Wave_Header_Attributes_t variable to set the wave attributes, including the total file size just set
+ * 7) write the wave header
+ * 8) close the file
+ *
+ * In code it would look something like this (psuedocode, some args omitted for clarity):
+ * 1) f_open(my_file_name);
+ * 2) f_lseek(wav_header_get_header_length());
+ * 3) f_write(audio_buffer, audio_buffer_size);
+ *    ... potentially more rounds of writing audio data to the SD card
+ * 4) wav_attributes.file_length = f_size();
+ * 5) f_lseek(0);
+ * 6) wav_header_set_attributes(&wav_attributes);
+ * 7) f_write(wav_header_get_header(), wav_header_get_header_length());
+ * 8) f_close();
+ *
+ * The other wave header attributes may be set at the same time as the total file length, or set at an earlier time.
+ *
+ * The sizes in a plain WAVE header are 32 bits, so files that might grow past 4GiB (a little over an hour of 384kHz 24
+ * bit mono audio) should use the RF64 layout, see `wav_header_enable_rf64()`.
+ *
+ * IMA ADPCM files need a longer fmt chunk and a fact chunk with the number of samples, see
+ * `wav_header_enable_ima_adpcm()`.
+ */
+
+#ifndef WAV_HEADER_H_
+#define WAV_HEADER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief Enumerated wave header options for number of channels are represented here.
+ */
+typedef enum
+{
+    WAVE_HEADER_MONO = 1,
+    WAVE_HEADER_STEREO = 2,
+} Wave_Header_Num_Channels_t;
+
+/**
+ * @brief Enumerated wave header options for bits per sample are represented here.
+ */
+typedef enum
+{
+    WAVE_HEADER_16_BITS_PER_SAMPLE = 16,
+    WAVE_HEADER_24_BITS_PER_SAMPLE = 24,
+    WAVE_HEADER_4_BITS_PER_SAMPLE_IMA_ADPCM = 4, /** 16 bit samples compressed 4:1 with IMA ADPCM, see `ima_adpcm.h` */
+} Wave_Header_Bits_Per_Sample_t;
+
+/**
+ * @brief Enumerated wave header sample rates are represented here.
+ */
+typedef enum
+{
+    WAVE_HEADER_SAMPLE_RATE_8kHz = 8000,
+    WAVE_HEADER_SAMPLE_RATE_16kHz = 16000,
+    WAVE_HEADER_SAMPLE_RATE_24kHz = 24000,
+    WAVE_HEADER_SAMPLE_RATE_32kHz = 32000,
+    WAVE_HEADER_SAMPLE_RATE_48kHz = 48000,
+    WAVE_HEADER_SAMPLE_RATE_96kHz = 96000,
+    WAVE_HEADER_SAMPLE_RATE_192kHz = 192000,
+    WAVE_HEADER_SAMPLE_RATE_384kHz = 384000,
+} Wave_Header_Sample_Rate_t;
+
+/**
+ * @brief A structure for holding the configurable wave header attributes is represented here.
+ */
+typedef struct
+{
+    Wave_Header_Num_Channels_t num_channels;       /** The enumerated number of channels */
+    Wave_Header_Bits_Per_Sample_t bits_per_sample; /** Enumerated bits per sample */
+    Wave_Header_Sample_Rate_t sample_rate;         /** The sample rate in Hz */
+    uint64_t file_length;                          /** The total file length, including the length of the header */
+} Wave_Header_Attributes_t;
+
+/**
+ * @brief A structure for holding the Broadcast Wave attributes of a file is represented here, they go in the bext chunk.
+ */
+typedef struct
+{
+    uint16_t year;           /** The date and time the first sample of the file was recorded, year e.g. 2024 */
+    uint8_t month;           /** Month in [1..12] */
+    uint8_t day;             /** Day of the month in [1..31] */
+    uint8_t hour;            /** Hour in [0..23] */
+    uint8_t minute;          /** Minute in [0..59] */
+    uint8_t second;          /** Second in [0..59] */
+    uint64_t time_reference; /** The first sample of the file as a count of samples since midnight */
+} Wave_Header_Broadcast_Attributes_t;
+
+/**
+ * @brief Enumerated results of checking the header of a file on disk with `wav_header_repair()` are represented here.
+ */
+typedef enum
+{
+    WAVE_HEADER_REPAIR_NOT_NEEDED,     /** The header agrees with the length of the file */
+    WAVE_HEADER_REPAIR_REPAIRED,       /** The sizes in the header were fixed, the file must be cut to the new length */
+    WAVE_HEADER_REPAIR_NOT_A_WAVE_FILE, /** The header isn't one we can make sense of, the file is best left alone */
+} Wave_Header_Repair_Result_t;
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `wav_header_enable_rf64(e)` selects the header layout, the plain header if `e` is false (the default), or one
+ * with 36 more bytes of room for a ds64 chunk if `e` is true, for files that may grow past 4GiB.
+ *
+ * With room for the ds64 chunk, a file under 4GiB is an ordinary RIFF file with a JUNK chunk that readers skip, while a
+ * bigger file is an RF64 file (EBU Tech 3306) with the 64 bit sizes in the ds64 chunk. Either way the audio data starts
+ * at the same offset, so the choice can be made when the file is finished.
+ *
+ * @pre no file is being written with the other layout, the header length changes with the layout.
+ *
+ * @param enable true for the RF64 capable layout, false for the plain 44 byte header
+ *
+ * @post `wav_header_get_header_length()` is the length of the selected layout, and the next call to
+ * `wav_header_set_attributes(a)` fills it in.
+ */
+void wav_header_enable_rf64(bool enable);
+
+/**
+ * @brief `wav_header_enable_bext(e)` adds a 610 byte bext chunk to the header if `e` is true, making the file a
+ * Broadcast Wave file (EBU Tech 3285) that says when its first sample was recorded, to the sample. Off by default.
+ *
+ * @pre no file is being written with the other setting, the header length changes with it.
+ *
+ * @param enable true to add the bext chunk, false to leave it out
+ *
+ * @post `wav_header_get_header_length()` includes the bext chunk if enabled, and the next call to
+ * `wav_header_set_broadcast_attributes(a)` fills it in.
+ */
+void wav_header_enable_bext(bool enable);
+
+/**
+ * @brief `wav_header_enable_ima_adpcm(e)` selects the header of an IMA ADPCM file (format tag 0x11) if `e` is true, or
+ * of a PCM file if `e` is false (the default). The fmt chunk of an IMA ADPCM file also gives the number of samples in
+ * each block of `IMA_ADPCM_BLOCK_LEN_IN_BYTES`, and a fact chunk after it gives the number of samples in the file,
+ * which the sizes alone don't tell for compressed audio.
+ *
+ * @pre no file is being written with the other setting, the header length changes with it.
+ *
+ * @param enable true for IMA ADPCM, used with attributes of `WAVE_HEADER_4_BITS_PER_SAMPLE_IMA_ADPCM`, false for PCM
+ *
+ * @post `wav_header_get_header_length()` includes the longer fmt chunk and the fact chunk if enabled, and the next call
+ * to `wav_header_set_attributes(a)` fills them in.
+ */
+void wav_header_enable_ima_adpcm(bool enable);
+
+/**
+ * @brief `wav_header_set_broadcast_attributes(a)` sets the origination date, time, and time reference of the bext chunk
+ * to the values in `a`.
+ *
+ * @param attributes the Broadcast Wave attributes to use
+ *
+ * @post the next time `wav_header_get_header()` is called, the bext chunk holds the values from `attributes`.
+ */
+void wav_header_set_broadcast_attributes(const Wave_Header_Broadcast_Attributes_t *attributes);
+
+/**
+ * @brief `wav_header_set_attributes(a)` sets the wave header attributes to the values contained in `a`.
+ *
+ * @param attributes the wave header attributes to use
+ *
+ * @post the values of the wave header are set to the given attributes. The next time `wave_header_get_header()` is
+ * called, the fields will be updated with the values from the input parameter `attributes`
+ */
+void wav_header_set_attributes(Wave_Header_Attributes_t *attributes);
+
+/**
+ * @brief `wav_header_get_header()` is a pointer to the wave header with the most recent set attributes applied.
+ *
+ * @pre `wav_header_set_attributes(a)` has been called with a valid set of attributes in `a`.
+ *
+ * @return pointer to the array of bytes that comprise the wave header with all attributes set. The length of the
+ * header is given by `wav_header_get_header_length()`
+ */
+char *wav_header_get_header();
+
+/**
+ * @brief `wav_header_get_header_length()` is the length in bytes of the wave header, 44 bytes, plus 36 bytes with the
+ * RF64 layout, plus 610 bytes with the bext chunk, plus 16 bytes for IMA ADPCM. This only changes when the layout is
+ * changed with `wav_header_enable_rf64(e)`, `wav_header_enable_bext(e)`, or `wav_header_enable_ima_adpcm(e)`.
+ */
+uint32_t wav_header_get_header_length();
+
+/**
+ * @brief `wav_header_get_block_align(a)` is the number of bytes in each block of the audio data of a file with
+ * attributes `a`, the nBlockAlign of the fmt chunk. Readers never split a block, so files should only ever be cut to a
+ * whole number of them.
+ *
+ * @retval one sample for each channel for PCM, or `IMA_ADPCM_BLOCK_LEN_IN_BYTES` for IMA ADPCM
+ */
+uint32_t wav_header_get_block_align(const Wave_Header_Attributes_t *attributes);
+
+/**
+ * @brief `wav_header_repair(h, n, s, l)` checks the header in the first `n` bytes `h` of a WAVE or RF64 file that is `s`
+ * bytes long on disk. If the header doesn't account for exactly `s` bytes, e.g. after a power cut in the middle of a
+ * recording, the sizes in `h` are fixed to cover only the whole samples both the header and the disk agree on, and the
+ * length the file must be cut to is stored in `l`.
+ *
+ * A file that was never finished either claims more audio than made it to the disk, or, if it was pre-allocated, is as
+ * long as its allocation with only the audio up to the last header checkpoint known to be good. Both come down to
+ * keeping the lesser of the two. The header does not need to be one this module wrote, any chunks are skipped on the
+ * way to the data chunk, but it must contain the data chunk header. The sample count of an IMA ADPCM file's fact chunk
+ * is fixed along with the sizes.
+ *
+ * @param header the start of the file, it is changed in place if it needs repairing
+ *
+ * @param header_len the number of bytes in `header`, at most the length of the file
+ *
+ * @param file_len the length of the file on disk in bytes
+ *
+ * @param repaired_file_len where to store the length the file must be cut to, `file_len` if it needs no repair
+ *
+ * @retval `WAVE_HEADER_REPAIR_REPAIRED` if `header` was fixed and must be written back before the file is cut to
+ * `repaired_file_len`, `WAVE_HEADER_REPAIR_NOT_NEEDED` if the file is fine, or `WAVE_HEADER_REPAIR_NOT_A_WAVE_FILE` if
+ * the header isn't recognized
+ */
+Wave_Header_Repair_Result_t wav_header_repair(uint8_t *header, uint32_t header_len, uint64_t file_len, uint64_t *repaired_file_len);
+
+#endif /* WAV_HEADER_H_ */
@@ -0,0 +1,98 @@
+
+/* Private includes --------------------------------------------------------------------------------------------------*/
+
+#include "write_coalescer.h"
+
+#include <stddef.h> // for NULL
+#include <string.h> // for memcpy
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+
+// the bytes of the unit the file position is in, from the file position up to the end of the unit at most
+static uint8_t unit_buff[WRITE_COALESCER_MAX_UNIT_LEN_IN_BYTES];
+static uint32_t num_buffered = 0;
+
+static Write_Coalescer_Write_Fn_t write_fn = NULL;
+
+// 0 when coalescing is off
+static uint32_t unit_len = 0;
+
+// the position within its unit of the byte after the buffered ones
+static uint32_t pos_in_unit = 0;
+
+/* Public function definitions ---------------------------------------------------------------------------------------*/
+
+void write_coalescer_start(Write_Coalescer_Write_Fn_t write, uint32_t unit_len_in_bytes, uint64_t file_pos)
+{
+    const uint32_t capped_len = unit_len_in_bytes < WRITE_COALESCER_MAX_UNIT_LEN_IN_BYTES ? unit_len_in_bytes : WRITE_COALESCER_MAX_UNIT_LEN_IN_BYTES;
+
+    write_fn = write;
+    unit_len = capped_len - (capped_len % WRITE_COALESCER_SECTOR_LEN_IN_BYTES);
+    pos_in_unit = unit_len == 0 ? 0 : (uint32_t)(file_pos % unit_len);
+    num_buffered = 0;
+}
+
+bool write_coalescer_write(const uint8_t *buff, uint32_t len)
+{
+    if (unit_len == 0)
+    {
+        return len == 0 || write_fn(buff, len);
+    }
+
+    // top up the unit the file position is in, and hand it over once it's full
+    if (num_buffered > 0 || pos_in_unit != 0)
+    {
+        const uint32_t room = unit_len - pos_in_unit;
+        const uint32_t len_buffered = len < room ? len : room;
+
+        memcpy(unit_buff + num_buffered, buff, len_buffered);
+        num_buffered += len_buffered;
+        pos_in_unit += len_buffered;
+        buff += len_buffered;
+        len -= len_buffered;
+
+        if (pos_in_unit < unit_len)
+        {
+            return true;
+        }
+
+        pos_in_unit = 0;
+        if (!write_coalescer_flush())
+        {
+            return false;
+        }
+    }
+
+    // the file position is on a unit boundary, the whole units go straight from the caller's buffer
+    const uint32_t whole_units_len = len - (len % unit_len);
+
+    if (whole_units_len > 0 && !write_fn(buff, whole_units_len))
+    {
+        return false;
+    }
+
+    num_buffered = len - whole_units_len;
+    pos_in_unit = num_buffered;
+    memcpy(unit_buff, buff + whole_units_len, num_buffered);
+
+    return true;
+}
+
+bool write_coalescer_flush()
+{
+    if (num_buffered == 0)
+    {
+        return true;
+    }
+
+    // the buffered bytes are gone either way, a failed write leaves the file position unknown
+    const uint32_t len = num_buffered;
+    num_buffered = 0;
+
+    return write_fn(unit_buff, len);
+}
+
+uint32_t write_coalescer_num_buffered()
+{
+    return num_buffered;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file      write_coalescer.h
+ * @brief     A software module for gathering small writes into whole write units of the SD card is represented here.
+ * @details   Each processed DMA block is written out as soon as it is ready, so the size of a write is whatever one
+ *            block turns into: 24768 bytes at 384kHz 24 bit, but only 2064 bytes at 24kHz 16 bit. Every write costs the
+ *            card a command, a busy period, and often a read-modify-write of a flash page, whatever its length, so at
+ *            low sample rates most of the time spent writing is overhead.
+ *
+ *            This module sits in front of the function that really writes to the card. It keeps the bytes of the open
+ *            file in a buffer until they fill a write unit, e.g. a cluster, and then hands the whole unit over in one
+ *            write that starts and ends on a unit boundary of the file. Whole units in the middle of a long write are
+ *            handed over straight from the caller's buffer, so at most one unit is ever copied per write, and the
+ *            buffer is the only extra memory it takes: `WRITE_COALESCER_MAX_UNIT_LEN_IN_BYTES`.
+ *
+ *            The buffered bytes must be flushed before anything else touches the file, e.g. a seek, a sync, or a
+ *            read, and before it is closed.
+ *
+ *            This module does not touch any peripherals, so it can be unit tested and shared with host simulations.
+ */
+
+#ifndef WRITE_COALESCER_H_
+#define WRITE_COALESCER_H_
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Public definitions ------------------------------------------------------------------------------------------------*/
+
+// the size of the buffer, the longest write unit there can be, a cluster of a FAT32 card of 32GiB or more
+#define WRITE_COALESCER_MAX_UNIT_LEN_IN_BYTES (32768)
+
+// write units are a whole number of sectors
+#define WRITE_COALESCER_SECTOR_LEN_IN_BYTES (512)
+
+/* Public types ------------------------------------------------------------------------------------------------------*/
+
+/**
+ * @brief The function the coalesced writes are handed to. It writes `len` bytes of `buff` at the file position and
+ * moves the file position on, and is true iff all of them were written.
+ */
+typedef bool (*Write_Coalescer_Write_Fn_t)(const uint8_t *buff, uint32_t len);
+
+/* Public function declarations --------------------------------------------------------------------------------------*/
+
+/**
+ * @brief `write_coalescer_start(w, u, p)` starts gathering writes into units of `u` bytes for write function `w`, for a
+ * file position of `p`. Call this when a file is opened, and after each seek.
+ *
+ * @param write the function to hand the coalesced writes to.
+ *
+ * @param unit_len_in_bytes the length of a write unit, rounded down to whole sectors and capped at
+ * `WRITE_COALESCER_MAX_UNIT_LEN_IN_BYTES`. Less than a sector turns coalescing off, so every write is handed straight
+ * to `w`.
+ *
+ * @param file_pos the file position the next write goes to, the units line up with the start of the file.
+ *
+ * @pre nothing is buffered, see `write_coalescer_flush()`.
+ */
+void write_coalescer_start(Write_Coalescer_Write_Fn_t write, uint32_t unit_len_in_bytes, uint64_t file_pos);
+
+/**
+ * @brief `write_coalescer_write(b, l)` writes `l` bytes of buffer `b` at the file position, buffering whatever doesn't
+ * reach the end of a write unit.
+ *
+ * @post the bytes up to the last unit boundary they reach have been handed to the write function, the rest are
+ * buffered. `b` can be reused straight away.
+ *
+ * @retval true if the write function took every write it was given, false if it failed, in which case the buffered
+ * bytes are dropped.
+ */
+bool write_coalescer_write(const uint8_t *buff, uint32_t len);
+
+/**
+ * @brief `write_coalescer_flush()` hands the buffered bytes to the write function, even though they don't fill a
+ * unit.
+ *
+ * @post nothing is buffered, and the file position is the end of the bytes written so far.
+ *
+ * @retval true if there was nothing to flush or the write function took it all, else false.
+ */
+bool write_coalescer_flush();
+
+/**
+ * @brief `write_coalescer_num_buffered()` is the number of bytes written but not yet handed to the write function,
+ * they go at the file position.
+ */
+uint32_t write_coalescer_num_buffered();
+
+#endif /* WRITE_COALESCER_H_ */
@@ -80,7 +80,7 @@ int main(void)
     // set up the mock sine wave
     mock_audio_sine_init();
     mock_audio_set_sample_rate(DEMO_CONFIG_SAMPLE_RATE_HZ);
-    mock_audio_set_sine_freq(DEMO_CONFIG_SINE_FREQUENCY_HZ);
+    mock_audio_set_sine_freq(MOCK_AUDIO_CHANNEL_A, DEMO_CONFIG_SINE_FREQUENCY_HZ);
 
     // get the SD card ready to write
     if (sd_card_init() != SD_CARD_ERROR_ALL_OK)
@@ -107,10 +107,7 @@ int main(void)
     MXC_GPIO_OutSet(file_write_timing_pin.port, file_write_timing_pin.mask); // whole file timing
     for (uint32_t buff = 0; buff < NUM_FULL_BUFFERS_IN_WHOLE_FILE; buff++)
     {
-        for (uint32_t samp = 0; samp < DEMO_CONFIG_AUDIO_BUFF_LEN_IN_SAMPS; samp++)
-        {
-            audio_buff[samp] = mock_audio_sine_tick();
-        }
+        mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_A, audio_buff, DEMO_CONFIG_AUDIO_BUFF_LEN_IN_SAMPS, 1);
 
         MXC_GPIO_OutSet(buff_write_timing_pin.port, buff_write_timing_pin.mask); // single buffer timing
         if (sd_card_fwrite(audio_buff, AUDIO_BUFF_LEN_IN_BYTES, &bytes_written) != SD_CARD_ERROR_ALL_OK)
@@ -121,7 +118,7 @@ int main(void)
     }
 
     // calculate the total size of the file and write the header
-    const uint32_t file_size = sd_card_fsize();
+    const uint64_t file_size = sd_card_fsize();
 
     Wave_Header_Attributes_t wav_attr = {
         .num_channels = WAVE_HEADER_MONO,
@@ -82,8 +82,8 @@ int main(void)
     mock_audio_sine_init();
     mock_audio_set_sample_rate(DEMO_CONFIG_SAMPLE_RATE_HZ);
 
-    mock_audio_set_sine_freq_A(DEMO_CONFIG_SINE_FREQUENCY_HZ);
-    mock_audio_set_sine_freq_B(DEMO_CONFIG_SINE_FREQUENCY_HZ * 2); // make the 2nd channel freq different so we can tell them apart in the wav file
+    mock_audio_set_sine_freq(MOCK_AUDIO_CHANNEL_A, DEMO_CONFIG_SINE_FREQUENCY_HZ);
+    mock_audio_set_sine_freq(MOCK_AUDIO_CHANNEL_B, DEMO_CONFIG_SINE_FREQUENCY_HZ * 2); // make the 2nd channel freq different so we can tell them apart in the wav file
 
     // get the SD card ready to write
     if (sd_card_init() != SD_CARD_ERROR_ALL_OK)
@@ -110,14 +110,9 @@ int main(void)
     MXC_GPIO_OutSet(file_write_timing_pin.port, file_write_timing_pin.mask); // whole file timing
     for (uint32_t buff = 0; buff < NUM_FULL_BUFFERS_IN_WHOLE_FILE; buff++)
     {
-        for (uint32_t samp = 0; samp < DEMO_CONFIG_AUDIO_BUFF_LEN_IN_SAMPS; samp += 2)
-        {
-            const int16_t left_sample = mock_audio_sine_tick_A();
-            const int16_t right_sample = mock_audio_sine_tick_B();
-
-            audio_buff[samp] = left_sample;
-            audio_buff[samp + 1] = right_sample;
-        }
+        // the samples are interleaved, left then right
+        mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_A, &audio_buff[0], DEMO_CONFIG_AUDIO_BUFF_LEN_IN_SAMPS / 2, 2);
+        mock_audio_sine_fill(MOCK_AUDIO_CHANNEL_B, &audio_buff[1], DEMO_CONFIG_AUDIO_BUFF_LEN_IN_SAMPS / 2, 2);
 
         MXC_GPIO_OutSet(buff_write_timing_pin.port, buff_write_timing_pin.mask); // single buffer timing
         if (sd_card_fwrite(audio_buff, AUDIO_BUFF_LEN_IN_BYTES, &bytes_written) != SD_CARD_ERROR_ALL_OK)
@@ -128,7 +123,7 @@ int main(void)
     }
 
     // calculate the total size of the file and write the header
-    const uint32_t file_size = sd_card_fsize();
+    const uint64_t file_size = sd_card_fsize();
 
     Wave_Header_Attributes_t wav_attr = {
         .num_channels = WAVE_HEADER_STEREO,
@@ -18,6 +18,17 @@ LIB_SDHC = 1
 
 FATFS_VERSION = ff15
 
+# sd_card, wav_header, mock_audio and the HAL they go through, from the modules shared between snippets
+include ../magpie_core/core.mk
+SRCS += $(MAGPIE_CORE_DIR)/mock_audio.c
+SRCS += $(MAGPIE_CORE_DIR)/sd_card.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_sdhc.c
+SRCS += $(MAGPIE_CORE_DIR)/write_coalescer.c
+SRCS += $(MAGPIE_CORE_DIR)/wav_header.c
+SRCS += $(MAGPIE_CORE_DIR)/ima_adpcm.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_timer.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_gpio.c
+
 MXC_OPTIMIZE_CFLAGS = -O2
 
 PROJ_LDFLAGS += -Wl,--print-memory-usage
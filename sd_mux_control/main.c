@@ -14,17 +14,13 @@
 #include "board.h"
 #include "mxc_delay.h"
 
-#include "i2c.h"
+#include "hal_i2c.h"
 #include "sd_card.h"
 #include "sd_card_bank_ctl.h"
 
 /* Private definitions -----------------------------------------------------------------------------------------------*/
 
-#define I2C_BUS_3V3_PULLUPS (MXC_I2C2_BUS0)
-
-#define I2C_CFG_MASTER_MODE (1)
-
-#define I2C_CLK_SPEED (MXC_I2C_STD_MODE)
+#define I2C_BUS_3V3_PULLUPS (HAL_I2C_BUS_2)
 
 /* Private enumerations ----------------------------------------------------------------------------------------------*/
 
@@ -63,7 +59,7 @@ static void blink_n_times(LED_Colot_t c, uint8_t n);
 
 int main(void)
 {
-  if (MXC_I2C_Init(I2C_BUS_3V3_PULLUPS, I2C_CFG_MASTER_MODE, 0) != E_NO_ERROR)
+  if (hal_i2c_init(I2C_BUS_3V3_PULLUPS, HAL_I2C_SPEED_STANDARD) != HAL_I2C_ERROR_ALL_OK)
   {
     printf("-->I2C initialization FAILED\n");
     return -1;
@@ -80,12 +76,6 @@ int main(void)
   };
   MXC_GPIO_Config(&i2c2_pins);
 
-  if (MXC_I2C_SetFrequency(I2C_BUS_3V3_PULLUPS, I2C_CLK_SPEED) != I2C_CLK_SPEED)
-  {
-    printf("-->I2C frequency set FAILED\n");
-    return -1;
-  }
-
   if (sd_card_bank_ctl_init(I2C_BUS_3V3_PULLUPS) != SD_CARD_BANK_CTL_ERROR_ALL_OK)
   {
     printf("-->SD card bank ctl init FAILED\n");
@@ -19,3 +19,13 @@ PROJ_CFLAGS+=-mno-unaligned-access
 LIB_SDHC = 1
 
 FATFS_VERSION = ff15
+
+# sd_card, the SD card bank control and the HAL they go through, from the modules shared between snippets
+include ../magpie_core/core.mk
+SRCS += $(MAGPIE_CORE_DIR)/sd_card.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_sdhc.c
+SRCS += $(MAGPIE_CORE_DIR)/write_coalescer.c
+SRCS += $(MAGPIE_CORE_DIR)/sd_card_bank_ctl.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_timer.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_gpio.c
+SRCS += $(MAGPIE_CORE_DIR)/hal_i2c.c